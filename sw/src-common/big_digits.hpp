@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "glyphs.hpp"
+
+#ifdef ESP_PLATFORM
+#include "esphome.h"
+#else
+#include "../src-pc/mock_esphome.hpp"
+#endif
+
+// The time left as mm:ss in digits 2 rows high, readable across the field. A digit is 3 columns of the seven segments:
+// the verticals are full blocks, the bars the strokes of glyphs.hpp (4 glyphs, so the cache of the LCD driver uploads
+// them once). Digits are a column apart, the colon takes a column of its own:
+//
+//   X"X X==.X"X X"X     (05:00 as the PC build prints it)
+//   X_X __X.X_X X_X
+
+static constexpr size_t BIG_TIME_COLS = 15;
+// Screens that show more than the time alternate between it and their text
+static constexpr int32_t BIG_TIME_SWAP_MS = 5000;
+
+// Renders a digit into the first 3 characters of its rows
+inline void big_digit(int digit, char *top, char *bottom) {
+  // segments a-g of 0-9, bit 0 = a
+  static const uint8_t SEGMENTS[] = {0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07, 0x7f, 0x6f};
+  uint8_t s = SEGMENTS[digit % 10];
+  bool a = s & 0x01, b = s & 0x02, c = s & 0x04, d = s & 0x08, e = s & 0x10, f = s & 0x20, g = s & 0x40;
+  // the top row has a at its top and g at its bottom, the bottom row d at its bottom
+  char bars = a && g ? GLYPH_BIG_BOTH : a ? GLYPH_BIG_TOP : g ? GLYPH_BIG_BOTTOM : ' ';
+  char base = d ? GLYPH_BIG_BOTTOM : ' ';
+  top[0] = f ? GLYPH_BLOCK : bars;
+  top[1] = bars;
+  top[2] = b ? GLYPH_BLOCK : bars;
+  bottom[0] = e ? GLYPH_BLOCK : base;
+  bottom[1] = base;
+  bottom[2] = c ? GLYPH_BLOCK : base;
+}
+
+// The time left as big digits in top and bottom (BIG_TIME_COLS characters and a NUL each), false from 100 minutes on
+inline bool format_big_time(int milliseconds, char *top, char *bottom) {
+  if (milliseconds < 0)
+    milliseconds = 0;
+  int seconds = milliseconds / 1000;
+  int minutes = seconds / 60;
+  if (minutes >= 100) {
+    return false;
+  }
+  memset(top, ' ', BIG_TIME_COLS);
+  memset(bottom, ' ', BIG_TIME_COLS);
+  top[BIG_TIME_COLS] = bottom[BIG_TIME_COLS] = '\0';
+  static const size_t COL[] = {0, 4, 8, 12};
+  int digits[] = {minutes / 10, minutes % 10, seconds % 60 / 10, seconds % 10};
+  for (int i = 0; i < 4; i++) {
+    big_digit(digits[i], top + COL[i], bottom + COL[i]);
+  }
+  top[7] = bottom[7] = GLYPH_BIG_DOT;
+  return true;
+}
+
+// Shows the time left as big digits on the whole display. Returns false if it doesn't fit, the caller shows its text.
+inline bool display_big_time(esphome::lcd_base::LCDDisplay &disp, int32_t ms_remaining) {
+  char top[BIG_TIME_COLS + 1], bottom[BIG_TIME_COLS + 1];
+  if (!format_big_time(ms_remaining, top, bottom)) {
+    return false;
+  }
+  disp.print(0, 0, top);
+  disp.print(0, 1, bottom);
+  return true;
+}
+
+// The turn of the big time on a screen that alternates with text, by the time left so the turns follow the clock
+inline bool big_time_turn(int32_t ms_remaining) { return ms_remaining / BIG_TIME_SWAP_MS % 2 == 1; }
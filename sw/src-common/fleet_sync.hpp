@@ -0,0 +1,647 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Fleet sync: keeps the props on one field in agreement about the running domination game.
+//
+// - Every prop broadcasts its state (team holding the point, time held by each team) as small deltas: a state message
+//   only carries the fields the receivers can't predict, every FULL_STATE_EVERY-th message carries all of them so
+//   that lost messages heal on their own. Game and team changes are repeated a few times right away.
+// - The props share one game clock (a timeline, named after the prop that founded it). A prop that hears nobody with a
+//   timeline for LISTEN_TIME after boot founds one; when several timelines meet, the lowest name wins. The lowest node
+//   id on the timeline is the leader, the others estimate the offset of their clock to the leader's NTP style
+//   (ping/pong, the sample with the lowest round trip wins). A prop that takes over the lead keeps its offset, so the
+//   shared clock doesn't jump when the leader is switched off.
+// - A game started on any prop is announced with its start time on the shared clock, the other props start it at
+//   the same moment (or join the running game with the right time left).
+//
+// The transport is a best effort broadcast (ESP-NOW on the device, an in-process loopback on the PC). Nothing here
+// reads the time itself, so the PC simulator can run many props in one process.
+
+static constexpr size_t FLEET_MAX_PROPS = 64;
+static constexpr size_t FLEET_MAX_MESSAGE = 48;
+
+class FleetTransport {
+public:
+  virtual ~FleetTransport() = default;
+
+  // Broadcasts a message to all other props. Delivery is best effort.
+  virtual void send(const uint8_t *data, size_t len) = 0;
+  // Copies the next received message into buf (FLEET_MAX_MESSAGE bytes). Returns its length, 0 if there is none.
+  virtual size_t receive(uint8_t *buf) = 0;
+};
+
+// State of one prop as shared with the fleet
+struct FleetPropState {
+  int8_t team_active = 0; // 0=no team, 1=red, 2=yellow
+  uint32_t red_ms = 0;
+  uint32_t yellow_ms = 0;
+};
+
+// A game announced to the fleet
+struct FleetGame {
+  uint32_t origin = 0;       // node id of the prop where the game was started, 0 = no game
+  uint32_t announced_at = 0; // shared clock time of the announcement
+  uint32_t start_at = 0;     // shared clock time when the game starts (after the delay)
+  uint16_t game_min = 0;
+
+  bool operator==(const FleetGame &other) const {
+    return origin == other.origin && announced_at == other.announced_at && start_at == other.start_at &&
+           game_min == other.game_min;
+  }
+  bool operator!=(const FleetGame &other) const { return !(*this == other); }
+
+  // Whether this game replaces other: the later announcement wins (a restart), ties go to the lower origin
+  bool newer_than(const FleetGame &other) const {
+    if (!origin) {
+      return false;
+    }
+    if (!other.origin) {
+      return true;
+    }
+    int32_t diff = (int32_t)(announced_at - other.announced_at);
+    return diff > 0 || (diff == 0 && origin < other.origin);
+  }
+};
+
+struct FleetScore {
+  uint32_t red_ms = 0;
+  uint32_t yellow_ms = 0;
+  uint8_t props = 0; // props in the game, including this one
+};
+
+struct FleetStats {
+  uint32_t bytes_sent = 0;
+  uint32_t messages_sent = 0;
+  uint32_t messages_received = 0;
+  uint32_t messages_invalid = 0;
+};
+
+// Wire format of the fleet messages. All integers are little endian, varints are LEB128.
+//
+//   uint8_t  MAGIC | type
+//   uint32_t sender
+//   STATE: uint8_t fields, then for each field bit that is set:
+//            F_CLOCK:  uint32_t timeline
+//            F_GAME:   uint32_t origin, uint32_t announced_at, varint start_at - announced_at, varint game_min
+//            F_TEAM:   uint8_t team_active
+//            F_RED:    varint red_ms / TIME_UNIT
+//            F_YELLOW: varint yellow_ms / TIME_UNIT
+//   PING:  uint32_t target, uint32_t t1
+//   PONG:  uint32_t target, uint32_t t1, uint32_t t2, uint32_t t3
+struct FleetMessage {
+  enum class TYPE : uint8_t { STATE = 1, PING = 2, PONG = 3 };
+  enum FIELD : uint8_t {
+    F_GAME = 1 << 0,
+    F_TEAM = 1 << 1,
+    F_RED = 1 << 2,
+    F_YELLOW = 1 << 3,
+    F_ALL = F_GAME | F_TEAM | F_RED | F_YELLOW,
+    F_CLOCK = 1 << 7, // the sender has a shared clock, sent in every message
+  };
+  static constexpr uint8_t MAGIC = 0xa0;     // high nibble of the first byte, the low nibble is the type
+  static constexpr uint32_t TIME_UNIT = 100; // resolution of the team times in ms
+
+  TYPE type = TYPE::STATE;
+  uint32_t sender = 0;
+
+  // STATE
+  uint8_t fields = 0;
+  uint32_t timeline = 0;
+  FleetGame game;
+  FleetPropState state;
+
+  // PING & PONG
+  uint32_t target = 0;
+  uint32_t t1 = 0; // ping sent (sender's clock)
+  uint32_t t2 = 0; // ping received (leader's shared clock)
+  uint32_t t3 = 0; // pong sent (leader's shared clock)
+
+  // Returns the encoded length, at most FLEET_MAX_MESSAGE
+  size_t encode(uint8_t *buf) const {
+    uint8_t *p = buf;
+    *p++ = MAGIC | (uint8_t)type;
+    p = put_u32(p, sender);
+    switch (type) {
+    case TYPE::STATE:
+      *p++ = fields;
+      if (fields & F_CLOCK) {
+        p = put_u32(p, timeline);
+      }
+      if (fields & F_GAME) {
+        p = put_u32(p, game.origin);
+        p = put_u32(p, game.announced_at);
+        p = put_varint(p, game.start_at - game.announced_at);
+        p = put_varint(p, game.game_min);
+      }
+      if (fields & F_TEAM) {
+        *p++ = (uint8_t)state.team_active;
+      }
+      if (fields & F_RED) {
+        p = put_varint(p, state.red_ms / TIME_UNIT);
+      }
+      if (fields & F_YELLOW) {
+        p = put_varint(p, state.yellow_ms / TIME_UNIT);
+      }
+      break;
+    case TYPE::PONG:
+      p = put_u32(p, target);
+      p = put_u32(p, t1);
+      p = put_u32(p, t2);
+      p = put_u32(p, t3);
+      break;
+    case TYPE::PING:
+      p = put_u32(p, target);
+      p = put_u32(p, t1);
+      break;
+    }
+    return p - buf;
+  }
+
+  // Returns false for foreign or malformed messages
+  bool decode(const uint8_t *buf, size_t len) {
+    const uint8_t *end = buf + len;
+    if (len < 5 || (buf[0] & 0xf0) != MAGIC) {
+      return false;
+    }
+    type = (TYPE)(buf[0] & 0x0f);
+    const uint8_t *p = buf + 1;
+    get_u32(p, end, sender);
+    switch (type) {
+    case TYPE::STATE: {
+      if (p == end) {
+        return false;
+      }
+      fields = *p++;
+      uint32_t value = 0;
+      if ((fields & F_CLOCK) && (!get_u32(p, end, timeline) || !timeline)) {
+        return false;
+      }
+      if (fields & F_GAME) {
+        uint32_t delay = 0;
+        if (!get_u32(p, end, game.origin) || !get_u32(p, end, game.announced_at) || !get_varint(p, end, delay) ||
+            !get_varint(p, end, value) || value > UINT16_MAX) {
+          return false;
+        }
+        game.start_at = game.announced_at + delay;
+        game.game_min = value;
+      }
+      if (fields & F_TEAM) {
+        if (p == end || *p > 2) {
+          return false;
+        }
+        state.team_active = *p++;
+      }
+      if (fields & F_RED) {
+        if (!get_varint(p, end, value)) {
+          return false;
+        }
+        state.red_ms = value * TIME_UNIT;
+      }
+      if (fields & F_YELLOW) {
+        if (!get_varint(p, end, value)) {
+          return false;
+        }
+        state.yellow_ms = value * TIME_UNIT;
+      }
+      break;
+    }
+    case TYPE::PONG:
+      if (!get_u32(p, end, target) || !get_u32(p, end, t1) || !get_u32(p, end, t2) || !get_u32(p, end, t3)) {
+        return false;
+      }
+      break;
+    case TYPE::PING:
+      if (!get_u32(p, end, target) || !get_u32(p, end, t1)) {
+        return false;
+      }
+      break;
+    default: return false;
+    }
+    return p == end;
+  }
+
+private:
+  static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+      *p++ = v >> (8 * i);
+    }
+    return p;
+  }
+
+  static uint8_t *put_varint(uint8_t *p, uint32_t v) {
+    while (v >= 0x80) {
+      *p++ = (v & 0x7f) | 0x80;
+      v >>= 7;
+    }
+    *p++ = v;
+    return p;
+  }
+
+  static bool get_u32(const uint8_t *&p, const uint8_t *end, uint32_t &v) {
+    if (end - p < 4) {
+      return false;
+    }
+    v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    p += 4;
+    return true;
+  }
+
+  static bool get_varint(const uint8_t *&p, const uint8_t *end, uint32_t &v) {
+    v = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      if (p == end) {
+        return false;
+      }
+      uint8_t b = *p++;
+      v |= (uint32_t)(b & 0x7f) << shift;
+      if (!(b & 0x80)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+class FleetSync {
+private:
+  static constexpr uint32_t STATE_INTERVAL = 1000;         // heartbeat
+  static constexpr uint32_t FULL_STATE_EVERY = 5;          // every n-th state message carries all fields
+  static constexpr uint32_t URGENT_REPEAT = 5;             // state messages that carry a game or team change
+  static constexpr uint32_t REPEAT_INTERVAL = 100;         // between those
+  static constexpr uint32_t PING_INTERVAL = 2000;          // offset sampling once synced
+  static constexpr uint32_t PING_INTERVAL_UNSYNCED = 200;  // offset sampling until synced
+  static constexpr uint32_t PEER_TIMEOUT = 5000;           // a prop is gone after this long without a message
+  static constexpr uint32_t LISTEN_TIME = 3000;            // after boot, before founding a timeline
+  static constexpr size_t OFFSET_SAMPLES = 8;              // offset samples to pick the lowest round trip from
+  static constexpr size_t OFFSET_SAMPLES_SYNCED = 4;       // samples needed before the clock counts as shared
+
+  struct Peer {
+    uint32_t id = 0;
+    uint32_t last_heard = 0;
+    uint32_t state_at = 0; // when the last state message was received
+    uint32_t timeline = 0;
+    FleetPropState state;
+    FleetGame game;
+  };
+
+  struct OffsetSample {
+    uint32_t rtt;
+    uint32_t offset;
+  };
+
+  FleetTransport *transport = nullptr;
+  uint32_t node_id = 0;
+  uint32_t boot_at = 0;
+  bool booted = false;
+
+  // Props that went quiet are kept, their time still counts in the field score
+  std::array<Peer, FLEET_MAX_PROPS - 1> peers;
+  size_t peers_len = 0;
+  size_t peers_alive = 0;
+
+  FleetPropState local;
+  FleetPropState sent;
+  FleetGame game;
+  FleetGame sent_game;
+  uint8_t repeat_fields = 0;
+  uint32_t repeat = 0;
+  bool game_pending = false;
+  uint32_t state_count = 0;
+  uint32_t last_state_at = 0;
+
+  uint32_t timeline = 0;  // 0 = no shared clock yet
+  uint32_t leader_id = 0; // 0 = unknown
+  uint32_t leader_timeline = 0;
+  uint32_t offset = 0;    // shared clock - local clock, modulo 2^32 like the clocks themselves
+  std::array<OffsetSample, OFFSET_SAMPLES> samples;
+  size_t samples_len = 0;
+  size_t samples_next = 0;
+  uint32_t last_ping_at = 0;
+
+  FleetStats stats;
+
+  void send(const FleetMessage &msg) {
+    uint8_t buf[FLEET_MAX_MESSAGE];
+    size_t len = msg.encode(buf);
+    transport->send(buf, len);
+    stats.bytes_sent += len;
+    stats.messages_sent++;
+  }
+
+  bool alive(const Peer &peer, uint32_t now) const { return now - peer.last_heard <= PEER_TIMEOUT; }
+
+  Peer *find_peer(uint32_t id, uint32_t now) {
+    Peer *quietest = nullptr;
+    for (size_t i = 0; i < peers_len; i++) {
+      if (peers[i].id == id) {
+        return &peers[i];
+      }
+      if (!quietest || now - peers[i].last_heard > now - quietest->last_heard) {
+        quietest = &peers[i];
+      }
+    }
+    Peer *peer;
+    if (peers_len < peers.size()) {
+      peer = &peers[peers_len++];
+    } else if (!alive(*quietest, now)) {
+      peer = quietest;
+    } else {
+      return nullptr; // more than FLEET_MAX_PROPS props around
+    }
+    *peer = Peer();
+    peer->id = id;
+    return peer;
+  }
+
+  void receive(uint32_t now) {
+    uint8_t buf[FLEET_MAX_MESSAGE];
+    size_t len;
+    while ((len = transport->receive(buf)) > 0) {
+      FleetMessage msg;
+      if (!msg.decode(buf, len) || msg.sender == node_id || !msg.sender) {
+        stats.messages_invalid++;
+        continue;
+      }
+      stats.messages_received++;
+      Peer *peer = find_peer(msg.sender, now);
+      if (!peer) {
+        continue;
+      }
+      peer->last_heard = now;
+      switch (msg.type) {
+      case FleetMessage::TYPE::STATE: handle_state(*peer, msg, now); break;
+      case FleetMessage::TYPE::PING:  handle_ping(msg, now); break;
+      case FleetMessage::TYPE::PONG:  handle_pong(msg, now); break;
+      }
+    }
+  }
+
+  void handle_state(Peer &peer, const FleetMessage &msg, uint32_t now) {
+    peer.timeline = msg.fields & FleetMessage::F_CLOCK ? msg.timeline : 0;
+    if (msg.fields & FleetMessage::F_GAME) {
+      peer.game = msg.game;
+      if (msg.game.newer_than(game)) {
+        game = msg.game;
+        game_pending = true;
+      }
+    }
+    // Fields that are left out are what the sender predicts we have, see send_state()
+    peer.state = extrapolate(peer.state, now - peer.state_at);
+    peer.state_at = now;
+    if (msg.fields & FleetMessage::F_TEAM) {
+      peer.state.team_active = msg.state.team_active;
+    }
+    if (msg.fields & FleetMessage::F_RED) {
+      peer.state.red_ms = msg.state.red_ms;
+    }
+    if (msg.fields & FleetMessage::F_YELLOW) {
+      peer.state.yellow_ms = msg.state.yellow_ms;
+    }
+  }
+
+  void handle_ping(const FleetMessage &msg, uint32_t now) {
+    if (msg.target != node_id || leader_id != node_id) {
+      return;
+    }
+    FleetMessage pong;
+    pong.type = FleetMessage::TYPE::PONG;
+    pong.sender = node_id;
+    pong.target = msg.sender;
+    pong.t1 = msg.t1;
+    pong.t2 = shared_time(now);
+    pong.t3 = pong.t2; // answered right away, the time spent queued in the transport counts as network delay
+    send(pong);
+  }
+
+  void handle_pong(const FleetMessage &msg, uint32_t now) {
+    if (msg.target != node_id || msg.sender != leader_id || leader_id == node_id) {
+      return;
+    }
+    uint32_t rtt = (now - msg.t1) - (msg.t3 - msg.t2);
+    if (rtt > PEER_TIMEOUT) {
+      return; // answer to a ping from before a leader switch or a reboot
+    }
+    // NTP: offset = ((t2 - t1) + (t3 - t4)) / 2, rearranged to stay correct modulo 2^32
+    OffsetSample sample = {rtt, msg.t2 - msg.t1 - rtt / 2};
+    samples[samples_next] = sample;
+    samples_next = (samples_next + 1) % samples.size();
+    if (samples_len < samples.size()) {
+      samples_len++;
+    }
+    const OffsetSample *best = &samples[0];
+    for (size_t i = 1; i < samples_len; i++) {
+      if (samples[i].rtt < best->rtt) {
+        best = &samples[i];
+      }
+    }
+    offset = best->offset;
+    if (samples_len >= OFFSET_SAMPLES_SYNCED) {
+      timeline = leader_timeline;
+    }
+  }
+
+  void elect_leader(uint32_t now) {
+    // The lowest timeline wins, its lowest node id leads
+    uint32_t best = timeline;
+    peers_alive = 0;
+    for (size_t i = 0; i < peers_len; i++) {
+      if (alive(peers[i], now)) {
+        peers_alive++;
+        if (peers[i].timeline && (!best || peers[i].timeline < best)) {
+          best = peers[i].timeline;
+        }
+      }
+    }
+    if (!best && now - boot_at >= LISTEN_TIME) {
+      // Nobody around has a shared clock, found one
+      timeline = best = node_id;
+    }
+    if (timeline != best) {
+      // This prop's clock is on a timeline that lost, start over on the winning one
+      timeline = 0;
+    }
+
+    uint32_t leader = timeline ? node_id : 0;
+    for (size_t i = 0; i < peers_len; i++) {
+      if (best && peers[i].timeline == best && alive(peers[i], now) && (!leader || peers[i].id < leader)) {
+        leader = peers[i].id;
+      }
+    }
+    if (leader != leader_id) {
+      leader_id = leader;
+      leader_timeline = best;
+      samples_len = 0;
+      samples_next = 0;
+      last_ping_at = now - PING_INTERVAL;
+    }
+  }
+
+  void send_ping(uint32_t now) {
+    if (!leader_id || leader_id == node_id) {
+      return;
+    }
+    uint32_t interval = samples_len >= OFFSET_SAMPLES_SYNCED ? PING_INTERVAL : PING_INTERVAL_UNSYNCED;
+    if (now - last_ping_at < interval) {
+      return;
+    }
+    last_ping_at = now;
+    FleetMessage ping;
+    ping.type = FleetMessage::TYPE::PING;
+    ping.sender = node_id;
+    ping.target = leader_id;
+    ping.t1 = now;
+    send(ping);
+  }
+
+  // The team holding a point keeps scoring between messages, both ends extrapolate its time the same way. The time
+  // fields are only sent when that prediction is off (a capture, a missed tick) or in the periodic full state.
+  static FleetPropState extrapolate(const FleetPropState &state, uint32_t elapsed) {
+    FleetPropState s = state;
+    switch (s.team_active) {
+    case 1: s.red_ms += elapsed; break;
+    case 2: s.yellow_ms += elapsed; break;
+    }
+    return s;
+  }
+
+  static bool off_by_unit(uint32_t a, uint32_t b) {
+    return (a > b ? a - b : b - a) >= FleetMessage::TIME_UNIT;
+  }
+
+  void send_state(uint32_t now) {
+    // Game and team changes go out right away and are repeated quickly, everything else waits for the heartbeat
+    uint8_t changed = 0;
+    if (game != sent_game) {
+      changed |= FleetMessage::F_GAME;
+    }
+    if (local.team_active != sent.team_active) {
+      changed |= FleetMessage::F_TEAM | FleetMessage::F_RED | FleetMessage::F_YELLOW;
+    }
+    if (changed) {
+      repeat = URGENT_REPEAT;
+      repeat_fields |= changed;
+    }
+    if (!changed && now - last_state_at < (repeat ? REPEAT_INTERVAL : STATE_INTERVAL)) {
+      return;
+    }
+
+    FleetPropState predicted = extrapolate(sent, now - last_state_at);
+    uint8_t fields = repeat_fields;
+    if (off_by_unit(local.red_ms, predicted.red_ms)) {
+      fields |= FleetMessage::F_RED;
+    }
+    if (off_by_unit(local.yellow_ms, predicted.yellow_ms)) {
+      fields |= FleetMessage::F_YELLOW;
+    }
+    if (state_count++ % FULL_STATE_EVERY == 0) {
+      fields |= FleetMessage::F_ALL;
+    }
+    if (timeline) {
+      fields |= FleetMessage::F_CLOCK;
+    }
+
+    FleetMessage msg;
+    msg.type = FleetMessage::TYPE::STATE;
+    msg.sender = node_id;
+    msg.fields = fields;
+    msg.timeline = timeline;
+    msg.game = game;
+    msg.state = local;
+    send(msg);
+
+    if (repeat && --repeat == 0) {
+      repeat_fields = 0;
+    }
+    // What the receivers have now
+    sent.team_active = local.team_active;
+    sent.red_ms = fields & FleetMessage::F_RED ? local.red_ms / FleetMessage::TIME_UNIT * FleetMessage::TIME_UNIT
+                                               : predicted.red_ms;
+    sent.yellow_ms = fields & FleetMessage::F_YELLOW
+                         ? local.yellow_ms / FleetMessage::TIME_UNIT * FleetMessage::TIME_UNIT
+                         : predicted.yellow_ms;
+    sent_game = game;
+    last_state_at = now;
+  }
+
+public:
+  // Starts syncing over transport. node_id must be unique within the fleet and not 0 (e.g. derived from the MAC).
+  void begin(FleetTransport *transport, uint32_t node_id) {
+    this->transport = transport;
+    this->node_id = node_id;
+  }
+
+  bool active() const { return transport != nullptr; }
+
+  // Sets this prop's state, sent with the next state message
+  void set_state(const FleetPropState &state) { local = state; }
+
+  // Announces a game started on this prop. delay_ms is the time left until the game starts.
+  void announce_game(uint32_t now, uint32_t delay_ms, uint16_t game_min) {
+    game.origin = node_id;
+    game.announced_at = shared_time(now);
+    game.start_at = game.announced_at + delay_ms;
+    game.game_min = game_min;
+    game_pending = false;
+  }
+
+  // Returns true once for each game announced by another prop, as soon as the shared clock is available to time it
+  bool take_game(FleetGame &out) {
+    if (!game_pending || !timeline) {
+      return false;
+    }
+    game_pending = false;
+    out = game;
+    return true;
+  }
+
+  void clock(uint32_t now) {
+    if (!transport) {
+      return;
+    }
+    if (!booted) {
+      booted = true;
+      boot_at = now;
+      last_state_at = now;
+    }
+    receive(now);
+    elect_leader(now);
+    send_ping(now);
+    send_state(now);
+  }
+
+  uint32_t id() const { return node_id; }
+  uint32_t leader() const { return leader_id; }
+  bool is_leader() const { return leader_id && leader_id == node_id; }
+  bool synced() const { return timeline != 0; }
+  int32_t clock_offset() const { return (int32_t)offset; }
+  uint32_t shared_time(uint32_t now) const { return now + offset; }
+  // Props heard from recently
+  size_t peer_count() const { return peers_alive; }
+  const FleetGame &current_game() const { return game; }
+  const FleetStats &statistics() const { return stats; }
+
+  // Total time held by each team, over all props in the current game
+  FleetScore field_score(uint32_t now) const {
+    FleetScore score;
+    score.red_ms = local.red_ms;
+    score.yellow_ms = local.yellow_ms;
+    score.props = 1;
+    for (size_t i = 0; i < peers_len; i++) {
+      const Peer &peer = peers[i];
+      if (!game.origin || peer.game != game) {
+        continue;
+      }
+      // The peer's times are as of its last message, the team holding its point kept scoring since (a prop that went
+      // quiet is assumed to be switched off)
+      FleetPropState state = extrapolate(peer.state, std::min(now - peer.state_at, PEER_TIMEOUT));
+      score.red_ms += state.red_ms;
+      score.yellow_ms += state.yellow_ms;
+      score.props++;
+    }
+    return score;
+  }
+};
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "game_snapshot.hpp"
+#include "gm_manager.hpp"
+#include "input_latency.hpp"
+#include "lcd_frame.hpp"
+#include "log_tokens.hpp"
+#include "task_queues.hpp"
+
+#ifdef ESP_PLATFORM
+#include "esphome.h"
+#else
+#include "../src-pc/mock_esphome.hpp"
+#endif
+
+// The game on a task of its own (the game_task component of config.yaml), away from the main loop of esphome and its
+// web server, WiFi and logger work.
+//
+// The game manager is only ever called by the game task. The main loop hands it the keys through a command queue
+// and takes back what the game did: the actions, for the scripts of config.yaml, through an action queue, and the
+// display as the game rendered it, the latest frame only. All three are lock-free (task_queues.hpp), neither side
+// waits for the other. The clock only advances at the ticks, a key between them is applied on its own, as the key
+// automations of esphome did:
+//
+//   main loop                              game task
+//   key(), key_edge()      -> commands ->  apply_commands() for a key, tick(): the keys and GameManager::clock()
+//   run_actions()          <- actions  <-  GameManager::handle_actions()
+//   frame_ready(), show()  <- frames   <-  publish(), after GameManager::display_update() into a display of its own
+//
+// The game task also writes the log records of the game (log_tokens.hpp), the main loop drains them, and publishes a
+// snapshot of the game with each frame for the tasks that want to know its state (game_snapshot.hpp).
+// The PC build runs both sides in one thread.
+
+// A key for the game task
+struct GameCommand {
+  enum class TYPE : uint8_t { KEY, EDGE };
+
+  TYPE type;
+  unsigned char key;
+  bool down;       // EDGE: pressed or released
+  uint32_t at;     // KEY: micros() of the automation that reported it, EDGE: millis() of the keypad
+  uint32_t ticket; // KEY: for telling when a frame shows the key, 0 for none
+};
+
+// A display the game task rendered, with the last key ticket it had applied
+struct GameFrame {
+  LcdFrame lcd;
+  uint32_t ticket = 0;
+};
+
+class GameLoop {
+public:
+  explicit GameLoop(GameManager &game) : game(game) { game.attach_action_queue(&actions); }
+
+  // Wakes the game task for a command, set by the game_task component; nullptr when the task ticks on its own
+  void (*wake)() = nullptr;
+
+  // Main loop: a key tap, with the time the automation reported it (input_latency.hpp). A caller that needs to know
+  // which frame first shows the key passes a ticket, see shown_ticket(); tickets must increase from key to key.
+  void key(unsigned char key, uint32_t edge_us, uint32_t ticket = 0) {
+    command(GameCommand{GameCommand::TYPE::KEY, key, false, edge_us, ticket});
+  }
+
+  // Main loop: a press or release of a key with long presses, see GameManager::handle_key_edge()
+  void key_edge(unsigned char key, bool down, uint32_t at) {
+    command(GameCommand{GameCommand::TYPE::EDGE, key, down, at, 0});
+  }
+
+  // Main loop: runs the actions the game queued with the s_handle_actions script
+  void run_actions() {
+    ant_actions_t pending;
+    while (actions.pop(pending)) {
+      ::run_actions(pending);
+    }
+  }
+
+  // Main loop: whether the game rendered a frame the LCD hasn't shown
+  bool frame_ready() const { return frames.fresh(); }
+
+  // Main loop: prints the latest frame on the display, from its update. Returns the frame, for the web clients
+  // (WebServer::capture_lcd()), valid until the next show().
+  const GameFrame &show(esphome::lcd_base::LCDDisplay &disp) {
+    const GameFrame &frame = frames.read();
+    shown = frame.ticket;
+    char row[LCD_COLS + 1];
+    row[LCD_COLS] = '\0';
+    for (size_t r = 0; r < LCD_ROWS; r++) {
+      memcpy(row, frame.lcd.cells + r * LCD_COLS, LCD_COLS);
+      disp.print(0, r, row);
+    }
+    return frame;
+  }
+
+  // Main loop: the ticket of the last key the game had applied when it rendered the frame of the last show(), 0 before
+  // any key with a ticket
+  uint32_t shown_ticket() const { return shown; }
+
+  // Game task: applies the commands, the keys that woke the task between its ticks
+  void apply_commands() {
+    GameCommand c;
+    while (commands.pop(c)) {
+      switch (c.type) {
+      case GameCommand::TYPE::KEY:
+        input_latency.edge(c.at);
+        ANT_LOGI("Key", "%c", c.key);
+        // the millis() of the automation, from how long ago it was in micros() (which wraps sooner)
+        game.handle_key(c.key, esphome::millis() - (esphome::micros() - c.at) / 1000);
+        if (c.ticket != 0) {
+          applied = c.ticket;
+        }
+        break;
+      case GameCommand::TYPE::EDGE: game.handle_key_edge(c.key, c.down, c.at); break;
+      }
+    }
+  }
+
+  // Game task: a tick, the commands and then the game clock advanced to now
+  void tick(uint32_t now) {
+    apply_commands();
+    game.clock(now, now - game.clock_last_update_ms);
+  }
+
+  // Game task: hands the cells of the display the game rendered into to the main loop, and the state of the game with
+  // them to any task (game_snapshot.hpp)
+  void publish(const char *cells) {
+    GameFrame &frame = frames.back();
+    memcpy(frame.lcd.cells, cells, LCD_CELLS);
+    frame.ticket = applied;
+    frames.publish();
+
+    GameSnapshot snapshot;
+    game.snapshot(snapshot);
+    memcpy(snapshot.lcd, cells, LCD_CELLS);
+    game_snapshot.write(snapshot);
+  }
+
+  SpscQueue<GameCommand, 32> commands;
+  ActionQueue actions;
+  LatestValue<GameFrame> frames;
+
+private:
+  GameManager &game;
+  uint32_t applied = 0; // game task: the ticket of the last key applied
+  uint32_t shown = 0;   // main loop: the ticket of the frame shown last
+
+  void command(const GameCommand &c) {
+    commands.push(c);
+    if (wake != nullptr) {
+      wake();
+    }
+  }
+};
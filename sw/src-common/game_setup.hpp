@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "globals.hpp"
+
+// Remote game setup: a complete game configuration (mode + the values that are normally entered in the mode's setup
+// menu), used by the web API to set up a prop in one request instead of ~15 key presses.
+//
+// The game_api esphome component posts it from the web server task. The setup is handed to the game loop through
+// game_setup_mailbox, GameManager applies it on its next clock tick.
+
+struct GameSetup {
+  enum class MODE { NONE, DEFUSAL, DOMINATION, ZONE_CONTROL, COUNTDOWN, RESPAWN_TIMER };
+
+  MODE mode = MODE::NONE;
+  int delay_min = 0;
+  int bomb_min = 0;
+  int game_min = 0;
+  int standby_min = 0;
+  int respawn_sec = 0;
+  std::string bomb_code = "";
+  bool use_siren = false;
+  bool start = false; // start the game right away instead of leaving it in the setup menu
+
+  // Parameter names accepted by set()
+  static constexpr const char *KEYS[] = {"mode",        "delay_min",   "bomb_min",  "bomb_code", "game_min",
+                                         "standby_min", "respawn_sec", "use_siren", "start"};
+
+  // Sets a field from its text form, e.g. set("bomb_min", "15").
+  // Returns nullptr on success, otherwise an error message.
+  const char *set(const std::string &key, const std::string &value) {
+    uint32_t field = field_bit(key);
+    fields |= field;
+    switch (field) {
+    case F_MODE:        return parse_mode(value);
+    case F_DELAY_MIN:   return parse_number(value, GM_MINUTES_MAX_LEN, delay_min) ? nullptr : "invalid delay_min";
+    case F_BOMB_MIN:    return parse_number(value, GM_MINUTES_MAX_LEN, bomb_min) ? nullptr : "invalid bomb_min";
+    case F_GAME_MIN:    return parse_number(value, GM_MINUTES_MAX_LEN, game_min) ? nullptr : "invalid game_min";
+    case F_STANDBY_MIN: return parse_number(value, GM_STANDBY_MAX_LEN, standby_min) ? nullptr : "invalid standby_min";
+    case F_RESPAWN_SEC: return parse_number(value, GM_RESPAWN_MAX_LEN, respawn_sec) ? nullptr : "invalid respawn_sec";
+    case F_USE_SIREN:   return parse_bool(value, use_siren) ? nullptr : "invalid use_siren";
+    case F_START:       return parse_bool(value, start) ? nullptr : "invalid start";
+    case F_BOMB_CODE:
+      // same rules as the keypad: digits only, at most GM_DEFUSAL_MAX_CODE_LEN, empty for the buttons variant
+      if (value.length() > GM_DEFUSAL_MAX_CODE_LEN || value.find_first_not_of("0123456789") != std::string::npos) {
+        return "invalid bomb_code";
+      }
+      bomb_code = value;
+      return nullptr;
+    }
+    return "unknown parameter";
+  }
+
+  // Checks the setup as a whole, after all fields have been set.
+  // Returns nullptr if the setup can be applied, otherwise an error message.
+  const char *validate() const {
+    uint32_t allowed = F_MODE | F_START;
+    switch (mode) {
+    case MODE::NONE:          return "missing mode";
+    case MODE::DEFUSAL:       allowed |= F_DELAY_MIN | F_BOMB_MIN | F_BOMB_CODE; break;
+    case MODE::DOMINATION:    allowed |= F_DELAY_MIN | F_GAME_MIN; break;
+    case MODE::ZONE_CONTROL:  break;
+    case MODE::COUNTDOWN:     allowed |= F_DELAY_MIN | F_GAME_MIN; break;
+    case MODE::RESPAWN_TIMER: allowed |= F_STANDBY_MIN | F_RESPAWN_SEC | F_USE_SIREN; break;
+    }
+    if (fields & ~allowed) {
+      return "parameter not used by this mode";
+    }
+    if (!start) {
+      return nullptr;
+    }
+    // The same checks as the START menu item of each mode
+    switch (mode) {
+    case MODE::DEFUSAL:       return bomb_min ? nullptr : "bomb_min is required";
+    case MODE::DOMINATION:    return game_min ? nullptr : "game_min is required";
+    case MODE::COUNTDOWN:     return game_min ? nullptr : "game_min is required";
+    case MODE::RESPAWN_TIMER:
+      if (!standby_min) {
+        return "standby_min is required";
+      }
+      return respawn_sec ? nullptr : "respawn_sec is required";
+    default: return nullptr;
+    }
+  }
+
+  static const char *mode_name(MODE mode) {
+    switch (mode) {
+    case MODE::DEFUSAL:       return "defusal";
+    case MODE::DOMINATION:    return "domination";
+    case MODE::ZONE_CONTROL:  return "zone_control";
+    case MODE::COUNTDOWN:     return "countdown";
+    case MODE::RESPAWN_TIMER: return "respawn_timer";
+    case MODE::NONE:          break;
+    }
+    return "none";
+  }
+
+private:
+  // Bit per entry of KEYS, in the same order
+  enum FIELD : uint32_t {
+    F_UNKNOWN = 0,
+    F_MODE = 1 << 0,
+    F_DELAY_MIN = 1 << 1,
+    F_BOMB_MIN = 1 << 2,
+    F_BOMB_CODE = 1 << 3,
+    F_GAME_MIN = 1 << 4,
+    F_STANDBY_MIN = 1 << 5,
+    F_RESPAWN_SEC = 1 << 6,
+    F_USE_SIREN = 1 << 7,
+    F_START = 1 << 8,
+  };
+
+  uint32_t fields = 0; // FIELD bits of the fields that were set
+
+  static uint32_t field_bit(const std::string &key) {
+    for (size_t i = 0; i < sizeof(KEYS) / sizeof(KEYS[0]); i++) {
+      if (key == KEYS[i]) {
+        return 1 << i;
+      }
+    }
+    return F_UNKNOWN;
+  }
+
+  const char *parse_mode(const std::string &value) {
+    for (MODE m : {MODE::DEFUSAL, MODE::DOMINATION, MODE::ZONE_CONTROL, MODE::COUNTDOWN, MODE::RESPAWN_TIMER}) {
+      if (value == mode_name(m)) {
+        mode = m;
+        return nullptr;
+      }
+    }
+    return "invalid mode";
+  }
+
+  // Accepts what could be typed on the keypad: 1 to max_len digits.
+  static bool parse_number(const std::string &value, size_t max_len, int &out) {
+    if (value.empty() || value.length() > max_len || value.find_first_not_of("0123456789") != std::string::npos) {
+      return false;
+    }
+    out = std::stoi(value);
+    return true;
+  }
+
+  static bool parse_bool(const std::string &value, bool &out) {
+    if (value == "1" || value == "true" || value == "on") {
+      out = true;
+    } else if (value == "0" || value == "false" || value == "off") {
+      out = false;
+    } else {
+      return false;
+    }
+    return true;
+  }
+};
+
+// Single slot handoff of a GameSetup from the web server task to the game loop. A newer setup replaces one that
+// hasn't been applied yet; the game loop only takes the lock when a setup is pending.
+class GameSetupMailbox {
+public:
+  void post(const GameSetup &setup) {
+    std::lock_guard<std::mutex> lock(mutex);
+    slot = setup;
+    pending.store(true, std::memory_order_release);
+  }
+
+  bool take(GameSetup &setup) {
+    if (!pending.load(std::memory_order_acquire)) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    setup = slot;
+    pending.store(false, std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+  std::mutex mutex;
+  GameSetup slot;
+  std::atomic<bool> pending{false};
+};
+
+inline GameSetupMailbox game_setup_mailbox;
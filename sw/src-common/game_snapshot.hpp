@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+#include "lcd_frame.hpp"
+#include "task_queues.hpp"
+
+// The state of the game as seen from other tasks: the web server, telemetry, anything that isn't the game task.
+//
+// The game manager is only ever called by the game task (game_loop.hpp), its fields change in the middle of a tick and
+// must not be read elsewhere. Instead the game loop publishes a GameSnapshot with each frame, into game_snapshot, and
+// other tasks read a copy of it:
+//
+//   GameSnapshot s = game_snapshot.read();
+//
+// The copy is consistent, all fields are from the same tick, and reading never blocks the game task (task_queues.hpp,
+// SeqLock). Fields a game mode doesn't have are 0.
+
+struct GameSnapshot {
+  enum class MODE : uint8_t { NONE, DEFUSAL, DOMINATION, ZONE_CONTROL, COUNTDOWN, RESPAWN_TIMER, SETTINGS };
+  // The phases all game modes go through. The menu is NONE in MENU, the settings are always in SETUP.
+  enum class STATE : uint8_t { SPLASH, MENU, SETUP, PRE_START, RUNNING, FINISHED };
+
+  MODE mode = MODE::NONE;
+  STATE state = STATE::SPLASH;
+  int8_t team_active = 0; // the team holding the point: 0=no team, 1=red, 2=yellow
+  bool armed = false;     // defusal: the bomb is armed
+  uint32_t clock_ms = 0;  // millis() of the last clock tick of the game
+  int32_t delay_ms = 0;   // PRE_START: until the game starts
+  int32_t game_ms = 0;    // until the game ends: the bomb, domination, timer, the standby or go of the respawn timer
+  uint32_t red_ms = 0;    // domination, zone control: time held by each team
+  uint32_t yellow_ms = 0;
+  // The rows of the display, as LcdFrame
+  char lcd[LCD_CELLS] = {};
+};
+
+// Written by the game task only, see GameLoop::publish()
+inline SeqLock<GameSnapshot> game_snapshot;
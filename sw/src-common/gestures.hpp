@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Gesture recognizer: taps, long holds and chords of the keys, from their timestamped press and release edges.
+//
+// The game modes subscribe to the holds they act on (hold(): "RED held for 5s"), the game manager to its long
+// presses and to keys that are held together (chord(): "D and * held for 10s"). The edges come in with their millis()
+// (press(), release()) and the gestures go out of poll(), in time order:
+//   TAP     - a release before any hold or chord of the key was reached
+//   HOLD    - the key has been down for one of its thresholds; at is exactly the press plus the threshold
+//   RELEASE - every release, with how long the key was down
+//   CHORD   - both keys of a chord down for its threshold, counted from the later press
+// Holds are reached by the clock, not counted per tick: poll() compares the next deadline with now, and
+// next_deadline() tells when it is. A hold that is reached before a release is reported even if no tick came in
+// between. The progress of a hold, for the progress bars, is computed when it is asked for (progress()).
+//
+// Keys without a subscription are not tracked. Everything runs in the main loop, the times are passed in and millis()
+// may wrap.
+
+struct Gesture {
+  enum class TYPE : uint8_t { TAP, HOLD, RELEASE, CHORD };
+
+  TYPE type;
+  unsigned char key; // for CHORD the first key of the chord
+  uint32_t at;       // ms of the edge, or of the deadline for HOLD and CHORD
+  uint32_t ms;       // HOLD and CHORD: the threshold; TAP and RELEASE: how long the key was down
+};
+
+class GestureRecognizer {
+public:
+  static constexpr size_t KEYS = 6;       // keys with subscriptions
+  static constexpr size_t THRESHOLDS = 4; // holds per key
+  static constexpr size_t CHORDS = 2;
+  static constexpr size_t QUEUE = 8; // gestures of edges waiting for poll()
+  // The most gestures poll() gives in a row: the queue, and a hold of every key and every chord
+  static constexpr size_t MAX_DUE = QUEUE + KEYS * THRESHOLDS + CHORDS;
+
+  uint32_t dropped = 0; // gestures lost to a full queue
+
+  // Subscribes to a hold of key for threshold ms. Returns false when the tables are full.
+  bool hold(unsigned char key, uint32_t threshold) {
+    Key *k = track(key);
+    if (!k) {
+      return false;
+    }
+    for (size_t i = 0; i < k->thresholds; i++) {
+      if (k->threshold[i] == threshold) {
+        return true;
+      }
+    }
+    if (k->thresholds == THRESHOLDS) {
+      return false;
+    }
+    k->threshold[k->thresholds++] = threshold;
+    return true;
+  }
+
+  // Subscribes to keys a and b held together for threshold ms. Returns false when the tables are full.
+  bool chord(unsigned char a, unsigned char b, uint32_t threshold) {
+    if (chords == CHORDS || !track(a) || !track(b)) {
+      return false;
+    }
+    chord_table[chords++] = Chord{a, b, threshold, false};
+    return true;
+  }
+
+  void press(unsigned char key, uint32_t at) {
+    Key *k = find(key);
+    if (!k) {
+      return;
+    }
+    // a press of a key that is down starts it over, its release was lost
+    flush(at);
+    k->down = true;
+    k->down_at = k->up_at = at;
+    k->fired = 0;
+    for (size_t i = 0; i < chords; i++) {
+      if (chord_table[i].a == key || chord_table[i].b == key) {
+        chord_table[i].fired = false;
+      }
+    }
+  }
+
+  void release(unsigned char key, uint32_t at) {
+    Key *k = find(key);
+    if (!k || !k->down) {
+      return;
+    }
+    flush(at);
+    k->down = false;
+    k->up_at = at;
+    if (!k->fired) {
+      push(Gesture{Gesture::TYPE::TAP, key, at, at - k->down_at});
+    }
+    push(Gesture{Gesture::TYPE::RELEASE, key, at, at - k->down_at});
+  }
+
+  // Takes the next gesture that is due at now, false if there is none
+  bool poll(uint32_t now, Gesture &g) {
+    if (queued != 0) {
+      g = queue[queue_head];
+      queue_head = (queue_head + 1) % QUEUE;
+      queued--;
+      return true;
+    }
+    return take_deadline(now, g);
+  }
+
+  // The time of the next hold or chord, false if no key is down towards one
+  bool next_deadline(uint32_t &at) const {
+    Deadline d = earliest();
+    at = d.at;
+    return d.found;
+  }
+
+  bool down(unsigned char key) const {
+    const Key *k = find(key);
+    return k && k->down;
+  }
+
+  // How far the last hold of key got towards threshold: up to now while the key is down, up to the release after it
+  float progress(unsigned char key, uint32_t threshold, uint32_t now) const {
+    const Key *k = find(key);
+    if (!k) {
+      return 0.0f;
+    }
+    return ((k->down ? now : k->up_at) - k->down_at) / (float)threshold;
+  }
+
+  // Forgets the keys that are down and the queued gestures, the subscriptions stay
+  void reset() {
+    for (size_t i = 0; i < keys; i++) {
+      key_table[i].down = false;
+      key_table[i].down_at = key_table[i].up_at = 0;
+      key_table[i].fired = 0;
+    }
+    for (size_t i = 0; i < chords; i++) {
+      chord_table[i].fired = false;
+    }
+    queued = 0;
+    dropped = 0;
+  }
+
+private:
+  struct Key {
+    unsigned char key;
+    bool down;
+    uint8_t fired; // bits of the thresholds reached in this press, and CHORD_FIRED
+    uint8_t thresholds;
+    uint32_t threshold[THRESHOLDS];
+    uint32_t down_at;
+    uint32_t up_at;
+  };
+
+  static constexpr uint8_t CHORD_FIRED = 0x80;
+  static_assert(THRESHOLDS < 8, "the fired bits of the thresholds and the chord share a byte");
+
+  struct Chord {
+    unsigned char a;
+    unsigned char b;
+    uint32_t threshold;
+    bool fired;
+  };
+
+  struct Deadline {
+    bool found = false;
+    uint32_t at = 0;
+    Key *key = nullptr;
+    size_t index = 0; // of the threshold, or of the chord when key is null
+  };
+
+  Key key_table[KEYS] = {};
+  size_t keys = 0;
+  Chord chord_table[CHORDS] = {};
+  size_t chords = 0;
+  Gesture queue[QUEUE] = {};
+  size_t queue_head = 0;
+  size_t queued = 0;
+
+  const Key *find(unsigned char key) const {
+    for (size_t i = 0; i < keys; i++) {
+      if (key_table[i].key == key) {
+        return &key_table[i];
+      }
+    }
+    return nullptr;
+  }
+
+  Key *find(unsigned char key) { return const_cast<Key *>(static_cast<const GestureRecognizer *>(this)->find(key)); }
+
+  Key *track(unsigned char key) {
+    Key *k = find(key);
+    if (!k && keys < KEYS) {
+      k = &key_table[keys++];
+      k->key = key;
+    }
+    return k;
+  }
+
+  // a is before b, for times that may wrap
+  static bool before(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+
+  Deadline earliest() const {
+    Deadline d;
+    auto consider = [&](uint32_t at, const Key *key, size_t index) {
+      if (!d.found || before(at, d.at)) {
+        d = Deadline{true, at, const_cast<Key *>(key), index};
+      }
+    };
+    for (size_t i = 0; i < keys; i++) {
+      const Key &k = key_table[i];
+      for (size_t t = 0; k.down && t < k.thresholds; t++) {
+        if (!(k.fired & 1 << t)) {
+          consider(k.down_at + k.threshold[t], &k, t);
+        }
+      }
+    }
+    for (size_t i = 0; i < chords; i++) {
+      const Chord &c = chord_table[i];
+      const Key *a = find(c.a);
+      const Key *b = find(c.b);
+      if (!c.fired && a->down && b->down) {
+        consider((before(a->down_at, b->down_at) ? b->down_at : a->down_at) + c.threshold, nullptr, i);
+      }
+    }
+    return d;
+  }
+
+  // Takes the earliest deadline if it is not after now
+  bool take_deadline(uint32_t now, Gesture &g) {
+    Deadline d = earliest();
+    if (!d.found || before(now, d.at)) {
+      return false;
+    }
+    if (d.key) {
+      d.key->fired |= 1 << d.index;
+      g = Gesture{Gesture::TYPE::HOLD, d.key->key, d.at, d.key->threshold[d.index]};
+    } else {
+      Chord &c = chord_table[d.index];
+      c.fired = true;
+      find(c.a)->fired |= CHORD_FIRED;
+      find(c.b)->fired |= CHORD_FIRED;
+      g = Gesture{Gesture::TYPE::CHORD, c.a, d.at, c.threshold};
+    }
+    return true;
+  }
+
+  // Queues the deadlines up to an edge, so that they come out before the gestures of the edge
+  void flush(uint32_t at) {
+    Gesture g;
+    while (take_deadline(at, g)) {
+      push(g);
+    }
+  }
+
+  void push(const Gesture &g) {
+    if (queued == QUEUE) {
+      dropped++;
+      return;
+    }
+    queue[(queue_head + queued) % QUEUE] = g;
+    queued++;
+  }
+};
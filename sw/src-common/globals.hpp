@@ -3,6 +3,9 @@
 #include <cstdint>
 #include <string>
 
+#include "gestures.hpp"
+#include "task_queues.hpp"
+
 constexpr unsigned char KEY_0 = '0';
 constexpr unsigned char KEY_1 = '1';
 constexpr unsigned char KEY_2 = '2';
@@ -29,6 +32,9 @@ constexpr unsigned char KEY_C_LONG = 'N'; // (n)ew / restart game
 #define ANT_VERSION "2.0.0"
 
 #define GM_DEFUSAL_MAX_CODE_LEN 6 // max defusal bomb code length
+#define GM_MINUTES_MAX_LEN 3      // max digits of game/delay minutes settings
+#define GM_STANDBY_MAX_LEN 3      // max digits of respawn timer standby minutes
+#define GM_RESPAWN_MAX_LEN 2      // max digits of respawn timer respawn seconds
 
 #define HARD_RESET_KEY_HOLD_DURATION 10000
 #define KEY_C_LONG_HOLD_DURATION 10000
@@ -84,14 +90,24 @@ struct ant_settings_t {
   float siren_level = 1.0;
 };
 
+// The actions of a key or a clock tick with their parameters, as the s_handle_actions script of config.yaml runs them
+struct ant_actions_t {
+  uint32_t actions = 0;
+  ant_siren_t siren_params = {};
+  ant_buzzer_t buzzer_params = {};
+  int siren_level_user = 9;
+};
+
+// The access point of the OTA settings, published by the s_start_ota script of config.yaml in the main loop and taken
+// into AntGlobals::ota_info by the game
+inline LatestValue<ant_ota_t> ota_info_updates;
+
 class AntGlobals {
 public:
   uint32_t actions = 0; // bitwise of ACTION_ states
 
-  uint32_t btn_red_pressed = 0;
-  uint32_t btn_red_duration = 0;
-  uint32_t btn_yellow_pressed = 0;
-  uint32_t btn_yellow_duration = 0;
+  // Holds and chords of the buttons and keys, the game modes subscribe to the ones they use
+  GestureRecognizer gestures;
 
   ant_siren_t siren_params = {};
   ant_buzzer_t buzzer_params = {};
@@ -100,6 +116,13 @@ public:
 
   void clear_actions() { actions = 0; }
 
+  // The pending actions, which are cleared
+  ant_actions_t take_actions() {
+    ant_actions_t pending = {actions, siren_params, buzzer_params, settings.siren_level_user};
+    clear_actions();
+    return pending;
+  }
+
   void action_exit_game() { actions |= ACTION_EXIT_GAME; }
 
   void action_siren(int duration = SIREN_DURATION_GAME_START, int delay = 0) {
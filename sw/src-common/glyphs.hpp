@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// The custom characters of the LCD. The game code prints glyph ids, the LCD driver (src-esphome/mycomponents/lcd_burst,
+// glyph_cache.h) keeps the glyphs a frame shows in the 8 CGRAM slots of the HD44780 and uploads the missing ones ahead
+// of the frame. The ids stay the same whichever slot a glyph is in, so more glyphs than slots can be drawn, just not
+// more than 8 in one frame.
+//
+// 1-5 are the progress bars of format_progress_bar() (5 is a full block, which the ROM has), 0x10-0x13 the strokes of
+// the big digits (big_digits.hpp). The LCD mirror sends them escaped (lcd_mirror.hpp), the PC build prints their
+// stand-ins.
+
+// progress bars, 1 to 5 columns lit from the left
+static constexpr uint8_t GLYPH_BAR_1 = 0x01;
+static constexpr uint8_t GLYPH_BAR_2 = 0x02;
+static constexpr uint8_t GLYPH_BAR_3 = 0x03;
+static constexpr uint8_t GLYPH_BAR_4 = 0x04;
+static constexpr uint8_t GLYPH_BAR_5 = 0x05;
+static constexpr uint8_t GLYPH_BLOCK = GLYPH_BAR_5;
+static constexpr uint8_t GLYPH_ARROW = 0x06;
+// big digit strokes: the top 2 pixel rows lit, the bottom 2, both, and a dot in the middle (half of a colon)
+static constexpr uint8_t GLYPH_BIG_TOP = 0x10;
+static constexpr uint8_t GLYPH_BIG_BOTTOM = 0x11;
+static constexpr uint8_t GLYPH_BIG_BOTH = 0x12;
+static constexpr uint8_t GLYPH_BIG_DOT = 0x13;
+
+struct Glyph {
+  uint8_t id;
+  uint8_t rom;     // the ROM character (HD44780 A00) that shows it when no slot is free
+  bool in_rom;     // the ROM character is the glyph itself, it never takes a slot
+  char stand_in;   // printable stand-in for the PC build
+  uint8_t rows[8]; // pixel rows, top first, 5 bits each
+};
+
+inline constexpr Glyph GLYPHS[] = {
+    {GLYPH_BAR_1, '|', false, '1', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10}},
+    {GLYPH_BAR_2, '|', false, '2', {0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18}},
+    {GLYPH_BAR_3, '|', false, '3', {0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c, 0x1c}},
+    {GLYPH_BAR_4, '|', false, '4', {0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e, 0x1e}},
+    {GLYPH_BAR_5, 0xff, true, 'X', {0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f, 0x1f}},
+    {GLYPH_ARROW, 0x7e, false, '>', {0x18, 0x0c, 0x06, 0x1f, 0x1f, 0x06, 0x0c, 0x18}},
+    {GLYPH_BIG_TOP, '-', false, '"', {0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    {GLYPH_BIG_BOTTOM, '_', false, '_', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f}},
+    {GLYPH_BIG_BOTH, '=', false, '=', {0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f}},
+    {GLYPH_BIG_DOT, 0xa5, false, '.', {0x00, 0x00, 0x00, 0x0e, 0x0e, 0x00, 0x00, 0x00}},
+};
+
+// The glyph of a character code, nullptr for the characters of the ROM
+inline const Glyph *find_glyph(uint8_t c) {
+  if (c >= 0x20) {
+    return nullptr;
+  }
+  for (const Glyph &g : GLYPHS) {
+    if (g.id == c) {
+      return &g;
+    }
+  }
+  return nullptr;
+}
+
+// What the PC build prints for a character code
+inline char glyph_stand_in(uint8_t c) {
+  const Glyph *g = find_glyph(c);
+  return g ? g->stand_in : (char)c;
+}
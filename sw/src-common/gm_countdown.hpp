@@ -1,6 +1,10 @@
 #pragma once
 
+#include "game_setup.hpp"
+#include "game_snapshot.hpp"
+#include "big_digits.hpp"
 #include "globals.hpp"
+#include "log_tokens.hpp"
 #include "utilities.hpp"
 
 #ifdef ESP_PLATFORM
@@ -11,7 +15,7 @@
 
 class GameModeCountdown {
 private:
-  static constexpr uint8_t MINUTES_MAX_LEN = 3;
+  static constexpr uint8_t MINUTES_MAX_LEN = GM_MINUTES_MAX_LEN;
 
   enum class STATE { SETUP, INVALID_INPUT, PRE_START, RUNNING, FINISHED };
   enum class MENU { DELAY_MIN, GAME_MIN, START, BACK, COUNT };
@@ -57,7 +61,7 @@ private:
         if (!game_min) {
           state = STATE::INVALID_INPUT;
         } else {
-          ESP_LOGI("GM_countdown", "Starting the game");
+          ANT_LOGI("GM_countdown", "Starting the game");
           start();
         }
       } else if (menu == MENU::BACK) {
@@ -108,8 +112,10 @@ private:
 
   // === RUNNING STATE ===
   void display_started(esphome::lcd_base::LCDDisplay &disp) {
-    disp.printf(0, 0, "  GAME STARTED");
-    disp.printf(0, 1, "     %s", format_time_remaining(game_ms_remaining).c_str());
+    if (!display_big_time(disp, game_ms_remaining)) {
+      disp.printf(0, 0, "  GAME STARTED");
+      disp.printf(0, 1, "     %s", format_time_remaining(game_ms_remaining).c_str());
+    }
   }
 
   void clock_started(uint32_t now, uint32_t delta) {
@@ -130,7 +136,7 @@ private:
     if (key == KEY_C_LONG) {
       antg.action_stop_siren();
       antg.action_buzzer(BUZZER_TONE_SPECIAL, BUZZER_DURATION_SPECIAL);
-      ESP_LOGI("GM_countdown", "Restarting the game");
+      ANT_LOGI("GM_countdown", "Restarting the game");
       start();
     }
   }
@@ -154,6 +160,31 @@ public:
     menu = MENU::DELAY_MIN;
   }
 
+  void apply_setup(const GameSetup &setup) {
+    init();
+    delay_min = setup.delay_min;
+    game_min = setup.game_min;
+    menu = MENU::START;
+    if (setup.start) {
+      ANT_LOGI("GM_countdown", "Starting the game");
+      start();
+    }
+  }
+
+  void snapshot(GameSnapshot &s) const {
+    switch (state) {
+    case STATE::SETUP:
+    case STATE::INVALID_INPUT: s.state = GameSnapshot::STATE::SETUP; break;
+    case STATE::PRE_START:     s.state = GameSnapshot::STATE::PRE_START; break;
+    case STATE::RUNNING:       s.state = GameSnapshot::STATE::RUNNING; break;
+    case STATE::FINISHED:      s.state = GameSnapshot::STATE::FINISHED; break;
+    }
+    if (state == STATE::PRE_START) {
+      s.delay_ms = delay_ms_remaining;
+    }
+    s.game_ms = game_ms_remaining;
+  }
+
   void display_update(esphome::lcd_base::LCDDisplay &disp) {
     switch (state) {
     case STATE::SETUP:         display_setup_menu(disp); break;
@@ -1,8 +1,11 @@
 #pragma once
 
+#include "game_setup.hpp"
+#include "game_snapshot.hpp"
 #include "globals.hpp"
 #include "gm_defusal_buttons.hpp"
 #include "gm_defusal_code.hpp"
+#include "log_tokens.hpp"
 #include "utilities.hpp"
 
 #ifdef ESP_PLATFORM
@@ -16,7 +19,7 @@ class GameModeDefusal {
   // * GameModeDefusalCode, if bomb code was entered
   // * GameModeDefusalButtons, if no bomb code was entered
 private:
-  static constexpr uint32_t MINUTES_MAX_LEN = 3;
+  static constexpr uint32_t MINUTES_MAX_LEN = GM_MINUTES_MAX_LEN;
 
   enum class STATE { SETUP, INVALID_INPUT, PRE_START, DEFUSAL_CODE, DEFUSAL_BUTTONS };
   enum class MENU { DELAY_MIN, BOMB_MIN, BOMB_CODE, START, BACK, COUNT };
@@ -88,7 +91,7 @@ private:
         if (!bomb_min) {
           state = STATE::INVALID_INPUT;
         } else {
-          ESP_LOGI("GM_defusal", "Starting the game");
+          ANT_LOGI("GM_defusal", "Starting the game");
           start_game();
         }
       } else if (menu == MENU::BACK) {
@@ -106,7 +109,7 @@ private:
   }
 
   void handle_key_invalid_input() {
-    ESP_LOGI("GM_defusal_buttons", "INVALID INPUT -> SETUP");
+    ANT_LOGI("GM_defusal_buttons", "INVALID INPUT -> SETUP");
     state = STATE::SETUP;
   }
 
@@ -131,7 +134,7 @@ private:
     case KEY_C_LONG:
       antg.action_stop_siren();
       antg.action_buzzer(BUZZER_TONE_SPECIAL, BUZZER_DURATION_SPECIAL);
-      ESP_LOGI("GM_defusal", "Restarting the game");
+      ANT_LOGI("GM_defusal", "Restarting the game");
       start_game();
       break;
     }
@@ -141,7 +144,7 @@ private:
   void start_game() {
     delay_ms_remaining = delay_min * 60 * 1000;
     if (delay_ms_remaining > 0) {
-      ESP_LOGI("GM_defusal_buttons", "-> PRE START");
+      ANT_LOGI("GM_defusal_buttons", "-> PRE START");
       state = STATE::PRE_START;
     } else {
       start_subgame();
@@ -152,11 +155,11 @@ private:
     last_bomb_buzzer_at = 0;
     bomb_ms_total = bomb_min * 60 * 1000;
     if (bomb_code.empty()) {
-      ESP_LOGI("GM_defusal_buttons", "-> DEFUSAL (BUTTONS)");
+      ANT_LOGI("GM_defusal_buttons", "-> DEFUSAL (BUTTONS)");
       state = STATE::DEFUSAL_BUTTONS;
       gm_defusal_buttons.start_game(bomb_ms_total);
     } else {
-      ESP_LOGI("GM_defusal_buttons", "-> DEFUSAL (CODE)");
+      ANT_LOGI("GM_defusal_buttons", "-> DEFUSAL (CODE)");
       state = STATE::DEFUSAL_CODE;
       gm_defusal_code.start_game(bomb_code, bomb_ms_total);
     }
@@ -188,6 +191,40 @@ public:
     menu = MENU::DELAY_MIN;
   }
 
+  void apply_setup(const GameSetup &setup) {
+    init();
+    delay_min = setup.delay_min;
+    bomb_min = setup.bomb_min;
+    bomb_code = setup.bomb_code;
+    menu = MENU::START;
+    if (setup.start) {
+      ANT_LOGI("GM_defusal", "Starting the game");
+      start_game();
+    }
+  }
+
+  void snapshot(GameSnapshot &s) const {
+    switch (state) {
+    case STATE::SETUP:
+    case STATE::INVALID_INPUT: s.state = GameSnapshot::STATE::SETUP; break;
+    case STATE::PRE_START:
+      s.state = GameSnapshot::STATE::PRE_START;
+      s.delay_ms = delay_ms_remaining;
+      s.game_ms = bomb_min * 60 * 1000;
+      break;
+    case STATE::DEFUSAL_CODE:
+      s.state = gm_defusal_code.finished ? GameSnapshot::STATE::FINISHED : GameSnapshot::STATE::RUNNING;
+      s.armed = gm_defusal_code.armed;
+      s.game_ms = gm_defusal_code.bomb_ms_remaining;
+      break;
+    case STATE::DEFUSAL_BUTTONS:
+      s.state = gm_defusal_buttons.finished ? GameSnapshot::STATE::FINISHED : GameSnapshot::STATE::RUNNING;
+      s.armed = gm_defusal_buttons.armed;
+      s.game_ms = gm_defusal_buttons.bomb_ms_remaining;
+      break;
+    }
+  }
+
   void display_update(esphome::lcd_base::LCDDisplay &disp) {
     switch (state) {
     case STATE::INVALID_INPUT:   display_invalid_input(disp); break;
@@ -237,4 +274,14 @@ public:
       break;
     }
   }
+
+  void handle_gesture(const Gesture &g) {
+    if (state == STATE::DEFUSAL_BUTTONS) {
+      gm_defusal_buttons.handle_gesture(g);
+      // armed by the hold: the bomb buzzer starts in the same loop pass
+      if (gm_defusal_buttons.armed && !gm_defusal_buttons.finished) {
+        bomb_buzzer(100 * (float)gm_defusal_buttons.bomb_ms_remaining / bomb_ms_total, esphome::millis());
+      }
+    }
+  }
 };
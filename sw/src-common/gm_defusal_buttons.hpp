@@ -1,6 +1,8 @@
 #pragma once
 
+#include "big_digits.hpp"
 #include "globals.hpp"
+#include "log_tokens.hpp"
 #include "utilities.hpp"
 
 #ifdef ESP_PLATFORM
@@ -17,7 +19,7 @@ private:
 
   STATE state = STATE::READY;
 
-  uint32_t key_press_at = 0;
+  unsigned char hold_key = 0; // the button held for arming or disarming
 
   void disp_time_left(esphome::lcd_base::LCDDisplay &disp, int32_t bomb_ms_remaining) {
     disp.printf(0, 1, "TIME LEFT:% 6s", format_time_remaining(bomb_ms_remaining).c_str());
@@ -32,8 +34,8 @@ private:
 
   void handle_key_ready(unsigned char key) {
     if (key == KEY_RED || key == KEY_YELLOW) {
-      key_press_at = esphome::millis();
-      ESP_LOGI("GM_defusal_buttons", "READY -> ARMING");
+      hold_key = key;
+      ANT_LOGI("GM_defusal_buttons", "READY -> ARMING");
       state = STATE::ARMING;
     }
   }
@@ -44,23 +46,23 @@ private:
     switch (key) {
     case KEY_RED_RELEASE:
     case KEY_YELLOW_RELEASE:
-      ESP_LOGI("GM_defusal_buttons", "ARMING -> READY");
-      key_press_at = 0;
+      ANT_LOGI("GM_defusal_buttons", "ARMING -> READY");
+      hold_key = 0;
       state = STATE::READY;
       break;
     }
   }
 
   void display_arming(esphome::lcd_base::LCDDisplay &disp) {
-    float ratio = (esphome::millis() - key_press_at) / (float)ARM_TIME;
+    float ratio = antg.gestures.progress(hold_key, ARM_TIME, esphome::millis());
     disp.printf(0, 0, "ARMING % 6s", format_time_remaining(bomb_ms_remaining).c_str());
     disp.printf(0, 1, "%s", format_progress_bar(ratio).c_str());
   }
 
-  void clock_arming(uint32_t now, uint32_t delta) {
-    if (now - key_press_at >= ARM_TIME) {
+  void gesture_arming(const Gesture &g) {
+    if (g.type == Gesture::TYPE::HOLD && g.key == hold_key && g.ms == ARM_TIME) {
       armed = true;
-      ESP_LOGI("GM_defusal_buttons", "ARMING -> ARMED");
+      ANT_LOGI("GM_defusal_buttons", "ARMING -> ARMED");
       state = STATE::ARMED;
     }
   }
@@ -71,22 +73,22 @@ private:
     switch (key) {
     case KEY_RED_RELEASE:
     case KEY_YELLOW_RELEASE:
-      ESP_LOGI("GM_defusal_buttons", "DISARMING -> ARMED");
-      key_press_at = 0;
+      ANT_LOGI("GM_defusal_buttons", "DISARMING -> ARMED");
+      hold_key = 0;
       state = STATE::ARMED;
       break;
     }
   }
 
   void display_disarming(esphome::lcd_base::LCDDisplay &disp) {
-    float ratio = (esphome::millis() - key_press_at) / (float)DISARM_TIME;
+    float ratio = antg.gestures.progress(hold_key, DISARM_TIME, esphome::millis());
     disp.printf(0, 0, "DISARMING% 6s", format_time_remaining(bomb_ms_remaining).c_str());
     disp.printf(0, 1, "%s", format_progress_bar(ratio).c_str());
   }
 
-  void clock_disarming(uint32_t now, uint32_t delta) {
-    if (now - key_press_at >= DISARM_TIME) {
-      ESP_LOGI("GM_defusal_buttons", "DISARMING -> DISARMED");
+  void gesture_disarming(const Gesture &g) {
+    if (g.type == Gesture::TYPE::HOLD && g.key == hold_key && g.ms == DISARM_TIME) {
+      ANT_LOGI("GM_defusal_buttons", "DISARMING -> DISARMED");
       state = STATE::DISARMED;
       armed = false;
       finished = true;
@@ -97,14 +99,17 @@ private:
   // === ARMED STATE ===
 
   void display_armed(esphome::lcd_base::LCDDisplay &disp) {
+    if (big_time_turn(bomb_ms_remaining) && display_big_time(disp, bomb_ms_remaining)) {
+      return;
+    }
     disp.printf(0, 0, "     ARMED      ");
     disp_time_left(disp, bomb_ms_remaining);
   }
 
   void handle_key_armed(unsigned char key) {
     if (key == KEY_RED || key == KEY_YELLOW) {
-      key_press_at = esphome::millis();
-      ESP_LOGI("GM_defusal_buttons", "ARMED -> DISARMING");
+      hold_key = key;
+      ANT_LOGI("GM_defusal_buttons", "ARMED -> DISARMING");
       state = STATE::DISARMING;
     }
   }
@@ -124,7 +129,12 @@ private:
 
 public:
   AntGlobals &antg;
-  GameModeDefusalButtons(AntGlobals &antg) : antg(antg) {}
+  GameModeDefusalButtons(AntGlobals &antg) : antg(antg) {
+    for (unsigned char key : {KEY_RED, KEY_YELLOW}) {
+      antg.gestures.hold(key, ARM_TIME);
+      antg.gestures.hold(key, DISARM_TIME);
+    }
+  }
 
   bool armed = false;
   bool finished = false;
@@ -134,10 +144,10 @@ public:
   void start_game(int32_t bomb_time_ms) {
     armed = false;
     finished = false;
-    ESP_LOGI("GM_defusal_buttons", "START");
+    ANT_LOGI("GM_defusal_buttons", "START");
     state = STATE::READY;
     bomb_ms_remaining = bomb_time_ms;
-    key_press_at = 0;
+    hold_key = 0;
   }
 
   void display_update(esphome::lcd_base::LCDDisplay &disp) {
@@ -166,17 +176,21 @@ public:
     if (armed && !finished) { // bomb timer
       bomb_ms_remaining -= delta;
       if (bomb_ms_remaining <= 0) {
-        ESP_LOGI("GM_defusal_buttons", "EXPLODED");
+        ANT_LOGI("GM_defusal_buttons", "EXPLODED");
         state = STATE::EXPLODED;
         armed = false;
         finished = true;
         antg.action_siren(SIREN_DURATION_GAME_END, SIREN_GAME_END_DELAY);
       }
     }
+  }
+
+  // The holds of the buttons, after the clock of the same loop pass
+  void handle_gesture(const Gesture &g) {
     switch (state) {
     case STATE::READY:     break;
-    case STATE::ARMING:    clock_arming(now, delta); break;
-    case STATE::DISARMING: clock_disarming(now, delta); break;
+    case STATE::ARMING:    gesture_arming(g); break;
+    case STATE::DISARMING: gesture_disarming(g); break;
     case STATE::ARMED:     break;
     case STATE::DISARMED:  break;
     case STATE::EXPLODED:  break;
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "big_digits.hpp"
 #include "globals.hpp"
+#include "log_tokens.hpp"
 #include "utilities.hpp"
 
 #ifdef ESP_PLATFORM
@@ -50,12 +52,12 @@ private:
         if (bomb_code == bomb_code_user) {
           armed = true;
           bomb_code_user = "";
-          ESP_LOGI("GM_defusal_code", "ARM -> ARMED");
+          ANT_LOGI("GM_defusal_code", "ARM -> ARMED");
           state = STATE::ARMED;
         } else {
           bomb_code_user = "";
           bad_code_ms_remaining = BAD_CODE_DISPLAY_MS;
-          ESP_LOGI("GM_defusal_code", "ARM -> BAD CODE");
+          ANT_LOGI("GM_defusal_code", "ARM -> BAD CODE");
           state = STATE::BAD_CODE;
         }
         break;
@@ -72,7 +74,7 @@ private:
   void clock_bad_code(uint32_t now, uint32_t delta) {
     bad_code_ms_remaining -= delta;
     if (bad_code_ms_remaining <= 0) {
-      ESP_LOGI("GM_defusal_code", "BAD_CODE -> ARM");
+      ANT_LOGI("GM_defusal_code", "BAD_CODE -> ARM");
       state = STATE::ARM;
     }
   }
@@ -80,13 +82,17 @@ private:
   void clock_bad_code_armed(uint32_t now, uint32_t delta) {
     bad_code_ms_remaining -= delta;
     if (bad_code_ms_remaining <= 0) {
-      ESP_LOGI("GM_defusal_code", "BAD_CODE_ARMED -> ARMED");
+      ANT_LOGI("GM_defusal_code", "BAD_CODE_ARMED -> ARMED");
       state = STATE::ARMED;
     }
   }
 
   // === ARMED STATE ===
   void display_armed(esphome::lcd_base::LCDDisplay &disp) {
+    // the code being entered stays on the screen
+    if (bomb_code_user.empty() && big_time_turn(bomb_ms_remaining) && display_big_time(disp, bomb_ms_remaining)) {
+      return;
+    }
     disp.printf(0, 0, "ARMED: %s", bomb_code_user.c_str());
     disp_time_left(disp, bomb_ms_remaining);
   }
@@ -108,7 +114,7 @@ private:
         // confirm code
         if (bomb_code == bomb_code_user) {
           bomb_code_user = "";
-          ESP_LOGI("GM_defusal_code", "ARMED -> DISARMED");
+          ANT_LOGI("GM_defusal_code", "ARMED -> DISARMED");
           state = STATE::DISARMED;
           armed = false;
           finished = true;
@@ -116,7 +122,7 @@ private:
         } else {
           bomb_code_user = "";
           bad_code_ms_remaining = BAD_CODE_DISPLAY_MS;
-          ESP_LOGI("GM_defusal_code", "ARMED -> ARMED");
+          ANT_LOGI("GM_defusal_code", "ARMED -> ARMED");
           state = STATE::BAD_CODE_ARMED;
           failed_code_count++;
           switch (failed_code_count) {
@@ -128,7 +134,7 @@ private:
             break;
           default:
             // third failed attempt = bomb explodes
-            ESP_LOGI("GM_defusal_code", "ARMED -> EXPLODED");
+            ANT_LOGI("GM_defusal_code", "ARMED -> EXPLODED");
             state = STATE::EXPLODED;
             armed = false;
             finished = true;
@@ -167,7 +173,7 @@ public:
   void start_game(std::string code, int32_t bomb_time_ms) {
     armed = false;
     finished = false;
-    ESP_LOGI("GM_defusal_code", "START");
+    ANT_LOGI("GM_defusal_code", "START");
     state = STATE::ARM;
     bomb_code = code;
     bomb_code_user = "";
@@ -202,7 +208,7 @@ public:
     if (armed && !finished) { // bomb timer
       bomb_ms_remaining -= delta;
       if (bomb_ms_remaining <= 0) {
-        ESP_LOGI("GM_defusal_code", "EXPLODED");
+        ANT_LOGI("GM_defusal_code", "EXPLODED");
         state = STATE::EXPLODED;
         armed = false;
         finished = true;
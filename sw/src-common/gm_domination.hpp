@@ -1,6 +1,11 @@
 #pragma once
 
+#include "big_digits.hpp"
+#include "fleet_sync.hpp"
+#include "game_setup.hpp"
+#include "game_snapshot.hpp"
 #include "globals.hpp"
+#include "log_tokens.hpp"
 #include "utilities.hpp"
 
 #ifdef ESP_PLATFORM
@@ -12,7 +17,7 @@
 class GameModeDomination {
 private:
   static constexpr uint32_t CAPTURE_TIME = 5000;
-  static constexpr uint8_t MINUTES_MAX_LEN = 3;
+  static constexpr uint8_t MINUTES_MAX_LEN = GM_MINUTES_MAX_LEN;
 
   enum class STATE { SETUP, INVALID_INPUT, PRE_START, RUNNING, FINISHED };
   enum class MENU { DELAY_MIN, GAME_MIN, START, BACK, COUNT };
@@ -29,7 +34,13 @@ private:
   int8_t team_active = 0; // 0=no team, 1=red, 2=yellow
   uint32_t team_red_time = 0;
   uint32_t team_yellow_time = 0;
-  uint32_t capture_start = 0;
+  unsigned char capture_key = 0; // the button that started the capture, 0 without one
+  uint32_t tick_ms = 0;          // the now of the last clock()
+  uint32_t tick_running_ms = 0;  // how much of the last tick was counted as game time
+
+  uint32_t start_count = 0;
+  bool field_score_valid = false; // with fleet sync the team times of all props in the game are shown
+  FleetScore field_score;
 
   // === SETUP STATE ===
   void display_setup_menu(esphome::lcd_base::LCDDisplay &disp) {
@@ -64,7 +75,7 @@ private:
         if (!game_min) {
           state = STATE::INVALID_INPUT;
         } else {
-          ESP_LOGI("GM_domination", "Starting the game");
+          ANT_LOGI("GM_domination", "Starting the game");
           start();
         }
       } else if (menu == MENU::BACK) {
@@ -118,22 +129,22 @@ private:
 
   // === RUNNING STATE ===
   void display_running(esphome::lcd_base::LCDDisplay &disp) {
-    if (capture_start) {
-      float ratio = (esphome::millis() - capture_start) / (float)CAPTURE_TIME;
+    if (capture_key) {
+      float ratio = antg.gestures.progress(capture_key, CAPTURE_TIME, esphome::millis());
       disp.printf(0, 0, "TIME LEFT:% 6s", format_time_remaining(game_ms_remaining).c_str());
       disp.printf(0, 1, "%s", format_progress_bar(ratio).c_str());
-    } else {
+    } else if (!big_time_turn(game_ms_remaining) || !display_big_time(disp, game_ms_remaining)) {
       disp.printf(0, 0, "TIME LEFT:% 6s", format_time_remaining(game_ms_remaining).c_str());
-      disp.printf(0, 1, "T1:%-4d  T2:%-4d", team_red_time / 1000, team_yellow_time / 1000);
+      display_team_times(disp);
     }
   }
 
   void handle_key_running(unsigned char key) {
-    if (!capture_start) {
+    if (!capture_key) {
       if (key == KEY_RED && team_active != 1)
-        capture_start = esphome::millis();
+        capture_key = key;
       else if (key == KEY_YELLOW && team_active != 2)
-        capture_start = esphome::millis();
+        capture_key = key;
     }
   }
 
@@ -149,39 +160,64 @@ private:
     case 1: team_red_time += delta; break;
     case 2: team_yellow_time += delta; break;
     }
+    tick_running_ms = delta;
+  }
 
-    if (capture_start) {
-      if (antg.btn_red_duration >= CAPTURE_TIME) {
-        capture_start = 0;
-        team_active = 1;
-        antg.action_buzzer(BUZZER_TONE, BUZZER_DURATION_TEAM_SWITCH);
-      } else if (antg.btn_yellow_duration >= CAPTURE_TIME) {
-        capture_start = 0;
-        team_active = 2;
-        antg.action_buzzer(BUZZER_TONE, BUZZER_DURATION_TEAM_SWITCH);
-      } else if (!antg.btn_red_pressed && !antg.btn_yellow_pressed) {
-        capture_start = 0;
-      }
+  uint32_t *team_time(int8_t team) { return team == 1 ? &team_red_time : team == 2 ? &team_yellow_time : nullptr; }
+
+  // clock_running() has counted the whole tick for the team that held the zone before, the time from the capture (at,
+  // the edge of the hold) to the end of the tick is the capturing team's
+  void capture(int8_t team, uint32_t at) {
+    uint32_t since = tick_ms - at < tick_running_ms ? tick_ms - at : tick_running_ms;
+    if (uint32_t *time = team_time(team_active)) {
+      *time -= since;
+    }
+    team_active = team;
+    if (uint32_t *time = team_time(team_active)) {
+      *time += since;
+    }
+  }
+
+  void gesture_running(const Gesture &g) {
+    if (!capture_key) {
+      return;
+    }
+    // either button held for the capture time takes the zone, letting go of both gives up
+    if (g.type == Gesture::TYPE::HOLD && g.ms == CAPTURE_TIME && (g.key == KEY_RED || g.key == KEY_YELLOW)) {
+      capture_key = 0;
+      capture(g.key == KEY_RED ? 1 : 2, g.at);
+      antg.action_buzzer(BUZZER_TONE, BUZZER_DURATION_TEAM_SWITCH);
+    } else if (g.type == Gesture::TYPE::RELEASE && !antg.gestures.down(KEY_RED) && !antg.gestures.down(KEY_YELLOW)) {
+      capture_key = 0;
     }
   }
 
   // === FINISHED STATE ===
   void display_finished(esphome::lcd_base::LCDDisplay &disp) {
     disp.printf(0, 0, "DOMINATION ENDED");
-    disp.printf(0, 1, "T1:%-4d  T2:%-4d", team_red_time / 1000, team_yellow_time / 1000);
+    display_team_times(disp);
   }
 
   void handle_key_finished(unsigned char key) {
     if (key == KEY_C_LONG) {
       antg.action_stop_siren();
       antg.action_buzzer(BUZZER_TONE_SPECIAL, BUZZER_DURATION_SPECIAL);
-      ESP_LOGI("GM_domination", "Restarting the game");
+      ANT_LOGI("GM_domination", "Restarting the game");
       start();
     }
   }
 
   // === Common ===
+  void display_team_times(esphome::lcd_base::LCDDisplay &disp) {
+    if (field_score_valid) {
+      disp.printf(0, 1, "T1:%-4d  T2:%-4d", field_score.red_ms / 1000, field_score.yellow_ms / 1000);
+    } else {
+      disp.printf(0, 1, "T1:%-4d  T2:%-4d", team_red_time / 1000, team_yellow_time / 1000);
+    }
+  }
+
   void start() {
+    start_count++;
     delay_ms_remaining = delay_min * 60 * 1000;
     game_ms_remaining = game_min * 60 * 1000;
     team_active = 0;
@@ -196,13 +232,80 @@ private:
 
 public:
   AntGlobals &antg;
-  GameModeDomination(AntGlobals &antg) : antg(antg) {}
+  GameModeDomination(AntGlobals &antg) : antg(antg) {
+    antg.gestures.hold(KEY_RED, CAPTURE_TIME);
+    antg.gestures.hold(KEY_YELLOW, CAPTURE_TIME);
+  }
 
   void init() {
     state = STATE::SETUP;
     menu = MENU::DELAY_MIN;
   }
 
+  void apply_setup(const GameSetup &setup) {
+    init();
+    delay_min = setup.delay_min;
+    game_min = setup.game_min;
+    menu = MENU::START;
+    if (setup.start) {
+      ANT_LOGI("GM_domination", "Starting the game");
+      start();
+    }
+  }
+
+  // === Fleet sync ===
+  // Incremented on every (re)start, so the game manager can announce games started on this prop
+  uint32_t starts() const { return start_count; }
+  uint32_t start_delay_ms() const { return state == STATE::PRE_START ? delay_ms_remaining : 0; }
+  uint16_t game_minutes() const { return game_min; }
+  bool running() const { return state == STATE::RUNNING; }
+
+  FleetPropState fleet_state() const {
+    FleetPropState s;
+    s.team_active = state == STATE::RUNNING ? team_active : 0; // only a running game scores
+    s.red_ms = team_red_time;
+    s.yellow_ms = team_yellow_time;
+    return s;
+  }
+
+  void snapshot(GameSnapshot &s) const {
+    switch (state) {
+    case STATE::SETUP:
+    case STATE::INVALID_INPUT: s.state = GameSnapshot::STATE::SETUP; break;
+    case STATE::PRE_START:     s.state = GameSnapshot::STATE::PRE_START; break;
+    case STATE::RUNNING:       s.state = GameSnapshot::STATE::RUNNING; break;
+    case STATE::FINISHED:      s.state = GameSnapshot::STATE::FINISHED; break;
+    }
+    if (state == STATE::PRE_START) {
+      s.delay_ms = delay_ms_remaining;
+    }
+    s.game_ms = game_ms_remaining;
+    s.team_active = state == STATE::RUNNING ? team_active : 0;
+    s.red_ms = team_red_time;
+    s.yellow_ms = team_yellow_time;
+  }
+
+  // Starts a game announced by another prop. A negative delay joins a game that is already running.
+  void start_synced(int minutes, int32_t delay_ms) {
+    delay_min = 0;
+    game_min = minutes;
+    menu = MENU::START;
+    start();
+    if (delay_ms > 0) {
+      delay_ms_remaining = delay_ms;
+      state = STATE::PRE_START;
+    } else {
+      game_ms_remaining += delay_ms;
+    }
+  }
+
+  void set_field_score(const FleetScore *score) {
+    field_score_valid = score != nullptr;
+    if (score) {
+      field_score = *score;
+    }
+  }
+
   void display_update(esphome::lcd_base::LCDDisplay &disp) {
     switch (state) {
     case STATE::INVALID_INPUT: display_invalid_input(disp); break;
@@ -224,6 +327,8 @@ public:
   }
 
   void clock(uint32_t now, uint32_t delta) {
+    tick_ms = now;
+    tick_running_ms = 0;
     switch (state) {
     case STATE::PRE_START:     clock_pre_start(now, delta); break;
     case STATE::SETUP:         break;
@@ -232,4 +337,11 @@ public:
     case STATE::FINISHED:      break;
     }
   }
+
+  // The gestures of the buttons, after the clock of the same loop pass
+  void handle_gesture(const Gesture &g) {
+    if (state == STATE::RUNNING) {
+      gesture_running(g);
+    }
+  }
 };
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "fleet_sync.hpp"
+#include "game_setup.hpp"
+#include "game_snapshot.hpp"
 #include "globals.hpp"
 #include "gm_countdown.hpp"
 #include "gm_defusal.hpp"
@@ -7,6 +10,9 @@
 #include "gm_respawn_timer.hpp"
 #include "gm_settings.hpp"
 #include "gm_zone_control.hpp"
+#include "input_latency.hpp"
+#include "log_tokens.hpp"
+#include "profiler.hpp"
 
 #ifdef ESP_PLATFORM
 #include "esphome.h"
@@ -14,11 +20,34 @@
 #include "../src-pc/mock_esphome.hpp"
 #endif
 
+// The actions of the game as the s_handle_actions script of config.yaml reads them
+inline ant_actions_t script_actions;
+
+// Runs actions with the s_handle_actions script. In the main loop: directly from the game manager, or from the action
+// queue when the game runs on a task of its own (game_loop.hpp).
+inline void run_actions(const ant_actions_t &actions) {
+  // NOTE
+  // This function directly references the `s_handle_actions` esphome script defined in config.yaml.
+  // This is unsupported by esphome. If it stops working at some point, check the generated
+  // .esphome/build/kms-ant-v2/src/main.cpp for the new signature/name.
+  // Also the esphome definition must be kept in sync with mock_esphome.hpp for the PC build to work.
+  ANT_PROFILE_SCOPE(ProfileSite::ACTIONS);
+  script_actions = actions;
+  s_handle_actions->execute();
+  if (actions.actions & ACTION_START_BUZZER) {
+    input_latency.buzzer(esphome::micros());
+  }
+}
+
+// From the game task to the main loop
+using ActionQueue = SpscQueue<ant_actions_t, 16>;
+
 class GameManager {
 private:
   enum class MODE { DEFUSAL, DOMINATION, ZONE_CONTROL, COUNTDOWN, RESPAWN_TIMER, SETTINGS, COUNT };
   // COUNT is used as a placeholder for the last value and also as an unselected gamemode.
   static constexpr MODE MODE_NONE = MODE::COUNT;
+  static_assert(profile_mode_site(ProfileSite::GAME_CLOCK, (int)MODE_NONE) == ProfileSite::MENU_CLOCK);
 
   enum class STATE { SPLASH, MENU };
   STATE state = STATE::SPLASH;
@@ -35,40 +64,46 @@ private:
   GameModeRespawnTimer gm_respawn_timer;
   GameSettings gm_settings;
 
+  FleetSync fleet;
+  uint32_t domination_starts = 0; // gm_domination.starts() that have been announced to the fleet
+
+  ActionQueue *action_queue = nullptr; // the actions for the main loop, when the game runs on a task of its own
+
   void handle_actions() {
-    // NOTE
-    // This function directly references the `s_handle_actions` esphome script defined in config.yaml.
-    // This is unsupported by esphome. If it stops working at some point, check the generated
-    // .esphome/build/kms-ant-v2/src/main.cpp for the new signature/name.
-    // Also the esphome definition must be kept in sync with mock_esphome.hpp for the PC build to work.
-
-    uint32_t actions = antg.actions;
-    if (actions == 0) {
+    if (antg.actions == 0) {
       return;
     }
+    ant_actions_t pending = antg.take_actions();
+    uint32_t actions = pending.actions;
 
     if (actions & ACTION_EXIT_GAME) {
-      ESP_LOGI("GameManager", "Exiting game");
+      ANT_LOGI("GameManager", "Exiting game");
       current_game = MODE_NONE;
     }
     if (actions & ACTION_START_SIREN) {
-      ant_siren_t *s = &antg.siren_params;
-      ESP_LOGI("GameManager", "Siren for %dms at %dHz level %f with %dms delay", s->duration, s->tone, s->level,
+      ant_siren_t *s = &pending.siren_params;
+      ANT_LOGI("GameManager", "Siren for %dms at %dHz level %f with %dms delay", s->duration, s->tone, s->level,
                s->delay);
     }
     if (actions & ACTION_STOP_SIREN) {
-      ESP_LOGI("GameManager", "Stopping siren");
+      ANT_LOGI("GameManager", "Stopping siren");
     }
     if (actions & ACTION_START_BUZZER) {
-      ant_buzzer_t *b = &antg.buzzer_params;
-      ESP_LOGI("GameManager", "Buzzer for %dms at %dHz", b->duration, b->tone);
+      ant_buzzer_t *b = &pending.buzzer_params;
+      ANT_LOGI("GameManager", "Buzzer for %dms at %dHz", b->duration, b->tone);
     }
     if (actions & ACTION_SAVE_SIREN_LEVEL) {
-      ESP_LOGI("GameManager", "Saving siren level: %f (user level %d)", antg.settings.siren_level,
-               antg.settings.siren_level_user);
+      ANT_LOGI("GameManager", "Saving siren level: %f (user level %d)", antg.settings.siren_level,
+               pending.siren_level_user);
     }
-    s_handle_actions->execute();
-    antg.clear_actions(); // all actions have been handled.
+    if (action_queue != nullptr) {
+      // on the game task the scripts run in the main loop, see game_loop.hpp
+      if (!action_queue->push(pending)) {
+        ANT_LOGW("GameManager", "Action queue full, actions %u dropped", (unsigned)actions);
+      }
+      return;
+    }
+    run_actions(pending);
   }
 
   void display_splash(esphome::lcd_base::LCDDisplay &disp) {
@@ -77,6 +112,7 @@ private:
   }
 
   void display_menu(esphome::lcd_base::LCDDisplay &disp) {
+    ANT_PROFILE_SCOPE(profile_mode_site(ProfileSite::GAME_DISPLAY, (int)current_game));
     switch (current_game) {
     case MODE_NONE:
       // No game activated, render menu
@@ -105,7 +141,7 @@ private:
         disp.print(0, 0, "  Respawn timer");
         disp.print(0, 1, "> Settings");
         break;
-      case MODE_NONE: ESP_LOGW("GameManager", "COUNT menu item should never be selected."); break;
+      case MODE_NONE: ANT_LOGW("GameManager", "COUNT menu item should never be selected."); break;
       }
       break;
     case MODE::DEFUSAL:       gm_defusal.display_update(disp); break;
@@ -141,24 +177,19 @@ private:
     state = STATE::MENU;
   }
 
-  void handle_key_menu(unsigned char key) {
+  void handle_key_menu(unsigned char key, uint32_t at) {
     key_buzzer(key);
 
-    // Long press timings
+    // Edges of the buttons, for their holds
     switch (key) {
-    case KEY_RED:    antg.btn_red_pressed = esphome::millis(); break;
-    case KEY_YELLOW: antg.btn_yellow_pressed = esphome::millis(); break;
-    case KEY_RED_RELEASE:
-      antg.btn_red_pressed = 0;
-      antg.btn_red_duration = 0;
-      break;
-    case KEY_YELLOW_RELEASE:
-      antg.btn_yellow_pressed = 0;
-      antg.btn_yellow_duration = 0;
-      break;
+    case KEY_RED:            antg.gestures.press(KEY_RED, at); break;
+    case KEY_YELLOW:         antg.gestures.press(KEY_YELLOW, at); break;
+    case KEY_RED_RELEASE:    antg.gestures.release(KEY_RED, at); break;
+    case KEY_YELLOW_RELEASE: antg.gestures.release(KEY_YELLOW, at); break;
     }
 
     // Handle keys
+    ANT_PROFILE_SCOPE(profile_mode_site(ProfileSite::GAME_KEY, (int)current_game));
     switch (current_game) {
     case MODE_NONE:
       switch (key) {
@@ -190,35 +221,114 @@ private:
     if (key == KEY_RESET) {
       antg.action_buzzer(BUZZER_TONE_SPECIAL, BUZZER_DURATION_SPECIAL);
       antg.action_stop_siren();
-      ESP_LOGI("GameManager", "Hard reset");
+      ANT_LOGI("GameManager", "Hard reset");
       current_game = MODE_NONE;
     }
   }
 
-  void clock_splash(uint32_t now, uint32_t delta) {
-    if (now - splash_start_time >= 2000) {
-      state = STATE::MENU;
+  void handle_ota_info() {
+    // The access point of the OTA settings, from the s_start_ota script
+    if (ota_info_updates.fresh()) {
+      antg.ota_info = ota_info_updates.read();
     }
   }
 
-  void clock_menu(uint32_t now, uint32_t delta) {
-    if (hard_reset_press_at && now - hard_reset_press_at > HARD_RESET_KEY_HOLD_DURATION) {
-      handle_key(KEY_RESET);
-      hard_reset_press_at = 0;
+  void handle_game_setup() {
+    // Applies a setup posted by the web API (see game_setup.hpp). Whatever is running is replaced, just like after
+    // the organizer reset.
+    GameSetup setup;
+    if (!game_setup_mailbox.take(setup)) {
+      return;
+    }
+
+    MODE mode = MODE_NONE;
+    switch (setup.mode) {
+    case GameSetup::MODE::DEFUSAL:       mode = MODE::DEFUSAL; break;
+    case GameSetup::MODE::DOMINATION:    mode = MODE::DOMINATION; break;
+    case GameSetup::MODE::ZONE_CONTROL:  mode = MODE::ZONE_CONTROL; break;
+    case GameSetup::MODE::COUNTDOWN:     mode = MODE::COUNTDOWN; break;
+    case GameSetup::MODE::RESPAWN_TIMER: mode = MODE::RESPAWN_TIMER; break;
+    case GameSetup::MODE::NONE:          return;
+    }
+
+    ANT_LOGI("GameManager", "Remote setup: %s%s", GameSetup::mode_name(setup.mode), setup.start ? " (start)" : "");
+    antg.action_stop_siren();
+    antg.action_buzzer(BUZZER_TONE_SPECIAL, BUZZER_DURATION_SPECIAL);
+    state = STATE::MENU;
+    menu = mode;
+    current_game = mode;
+    switch (mode) {
+    case MODE::DEFUSAL:       gm_defusal.apply_setup(setup); break;
+    case MODE::DOMINATION:    gm_domination.apply_setup(setup); break;
+    case MODE::ZONE_CONTROL:  gm_zone_control.apply_setup(setup); break;
+    case MODE::COUNTDOWN:     gm_countdown.apply_setup(setup); break;
+    case MODE::RESPAWN_TIMER: gm_respawn_timer.apply_setup(setup); break;
+    default:                  break;
+    }
+  }
+
+  void clock_fleet(uint32_t now) {
+    // Shares the domination game with the other props on the field, see fleet_sync.hpp
+    if (!fleet.active()) {
       return;
     }
-    if (key_c_press_at && now - key_c_press_at > KEY_C_LONG_HOLD_DURATION) {
-      handle_key(KEY_C_LONG);
-      key_c_press_at = 0;
+    if (gm_domination.starts() != domination_starts) {
+      domination_starts = gm_domination.starts();
+      fleet.announce_game(now, gm_domination.start_delay_ms(), gm_domination.game_minutes());
     }
+    fleet.set_state(gm_domination.fleet_state());
+    fleet.clock(now);
 
-    if (antg.btn_red_pressed) {
-      antg.btn_red_duration = now - antg.btn_red_pressed;
+    FleetGame game;
+    if (fleet.take_game(game)) {
+      int32_t delay_ms = (int32_t)(game.start_at - fleet.shared_time(now));
+      // Only props that are idle or already playing domination join, a prop set up for another game is left alone
+      bool joinable = current_game == MODE_NONE || current_game == MODE::DOMINATION;
+      if (joinable && delay_ms + game.game_min * 60 * 1000 > 0) {
+        ANT_LOGI("GameManager", "Fleet game from %08x, starts in %dms", (unsigned)game.origin, (int)delay_ms);
+        antg.action_stop_siren();
+        antg.action_buzzer(BUZZER_TONE_SPECIAL, BUZZER_DURATION_SPECIAL);
+        state = STATE::MENU;
+        menu = MODE::DOMINATION;
+        current_game = MODE::DOMINATION;
+        gm_domination.start_synced(game.game_min, delay_ms);
+        domination_starts = gm_domination.starts();
+      }
     }
-    if (antg.btn_yellow_pressed) {
-      antg.btn_yellow_duration = now - antg.btn_yellow_pressed;
+
+    if (fleet.peer_count()) {
+      FleetScore score = fleet.field_score(now);
+      gm_domination.set_field_score(&score);
+    } else {
+      gm_domination.set_field_score(nullptr);
     }
+  }
 
+  void clock_splash(uint32_t now, uint32_t delta) {
+    if (now - splash_start_time >= 2000) {
+      state = STATE::MENU;
+    }
+  }
+
+  void clock_menu(uint32_t now, uint32_t delta) {
+    // The gestures that are due: the organizer's act first, the game mode gets its own after its clock
+    Gesture due[GestureRecognizer::MAX_DUE];
+    size_t due_count = 0;
+    Gesture g;
+    while (antg.gestures.poll(now, g)) {
+      bool hold = g.type == Gesture::TYPE::HOLD;
+      if (g.type == Gesture::TYPE::CHORD && g.key == KEY_D && g.ms == HARD_RESET_KEY_HOLD_DURATION) {
+        handle_key(KEY_RESET);
+        return;
+      }
+      if (hold && g.key == KEY_C && g.ms == KEY_C_LONG_HOLD_DURATION) {
+        handle_key(KEY_C_LONG);
+      } else if (due_count < GestureRecognizer::MAX_DUE) {
+        due[due_count++] = g;
+      }
+    }
+
+    ANT_PROFILE_SCOPE(profile_mode_site(ProfileSite::GAME_CLOCK, (int)current_game));
     switch (current_game) {
     case MODE::DEFUSAL:       gm_defusal.clock(now, delta); break;
     case MODE::DOMINATION:    gm_domination.clock(now, delta); break;
@@ -228,38 +338,97 @@ private:
     case MODE::SETTINGS:      gm_settings.clock(now, delta); break;
     case MODE_NONE:           break;
     }
+    for (size_t i = 0; i < due_count; i++) {
+      switch (current_game) {
+      case MODE::DEFUSAL:      gm_defusal.handle_gesture(due[i]); break;
+      case MODE::DOMINATION:   gm_domination.handle_gesture(due[i]); break;
+      case MODE::ZONE_CONTROL: gm_zone_control.handle_gesture(due[i]); break;
+      default:                 break;
+      }
+    }
 
     clock_last_update_ms = now;
   }
 
 public:
-  int hard_reset_press_at = 0;
-  int key_c_press_at = 0;
-
   int clock_last_update_ms = 0;
 
   GameManager(AntGlobals &antg)
       : antg(antg), gm_defusal(antg), gm_domination(antg), gm_zone_control(antg), gm_countdown(antg),
         gm_respawn_timer(antg), gm_settings(antg) {
     splash_start_time = esphome::millis();
+    antg.gestures.hold(KEY_C, KEY_C_LONG_HOLD_DURATION);
+    // The organizer reset is D and * held together, a chord no game mode uses
+    antg.gestures.chord(KEY_D, KEY_STAR, HARD_RESET_KEY_HOLD_DURATION);
+  }
+
+  // Enables fleet sync. node_id must be unique on the field and not 0.
+  void attach_fleet(FleetTransport *transport, uint32_t node_id) { fleet.begin(transport, node_id); }
+  const FleetSync &fleet_sync() const { return fleet; }
+
+  // Queues the actions for the main loop instead of running the scripts, for the game task (game_loop.hpp)
+  void attach_action_queue(ActionQueue *queue) { action_queue = queue; }
+
+  // The state of the game for other tasks (game_snapshot.hpp), all but the display
+  void snapshot(GameSnapshot &s) const {
+    s.clock_ms = clock_last_update_ms;
+    if (state == STATE::SPLASH) {
+      s.state = GameSnapshot::STATE::SPLASH;
+      return;
+    }
+    switch (current_game) {
+    case MODE::DEFUSAL:       s.mode = GameSnapshot::MODE::DEFUSAL; gm_defusal.snapshot(s); break;
+    case MODE::DOMINATION:    s.mode = GameSnapshot::MODE::DOMINATION; gm_domination.snapshot(s); break;
+    case MODE::ZONE_CONTROL:  s.mode = GameSnapshot::MODE::ZONE_CONTROL; gm_zone_control.snapshot(s); break;
+    case MODE::COUNTDOWN:     s.mode = GameSnapshot::MODE::COUNTDOWN; gm_countdown.snapshot(s); break;
+    case MODE::RESPAWN_TIMER: s.mode = GameSnapshot::MODE::RESPAWN_TIMER; gm_respawn_timer.snapshot(s); break;
+    case MODE::SETTINGS:
+      s.mode = GameSnapshot::MODE::SETTINGS;
+      s.state = GameSnapshot::STATE::SETUP;
+      break;
+    case MODE_NONE: s.state = GameSnapshot::STATE::MENU; break;
+    }
   }
 
   void display_update(esphome::lcd_base::LCDDisplay &disp) {
+    ANT_PROFILE_SCOPE(ProfileSite::GAME_DISPLAY);
     switch (state) {
     case STATE::SPLASH: display_splash(disp); break;
     case STATE::MENU:   display_menu(disp); break;
     }
   }
 
-  void handle_key(unsigned char key) {
+  // Press and release of the keypad keys, at the millis() the keypad saw them (on_edge of config.yaml). Only the keys
+  // with long presses are tracked: C, and D and * for the organizer reset. Their taps come with handle_key().
+  void handle_key_edge(unsigned char key, bool down, uint32_t at) {
+    if (down) {
+      antg.gestures.press(key, at);
+    } else {
+      antg.gestures.release(key, at);
+    }
+  }
+
+  void handle_key_edge(unsigned char key, bool down) { handle_key_edge(key, down, esphome::millis()); }
+
+  // A key, at the millis() its automation reported it: the press and release of the buttons are edges for their holds
+  // too, like the ones of handle_key_edge()
+  void handle_key(unsigned char key, uint32_t at) {
+    ANT_PROFILE_SCOPE(ProfileSite::GAME_KEY);
+    input_latency.key(esphome::micros());
     switch (state) {
     case STATE::SPLASH: handle_key_splash(key); break;
-    case STATE::MENU:   handle_key_menu(key); break;
+    case STATE::MENU:   handle_key_menu(key, at); break;
     }
     handle_actions();
   }
 
+  void handle_key(unsigned char key) { handle_key(key, esphome::millis()); }
+
   void clock(uint32_t now, uint32_t delta) {
+    ANT_PROFILE_SCOPE(ProfileSite::GAME_CLOCK);
+    handle_game_setup();
+    handle_ota_info();
+    clock_fleet(now);
     switch (state) {
     case STATE::SPLASH: clock_splash(now, delta); break;
     case STATE::MENU:   clock_menu(now, delta); break;
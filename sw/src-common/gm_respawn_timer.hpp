@@ -1,5 +1,7 @@
 #pragma once
 
+#include "game_setup.hpp"
+#include "game_snapshot.hpp"
 #include "globals.hpp"
 #include "utilities.hpp"
 
@@ -11,8 +13,8 @@
 
 class GameModeRespawnTimer {
 private:
-  static constexpr uint16_t STANDBY_MAX_LEN = 3;
-  static constexpr uint8_t RESPAWN_MAX_LEN = 2;
+  static constexpr uint16_t STANDBY_MAX_LEN = GM_STANDBY_MAX_LEN;
+  static constexpr uint8_t RESPAWN_MAX_LEN = GM_RESPAWN_MAX_LEN;
 
   enum class STATE { SETUP, INVALID_INPUT_STANDBY, INVALID_INPUT_RESPAWN, GAME_STANDBY, GAME_RESPAWN };
   enum class MENU { STANDBY_MIN, RESPAWN_SEC, USE_SIREN, START, BACK, COUNT };
@@ -181,6 +183,33 @@ public:
     go_time_remaining = 0;
   }
 
+  void apply_setup(const GameSetup &setup) {
+    init();
+    standby_min = setup.standby_min;
+    respawn_sec = setup.respawn_sec;
+    use_siren = setup.use_siren;
+    menu = MENU::START;
+    if (setup.start) {
+      start_game_standby();
+    }
+  }
+
+  void snapshot(GameSnapshot &s) const {
+    switch (state) {
+    case STATE::SETUP:
+    case STATE::INVALID_INPUT_STANDBY:
+    case STATE::INVALID_INPUT_RESPAWN: s.state = GameSnapshot::STATE::SETUP; break;
+    case STATE::GAME_STANDBY:
+      s.state = GameSnapshot::STATE::RUNNING;
+      s.game_ms = standby_time_remaining;
+      break;
+    case STATE::GAME_RESPAWN:
+      s.state = GameSnapshot::STATE::RUNNING;
+      s.game_ms = go_time_remaining;
+      break;
+    }
+  }
+
   void display_update(esphome::lcd_base::LCDDisplay &disp) {
     switch (state) {
     case STATE::SETUP:                 display_setup(disp); break;
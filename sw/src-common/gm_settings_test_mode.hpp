@@ -1,6 +1,7 @@
 #pragma once
 
 #include "globals.hpp"
+#include "input_latency.hpp"
 
 #ifdef ESP_PLATFORM
 #include "esphome.h"
@@ -27,10 +28,15 @@ public:
   }
 
   void display_update(esphome::lcd_base::LCDDisplay &disp) {
-    disp.printf(0, 0, "   TEST  MENU   ");
     if (input != ' ') {
-      disp.printf(0, 1, "Key: %c", input);
+      // The latencies of the last key that has reached the LCD (see input_latency.hpp): the key on the screen is
+      // being drawn, its own show after the next redraw.
+      const std::atomic<uint32_t> *last = input_latency.last_us;
+      disp.printf(0, 0, "Key:%c lcd%4.1fms", input, last[(int)InputLatency::SPAN::KEY_TO_LCD] / 1000.0f);
+      disp.printf(0, 1, "in%4.1f bz%4.1fms", last[(int)InputLatency::SPAN::EDGE_TO_KEY] / 1000.0f,
+                  last[(int)InputLatency::SPAN::KEY_TO_BUZZER] / 1000.0f);
     } else {
+      disp.printf(0, 0, "   TEST  MENU   ");
       disp.printf(0, 1, "");
     }
   }
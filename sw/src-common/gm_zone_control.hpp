@@ -1,5 +1,7 @@
 #pragma once
 
+#include "game_setup.hpp"
+#include "game_snapshot.hpp"
 #include "globals.hpp"
 #include "utilities.hpp"
 
@@ -23,7 +25,9 @@ private:
 
   uint32_t team_red_time = 0;
   uint32_t team_yellow_time = 0;
-  uint32_t capture_start = 0;
+  unsigned char capture_key = 0; // the button that started the capture
+  uint32_t tick_ms = 0;          // the now and delta of the last clock()
+  uint32_t tick_delta = 0;
 
   // === SETUP STATE ===
   void display_setup(esphome::lcd_base::LCDDisplay &disp) {
@@ -60,30 +64,26 @@ private:
   void handle_key_scoreboard(unsigned char key) {
     if (key == KEY_RED && team_active != TEAM::RED) {
       state = STATE::CAPTURING;
-      capture_start = esphome::millis();
+      capture_key = key;
     } else if (key == KEY_YELLOW && team_active != TEAM::YELLOW) {
       state = STATE::CAPTURING;
-      capture_start = esphome::millis();
+      capture_key = key;
     }
   }
 
   // === CAPTURING STATE ===
   void display_capturing(esphome::lcd_base::LCDDisplay &disp) {
-    float ratio = (esphome::millis() - capture_start) / (float)CAPTURE_TIME;
+    float ratio = antg.gestures.progress(capture_key, CAPTURE_TIME, esphome::millis());
     disp.printf(0, 0, "   CAPTURING   ");
     disp.printf(0, 1, "%s", format_progress_bar(ratio).c_str());
   }
 
-  void clock_capturing(uint32_t now, uint32_t delta) {
-    if (antg.btn_red_duration >= CAPTURE_TIME) {
+  void gesture_capturing(const Gesture &g) {
+    if (g.type == Gesture::TYPE::HOLD && g.ms == CAPTURE_TIME && (g.key == KEY_RED || g.key == KEY_YELLOW)) {
       state = STATE::SCOREBOARD;
-      team_active = TEAM::RED;
+      capture(g.key == KEY_RED ? TEAM::RED : TEAM::YELLOW, g.at);
       antg.action_buzzer(BUZZER_TONE, BUZZER_DURATION_TEAM_SWITCH);
-    } else if (antg.btn_yellow_duration >= CAPTURE_TIME) {
-      state = STATE::SCOREBOARD;
-      team_active = TEAM::YELLOW;
-      antg.action_buzzer(BUZZER_TONE, BUZZER_DURATION_TEAM_SWITCH);
-    } else if (!antg.btn_red_pressed && !antg.btn_yellow_pressed) {
+    } else if (g.type == Gesture::TYPE::RELEASE && !antg.gestures.down(KEY_RED) && !antg.gestures.down(KEY_YELLOW)) {
       state = STATE::SCOREBOARD;
     }
   }
@@ -97,9 +97,29 @@ private:
     }
   }
 
+  uint32_t *team_time(TEAM team) {
+    return team == TEAM::RED ? &team_red_time : team == TEAM::YELLOW ? &team_yellow_time : nullptr;
+  }
+
+  // clock() has counted the whole tick for the team that held the zone before, the time from the capture (at, the
+  // edge of the hold) to the end of the tick is the capturing team's
+  void capture(TEAM team, uint32_t at) {
+    uint32_t since = tick_ms - at < tick_delta ? tick_ms - at : tick_delta;
+    if (uint32_t *time = team_time(team_active)) {
+      *time -= since;
+    }
+    team_active = team;
+    if (uint32_t *time = team_time(team_active)) {
+      *time += since;
+    }
+  }
+
 public:
   AntGlobals &antg;
-  GameModeZoneControl(AntGlobals &antg) : antg(antg) {}
+  GameModeZoneControl(AntGlobals &antg) : antg(antg) {
+    antg.gestures.hold(KEY_RED, CAPTURE_TIME);
+    antg.gestures.hold(KEY_YELLOW, CAPTURE_TIME);
+  }
 
   void init() {
     menu = MENU::START;
@@ -109,6 +129,20 @@ public:
     team_yellow_time = 0;
   }
 
+  void apply_setup(const GameSetup &setup) {
+    init();
+    if (setup.start) {
+      state = STATE::SCOREBOARD;
+    }
+  }
+
+  void snapshot(GameSnapshot &s) const {
+    s.state = state == STATE::SETUP ? GameSnapshot::STATE::SETUP : GameSnapshot::STATE::RUNNING;
+    s.team_active = (int8_t)team_active;
+    s.red_ms = team_red_time;
+    s.yellow_ms = team_yellow_time;
+  }
+
   void display_update(esphome::lcd_base::LCDDisplay &disp) {
     switch (state) {
     case STATE::SETUP:      display_setup(disp); break;
@@ -126,12 +160,15 @@ public:
   }
 
   void clock(uint32_t now, uint32_t delta) {
+    tick_ms = now;
+    tick_delta = delta;
     update_team_time(delta);
+  }
 
-    switch (state) {
-    case STATE::SETUP:      break;
-    case STATE::CAPTURING:  clock_capturing(now, delta); break;
-    case STATE::SCOREBOARD: break;
+  // The gestures of the buttons, after the clock of the same loop pass
+  void handle_gesture(const Gesture &g) {
+    if (state == STATE::CAPTURING) {
+      gesture_capturing(g);
     }
   }
 };
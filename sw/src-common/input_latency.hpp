@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "profiler.hpp"
+
+// Input latency: how long a key takes to reach the game, the buzzer and the LCD.
+//
+// A key is traced through four points:
+//   edge    - the input automation of config.yaml fired (on_press of the buttons, on_key of the keypads) and queued
+//             the key for the game task (game_loop.hpp)
+//   key     - GameManager::handle_key() started, in the game task
+//   buzzer  - the s_handle_actions script returned after starting the buzzer for the key, in the main loop
+//   lcd     - the display update of the frame with the key returned, i.e. the I2C writes are done
+// and the spans edge -> key, key -> buzzer and key -> lcd are kept as histograms in microseconds (the histograms of
+// profiler.hpp). Keys that don't buzz have no key -> buzzer sample, neither do keys whose buzzer only starts after
+// the LCD; keys that come from the game itself (the long presses of the clock) have no edge. A key that comes while
+// one is still on its way to the LCD is not traced on its own: the first one, which waited longer, is the one the
+// player sees.
+//
+// The trace is always compiled in, it is a few calls per key. The game task records edge and key, the main loop
+// buzzer and lcd. The key in flight is handed over with an atomic state: only key() starts one, when none is pending,
+// and only the main loop ends it, so its time is never written while the main loop reads it. Each histogram has a
+// single writer, readers in other tasks may see a histogram half-recorded; the latest samples are atomic. The PC build
+// runs it on the virtual clock (esphome::micros() of mock_esphome.hpp), where every span is expected to be 0.
+
+class InputLatency {
+public:
+  enum class SPAN { EDGE_TO_KEY, KEY_TO_BUZZER, KEY_TO_LCD, COUNT };
+
+  // One header line, the column names and a line per span
+  static constexpr size_t MAX_TEXT = ProfileHistogram::LINE * (static_cast<size_t>(SPAN::COUNT) + 2);
+
+  ProfileHistogram spans[static_cast<size_t>(SPAN::COUNT)];
+  std::atomic<uint32_t> last_us[static_cast<size_t>(SPAN::COUNT)] = {}; // latest sample of each span
+
+  // Game task
+  void edge(uint32_t now_us) {
+    edge_at = now_us;
+    edge_pending = true;
+  }
+
+  // Game task
+  void key(uint32_t now_us) {
+    if (edge_pending) {
+      record(SPAN::EDGE_TO_KEY, now_us - edge_at);
+      edge_pending = false;
+    }
+    if (pending.load(std::memory_order_acquire) == 0) {
+      key_at.store(now_us, std::memory_order_relaxed);
+      pending.store(PENDING_KEY | PENDING_BUZZER, std::memory_order_release);
+    }
+  }
+
+  // Main loop
+  void buzzer(uint32_t now_us) {
+    if (pending.load(std::memory_order_acquire) == (PENDING_KEY | PENDING_BUZZER)) {
+      record(SPAN::KEY_TO_BUZZER, now_us - key_at.load(std::memory_order_relaxed));
+      pending.store(PENDING_KEY, std::memory_order_release);
+    }
+  }
+
+  // Main loop
+  void lcd(uint32_t now_us) {
+    if (pending.load(std::memory_order_acquire) & PENDING_KEY) {
+      record(SPAN::KEY_TO_LCD, now_us - key_at.load(std::memory_order_relaxed));
+      pending.store(0, std::memory_order_release);
+    }
+  }
+
+  const ProfileHistogram &span(SPAN s) const { return spans[static_cast<size_t>(s)]; }
+
+  void reset() {
+    for (size_t i = 0; i < static_cast<size_t>(SPAN::COUNT); i++) {
+      spans[i] = ProfileHistogram();
+      last_us[i] = 0;
+    }
+    edge_pending = false;
+    pending = 0;
+  }
+
+  // Writes the spans as a table in microseconds into out (NUL terminated, MAX_TEXT bytes are always enough, with less
+  // the table is cut). Returns the length of the text.
+  size_t format(char *out, size_t size) const {
+    static const char *const NAMES[] = {"edge_to_key", "key_to_buzzer", "key_to_lcd"};
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<size_t>(SPAN::COUNT));
+    size_t len = ProfileHistogram::append(out, size, 0, "%s\n", "# input latency since boot, in us");
+    len = ProfileHistogram::format_columns(out, size, len, "span");
+    for (size_t i = 0; i < static_cast<size_t>(SPAN::COUNT); i++) {
+      len = spans[i].format_row(out, size, len, NAMES[i], 1.0f);
+    }
+    return len;
+  }
+
+private:
+  static constexpr uint8_t PENDING_KEY = 1;    // a key is on its way to the LCD
+  static constexpr uint8_t PENDING_BUZZER = 2; // and hasn't buzzed yet
+
+  uint32_t edge_at = 0; // game task only, like edge_pending
+  bool edge_pending = false;
+  std::atomic<uint32_t> key_at{0};
+  std::atomic<uint8_t> pending{0}; // PENDING_KEY and PENDING_BUZZER, 0 when no key is on its way
+
+  void record(SPAN s, uint32_t us) {
+    spans[static_cast<size_t>(s)].record(us);
+    last_us[static_cast<size_t>(s)].store(us, std::memory_order_relaxed);
+  }
+};
+
+inline InputLatency input_latency;
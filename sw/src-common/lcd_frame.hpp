@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// A copy of the 16x2 LCD contents, for showing the display of a prop to web clients.
+//
+// Cells hold the raw character codes as printed by the game modes, including the glyph ids of glyphs.hpp (progress
+// bars, big digits). Clients are sent diffs against the last frame they got:
+//
+//   diff = run...   run = position (row * 16 + column), length, characters
+//
+// An unchanged gap of up to RUN_HEADER cells is sent as part of the surrounding run, as that is never longer than
+// starting a new one. The diff of a frame against nothing is a single run over the whole display.
+
+static constexpr size_t LCD_COLS = 16;
+static constexpr size_t LCD_ROWS = 2;
+static constexpr size_t LCD_CELLS = LCD_COLS * LCD_ROWS;
+
+struct LcdFrame {
+  static constexpr size_t RUN_HEADER = 2;
+  // Longest diff: the full frame
+  static constexpr size_t MAX_DIFF = RUN_HEADER + LCD_CELLS;
+
+  char cells[LCD_CELLS];
+
+  LcdFrame() { clear(); }
+
+  void clear() { memset(cells, ' ', LCD_CELLS); }
+
+  bool operator==(const LcdFrame &other) const { return memcmp(cells, other.cells, LCD_CELLS) == 0; }
+  bool operator!=(const LcdFrame &other) const { return !(*this == other); }
+
+  // Encodes the changes from prev (nullptr = nothing shown yet) into out (MAX_DIFF bytes). Returns the length, 0 if
+  // nothing changed.
+  size_t diff(const LcdFrame *prev, uint8_t *out) const {
+    if (!prev) {
+      out[0] = 0;
+      out[1] = LCD_CELLS;
+      memcpy(out + RUN_HEADER, cells, LCD_CELLS);
+      return MAX_DIFF;
+    }
+    size_t len = 0;
+    size_t i = 0;
+    while (i < LCD_CELLS) {
+      if (cells[i] == prev->cells[i]) {
+        i++;
+        continue;
+      }
+      // a run from the first changed cell to the last one that is followed by more than RUN_HEADER unchanged cells
+      size_t start = i, end = i + 1;
+      for (size_t j = end; j < LCD_CELLS && j - end <= RUN_HEADER; j++) {
+        if (cells[j] != prev->cells[j]) {
+          end = j + 1;
+        }
+      }
+      if (len + RUN_HEADER + (end - start) > MAX_DIFF) {
+        return diff(nullptr, out); // scattered changes, the full frame is shorter
+      }
+      out[len++] = start;
+      out[len++] = end - start;
+      memcpy(out + len, cells + start, end - start);
+      len += end - start;
+      i = end;
+    }
+    return len;
+  }
+
+  // Applies a diff made by diff(). Returns false (leaving the frame partly updated) if it is malformed.
+  bool apply(const uint8_t *data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+      if (len - i < RUN_HEADER) {
+        return false;
+      }
+      size_t pos = data[i], n = data[i + 1];
+      i += RUN_HEADER;
+      if (n == 0 || pos + n > LCD_CELLS || len - i < n) {
+        return false;
+      }
+      memcpy(cells + pos, data + i, n);
+      i += n;
+    }
+    return true;
+  }
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "lcd_frame.hpp"
+
+// LCD mirror: the display of a prop streamed to spectators as `lcd` events of the web server's event source.
+//
+// Server-sent events are text, so the diffs of lcd_frame.hpp are sent as text:
+//
+//   event = run...   run = position, length, characters
+//
+// Position and length are one character each, '0' + value ('0' to 'P'). Characters are sent as they are, except the
+// glyphs (glyphs.hpp), sent as '\' followed by '0' + id for 0-7 and '@' + id - 0x10 for 0x10-0x17, and '\' itself,
+// sent as "\\". Any other character outside printable ASCII is sent as '?'.
+//
+// Each viewer is sent the changes since the last frame it acknowledged, i.e. the last event that could be queued for
+// it. A viewer that doesn't keep up gets fewer, larger events instead of a backlog. Events to one viewer are at least
+// the interval of the FPS limit apart; a change that comes sooner is sent together with the next one.
+
+class LcdMirror {
+public:
+  // Longest event: the full frame with every cell escaped, NUL terminated
+  static constexpr size_t MAX_TEXT = LcdFrame::RUN_HEADER + 2 * LCD_CELLS + 1;
+
+  explicit LcdMirror(uint32_t interval_ms = 0) : interval_ms(interval_ms) {}
+
+  // The next event carries the full display
+  void reset() { synced = false; }
+
+  // Writes the changes of frame since the last acknowledged one into out (MAX_TEXT bytes, NUL terminated).
+  // Returns the length, 0 if there is nothing to send yet.
+  size_t update(const LcdFrame &frame, uint32_t now, char *out) {
+    if (synced && now - acked_at < interval_ms) {
+      return 0;
+    }
+    uint8_t diff[LcdFrame::MAX_DIFF];
+    size_t len = frame.diff(synced ? &acked : nullptr, diff);
+    if (len == 0) {
+      return 0;
+    }
+    pending = frame;
+    pending_at = now;
+    return encode(diff, len, out);
+  }
+
+  // The event of the last update() was queued for the viewer
+  void acknowledge() {
+    acked = pending;
+    acked_at = pending_at;
+    synced = true;
+  }
+
+  // Text form of a diff made by LcdFrame::diff(), see above
+  static size_t encode(const uint8_t *diff, size_t len, char *out) {
+    size_t n = 0;
+    size_t i = 0;
+    while (i < len) {
+      size_t cells = diff[i + 1];
+      out[n++] = '0' + diff[i];
+      out[n++] = '0' + cells;
+      for (size_t j = 0; j < cells; j++) {
+        unsigned char c = diff[i + LcdFrame::RUN_HEADER + j];
+        if (c < 8) {
+          out[n++] = '\\';
+          out[n++] = '0' + c;
+        } else if (c >= 0x10 && c < 0x18) {
+          out[n++] = '\\';
+          out[n++] = '@' + c - 0x10;
+        } else if (c == '\\') {
+          out[n++] = '\\';
+          out[n++] = '\\';
+        } else {
+          out[n++] = c >= ' ' && c <= '~' ? c : '?';
+        }
+      }
+      i += LcdFrame::RUN_HEADER + cells;
+    }
+    out[n] = '\0';
+    return n;
+  }
+
+  // Applies an event to a viewer's copy of the display. Returns false (leaving it partly updated) if it is malformed.
+  static bool apply(LcdFrame &frame, const char *text) {
+    while (*text) {
+      if (!text[1]) {
+        return false;
+      }
+      size_t pos = text[0] - '0', cells = text[1] - '0';
+      text += LcdFrame::RUN_HEADER;
+      if (text[-2] < '0' || text[-1] < '0' || cells == 0 || pos + cells > LCD_CELLS) {
+        return false;
+      }
+      for (size_t j = 0; j < cells; j++) {
+        char c = *text++;
+        if (!c) {
+          return false;
+        }
+        if (c == '\\') {
+          char escaped = *text++;
+          if (escaped >= '0' && escaped <= '7') {
+            c = escaped - '0';
+          } else if (escaped >= '@' && escaped <= 'G') {
+            c = escaped - '@' + 0x10;
+          } else if (escaped != '\\') {
+            return false;
+          }
+        }
+        frame.cells[pos + j] = c;
+      }
+    }
+    return true;
+  }
+
+private:
+  uint32_t interval_ms;
+  LcdFrame acked;
+  LcdFrame pending;
+  uint32_t acked_at = 0;
+  uint32_t pending_at = 0;
+  bool synced = false;
+};
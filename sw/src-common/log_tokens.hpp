@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+// Tokenized logging: the log lines of the game code as binary records, with the format strings left out of the
+// firmware.
+//
+// ANT_LOGI(tag, format, ...) and ANT_LOGW() take the arguments of ESP_LOGI() and ESP_LOGW(), the tag and the format
+// must be string literals. The level, tag and format are hashed at compile time into a 32-bit token, and a log call
+// only writes a record into a ring buffer:
+//   u8      length of the rest of the record
+//   u32     token, little endian
+//   varint  timestamp, esphome::millis()
+//   ...     the arguments in order: integers (chars, bools, enums) as zigzag varints, floating point as a float32,
+//           strings as a varint length and at most MAX_STRING bytes
+// There is no formatting on the device. The compiler still checks the arguments against the format, like for printf,
+// and the decoder takes their types from the conversions of the format. Floating point arguments lose the precision
+// of a double (the game logs floats only), longer strings are cut.
+//
+// The main loop drains the ring after the display update (drain_log_tokens() of esphome-entry.hpp, called by the
+// game_task component of config.yaml): the records go to the esphome logger base64 encoded, in lines starting with
+// '$'. When the ring is full, new records are dropped and counted.
+//
+// The formats stay on the host: `ant_log dict` (src-pc/tools/ant_log.cpp) scans the sources for the macros into a
+// token dictionary, which the PC build makes as build/ant_log.dict, and `ant_log decode` turns the '$' lines of a
+// device log back into text, see README.md.
+//
+// The PC build also prints the text with the mock ESP_LOGx, so its output doesn't change. It writes the records as
+// well, and unit/unit_log_tokens.cpp checks that they decode to the same text.
+//
+// The game task writes, the main loop reads (game_loop.hpp): the ring has one producer and one consumer and no lock.
+// The macros take the time from esphome::millis().
+
+// FNV-1a of a NUL terminated text, the NUL included
+constexpr uint32_t log_hash(uint32_t hash, const char *text) {
+  do {
+    hash = (hash ^ (uint8_t)*text) * 16777619u;
+  } while (*text++ != 0);
+  return hash;
+}
+
+// The token of a log call, level being 'I' or 'W'
+constexpr uint32_t log_token(char level, const char *tag, const char *format) {
+  return log_hash(log_hash((2166136261u ^ (uint8_t)level) * 16777619u, tag), format);
+}
+
+class LogTokens {
+public:
+  static constexpr size_t RING = 1024;
+  static constexpr size_t MAX_RECORD = 64; // without the length byte, longer records are dropped
+  static constexpr size_t MAX_STRING = 24;
+
+  std::atomic<uint32_t> dropped{0}; // records lost since the last take_dropped()
+
+  template <typename... Args> void write(uint32_t token, uint32_t ms, const Args &...args) {
+    Record record;
+    for (int i = 0; i < 4; i++) {
+      record.put((uint8_t)(token >> (8 * i)));
+    }
+    record.varint(ms);
+    (record.arg(args), ...);
+    size_t head = this->head.load(std::memory_order_relaxed);
+    if (record.len > MAX_RECORD || RING - (head - tail.load(std::memory_order_acquire)) < record.len + 1) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    ring[head++ % RING] = (uint8_t)record.len;
+    for (size_t i = 0; i < record.len; i++) {
+      ring[head++ % RING] = record.bytes[i];
+    }
+    this->head.store(head, std::memory_order_release);
+  }
+
+  // Moves whole records out of the ring into out, as many as fit in size bytes (at least MAX_RECORD + 1 for progress).
+  // Returns the bytes written, 0 when the ring is empty.
+  size_t read(uint8_t *out, size_t size) {
+    size_t len = 0;
+    size_t head = this->head.load(std::memory_order_acquire);
+    size_t tail = this->tail.load(std::memory_order_relaxed);
+    while (tail != head) {
+      size_t record = ring[tail % RING] + 1;
+      if (len + record > size) {
+        break;
+      }
+      for (size_t i = 0; i < record; i++) {
+        out[len++] = ring[tail++ % RING];
+      }
+    }
+    this->tail.store(tail, std::memory_order_release);
+    return len;
+  }
+
+  uint32_t take_dropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+
+  // Not while the other task uses the ring
+  void reset() {
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+  }
+
+  // Base64 with padding into out (4 * ((len + 2) / 3) + 1 bytes), NUL terminated. Returns the length of the text.
+  static size_t base64(const uint8_t *in, size_t len, char *out) {
+    static const char CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t n = 0;
+    for (size_t i = 0; i < len; i += 3) {
+      uint32_t v = in[i] << 16 | (i + 1 < len ? in[i + 1] << 8 : 0) | (i + 2 < len ? in[i + 2] : 0);
+      out[n++] = CHARS[v >> 18 & 63];
+      out[n++] = CHARS[v >> 12 & 63];
+      out[n++] = i + 1 < len ? CHARS[v >> 6 & 63] : '=';
+      out[n++] = i + 2 < len ? CHARS[v & 63] : '=';
+    }
+    out[n] = 0;
+    return n;
+  }
+
+private:
+  // A record being written, without its length byte; len goes past the buffer when the record is too long
+  struct Record {
+    uint8_t bytes[MAX_RECORD];
+    size_t len = 0;
+
+    void put(uint8_t b) {
+      if (len < MAX_RECORD) {
+        bytes[len] = b;
+      }
+      len++;
+    }
+
+    void varint(uint64_t v) {
+      while (v >= 0x80) {
+        put((uint8_t)(v | 0x80));
+        v >>= 7;
+      }
+      put((uint8_t)v);
+    }
+
+    template <typename T> void arg(const T &value) {
+      if constexpr (std::is_floating_point_v<T>) {
+        float f = (float)value;
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        for (int i = 0; i < 4; i++) {
+          put((uint8_t)(bits >> (8 * i)));
+        }
+      } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+        int64_t v = (int64_t)value;
+        varint((uint64_t)v << 1 ^ (uint64_t)(v >> 63));
+      } else {
+        const char *s = value;
+        size_t n = strnlen(s, MAX_STRING);
+        varint(n);
+        for (size_t i = 0; i < n; i++) {
+          put((uint8_t)s[i]);
+        }
+      }
+    }
+  };
+
+  uint8_t ring[RING];
+  std::atomic<size_t> head{0}; // bytes written, ever
+  std::atomic<size_t> tail{0}; // bytes read, ever
+};
+
+inline LogTokens log_tokens;
+
+// Checks the arguments against the format without evaluating anything, and writes the record
+#define ANT_LOG_RECORD(level, tag, format, ...)                                                                        \
+  do {                                                                                                                 \
+    (void)sizeof(printf(format, ##__VA_ARGS__));                                                                       \
+    log_tokens.write(std::integral_constant<uint32_t, log_token(level, tag, format)>::value, esphome::millis(),        \
+                     ##__VA_ARGS__);                                                                                   \
+  } while (0)
+
+#ifdef ESP_PLATFORM
+#define ANT_LOGI(tag, format, ...) ANT_LOG_RECORD('I', tag, format, ##__VA_ARGS__)
+#define ANT_LOGW(tag, format, ...) ANT_LOG_RECORD('W', tag, format, ##__VA_ARGS__)
+#else
+#define ANT_LOGI(tag, format, ...)                                                                                     \
+  do {                                                                                                                 \
+    ESP_LOGI(tag, format, ##__VA_ARGS__);                                                                              \
+    ANT_LOG_RECORD('I', tag, format, ##__VA_ARGS__);                                                                   \
+  } while (0)
+#define ANT_LOGW(tag, format, ...)                                                                                     \
+  do {                                                                                                                 \
+    ESP_LOGW(tag, format, ##__VA_ARGS__);                                                                              \
+    ANT_LOG_RECORD('W', tag, format, ##__VA_ARGS__);                                                                   \
+  } while (0)
+#endif
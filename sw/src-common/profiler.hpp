@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#ifdef ESP_PLATFORM
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#else
+#include <chrono>
+#endif
+
+// Hot path profiler: the time spent in the sites of the game loop, as histograms of CPU ticks.
+//
+// A site is timed by an ANT_PROFILE_SCOPE() at the start of a block, up to the end of the block. Sites nest and times
+// are inclusive: GAME_CLOCK contains the clock of the mode, and in the PC build ACTIONS (on the device the actions run
+// in the main loop, see game_loop.hpp). The ticks are CPU cycles on the device (the performance counter
+// esp_cpu_get_cycle_count() reads, the ESP32-C3 has no mcycle) and nanoseconds of steady_clock on the PC.
+//
+// Each site has a fixed histogram with power of two buckets, recording a sample is a few adds and no allocation. The
+// histograms are cumulative since boot: to see a game on its own, take the difference of two dumps.
+//
+// The profiler is compiled in with ANT_PROFILE (set by the `metrics` component of config.yaml, and for the PC build),
+// without it ANT_PROFILE_SCOPE() expands to nothing. Samples are recorded by the game task (GAME_* and the modes) and
+// the main loop (ACTIONS, DISPLAY_WRITE), each site by one of them; the metrics page reads them from the web server
+// task without a lock, so a dump may miss the sample that is being recorded.
+
+// The mode sites are in the order of GameManager::MODE, with the menu (no game selected) last.
+enum class ProfileSite : uint8_t {
+  GAME_CLOCK,    // GameManager::clock()
+  GAME_KEY,      // GameManager::handle_key()
+  GAME_DISPLAY,  // GameManager::display_update()
+  ACTIONS,       // the s_handle_actions script
+  DISPLAY_WRITE, // the display component update: the frame of the game task, LCD mirror and the I2C writes
+  DEFUSAL_CLOCK,
+  DEFUSAL_KEY,
+  DEFUSAL_DISPLAY,
+  DOMINATION_CLOCK,
+  DOMINATION_KEY,
+  DOMINATION_DISPLAY,
+  ZONE_CONTROL_CLOCK,
+  ZONE_CONTROL_KEY,
+  ZONE_CONTROL_DISPLAY,
+  COUNTDOWN_CLOCK,
+  COUNTDOWN_KEY,
+  COUNTDOWN_DISPLAY,
+  RESPAWN_TIMER_CLOCK,
+  RESPAWN_TIMER_KEY,
+  RESPAWN_TIMER_DISPLAY,
+  SETTINGS_CLOCK,
+  SETTINGS_KEY,
+  SETTINGS_DISPLAY,
+  MENU_CLOCK,
+  MENU_KEY,
+  MENU_DISPLAY,
+  COUNT
+};
+
+// The site of a mode for one of GAME_CLOCK, GAME_KEY and GAME_DISPLAY, mode being the index of GameManager::MODE
+constexpr ProfileSite profile_mode_site(ProfileSite game_site, int mode) {
+  return static_cast<ProfileSite>(static_cast<int>(ProfileSite::DEFUSAL_CLOCK) + mode * 3 +
+                                  static_cast<int>(game_site) - static_cast<int>(ProfileSite::GAME_CLOCK));
+}
+
+struct ProfileHistogram {
+  // Bucket b holds the samples below 2^b ticks (and from 2^(b-1)), the last one all longer ones: 2^23 cycles are 50ms
+  // at 160MHz
+  static constexpr size_t BUCKETS = 24;
+
+  uint32_t count = 0;
+  uint32_t max = 0;
+  uint64_t total = 0;
+  uint32_t buckets[BUCKETS] = {};
+
+  static size_t bucket_of(uint32_t ticks) {
+    size_t b = ticks ? 32 - __builtin_clz(ticks) : 0;
+    return b < BUCKETS ? b : BUCKETS - 1;
+  }
+
+  void record(uint32_t ticks) {
+    count++;
+    total += ticks;
+    if (ticks > max) {
+      max = ticks;
+    }
+    buckets[bucket_of(ticks)]++;
+  }
+
+  // Upper bound of the given fraction of the samples in ticks: the bound of its bucket, or the max if that is lower
+  uint32_t percentile(float fraction) const {
+    uint32_t rank = (uint32_t)(fraction * count);
+    uint32_t seen = 0;
+    for (size_t b = 0; b < BUCKETS - 1; b++) {
+      seen += buckets[b];
+      if (seen > rank) {
+        return (1u << b) < max ? 1u << b : max;
+      }
+    }
+    return max;
+  }
+
+  // Table lines, with room for the widest numbers
+  static constexpr size_t LINE = 96;
+
+  // Appends the column names to the text of len bytes in out, returns the new length
+  static size_t format_columns(char *out, size_t size, size_t len, const char *name) {
+    return append(out, size, len, "%-22s %8s %8s %8s %8s %8s %8s\n", name, "count", "mean", "p50", "p90", "p99",
+                  "max");
+  }
+
+  // Appends the line of the histogram in microseconds, returns the new length
+  size_t format_row(char *out, size_t size, size_t len, const char *name, float ticks_per_us) const {
+    return append(out, size, len, "%-22s %8u %8.1f %8.1f %8.1f %8.1f %8.1f\n", name, (unsigned)count,
+                  count ? total / ticks_per_us / count : 0.0f, percentile(0.5f) / ticks_per_us,
+                  percentile(0.9f) / ticks_per_us, percentile(0.99f) / ticks_per_us, max / ticks_per_us);
+  }
+
+  // snprintf() at len that keeps out NUL terminated when it is full
+  template <typename... Args> static size_t append(char *out, size_t size, size_t len, const char *fmt, Args... args) {
+    if (len + 1 >= size) {
+      return len;
+    }
+    int n = snprintf(out + len, size - len, fmt, args...);
+    if (n < 0) {
+      return len;
+    }
+    return len + n < size ? len + n : size - 1;
+  }
+};
+
+class Profiler {
+public:
+  // One header line, the column names and a line per site
+  static constexpr size_t MAX_TEXT = ProfileHistogram::LINE * (static_cast<size_t>(ProfileSite::COUNT) + 2);
+
+  ProfileHistogram sites[static_cast<size_t>(ProfileSite::COUNT)];
+
+  static uint32_t now() {
+#ifdef ESP_PLATFORM
+    return esp_cpu_get_cycle_count();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  static uint32_t ticks_per_us() {
+#ifdef ESP_PLATFORM
+    return esp_rom_get_cpu_ticks_per_us();
+#else
+    return 1000;
+#endif
+  }
+
+  static const char *site_name(ProfileSite site) {
+    static const char *const NAMES[] = {
+        "clock",
+        "handle_key",
+        "display_update",
+        "actions",
+        "display_write",
+        "defusal.clock",
+        "defusal.key",
+        "defusal.display",
+        "domination.clock",
+        "domination.key",
+        "domination.display",
+        "zone_control.clock",
+        "zone_control.key",
+        "zone_control.display",
+        "countdown.clock",
+        "countdown.key",
+        "countdown.display",
+        "respawn_timer.clock",
+        "respawn_timer.key",
+        "respawn_timer.display",
+        "settings.clock",
+        "settings.key",
+        "settings.display",
+        "menu.clock",
+        "menu.key",
+        "menu.display",
+    };
+    static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<size_t>(ProfileSite::COUNT));
+    return NAMES[static_cast<size_t>(site)];
+  }
+
+  ProfileHistogram &site(ProfileSite site) { return sites[static_cast<size_t>(site)]; }
+
+  void reset() {
+    for (ProfileHistogram &h : sites) {
+      h = ProfileHistogram();
+    }
+  }
+
+  // Writes the sites that have samples as a table in microseconds into out (NUL terminated, MAX_TEXT bytes are
+  // always enough, with less the table is cut). Returns the length of the text.
+  size_t format(char *out, size_t size) const {
+    float tpu = (float)ticks_per_us();
+    size_t len = ProfileHistogram::append(out, size, 0,
+                                          "# since boot, %u ticks/us, times in us, p50-p99 are upper bounds\n",
+                                          (unsigned)ticks_per_us());
+    len = ProfileHistogram::format_columns(out, size, len, "site");
+    for (size_t i = 0; i < static_cast<size_t>(ProfileSite::COUNT); i++) {
+      if (sites[i].count != 0) {
+        len = sites[i].format_row(out, size, len, site_name(static_cast<ProfileSite>(i)), tpu);
+      }
+    }
+    return len;
+  }
+};
+
+inline Profiler profiler;
+
+// Records the ticks from its construction to its destruction in a site
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfileSite site) : histogram(profiler.site(site)), start(Profiler::now()) {}
+  ~ProfileScope() { histogram.record(Profiler::now() - start); }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  ProfileHistogram &histogram;
+  uint32_t start;
+};
+
+#ifdef ANT_PROFILE
+#define ANT_PROFILE_SCOPE(site) ProfileScope ant_profile_scope(site)
+#else
+#define ANT_PROFILE_SCOPE(site)
+#endif
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "globals.hpp"
+#include "lcd_frame.hpp"
+#include "task_queues.hpp"
+
+// Remote keypad: the keypad and the team buttons of a prop operated from a phone over a WebSocket.
+//
+// The protocol is binary, one WebSocket message per frame:
+//
+//   client -> prop   key frame   seq, key...        key codes as in globals.hpp (KEY_RED, KEY_C_LONG, ...)
+//   prop -> client   LCD frame   ack, diff          ack = seq of the last key frame that was applied before the
+//                                                   display was captured, diff as in lcd_frame.hpp
+//
+// The first LCD frame after connecting carries the full display. A key frame that doesn't change the display is
+// still answered (with an empty diff), so the client can measure the round trip.
+//
+// Keys are received in the web server task and handed to the main loop through RemoteKeyQueue. On the prop the main
+// loop queues them for the game task (game_loop.hpp): a key frame is only acknowledged with the first display that
+// the game task rendered after applying it, see RemoteKeypadClient::queued().
+
+static constexpr size_t REMOTE_KEYPAD_MAX_KEYS = 8; // per key frame
+static constexpr size_t REMOTE_KEYPAD_MAX_FRAME = 1 + REMOTE_KEYPAD_MAX_KEYS;
+static constexpr size_t REMOTE_KEYPAD_MAX_LCD_FRAME = 1 + LcdFrame::MAX_DIFF;
+
+inline bool remote_key_valid(unsigned char key) {
+  if ((key >= KEY_0 && key <= KEY_9) || (key >= KEY_A && key <= KEY_D)) {
+    return true;
+  }
+  switch (key) {
+  case KEY_STAR:
+  case KEY_HASH:
+  case KEY_RED:
+  case KEY_RED_RELEASE:
+  case KEY_YELLOW:
+  case KEY_YELLOW_RELEASE:
+  case KEY_RESET:
+  case KEY_C_LONG: return true;
+  }
+  return false;
+}
+
+// Checks a key frame: a sequence number and 1 to REMOTE_KEYPAD_MAX_KEYS valid key codes
+inline bool remote_key_frame_valid(const uint8_t *data, size_t len) {
+  if (len < 2 || len > REMOTE_KEYPAD_MAX_FRAME) {
+    return false;
+  }
+  for (size_t i = 1; i < len; i++) {
+    if (!remote_key_valid(data[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A key on its way from a client to the game loop
+struct RemoteKey {
+  uint32_t received_us; // when the key frame arrived, for measuring the time spent in the queue
+  uint8_t client;       // slot of the client, see RemoteKeypadClient
+  uint8_t seq;          // sequence number of the key frame
+  unsigned char key;
+};
+
+// The web server task pushes, the main loop pops
+template <size_t N> using RemoteKeyQueueN = SpscQueue<RemoteKey, N>;
+
+using RemoteKeyQueue = RemoteKeyQueueN<32>;
+
+// What one connected client has been sent, used by the main loop to build its next LCD frame
+class RemoteKeypadClient {
+public:
+  // Key frames handed to the game task and not shown yet, the oldest is dropped when more are in flight
+  static constexpr size_t MAX_QUEUED = 8;
+
+  // A new connection in this slot: the next LCD frame carries the full display
+  void reset() {
+    has_frame = false;
+    ack = 0;
+    ack_pending = false;
+    queued_count = 0;
+  }
+
+  // A key of the key frame seq was queued for the game task with this ticket (GameLoop::key()). Tickets increase with
+  // every key queued, 0 is never used.
+  void queued(uint8_t seq, uint32_t ticket) {
+    if (queued_count == MAX_QUEUED) {
+      memmove(in_flight, in_flight + 1, sizeof(in_flight) - sizeof(in_flight[0]));
+      queued_count--;
+    }
+    in_flight[queued_count++] = InFlight{seq, ticket};
+  }
+
+  // The display about to be sent was rendered after the game task applied the keys up to this ticket: the key frames
+  // among them are applied
+  void shown(uint32_t ticket) {
+    size_t done = 0;
+    while (done < queued_count && (int32_t)(ticket - in_flight[done].ticket) >= 0) {
+      done++;
+    }
+    if (done == 0) {
+      return;
+    }
+    applied(in_flight[done - 1].seq);
+    queued_count -= done;
+    memmove(in_flight, in_flight + done, queued_count * sizeof(in_flight[0]));
+  }
+
+  // A key frame of this client was applied
+  void applied(uint8_t seq) {
+    ack = seq;
+    ack_pending = true;
+  }
+
+  // Builds the LCD frame for the current display into out (REMOTE_KEYPAD_MAX_LCD_FRAME bytes).
+  // Returns its length, 0 if the client is up to date.
+  size_t update(const LcdFrame &frame, uint8_t *out) {
+    size_t len = frame.diff(has_frame ? &sent : nullptr, out + 1);
+    if (len == 0 && !ack_pending) {
+      return 0;
+    }
+    out[0] = ack;
+    sent = frame;
+    has_frame = true;
+    ack_pending = false;
+    return 1 + len;
+  }
+
+private:
+  struct InFlight {
+    uint8_t seq;
+    uint32_t ticket;
+  };
+
+  LcdFrame sent;
+  bool has_frame = false;
+  uint8_t ack = 0;
+  bool ack_pending = false;
+  InFlight in_flight[MAX_QUEUED];
+  size_t queued_count = 0;
+};
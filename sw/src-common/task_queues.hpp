@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Lock-free hand-offs between tasks: a queue of records and the latest of a value, each with one producer and one
+// consumer, and the latest of a value for any number of readers. The writing side never waits for the reading one.
+
+// Single producer, single consumer queue. N must be a power of two, one slot is kept free.
+template <typename T, size_t N> class SpscQueue {
+public:
+  // Returns false if the queue is full, the record is dropped
+  bool push(const T &record) {
+    size_t head = this->head.load(std::memory_order_relaxed);
+    size_t next = (head + 1) & (N - 1);
+    if (next == tail.load(std::memory_order_acquire)) {
+      dropped++;
+      return false;
+    }
+    slots[head] = record;
+    this->head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &record) {
+    size_t tail = this->tail.load(std::memory_order_relaxed);
+    if (tail == head.load(std::memory_order_acquire)) {
+      return false;
+    }
+    record = slots[tail];
+    this->tail.store((tail + 1) & (N - 1), std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const { return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire); }
+
+  // Records that didn't fit, only written by the producer
+  uint32_t dropped = 0;
+
+private:
+  static_assert((N & (N - 1)) == 0, "N must be a power of two");
+
+  T slots[N];
+  std::atomic<size_t> head{0};
+  std::atomic<size_t> tail{0};
+};
+
+// The latest value a producer published, for a consumer that only wants the newest one (a triple buffer). The
+// producer writes into a slot of its own and swaps it with the middle one; the consumer swaps its slot with the
+// middle one when that holds a value it hasn't seen. Values the consumer was too slow for are skipped.
+template <typename T> class LatestValue {
+public:
+  // Producer: the slot to fill, then publish() it
+  T &back() { return slots[back_slot]; }
+  void publish() { back_slot = middle.exchange(back_slot | FRESH, std::memory_order_acq_rel) & INDEX; }
+  void write(const T &value) {
+    back() = value;
+    publish();
+  }
+
+  // Consumer: whether a value was published since the last read()
+  bool fresh() const { return middle.load(std::memory_order_acquire) & FRESH; }
+  // The latest value, default constructed before the first publish()
+  const T &read() {
+    if (fresh()) {
+      front_slot = middle.exchange(front_slot, std::memory_order_acq_rel) & INDEX;
+    }
+    return slots[front_slot];
+  }
+
+private:
+  static constexpr uint8_t INDEX = 3;
+  static constexpr uint8_t FRESH = 4;
+
+  T slots[3] = {};
+  uint8_t back_slot = 0;          // only used by the producer
+  uint8_t front_slot = 1;         // only used by the consumer
+  std::atomic<uint8_t> middle{2}; // the slot in between, FRESH while the consumer hasn't taken it
+};
+
+// The latest value a writer published, for any number of readers on any task (a sequence lock). The writer bumps the
+// sequence to odd, stores the value and bumps it to even again; a reader copies the value and tries again if the
+// sequence was odd or changed meanwhile. The writer never waits, a reader only while a write is in progress.
+//
+// The value is kept as atomic words, so a copy that overlaps a write is discarded rather than a data race. T must be
+// trivially copyable and small, every read copies all of it.
+template <typename T> class SeqLock {
+public:
+  SeqLock() { store(T()); }
+
+  // Writer: one task only
+  void write(const T &value) {
+    uint32_t seq = this->seq.load(std::memory_order_relaxed);
+    this->seq.store(seq + 1, std::memory_order_relaxed);
+    store(value); // release: the odd sequence is seen before any word of the value
+    this->seq.store(seq + 2, std::memory_order_release);
+  }
+
+  // Reader: one attempt, false if a write overlapped the copy
+  bool try_read(T &value) const {
+    uint32_t seq = this->seq.load(std::memory_order_acquire);
+    if (seq & 1) {
+      return false;
+    }
+    uint32_t copy[WORDS];
+    for (size_t i = 0; i < WORDS; i++) {
+      copy[i] = words[i].load(std::memory_order_acquire);
+    }
+    if (this->seq.load(std::memory_order_relaxed) != seq) {
+      return false;
+    }
+    memcpy(&value, copy, sizeof(T));
+    return true;
+  }
+
+  // Reader: the latest value, default constructed before the first write. Spins while a write is in progress, so the
+  // reader must not keep the writer from finishing it: on the prop, readers run below the priority of the game task.
+  T read() const {
+    T value;
+    while (!try_read(value)) {
+    }
+    return value;
+  }
+
+  // Values written so far, for readers that only want to know whether there is a new one
+  uint32_t writes() const { return seq.load(std::memory_order_acquire) / 2; }
+
+private:
+  static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+  static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+  void store(const T &value) {
+    uint32_t copy[WORDS] = {};
+    memcpy(copy, &value, sizeof(T));
+    for (size_t i = 0; i < WORDS; i++) {
+      words[i].store(copy[i], std::memory_order_release);
+    }
+  }
+
+  std::atomic<uint32_t> seq{0}; // odd while a write is in progress
+  std::atomic<uint32_t> words[WORDS];
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "profiler.hpp"
+
+// Tick jitter of the game task (src-esphome/mycomponents/game_task): how late each tick started after its deadline,
+// and how long it ran, as histograms in microseconds (the histograms of profiler.hpp).
+//
+// The deadlines are fixed, a period apart from the start of the task. A tick that starts more than a period late has
+// missed the ones in between: they are counted as skipped, not run back to back, the game clock takes the real time.
+// The keys wake the task between the deadlines, those extra passes are counted but not timed.
+//
+// Samples are recorded by the game task only; the metrics page and the log read them from other tasks without a lock,
+// so a dump may miss the sample that is being recorded.
+
+class TickJitter {
+public:
+  // One header line, the column names, a line per histogram and the counters
+  static constexpr size_t MAX_TEXT = ProfileHistogram::LINE * 5;
+
+  ProfileHistogram late; // from the deadline to the start of the tick
+  ProfileHistogram run;  // from the start of the tick to its end
+  uint32_t period_us = 0;
+  uint32_t skipped = 0; // deadlines missed altogether
+  uint32_t wakes = 0;   // passes between the deadlines, for keys
+
+  void tick(uint32_t late_us, uint32_t run_us) {
+    late.record(late_us);
+    run.record(run_us);
+  }
+
+  void reset() { *this = TickJitter(); }
+
+  // Writes the histograms as a table in microseconds and the counters into out (NUL terminated, MAX_TEXT bytes are
+  // always enough, with less the text is cut). Returns the length of the text.
+  size_t format(char *out, size_t size) const {
+    size_t len = ProfileHistogram::append(out, size, 0, "# game task ticks since boot, every %u us, in us\n",
+                                          (unsigned)period_us);
+    len = ProfileHistogram::format_columns(out, size, len, "tick");
+    len = late.format_row(out, size, len, "late", 1.0f);
+    len = run.format_row(out, size, len, "run", 1.0f);
+    return ProfileHistogram::append(out, size, len, "skipped %u, woken for keys %u\n", (unsigned)skipped,
+                                    (unsigned)wakes);
+  }
+};
+
+inline TickJitter tick_jitter;
@@ -1,5 +1,6 @@
 #include <iomanip>
 
+#include "glyphs.hpp"
 #include "utilities.hpp"
 
 int append_digit(char digit_to_append, int current_value, long unsigned int max_len) {
@@ -25,7 +26,8 @@ std::string format_time_remaining(int milliseconds) {
 
 // Given a ratio 0.1-1.0, return 16 characters, where each character consists of one of:
 // * " " - empty
-// * \x01 to \x05 - special character which fills 1 to 5 columns of the character width.
+// * GLYPH_BAR_1 to GLYPH_BAR_5 - glyph which fills 1 to 5 columns of the character width (the PC build prints
+//   stand-ins, see glyphs.hpp).
 std::string format_progress_bar(float ratio) {
   if (ratio < 0)
     ratio = 0;
@@ -33,13 +35,9 @@ std::string format_progress_bar(float ratio) {
     ratio = 1;
 
   static const int num_chars = 16;
-#ifdef ESP_PLATFORM
-  static const std::string chars = "\x01\x01\x02\x02\x03\x03\x04\x04\x05\x05";
-  static const char block = '\x05';
-#else
-  static const std::string chars = "1122334455";
-  static const char block = 'X';
-#endif
+  static const char chars[] = {GLYPH_BAR_1, GLYPH_BAR_1, GLYPH_BAR_2, GLYPH_BAR_2, GLYPH_BAR_3,
+                                GLYPH_BAR_3, GLYPH_BAR_4, GLYPH_BAR_4, GLYPH_BAR_5, GLYPH_BAR_5};
+  static const char block = GLYPH_BLOCK;
 
   const float filled_ratio = ratio * num_chars;
   const int filled_chars = (int)filled_ratio;
@@ -1,4 +1,58 @@
-#include "src-common/gm_manager.hpp"
+#include "src-common/game_loop.hpp"
 
 AntGlobals antg;
 GameManager game_manager(antg);
+GameLoop game_loop(game_manager);
+
+// Sends the tokenized log records of the game (src-common/log_tokens.hpp) to the logger, base64 encoded in lines
+// starting with '$'; `ant_log decode` turns them back into text. Called by the main loop after the display update.
+inline void drain_log_tokens() {
+  uint8_t records[96];
+  char text[4 * sizeof(records) / 3 + 1];
+  static_assert(sizeof(records) > LogTokens::MAX_RECORD);
+  size_t len;
+  while ((len = log_tokens.read(records, sizeof(records))) != 0) {
+    LogTokens::base64(records, len, text);
+    ESP_LOGI("ant_log", "$%s", text);
+  }
+  uint32_t dropped = log_tokens.take_dropped();
+  if (dropped != 0) {
+    ESP_LOGW("ant_log", "%u log records dropped", (unsigned)dropped);
+  }
+}
+
+// The display the game renders into on the game task: the buffer of LCDDisplay without an LCD behind it. The LCD
+// itself is only written by the main loop, from the frames the game task publishes (src-common/game_loop.hpp).
+class FrameDisplay : public esphome::lcd_base::LCDDisplay {
+public:
+  FrameDisplay() {
+    this->set_dimensions(LCD_COLS, LCD_ROWS);
+    this->buffer_ = (uint8_t *)this->cells_;
+    this->blank();
+  }
+
+  void blank() { memset(this->cells_, ' ', LCD_CELLS); }
+  const char *cells() const { return this->cells_; }
+
+protected:
+  bool is_four_bit_mode() override { return true; }
+  void write_n_bits(uint8_t value, uint8_t n) override {}
+  void send(uint8_t value, bool rs) override {}
+  void call_writer() override {}
+
+  char cells_[LCD_CELLS];
+};
+
+// A pass of the game task (the game_task component of config.yaml): the keys, the clock at the deadlines of the ticks,
+// and the frame for the LCD
+inline void game_task_tick(uint32_t now, bool deadline) {
+  static FrameDisplay frame;
+  if (deadline) {
+    game_loop.tick(now);
+  } else {
+    game_loop.apply_commands();
+  }
+  frame.blank();
+  game_manager.display_update(frame);
+  game_loop.publish(frame.cells());
+}
@@ -0,0 +1,35 @@
+# Scheduler of the I2C transactions of the keypad and the LCD on their bus: see bus_scheduler.h
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import CONF_FREQUENCY, CONF_ID
+
+CONF_BUS_SCHEDULER_ID = "bus_scheduler_id"
+CONF_CHUNK_TIME = "chunk_time"
+CONF_SLOT_TIME = "slot_time"
+
+bus_scheduler_ns = cg.esphome_ns.namespace("bus_scheduler")
+BusScheduler = bus_scheduler_ns.class_("BusScheduler", cg.Component)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(BusScheduler),
+        # the frequency of the bus, for the bus time of the chunks
+        cv.Optional(CONF_FREQUENCY, default="100kHz"): cv.All(
+            cv.frequency, cv.Range(min=10e3, max=1e6)
+        ),
+        cv.Optional(
+            CONF_CHUNK_TIME, default="500us"
+        ): cv.positive_time_period_microseconds,
+        cv.Optional(
+            CONF_SLOT_TIME, default="1ms"
+        ): cv.positive_time_period_microseconds,
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    cg.add(var.set_frequency(int(config[CONF_FREQUENCY])))
+    cg.add(var.set_chunk_time(config[CONF_CHUNK_TIME].total_microseconds))
+    cg.add(var.set_slot_time(config[CONF_SLOT_TIME].total_microseconds))
@@ -0,0 +1,43 @@
+#include "bus_scheduler.h"
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace bus_scheduler {
+
+static const char *const TAG = "bus_scheduler";
+
+void BusScheduler::setup() {
+  this->stats_since_ = micros();
+  this->set_interval("stats", 60000, [this]() { this->log_stats_(); });
+}
+
+void BusScheduler::loop() {
+  while (this->scheduler_.step(micros())) {
+  }
+  if (this->scheduler_.idle()) {
+    this->high_freq_.stop();
+  } else {
+    this->high_freq_.start();
+  }
+}
+
+void BusScheduler::dump_config() {
+  ESP_LOGCONFIG(TAG, "Bus scheduler:");
+  for (uint8_t i = 0; i < this->scheduler_.clients(); i++) {
+    ESP_LOGCONFIG(TAG, "  Device: %s", this->scheduler_.name(i));
+  }
+}
+
+void BusScheduler::log_stats_() {
+  uint32_t now = micros();
+  char line[200];
+  this->scheduler_.format(line, sizeof(line), now - this->stats_since_);
+  ESP_LOGD(TAG, "Bus: %s", line);
+  this->scheduler_.reset_stats();
+  this->stats_since_ = now;
+}
+
+}  // namespace bus_scheduler
+}  // namespace esphome
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "transaction_scheduler.h"
+
+namespace esphome {
+namespace bus_scheduler {
+
+/// Schedules the transactions of the keypad and the LCD on bus_a, see transaction_scheduler.h, and the "I2C bus
+/// scheduling" section of the README.
+///
+/// The devices join with their bus_scheduler_id (pcf8574_keypad reserves its scans, lcd_burst queues its frames). The
+/// loop writes the chunks that fit, and runs without the pause of the main loop while there are more. The bus time of
+/// each device is logged every minute, at debug level.
+class BusScheduler : public Component {
+ public:
+  TransactionScheduler &scheduler() { return this->scheduler_; }
+  void set_frequency(uint32_t hz) { this->scheduler_.set_frequency(hz); }
+  void set_chunk_time(uint32_t us) { this->scheduler_.set_chunk_time(us); }
+  void set_slot_time(uint32_t us) { this->scheduler_.set_slot_time(us); }
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::BUS; }
+
+ protected:
+  void log_stats_();
+
+  TransactionScheduler scheduler_;
+  HighFrequencyLoopRequester high_freq_;
+  uint32_t stats_since_{0};
+};
+
+}  // namespace bus_scheduler
+}  // namespace esphome
@@ -0,0 +1,167 @@
+#include "transaction_scheduler.h"
+
+#include <cstdio>
+
+namespace esphome {
+namespace bus_scheduler {
+
+// start, address byte with its ACK, stop
+static const uint32_t OVERHEAD_BITS = 1 + 9 + 1;
+
+uint8_t TransactionScheduler::add_client(const char *name, ChunkWriter *writer) {
+  if (this->count_ == MAX_CLIENTS) {
+    return MAX_CLIENTS;
+  }
+  this->clients_[this->count_] = Client{name, writer, false, 0, nullptr, 0, 0, {}};
+  return this->count_++;
+}
+
+uint32_t TransactionScheduler::write_us(size_t len) const {
+  uint64_t bits = OVERHEAD_BITS + 9 * len;
+  return (bits * 1000000 + this->frequency_ - 1) / this->frequency_;
+}
+
+void TransactionScheduler::reserve(uint8_t client, uint32_t at) {
+  if (client >= this->count_) {
+    return;
+  }
+  this->clients_[client].reserved = true;
+  this->clients_[client].at = at;
+}
+
+void TransactionScheduler::record(uint8_t client, uint32_t start, uint32_t us, size_t bytes, bool ok) {
+  if (client >= this->count_) {
+    return;
+  }
+  Client &c = this->clients_[client];
+  if (c.reserved && !before_(start, c.at) && start - c.at > c.stats.max_wait_us) {
+    c.stats.max_wait_us = start - c.at;
+  }
+  c.reserved = false;
+  this->account_(c, us, bytes, ok);
+}
+
+void TransactionScheduler::queue(uint8_t client, const uint8_t *data, size_t len, uint8_t strobe) {
+  if (client >= this->count_ || this->clients_[client].writer == nullptr) {
+    return;
+  }
+  Client &c = this->clients_[client];
+  c.data = data;
+  c.left = len;
+  c.strobe = strobe;
+}
+
+bool TransactionScheduler::idle() const {
+  for (uint8_t i = 0; i < this->count_; i++) {
+    if (this->clients_[i].left != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TransactionScheduler::budget_(uint32_t now, uint32_t &us) const {
+  us = this->chunk_time_;
+  for (uint8_t i = 0; i < this->count_; i++) {
+    const Client &c = this->clients_[i];
+    if (!c.reserved || !before_(now, c.at + this->slot_time_)) {
+      continue;  // none, or not taken in its slot
+    }
+    if (!before_(now, c.at)) {
+      return false;
+    }
+    if (c.at - now < us) {
+      us = c.at - now;
+    }
+  }
+  return true;
+}
+
+bool TransactionScheduler::step(uint32_t now) {
+  for (uint8_t i = 0; i < this->count_; i++) {
+    Client &c = this->clients_[i];
+    if (c.left == 0) {
+      continue;
+    }
+    uint32_t us;
+    if (!this->budget_(now, us)) {
+      return false;
+    }
+    uint64_t bits = (uint64_t) us * this->frequency_ / 1000000;
+    size_t len = bits > OVERHEAD_BITS ? (bits - OVERHEAD_BITS) / 9 : 0;
+    if (len >= c.left) {
+      len = c.left;
+    } else {
+      len = cut_(c, len);
+      if (len < MIN_CHUNK) {
+        return false;  // the rest waits for a gap that fits a chunk
+      }
+    }
+    bool ok = c.writer->write_chunk(c.data, len);
+    this->account_(c, this->write_us(len), len, ok);
+    if (!ok) {
+      c.left = 0;  // the rest is stale without this chunk, the next frame writes it all again
+      return true;
+    }
+    c.data += len;
+    c.left -= len;
+    return true;
+  }
+  return false;
+}
+
+size_t TransactionScheduler::cut_(const Client &c, size_t len) {
+  // the last chunk ended with the strobe low and a whole number of pairs
+  size_t cut = 0;
+  bool high = false;
+  bool odd = false;
+  for (size_t i = 0; i < len; i++) {
+    bool strobe = (c.data[i] & c.strobe) != 0;
+    if (high && !strobe) {
+      odd = !odd;
+    }
+    high = strobe;
+    if (!high && !odd) {
+      cut = i + 1;
+    }
+  }
+  return cut;
+}
+
+void TransactionScheduler::account_(Client &c, uint32_t us, size_t bytes, bool ok) {
+  c.stats.transactions++;
+  c.stats.bytes += bytes;
+  c.stats.busy_us += us;
+  if (us > c.stats.max_us) {
+    c.stats.max_us = us;
+  }
+  if (!ok) {
+    c.stats.errors++;
+  }
+}
+
+size_t TransactionScheduler::format(char *buf, size_t size, uint32_t elapsed) const {
+  size_t len = 0;
+  buf[0] = '\0';
+  for (uint8_t i = 0; i < this->count_ && len < size; i++) {
+    const ClientStats &s = this->clients_[i].stats;
+    double seconds = elapsed / 1e6;
+    int n = snprintf(buf + len, size - len, "%s%s %.1f%% %.0f/s max %uus wait %uus", i == 0 ? "" : ", ",
+                     this->clients_[i].name, elapsed == 0 ? 0.0 : 100.0 * s.busy_us / elapsed,
+                     elapsed == 0 ? 0.0 : s.transactions / seconds, (unsigned) s.max_us, (unsigned) s.max_wait_us);
+    if (n < 0) {
+      break;
+    }
+    len += (size_t) n < size - len ? n : size - len - 1;
+  }
+  return len;
+}
+
+void TransactionScheduler::reset_stats() {
+  for (uint8_t i = 0; i < this->count_; i++) {
+    this->clients_[i].stats = ClientStats{};
+  }
+}
+
+}  // namespace bus_scheduler
+}  // namespace esphome
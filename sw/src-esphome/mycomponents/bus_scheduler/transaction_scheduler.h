@@ -0,0 +1,106 @@
+#pragma once
+
+// Cooperative scheduler of the I2C transactions of the devices on one bus, for the keypad and the LCD of bus_a.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace bus_scheduler {
+
+/// A device that writes its data in chunks through the scheduler: the LCD.
+class ChunkWriter {
+ public:
+  virtual ~ChunkWriter() = default;
+  virtual bool write_chunk(const uint8_t *data, size_t len) = 0;
+};
+
+/// The bus time of a device since the last reset of the statistics.
+struct ClientStats {
+  uint32_t transactions{0};
+  uint32_t bytes{0};  ///< data bytes, without the address bytes
+  uint64_t busy_us{0};
+  uint32_t max_us{0};       ///< the longest transaction
+  uint32_t max_wait_us{0};  ///< the latest a reserved transaction started after its time
+  uint32_t errors{0};
+};
+
+/// Shares a bus between devices that need it at a time (the keypad scans) and devices that write a lot of data now
+/// and then (the LCD frames), in the esphome main loop.
+///
+/// A device of the first kind reserves the time of its next transaction and records the transaction when it comes.
+/// The data of the second kind is queued and written in chunks of at most chunk_time on the bus, each only if it ends
+/// before the next reservation. A transaction that is due thus waits for one chunk at most, and for nothing once the
+/// reservation is made; a reservation that isn't taken blocks the chunks for slot_time. A chunk ends only with the
+/// strobe bit of its data low, after an even number of its falling edges: the LCD takes a byte as two nibbles, each on
+/// a falling edge of E, and a newer frame queued in between must start with a whole byte.
+///
+/// The bus time of a chunk is taken from the bus frequency, the one of a recorded transaction is measured by the
+/// device.
+class TransactionScheduler {
+ public:
+  static const uint8_t MAX_CLIENTS = 4;
+  static const size_t MIN_CHUNK = 4;  ///< smaller chunks wait, unless it's the rest of the data
+
+  void set_frequency(uint32_t hz) { this->frequency_ = hz; }
+  void set_chunk_time(uint32_t us) { this->chunk_time_ = us; }
+  void set_slot_time(uint32_t us) { this->slot_time_ = us; }
+
+  /// Adds a device, writer for one that queues data. Returns its index for the calls below, MAX_CLIENTS if there are
+  /// too many.
+  uint8_t add_client(const char *name, ChunkWriter *writer = nullptr);
+
+  /// The bus time of a write of len bytes: the start, the address and the bytes with their ACKs, the stop.
+  uint32_t write_us(size_t len) const;
+
+  /// The next transaction of the client is due at `at` (us).
+  void reserve(uint8_t client, uint32_t at);
+  /// A transaction the client made itself, of bytes data bytes, started at start and us long on the bus.
+  void record(uint8_t client, uint32_t start, uint32_t us, size_t bytes, bool ok = true);
+
+  /// Queues data to be written in chunks, cut after whole pairs of pulses of the strobe bit. The data stays the
+  /// client's and must not change until done(); queueing again starts over with the new data, e.g. a newer frame.
+  void queue(uint8_t client, const uint8_t *data, size_t len, uint8_t strobe);
+  bool done(uint8_t client) const { return this->clients_[client].left == 0; }
+  /// Nothing queued
+  bool idle() const;
+
+  /// Writes the next chunk if one fits before the reservations, at now (us). Returns whether it wrote one.
+  bool step(uint32_t now);
+
+  uint8_t clients() const { return this->count_; }
+  const char *name(uint8_t client) const { return this->clients_[client].name; }
+  const ClientStats &stats(uint8_t client) const { return this->clients_[client].stats; }
+  /// The statistics as a line of text for elapsed us: per device the share of the time on the bus, the transactions
+  /// a second and the longest wait. Returns the length.
+  size_t format(char *buf, size_t size, uint32_t elapsed) const;
+  void reset_stats();
+
+ protected:
+  struct Client {
+    const char *name;
+    ChunkWriter *writer;
+    bool reserved;
+    uint32_t at;
+    const uint8_t *data;
+    size_t left;
+    uint8_t strobe;
+    ClientStats stats;
+  };
+
+  static bool before_(uint32_t a, uint32_t b) { return (int32_t) (a - b) < 0; }
+  /// The bus time until the first reservation, chunk_time at most; false if one is due
+  bool budget_(uint32_t now, uint32_t &us) const;
+  /// The longest chunk of at most len bytes of the client's data that can be cut there, 0 for none
+  static size_t cut_(const Client &c, size_t len);
+  void account_(Client &c, uint32_t us, size_t bytes, bool ok);
+
+  uint32_t frequency_{100000};
+  uint32_t chunk_time_{500};
+  uint32_t slot_time_{1000};
+  Client clients_[MAX_CLIENTS];
+  uint8_t count_{0};
+};
+
+}  // namespace bus_scheduler
+}  // namespace esphome
@@ -0,0 +1,144 @@
+#include "fleet_sync.h"
+
+#include <cstring>
+
+#include <esp_wifi.h>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace fleet_sync {
+
+static const char *const TAG = "fleet_sync";
+
+static const uint8_t BROADCAST_ADDR[ESP_NOW_ETH_ALEN] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+/// Received messages waiting for the game loop (50ms ticks), at worst a few from every prop
+static constexpr size_t RX_QUEUE_LEN = 32;
+static constexpr uint32_t START_RETRY_INTERVAL = 1000;
+
+// ESP-NOW callbacks have no user argument
+static EspNowFleetTransport *instance = nullptr;
+
+void EspNowFleetTransport::setup() {
+  this->rx_queue_ = xQueueCreate(RX_QUEUE_LEN, sizeof(Packet));
+  instance = this;
+}
+
+void EspNowFleetTransport::loop() {
+  if (!this->started_ && millis() - this->last_start_attempt_ >= START_RETRY_INTERVAL) {
+    this->last_start_attempt_ = millis();
+    this->started_ = this->start_();
+  }
+
+  // Until ESP-NOW is up the messages are dropped, as they would be by the radio
+  Packet packet;
+  while (this->tx_queue_.pop(packet)) {
+    if (!this->started_) {
+      continue;
+    }
+    esp_err_t err = esp_now_send(BROADCAST_ADDR, packet.data, packet.len);
+    if (err == ESP_ERR_ESPNOW_NOT_INIT || err == ESP_ERR_ESPNOW_IF) {
+      this->started_ = false;  // WiFi was switched off, or to another mode, by the OTA scripts
+    } else if (err != ESP_OK && this->send_errors_++ % 100 == 0) {
+      ESP_LOGW(TAG, "esp_now_send failed: %s (%u errors)", esp_err_to_name(err), (unsigned) this->send_errors_);
+    }
+  }
+}
+
+bool EspNowFleetTransport::start_() {
+  wifi_mode_t mode;
+  if (esp_wifi_get_mode(&mode) != ESP_OK) {
+    return false;  // the wifi component hasn't set the driver up yet
+  }
+  if (mode == WIFI_MODE_NULL) {
+    // The wifi component keeps the radio off outside of OTA (enable_on_boot: false). ESP-NOW only needs it started in
+    // station mode: not connected to anything, and without the access point. Power save would miss broadcasts.
+    esp_err_t err = esp_wifi_set_mode(WIFI_MODE_STA);
+    if (err == ESP_OK) {
+      err = esp_wifi_start();
+    }
+    if (err != ESP_OK) {
+      ESP_LOGW(TAG, "Starting the radio failed: %s", esp_err_to_name(err));
+      return false;
+    }
+    esp_wifi_set_ps(WIFI_PS_NONE);
+    mode = WIFI_MODE_STA;
+  }
+  esp_err_t err = esp_now_init();
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "esp_now_init failed: %s", esp_err_to_name(err));
+    return false;
+  }
+  esp_now_register_recv_cb(EspNowFleetTransport::recv_cb_);
+
+  esp_now_peer_info_t peer{};
+  memcpy(peer.peer_addr, BROADCAST_ADDR, ESP_NOW_ETH_ALEN);
+  peer.channel = 0;  // whatever channel the radio is on
+  peer.ifidx = mode == WIFI_MODE_AP ? WIFI_IF_AP : WIFI_IF_STA;
+  peer.encrypt = false;
+  err = esp_now_add_peer(&peer);
+  if (err == ESP_ERR_ESPNOW_EXIST) {
+    err = esp_now_mod_peer(&peer);  // restarted in another mode, the interface may have changed
+  }
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Adding the broadcast peer failed: %s", esp_err_to_name(err));
+    esp_now_deinit();
+    return false;
+  }
+  ESP_LOGI(TAG, "ESP-NOW started, node id %08x", (unsigned) this->node_id());
+  return true;
+}
+
+void EspNowFleetTransport::dump_config() {
+  ESP_LOGCONFIG(TAG, "Fleet sync (ESP-NOW):");
+  ESP_LOGCONFIG(TAG, "  Node id: %08x", (unsigned) this->node_id());
+  ESP_LOGCONFIG(TAG, "  Started: %s", YESNO(this->started_));
+}
+
+uint32_t EspNowFleetTransport::node_id() const {
+  uint8_t mac[6];
+  get_mac_address_raw(mac);
+  uint32_t id = encode_uint32(mac[2], mac[3], mac[4], mac[5]);
+  return id != 0 ? id : 1;  // 0 means "nobody" in the fleet messages
+}
+
+void EspNowFleetTransport::send(const uint8_t *data, size_t len) {
+  if (len > FLEET_MAX_MESSAGE) {
+    return;
+  }
+  Packet packet;
+  packet.len = len;
+  memcpy(packet.data, data, len);
+  // A full queue drops the message, fleet sync copes with lost messages
+  this->tx_queue_.push(packet);
+}
+
+size_t EspNowFleetTransport::receive(uint8_t *buf) {
+  Packet packet;
+  if (this->rx_queue_ == nullptr || xQueueReceive(this->rx_queue_, &packet, 0) != pdTRUE) {
+    return 0;
+  }
+  memcpy(buf, packet.data, packet.len);
+  return packet.len;
+}
+
+// Runs in the WiFi task
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+void EspNowFleetTransport::recv_cb_(const esp_now_recv_info_t *info, const uint8_t *data, int len) {
+#else
+void EspNowFleetTransport::recv_cb_(const uint8_t *mac, const uint8_t *data, int len) {
+#endif
+  if (instance == nullptr || instance->rx_queue_ == nullptr || len <= 0 || len > (int) FLEET_MAX_MESSAGE) {
+    return;
+  }
+  Packet packet;
+  packet.len = len;
+  memcpy(packet.data, data, len);
+  // A full queue drops the message, fleet sync copes with lost messages
+  xQueueSend(instance->rx_queue_, &packet, 0);
+}
+
+}  // namespace fleet_sync
+}  // namespace esphome
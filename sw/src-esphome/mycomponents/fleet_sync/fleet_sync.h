@@ -0,0 +1,61 @@
+#pragma once
+
+#include <esp_idf_version.h>
+#include <esp_now.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+#include "esphome/core/component.h"
+
+// Copied into the build by the `includes:` section of config.yaml
+#include "src-common/fleet_sync.hpp"
+#include "src-common/task_queues.hpp"
+
+namespace esphome {
+namespace fleet_sync {
+
+/// Fleet sync transport: ESP-NOW broadcasts, see the "Fleet sync" section of the README.
+///
+/// ESP-NOW needs the WiFi radio. The wifi component only switches it on for OTA updates, so the transport starts it
+/// in station mode itself, without the access point, and again after OTA has switched it off. Until ESP-NOW is up
+/// messages are dropped, the game manager keeps running standalone.
+///
+/// The game manager runs on the game task (src-common/game_loop.hpp), but all ESP-NOW calls are made by the main
+/// loop: send() only queues the message, loop() sends it.
+class EspNowFleetTransport : public Component, public FleetTransport {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::AFTER_WIFI; }
+
+  /// Called from the game task
+  void send(const uint8_t *data, size_t len) override;
+  size_t receive(uint8_t *buf) override;
+
+  /// Unique id of this prop within the fleet, from the MAC address
+  uint32_t node_id() const;
+
+ protected:
+  struct Packet {
+    uint8_t len;
+    uint8_t data[FLEET_MAX_MESSAGE];
+  };
+
+  bool start_();
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  static void recv_cb_(const esp_now_recv_info_t *info, const uint8_t *data, int len);
+#else
+  static void recv_cb_(const uint8_t *mac, const uint8_t *data, int len);
+#endif
+
+  QueueHandle_t rx_queue_{nullptr};
+  /// Messages from the game task waiting for loop(), room for those of a few ticks
+  SpscQueue<Packet, 16> tx_queue_;
+  bool started_{false};  // only used by the main loop
+  uint32_t last_start_attempt_{0};
+  uint32_t send_errors_{0};
+};
+
+}  // namespace fleet_sync
+}  // namespace esphome
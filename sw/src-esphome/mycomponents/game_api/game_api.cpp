@@ -0,0 +1,54 @@
+#include "game_api.h"
+
+#include "esphome/core/log.h"
+
+// Copied into the build by the `includes:` section of config.yaml. Only the esphome-free setup document and mailbox
+// are used here, the game itself lives in main.cpp.
+#include "src-common/game_setup.hpp"
+
+namespace esphome {
+namespace game_api {
+
+static const char *const TAG = "game_api";
+
+class GameApiHandler : public AsyncWebHandler {
+ public:
+  bool canHandle(AsyncWebServerRequest *request) const override {
+    return request->url() == "/game/setup" && request->method() == HTTP_POST;
+  }
+
+  void handleRequest(AsyncWebServerRequest *request) override {
+    GameSetup setup;
+    const char *error = nullptr;
+    for (const char *key : GameSetup::KEYS) {
+      if (error == nullptr && request->hasParam(key)) {
+        error = setup.set(key, request->getParam(key)->value().c_str());
+      }
+    }
+    if (error == nullptr) {
+      error = setup.validate();
+    }
+    if (error != nullptr) {
+      ESP_LOGW(TAG, "Rejected game setup: %s", error);
+      request->send(400, "application/json", (std::string("{\"error\":\"") + error + "\"}").c_str());
+      return;
+    }
+
+    ESP_LOGI(TAG, "Game setup: %s%s", GameSetup::mode_name(setup.mode), setup.start ? " (start)" : "");
+    game_setup_mailbox.post(setup);
+    request->send(200, "application/json", "{\"ok\":true}");
+  }
+
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  bool isRequestHandlerTrivial() const override { return false; }
+};
+
+void GameApi::setup() {
+  // AsyncWebServer takes ownership of the handler and will delete it when the server is destroyed
+  this->base_->add_handler(new GameApiHandler());  // NOLINT
+}
+
+void GameApi::dump_config() { ESP_LOGCONFIG(TAG, "Game API: POST /game/setup"); }
+
+}  // namespace game_api
+}  // namespace esphome
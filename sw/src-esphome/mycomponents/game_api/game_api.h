@@ -0,0 +1,26 @@
+#pragma once
+
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace game_api {
+
+/// HTTP API for setting up games remotely, see the "Remote game setup" section of the README.
+///
+/// Requests are validated in the web server task and handed to the game loop through game_setup_mailbox
+/// (src-common/game_setup.hpp); the game manager is never called from here.
+class GameApi : public Component {
+ public:
+  explicit GameApi(web_server_base::WebServerBase *base) : base_(base) {}
+
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::WIFI - 1.0f; }
+
+ protected:
+  web_server_base::WebServerBase *base_;
+};
+
+}  // namespace game_api
+}  // namespace esphome
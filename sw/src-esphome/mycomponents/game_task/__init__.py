@@ -0,0 +1,48 @@
+# The game on a FreeRTOS task of its own, ticked at fixed deadlines: see game_task.h
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import CONF_ID, CONF_INTERVAL, CONF_PRIORITY
+
+DEPENDENCIES = ["esp32"]
+
+CONF_STACK_SIZE = "stack_size"
+CONF_TICK = "tick"
+CONF_DRAIN = "drain"
+
+game_task_ns = cg.esphome_ns.namespace("game_task")
+GameTask = game_task_ns.class_("GameTask", cg.Component)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(GameTask),
+        cv.Optional(CONF_INTERVAL, default="50ms"): cv.All(
+            cv.positive_time_period_milliseconds,
+            cv.Range(min=cv.TimePeriod(milliseconds=1)),
+        ),
+        # above the main loop (1) and the web servers (5), below lwIP (18) and WiFi (23)
+        cv.Optional(CONF_PRIORITY, default=6): cv.int_range(min=1, max=17),
+        cv.Optional(CONF_STACK_SIZE, default=8192): cv.int_range(min=2048, max=32768),
+        # runs in the game task, with the millis() of the pass as `now`; `deadline` is false for a pass between the
+        # ticks, after wake()
+        cv.Required(CONF_TICK): cv.lambda_,
+        # runs in the main loop, on every loop()
+        cv.Optional(CONF_DRAIN): cv.lambda_,
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    cg.add(var.set_period(config[CONF_INTERVAL].total_milliseconds))
+    cg.add(var.set_priority(config[CONF_PRIORITY]))
+    cg.add(var.set_stack_size(config[CONF_STACK_SIZE]))
+    tick = await cg.process_lambda(
+        config[CONF_TICK],
+        [(cg.uint32, "now"), (cg.bool_, "deadline")],
+        return_type=cg.void,
+    )
+    cg.add(var.set_tick(tick))
+    if CONF_DRAIN in config:
+        drain = await cg.process_lambda(config[CONF_DRAIN], [], return_type=cg.void)
+        cg.add(var.set_drain(drain))
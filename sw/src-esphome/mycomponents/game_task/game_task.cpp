@@ -0,0 +1,91 @@
+#include "game_task.h"
+
+#include <algorithm>
+
+#include <esp_timer.h>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+// Copied into the build by the `includes:` section of config.yaml
+#include "src-common/tick_jitter.hpp"
+
+namespace esphome {
+namespace game_task {
+
+static const char *const TAG = "game_task";
+
+void GameTask::setup() {
+  tick_jitter.period_us = this->period_ms_ * 1000;
+  if (xTaskCreate(GameTask::task_, "game", this->stack_size_, this, this->priority_, &this->handle_) != pdPASS) {
+    ESP_LOGE(TAG, "Creating the game task failed");
+    this->mark_failed();
+    return;
+  }
+  this->set_interval("tick_stats", 60000, []() {
+    ESP_LOGD(TAG, "Ticks since boot: %u, late p99 %u us max %u us, run p99 %u us max %u us, %u skipped",
+             (unsigned) tick_jitter.late.count, (unsigned) tick_jitter.late.percentile(0.99f),
+             (unsigned) tick_jitter.late.max, (unsigned) tick_jitter.run.percentile(0.99f),
+             (unsigned) tick_jitter.run.max, (unsigned) tick_jitter.skipped);
+  });
+}
+
+void GameTask::loop() {
+  if (this->drain_) {
+    this->drain_();
+  }
+}
+
+void GameTask::dump_config() {
+  ESP_LOGCONFIG(TAG, "Game task:");
+  ESP_LOGCONFIG(TAG, "  Interval: %ums", (unsigned) this->period_ms_);
+  ESP_LOGCONFIG(TAG, "  Priority: %u", this->priority_);
+  ESP_LOGCONFIG(TAG, "  Stack size: %u", (unsigned) this->stack_size_);
+  if (this->is_failed()) {
+    ESP_LOGE(TAG, "  The task could not be created");
+  }
+}
+
+void GameTask::wake() {
+  if (this->handle_ != nullptr) {
+    xTaskNotifyGive(this->handle_);
+  }
+}
+
+void GameTask::task_(void *arg) { static_cast<GameTask *>(arg)->run_(); }
+
+void GameTask::run_() {
+  const TickType_t period = std::max<TickType_t>(pdMS_TO_TICKS(this->period_ms_), 1);
+  const int64_t period_us = (int64_t) period * portTICK_PERIOD_MS * 1000;
+  // start on a tick boundary, the deadlines in microseconds are then those of the tick count
+  vTaskDelay(1);
+  TickType_t deadline = xTaskGetTickCount();
+  int64_t deadline_us = esp_timer_get_time();
+  for (;;) {
+    int64_t start = esp_timer_get_time();
+    // a deadline missed altogether is skipped, the game clock takes the real time
+    while (start - deadline_us >= period_us) {
+      deadline += period;
+      deadline_us += period_us;
+      tick_jitter.skipped++;
+    }
+    this->tick_(millis(), true);
+    tick_jitter.tick(start > deadline_us ? (uint32_t) (start - deadline_us) : 0,
+                     (uint32_t) (esp_timer_get_time() - start));
+    deadline += period;
+    deadline_us += period_us;
+
+    // until the next deadline, the keys right away
+    for (;;) {
+      int32_t wait = (int32_t) (deadline - xTaskGetTickCount());
+      if (wait <= 0 || ulTaskNotifyTake(pdTRUE, wait) == 0) {
+        break;
+      }
+      tick_jitter.wakes++;
+      this->tick_(millis(), false);
+    }
+  }
+}
+
+}  // namespace game_task
+}  // namespace esphome
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <functional>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace game_task {
+
+/// The game on a FreeRTOS task of its own, see the "Game task" section of the README and src-common/game_loop.hpp.
+///
+/// The task runs the tick lambda at fixed deadlines a period apart, the scheme of vTaskDelayUntil(): a late tick
+/// doesn't push the ones after it. Its priority is above the main loop and the web servers, so their work (the
+/// requests, the event streams, an OTA upload, the logger, flash writes) no longer delays the game clock, and below the
+/// network stack. Keys wake the task between the deadlines (wake()): the tick lambda runs for them right away, with
+/// `deadline` false, and the deadlines stay. The lateness of each tick and its run time go to
+/// src-common/tick_jitter.hpp, for GET /metrics and a log line a minute.
+///
+/// The drain lambda runs in the main loop on every loop(), for what the task hands back to esphome.
+class GameTask : public Component {
+ public:
+  void set_period(uint32_t period_ms) { this->period_ms_ = period_ms; }
+  void set_priority(uint8_t priority) { this->priority_ = priority; }
+  void set_stack_size(uint32_t stack_size) { this->stack_size_ = stack_size; }
+  void set_tick(std::function<void(uint32_t, bool)> &&tick) { this->tick_ = std::move(tick); }
+  void set_drain(std::function<void()> &&drain) { this->drain_ = std::move(drain); }
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  /// After on_boot has set up the game
+  float get_setup_priority() const override { return setup_priority::LATE; }
+
+  /// Runs the tick lambda as soon as possible, for a key; from any task but an ISR
+  void wake();
+
+ protected:
+  static void task_(void *arg);
+  void run_();
+
+  uint32_t period_ms_{50};
+  uint8_t priority_{6};
+  uint32_t stack_size_{8192};
+  std::function<void(uint32_t, bool)> tick_;
+  std::function<void()> drain_;
+  TaskHandle_t handle_{nullptr};
+};
+
+}  // namespace game_task
+}  // namespace esphome
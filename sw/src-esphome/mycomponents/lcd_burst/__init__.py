@@ -0,0 +1 @@
+# HD44780 LCD behind a PCF8574, written in bursts: see display.py and lcd_burst.h
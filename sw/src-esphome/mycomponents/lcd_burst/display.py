@@ -0,0 +1,44 @@
+# Drop-in for `display: platform: lcd_pcf8574`, with the same options but user_characters
+import esphome.codegen as cg
+from esphome.components import bus_scheduler, i2c, lcd_base
+import esphome.config_validation as cv
+from esphome.const import CONF_ID, CONF_LAMBDA
+
+DEPENDENCIES = ["i2c"]
+AUTO_LOAD = ["bus_scheduler"]
+
+lcd_burst_ns = cg.esphome_ns.namespace("lcd_burst")
+BurstLCDDisplay = lcd_burst_ns.class_(
+    "BurstLCDDisplay", lcd_base.LCDDisplay, i2c.I2CDevice
+)
+
+CONFIG_SCHEMA = lcd_base.LCD_SCHEMA.extend(
+    {
+        cv.GenerateID(): cv.declare_id(BurstLCDDisplay),
+        # frames in chunks between the keypad scans, see mycomponents/bus_scheduler
+        cv.Optional(bus_scheduler.CONF_BUS_SCHEDULER_ID): cv.use_id(
+            bus_scheduler.BusScheduler
+        ),
+        # the CGRAM slots are a cache of the glyphs of src-common/glyphs.hpp, see glyph_cache.h
+        cv.Optional("user_characters"): cv.invalid(
+            "lcd_burst uploads the glyphs of src-common/glyphs.hpp on demand, user_characters are not supported"
+        ),
+    }
+).extend(i2c.i2c_device_schema(0x3F))
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await lcd_base.setup_lcd_display(var, config)
+    await i2c.register_i2c_device(var, config)
+    if bus_scheduler.CONF_BUS_SCHEDULER_ID in config:
+        scheduler = await cg.get_variable(config[bus_scheduler.CONF_BUS_SCHEDULER_ID])
+        cg.add(var.set_bus_scheduler(scheduler))
+
+    if CONF_LAMBDA in config:
+        lambda_ = await cg.process_lambda(
+            config[CONF_LAMBDA],
+            [(BurstLCDDisplay.operator("ref"), "it")],
+            return_type=cg.void,
+        )
+        cg.add(var.set_writer(lambda_))
@@ -0,0 +1,129 @@
+#include "glyph_cache.h"
+
+#include <cstring>
+
+// Copied into the build by the `includes:` section of config.yaml
+#include "src-common/glyphs.hpp"
+
+namespace esphome {
+namespace lcd_burst {
+
+void GlyphCache::map(const uint8_t *cells, size_t n, uint8_t *out) {
+  this->frame_++;
+  this->upload_count_ = 0;
+  // the slots of the glyphs in place first, the missing ones must not take them
+  uint8_t taken = 0;
+  for (size_t i = 0; i < n; i++) {
+    int slot = this->slot_of_(cells[i]);
+    if (slot >= 0) {
+      taken |= 1 << slot;
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    const Glyph *glyph = find_glyph(cells[i]);
+    if (glyph == nullptr) {
+      out[i] = cells[i];
+      continue;
+    }
+    if (glyph->in_rom) {
+      out[i] = glyph->rom;
+      continue;
+    }
+    int slot = this->slot_of_(glyph->id);
+    if (slot < 0) {
+      slot = this->victim_(taken);
+      if (slot < 0) {
+        out[i] = glyph->rom;
+        this->fallbacks_++;
+        continue;
+      }
+      this->glyph_[slot] = glyph->id;
+      this->uploads_[this->upload_count_++] = Upload{(uint8_t) slot, glyph->id};
+      this->uploaded_++;
+      taken |= 1 << slot;
+    }
+    this->used_[slot] = this->frame_;
+    out[i] = slot;
+  }
+  this->shown_ = taken;
+}
+
+size_t GlyphCache::encode(const uint8_t *cells, uint8_t columns, uint8_t rows, uint8_t backlight, uint8_t *buf,
+                          size_t capacity) {
+  uint8_t chars[4 * 20];
+  if ((size_t) columns * rows > sizeof(chars)) {
+    return 0;
+  }
+  this->map(cells, (size_t) columns * rows, chars);
+  size_t len = 0;
+  for (size_t i = 0; i < this->upload_count_; i++) {
+    const Glyph *glyph = find_glyph(this->uploads_[i].glyph);
+    size_t bytes = encode_glyph(this->uploads_[i].slot, glyph->rows, backlight, buf + len, capacity - len);
+    if (bytes == 0) {
+      this->drop_last();
+      return 0;
+    }
+    len += bytes;
+  }
+  size_t bytes = encode_frame(chars, columns, rows, backlight, buf + len, capacity - len);
+  if (bytes == 0) {
+    this->drop_last();
+    return 0;
+  }
+  return len + bytes;
+}
+
+void GlyphCache::drop_last() {
+  for (size_t i = 0; i < this->upload_count_; i++) {
+    if (this->glyph_[this->uploads_[i].slot] == this->uploads_[i].glyph) {
+      this->glyph_[this->uploads_[i].slot] = 0;
+    }
+  }
+  this->upload_count_ = 0;
+}
+
+void GlyphCache::clear() {
+  memset(this->glyph_, 0, sizeof(this->glyph_));
+  this->shown_ = 0;
+  this->upload_count_ = 0;
+}
+
+int GlyphCache::slot_of_(uint8_t glyph) const {
+  if (glyph == 0) {
+    return -1;
+  }
+  for (uint8_t slot = 0; slot < SLOTS; slot++) {
+    if (this->glyph_[slot] == glyph) {
+      return slot;
+    }
+  }
+  return -1;
+}
+
+int GlyphCache::victim_(uint8_t taken) const {
+  // first an empty slot or the least recently used one off the screen, then the least recently used one
+  for (int pass = 0; pass < 2; pass++) {
+    int best = -1;
+    for (uint8_t slot = 0; slot < SLOTS; slot++) {
+      if (taken & 1 << slot) {
+        continue;
+      }
+      if (this->glyph_[slot] == 0) {
+        return slot;
+      }
+      if (pass == 0 && this->shown_ & 1 << slot) {
+        continue;
+      }
+      if (best < 0 || this->used_[slot] < this->used_[best]) {
+        best = slot;
+      }
+    }
+    if (best >= 0) {
+      return best;
+    }
+  }
+  return -1;
+}
+
+}  // namespace lcd_burst
+}  // namespace esphome
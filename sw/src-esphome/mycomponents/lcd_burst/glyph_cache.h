@@ -0,0 +1,73 @@
+#pragma once
+
+// The 8 CGRAM slots of the HD44780 as a cache of the glyphs of src-common/glyphs.hpp.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hd44780_burst.h"
+
+namespace esphome {
+namespace lcd_burst {
+
+/// Keeps the glyphs the frames show in the CGRAM slots of the LCD, uploading only those a frame is missing.
+///
+/// The game code prints glyph ids, map() turns a frame of them into the character codes of the LCD: the slot that holds
+/// the glyph, or the ROM character for the glyphs the ROM has (the full block). A glyph that isn't in a slot takes
+/// one, and is uploaded ahead of the characters of the frame. The slot given up is, in order of preference: an empty
+/// one, the least recently used of those the last frame didn't show, the least recently used of the rest. The LCD
+/// shows a new glyph the moment it is written, in every cell of the slot, so a slot still on the screen changes a
+/// frame early. A slot the frame itself shows is never given up; glyphs that find no slot show their ROM stand-in.
+///
+/// The screens switch between few glyphs (the progress bars and the strokes of the big digits fit into the slots
+/// together), so after the first frame of a glyph there is nothing to upload: the 50ms redraws write the characters
+/// alone.
+class GlyphCache {
+ public:
+  static const uint8_t SLOTS = 8;
+
+  struct Upload {
+    uint8_t slot;
+    uint8_t glyph;
+  };
+
+  /// Maps the n cells of a frame to LCD character codes into out. The glyphs to upload first are uploads().
+  void map(const uint8_t *cells, size_t n, uint8_t *out);
+  /// Maps a frame and encodes its uploads and characters into buf, returns the number of bytes, 0 if they don't fit.
+  size_t encode(const uint8_t *cells, uint8_t columns, uint8_t rows, uint8_t backlight, uint8_t *buf, size_t capacity);
+
+  /// The uploads of the last frame
+  const Upload *uploads() const { return this->uploads_; }
+  size_t upload_count() const { return this->upload_count_; }
+  /// The LCD didn't get the last frame (a write failed, or a newer frame replaced it before it was written): its
+  /// glyphs are uploaded again when needed.
+  void drop_last();
+  /// The CGRAM is unknown, e.g. after a reset of the LCD.
+  void clear();
+
+  /// The glyph in a slot, 0 if empty
+  uint8_t glyph(uint8_t slot) const { return this->glyph_[slot]; }
+  /// Glyphs uploaded and cells shown with their ROM stand-in since the last reset of the statistics.
+  uint32_t uploaded() const { return this->uploaded_; }
+  uint32_t fallbacks() const { return this->fallbacks_; }
+  void reset_stats() { this->uploaded_ = this->fallbacks_ = 0; }
+
+ protected:
+  int slot_of_(uint8_t glyph) const;
+  int victim_(uint8_t taken) const;
+
+  uint8_t glyph_[SLOTS]{};
+  uint32_t used_[SLOTS]{};  // the frame that last showed the slot
+  uint8_t shown_{0};        // the slots the last frame showed, a bit each
+  uint32_t frame_{0};
+  Upload uploads_[SLOTS];
+  size_t upload_count_{0};
+  uint32_t uploaded_{0};
+  uint32_t fallbacks_{0};
+};
+
+/// Bytes of a frame with all slots uploaded ahead of it.
+static const size_t MAX_GLYPH_FRAME_BYTES = GlyphCache::SLOTS * MAX_GLYPH_BYTES + MAX_FRAME_BYTES;
+
+}  // namespace lcd_burst
+}  // namespace esphome
@@ -0,0 +1,49 @@
+#include "hd44780_burst.h"
+
+namespace esphome {
+namespace lcd_burst {
+
+void BurstEncoder::nibble(uint8_t value, bool rs) {
+  uint8_t pins = (value & 0xF0) | (this->pins_ & PCF8574_BACKLIGHT) | (rs ? PCF8574_RS : 0);
+  if (!this->started_ || (pins ^ this->pins_) & PCF8574_RS) {
+    this->put_(pins);  // RS settles before E rises
+    this->started_ = true;
+  }
+  this->put_(pins | PCF8574_E);
+  this->put_(pins);
+}
+
+void BurstEncoder::put_(uint8_t pins) {
+  this->pins_ = pins;
+  if (this->size_ == this->capacity_) {
+    this->overflow_ = true;
+    return;
+  }
+  this->buf_[this->size_++] = pins;
+}
+
+size_t encode_frame(const uint8_t *chars, uint8_t columns, uint8_t rows, uint8_t backlight, uint8_t *buf,
+                    size_t capacity) {
+  // the DDRAM addresses of the rows; rows 3 and 4 continue rows 1 and 2
+  static const uint8_t ROW_ADDR[] = {0x00, 0x40, 0x00, 0x40};
+  BurstEncoder enc(buf, capacity, backlight);
+  for (uint8_t row = 0; row < rows && row < 4; row++) {
+    enc.command(HD44780_SET_DDRAM_ADDR | (ROW_ADDR[row] + (row >= 2 ? columns : 0)));
+    for (uint8_t col = 0; col < columns; col++) {
+      enc.data(chars[row * columns + col]);
+    }
+  }
+  return enc.overflow() ? 0 : enc.size();
+}
+
+size_t encode_glyph(uint8_t slot, const uint8_t *rows, uint8_t backlight, uint8_t *buf, size_t capacity) {
+  BurstEncoder enc(buf, capacity, backlight);
+  enc.command(HD44780_SET_CGRAM_ADDR | (slot & 7) << 3);
+  for (int i = 0; i < 8; i++) {
+    enc.data(rows[i]);
+  }
+  return enc.overflow() ? 0 : enc.size();
+}
+
+}  // namespace lcd_burst
+}  // namespace esphome
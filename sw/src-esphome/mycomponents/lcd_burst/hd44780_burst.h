@@ -0,0 +1,72 @@
+#pragma once
+
+// The bytes of an HD44780 LCD in 4-bit mode behind a PCF8574 I2C port expander, for writing them in bursts: a whole
+// frame in one I2C write instead of a write per pin change.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace lcd_burst {
+
+// Pins of the PCF8574 backpack: P0 RS, P1 RW, P2 E, P3 backlight, P4-P7 D4-D7
+static const uint8_t PCF8574_RS = 0x01;
+static const uint8_t PCF8574_E = 0x04;
+static const uint8_t PCF8574_BACKLIGHT = 0x08;
+
+static const uint8_t HD44780_SET_CGRAM_ADDR = 0x40;
+static const uint8_t HD44780_SET_DDRAM_ADDR = 0x80;
+
+/// Appends the bytes of HD44780 commands and characters to a buffer.
+///
+/// The PCF8574 latches every byte of a write on its pins in turn, so a burst of bytes plays the pin changes of a
+/// sequence of nibbles. The LCD takes a nibble on the falling edge of E, so each nibble is two bytes: with E high,
+/// then the same without E. RS must be stable before E rises, when it changes a byte without E goes first.
+///
+/// The bytes pace the LCD: at 9 bit times a byte, the two bytes of a nibble give the 37us a command or character needs
+/// up to 480 kHz on the bus. Commands that take longer (clear, home) need a pause after the write.
+class BurstEncoder {
+ public:
+  BurstEncoder(uint8_t *buf, size_t capacity, uint8_t backlight) : buf_(buf), capacity_(capacity), pins_(backlight) {}
+
+  void command(uint8_t value) { this->byte_(value, false); }
+  void data(uint8_t value) { this->byte_(value, true); }
+  /// A lone nibble (the upper 4 bits of value), for the 8-bit mode commands of the initialization.
+  void nibble(uint8_t value, bool rs);
+
+  size_t size() const { return this->size_; }
+  /// Bytes that didn't fit into the buffer were dropped.
+  bool overflow() const { return this->overflow_; }
+
+ protected:
+  void byte_(uint8_t value, bool rs) {
+    this->nibble(value & 0xF0, rs);
+    this->nibble(value << 4, rs);
+  }
+  void put_(uint8_t pins);
+
+  uint8_t *buf_;
+  size_t capacity_;
+  size_t size_{0};
+  bool overflow_{false};
+  uint8_t pins_;  // the pins the last byte set, the backlight bit stays
+  bool started_{false};
+};
+
+/// Bytes of a whole frame: at most 4 rows of 20 characters, each row the DDRAM address and its characters.
+static const size_t MAX_FRAME_BYTES = 4 * (1 + 4 + 1 + 4 * 20);
+
+/// Encodes the characters of a rows x columns display (row by row, as LCDDisplay keeps them) into buf, returns the
+/// number of bytes, 0 if they don't fit.
+size_t encode_frame(const uint8_t *chars, uint8_t columns, uint8_t rows, uint8_t backlight, uint8_t *buf,
+                    size_t capacity);
+
+/// Bytes of a glyph upload: the CGRAM address of the slot and the 8 pixel rows.
+static const size_t MAX_GLYPH_BYTES = 1 + 4 + 1 + 4 * 8;
+
+/// Encodes the upload of a glyph (8 pixel rows) into CGRAM slot 0-7, returns the number of bytes, 0 if they don't fit.
+/// The LCD writes DDRAM again after the next DDRAM address, which each row of a frame starts with.
+size_t encode_glyph(uint8_t slot, const uint8_t *rows, uint8_t backlight, uint8_t *buf, size_t capacity);
+
+}  // namespace lcd_burst
+}  // namespace esphome
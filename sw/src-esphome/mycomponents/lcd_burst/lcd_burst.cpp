@@ -0,0 +1,103 @@
+#include "lcd_burst.h"
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace lcd_burst {
+
+static const char *const TAG = "lcd_burst";
+
+void BurstLCDDisplay::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up burst LCD Display...");
+  this->backlight_value_ = PCF8574_BACKLIGHT;
+  if (!this->write_bytes(this->backlight_value_, nullptr, 0)) {
+    this->mark_failed();
+    return;
+  }
+  LCDDisplay::setup();
+  this->set_interval("glyph_stats", 60000, [this]() {
+    ESP_LOGD(TAG, "CGRAM: %u glyph uploads, %u cells without a slot in the last minute", this->glyphs_.uploaded(),
+             this->glyphs_.fallbacks());
+    this->glyphs_.reset_stats();
+  });
+}
+
+void BurstLCDDisplay::dump_config() {
+  ESP_LOGCONFIG(TAG, "Burst LCD Display:");
+  ESP_LOGCONFIG(TAG, "  Columns: %u, Rows: %u", this->columns_, this->rows_);
+  LOG_I2C_DEVICE(this);
+  LOG_UPDATE_INTERVAL(this);
+  if (this->is_failed()) {
+    ESP_LOGE(TAG, "Communication with LCD Display failed!");
+  }
+}
+
+void BurstLCDDisplay::update() {
+  this->clear();
+  this->call_writer();
+  // LCDDisplay::display() would send the characters one by one
+  if (this->bus_scheduler_ != nullptr) {
+    if (!this->bus_scheduler_->done(this->client_)) {
+      // the frame still queued is dropped, this one has all its characters, the glyphs it was to upload may be missing
+      this->glyphs_.drop_last();
+    }
+    this->bus_scheduler_->queue(this->client_, this->frame_, this->encode_(), PCF8574_E);
+    return;
+  }
+  this->write_burst_(this->frame_, this->encode_());
+}
+
+size_t BurstLCDDisplay::encode_() {
+  return this->glyphs_.encode(this->buffer_, this->columns_, this->rows_, this->backlight_value_, this->frame_,
+                              sizeof(this->frame_));
+}
+
+bool BurstLCDDisplay::write_chunk(const uint8_t *data, size_t len) {
+  this->write_burst_(data, len);
+  return !this->status_has_warning();
+}
+
+void BurstLCDDisplay::write_n_bits(uint8_t value, uint8_t n) {
+  // only the initialization of LCDDisplay::setup() writes nibbles, in the low bits
+  uint8_t buf[3];
+  BurstEncoder enc(buf, sizeof(buf), this->backlight_value_);
+  enc.nibble(value << 4, false);
+  this->write_burst_(buf, enc.size());
+  delayMicroseconds(100);  // >37us
+}
+
+void BurstLCDDisplay::send(uint8_t value, bool rs) {
+  // commands and the user defined characters, one write each
+  uint8_t buf[5];
+  BurstEncoder enc(buf, sizeof(buf), this->backlight_value_);
+  if (rs) {
+    enc.data(value);
+  } else {
+    enc.command(value);
+  }
+  this->write_burst_(buf, enc.size());
+}
+
+void BurstLCDDisplay::write_burst_(const uint8_t *data, size_t len) {
+  if (len == 0 || this->write(data, len) != i2c::ERROR_OK) {
+    // the glyphs of the write may not have made it
+    this->glyphs_.clear();
+    this->status_set_warning();
+    return;
+  }
+  this->status_clear_warning();
+}
+
+void BurstLCDDisplay::backlight() {
+  this->backlight_value_ = PCF8574_BACKLIGHT;
+  this->write_bytes(this->backlight_value_, nullptr, 0);
+}
+
+void BurstLCDDisplay::no_backlight() {
+  this->backlight_value_ = 0;
+  this->write_bytes(this->backlight_value_, nullptr, 0);
+}
+
+}  // namespace lcd_burst
+}  // namespace esphome
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "esphome/components/bus_scheduler/bus_scheduler.h"
+#include "esphome/components/i2c/i2c.h"
+#include "esphome/components/lcd_base/lcd_display.h"
+#include "glyph_cache.h"
+#include "hd44780_burst.h"
+
+namespace esphome {
+namespace lcd_burst {
+
+/// HD44780 LCD behind a PCF8574, like `lcd_pcf8574`, that writes each update of the display as one I2C transaction.
+///
+/// The stock driver writes every pin change on its own, three single byte writes a nibble with a 100us pause: 6 I2C
+/// transactions and 640us for each character at 300 kHz. This one encodes the whole frame (hd44780_burst.h) and writes
+/// it at once, the PCF8574 plays the bytes in turn. See bench_lcd_burst in the PC build for the bytes and time on the
+/// bus.
+///
+/// With a bus scheduler, update() only queues the frame, the scheduler writes it in chunks between the keypad scans.
+///
+/// The CGRAM slots hold the glyphs the game code prints (src-common/glyphs.hpp) as a cache (glyph_cache.h): a frame
+/// that shows a glyph the LCD doesn't have uploads it ahead of its characters, in the same write. The user defined
+/// characters of LCDDisplay would take the slots from it and are not supported.
+class BurstLCDDisplay : public lcd_base::LCDDisplay, public i2c::I2CDevice, public bus_scheduler::ChunkWriter {
+ public:
+  void set_writer(std::function<void(BurstLCDDisplay &)> &&writer) { this->writer_ = std::move(writer); }
+  void set_bus_scheduler(bus_scheduler::BusScheduler *scheduler) {
+    this->bus_scheduler_ = &scheduler->scheduler();
+    this->client_ = this->bus_scheduler_->add_client("lcd", this);
+  }
+  void setup() override;
+  void dump_config() override;
+  void update() override;
+  void backlight();
+  void no_backlight();
+  bool write_chunk(const uint8_t *data, size_t len) override;
+
+ protected:
+  bool is_four_bit_mode() override { return true; }
+  void write_n_bits(uint8_t value, uint8_t n) override;
+  void send(uint8_t value, bool rs) override;
+  void call_writer() override { this->writer_(*this); }
+  void write_burst_(const uint8_t *data, size_t len);
+  size_t encode_();
+
+  uint8_t backlight_value_;
+  std::function<void(BurstLCDDisplay &)> writer_;
+  bus_scheduler::TransactionScheduler *bus_scheduler_{nullptr};
+  uint8_t client_{0};
+  GlyphCache glyphs_;
+  uint8_t frame_[MAX_GLYPH_FRAME_BYTES];  // the frame, kept for the scheduler to write
+};
+
+}  // namespace lcd_burst
+}  // namespace esphome
@@ -0,0 +1,27 @@
+import esphome.codegen as cg
+from esphome.components import web_server_base
+from esphome.components.web_server_base import CONF_WEB_SERVER_BASE_ID
+import esphome.config_validation as cv
+from esphome.const import CONF_ID
+
+DEPENDENCIES = ["web_server_base"]
+
+metrics_ns = cg.esphome_ns.namespace("metrics")
+Metrics = metrics_ns.class_("Metrics", cg.Component)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(Metrics),
+        cv.GenerateID(CONF_WEB_SERVER_BASE_ID): cv.use_id(
+            web_server_base.WebServerBase
+        ),
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    # compiles in the scopes of src-common/profiler.hpp, in the game code of main.cpp as well
+    cg.add_build_flag("-DANT_PROFILE")
+    base = await cg.get_variable(config[CONF_WEB_SERVER_BASE_ID])
+    var = cg.new_Pvariable(config[CONF_ID], base)
+    await cg.register_component(var, config)
@@ -0,0 +1,44 @@
+#include "metrics.h"
+
+#include <memory>
+
+#include "esphome/core/log.h"
+
+// Copied into the build by the `includes:` section of config.yaml
+#include "src-common/input_latency.hpp"
+#include "src-common/profiler.hpp"
+#include "src-common/tick_jitter.hpp"
+
+namespace esphome {
+namespace metrics {
+
+static const char *const TAG = "metrics";
+
+class MetricsHandler : public AsyncWebHandler {
+ public:
+  bool canHandle(AsyncWebServerRequest *request) const override {
+    return request->url() == "/metrics" && request->method() == HTTP_GET;
+  }
+
+  void handleRequest(AsyncWebServerRequest *request) override {
+    // the game loop profile, the input latency and the tick jitter of the game task, a blank line apart
+    const size_t size = Profiler::MAX_TEXT + 1 + InputLatency::MAX_TEXT + 1 + TickJitter::MAX_TEXT;
+    std::unique_ptr<char[]> text(new char[size]);  // NOLINT
+    size_t len = profiler.format(text.get(), size);
+    text[len++] = '\n';
+    len += input_latency.format(text.get() + len, size - len);
+    text[len++] = '\n';
+    tick_jitter.format(text.get() + len, size - len);
+    request->send(200, "text/plain", text.get());
+  }
+};
+
+void Metrics::setup() {
+  // AsyncWebServer takes ownership of the handler and will delete it when the server is destroyed
+  this->base_->add_handler(new MetricsHandler());  // NOLINT
+}
+
+void Metrics::dump_config() { ESP_LOGCONFIG(TAG, "Metrics: GET /metrics"); }
+
+}  // namespace metrics
+}  // namespace esphome
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace metrics {
+
+/// Game loop profile and input latency as a plain text page on GET /metrics, see the "Game loop metrics" section of
+/// the README.
+///
+/// The timings are recorded by the game code (src-common/profiler.hpp, src-common/input_latency.hpp) and the game task
+/// (src-common/tick_jitter.hpp); the page only formats them, in the web server task.
+class Metrics : public Component {
+ public:
+  explicit Metrics(web_server_base::WebServerBase *base) : base_(base) {}
+
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::WIFI - 1.0f; }
+
+ protected:
+  web_server_base::WebServerBase *base_;
+};
+
+}  // namespace metrics
+}  // namespace esphome
@@ -0,0 +1,83 @@
+from esphome import automation
+import esphome.codegen as cg
+from esphome.components import bus_scheduler, i2c
+import esphome.config_validation as cv
+from esphome.const import CONF_ID, CONF_TRIGGER_ID
+
+DEPENDENCIES = ["i2c"]
+AUTO_LOAD = ["bus_scheduler"]
+
+CONF_KEYS = "keys"
+CONF_FAST_INTERVAL = "fast_interval"
+CONF_IDLE_INTERVAL = "idle_interval"
+CONF_ACTIVE_TIME = "active_time"
+CONF_DEBOUNCE_TIME = "debounce_time"
+CONF_ON_KEY = "on_key"
+CONF_ON_EDGE = "on_edge"
+
+pcf8574_keypad_ns = cg.esphome_ns.namespace("pcf8574_keypad")
+Pcf8574Keypad = pcf8574_keypad_ns.class_(
+    "Pcf8574Keypad", cg.Component, i2c.I2CDevice
+)
+KeyTrigger = pcf8574_keypad_ns.class_(
+    "KeyTrigger", automation.Trigger.template(cg.uint8)
+)
+EdgeTrigger = pcf8574_keypad_ns.class_(
+    "EdgeTrigger", automation.Trigger.template(cg.uint8, cg.bool_, cg.uint32)
+)
+
+CONFIG_SCHEMA = (
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(Pcf8574Keypad),
+            # the keys row by row, rows on P0-P3 and columns on P4-P7
+            cv.Required(CONF_KEYS): cv.All(cv.string, cv.Length(min=16, max=16)),
+            cv.Optional(
+                CONF_FAST_INTERVAL, default="1ms"
+            ): cv.positive_time_period_microseconds,
+            cv.Optional(
+                CONF_IDLE_INTERVAL, default="16ms"
+            ): cv.positive_time_period_microseconds,
+            cv.Optional(
+                CONF_ACTIVE_TIME, default="500ms"
+            ): cv.positive_time_period_microseconds,
+            cv.Optional(
+                CONF_DEBOUNCE_TIME, default="5ms"
+            ): cv.positive_time_period_microseconds,
+            # keypad scans before LCD chunks, see mycomponents/bus_scheduler
+            cv.Optional(bus_scheduler.CONF_BUS_SCHEDULER_ID): cv.use_id(
+                bus_scheduler.BusScheduler
+            ),
+            cv.Optional(CONF_ON_KEY): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(KeyTrigger)}
+            ),
+            cv.Optional(CONF_ON_EDGE): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(EdgeTrigger)}
+            ),
+        }
+    )
+    .extend(cv.COMPONENT_SCHEMA)
+    .extend(i2c.i2c_device_schema(0x20))
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await i2c.register_i2c_device(var, config)
+    cg.add(var.set_keys(config[CONF_KEYS]))
+    cg.add(var.set_fast_interval(config[CONF_FAST_INTERVAL].total_microseconds))
+    cg.add(var.set_idle_interval(config[CONF_IDLE_INTERVAL].total_microseconds))
+    cg.add(var.set_active_time(config[CONF_ACTIVE_TIME].total_microseconds))
+    cg.add(var.set_debounce(config[CONF_DEBOUNCE_TIME].total_microseconds))
+    if bus_scheduler.CONF_BUS_SCHEDULER_ID in config:
+        scheduler = await cg.get_variable(config[bus_scheduler.CONF_BUS_SCHEDULER_ID])
+        cg.add(var.set_bus_scheduler(scheduler))
+    for conf in config.get(CONF_ON_KEY, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(cg.uint8, "x")], conf)
+    for conf in config.get(CONF_ON_EDGE, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(
+            trigger, [(cg.uint8, "x"), (cg.bool_, "down"), (cg.uint32, "at")], conf
+        )
@@ -0,0 +1,137 @@
+#include "keypad_scanner.h"
+
+namespace esphome {
+namespace pcf8574_keypad {
+
+static uint8_t count_bits(uint8_t bits) {
+  uint8_t n = 0;
+  for (; bits != 0; bits &= bits - 1) {
+    n++;
+  }
+  return n;
+}
+
+size_t KeypadScanner::poll(uint32_t now, KeyEdge *edges) {
+  if (this->started_ && before_(now, this->next_scan_)) {
+    return 0;
+  }
+  if (!this->started_) {
+    this->started_ = true;
+    this->debounce_until_ = this->active_until_ = now;
+  }
+  this->scans_++;
+  size_t count = 0;
+  uint16_t keys;
+  bool ok = this->scan_(keys);
+  if (!ok) {
+    this->errors_++;
+  } else if (keys != this->stable_ && !before_(now, this->debounce_until_)) {
+    uint16_t changed = keys ^ this->stable_;
+    for (uint8_t key = 0; key < KEYS; key++) {
+      if (changed & (1 << key)) {
+        edges[count++] = KeyEdge{key, (keys & (1 << key)) != 0, now};
+      }
+    }
+    this->stable_ = keys;
+    this->debounce_until_ = now + this->debounce_;
+  }
+  if (ok && keys != 0) {
+    this->active_until_ = now + this->active_time_;
+  }
+  this->fast_ = this->stable_ != 0 || before_(now, this->active_until_);
+  this->next_scan_ = now + (this->fast_ ? this->fast_interval_ : this->idle_interval_);
+  return count;
+}
+
+bool KeypadScanner::scan_(uint16_t &keys) {
+  keys = 0;
+  if (this->rest_ == 0xFF) {
+    if (!this->bus_->write_pins(ROWS_LOW)) {
+      return false;
+    }
+    this->rest_ = ROWS_LOW;
+  }
+  uint8_t pins;
+  if (!this->bus_->read_pins(pins)) {
+    return false;
+  }
+  uint8_t lines = ~pins & this->rest_;
+  if (lines != 0 && lines == this->lines_of_(this->last_) && ++this->undecoded_ < DECODE_EVERY) {
+    keys = this->last_;
+    return true;
+  }
+  this->undecoded_ = 0;
+  if (lines != 0 && !this->decode_(lines, keys)) {
+    return false;
+  }
+  this->last_ = keys;
+  return true;
+}
+
+bool KeypadScanner::decode_(uint8_t lines, uint16_t &keys) {
+  // the lines of the other side
+  uint8_t other = ~this->rest_;
+  uint8_t pins;
+  if (!this->bus_->write_read_pins(other, pins)) {
+    this->rest_ = 0xFF;  // the pins are not known
+    return false;
+  }
+  this->rest_ = other;
+  lines |= ~pins & other;
+
+  uint8_t rows = lines & 0x0F;
+  uint8_t columns = lines >> 4;
+  if (count_bits(rows) == 1 || count_bits(columns) == 1) {
+    for (uint8_t row = 0; row < 4; row++) {
+      if (rows & (1 << row)) {
+        keys |= columns << (row * 4);
+      }
+    }
+    return true;
+  }
+  if (rows == 0 || columns == 0) {
+    return true;  // let go between the reads
+  }
+  if (count_bits(rows) == 2 && count_bits(columns) == 2) {
+    return this->scan_rows_(rows, keys);
+  }
+  keys = this->stable_;  // more than two keys
+  return true;
+}
+
+uint8_t KeypadScanner::lines_of_(uint16_t keys) const {
+  uint8_t lines = 0;
+  for (uint8_t row = 0; row < 4; row++) {
+    uint8_t columns = (keys >> (row * 4)) & 0x0F;
+    if (columns != 0) {
+      lines |= (1 << row) | (columns << 4);
+    }
+  }
+  return lines & this->rest_;
+}
+
+bool KeypadScanner::scan_rows_(uint8_t rows, uint16_t &keys) {
+  for (uint8_t row = 0; row < 4; row++) {
+    uint8_t pins;
+    if ((rows & (1 << row)) == 0) {
+      continue;
+    }
+    if (!this->bus_->write_read_pins(0xFF & ~(1 << row), pins)) {
+      this->rest_ = 0xFF;
+      return false;
+    }
+    keys |= ((~pins >> 4) & 0x0F) << (row * 4);
+  }
+  if (!this->bus_->write_pins(this->rest_)) {
+    this->rest_ = 0xFF;
+    return false;
+  }
+  uint8_t high = keys >> 8;
+  if (count_bits(keys & 0xFF) + count_bits(high) > 2) {
+    keys = this->stable_;  // three keys, and the one they make up
+  }
+  return true;
+}
+
+}  // namespace pcf8574_keypad
+}  // namespace esphome
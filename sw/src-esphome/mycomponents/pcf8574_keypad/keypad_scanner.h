@@ -0,0 +1,97 @@
+#pragma once
+
+// Scanner of a 4x4 key matrix on a PCF8574: rows on P0-P3, columns on P4-P7, no diodes.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace pcf8574_keypad {
+
+/// The I2C transactions of a scan. The PCF8574 pins are quasi-bidirectional: a 0 drives the pin low, a 1 pulls it up
+/// weakly, so that a key can pull it low, and a read returns all pins.
+class KeypadBus {
+ public:
+  virtual ~KeypadBus() = default;
+  virtual bool read_pins(uint8_t &pins) = 0;
+  virtual bool write_pins(uint8_t pins) = 0;
+  /// A write and a read in one transaction, with a repeated start.
+  virtual bool write_read_pins(uint8_t out, uint8_t &pins) = 0;
+};
+
+/// A key that went down or up, with the time of the scan that saw the change first.
+struct KeyEdge {
+  uint8_t key;  ///< row * 4 + column, the index into the keys of the keypad
+  bool down;
+  uint32_t at;  ///< us
+};
+
+/// Scans the matrix in as few transactions as the keys down allow, and fast only while the keypad is in use.
+///
+/// Between scans the pins rest with one side of the matrix (the rows or the columns) driven low, so that a scan starts
+/// with a bare read: the lines of the other side a key pulls low. With none, the scan is done, that's the scan of an
+/// idle keypad. The same lines as the keys of the last scan make, the keys are taken as unchanged, but every
+/// DECODE_EVERY scans they are read out anyway: a key on the same line as one held down doesn't change the read.
+/// Otherwise the scan drives the other side low and reads the first, that is where the pins rest until the next scan.
+/// A single row or column gives the keys, two keys on different rows and columns take a read of each of the two rows.
+/// More than two keys can show keys that aren't pressed (there are no diodes), such scans are dropped.
+///
+/// A change of the keys is reported at the scan that sees it, with the time of that scan, and the keys are then held
+/// for the debounce time: changes while the contacts bounce are taken once they persist after it. The scans come every
+/// fast_interval while a key is down and for active_time after the last scan that saw one, every idle_interval
+/// otherwise.
+class KeypadScanner {
+ public:
+  static const size_t KEYS = 16;
+  static const uint8_t ROWS_LOW = 0xF0;  ///< the pins with the rows driven low
+  static const uint8_t DECODE_EVERY = 8;
+
+  explicit KeypadScanner(KeypadBus *bus) : bus_(bus) {}
+
+  void set_fast_interval(uint32_t us) { this->fast_interval_ = us; }
+  void set_idle_interval(uint32_t us) { this->idle_interval_ = us; }
+  void set_active_time(uint32_t us) { this->active_time_ = us; }
+  void set_debounce(uint32_t us) { this->debounce_ = us; }
+
+  /// Scans if a scan is due at now (us), and writes the edges of the keys into edges, which has room for KEYS.
+  /// Returns the number of edges.
+  size_t poll(uint32_t now, KeyEdge *edges);
+
+  /// The keys down after debouncing, a bit for each key.
+  uint16_t keys() const { return this->stable_; }
+  /// Whether the scans come at the fast rate.
+  bool fast() const { return this->fast_; }
+  /// When the next scan is due (us).
+  uint32_t next_scan() const { return this->next_scan_; }
+  uint32_t scans() const { return this->scans_; }
+  uint32_t errors() const { return this->errors_; }
+
+ protected:
+  bool scan_(uint16_t &keys);
+  bool scan_rows_(uint8_t rows, uint16_t &keys);
+  bool decode_(uint8_t lines, uint16_t &keys);
+  /// The lines of the side that isn't driven low at rest that keys pull low
+  uint8_t lines_of_(uint16_t keys) const;
+  static bool before_(uint32_t a, uint32_t b) { return (int32_t) (a - b) < 0; }
+
+  KeypadBus *bus_;
+  uint32_t fast_interval_{1000};
+  uint32_t idle_interval_{16000};
+  uint32_t active_time_{500000};
+  uint32_t debounce_{5000};
+
+  uint8_t rest_{0xFF};  // the pins between scans, 0xFF before the first scan
+  uint16_t stable_{0};
+  uint16_t last_{0};  // the keys of the last scan
+  uint8_t undecoded_{0};  // scans that took the keys of the last one
+  uint32_t next_scan_{0};
+  uint32_t debounce_until_{0};
+  uint32_t active_until_{0};
+  bool fast_{false};
+  bool started_{false};
+  uint32_t scans_{0};
+  uint32_t errors_{0};
+};
+
+}  // namespace pcf8574_keypad
+}  // namespace esphome
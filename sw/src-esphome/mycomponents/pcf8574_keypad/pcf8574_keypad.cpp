@@ -0,0 +1,76 @@
+#include "pcf8574_keypad.h"
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace pcf8574_keypad {
+
+static const char *const TAG = "pcf8574_keypad";
+
+void Pcf8574Keypad::setup() {
+  uint8_t pins;
+  if (!this->read_pins(pins)) {
+    this->mark_failed();
+  }
+}
+
+void Pcf8574Keypad::loop() {
+  KeyEdge edges[KeypadScanner::KEYS];
+  uint32_t now = micros();
+  uint32_t scans = this->scanner_.scans();
+  uint32_t errors = this->scanner_.errors();
+  this->bus_bytes_ = 0;
+  size_t count = this->scanner_.poll(now, edges);
+  if (this->bus_scheduler_ != nullptr) {
+    if (this->scanner_.scans() != scans) {
+      this->bus_scheduler_->record(this->client_, now, micros() - now, this->bus_bytes_,
+                                   this->scanner_.errors() == errors);
+    }
+    this->bus_scheduler_->reserve(this->client_, this->scanner_.next_scan());
+  }
+  if (this->scanner_.fast()) {
+    this->high_freq_.start();
+  } else {
+    this->high_freq_.stop();
+  }
+  uint32_t ms = millis();
+  for (size_t i = 0; i < count; i++) {
+    if (edges[i].key >= this->keys_.size()) {
+      continue;
+    }
+    uint8_t key = this->keys_[edges[i].key];
+    ESP_LOGD(TAG, "key '%c' %s", key, edges[i].down ? "pressed" : "released");
+    this->edge_callback_.call(key, edges[i].down, ms - (now - edges[i].at) / 1000);
+    if (edges[i].down) {
+      this->key_callback_.call(key);
+    }
+  }
+}
+
+void Pcf8574Keypad::dump_config() {
+  ESP_LOGCONFIG(TAG, "PCF8574 keypad: %s", this->keys_.c_str());
+  LOG_I2C_DEVICE(this);
+  if (this->is_failed()) {
+    ESP_LOGE(TAG, "Communication with the PCF8574 failed!");
+  }
+}
+
+bool Pcf8574Keypad::read_pins(uint8_t &pins) {
+  this->bus_bytes_ += 1;
+  return this->read(&pins, 1) == i2c::ERROR_OK;
+}
+
+bool Pcf8574Keypad::write_pins(uint8_t pins) {
+  this->bus_bytes_ += 1;
+  return this->write(&pins, 1) == i2c::ERROR_OK;
+}
+
+bool Pcf8574Keypad::write_read_pins(uint8_t out, uint8_t &pins) {
+  this->bus_bytes_ += 2;
+  // the byte written is what read_register() calls the register, without a stop before the read
+  return this->read_register(out, &pins, 1, false) == i2c::ERROR_OK;
+}
+
+}  // namespace pcf8574_keypad
+}  // namespace esphome
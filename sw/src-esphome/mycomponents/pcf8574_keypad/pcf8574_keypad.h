@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+
+#include "esphome/components/bus_scheduler/bus_scheduler.h"
+#include "esphome/components/i2c/i2c.h"
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "keypad_scanner.h"
+
+namespace esphome {
+namespace pcf8574_keypad {
+
+/// 4x4 keypad on a PCF8574, in place of matrix_keypad on the pins of a pcf8574 hub. See keypad_scanner.h for the scan,
+/// and the "Keypad" section of the README for its bus time and latency.
+///
+/// on_key fires for each key that goes down (x), like the one of matrix_keypad. on_edge fires for each key that goes
+/// down or up: the key (x), down, and the millis() of the scan that saw it (at). The main loop runs without its pause
+/// while the scans are fast, and every 16ms otherwise, an idle scan each pass. With a bus scheduler, each scan reserves
+/// the time of the next one, so that the LCD leaves the bus free for it.
+class Pcf8574Keypad : public Component, public i2c::I2CDevice, public KeypadBus {
+ public:
+  void set_keys(const std::string &keys) { this->keys_ = keys; }
+  void set_fast_interval(uint32_t us) { this->scanner_.set_fast_interval(us); }
+  void set_idle_interval(uint32_t us) { this->scanner_.set_idle_interval(us); }
+  void set_active_time(uint32_t us) { this->scanner_.set_active_time(us); }
+  void set_debounce(uint32_t us) { this->scanner_.set_debounce(us); }
+  void set_bus_scheduler(bus_scheduler::BusScheduler *scheduler) {
+    this->bus_scheduler_ = &scheduler->scheduler();
+    this->client_ = this->bus_scheduler_->add_client("keypad");
+  }
+
+  void add_on_key_callback(std::function<void(uint8_t)> &&callback) { this->key_callback_.add(std::move(callback)); }
+  void add_on_edge_callback(std::function<void(uint8_t, bool, uint32_t)> &&callback) {
+    this->edge_callback_.add(std::move(callback));
+  }
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  bool read_pins(uint8_t &pins) override;
+  bool write_pins(uint8_t pins) override;
+  bool write_read_pins(uint8_t out, uint8_t &pins) override;
+
+ protected:
+  KeypadScanner scanner_{this};
+  std::string keys_;
+  HighFrequencyLoopRequester high_freq_;
+  bus_scheduler::TransactionScheduler *bus_scheduler_{nullptr};
+  uint8_t client_{0};
+  uint32_t bus_bytes_{0};  // data bytes of the transactions, for the scheduler
+  CallbackManager<void(uint8_t)> key_callback_;
+  CallbackManager<void(uint8_t, bool, uint32_t)> edge_callback_;
+};
+
+class KeyTrigger : public Trigger<uint8_t> {
+ public:
+  explicit KeyTrigger(Pcf8574Keypad *parent) {
+    parent->add_on_key_callback([this](uint8_t key) { this->trigger(key); });
+  }
+};
+
+class EdgeTrigger : public Trigger<uint8_t, bool, uint32_t> {
+ public:
+  explicit EdgeTrigger(Pcf8574Keypad *parent) {
+    parent->add_on_edge_callback([this](uint8_t key, bool down, uint32_t at) { this->trigger(key, down, at); });
+  }
+};
+
+}  // namespace pcf8574_keypad
+}  // namespace esphome
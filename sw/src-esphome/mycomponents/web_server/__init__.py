@@ -2,8 +2,10 @@ from __future__ import annotations
 
 import gzip
 
+from esphome import automation
 import esphome.codegen as cg
 from esphome.components import web_server_base
+from esphome.components.esp32 import add_idf_sdkconfig_option
 from esphome.components.web_server_base import CONF_WEB_SERVER_BASE_ID
 import esphome.config_validation as cv
 from esphome.const import (
@@ -21,6 +23,7 @@ from esphome.const import (
     CONF_OTA,
     CONF_PASSWORD,
     CONF_PORT,
+    CONF_TRIGGER_ID,
     CONF_USERNAME,
     CONF_VERSION,
     CONF_WEB_SERVER,
@@ -42,10 +45,24 @@ CONF_SORTING_GROUPS = "sorting_groups"
 CONF_SORTING_WEIGHT = "sorting_weight"
 
 CONF_INDEX_HTML_INCLUDE = "index_html_include"
+CONF_REMOTE_KEYPAD = "remote_keypad"
+CONF_HTML_INCLUDE = "html_include"
+CONF_ON_KEY = "on_key"
+CONF_LCD_MIRROR = "lcd_mirror"
+CONF_MAX_FPS = "max_fps"
+CONF_ENTITY_BATCH = "entity_batch"
+CONF_MAX_BYTES = "max_bytes"
+CONF_UI_PARTITION = "ui_partition"
+CONF_PARTITION = "partition"
 
 
 web_server_ns = cg.esphome_ns.namespace("web_server")
 WebServer = web_server_ns.class_("WebServer", cg.Component, cg.Controller)
+RemoteKeypad = web_server_ns.class_("RemoteKeypad")
+UIPartition = web_server_ns.class_("UIPartition")
+RemoteKeyTrigger = web_server_ns.class_(
+    "RemoteKeyTrigger", automation.Trigger.template(cg.uint8, cg.uint32)
+)
 
 sorting_groups = {}
 
@@ -76,6 +93,19 @@ def validate_local(config: ConfigType) -> ConfigType:
     return config
 
 
+def validate_ui_partition(config: ConfigType) -> ConfigType:
+    # With a UI partition the pages are uploaded on POST /ui, the firmware only has UI_UPLOAD_HTML
+    if CONF_UI_PARTITION in config and (
+        CONF_INDEX_HTML_INCLUDE in config
+        or CONF_HTML_INCLUDE in config.get(CONF_REMOTE_KEYPAD, {})
+    ):
+        raise cv.Invalid(
+            f"'{CONF_INDEX_HTML_INCLUDE}' and '{CONF_HTML_INCLUDE}' can't be used with '{CONF_UI_PARTITION}', "
+            f"the pages are served from the partition"
+        )
+    return config
+
+
 def validate_ota(config: ConfigType) -> ConfigType:
     # The OTA option only accepts False to explicitly disable OTA for web_server
     # IMPORTANT: Setting ota: false ONLY affects the web_server component
@@ -163,6 +193,60 @@ WEBSERVER_SORTING_SCHEMA = cv.Schema(
 )
 
 
+# Phone keypad over a WebSocket on its own port, see README.md
+REMOTE_KEYPAD_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(RemoteKeypad),
+            cv.Optional(CONF_PORT, default=81): cv.port,
+            cv.Optional(CONF_HTML_INCLUDE): cv.file_,
+            cv.Optional(CONF_ON_KEY): automation.validate_automation(
+                {
+                    cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(RemoteKeyTrigger),
+                }
+            ),
+        }
+    ),
+    cv.only_with_esp_idf,
+)
+
+
+# LCD contents as `lcd` events on /events?lcd=1, see README.md
+LCD_MIRROR_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_MAX_FPS, default=10): cv.int_range(min=1, max=50),
+        }
+    ),
+    cv.only_with_esp_idf,
+)
+
+
+# Initial entity dump as `entities` events holding several entities each, see README.md
+ENTITY_BATCH_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_MAX_BYTES, default=1024): cv.int_range(min=256, max=4096),
+        }
+    ),
+    cv.only_with_esp_idf,
+)
+
+
+# Pages served from their own data partition, uploaded on POST /ui, see README.md
+UI_PARTITION_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(UIPartition),
+            cv.Optional(CONF_PARTITION, default="webui"): cv.All(
+                cv.string_strict, cv.Length(min=1, max=15)
+            ),
+        }
+    ),
+    cv.only_with_esp_idf,
+)
+
+
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
@@ -193,6 +277,10 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(CONF_LOG, default=True): cv.boolean,
             cv.Optional(CONF_LOCAL): cv.boolean,
             cv.Optional(CONF_SORTING_GROUPS): cv.ensure_list(sorting_group),
+            cv.Optional(CONF_REMOTE_KEYPAD): REMOTE_KEYPAD_SCHEMA,
+            cv.Optional(CONF_LCD_MIRROR): LCD_MIRROR_SCHEMA,
+            cv.Optional(CONF_ENTITY_BATCH): ENTITY_BATCH_SCHEMA,
+            cv.Optional(CONF_UI_PARTITION): UI_PARTITION_SCHEMA,
         }
     ).extend(cv.COMPONENT_SCHEMA),
     cv.only_on(
@@ -208,6 +296,7 @@ CONFIG_SCHEMA = cv.All(
     validate_local,
     validate_sorting_groups,
     validate_ota,
+    validate_ui_partition,
 )
 
 
@@ -237,6 +326,19 @@ async def add_entity_config(entity, config):
     )
 
 
+# The built-in index page with a UI partition, for while the partition has no valid image: the forms to upload one
+# (make ui) and a firmware
+UI_UPLOAD_HTML = (
+    "<!DOCTYPE html><html><head><meta charset=UTF-8><meta name=viewport content=width=device-width>"
+    "<title>Upload</title></head><body><p>No web UI installed.</p>"
+    "<form method=post action=/ui enctype=multipart/form-data>"
+    "<input type=file name=file accept=.bin> <button>Upload web UI</button></form><br>"
+    "<form method=post action=/update enctype=multipart/form-data>"
+    "<input type=file name=update accept=.bin,.gz,.antp> <button>Update firmware</button></form>"
+    "</body></html>"
+)
+
+
 def build_index_html(config) -> str:
     html = "<!DOCTYPE html><html><head><meta charset=UTF-8><link rel=icon href=data:>"
     css_include = config.get(CONF_CSS_INCLUDE)
@@ -287,7 +389,9 @@ async def to_code(config):
     cg.add_define("USE_WEBSERVER_PORT", config[CONF_PORT])
     cg.add_define("USE_WEBSERVER_VERSION", version)
     if version >= 2:
-        if CONF_INDEX_HTML_INCLUDE in config:
+        if CONF_UI_PARTITION in config:
+            add_resource_as_progmem("INDEX_HTML", UI_UPLOAD_HTML)
+        elif CONF_INDEX_HTML_INCLUDE in config:
             path = CORE.relative_config_path(config[CONF_INDEX_HTML_INCLUDE])
             with open(file=path, encoding="utf-8") as html_file:
                 add_resource_as_progmem("INDEX_HTML", html_file.read())
@@ -326,3 +430,39 @@ async def to_code(config):
     if (sorting_group_config := config.get(CONF_SORTING_GROUPS)) is not None:
         cg.add_define("USE_WEBSERVER_SORTING")
         add_sorting_groups(var, sorting_group_config)
+
+    if (keypad_config := config.get(CONF_REMOTE_KEYPAD)) is not None:
+        cg.add_define("USE_WEBSERVER_REMOTE_KEYPAD")
+        cg.add_define("USE_WEBSERVER_LCD")
+        add_idf_sdkconfig_option("CONFIG_HTTPD_WS_SUPPORT", True)
+        keypad = cg.new_Pvariable(keypad_config[CONF_ID], keypad_config[CONF_PORT])
+        cg.add(var.set_remote_keypad(keypad))
+        if CONF_HTML_INCLUDE in keypad_config:
+            path = CORE.relative_config_path(keypad_config[CONF_HTML_INCLUDE])
+            with open(file=path, encoding="utf-8") as html_file:
+                add_resource_as_progmem("KEYPAD_HTML", html_file.read())
+            cg.add(
+                keypad.set_page(
+                    cg.RawExpression("ESPHOME_WEBSERVER_KEYPAD_HTML"),
+                    cg.RawExpression("ESPHOME_WEBSERVER_KEYPAD_HTML_SIZE"),
+                )
+            )
+        for conf in keypad_config.get(CONF_ON_KEY, []):
+            trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], keypad)
+            await automation.build_automation(
+                trigger, [(cg.uint8, "x"), (cg.uint32, "ticket")], conf
+            )
+
+    if (mirror_config := config.get(CONF_LCD_MIRROR)) is not None:
+        cg.add_define("USE_WEBSERVER_LCD_MIRROR")
+        cg.add_define("USE_WEBSERVER_LCD")
+        cg.add(var.set_lcd_mirror_fps(mirror_config[CONF_MAX_FPS]))
+
+    if (batch_config := config.get(CONF_ENTITY_BATCH)) is not None:
+        cg.add_define("USE_WEBSERVER_ENTITY_BATCH")
+        cg.add(var.set_entity_batch_bytes(batch_config[CONF_MAX_BYTES]))
+
+    if (ui_config := config.get(CONF_UI_PARTITION)) is not None:
+        cg.add_define("USE_WEBSERVER_UI_PARTITION")
+        ui_partition = cg.new_Pvariable(ui_config[CONF_ID], ui_config[CONF_PARTITION])
+        cg.add(var.set_ui_partition(ui_partition))
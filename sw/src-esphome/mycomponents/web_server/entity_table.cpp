@@ -0,0 +1,236 @@
+#include "entity_table.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace web_server {
+
+namespace {
+
+/// One top level member of a JSON object, as offsets into its text.
+struct Member {
+  size_t begin;  // the opening quote of the key
+  size_t key_len;
+  size_t end;  // past the value
+};
+
+size_t skip_space(const std::string &s, size_t i) {
+  while (i < s.size() && (s[i] == ' ' || s[i] == '\n' || s[i] == '\r' || s[i] == '\t'))
+    i++;
+  return i;
+}
+
+/// Past the closing quote of the string starting at i, or npos.
+size_t skip_string(const std::string &s, size_t i) {
+  for (i++; i < s.size(); i++) {
+    if (s[i] == '\\') {
+      i++;
+    } else if (s[i] == '"') {
+      return i + 1;
+    }
+  }
+  return std::string::npos;
+}
+
+/// Splits a JSON object into its top level members. Only as much is checked as is needed to find them.
+bool split_members(const std::string &s, std::vector<Member> &members) {
+  size_t i = skip_space(s, 0);
+  if (i >= s.size() || s[i] != '{')
+    return false;
+  i = skip_space(s, i + 1);
+  if (i < s.size() && s[i] == '}')
+    return true;
+  while (i < s.size()) {
+    if (s[i] != '"')
+      return false;
+    Member m{i, 0, 0};
+    size_t key_end = skip_string(s, i);
+    if (key_end == std::string::npos)
+      return false;
+    m.key_len = key_end - i - 2;
+    i = skip_space(s, key_end);
+    if (i >= s.size() || s[i] != ':')
+      return false;
+    // the value ends at the first comma or brace at the top level
+    int depth = 0;
+    for (i++; i < s.size(); i++) {
+      char c = s[i];
+      if (c == '"') {
+        i = skip_string(s, i);
+        if (i == std::string::npos)
+          return false;
+        i--;
+      } else if (c == '{' || c == '[') {
+        depth++;
+      } else if (c == ']' || (c == '}' && depth > 0)) {
+        depth--;
+      } else if (depth == 0 && (c == ',' || c == '}')) {
+        break;
+      }
+    }
+    if (i >= s.size())
+      return false;
+    m.end = i;
+    while (m.end > m.begin && (s[m.end - 1] == ' ' || s[m.end - 1] == '\n' || s[m.end - 1] == '\r'))
+      m.end--;
+    members.push_back(m);
+    if (s[i] == '}')
+      return true;
+    i = skip_space(s, i + 1);
+  }
+  return false;
+}
+
+/// The members of an object without the braces.
+bool inner(JsonView s, size_t &begin, size_t &len) {
+  const char *open = static_cast<const char *>(memchr(s.data, '{', s.size));
+  size_t close = s.size;
+  while (close != 0 && s.data[close - 1] != '}')
+    close--;
+  if (open == nullptr || close == 0)
+    return false;
+  begin = open - s.data + 1;
+  if (close - 1 < begin)
+    return false;
+  len = close - 1 - begin;
+  return true;
+}
+
+}  // namespace
+
+void EntityTable::add(void *source, state_t *state, generator_t *all, bool cached) {
+  this->entries_.push_back(Entry{source, state, all, 0, 0, cached, 0});
+}
+
+void EntityTable::build(WebServer *ws) {
+  std::string members;
+  for (Entry &entry : this->entries_) {
+    members.clear();
+    entry.changed = this->seq_;
+    if (!entry.cached)
+      continue;
+    JsonView state = entry.state(ws, entry.source);
+    if (!static_members(entry.all(ws, entry.source), std::string(state.data, state.size), members) ||
+        members.size() > UINT16_MAX) {
+      entry.cached = false;
+      continue;
+    }
+    entry.detail_offset = this->details_.size();
+    entry.detail_len = members.size();
+    this->details_ += members;
+  }
+  this->details_.shrink_to_fit();
+  this->built_ = true;
+}
+
+bool EntityTable::static_members(const std::string &all, const std::string &state, std::string &out) {
+  std::vector<Member> all_members, state_members;
+  if (!split_members(all, all_members) || !split_members(state, state_members))
+    return false;
+  for (const Member &m : all_members) {
+    bool live = std::any_of(state_members.begin(), state_members.end(), [&](const Member &s) {
+      return s.key_len == m.key_len && memcmp(state.data() + s.begin, all.data() + m.begin, m.key_len + 2) == 0;
+    });
+    if (live)
+      continue;
+    if (!out.empty())
+      out += ',';
+    out.append(all, m.begin, m.end - m.begin);
+  }
+  return true;
+}
+
+void EntityTable::changed(void *source) {
+  for (Entry &entry : this->entries_) {
+    if (entry.source == source) {
+      entry.changed = ++this->seq_;
+      return;
+    }
+  }
+}
+
+bool EntityTable::resumable(uint32_t seq) const {
+  // a number of this boot, the distances from the base can't wrap
+  return this->built_ && seq - this->base_ <= this->seq_ - this->base_;
+}
+
+EntityCursor EntityTable::cursor(uint32_t last_id) const {
+  EntityCursor cursor;
+  if (last_id != 0 && this->resumable(last_id)) {
+    cursor.since = last_id;
+    cursor.full = false;
+  }
+  return cursor;
+}
+
+bool EntityTable::next_batch(WebServer *ws, EntityCursor &cursor, size_t max_bytes, std::string &out,
+                             uint32_t &id) const {
+  if (!cursor.in_pass) {
+    if (!cursor.full && cursor.since == this->seq_)
+      return false;
+    cursor.in_pass = true;
+    cursor.until = this->seq_;
+    cursor.next = 0;
+  }
+  cursor.batch_end = this->write_(ws, cursor.next, cursor.full, cursor.since, max_bytes, out);
+  // ids only on the last batch of a pass, a client that drops out in the middle resumes from the previous pass
+  id = cursor.batch_end == this->entries_.size() ? cursor.until : 0;
+  return true;
+}
+
+void EntityTable::consume(EntityCursor &cursor) const {
+  cursor.next = cursor.batch_end;
+  if (cursor.next == this->entries_.size()) {
+    cursor.since = cursor.until;
+    cursor.full = false;
+    cursor.in_pass = false;
+  }
+}
+
+size_t EntityTable::write_(WebServer *ws, size_t index, bool all, uint32_t since, size_t max_bytes,
+                           std::string &out) const {
+  auto wanted = [&](size_t i) { return all || (int32_t) (this->entries_[i].changed - since) > 0; };
+  out.clear();
+  out += '[';
+  for (; index < this->entries_.size(); index++) {
+    if (!wanted(index))
+      continue;
+    size_t before = out.size();
+    if (before > 1)
+      out += ',';
+    this->write_entity_(ws, this->entries_[index], out);
+    // an entity that doesn't fit goes first into the next batch
+    if (before > 1 && out.size() + 1 > max_bytes) {
+      out.resize(before);
+      break;
+    }
+  }
+  while (index < this->entries_.size() && !wanted(index))
+    index++;
+  out += ']';
+  return index;
+}
+
+void EntityTable::write_entity_(WebServer *ws, const Entry &entry, std::string &out) const {
+  if (!entry.cached) {
+    out += entry.all(ws, entry.source);
+    return;
+  }
+  // appended straight from the buffer of the web server, the state isn't copied on its own
+  JsonView state = entry.state(ws, entry.source);
+  size_t begin, len;
+  if (!inner(state, begin, len)) {
+    out += entry.all(ws, entry.source);
+    return;
+  }
+  out += '{';
+  out.append(state.data + begin, len);
+  if (len != 0 && entry.detail_len != 0)
+    out += ',';
+  out.append(this->details_, entry.detail_offset, entry.detail_len);
+  out += '}';
+}
+
+}  // namespace web_server
+}  // namespace esphome
@@ -0,0 +1,120 @@
+#pragma once
+
+// Entity table for the batched initial entity dump of the /events clients.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "json_writer.h"
+
+namespace esphome {
+namespace web_server {
+
+class WebServer;
+
+/// Position of one /events client in the entity stream of an EntityTable.
+struct EntityCursor {
+  /// The client has the state of all entities up to this change.
+  uint32_t since{0};
+  /// The client has nothing to resume from, the next pass sends all entities.
+  bool full{true};
+  /// A pass sends the entities that changed after `since` (or all of them), up to change `until`.
+  bool in_pass{false};
+  uint32_t until{0};
+  /// The next entity of the pass, and the one after the batch that is being sent.
+  size_t next{0};
+  size_t batch_end{0};
+};
+
+/** The entities of the web server in iteration order, with the static part of their detail written once.
+ *
+ * A state_detail_all object is made of members that change with the state ("id", "value", "state", ...) and members
+ * that don't ("name", "icon", "entity_category", sorting, traits, ...). build() takes the latter out of the detail JSON
+ * of each entity once and keeps them in one buffer. A batch then only runs the state generator of each entity and
+ * appends the cached members, and packs several entities into one JSON array.
+ *
+ * The table also numbers the state changes and keeps the latest one of each entity. A client is sent the entities in
+ * passes, each pass the ones that changed since the previous pass, and the last batch of a pass carries the number
+ * of the change it is complete up to as its event id. A client that reconnects with that id as Last-Event-ID is only
+ * sent what changed in the meantime.
+ */
+class EntityTable {
+ public:
+  /// A *_json_generator of WebServer.
+  using generator_t = std::string(WebServer *, void *);
+  /// A *_state_json of WebServer: the state object in the buffer of the web server, valid until the next one.
+  using state_t = JsonView(WebServer *, void *);
+
+  /// Adds an entity, in the order of the dump.
+  /// @param state Writes the state object of the entity, the members of which are live.
+  /// @param all Writes the state_detail_all object of the entity.
+  /// @param cached Whether the members of `all` that aren't in `state` never change. If not, `all` is used as is.
+  void add(void *source, state_t *state, generator_t *all, bool cached);
+  /// Writes the static members of the cached entities. Called once, after all entities are added.
+  void build(WebServer *ws);
+  /// Numbers the changes from `base` on, which must not be 0. The numbers of a boot shouldn't be mistaken for those of
+  /// another boot, nor for other event ids.
+  void start_sequence(uint32_t base) { this->base_ = this->seq_ = base; }
+
+  /// Marks the state of an entity as changed, entities that aren't in the table are ignored.
+  void changed(void *source);
+  /// The number of the latest change.
+  uint32_t seq() const { return this->seq_; }
+  /// Whether a client that has the state up to change `seq` can be sent only the changes after it.
+  bool resumable(uint32_t seq) const;
+  /// A cursor for a new client, that resumes after `last_id` if possible (0 for none).
+  EntityCursor cursor(uint32_t last_id) const;
+
+  /// Writes the next batch for a client.
+  /// @param id The event id of the batch: the change the client has everything up to once it has the batch, or 0.
+  /// @return false if the client is up to date.
+  bool next_batch(WebServer *ws, EntityCursor &cursor, size_t max_bytes, std::string &out, uint32_t &id) const;
+  /// Moves the cursor past the batch of next_batch(), once it is sent.
+  void consume(EntityCursor &cursor) const;
+
+  bool built() const { return this->built_; }
+  size_t size() const { return this->entries_.size(); }
+  /// Bytes used by the static members of all entities.
+  size_t detail_bytes() const { return this->details_.size(); }
+
+  /// Writes a JSON array of the state_detail_all objects of the entities from `index` on, as many as fit into
+  /// `max_bytes` but at least one.
+  /// @return The index of the first entity that isn't in the batch.
+  size_t write_batch(WebServer *ws, size_t index, size_t max_bytes, std::string &out) const {
+    return this->write_(ws, index, true, 0, max_bytes, out);
+  }
+
+  /// The members of the JSON object `all` whose keys are not in the JSON object `state`, comma separated and without
+  /// the braces.
+  /// @return false if either is not a JSON object.
+  static bool static_members(const std::string &all, const std::string &state, std::string &out);
+
+ protected:
+  struct Entry {
+    void *source;
+    state_t *state;
+    generator_t *all;
+    uint32_t detail_offset;
+    uint16_t detail_len;
+    bool cached;
+    uint32_t changed;
+  };
+
+  /// Writes a batch of all entities, or of those that changed after `since`. Unchanged entities after the batch are
+  /// skipped, so that the last batch of a pass ends at size().
+  size_t write_(WebServer *ws, size_t index, bool all, uint32_t since, size_t max_bytes, std::string &out) const;
+  /// Appends the state_detail_all object of one entity.
+  void write_entity_(WebServer *ws, const Entry &entry, std::string &out) const;
+
+  std::vector<Entry> entries_;
+  /// The static members of all cached entities, one allocation for all of them.
+  std::string details_;
+  bool built_{false};
+  uint32_t base_{1};
+  uint32_t seq_{1};
+};
+
+}  // namespace web_server
+}  // namespace esphome
@@ -0,0 +1,157 @@
+#include "json_writer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace esphome {
+namespace web_server {
+
+JsonWriter::JsonWriter(char *buffer, size_t size) : buffer_(buffer), size_(size) {
+  if (size == 0) {
+    this->overflow_ = true;
+  } else {
+    buffer[0] = '\0';
+  }
+}
+
+void JsonWriter::begin_object() {
+  this->raw_("{", 1);
+  this->first_ = true;
+}
+
+void JsonWriter::end_object() { this->raw_("}", 1); }
+
+void JsonWriter::add(const char *key, const char *value) { this->add(key, value, strlen(value)); }
+
+void JsonWriter::add(const char *key, const char *value, size_t len) {
+  this->key_(key);
+  this->raw_("\"", 1);
+  this->string_(value, len);
+  this->raw_("\"", 1);
+}
+
+void JsonWriter::add(const char *key, const char *prefix, const std::string &value) {
+  this->key_(key);
+  this->raw_("\"", 1);
+  this->string_(prefix, strlen(prefix));
+  this->string_(value.data(), value.size());
+  this->raw_("\"", 1);
+}
+
+void JsonWriter::add(const char *key, bool value) {
+  this->key_(key);
+  if (value) {
+    this->raw_("true", 4);
+  } else {
+    this->raw_("false", 5);
+  }
+}
+
+void JsonWriter::add(const char *key, int value) {
+  char buf[12];
+  int len = snprintf(buf, sizeof(buf), "%d", value);
+  this->key_(key);
+  this->raw_(buf, len);
+}
+
+void JsonWriter::add(const char *key, float value) {
+  this->key_(key);
+  if (!std::isfinite(value)) {
+    this->raw_("null", 4);
+    return;
+  }
+  // the shortest form that reads back as the same float, at most 9 digits are needed
+  char buf[24];
+  int len = 0;
+  for (int digits = 6; digits <= 9; digits++) {
+    len = snprintf(buf, sizeof(buf), "%.*g", digits, value);
+    if (strtof(buf, nullptr) == value)
+      break;
+  }
+  this->raw_(buf, len);
+}
+
+void JsonWriter::add_decimal(const char *key, float value, int decimals, const std::string &unit) {
+  char buf[40];
+  int len = snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+  if (len < 0 || (size_t) len >= sizeof(buf)) {
+    // a huge number: the JSON can't be right, rather than sending something else
+    this->overflow_ = true;
+    return;
+  }
+  this->key_(key);
+  this->raw_("\"", 1);
+  this->raw_(buf, len);
+  if (!unit.empty()) {
+    this->raw_(" ", 1);
+    this->string_(unit.data(), unit.size());
+  }
+  this->raw_("\"", 1);
+}
+
+void JsonWriter::key_(const char *key) {
+  if (!this->first_) {
+    this->raw_(",", 1);
+  }
+  this->first_ = false;
+  this->raw_("\"", 1);
+  this->raw_(key, strlen(key));
+  this->raw_("\":", 2);
+}
+
+void JsonWriter::raw_(const char *data, size_t len) {
+  if (this->overflow_ || len >= this->size_ - this->len_) {
+    this->overflow_ = true;
+    return;
+  }
+  memcpy(this->buffer_ + this->len_, data, len);
+  this->len_ += len;
+  this->buffer_[this->len_] = '\0';
+}
+
+void JsonWriter::string_(const char *data, size_t len) {
+  static const char HEX[] = "0123456789abcdef";
+  size_t plain = 0;
+  for (size_t i = 0; i < len; i++) {
+    unsigned char c = data[i];
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+    // copy the plain characters in one go, then the escape sequence
+    this->raw_(data + plain, i - plain);
+    plain = i + 1;
+    char escape[6] = {'\\', 0, '0', '0', HEX[c >> 4], HEX[c & 0xf]};
+    switch (c) {
+      case '"':
+      case '\\':
+        escape[1] = c;
+        break;
+      case '\b':
+        escape[1] = 'b';
+        break;
+      case '\f':
+        escape[1] = 'f';
+        break;
+      case '\n':
+        escape[1] = 'n';
+        break;
+      case '\r':
+        escape[1] = 'r';
+        break;
+      case '\t':
+        escape[1] = 't';
+        break;
+      default:
+        escape[1] = 'u';
+        this->raw_(escape, 6);
+        continue;
+    }
+    this->raw_(escape, 2);
+  }
+  this->raw_(data + plain, len - plain);
+}
+
+}  // namespace web_server
+}  // namespace esphome
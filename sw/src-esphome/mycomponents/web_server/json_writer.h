@@ -0,0 +1,64 @@
+#pragma once
+
+// Streaming JSON writer for the state events.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+namespace web_server {
+
+/// JSON text in a buffer owned by someone else, valid until the owner writes the next one.
+struct JsonView {
+  const char *data;
+  size_t size;
+};
+
+/** Writes one flat JSON object straight into a caller owned buffer, without building a document first.
+ *
+ * Keys are written as given (they are literals), string values are escaped. The output is bounded by the buffer: once
+ * something doesn't fit, nothing more is written and ok() returns false, the caller then has to take another way.
+ */
+class JsonWriter {
+ public:
+  /// @param buffer Output, NUL terminated while ok().
+  /// @param size Size of the buffer, including the NUL.
+  JsonWriter(char *buffer, size_t size);
+
+  void begin_object();
+  void end_object();
+
+  void add(const char *key, const char *value);
+  void add(const char *key, const std::string &value) { this->add(key, value.data(), value.size()); }
+  void add(const char *key, const char *value, size_t len);
+  /// A string value made of two parts, e.g. the entity id "sensor-" + object id.
+  void add(const char *key, const char *prefix, const std::string &value);
+  void add(const char *key, bool value);
+  void add(const char *key, int value);
+  /// A number, or null if it's not finite.
+  void add(const char *key, float value);
+  /// A string value of the number with a fixed number of decimals (as value_accuracy_to_string()), followed by a space
+  /// and the unit if there is one.
+  void add_decimal(const char *key, float value, int decimals, const std::string &unit = std::string());
+
+  bool ok() const { return !this->overflow_; }
+  const char *c_str() const { return this->buffer_; }
+  size_t size() const { return this->len_; }
+  std::string str() const { return std::string(this->buffer_, this->len_); }
+  JsonView view() const { return JsonView{this->buffer_, this->len_}; }
+
+ protected:
+  void key_(const char *key);
+  void raw_(const char *data, size_t len);
+  void string_(const char *data, size_t len);
+
+  char *buffer_;
+  size_t size_;
+  size_t len_{0};
+  bool first_{true};
+  bool overflow_{false};
+};
+
+}  // namespace web_server
+}  // namespace esphome
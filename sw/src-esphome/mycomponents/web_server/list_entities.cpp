@@ -16,178 +16,137 @@ ListEntitiesIterator::ListEntitiesIterator(const WebServer *ws, DeferredUpdateEv
 #ifdef USE_ESP_IDF
 ListEntitiesIterator::ListEntitiesIterator(const WebServer *ws, AsyncEventSource *es) : web_server_(ws), events_(es) {}
 #endif
+ListEntitiesIterator::ListEntitiesIterator(const WebServer *ws, EntityTable *table) : web_server_(ws), table_(table) {}
 ListEntitiesIterator::~ListEntitiesIterator() {}
 
-#ifdef USE_BINARY_SENSOR
-bool ListEntitiesIterator::on_binary_sensor(binary_sensor::BinarySensor *obj) {
+bool ListEntitiesIterator::add_(void *source, EntityTable::state_t *state, EntityTable::generator_t *all,
+                                bool cached) {
+  if (this->table_ != nullptr) {
+    this->table_->add(source, state, all, cached);
+    return true;
+  }
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+  // the entities are sent in batches by WebServer::entity_dump_loop_()
+  return true;
+#else
   if (this->events_->count() == 0)
     return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::binary_sensor_all_json_generator);
+  this->events_->deferrable_send_state(source, "state_detail_all", all);
   return true;
+#endif
+}
+
+#ifdef USE_BINARY_SENSOR
+bool ListEntitiesIterator::on_binary_sensor(binary_sensor::BinarySensor *obj) {
+  return this->add_(obj, WebServer::binary_sensor_state_json, WebServer::binary_sensor_all_json_generator);
 }
 #endif
 #ifdef USE_COVER
 bool ListEntitiesIterator::on_cover(cover::Cover *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::cover_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::cover_state_json, WebServer::cover_all_json_generator);
 }
 #endif
 #ifdef USE_FAN
 bool ListEntitiesIterator::on_fan(fan::Fan *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::fan_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::fan_state_json, WebServer::fan_all_json_generator);
 }
 #endif
 #ifdef USE_LIGHT
 bool ListEntitiesIterator::on_light(light::LightState *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::light_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::light_state_json, WebServer::light_all_json_generator);
 }
 #endif
 #ifdef USE_SENSOR
 bool ListEntitiesIterator::on_sensor(sensor::Sensor *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::sensor_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::sensor_state_json, WebServer::sensor_all_json_generator);
 }
 #endif
 #ifdef USE_SWITCH
 bool ListEntitiesIterator::on_switch(switch_::Switch *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::switch_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::switch_state_json, WebServer::switch_all_json_generator);
 }
 #endif
 #ifdef USE_BUTTON
 bool ListEntitiesIterator::on_button(button::Button *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::button_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::button_state_json, WebServer::button_all_json_generator);
 }
 #endif
 #ifdef USE_TEXT_SENSOR
 bool ListEntitiesIterator::on_text_sensor(text_sensor::TextSensor *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::text_sensor_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::text_sensor_state_json, WebServer::text_sensor_all_json_generator);
 }
 #endif
 #ifdef USE_LOCK
 bool ListEntitiesIterator::on_lock(lock::Lock *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::lock_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::lock_state_json, WebServer::lock_all_json_generator);
 }
 #endif
 
 #ifdef USE_VALVE
 bool ListEntitiesIterator::on_valve(valve::Valve *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::valve_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::valve_state_json, WebServer::valve_all_json_generator);
 }
 #endif
 
 #ifdef USE_CLIMATE
 bool ListEntitiesIterator::on_climate(climate::Climate *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::climate_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::climate_state_json, WebServer::climate_all_json_generator);
 }
 #endif
 
 #ifdef USE_NUMBER
 bool ListEntitiesIterator::on_number(number::Number *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::number_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::number_state_json, WebServer::number_all_json_generator);
 }
 #endif
 
 #ifdef USE_DATETIME_DATE
 bool ListEntitiesIterator::on_date(datetime::DateEntity *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::date_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::date_state_json, WebServer::date_all_json_generator);
 }
 #endif
 
 #ifdef USE_DATETIME_TIME
 bool ListEntitiesIterator::on_time(datetime::TimeEntity *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::time_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::time_state_json, WebServer::time_all_json_generator);
 }
 #endif
 
 #ifdef USE_DATETIME_DATETIME
 bool ListEntitiesIterator::on_datetime(datetime::DateTimeEntity *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::datetime_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::datetime_state_json, WebServer::datetime_all_json_generator);
 }
 #endif
 
 #ifdef USE_TEXT
 bool ListEntitiesIterator::on_text(text::Text *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::text_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::text_state_json, WebServer::text_all_json_generator);
 }
 #endif
 
 #ifdef USE_SELECT
 bool ListEntitiesIterator::on_select(select::Select *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::select_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::select_state_json, WebServer::select_all_json_generator);
 }
 #endif
 
 #ifdef USE_ALARM_CONTROL_PANEL
 bool ListEntitiesIterator::on_alarm_control_panel(alarm_control_panel::AlarmControlPanel *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::alarm_control_panel_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::alarm_control_panel_state_json,
+                    WebServer::alarm_control_panel_all_json_generator);
 }
 #endif
 
 #ifdef USE_EVENT
 bool ListEntitiesIterator::on_event(event::Event *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  // Null event type, since we are just iterating over entities
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::event_all_json_generator);
-  return true;
+  return this->add_(obj, WebServer::event_state_json, WebServer::event_all_json_generator);
 }
 #endif
 
 #ifdef USE_UPDATE
 bool ListEntitiesIterator::on_update(update::UpdateEntity *obj) {
-  if (this->events_->count() == 0)
-    return true;
-  this->events_->deferrable_send_state(obj, "state_detail_all", WebServer::update_all_json_generator);
-  return true;
+  // the release notes change with the available update
+  return this->add_(obj, WebServer::update_state_json, WebServer::update_all_json_generator, false);
 }
 #endif
 
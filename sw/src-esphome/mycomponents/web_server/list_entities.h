@@ -4,6 +4,9 @@
 #ifdef USE_WEBSERVER
 #include "esphome/core/component.h"
 #include "esphome/core/component_iterator.h"
+
+#include "entity_table.h"
+
 namespace esphome {
 #ifdef USE_ESP_IDF
 namespace web_server_idf {
@@ -25,6 +28,8 @@ class ListEntitiesIterator : public ComponentIterator {
 #ifdef USE_ESP_IDF
   ListEntitiesIterator(const WebServer *ws, esphome::web_server_idf::AsyncEventSource *es);
 #endif
+  /// Adds the entities to a table instead of sending them.
+  ListEntitiesIterator(const WebServer *ws, EntityTable *table);
   virtual ~ListEntitiesIterator();
 #ifdef USE_BINARY_SENSOR
   bool on_binary_sensor(binary_sensor::BinarySensor *obj) override;
@@ -89,13 +94,16 @@ class ListEntitiesIterator : public ComponentIterator {
   bool completed() { return this->state_ == IteratorState::NONE; }
 
  protected:
+  bool add_(void *source, EntityTable::state_t *state, EntityTable::generator_t *all, bool cached = true);
+
   const WebServer *web_server_;
 #ifdef USE_ARDUINO
-  DeferredUpdateEventSource *events_;
+  DeferredUpdateEventSource *events_{nullptr};
 #endif
 #ifdef USE_ESP_IDF
-  esphome::web_server_idf::AsyncEventSource *events_;
+  esphome::web_server_idf::AsyncEventSource *events_{nullptr};
 #endif
+  EntityTable *table_{nullptr};
 };
 
 }  // namespace web_server
@@ -0,0 +1,90 @@
+#include "log_ring.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+namespace esphome {
+namespace web_server {
+
+void LogBatch::consume(LogCursor &cursor, bool marker_sent, size_t sent) const {
+  if (this->dropped_ != 0 && !marker_sent) {
+    sent = 0;  // nothing goes out ahead of the marker
+  }
+  cursor.dropped = marker_sent ? 0 : this->dropped_;
+  cursor.seq = sent < this->count_ ? this->lines_[sent].seq : this->end_seq_;
+}
+
+LogRing::LogRing(size_t bytes, size_t max_lines)
+    : buf_(new char[bytes]), entries_(new Entry[max_lines]), bytes_(bytes), max_lines_(max_lines) {}
+
+uint32_t LogRing::push(uint8_t level, const char *text, size_t len) {
+  // a line must fit into a batch, and shouldn't flush most of the history on its own
+  len = std::min(len, std::min(this->bytes_ / 4, LogBatch::MAX_BYTES) - 1);
+  uint32_t need = len + 1;
+  uint32_t start = this->head_;
+  uint32_t offset = start & (this->bytes_ - 1);
+  if (offset + need > this->bytes_) {
+    start += this->bytes_ - offset;  // skip the tail end of the ring, a line is never split
+  }
+  // make room by dropping the oldest lines
+  while (this->size() != 0) {
+    uint32_t oldest = this->entries_[this->first_seq_ & (this->max_lines_ - 1)].pos;
+    if (this->size() < this->max_lines_ && start + need - oldest <= this->bytes_) {
+      break;
+    }
+    this->first_seq_++;
+  }
+
+  char *dst = &this->buf_[start & (this->bytes_ - 1)];
+  memcpy(dst, text, len);
+  dst[len] = '\0';
+  this->entries_[this->next_seq_ & (this->max_lines_ - 1)] = Entry{start, static_cast<uint16_t>(len), level};
+  this->head_ = start + need;
+  return this->next_seq_++;
+}
+
+void LogRing::read(const LogCursor &cursor, LogBatch &batch) const {
+  uint32_t seq = cursor.seq;
+  batch.count_ = 0;
+  batch.dropped_ = cursor.dropped;
+  if (static_cast<int32_t>(this->first_seq_ - seq) > 0) {
+    batch.dropped_ += this->first_seq_ - seq;
+    seq = this->first_seq_;
+  }
+
+  size_t used = 0;
+  for (; seq != this->next_seq_ && batch.count_ < LogBatch::MAX_LINES; seq++) {
+    const Entry &e = this->entries_[seq & (this->max_lines_ - 1)];
+    if (e.level > cursor.level) {
+      continue;
+    }
+    if (used + e.len + 1 > LogBatch::MAX_BYTES) {
+      break;
+    }
+    memcpy(batch.text_ + used, &this->buf_[e.pos & (this->bytes_ - 1)], e.len + 1);
+    batch.lines_[batch.count_++] = LogBatch::Line{seq, static_cast<uint16_t>(used), e.level};
+    used += e.len + 1;
+  }
+  batch.end_seq_ = seq;
+}
+
+bool LogRing::parse_level(const char *name, uint8_t &level) {
+  static const char *const NAMES[] = {"NONE", "ERROR", "WARN", "INFO", "CONFIG", "DEBUG", "VERBOSE", "VERY_VERBOSE"};
+  for (size_t i = 0; i < sizeof(NAMES) / sizeof(NAMES[0]); i++) {
+    if (strcasecmp(name, NAMES[i]) == 0) {
+      level = i;
+      return true;
+    }
+  }
+  if (isdigit(static_cast<unsigned char>(name[0])) && name[1] == '\0') {
+    level = name[0] - '0';
+    return level < sizeof(NAMES) / sizeof(NAMES[0]);
+  }
+  return false;
+}
+
+}  // namespace web_server
+}  // namespace esphome
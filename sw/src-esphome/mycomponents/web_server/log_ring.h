@@ -0,0 +1,104 @@
+#pragma once
+
+// Log buffering for the /events log stream.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esphome {
+namespace web_server {
+
+/// Read position of one log stream client in a LogRing.
+struct LogCursor {
+  /// Sequence number of the next line to deliver.
+  uint32_t seq{0};
+  /// Most verbose level delivered to this client (ESPHOME_LOG_LEVEL_*), lines above it are skipped.
+  uint8_t level{UINT8_MAX};
+  /// Lines that were overwritten before this client read them and haven't been reported yet.
+  uint32_t dropped{0};
+};
+
+class LogRing;
+
+/// Lines copied out of a LogRing for one client, so that they can be sent without holding the lock of the ring.
+class LogBatch {
+ public:
+  static constexpr size_t MAX_LINES = 16;
+  static constexpr size_t MAX_BYTES = 1024;
+
+  size_t size() const { return this->count_; }
+  /// NUL terminated text of line i.
+  const char *text(size_t i) const { return this->text_ + this->lines_[i].offset; }
+  uint8_t level(size_t i) const { return this->lines_[i].level; }
+  /// Lines dropped for the client before this batch, to be reported ahead of it.
+  uint32_t dropped() const { return this->dropped_; }
+
+  /// Advance the cursor past what was actually sent: the dropped marker (if any) and the first sent lines.
+  void consume(LogCursor &cursor, bool marker_sent, size_t sent) const;
+
+ protected:
+  friend class LogRing;
+
+  struct Line {
+    uint32_t seq;
+    uint16_t offset;
+    uint8_t level;
+  };
+
+  Line lines_[MAX_LINES];
+  char text_[MAX_BYTES];
+  size_t count_{0};
+  uint32_t dropped_{0};
+  uint32_t end_seq_{0};  // the cursor position once the whole batch is sent
+};
+
+/// Fixed size in-RAM log ring buffer with sequence numbers.
+///
+/// Lines are stored back to back in a byte ring (a line never wraps around the end), the oldest lines are overwritten
+/// when either the bytes or the line slots run out. Every client reads at its own pace through a LogCursor; a client
+/// that falls behind by more than the ring holds loses the overwritten lines and is told how many.
+///
+/// Not thread safe, the caller serializes push() and read().
+class LogRing {
+ public:
+  /// Both sizes must be powers of two.
+  LogRing(size_t bytes, size_t max_lines);
+
+  /// Append a line, truncated to a quarter of the ring. Returns its sequence number.
+  uint32_t push(uint8_t level, const char *text, size_t len);
+
+  /// Copy the next lines for a client into a batch, without moving its cursor (see LogBatch::consume()).
+  void read(const LogCursor &cursor, LogBatch &batch) const;
+
+  /// Cursor for a new client, positioned at the oldest line that is still buffered.
+  LogCursor oldest(uint8_t level) const { return LogCursor{this->first_seq_, level, 0}; }
+  /// Cursor for a new client that only wants lines logged from now on.
+  LogCursor newest(uint8_t level) const { return LogCursor{this->next_seq_, level, 0}; }
+
+  size_t size() const { return this->next_seq_ - this->first_seq_; }
+  uint32_t first_seq() const { return this->first_seq_; }
+  uint32_t next_seq() const { return this->next_seq_; }
+
+  /// Parse a level name (ERROR, WARN, INFO, CONFIG, DEBUG, VERBOSE, VERY_VERBOSE, case insensitive) or number.
+  /// Returns false if it is neither.
+  static bool parse_level(const char *name, uint8_t &level);
+
+ protected:
+  struct Entry {
+    uint32_t pos;  // position of the text in the byte stream, the ring offset is pos & (bytes_ - 1)
+    uint16_t len;
+    uint8_t level;
+  };
+
+  std::unique_ptr<char[]> buf_;
+  std::unique_ptr<Entry[]> entries_;
+  size_t bytes_;
+  size_t max_lines_;
+  uint32_t head_{0};  // stream position where the next line goes
+  uint32_t first_seq_{0};
+  uint32_t next_seq_{0};
+};
+
+}  // namespace web_server
+}  // namespace esphome
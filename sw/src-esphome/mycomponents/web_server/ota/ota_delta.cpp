@@ -0,0 +1,234 @@
+#include "ota_delta.h"
+
+#include <cstring>
+#include <utility>
+
+namespace esphome {
+namespace web_server {
+
+static const uint8_t PATCH_MAGIC[4] = {'A', 'N', 'T', 'P'};
+
+static uint32_t read_le32(const uint8_t *p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+OTADeltaDecoder::OTADeltaDecoder(read_old_t read_old, uint32_t old_size, const uint8_t *base_id, sink_t sink)
+    : read_old_(std::move(read_old)), sink_(std::move(sink)), old_limit_(old_size), base_id_(base_id) {}
+
+bool OTADeltaDecoder::is_patch(const uint8_t *data, size_t len) {
+  return len >= sizeof(PATCH_MAGIC) && memcmp(data, PATCH_MAGIC, sizeof(PATCH_MAGIC)) == 0;
+}
+
+OTADeltaDecoder::Error OTADeltaDecoder::fail_(Error err) {
+  this->state_ = State::FAILED;
+  return err;
+}
+
+OTADeltaDecoder::Error OTADeltaDecoder::parse_header_() {
+  const uint8_t *h = this->header_;
+  if (!is_patch(h, HEADER_SIZE) || h[4] != VERSION)
+    return ERROR_FORMAT;
+  this->old_size_ = read_le32(h + 8);
+  this->new_size_ = read_le32(h + 12);
+  memcpy(this->new_sha256_, h + 48, sizeof(this->new_sha256_));
+  if (this->old_size_ > this->old_limit_)
+    return ERROR_BASE;
+
+  static const uint8_t NO_ID[ID_SIZE] = {};
+  const uint8_t *patch_base_id = h + 16;
+  if (this->base_id_ != nullptr && memcmp(patch_base_id, NO_ID, ID_SIZE) != 0 &&
+      memcmp(patch_base_id, this->base_id_, ID_SIZE) != 0)
+    return ERROR_BASE;
+
+  this->sha256_.init();
+  this->old_pos_ = 0;
+  this->produced_ = 0;
+  return OK;
+}
+
+bool OTADeltaDecoder::read_varint_(const uint8_t *&data, size_t &len) {
+  while (len > 0) {
+    uint8_t b = *data++;
+    len--;
+    this->value_ |= uint32_t(b & 0x7F) << this->value_shift_;
+    this->value_shift_ += 7;
+    if ((b & 0x80) == 0 || this->value_shift_ >= 35) {
+      this->value_shift_ = 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+OTADeltaDecoder::Error OTADeltaDecoder::emit_(const uint8_t *data, size_t len) {
+  if (len > this->new_size_ - this->produced_)
+    return ERROR_SIZE;
+  this->sha256_.update(data, len);
+  this->produced_ += len;
+  this->sink_error_ = this->sink_(data, len);
+  return this->sink_error_ == 0 ? OK : ERROR_SINK;
+}
+
+OTADeltaDecoder::Error OTADeltaDecoder::copy_old_(uint32_t len) {
+  while (len > 0) {
+    size_t n = len < OUT_CHUNK ? len : OUT_CHUNK;
+    if (this->old_pos_ > this->old_size_ || n > this->old_size_ - this->old_pos_ ||
+        !this->read_old_(this->old_pos_, this->out_, n))
+      return ERROR_OLD_READ;
+    Error err = this->emit_(this->out_, n);
+    if (err != OK)
+      return err;
+    this->old_pos_ += n;
+    len -= n;
+  }
+  return OK;
+}
+
+OTADeltaDecoder::Error OTADeltaDecoder::add_old_(const uint8_t *diff, size_t len) {
+  while (len > 0) {
+    size_t n = len < OUT_CHUNK ? len : OUT_CHUNK;
+    if (this->old_pos_ > this->old_size_ || n > this->old_size_ - this->old_pos_ ||
+        !this->read_old_(this->old_pos_, this->out_, n))
+      return ERROR_OLD_READ;
+    for (size_t i = 0; i < n; i++)
+      this->out_[i] += diff[i];
+    Error err = this->emit_(this->out_, n);
+    if (err != OK)
+      return err;
+    this->old_pos_ += n;
+    diff += n;
+    len -= n;
+  }
+  return OK;
+}
+
+void OTADeltaDecoder::next_record_() {
+  this->old_pos_ += this->seek_;
+  this->state_ = this->produced_ == this->new_size_ ? State::DONE : State::DIFF_LEN;
+}
+
+OTADeltaDecoder::Error OTADeltaDecoder::feed(const uint8_t *data, size_t len) {
+  while (len > 0) {
+    switch (this->state_) {
+      case State::HEADER: {
+        size_t n = HEADER_SIZE - this->header_len_;
+        if (n > len)
+          n = len;
+        memcpy(this->header_ + this->header_len_, data, n);
+        this->header_len_ += n;
+        data += n;
+        len -= n;
+        if (this->header_len_ == HEADER_SIZE) {
+          Error err = this->parse_header_();
+          if (err != OK)
+            return this->fail_(err);
+          this->value_ = 0;
+          this->state_ = this->new_size_ == 0 ? State::DONE : State::DIFF_LEN;
+        }
+        break;
+      }
+      case State::DIFF_LEN:
+        if (!this->read_varint_(data, len))
+          break;
+        this->diff_remaining_ = this->value_;
+        this->value_ = 0;
+        this->state_ = State::EXTRA_LEN;
+        break;
+      case State::EXTRA_LEN:
+        if (!this->read_varint_(data, len))
+          break;
+        this->extra_len_ = this->value_;
+        this->value_ = 0;
+        this->state_ = State::SEEK;
+        break;
+      case State::SEEK:
+        if (!this->read_varint_(data, len))
+          break;
+        this->seek_ = int32_t(this->value_ >> 1) ^ -int32_t(this->value_ & 1);
+        this->value_ = 0;
+        if (uint64_t(this->diff_remaining_) + this->extra_len_ > this->new_size_ - this->produced_)
+          return this->fail_(ERROR_SIZE);
+        if (this->diff_remaining_ > 0) {
+          this->state_ = State::ZERO_RUN;
+        } else if (this->extra_len_ > 0) {
+          this->state_ = State::EXTRA_BYTES;
+        } else {
+          this->next_record_();
+        }
+        break;
+      case State::ZERO_RUN: {
+        if (!this->read_varint_(data, len))
+          break;
+        uint32_t zeros = this->value_;
+        this->value_ = 0;
+        if (zeros > this->diff_remaining_)
+          return this->fail_(ERROR_FORMAT);
+        Error err = this->copy_old_(zeros);
+        if (err != OK)
+          return this->fail_(err);
+        this->diff_remaining_ -= zeros;
+        this->state_ = State::LITERAL_RUN;
+        break;
+      }
+      case State::LITERAL_RUN:
+        if (!this->read_varint_(data, len))
+          break;
+        this->run_remaining_ = this->value_;
+        this->value_ = 0;
+        if (this->run_remaining_ > this->diff_remaining_)
+          return this->fail_(ERROR_FORMAT);
+        this->diff_remaining_ -= this->run_remaining_;
+        this->state_ = State::LITERAL_BYTES;
+        break;
+      case State::LITERAL_BYTES: {
+        size_t n = this->run_remaining_ < len ? this->run_remaining_ : len;
+        Error err = this->add_old_(data, n);
+        if (err != OK)
+          return this->fail_(err);
+        data += n;
+        len -= n;
+        this->run_remaining_ -= n;
+        break;
+      }
+      case State::EXTRA_BYTES: {
+        size_t n = this->extra_len_ < len ? this->extra_len_ : len;
+        Error err = this->emit_(data, n);
+        if (err != OK)
+          return this->fail_(err);
+        data += n;
+        len -= n;
+        this->extra_len_ -= n;
+        break;
+      }
+      case State::DONE:
+        // trailing garbage after the last record
+        return this->fail_(ERROR_SIZE);
+      case State::FAILED:
+        return ERROR_FORMAT;
+    }
+
+    // Zero length runs and sections complete without consuming input, so advance those states here as well
+    if (this->state_ == State::LITERAL_BYTES && this->run_remaining_ == 0) {
+      this->state_ = this->diff_remaining_ > 0 ? State::ZERO_RUN : State::EXTRA_BYTES;
+    }
+    if (this->state_ == State::EXTRA_BYTES && this->extra_len_ == 0) {
+      this->next_record_();
+    }
+  }
+  return OK;
+}
+
+OTADeltaDecoder::Error OTADeltaDecoder::finish() {
+  if (this->state_ == State::FAILED)
+    return ERROR_FORMAT;
+  if (this->state_ != State::DONE || this->produced_ != this->new_size_)
+    return this->fail_(this->state_ == State::HEADER ? ERROR_FORMAT : ERROR_SIZE);
+  uint8_t digest[OTASha256::DIGEST_SIZE];
+  this->sha256_.final(digest);
+  if (memcmp(digest, this->new_sha256_, sizeof(digest)) != 0)
+    return this->fail_(ERROR_HASH);
+  return OK;
+}
+
+}  // namespace web_server
+}  // namespace esphome
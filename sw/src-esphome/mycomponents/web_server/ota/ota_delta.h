@@ -0,0 +1,129 @@
+#pragma once
+
+// Streaming decoder for delta OTA patches.
+//
+// A patch describes the new firmware image in terms of the image that is currently running, bsdiff style: the new
+// image is produced by a sequence of records, each consisting of a "diff" section (bytes of the old image with a
+// delta added to them), an "extra" section (literal new bytes) and a seek in the old image. Firmware builds change
+// little between versions apart from shifted addresses, so the diff sections are mostly zero and are run length
+// encoded.
+//
+// Patch layout (all integers little endian):
+//
+//   header (80 bytes):
+//     char     magic[4]         "ANTP"
+//     uint8_t  version          1
+//     uint8_t  reserved[3]
+//     uint32_t old_size         size of the base image
+//     uint32_t new_size         size of the image produced by the patch
+//     uint8_t  base_id[32]      app_elf_sha256 from the base image's app descriptor, all zero if unknown
+//     uint8_t  new_sha256[32]   SHA-256 of the complete new image
+//   records, until new_size bytes have been produced:
+//     varint   diff_len
+//     varint   extra_len
+//     zigzag   seek             added to the old image position after the diff section
+//     diff_len bytes of diff, as pairs of { varint zero_run, varint literal_run, literal_run bytes }
+//     extra_len literal bytes
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "ota_stream.h"
+
+namespace esphome {
+namespace web_server {
+
+class OTADeltaDecoder {
+ public:
+  static constexpr size_t HEADER_SIZE = 80;
+  static constexpr size_t ID_SIZE = 32;
+  static constexpr uint8_t VERSION = 1;
+  /// Offset of esp_app_desc_t::app_elf_sha256 in an ESP32 app image, used as base_id
+  static constexpr size_t APP_ELF_SHA256_OFFSET = 176;
+
+  enum Error : uint8_t {
+    OK = 0,
+    ERROR_FORMAT,     ///< not a patch or corrupt record
+    ERROR_BASE,       ///< patch was made for a different base image
+    ERROR_OLD_READ,   ///< patch references bytes outside of the base image
+    ERROR_SIZE,       ///< produced more or fewer bytes than announced
+    ERROR_HASH,       ///< result doesn't match new_sha256
+    ERROR_SINK,       ///< the sink failed, see sink_error()
+  };
+
+  /// Read len bytes of the base image at offset. Returns false on failure.
+  using read_old_t = std::function<bool(uint32_t offset, uint8_t *buf, size_t len)>;
+  /// Receives the new image. Returns 0 on success or an error code that is kept in sink_error().
+  using sink_t = std::function<uint8_t(const uint8_t *data, size_t len)>;
+
+  /**
+   * @param old_size Size of the readable base image (e.g. the running app partition)
+   * @param base_id Identity of the running image (ID_SIZE bytes), nullptr to skip the base check
+   */
+  OTADeltaDecoder(read_old_t read_old, uint32_t old_size, const uint8_t *base_id, sink_t sink);
+
+  /// Whether the data starts with the patch magic.
+  static bool is_patch(const uint8_t *data, size_t len);
+
+  /// Decode the next chunk of the patch. Chunks can be split at any byte.
+  Error feed(const uint8_t *data, size_t len);
+  /// Check that the patch was complete and the new image hash matches.
+  Error finish();
+
+  uint8_t sink_error() const { return this->sink_error_; }
+  uint32_t new_size() const { return this->new_size_; }
+  uint32_t produced() const { return this->produced_; }
+
+ protected:
+  enum class State : uint8_t {
+    HEADER,
+    DIFF_LEN,
+    EXTRA_LEN,
+    SEEK,
+    ZERO_RUN,
+    LITERAL_RUN,
+    LITERAL_BYTES,
+    EXTRA_BYTES,
+    DONE,
+    FAILED,
+  };
+  static constexpr size_t OUT_CHUNK = 256;
+
+  Error parse_header_();
+  /// Returns true once a complete varint has been read into value_.
+  bool read_varint_(const uint8_t *&data, size_t &len);
+  Error emit_(const uint8_t *data, size_t len);
+  Error copy_old_(uint32_t len);
+  Error add_old_(const uint8_t *diff, size_t len);
+  void next_record_();
+  Error fail_(Error err);
+
+  read_old_t read_old_;
+  sink_t sink_;
+  uint32_t old_limit_;
+  const uint8_t *base_id_;
+
+  State state_{State::HEADER};
+  uint8_t header_[HEADER_SIZE];
+  size_t header_len_{0};
+  uint32_t value_{0};
+  uint8_t value_shift_{0};
+
+  uint32_t old_size_{0};
+  uint32_t new_size_{0};
+  uint8_t new_sha256_[OTASha256::DIGEST_SIZE];
+
+  uint32_t old_pos_{0};
+  uint32_t produced_{0};
+  uint32_t diff_remaining_{0};
+  uint32_t extra_len_{0};
+  int32_t seek_{0};
+  uint32_t run_remaining_{0};
+  uint8_t sink_error_{0};
+  uint8_t out_[OUT_CHUNK];
+  OTASha256 sha256_;
+};
+
+}  // namespace web_server
+}  // namespace esphome
@@ -0,0 +1,431 @@
+#include "ota_inflate.h"
+
+#include <cstring>
+#include <utility>
+
+namespace esphome {
+namespace web_server {
+
+static const uint8_t GZIP_FLAG_HCRC = 0x02;
+static const uint8_t GZIP_FLAG_EXTRA = 0x04;
+static const uint8_t GZIP_FLAG_NAME = 0x08;
+static const uint8_t GZIP_FLAG_COMMENT = 0x10;
+static const uint8_t GZIP_FLAG_RESERVED = 0xE0;
+
+// Base lengths and extra bits for length codes 257..285 and distance codes 0..29 (RFC 1951 3.2.5)
+static const uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                         31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                         2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DIST_BASE[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                       193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+                                       6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// Order of the code length code lengths in a dynamic block header
+static const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// CRC-32 (gzip polynomial) with a 4 bit table, small and fast enough for the OTA transfer rate
+static const uint32_t CRC_NIBBLE[16] = {0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+                                        0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+                                        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+    crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+OTAGzipInflater::OTAGzipInflater(sink_t sink) : sink_(std::move(sink)) {}
+
+bool OTAGzipInflater::is_gzip(const uint8_t *data, size_t len) {
+  return len >= 3 && data[0] == 0x1F && data[1] == 0x8B && data[2] == 8;
+}
+
+OTAGzipInflater::Error OTAGzipInflater::fail_(Error err) {
+  this->state_ = State::FAILED;
+  return err;
+}
+
+void OTAGzipInflater::checkpoint_() {
+  this->saved_pos_ = this->in_pos_;
+  this->saved_bit_buf_ = this->bit_buf_;
+  this->saved_bit_cnt_ = this->bit_cnt_;
+}
+
+void OTAGzipInflater::rollback_() {
+  this->in_pos_ = this->saved_pos_;
+  this->bit_buf_ = this->saved_bit_buf_;
+  this->bit_cnt_ = this->saved_bit_cnt_;
+}
+
+bool OTAGzipInflater::bits_(uint8_t n, uint32_t *val) {
+  // n is at most 16, so the buffer never holds more than 23 bits
+  while (this->bit_cnt_ < n) {
+    if (this->in_pos_ == this->in_len_)
+      return false;
+    this->bit_buf_ |= uint32_t(this->in_[this->in_pos_++]) << this->bit_cnt_;
+    this->bit_cnt_ += 8;
+  }
+  *val = this->bit_buf_ & ((1u << n) - 1);
+  this->bit_buf_ >>= n;
+  this->bit_cnt_ -= n;
+  return true;
+}
+
+OTAGzipInflater::Step OTAGzipInflater::decode_(const Huffman &h, uint16_t *sym) {
+  // Canonical Huffman decoding one bit at a time, codes are stored bit reversed in the stream
+  int code = 0, first = 0, index = 0;
+  for (int len = 1; len < 16; len++) {
+    if (this->bit_cnt_ == 0) {
+      if (this->in_pos_ == this->in_len_)
+        return Step::MORE;
+      this->bit_buf_ = this->in_[this->in_pos_++];
+      this->bit_cnt_ = 8;
+    }
+    code |= this->bit_buf_ & 1;
+    this->bit_buf_ >>= 1;
+    this->bit_cnt_--;
+    int count = h.count[len];
+    if (code - count < first) {
+      *sym = h.symbol[index + (code - first)];
+      return Step::OK;
+    }
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return Step::BAD;
+}
+
+int OTAGzipInflater::build_(Huffman &h, const uint8_t *lengths, uint16_t n) {
+  memset(h.count, 0, sizeof(h.count));
+  for (uint16_t sym = 0; sym < n; sym++)
+    h.count[lengths[sym]]++;
+  if (h.count[0] == n)
+    return 0;
+  // Returns < 0 for an over-subscribed set of lengths, > 0 for an incomplete one
+  int left = 1;
+  for (int len = 1; len < 16; len++) {
+    left <<= 1;
+    left -= h.count[len];
+    if (left < 0)
+      return left;
+  }
+  uint16_t offs[16];
+  offs[1] = 0;
+  for (int len = 1; len < 15; len++)
+    offs[len + 1] = offs[len] + h.count[len];
+  for (uint16_t sym = 0; sym < n; sym++) {
+    if (lengths[sym] != 0)
+      h.symbol[offs[lengths[sym]]++] = sym;
+  }
+  return left;
+}
+
+OTAGzipInflater::Step OTAGzipInflater::gzip_header_() {
+  uint32_t v, flags;
+  if (!this->bits_(16, &v))
+    return Step::MORE;
+  if (v != 0x8B1F)
+    return Step::BAD;
+  if (!this->bits_(8, &v) || !this->bits_(8, &flags))
+    return Step::MORE;
+  if (v != 8 || (flags & GZIP_FLAG_RESERVED) != 0)
+    return Step::BAD;
+  // mtime, xfl, os
+  for (int i = 0; i < 3; i++) {
+    if (!this->bits_(16, &v))
+      return Step::MORE;
+  }
+  if (flags & GZIP_FLAG_EXTRA) {
+    uint32_t xlen;
+    if (!this->bits_(16, &xlen))
+      return Step::MORE;
+    for (uint32_t i = 0; i < xlen; i++) {
+      if (!this->bits_(8, &v))
+        return Step::MORE;
+    }
+  }
+  for (uint8_t flag : {GZIP_FLAG_NAME, GZIP_FLAG_COMMENT}) {
+    if ((flags & flag) == 0)
+      continue;
+    do {
+      if (!this->bits_(8, &v))
+        return Step::MORE;
+    } while (v != 0);
+  }
+  if ((flags & GZIP_FLAG_HCRC) && !this->bits_(16, &v))
+    return Step::MORE;
+  return Step::OK;
+}
+
+OTAGzipInflater::Step OTAGzipInflater::block_header_() {
+  uint32_t last, type;
+  if (!this->bits_(1, &last) || !this->bits_(2, &type))
+    return Step::MORE;
+  this->last_block_ = last != 0;
+
+  if (type == 0) {
+    // stored block, starts at the next byte boundary
+    uint32_t len, nlen;
+    this->bit_buf_ >>= this->bit_cnt_ & 7;
+    this->bit_cnt_ -= this->bit_cnt_ & 7;
+    if (!this->bits_(16, &len) || !this->bits_(16, &nlen))
+      return Step::MORE;
+    if (len != (~nlen & 0xFFFF))
+      return Step::BAD;
+    this->stored_remaining_ = len;
+    this->state_ = State::STORED;
+    return Step::OK;
+  }
+  if (type == 1) {
+    uint8_t lengths[288];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    build_(this->lit_, lengths, 288);
+    memset(lengths, 5, 30);
+    build_(this->dist_, lengths, 30);
+    this->state_ = State::HUFFMAN;
+    return Step::OK;
+  }
+  if (type == 2) {
+    Step step = this->dynamic_tables_();
+    if (step == Step::OK)
+      this->state_ = State::HUFFMAN;
+    return step;
+  }
+  return Step::BAD;
+}
+
+OTAGzipInflater::Step OTAGzipInflater::dynamic_tables_() {
+  uint32_t nlen, ndist, ncode;
+  if (!this->bits_(5, &nlen) || !this->bits_(5, &ndist) || !this->bits_(4, &ncode))
+    return Step::MORE;
+  nlen += 257;
+  ndist += 1;
+  ncode += 4;
+  if (nlen > 286 || ndist > 30)
+    return Step::BAD;
+
+  uint8_t lengths[286 + 30] = {};
+  for (uint32_t i = 0; i < ncode; i++) {
+    uint32_t len;
+    if (!this->bits_(3, &len))
+      return Step::MORE;
+    lengths[CODE_LENGTH_ORDER[i]] = len;
+  }
+  // the code length code must be complete
+  Huffman &code_lengths = this->lit_;
+  if (build_(code_lengths, lengths, 19) != 0)
+    return Step::BAD;
+
+  uint32_t index = 0;
+  while (index < nlen + ndist) {
+    uint16_t sym;
+    Step step = this->decode_(code_lengths, &sym);
+    if (step != Step::OK)
+      return step;
+    if (sym < 16) {
+      lengths[index++] = sym;
+      continue;
+    }
+    uint8_t len = 0;
+    uint32_t repeat;
+    if (sym == 16) {
+      if (index == 0)
+        return Step::BAD;
+      len = lengths[index - 1];
+      if (!this->bits_(2, &repeat))
+        return Step::MORE;
+      repeat += 3;
+    } else if (sym == 17) {
+      if (!this->bits_(3, &repeat))
+        return Step::MORE;
+      repeat += 3;
+    } else {
+      if (!this->bits_(7, &repeat))
+        return Step::MORE;
+      repeat += 11;
+    }
+    if (index + repeat > nlen + ndist)
+      return Step::BAD;
+    while (repeat--)
+      lengths[index++] = len;
+  }
+  // there must be an end of block code
+  if (lengths[256] == 0)
+    return Step::BAD;
+
+  // incomplete codes are only allowed if there's a single code
+  int err = build_(this->lit_, lengths, nlen);
+  if (err < 0 || (err > 0 && nlen - this->lit_.count[0] != 1))
+    return Step::BAD;
+  err = build_(this->dist_, lengths + nlen, ndist);
+  if (err < 0 || (err > 0 && ndist - this->dist_.count[0] != 1))
+    return Step::BAD;
+  return Step::OK;
+}
+
+OTAGzipInflater::Step OTAGzipInflater::stored_() {
+  while (this->stored_remaining_ > 0) {
+    uint32_t b;
+    if (!this->bits_(8, &b))
+      return Step::MORE;
+    this->put_(b);
+    this->stored_remaining_--;
+    this->checkpoint_();
+    if (this->total_ - this->flushed_ >= FLUSH_SIZE && !this->flush_())
+      return Step::BAD;
+  }
+  return Step::OK;
+}
+
+OTAGzipInflater::Step OTAGzipInflater::huffman_() {
+  for (;;) {
+    this->checkpoint_();
+    if (this->total_ - this->flushed_ >= FLUSH_SIZE && !this->flush_())
+      return Step::BAD;
+
+    uint16_t sym;
+    Step step = this->decode_(this->lit_, &sym);
+    if (step != Step::OK)
+      return step;
+    if (sym < 256) {
+      this->put_(sym);
+      continue;
+    }
+    if (sym == 256)
+      return Step::OK;
+
+    sym -= 257;
+    if (sym >= 29)
+      return Step::BAD;
+    uint32_t extra, len, dist;
+    if (!this->bits_(LENGTH_EXTRA[sym], &extra))
+      return Step::MORE;
+    len = LENGTH_BASE[sym] + extra;
+    step = this->decode_(this->dist_, &sym);
+    if (step != Step::OK)
+      return step;
+    if (sym >= 30)
+      return Step::BAD;
+    if (!this->bits_(DIST_EXTRA[sym], &extra))
+      return Step::MORE;
+    dist = DIST_BASE[sym] + extra;
+    if (dist > this->total_)
+      return Step::BAD;
+    while (len--)
+      this->put_(this->window_[(this->total_ - dist) & (WINDOW_SIZE - 1)]);
+  }
+}
+
+OTAGzipInflater::Step OTAGzipInflater::trailer_() {
+  uint32_t crc_lo, crc_hi, size_lo, size_hi;
+  this->bit_buf_ >>= this->bit_cnt_ & 7;
+  this->bit_cnt_ -= this->bit_cnt_ & 7;
+  if (!this->bits_(16, &crc_lo) || !this->bits_(16, &crc_hi) || !this->bits_(16, &size_lo) ||
+      !this->bits_(16, &size_hi))
+    return Step::MORE;
+  this->expected_crc_ = crc_lo | (crc_hi << 16);
+  this->expected_size_ = size_lo | (size_hi << 16);
+  return Step::OK;
+}
+
+bool OTAGzipInflater::flush_() {
+  while (this->flushed_ != this->total_) {
+    size_t start = this->flushed_ & (WINDOW_SIZE - 1);
+    size_t len = this->total_ - this->flushed_;
+    if (len > WINDOW_SIZE - start)
+      len = WINDOW_SIZE - start;
+    this->crc_ = crc32_update(this->crc_, this->window_ + start, len);
+    this->sink_error_ = this->sink_(this->window_ + start, len);
+    if (this->sink_error_ != 0)
+      return false;
+    this->flushed_ += len;
+  }
+  return true;
+}
+
+OTAGzipInflater::Error OTAGzipInflater::inflate_() {
+  for (;;) {
+    this->checkpoint_();
+    Step step = Step::OK;
+    switch (this->state_) {
+      case State::GZIP_HEADER:
+        step = this->gzip_header_();
+        if (step == Step::OK)
+          this->state_ = State::BLOCK_HEADER;
+        break;
+      case State::BLOCK_HEADER:
+        step = this->block_header_();
+        break;
+      case State::STORED:
+      case State::HUFFMAN:
+        step = this->state_ == State::STORED ? this->stored_() : this->huffman_();
+        if (step == Step::OK)
+          this->state_ = this->last_block_ ? State::TRAILER : State::BLOCK_HEADER;
+        break;
+      case State::TRAILER:
+        step = this->trailer_();
+        if (step == Step::OK)
+          this->state_ = State::DONE;
+        break;
+      case State::DONE:
+        // nothing may follow the gzip member
+        return this->in_pos_ == this->in_len_ ? OK : ERROR_FORMAT;
+      case State::FAILED:
+        return ERROR_FORMAT;
+    }
+    if (step == Step::MORE) {
+      this->rollback_();
+      return OK;
+    }
+    if (step == Step::BAD)
+      return this->sink_error_ != 0 ? ERROR_SINK : ERROR_FORMAT;
+  }
+}
+
+OTAGzipInflater::Error OTAGzipInflater::feed(const uint8_t *data, size_t len) {
+  while (len > 0) {
+    size_t n = IN_SIZE - this->in_len_;
+    if (n > len)
+      n = len;
+    memcpy(this->in_ + this->in_len_, data, n);
+    this->in_len_ += n;
+    data += n;
+    len -= n;
+
+    Error err = this->inflate_();
+    if (err != OK)
+      return this->fail_(err);
+    // keep the bytes of the element that was cut off
+    this->in_len_ -= this->in_pos_;
+    memmove(this->in_, this->in_ + this->in_pos_, this->in_len_);
+    this->in_pos_ = 0;
+    if (this->in_len_ == IN_SIZE) {
+      // a single element (i.e. the gzip header) doesn't fit into the buffer
+      return this->fail_(ERROR_FORMAT);
+    }
+  }
+  return OK;
+}
+
+OTAGzipInflater::Error OTAGzipInflater::finish() {
+  if (this->state_ != State::DONE)
+    return this->fail_(ERROR_FORMAT);
+  if (!this->flush_())
+    return this->fail_(ERROR_SINK);
+  // ISIZE is the length modulo 2^32
+  if (this->crc_ != this->expected_crc_ || this->total_ != this->expected_size_)
+    return this->fail_(ERROR_CRC);
+  return OK;
+}
+
+}  // namespace web_server
+}  // namespace esphome
@@ -0,0 +1,107 @@
+#pragma once
+
+// Streaming gzip (RFC 1952 / deflate RFC 1951) decoder for compressed OTA uploads.
+//
+// Input can be split at any byte: compressed data is consumed one element (block header, symbol, trailer, ...) at a
+// time, and an element that is cut off by the end of a chunk is decoded again once the next chunk arrives. Only a small
+// input buffer and the 32 KiB deflate window are kept, never the whole image.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace esphome {
+namespace web_server {
+
+class OTAGzipInflater {
+ public:
+  static constexpr size_t WINDOW_SIZE = 32768;
+
+  enum Error : uint8_t {
+    OK = 0,
+    ERROR_FORMAT,  ///< not gzip, unsupported or corrupt data
+    ERROR_CRC,     ///< CRC-32 or length in the gzip trailer doesn't match
+    ERROR_SINK,    ///< the sink failed, see sink_error()
+  };
+
+  /// Receives the inflated data. Returns 0 on success or an error code that is kept in sink_error().
+  using sink_t = std::function<uint8_t(const uint8_t *data, size_t len)>;
+
+  explicit OTAGzipInflater(sink_t sink);
+
+  /// Whether the data starts with the gzip magic and the deflate method.
+  static bool is_gzip(const uint8_t *data, size_t len);
+
+  /// Inflate the next chunk of compressed data.
+  Error feed(const uint8_t *data, size_t len);
+  /// Check that the stream was complete and passes the gzip trailer checks.
+  Error finish();
+
+  uint8_t sink_error() const { return this->sink_error_; }
+  /// Number of inflated bytes passed to the sink so far.
+  uint32_t produced() const { return this->flushed_; }
+
+ protected:
+  enum class State : uint8_t { GZIP_HEADER, BLOCK_HEADER, STORED, HUFFMAN, TRAILER, DONE, FAILED };
+  /// Result of decoding one element
+  enum class Step : uint8_t { OK, MORE, BAD };
+
+  struct Huffman {
+    uint16_t count[16];    // number of codes of each length
+    uint16_t symbol[288];  // symbols ordered by code
+  };
+
+  static constexpr size_t IN_SIZE = 1024;
+  /// Output is passed to the sink in pieces of this size, well below the window size so no match can overwrite
+  /// bytes that haven't been flushed yet.
+  static constexpr size_t FLUSH_SIZE = 4096;
+
+  Error inflate_();
+  Step gzip_header_();
+  Step block_header_();
+  Step dynamic_tables_();
+  Step stored_();
+  Step huffman_();
+  Step trailer_();
+
+  bool bits_(uint8_t n, uint32_t *val);
+  Step decode_(const Huffman &h, uint16_t *sym);
+  static int build_(Huffman &h, const uint8_t *lengths, uint16_t n);
+
+  void checkpoint_();
+  void rollback_();
+  void put_(uint8_t b) {
+    this->window_[this->total_ & (WINDOW_SIZE - 1)] = b;
+    this->total_++;
+  }
+  bool flush_();
+  Error fail_(Error err);
+
+  sink_t sink_;
+  State state_{State::GZIP_HEADER};
+  bool last_block_{false};
+  uint8_t sink_error_{0};
+
+  uint8_t in_[IN_SIZE];
+  size_t in_len_{0};
+  size_t in_pos_{0};
+  uint32_t bit_buf_{0};
+  uint8_t bit_cnt_{0};
+  size_t saved_pos_{0};
+  uint32_t saved_bit_buf_{0};
+  uint8_t saved_bit_cnt_{0};
+
+  uint16_t stored_remaining_{0};
+  Huffman lit_;
+  Huffman dist_;
+
+  uint32_t crc_{0};  // of the flushed bytes
+  uint32_t expected_crc_{0};
+  uint32_t expected_size_{0};
+  uint32_t total_{0};    // bytes inflated
+  uint32_t flushed_{0};  // bytes passed to the sink
+  uint8_t window_[WINDOW_SIZE];
+};
+
+}  // namespace web_server
+}  // namespace esphome
@@ -0,0 +1,208 @@
+#include "ota_stream.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace web_server {
+
+#if defined(ESP_PLATFORM)
+
+OTASha256::OTASha256() {
+  mbedtls_sha256_init(&this->ctx_);
+  this->init();
+}
+
+OTASha256::~OTASha256() { mbedtls_sha256_free(&this->ctx_); }
+
+void OTASha256::init() { mbedtls_sha256_starts(&this->ctx_, 0); }
+
+void OTASha256::update(const uint8_t *data, size_t len) { mbedtls_sha256_update(&this->ctx_, data, len); }
+
+void OTASha256::final(uint8_t digest[DIGEST_SIZE]) { mbedtls_sha256_finish(&this->ctx_, digest); }
+
+#else
+
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t rotr(uint32_t x, uint32_t n) { return (x >> n) | (x << (32 - n)); }
+
+OTASha256::OTASha256() { this->init(); }
+
+OTASha256::~OTASha256() {}
+
+void OTASha256::init() {
+  static const uint32_t INITIAL[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  memcpy(this->state_, INITIAL, sizeof(INITIAL));
+  this->bit_len_ = 0;
+  this->block_len_ = 0;
+}
+
+void OTASha256::transform_(const uint8_t block[64]) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; i++) {
+    w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) | (uint32_t(block[i * 4 + 2]) << 8) |
+           uint32_t(block[i * 4 + 3]);
+  }
+  for (int i = 16; i < 64; i++) {
+    uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = this->state_[0], b = this->state_[1], c = this->state_[2], d = this->state_[3];
+  uint32_t e = this->state_[4], f = this->state_[5], g = this->state_[6], h = this->state_[7];
+  for (int i = 0; i < 64; i++) {
+    uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+    uint32_t ch = (e & f) ^ (~e & g);
+    uint32_t t1 = h + s1 + ch + SHA256_K[i] + w[i];
+    uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    uint32_t t2 = s0 + maj;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  this->state_[0] += a;
+  this->state_[1] += b;
+  this->state_[2] += c;
+  this->state_[3] += d;
+  this->state_[4] += e;
+  this->state_[5] += f;
+  this->state_[6] += g;
+  this->state_[7] += h;
+}
+
+void OTASha256::update(const uint8_t *data, size_t len) {
+  this->bit_len_ += uint64_t(len) * 8;
+  if (this->block_len_ > 0) {
+    size_t take = 64 - this->block_len_;
+    if (take > len)
+      take = len;
+    memcpy(this->block_ + this->block_len_, data, take);
+    this->block_len_ += take;
+    data += take;
+    len -= take;
+    if (this->block_len_ < 64)
+      return;
+    this->transform_(this->block_);
+    this->block_len_ = 0;
+  }
+  while (len >= 64) {
+    this->transform_(data);
+    data += 64;
+    len -= 64;
+  }
+  if (len > 0) {
+    memcpy(this->block_, data, len);
+    this->block_len_ = len;
+  }
+}
+
+void OTASha256::final(uint8_t digest[DIGEST_SIZE]) {
+  uint64_t bit_len = this->bit_len_;
+  this->block_[this->block_len_++] = 0x80;
+  if (this->block_len_ > 56) {
+    memset(this->block_ + this->block_len_, 0, 64 - this->block_len_);
+    this->transform_(this->block_);
+    this->block_len_ = 0;
+  }
+  memset(this->block_ + this->block_len_, 0, 56 - this->block_len_);
+  for (int i = 0; i < 8; i++)
+    this->block_[56 + i] = uint8_t(bit_len >> (56 - i * 8));
+  this->transform_(this->block_);
+  for (int i = 0; i < 8; i++) {
+    digest[i * 4] = uint8_t(this->state_[i] >> 24);
+    digest[i * 4 + 1] = uint8_t(this->state_[i] >> 16);
+    digest[i * 4 + 2] = uint8_t(this->state_[i] >> 8);
+    digest[i * 4 + 3] = uint8_t(this->state_[i]);
+  }
+}
+
+#endif
+
+std::string OTASha256::to_hex(const uint8_t digest[DIGEST_SIZE]) {
+  static const char *const HEX_CHARS = "0123456789abcdef";
+  std::string out(DIGEST_SIZE * 2, '0');
+  for (size_t i = 0; i < DIGEST_SIZE; i++) {
+    out[i * 2] = HEX_CHARS[digest[i] >> 4];
+    out[i * 2 + 1] = HEX_CHARS[digest[i] & 0x0F];
+  }
+  return out;
+}
+
+static int hex_nibble(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+bool OTASha256::from_hex(const std::string &hex, uint8_t digest[DIGEST_SIZE]) {
+  if (hex.size() != DIGEST_SIZE * 2)
+    return false;
+  for (size_t i = 0; i < DIGEST_SIZE; i++) {
+    int hi = hex_nibble(hex[i * 2]);
+    int lo = hex_nibble(hex[i * 2 + 1]);
+    if (hi < 0 || lo < 0)
+      return false;
+    digest[i] = uint8_t((hi << 4) | lo);
+  }
+  return true;
+}
+
+uint8_t OTASectorWriter::write(const uint8_t *data, size_t len) {
+  while (len > 0) {
+    if (this->fill_ == 0 && len >= SECTOR_SIZE) {
+      // Whole sectors straight from the caller's buffer, no copy needed
+      uint8_t err = this->sink_(data, SECTOR_SIZE);
+      if (err != 0)
+        return err;
+      data += SECTOR_SIZE;
+      len -= SECTOR_SIZE;
+      continue;
+    }
+    size_t take = SECTOR_SIZE - this->fill_;
+    if (take > len)
+      take = len;
+    memcpy(this->buf_ + this->fill_, data, take);
+    this->fill_ += take;
+    data += take;
+    len -= take;
+    if (this->fill_ == SECTOR_SIZE) {
+      this->fill_ = 0;
+      uint8_t err = this->sink_(this->buf_, SECTOR_SIZE);
+      if (err != 0)
+        return err;
+    }
+  }
+  return 0;
+}
+
+uint8_t OTASectorWriter::flush() {
+  if (this->fill_ == 0)
+    return 0;
+  size_t len = this->fill_;
+  this->fill_ = 0;
+  return this->sink_(this->buf_, len);
+}
+
+}  // namespace web_server
+}  // namespace esphome
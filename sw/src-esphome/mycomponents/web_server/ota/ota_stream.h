@@ -0,0 +1,80 @@
+#pragma once
+
+// Streaming helpers for the web server OTA upload path.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+
+#if defined(ESP_PLATFORM)
+#include "mbedtls/sha256.h"
+#endif
+
+namespace esphome {
+namespace web_server {
+
+/// Incremental SHA-256. Uses the (hardware accelerated) mbedtls implementation on the device and a portable software
+/// implementation everywhere else.
+class OTASha256 {
+ public:
+  static constexpr size_t DIGEST_SIZE = 32;
+
+  OTASha256();
+  ~OTASha256();
+  OTASha256(const OTASha256 &) = delete;
+  OTASha256 &operator=(const OTASha256 &) = delete;
+
+  /// Start a new digest.
+  void init();
+  void update(const uint8_t *data, size_t len);
+  void final(uint8_t digest[DIGEST_SIZE]);
+
+  /// Lower case hex representation of a digest.
+  static std::string to_hex(const uint8_t digest[DIGEST_SIZE]);
+  /// Parse a 64 character hex digest (case insensitive). Returns false on malformed input.
+  static bool from_hex(const std::string &hex, uint8_t digest[DIGEST_SIZE]);
+
+ protected:
+#if defined(ESP_PLATFORM)
+  mbedtls_sha256_context ctx_;
+#else
+  void transform_(const uint8_t block[64]);
+
+  uint32_t state_[8];
+  uint64_t bit_len_{0};
+  uint8_t block_[64];
+  size_t block_len_{0};
+#endif
+};
+
+/** Coalesces arbitrarily sized upload chunks into flash-sector sized writes.
+ *
+ * Multipart upload chunks follow TCP segmentation, so without this the OTA backend would see many small unaligned
+ * writes. Every sink call except the last one (from flush()) is exactly SECTOR_SIZE bytes long. The sink returns 0 on
+ * success or an OTA error code which is passed through to the caller.
+ */
+class OTASectorWriter {
+ public:
+  static constexpr size_t SECTOR_SIZE = 4096;
+  using sink_t = std::function<uint8_t(const uint8_t *data, size_t len)>;
+
+  explicit OTASectorWriter(sink_t sink) : sink_(std::move(sink)) {}
+
+  uint8_t write(const uint8_t *data, size_t len);
+  /// Write out any buffered tail. Must be called once after the last write().
+  uint8_t flush();
+  void reset() { this->fill_ = 0; }
+
+  /// Bytes waiting in the buffer for the next sink call.
+  size_t buffered() const { return this->fill_; }
+
+ protected:
+  sink_t sink_;
+  size_t fill_{0};
+  uint8_t buf_[SECTOR_SIZE];
+};
+
+}  // namespace web_server
+}  // namespace esphome
@@ -1,6 +1,15 @@
 #include "ota_web_server.h"
 #ifdef USE_WEBSERVER_OTA
 
+#include "ota_delta.h"
+#include "ota_inflate.h"
+#include "ota_stream.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
 #include "esphome/components/ota/ota_backend.h"
 #include "esphome/core/application.h"
 #include "esphome/core/log.h"
@@ -17,11 +26,43 @@
 #endif
 #endif  // USE_ARDUINO
 
+#ifdef USE_ESP32
+#include <esp_app_desc.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#endif
+
 namespace esphome {
 namespace web_server {
 
 static const char *const TAG = "web_server.ota";
 
+#ifdef USE_ESP32
+/// The running app partition mapped into the data address space, used as the base image of delta uploads.
+struct OTARunningImage {
+  ~OTARunningImage() {
+    if (this->data != nullptr)
+      esp_partition_munmap(this->handle);
+  }
+
+  bool map() {
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (running == nullptr)
+      return false;
+    const void *ptr = nullptr;
+    if (esp_partition_mmap(running, 0, running->size, ESP_PARTITION_MMAP_DATA, &ptr, &this->handle) != ESP_OK)
+      return false;
+    this->data = static_cast<const uint8_t *>(ptr);
+    this->size = running->size;
+    return true;
+  }
+
+  const uint8_t *data{nullptr};
+  uint32_t size{0};
+  esp_partition_mmap_handle_t handle{};
+};
+#endif
+
 class OTARequestHandler : public AsyncWebHandler {
  public:
   OTARequestHandler(WebServerOTAComponent *parent) : parent_(parent) {}
@@ -53,28 +94,57 @@ class OTARequestHandler : public AsyncWebHandler {
  protected:
   void report_ota_progress_(AsyncWebServerRequest *request);
   void schedule_ota_reboot_();
-  void ota_init_(const char *filename);
+  void ota_init_(AsyncWebServerRequest *request, const char *filename);
+  ota::OTAResponseTypes ota_finish_();
+  void ota_fail_(ota::OTAResponseTypes error_code, bool abort_backend = true);
+  void release_upload_();
+  bool choose_decoder_();
+  bool write_(const uint8_t *data, size_t len);
+  bool delta_init_();
+  ota::OTAResponseTypes delta_error_(OTADeltaDecoder::Error error);
+  ota::OTAResponseTypes inflate_error_(OTAGzipInflater::Error error);
 
   uint32_t last_ota_progress_{0};
   uint32_t ota_read_length_{0};
+  uint32_t ota_expected_length_{0};  // uploaded file size as reported by the upload page, 0 if unknown
+  uint32_t ota_backend_writes_{0};
   WebServerOTAComponent *parent_;
   bool ota_success_{false};
+  bool ota_expect_sha256_{false};
+  uint8_t ota_expected_sha256_[OTASha256::DIGEST_SIZE];
 
  private:
   std::unique_ptr<ota::OTABackend> ota_backend_{nullptr};
+  // Only allocated while an upload is in progress, the sector buffer is 4 KiB
+  std::unique_ptr<OTASectorWriter> sector_writer_{nullptr};
+  OTASha256 sha256_;
+  // The first bytes of the upload, held back until there are enough to recognize the magic (see choose_decoder_())
+  static constexpr uint8_t MAGIC_SIZE = 4;
+  uint8_t magic_[MAGIC_SIZE];
+  uint8_t magic_len_{0};
+  // Only set while a delta patch is being applied
+  std::unique_ptr<OTADeltaDecoder> delta_{nullptr};
+  // Only set while a gzip compressed image is being uploaded, holds the 32 KiB inflate window
+  std::unique_ptr<OTAGzipInflater> inflater_{nullptr};
+#ifdef USE_ESP32
+  std::unique_ptr<OTARunningImage> running_image_{nullptr};
+#endif
 };
 
 void OTARequestHandler::report_ota_progress_(AsyncWebServerRequest *request) {
   const uint32_t now = millis();
   if (now - this->last_ota_progress_ > 1000) {
     float percentage = 0.0f;
-    if (request->contentLength() != 0) {
-      // Note: Using contentLength() for progress calculation is technically wrong as it includes
-      // multipart headers/boundaries, but it's only off by a small amount and we don't have
-      // access to the actual firmware size until the upload is complete. This is intentional
-      // as it still gives the user a reasonable progress indication.
+    if (this->ota_expected_length_ != 0) {
+      // The upload page passes the real file size, so this is exact
+      percentage = (this->ota_read_length_ * 100.0f) / this->ota_expected_length_;
+      ESP_LOGD(TAG, "OTA in progress: %0.1f%% (%" PRIu32 "/%" PRIu32 " bytes)", percentage, this->ota_read_length_,
+               this->ota_expected_length_);
+    } else if (request->contentLength() != 0) {
+      // Fallback for clients that don't send the file size. contentLength() includes multipart headers/boundaries,
+      // so this is only an approximation.
       percentage = (this->ota_read_length_ * 100.0f) / request->contentLength();
-      ESP_LOGD(TAG, "OTA in progress: %0.1f%%", percentage);
+      ESP_LOGD(TAG, "OTA in progress: ~%0.1f%%", percentage);
     } else {
       ESP_LOGD(TAG, "OTA in progress: %" PRIu32 " bytes read", this->ota_read_length_);
     }
@@ -94,10 +164,193 @@ void OTARequestHandler::schedule_ota_reboot_() {
   });
 }
 
-void OTARequestHandler::ota_init_(const char *filename) {
+void OTARequestHandler::ota_init_(AsyncWebServerRequest *request, const char *filename) {
   ESP_LOGI(TAG, "OTA Update Start: %s", filename);
   this->ota_read_length_ = 0;
+  this->magic_len_ = 0;
+  this->ota_backend_writes_ = 0;
   this->ota_success_ = false;
+  this->sha256_.init();
+
+  // Optional query parameters set by the upload page: ?size=<file size>&sha256=<hex digest>
+  this->ota_expected_length_ = 0;
+  auto *size_param = request->getParam("size");
+  if (size_param != nullptr) {
+    this->ota_expected_length_ = strtoul(size_param->value().c_str(), nullptr, 10);
+  }
+  this->ota_expect_sha256_ = false;
+  auto *sha_param = request->getParam("sha256");
+  std::string sha_hex = sha_param != nullptr ? sha_param->value().c_str() : "";
+  if (!sha_hex.empty()) {
+    if (OTASha256::from_hex(sha_hex, this->ota_expected_sha256_)) {
+      this->ota_expect_sha256_ = true;
+    } else {
+      ESP_LOGW(TAG, "Ignoring malformed sha256 parameter");
+    }
+  }
+
+  this->sector_writer_ = std::make_unique<OTASectorWriter>([this](const uint8_t *data, size_t len) -> uint8_t {
+    this->ota_backend_writes_++;
+    return this->ota_backend_->write((uint8_t *) data, len);
+  });
+}
+
+// Compressed images and delta patches (see ota_delta.h) are recognized by their magic, anything else is a plain
+// firmware image. Called once the first MAGIC_SIZE bytes are in, or with fewer for an upload that is shorter.
+bool OTARequestHandler::choose_decoder_() {
+  if (OTAGzipInflater::is_gzip(this->magic_, this->magic_len_)) {
+    ESP_LOGI(TAG, "Compressed OTA: inflating gzip upload");
+    this->inflater_ = std::make_unique<OTAGzipInflater>(
+        [this](const uint8_t *out, size_t out_len) { return this->sector_writer_->write(out, out_len); });
+  } else if (OTADeltaDecoder::is_patch(this->magic_, this->magic_len_) && !this->delta_init_()) {
+    this->ota_fail_(ota::OTA_RESPONSE_ERROR_UNKNOWN);
+    return false;
+  }
+  return true;
+}
+
+// Chunk sizes follow TCP segmentation, the sector writer turns them into sector sized flash writes
+bool OTARequestHandler::write_(const uint8_t *data, size_t len) {
+  this->sha256_.update(data, len);
+  ota::OTAResponseTypes error_code;
+  if (this->inflater_) {
+    error_code = this->inflate_error_(this->inflater_->feed(data, len));
+  } else if (this->delta_) {
+    error_code = this->delta_error_(this->delta_->feed(data, len));
+  } else {
+    error_code = static_cast<ota::OTAResponseTypes>(this->sector_writer_->write(data, len));
+  }
+  if (error_code != ota::OTA_RESPONSE_OK) {
+    ESP_LOGE(TAG, "OTA write failed: %d", error_code);
+    this->ota_fail_(error_code);
+    return false;
+  }
+  this->ota_read_length_ += len;
+  return true;
+}
+
+bool OTARequestHandler::delta_init_() {
+#ifdef USE_ESP32
+  this->running_image_ = std::make_unique<OTARunningImage>();
+  if (!this->running_image_->map()) {
+    ESP_LOGE(TAG, "Delta OTA: can't map the running partition");
+    this->running_image_.reset();
+    return false;
+  }
+  const OTARunningImage *image = this->running_image_.get();
+  this->delta_ = std::make_unique<OTADeltaDecoder>(
+      [image](uint32_t offset, uint8_t *buf, size_t len) {
+        memcpy(buf, image->data + offset, len);
+        return true;
+      },
+      image->size, esp_app_get_description()->app_elf_sha256,
+      [this](const uint8_t *data, size_t len) { return this->sector_writer_->write(data, len); });
+  ESP_LOGI(TAG, "Delta OTA: applying patch to the running image");
+  return true;
+#else
+  ESP_LOGE(TAG, "Delta OTA is not supported on this platform");
+  return false;
+#endif
+}
+
+ota::OTAResponseTypes OTARequestHandler::delta_error_(OTADeltaDecoder::Error error) {
+  switch (error) {
+    case OTADeltaDecoder::OK:
+      return ota::OTA_RESPONSE_OK;
+    case OTADeltaDecoder::ERROR_SINK:
+      return static_cast<ota::OTAResponseTypes>(this->delta_->sink_error());
+    case OTADeltaDecoder::ERROR_HASH:
+      ESP_LOGE(TAG, "Delta OTA: patched image hash mismatch");
+      return ota::OTA_RESPONSE_ERROR_MD5_MISMATCH;
+    case OTADeltaDecoder::ERROR_BASE:
+      ESP_LOGE(TAG, "Delta OTA: patch was made for a different firmware");
+      return ota::OTA_RESPONSE_ERROR_UNKNOWN;
+    default:
+      ESP_LOGE(TAG, "Delta OTA: corrupt patch (error %u)", error);
+      return ota::OTA_RESPONSE_ERROR_UNKNOWN;
+  }
+}
+
+ota::OTAResponseTypes OTARequestHandler::inflate_error_(OTAGzipInflater::Error error) {
+  switch (error) {
+    case OTAGzipInflater::OK:
+      return ota::OTA_RESPONSE_OK;
+    case OTAGzipInflater::ERROR_SINK:
+      return static_cast<ota::OTAResponseTypes>(this->inflater_->sink_error());
+    case OTAGzipInflater::ERROR_CRC:
+      ESP_LOGE(TAG, "Compressed OTA: CRC mismatch");
+      return ota::OTA_RESPONSE_ERROR_MD5_MISMATCH;
+    default:
+      ESP_LOGE(TAG, "Compressed OTA: corrupt or truncated gzip data");
+      return ota::OTA_RESPONSE_ERROR_UNKNOWN;
+  }
+}
+
+ota::OTAResponseTypes OTARequestHandler::ota_finish_() {
+  if (this->inflater_) {
+    auto inflate_code = this->inflate_error_(this->inflater_->finish());
+    if (inflate_code != ota::OTA_RESPONSE_OK) {
+      this->ota_fail_(inflate_code);
+      return inflate_code;
+    }
+    ESP_LOGI(TAG, "Compressed OTA: %" PRIu32 " bytes inflated to %" PRIu32, this->ota_read_length_,
+             this->inflater_->produced());
+  }
+  if (this->delta_) {
+    auto delta_code = this->delta_error_(this->delta_->finish());
+    if (delta_code != ota::OTA_RESPONSE_OK) {
+      this->ota_fail_(delta_code);
+      return delta_code;
+    }
+    ESP_LOGI(TAG, "Delta OTA: patch of %" PRIu32 " bytes produced a %" PRIu32 " byte image", this->ota_read_length_,
+             this->delta_->produced());
+  }
+
+  auto error_code = static_cast<ota::OTAResponseTypes>(this->sector_writer_->flush());
+  if (error_code != ota::OTA_RESPONSE_OK) {
+    ESP_LOGE(TAG, "OTA write failed: %d", error_code);
+    this->ota_fail_(error_code);
+    return error_code;
+  }
+
+  uint8_t digest[OTASha256::DIGEST_SIZE];
+  this->sha256_.final(digest);
+  ESP_LOGI(TAG, "OTA image: %" PRIu32 " bytes, %" PRIu32 " flash writes, sha256 %s", this->ota_read_length_,
+           this->ota_backend_writes_, OTASha256::to_hex(digest).c_str());
+  if (this->ota_expect_sha256_ && memcmp(digest, this->ota_expected_sha256_, sizeof(digest)) != 0) {
+    ESP_LOGE(TAG, "OTA sha256 mismatch, expected %s", OTASha256::to_hex(this->ota_expected_sha256_).c_str());
+    this->ota_fail_(ota::OTA_RESPONSE_ERROR_MD5_MISMATCH);
+    return ota::OTA_RESPONSE_ERROR_MD5_MISMATCH;
+  }
+
+  // For Arduino framework, the Update library tracks expected size from firmware header
+  // If we haven't received enough data, calling end() will fail
+  // This can happen if the upload is interrupted or the client disconnects
+  error_code = this->ota_backend_->end();
+  if (error_code != ota::OTA_RESPONSE_OK) {
+    ESP_LOGE(TAG, "OTA end failed: %d", error_code);
+    this->ota_fail_(error_code, false);
+  }
+  return error_code;
+}
+
+void OTARequestHandler::ota_fail_(ota::OTAResponseTypes error_code, bool abort_backend) {
+  if (abort_backend)
+    this->ota_backend_->abort();
+  this->ota_backend_.reset();
+  this->release_upload_();
+#ifdef USE_OTA_STATE_CALLBACK
+  this->parent_->state_callback_.call_deferred(ota::OTA_ERROR, 0.0f, static_cast<uint8_t>(error_code));
+#endif
+}
+
+void OTARequestHandler::release_upload_() {
+  this->inflater_.reset();
+  this->delta_.reset();
+#ifdef USE_ESP32
+  this->running_image_.reset();
+#endif
+  this->sector_writer_.reset();
 }
 
 void OTARequestHandler::handleUpload(AsyncWebServerRequest *request, const String &filename, size_t index,
@@ -106,7 +359,7 @@ void OTARequestHandler::handleUpload(AsyncWebServerRequest *request, const Strin
 
   if (index == 0 && !this->ota_backend_) {
     // Initialize OTA on first call
-    this->ota_init_(filename.c_str());
+    this->ota_init_(request, filename.c_str());
 
 #ifdef USE_OTA_STATE_CALLBACK
     // Notify OTA started - use call_deferred since we're in web server task
@@ -128,6 +381,7 @@ void OTARequestHandler::handleUpload(AsyncWebServerRequest *request, const Strin
     this->ota_backend_ = ota::make_ota_backend();
     if (!this->ota_backend_) {
       ESP_LOGE(TAG, "Failed to create OTA backend");
+      this->sector_writer_.reset();
 #ifdef USE_OTA_STATE_CALLBACK
       this->parent_->state_callback_.call_deferred(ota::OTA_ERROR, 0.0f,
                                                    static_cast<uint8_t>(ota::OTA_RESPONSE_ERROR_UNKNOWN));
@@ -142,6 +396,7 @@ void OTARequestHandler::handleUpload(AsyncWebServerRequest *request, const Strin
     if (error_code != ota::OTA_RESPONSE_OK) {
       ESP_LOGE(TAG, "OTA begin failed: %d", error_code);
       this->ota_backend_.reset();
+      this->sector_writer_.reset();
 #ifdef USE_OTA_STATE_CALLBACK
       this->parent_->state_callback_.call_deferred(ota::OTA_ERROR, 0.0f, static_cast<uint8_t>(error_code));
 #endif
@@ -153,19 +408,26 @@ void OTARequestHandler::handleUpload(AsyncWebServerRequest *request, const Strin
     return;
   }
 
+  // The first chunk can be shorter than the magic, its bytes wait for the next ones before the decoder is chosen
+  if (this->magic_len_ < MAGIC_SIZE) {
+    size_t take = std::min<size_t>(MAGIC_SIZE - this->magic_len_, len);
+    memcpy(this->magic_ + this->magic_len_, data, take);
+    this->magic_len_ += take;
+    data += take;
+    len -= take;
+    if (this->magic_len_ < MAGIC_SIZE && !final) {
+      return;
+    }
+    if (!this->choose_decoder_() || !this->write_(this->magic_, this->magic_len_)) {
+      return;
+    }
+  }
+
   // Process data
   if (len > 0) {
-    error_code = this->ota_backend_->write(data, len);
-    if (error_code != ota::OTA_RESPONSE_OK) {
-      ESP_LOGE(TAG, "OTA write failed: %d", error_code);
-      this->ota_backend_->abort();
-      this->ota_backend_.reset();
-#ifdef USE_OTA_STATE_CALLBACK
-      this->parent_->state_callback_.call_deferred(ota::OTA_ERROR, 0.0f, static_cast<uint8_t>(error_code));
-#endif
+    if (!this->write_(data, len)) {
       return;
     }
-    this->ota_read_length_ += len;
     this->report_ota_progress_(request);
   }
 
@@ -174,24 +436,19 @@ void OTARequestHandler::handleUpload(AsyncWebServerRequest *request, const Strin
     ESP_LOGD(TAG, "OTA final chunk: index=%zu, len=%zu, total_read=%" PRIu32 ", contentLength=%zu", index, len,
              this->ota_read_length_, request->contentLength());
 
-    // For Arduino framework, the Update library tracks expected size from firmware header
-    // If we haven't received enough data, calling end() will fail
-    // This can happen if the upload is interrupted or the client disconnects
-    error_code = this->ota_backend_->end();
-    if (error_code == ota::OTA_RESPONSE_OK) {
-      this->ota_success_ = true;
-#ifdef USE_OTA_STATE_CALLBACK
-      // Report completion before reboot - use call_deferred since we're in web server task
-      this->parent_->state_callback_.call_deferred(ota::OTA_COMPLETED, 100.0f, 0);
-#endif
-      this->schedule_ota_reboot_();
-    } else {
-      ESP_LOGE(TAG, "OTA end failed: %d", error_code);
+    error_code = this->ota_finish_();
+    if (error_code != ota::OTA_RESPONSE_OK) {
+      // ota_finish_() already released the backend and reported the error
+      return;
+    }
+    this->ota_success_ = true;
 #ifdef USE_OTA_STATE_CALLBACK
-      this->parent_->state_callback_.call_deferred(ota::OTA_ERROR, 0.0f, static_cast<uint8_t>(error_code));
+    // Report completion before reboot - use call_deferred since we're in web server task
+    this->parent_->state_callback_.call_deferred(ota::OTA_COMPLETED, 100.0f, 0);
 #endif
-    }
+    this->schedule_ota_reboot_();
     this->ota_backend_.reset();
+    this->release_upload_();
   }
 }
 
@@ -0,0 +1,228 @@
+#include "remote_keypad.h"
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace web_server {
+
+static const char *const TAG = "remote_keypad";
+
+void RemoteKeypad::setup() {
+  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+  config.server_port = this->port_;
+  config.ctrl_port = this->port_ + 32768;  // the main web server uses the default
+  config.max_open_sockets = MAX_CLIENTS + 1;  // one more for loading the page
+  config.max_uri_handlers = 2;
+  config.stack_size = 4096;
+  config.lru_purge_enable = true;
+  config.close_fn = RemoteKeypad::close_handler_;
+  config.global_user_ctx = this;
+  config.global_user_ctx_free_fn = [](void *) {};  // not owned by the server
+  esp_err_t err = httpd_start(&this->server_, &config);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Starting the server failed: %s", esp_err_to_name(err));
+    this->server_ = nullptr;
+    return;
+  }
+
+  httpd_uri_t ws = {};
+  ws.uri = "/keypad";
+  ws.method = HTTP_GET;
+  ws.handler = RemoteKeypad::ws_handler_;
+  ws.user_ctx = this;
+  ws.is_websocket = true;
+  httpd_register_uri_handler(this->server_, &ws);
+
+  httpd_uri_t page = {};
+  page.uri = "/";
+  page.method = HTTP_GET;
+  page.handler = RemoteKeypad::page_handler_;
+  page.user_ctx = this;
+  httpd_register_uri_handler(this->server_, &page);
+}
+
+void RemoteKeypad::loop() {
+  if (this->connected_.load(std::memory_order_relaxed) == 0) {
+    this->high_freq_.stop();
+  } else {
+    this->high_freq_.start();
+  }
+
+  int fds[MAX_CLIENTS];
+  {
+    LockGuard guard(this->lock_);
+    for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+      Slot &slot = this->slots_[i];
+      if (slot.fresh) {
+        slot.client.reset();
+        slot.fresh = false;
+      }
+      fds[i] = slot.fd;
+    }
+  }
+
+  // Hand the keys to the on_key automation, which queues them for the game task. Their key frames are acknowledged
+  // once set_frame() brings a display the game rendered after applying them.
+  RemoteKey key;
+  while (this->queue_.pop(key)) {
+    uint32_t queued_us = micros() - key.received_us;
+    this->keys_++;
+    this->queue_us_total_ += queued_us;
+    this->queue_us_max_ = std::max(this->queue_us_max_, queued_us);
+    if (++this->last_ticket_ == 0) {
+      this->last_ticket_ = 1;  // 0 is no ticket
+    }
+    if (fds[key.client] >= 0) {
+      this->slots_[key.client].client.queued(key.seq, this->last_ticket_);
+    }
+    this->key_callback_.call(key.key, this->last_ticket_);
+  }
+
+  uint8_t buf[REMOTE_KEYPAD_MAX_LCD_FRAME];
+  for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+    if (fds[i] < 0) {
+      continue;
+    }
+    this->slots_[i].client.shown(this->frame_ticket_);
+    size_t len = this->slots_[i].client.update(this->frame_, buf);
+    if (len != 0) {
+      this->send_(fds[i], buf, len);
+    }
+  }
+}
+
+void RemoteKeypad::dump_config() {
+  ESP_LOGCONFIG(TAG,
+                "Remote keypad:\n"
+                "  Port: %u",
+                this->port_);
+  if (this->keys_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Keys: %" PRIu32 ", time in queue avg %" PRIu32 "us max %" PRIu32 "us", this->keys_,
+                  static_cast<uint32_t>(this->queue_us_total_ / this->keys_), this->queue_us_max_);
+  }
+}
+
+// The frames are sent from the server task, sockets of the HTTP server must not be written from other tasks
+void RemoteKeypad::send_(int fd, const uint8_t *data, size_t len) {
+  auto *job = new SendJob;  // NOLINT(cppcoreguidelines-owning-memory)
+  job->server = this->server_;
+  job->fd = fd;
+  job->len = len;
+  memcpy(job->data, data, len);
+  if (httpd_queue_work(this->server_, RemoteKeypad::send_job_, job) != ESP_OK) {
+    delete job;  // NOLINT(cppcoreguidelines-owning-memory)
+  }
+}
+
+void RemoteKeypad::send_job_(void *arg) {
+  auto *job = static_cast<SendJob *>(arg);
+  httpd_ws_frame_t frame = {};
+  frame.final = true;
+  frame.type = HTTPD_WS_TYPE_BINARY;
+  frame.payload = job->data;
+  frame.len = job->len;
+  if (httpd_ws_get_fd_info(job->server, job->fd) == HTTPD_WS_CLIENT_WEBSOCKET) {
+    httpd_ws_send_frame_async(job->server, job->fd, &frame);
+  }
+  delete job;  // NOLINT(cppcoreguidelines-owning-memory)
+}
+
+esp_err_t RemoteKeypad::page_handler_(httpd_req_t *req) {
+  auto *self = static_cast<RemoteKeypad *>(req->user_ctx);
+#ifdef USE_WEBSERVER_UI_PARTITION
+  UIAsset asset;
+  if (self->ui_partition_ != nullptr && self->ui_partition_->find("/keypad", 7, asset))
+    return UIPartition::send(req, asset);
+#endif
+  if (self->page_ == nullptr) {
+    httpd_resp_send_404(req);
+    return ESP_OK;
+  }
+  httpd_resp_set_type(req, "text/html");
+  httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+  return httpd_resp_send(req, reinterpret_cast<const char *>(self->page_), self->page_size_);
+}
+
+esp_err_t RemoteKeypad::ws_handler_(httpd_req_t *req) {
+  auto *self = static_cast<RemoteKeypad *>(req->user_ctx);
+  int fd = httpd_req_to_sockfd(req);
+
+  if (req->method == HTTP_GET) {
+    // the handshake is done, take a slot
+    LockGuard guard(self->lock_);
+    for (Slot &slot : self->slots_) {
+      if (slot.fd < 0) {
+        slot.fd = fd;
+        slot.fresh = true;
+        self->connected_++;
+        ESP_LOGD(TAG, "Client connected");
+        return ESP_OK;
+      }
+    }
+    ESP_LOGW(TAG, "Too many clients");
+    return ESP_FAIL;
+  }
+
+  uint8_t buf[REMOTE_KEYPAD_MAX_FRAME];
+  httpd_ws_frame_t frame = {};
+  esp_err_t err = httpd_ws_recv_frame(req, &frame, 0);  // just the length
+  if (err != ESP_OK) {
+    return err;
+  }
+  if (frame.type != HTTPD_WS_TYPE_BINARY || frame.len > sizeof(buf)) {
+    ESP_LOGW(TAG, "Invalid key frame");
+    return ESP_FAIL;
+  }
+  frame.payload = buf;
+  err = httpd_ws_recv_frame(req, &frame, sizeof(buf));
+  if (err != ESP_OK) {
+    return err;
+  }
+  if (!remote_key_frame_valid(buf, frame.len)) {
+    ESP_LOGW(TAG, "Invalid key frame");
+    return ESP_FAIL;
+  }
+
+  uint8_t client = MAX_CLIENTS;
+  for (uint8_t i = 0; i < MAX_CLIENTS; i++) {
+    if (self->slots_[i].fd == fd) {
+      client = i;
+    }
+  }
+  if (client == MAX_CLIENTS) {
+    return ESP_FAIL;
+  }
+  uint32_t now = micros();
+  for (size_t i = 1; i < frame.len; i++) {
+    self->queue_.push(RemoteKey{now, client, buf[0], buf[i]});
+  }
+  return ESP_OK;
+}
+
+void RemoteKeypad::close_handler_(httpd_handle_t server, int fd) {
+  auto *self = static_cast<RemoteKeypad *>(httpd_get_global_user_ctx(server));
+  {
+    LockGuard guard(self->lock_);
+    for (Slot &slot : self->slots_) {
+      if (slot.fd == fd) {
+        slot.fd = -1;
+        self->connected_--;
+        ESP_LOGD(TAG, "Client disconnected");
+      }
+    }
+  }
+  close(fd);  // with a close_fn the server leaves this to us
+}
+
+}  // namespace web_server
+}  // namespace esphome
+#endif
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+
+#include <atomic>
+
+#include <esp_http_server.h>
+
+#include "esphome/core/automation.h"
+#include "esphome/core/helpers.h"
+
+#ifdef USE_WEBSERVER_UI_PARTITION
+#include "ui_partition.h"
+#endif
+
+// Copied into the build by the `includes:` section of config.yaml
+#include "src-common/remote_keypad.hpp"
+
+namespace esphome {
+namespace web_server {
+
+/// Remote keypad over a WebSocket, see the "Remote keypad" section of the README and src-common/remote_keypad.hpp.
+///
+/// The WebSocket is served by its own small ESP-IDF HTTP server on a separate port (the main web server answers every
+/// URI itself and has no WebSocket support), together with the keypad page. Key frames are received in that server's
+/// task and handed to the main loop through a lock-free queue; loop() fires the key callbacks and sends the LCD
+/// frames. While a client is connected the main loop runs without sleeping, so a key is queued for the game task within
+/// a millisecond or two instead of on the next loop tick.
+///
+/// Each key is passed to the callbacks with a ticket, for the game task (GameLoop::key()). A key frame is acknowledged
+/// with the first display rendered after the game applied it, set_frame() tells which keys that display shows.
+class RemoteKeypad {
+ public:
+  static constexpr uint8_t MAX_CLIENTS = 3;
+
+  explicit RemoteKeypad(uint16_t port) : port_(port) {}
+
+  void set_page(const uint8_t *page, size_t size) {
+    this->page_ = page;
+    this->page_size_ = size;
+  }
+#ifdef USE_WEBSERVER_UI_PARTITION
+  /// Serve the page from the UI partition (as `/keypad`) when it holds one.
+  void set_ui_partition(UIPartition *ui_partition) { this->ui_partition_ = ui_partition; }
+#endif
+  void add_on_key_callback(std::function<void(uint8_t, uint32_t)> &&callback) {
+    this->key_callback_.add(std::move(callback));
+  }
+
+  void setup();
+  void loop();
+  void dump_config();
+
+  /// Whether the display contents are needed, the LCD capture is skipped otherwise.
+  bool active() const { return this->connected_.load(std::memory_order_relaxed) != 0; }
+  /// The display as the game last rendered it, after applying the keys up to this ticket.
+  void set_frame(const LcdFrame &frame, uint32_t ticket) {
+    this->frame_ = frame;
+    this->frame_ticket_ = ticket;
+  }
+
+ protected:
+  struct Slot {
+    int fd{-1};  // socket of the connected client, -1 if free; only changed in the HTTP server task under lock_
+    bool fresh{false};  // connected since the last loop(), its RemoteKeypadClient needs a reset
+    RemoteKeypadClient client;  // only used in the main loop
+  };
+
+  struct SendJob {
+    httpd_handle_t server;
+    int fd;
+    size_t len;
+    uint8_t data[REMOTE_KEYPAD_MAX_LCD_FRAME];
+  };
+
+  static esp_err_t page_handler_(httpd_req_t *req);
+  static esp_err_t ws_handler_(httpd_req_t *req);
+  static void close_handler_(httpd_handle_t server, int fd);
+  static void send_job_(void *arg);
+
+  void send_(int fd, const uint8_t *data, size_t len);
+
+  uint16_t port_;
+  const uint8_t *page_{nullptr};
+  size_t page_size_{0};
+#ifdef USE_WEBSERVER_UI_PARTITION
+  UIPartition *ui_partition_{nullptr};
+#endif
+  httpd_handle_t server_{nullptr};
+  CallbackManager<void(uint8_t, uint32_t)> key_callback_;
+
+  Mutex lock_;
+  Slot slots_[MAX_CLIENTS];
+  std::atomic<uint8_t> connected_{0};
+  RemoteKeyQueue queue_;
+  LcdFrame frame_;
+  uint32_t frame_ticket_{0};
+  uint32_t last_ticket_{0};  // of the last key passed to the callbacks
+  HighFrequencyLoopRequester high_freq_;
+
+  // statistics, main loop only
+  uint32_t keys_{0};
+  uint32_t queue_us_max_{0};
+  uint64_t queue_us_total_{0};
+};
+
+class RemoteKeyTrigger : public Trigger<uint8_t, uint32_t> {
+ public:
+  explicit RemoteKeyTrigger(RemoteKeypad *parent) {
+    parent->add_on_key_callback([this](uint8_t key, uint32_t ticket) { this->trigger(key, ticket); });
+  }
+};
+
+}  // namespace web_server
+}  // namespace esphome
+#endif
@@ -0,0 +1,134 @@
+#include "ui_assets.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(ESP_PLATFORM)
+#include "esp_rom_crc.h"
+#endif
+
+namespace esphome {
+namespace web_server {
+
+static const uint8_t IMAGE_MAGIC[4] = {'A', 'N', 'T', 'U'};
+
+static uint32_t read_le32(const uint8_t *p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+bool UIAssetImage::is_image(const uint8_t *data, size_t len) {
+  return len >= sizeof(IMAGE_MAGIC) && memcmp(data, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) == 0;
+}
+
+UIAssetImage::Error UIAssetImage::load(const uint8_t *data, size_t size, bool verify) {
+  this->clear();
+  if (size < HEADER_SIZE)
+    return ERROR_FORMAT;
+  static const uint8_t ERASED[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+  if (memcmp(data, ERASED, sizeof(ERASED)) == 0)
+    return ERROR_EMPTY;
+  if (!is_image(data, size) || data[4] != VERSION)
+    return ERROR_FORMAT;
+
+  uint8_t count = data[5];
+  uint32_t image_size = read_le32(data + 8);
+  size_t index_end = HEADER_SIZE + count * ENTRY_SIZE;
+  if (image_size > size || image_size < index_end)
+    return ERROR_SIZE;
+  if (count > MAX_ASSETS || crc32(0, data + HEADER_SIZE, count * ENTRY_SIZE) != read_le32(data + 12))
+    return ERROR_INDEX;
+
+  std::vector<UIAsset> assets;
+  assets.reserve(count);
+  for (uint8_t i = 0; i < count; i++) {
+    const uint8_t *entry = data + HEADER_SIZE + i * ENTRY_SIZE;
+    const char *name = reinterpret_cast<const char *>(entry);
+    const char *content_type = name + NAME_SIZE;
+    uint32_t offset = read_le32(entry + 80);
+    uint32_t length = read_le32(entry + 84);
+    // the strings are used in place, so they must end within their fields
+    if (memchr(name, 0, NAME_SIZE) == nullptr || memchr(content_type, 0, CONTENT_TYPE_SIZE) == nullptr ||
+        name[0] != '/' || offset < index_end || offset > image_size || length > image_size - offset)
+      return ERROR_INDEX;
+    assets.push_back(UIAsset{name, content_type, data + offset, length, read_le32(entry + 88),
+                             (entry[92] & FLAG_GZIP) != 0});
+  }
+  if (verify) {
+    for (const UIAsset &asset : assets) {
+      if (crc32(0, asset.data, asset.size) != asset.crc)
+        return ERROR_DATA;
+    }
+  }
+
+  this->assets_ = std::move(assets);
+  this->size_ = image_size;
+  return OK;
+}
+
+void UIAssetImage::clear() {
+  this->assets_.clear();
+  this->size_ = 0;
+}
+
+const UIAsset *UIAssetImage::find(const char *name, size_t len) const {
+  for (const UIAsset &asset : this->assets_) {
+    if (strncmp(asset.name, name, len) == 0 && asset.name[len] == '\0')
+      return &asset;
+  }
+  return nullptr;
+}
+
+bool UIAssetImage::send_chunked(const UIAsset &asset, size_t chunk_size, const chunk_sink_t &sink) {
+  for (uint32_t offset = 0; offset < asset.size;) {
+    size_t len = std::min<size_t>(chunk_size, asset.size - offset);
+    if (!sink(asset.data + offset, len))
+      return false;
+    offset += len;
+  }
+  return true;
+}
+
+#if defined(ESP_PLATFORM)
+
+uint32_t UIAssetImage::crc32(uint32_t crc, const uint8_t *data, size_t len) { return esp_rom_crc32_le(crc, data, len); }
+
+#else
+
+uint32_t UIAssetImage::crc32(uint32_t crc, const uint8_t *data, size_t len) {
+  static uint32_t table[256];
+  if (table[1] == 0) {
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++)
+        c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++)
+    crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+#endif
+
+const char *UIAssetImage::error_str(Error error) {
+  switch (error) {
+    case OK:
+      return "ok";
+    case ERROR_EMPTY:
+      return "empty";
+    case ERROR_FORMAT:
+      return "not a UI image";
+    case ERROR_SIZE:
+      return "image too large";
+    case ERROR_INDEX:
+      return "corrupt index";
+    case ERROR_DATA:
+      return "corrupt asset";
+  }
+  return "unknown";
+}
+
+}  // namespace web_server
+}  // namespace esphome
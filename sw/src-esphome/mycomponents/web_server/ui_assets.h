@@ -0,0 +1,99 @@
+#pragma once
+
+// Web UI assets in their own flash partition, so that the pages can be updated without a firmware OTA.
+//
+// The partition holds an image of the assets with a small index in front of them. The device maps the partition and
+// serves the assets straight from the mapping, the index only points into it.
+//
+// Image layout (all integers little endian):
+//
+//   header (16 bytes):
+//     char     magic[4]             "ANTU"
+//     uint8_t  version              1
+//     uint8_t  count                number of assets
+//     uint8_t  reserved[2]
+//     uint32_t size                 size of the image, header included
+//     uint32_t index_crc            CRC-32 of the index entries
+//   index, count entries of 96 bytes:
+//     char     name[40]             URL path of the asset, e.g. "/" or "/keypad", NUL terminated
+//     char     content_type[40]     NUL terminated
+//     uint32_t offset               of the data, from the start of the image
+//     uint32_t length               of the data
+//     uint32_t crc                  CRC-32 of the data
+//     uint8_t  flags                FLAG_GZIP if the data is gzip encoded
+//     uint8_t  reserved[3]
+//   data of the assets
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace esphome {
+namespace web_server {
+
+/// One asset of a UIAssetImage, pointing into the image.
+struct UIAsset {
+  const char *name;
+  const char *content_type;
+  const uint8_t *data;
+  uint32_t size;
+  uint32_t crc;
+  bool gzip;
+};
+
+class UIAssetImage {
+ public:
+  static constexpr size_t HEADER_SIZE = 16;
+  static constexpr size_t ENTRY_SIZE = 96;
+  static constexpr size_t NAME_SIZE = 40;
+  static constexpr size_t CONTENT_TYPE_SIZE = 40;
+  static constexpr uint8_t VERSION = 1;
+  static constexpr uint8_t FLAG_GZIP = 0x01;
+  static constexpr uint8_t MAX_ASSETS = 32;
+
+  enum Error : uint8_t {
+    OK = 0,
+    ERROR_EMPTY,   ///< no image, e.g. an erased partition
+    ERROR_FORMAT,  ///< not an image or of another version
+    ERROR_SIZE,    ///< the image doesn't fit into the partition
+    ERROR_INDEX,   ///< the index is corrupt or points outside of the image
+    ERROR_DATA,    ///< the data of an asset doesn't match its CRC
+  };
+
+  /// Receives the chunks of an asset. Returns false to stop.
+  using chunk_sink_t = std::function<bool(const uint8_t *data, size_t len)>;
+
+  /** Reads the index of an image. The image must stay in place as long as the assets are used.
+   *
+   * @param data The image, e.g. the mapped partition.
+   * @param size Bytes readable at data. The image itself may be smaller.
+   * @param verify Check the data of every asset against its CRC, not only the index.
+   */
+  Error load(const uint8_t *data, size_t size, bool verify);
+  /// Forget the assets.
+  void clear();
+
+  /// The asset with this URL path, nullptr if there is none.
+  const UIAsset *find(const char *name, size_t len) const;
+  const std::vector<UIAsset> &assets() const { return this->assets_; }
+  /// Size of the loaded image, 0 if none is loaded.
+  uint32_t size() const { return this->size_; }
+
+  /// Hands the data of an asset to the sink in chunks of at most chunk_size bytes, without copying it.
+  /// @return false if the sink stopped.
+  static bool send_chunked(const UIAsset &asset, size_t chunk_size, const chunk_sink_t &sink);
+  /// Whether data starts like an image, to reject other uploads early.
+  static bool is_image(const uint8_t *data, size_t len);
+  /// CRC-32 as used by zlib. The ROM implementation on the device, a portable one everywhere else.
+  static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len);
+
+  static const char *error_str(Error error);
+
+ protected:
+  std::vector<UIAsset> assets_;
+  uint32_t size_{0};
+};
+
+}  // namespace web_server
+}  // namespace esphome
@@ -0,0 +1,138 @@
+#include "ui_partition.h"
+#ifdef USE_WEBSERVER_UI_PARTITION
+
+#include <cinttypes>
+#include <string>
+
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace web_server {
+
+static const char *const TAG = "web_server.ui";
+
+void UIPartition::setup() {
+  this->partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, this->label_);
+  if (this->partition_ == nullptr) {
+    ESP_LOGW(TAG, "No partition '%s', serving the upload page", this->label_);
+    return;
+  }
+  const void *ptr = nullptr;
+  if (esp_partition_mmap(this->partition_, 0, this->partition_->size, ESP_PARTITION_MMAP_DATA, &ptr, &this->handle_) !=
+      ESP_OK) {
+    ESP_LOGE(TAG, "Can't map partition '%s'", this->label_);
+    this->partition_ = nullptr;
+    return;
+  }
+  this->data_ = static_cast<const uint8_t *>(ptr);
+  this->load_();
+}
+
+void UIPartition::dump_config() {
+  if (this->partition_ == nullptr) {
+    ESP_LOGCONFIG(TAG, "  UI partition: '%s' not found", this->label_);
+  } else if (this->error_ != UIAssetImage::OK) {
+    ESP_LOGCONFIG(TAG, "  UI partition: '%s' at 0x%" PRIx32 ", %s, serving the upload page", this->label_,
+                  this->partition_->address, UIAssetImage::error_str(this->error_));
+  } else {
+    ESP_LOGCONFIG(TAG, "  UI partition: '%s' at 0x%" PRIx32 ", %zu assets, %" PRIu32 " of %" PRIu32 " bytes",
+                  this->label_, this->partition_->address, this->image_.assets().size(), this->image_.size(),
+                  this->partition_->size);
+  }
+}
+
+void UIPartition::load_() {
+  LockGuard guard(this->lock_);
+  this->error_ = this->image_.load(this->data_, this->partition_->size, true);
+}
+
+bool UIPartition::find(const char *path, size_t len, UIAsset &asset) const {
+  LockGuard guard(this->lock_);
+  const UIAsset *found = this->image_.find(path, len);
+  if (found == nullptr)
+    return false;
+  asset = *found;
+  return true;
+}
+
+esp_err_t UIPartition::send(httpd_req_t *req, const UIAsset &asset) {
+  httpd_resp_set_type(req, asset.content_type);
+  if (asset.gzip)
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+  // the chunks are passed to the socket as they are, nothing is copied to RAM first
+  bool sent = UIAssetImage::send_chunked(asset, CHUNK_SIZE, [req](const uint8_t *data, size_t len) {
+    return httpd_resp_send_chunk(req, reinterpret_cast<const char *>(data), len) == ESP_OK;
+  });
+  if (!sent)
+    return ESP_FAIL;
+  return httpd_resp_send_chunk(req, nullptr, 0);
+}
+
+void UIPartition::handleUpload(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data,
+                               size_t len, bool final) {
+  if (index == 0) {
+    this->upload_error_ = nullptr;
+    this->erased_ = 0;
+    if (this->partition_ == nullptr) {
+      this->upload_error_ = "no UI partition";
+    } else if (!UIAssetImage::is_image(data, len)) {
+      this->upload_error_ = "not a UI image";
+    } else {
+      ESP_LOGI(TAG, "Writing a new UI image to partition '%s'", this->label_);
+      // nothing is served from the partition until the new image is complete and checked
+      LockGuard guard(this->lock_);
+      this->image_.clear();
+      this->error_ = UIAssetImage::ERROR_EMPTY;
+    }
+  }
+  if (this->upload_error_ != nullptr)
+    return;
+
+  if (len > 0 && !this->write_(index, data, len))
+    return;
+  if (final) {
+    // writes invalidate the cache of the mapping, the new image can be read right away
+    this->load_();
+    if (this->error_ != UIAssetImage::OK)
+      this->upload_error_ = UIAssetImage::error_str(this->error_);
+  }
+}
+
+bool UIPartition::write_(size_t offset, const uint8_t *data, size_t len) {
+  if (offset + len > this->partition_->size) {
+    this->upload_error_ = "image too large for the partition";
+    return false;
+  }
+  // only the sectors the image needs are erased, a few KB of pages don't wait for the whole partition
+  while (this->erased_ < offset + len) {
+    if (esp_partition_erase_range(this->partition_, this->erased_, this->partition_->erase_size) != ESP_OK) {
+      this->upload_error_ = "flash erase failed";
+      return false;
+    }
+    this->erased_ += this->partition_->erase_size;
+  }
+  if (esp_partition_write(this->partition_, offset, data, len) != ESP_OK) {
+    this->upload_error_ = "flash write failed";
+    return false;
+  }
+  return true;
+}
+
+void UIPartition::handleRequest(AsyncWebServerRequest *request) {
+  if (this->upload_error_ != nullptr) {
+    ESP_LOGW(TAG, "UI upload failed: %s", this->upload_error_);
+    request->send(400, "application/json", (std::string("{\"error\":\"") + this->upload_error_ + "\"}").c_str());
+  } else {
+    ESP_LOGI(TAG, "New UI image: %zu assets, %" PRIu32 " bytes", this->image_.assets().size(), this->image_.size());
+    request->send(200, "application/json",
+                  str_sprintf("{\"ok\":true,\"assets\":%zu,\"bytes\":%" PRIu32 "}", this->image_.assets().size(),
+                              this->image_.size())
+                      .c_str());
+  }
+  this->upload_error_ = "no file";
+}
+
+}  // namespace web_server
+}  // namespace esphome
+
+#endif  // USE_WEBSERVER_UI_PARTITION
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_WEBSERVER_UI_PARTITION
+
+#include <esp_http_server.h>
+#include <esp_partition.h>
+
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "esphome/core/helpers.h"
+
+#include "ui_assets.h"
+
+namespace esphome {
+namespace web_server {
+
+/// Web UI assets in their own data partition, see ui_assets.h and the "Web UI partition" section of the README.
+///
+/// The partition is mapped once at setup and never unmapped, the assets are sent from the mapping in chunks. POST /ui
+/// replaces the image. While it is being written, and whenever the partition holds no valid image, find() finds
+/// nothing and the firmware serves its upload page instead (UI_UPLOAD_HTML of __init__.py).
+class UIPartition : public AsyncWebHandler {
+ public:
+  /// Bytes handed to the HTTP server at a time.
+  static constexpr size_t CHUNK_SIZE = 4096;
+
+  explicit UIPartition(const char *label) : label_(label) {}
+
+  void setup();
+  void dump_config();
+
+  /// The asset at a URL path. The asset points into the mapped partition, which stays mapped, so it may be used
+  /// after the call; its contents are only undefined if an upload starts in the meantime. Called from the tasks of
+  /// the web server and the keypad server.
+  bool find(const char *path, size_t len, UIAsset &asset) const;
+  /// Sends an asset as a chunked response straight from flash.
+  static esp_err_t send(httpd_req_t *req, const UIAsset &asset);
+
+  bool canHandle(AsyncWebServerRequest *request) const override {
+    return request->url() == "/ui" && request->method() == HTTP_POST;
+  }
+  void handleRequest(AsyncWebServerRequest *request) override;
+  void handleUpload(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len,
+                    bool final) override;
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  bool isRequestHandlerTrivial() const override { return false; }
+
+ protected:
+  /// Reads the index of the image in the partition, and checks the assets.
+  void load_();
+  /// Writes a chunk of an upload, erasing the sectors ahead of it.
+  bool write_(size_t offset, const uint8_t *data, size_t len);
+
+  const char *label_;
+  const esp_partition_t *partition_{nullptr};
+  const uint8_t *data_{nullptr};
+  esp_partition_mmap_handle_t handle_{};
+
+  // image_ is only changed by the upload in the web server task, lock_ guards it against find() from the keypad task
+  mutable Mutex lock_;
+  UIAssetImage image_;
+  UIAssetImage::Error error_{UIAssetImage::ERROR_EMPTY};
+
+  // upload state, web server task only
+  const char *upload_error_{"no file"};
+  uint32_t erased_{0};
+};
+
+}  // namespace web_server
+}  // namespace esphome
+
+#endif  // USE_WEBSERVER_UI_PARTITION
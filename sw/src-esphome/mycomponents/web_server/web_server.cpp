@@ -12,7 +12,10 @@
 #include "StreamString.h"
 #endif
 
+#include <algorithm>
+#include <cinttypes>
 #include <cstdlib>
+#include <cstring>
 
 #ifdef USE_LIGHT
 #include "esphome/components/light/light_json_schema.h"
@@ -26,6 +29,10 @@
 #include "esphome/components/climate/climate.h"
 #endif
 
+#ifdef USE_ESP_IDF
+#include <esp_heap_caps.h>
+#endif
+
 #ifdef USE_WEBSERVER_LOCAL
 #if USE_WEBSERVER_VERSION == 2
 #include "server_index_v2.h"
@@ -285,17 +292,54 @@ void WebServer::setup() {
 
 #ifdef USE_LOGGER
   if (logger::global_logger != nullptr && this->expose_log_) {
+#ifdef USE_ESP_IDF
+    // logs are buffered in a ring and sent from loop(), at the pace of each client
+    logger::global_logger->add_on_log_callback(
+        [this](int level, const char *tag, const char *message, size_t message_len) {
+          LockGuard guard(this->log_lock_);
+          this->log_ring_.push(level, message, message_len);
+        });
+#else
     logger::global_logger->add_on_log_callback(
         // logs are not deferred, the memory overhead would be too large
         [this](int level, const char *tag, const char *message, size_t message_len) {
           (void) message_len;
           this->events_.try_send_nodefer(message, "log", millis());
         });
+#endif
   }
 #endif
 
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+  // above the millis() ids of the events sent by the event source itself, and different for every boot
+  this->entity_table_.start_sequence(0x80000000 | (random_uint32() >> 2));
+#endif
 #ifdef USE_ESP_IDF
+  this->events_.onConnect([this](AsyncEventSourceClient *client) {
+#ifdef USE_LOGGER
+    // new clients catch up with the buffered log history
+    if (this->expose_log_) {
+      LockGuard guard(this->log_lock_);
+      this->log_clients_[client] = this->log_ring_.oldest(this->events_.connect_level());
+    }
+#endif
+#ifdef USE_WEBSERVER_LCD_MIRROR
+    if (this->events_.connect_lcd()) {
+      LockGuard guard(this->lcd_lock_);
+      this->lcd_viewers_[client] = LcdViewer{LcdMirror(this->lcd_interval_ms_), millis(), false};
+      this->lcd_viewer_count_ = this->lcd_viewers_.size();
+    }
+#endif
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+    // a reconnecting client only gets what it missed, a client at the address of one that just disconnected starts
+    // over
+    LockGuard guard(this->entity_lock_);
+    EntityCursor cursor = this->entity_table_.cursor(this->events_.connect_last_id());
+    this->entity_dumps_[client] = EntityDump{cursor, millis(), false};
+#endif
+  });
   this->base_->add_handler(&this->events_);
+  this->set_interval("heap", 60000, [this]() { this->log_heap_(); });
 #endif
   this->base_->add_handler(this);
 
@@ -303,15 +347,256 @@ void WebServer::setup() {
 
   // doesn't need defer functionality - if the queue is full, the client JS knows it's alive because it's clearly
   // getting a lot of events
-  this->set_interval(10000, [this]() { this->events_.try_send_nodefer("", "ping", millis(), 30000); });
+  this->set_interval(10000, [this]() { this->events_.try_send_nodefer("", "ping", event_id_(millis()), 30000); });
+
+#ifdef USE_WEBSERVER_UI_PARTITION
+  this->ui_partition_->setup();
+  this->base_->add_handler(this->ui_partition_);
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+  this->remote_keypad_->set_ui_partition(this->ui_partition_);
+#endif
+#endif
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+  this->remote_keypad_->setup();
+#endif
+}
+void WebServer::loop() {
+  this->events_.loop();
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+  this->remote_keypad_->loop();
+#endif
+#if defined(USE_LOGGER) && defined(USE_ESP_IDF)
+  if (this->expose_log_) {
+    this->log_stream_loop_();
+  }
+#endif
+#ifdef USE_WEBSERVER_LCD_MIRROR
+  this->lcd_mirror_loop_();
+#endif
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+  this->entity_dump_loop_();
+#endif
+}
+
+#if defined(USE_LOGGER) && defined(USE_ESP_IDF)
+void WebServer::log_stream_loop_() {
+  for (AsyncEventSourceResponse *client : this->events_.clients()) {
+    {
+      LockGuard guard(this->log_lock_);
+      auto it = this->log_clients_.find(client);
+      if (it == this->log_clients_.end()) {
+        it = this->log_clients_.emplace(client, this->log_ring_.oldest(ESPHOME_LOG_LEVEL_VERY_VERBOSE)).first;
+      }
+      if (it->second.seq == this->log_ring_.next_seq() && it->second.dropped == 0) {
+        continue;
+      }
+      this->log_ring_.read(it->second, this->log_batch_);
+    }
+
+    // at most one batch per client and loop, a client that doesn't take a line gets the rest in a later loop
+    const LogBatch &batch = this->log_batch_;
+    bool marker_sent = true;
+    size_t sent = 0;
+    if (batch.dropped() != 0) {
+      char marker[64];
+      snprintf(marker, sizeof(marker), "\033[0;33m[W][%s]: %" PRIu32 " log lines dropped\033[0m", TAG,
+               batch.dropped());
+      marker_sent = client->try_send_nodefer(marker, "log", event_id_(millis()));
+    }
+    while (marker_sent && sent < batch.size() &&
+           client->try_send_nodefer(batch.text(sent), "log", event_id_(millis()))) {
+      sent++;
+    }
+
+    LockGuard guard(this->log_lock_);
+    auto it = this->log_clients_.find(client);
+    if (it != this->log_clients_.end()) {
+      batch.consume(it->second, marker_sent, sent);
+    }
+  }
+
+  // forget the clients that disconnected
+  LockGuard guard(this->log_lock_);
+  for (auto it = this->log_clients_.begin(); it != this->log_clients_.end();) {
+    if (this->events_.clients().count(it->first) == 0) {
+      it = this->log_clients_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+#endif
+
+#ifdef USE_WEBSERVER_LCD_MIRROR
+void WebServer::lcd_mirror_loop_() {
+  if (this->lcd_viewer_count_ == 0) {
+    return;
+  }
+  uint32_t now = millis();
+  char text[LcdMirror::MAX_TEXT];
+  LockGuard guard(this->lcd_lock_);
+  for (auto it = this->lcd_viewers_.begin(); it != this->lcd_viewers_.end();) {
+    LcdViewer &viewer = it->second;
+    bool connected = this->events_.clients().count(it->first) != 0;
+    // forget the viewers that disconnected, or never showed up among the clients
+    if (!connected && (viewer.seen || now - viewer.since > 1000)) {
+      it = this->lcd_viewers_.erase(it);
+      continue;
+    }
+    viewer.seen |= connected;
+    // a frame that can't be queued is not acknowledged, its changes are sent with the next one
+    if (connected && this->lcd_captured_ && viewer.mirror.update(this->lcd_frame_, now, text) != 0 &&
+        it->first->try_send_nodefer(text, "lcd", event_id_(now))) {
+      viewer.mirror.acknowledge();
+    }
+    ++it;
+  }
+  this->lcd_viewer_count_ = this->lcd_viewers_.size();
+  if (this->lcd_viewers_.empty()) {
+    this->lcd_captured_ = false;
+  }
 }
-void WebServer::loop() { this->events_.loop(); }
+#endif
+
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+void WebServer::entity_dump_loop_() {
+  if (!this->events_.clients().empty() && !this->entity_table_.built()) {
+    // the entities and their static detail don't change, they are collected once
+    ListEntitiesIterator iterator(this, &this->entity_table_);
+    iterator.begin(this->include_internal_);
+    while (!iterator.completed()) {
+      iterator.advance();
+    }
+    this->entity_table_.build(this);
+    ESP_LOGD(TAG, "Entity table: %zu entities, %zu bytes of static detail", this->entity_table_.size(),
+             this->entity_table_.detail_bytes());
+  }
+
+  uint32_t now = millis();
+  for (AsyncEventSourceResponse *client : this->events_.clients()) {
+    // a client that onConnect() didn't leave a cursor for gets all entities
+    EntityCursor cursor;
+    {
+      LockGuard guard(this->entity_lock_);
+      EntityDump &dump = this->entity_dumps_.emplace(client, EntityDump{EntityCursor{}, now, true}).first->second;
+      dump.seen = true;
+      cursor = dump.cursor;
+    }
+    // a batch that can't be queued is written again in a later loop, with the state of then
+    uint32_t id;
+    for (uint8_t i = 0; i < ENTITY_BATCHES_PER_LOOP; i++) {
+      if (!this->entity_table_.next_batch(this, cursor, this->entity_batch_bytes_, this->entity_batch_, id) ||
+          !client->try_send_nodefer(this->entity_batch_.c_str(), "entities", id)) {
+        break;
+      }
+      this->entity_table_.consume(cursor);
+    }
+    LockGuard guard(this->entity_lock_);
+    this->entity_dumps_[client].cursor = cursor;
+  }
+
+  // forget the clients that disconnected, or never showed up among the clients; a cursor that onConnect() has just
+  // left for a client that isn't added yet stays
+  LockGuard guard(this->entity_lock_);
+  for (auto it = this->entity_dumps_.begin(); it != this->entity_dumps_.end();) {
+    const EntityDump &dump = it->second;
+    if (this->events_.clients().count(it->first) == 0 && (dump.seen || now - dump.since > 1000)) {
+      it = this->entity_dumps_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+#endif
+
+void WebServer::send_state_(void *source, message_generator_t *message_generator) {
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+  // goes out with the next pass of each client, also to the ones that reconnect later
+  this->entity_table_.changed(source);
+#else
+  if (this->events_.empty())
+    return;
+  this->events_.deferrable_send_state(source, "state", message_generator);
+#endif
+}
+
+#ifdef USE_ESP_IDF
+void WebServerEventSource::handleRequest(AsyncWebServerRequest *request) {
+  this->connect_level_ = ESPHOME_LOG_LEVEL_VERY_VERBOSE;
+  if (request->hasParam("level")) {
+    uint8_t level;
+    if (LogRing::parse_level(request->getParam("level")->value().c_str(), level)) {
+      this->connect_level_ = level;
+    }
+  }
+  this->connect_lcd_ = request->hasParam("lcd");
+  this->connect_last_id_ = 0;
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+  auto last_id = request->get_header("Last-Event-ID");
+  if (last_id.has_value()) {
+    this->connect_last_id_ = parse_number<uint32_t>(*last_id).value_or(0);
+  }
+#endif
+  AsyncEventSource::handleRequest(request);
+}
+#endif
 void WebServer::dump_config() {
   ESP_LOGCONFIG(TAG,
                 "Web Server:\n"
                 "  Address: %s:%u",
                 network::get_use_address().c_str(), this->base_->get_port());
+#ifdef USE_WEBSERVER_UI_PARTITION
+  this->ui_partition_->dump_config();
+#endif
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+  this->remote_keypad_->dump_config();
+#endif
+#ifdef USE_WEBSERVER_LCD_MIRROR
+  ESP_LOGCONFIG(TAG, "  LCD mirror: every %" PRIu32 "ms at most", this->lcd_interval_ms_);
+#endif
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+  ESP_LOGCONFIG(TAG, "  Entity batches: %u bytes", this->entity_batch_bytes_);
+#endif
+}
+
+#ifdef USE_ESP_IDF
+void WebServer::log_heap_() {
+  uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  this->heap_largest_min_ = std::min(this->heap_largest_min_, largest);
+  ESP_LOGD(TAG, "Heap: %zu free, largest block %" PRIu32 " (lowest %" PRIu32 ")",
+           heap_caps_get_free_size(MALLOC_CAP_8BIT), largest, this->heap_largest_min_);
+}
+#endif
+
+#ifdef USE_WEBSERVER_LCD
+void WebServer::capture_lcd(const LcdFrame &frame, uint32_t key_ticket) {
+  // nothing to do while nobody is watching
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+  bool keypad = this->remote_keypad_->active();
+#else
+  bool keypad = false;
+#endif
+#ifdef USE_WEBSERVER_LCD_MIRROR
+  bool mirror = this->lcd_viewer_count_ != 0;
+#else
+  bool mirror = false;
+#endif
+  if (!keypad && !mirror) {
+    return;
+  }
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+  if (keypad) {
+    this->remote_keypad_->set_frame(frame, key_ticket);
+  }
+#endif
+#ifdef USE_WEBSERVER_LCD_MIRROR
+  if (mirror) {
+    this->lcd_frame_ = frame;
+    this->lcd_captured_ = true;
+  }
+#endif
 }
+#endif
 float WebServer::get_setup_priority() const { return setup_priority::WIFI - 1.0f; }
 
 #ifdef USE_WEBSERVER_LOCAL
@@ -407,11 +692,21 @@ static JsonDetail get_request_detail(AsyncWebServerRequest *request) {
   return (param && param->value() == "all") ? DETAIL_ALL : DETAIL_STATE;
 }
 
+// State events are written with a JsonWriter into a buffer of the server instead of building an ArduinoJson document
+// and copying it out. A state that doesn't fit the buffer (a long text) takes the *_json() path instead.
+
+#if defined(USE_SENSOR) || defined(USE_NUMBER) || defined(USE_CLIMATE)
+// Helper to write a number like value_accuracy_to_string() does
+static void add_accuracy(JsonWriter &json, const char *key, float value, int8_t accuracy_decimals,
+                         const std::string &unit) {
+  normalize_accuracy_decimals(value, accuracy_decimals);
+  json.add_decimal(key, value, accuracy_decimals, unit);
+}
+#endif
+
 #ifdef USE_SENSOR
 void WebServer::on_sensor_update(sensor::Sensor *obj, float state) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", sensor_state_json_generator);
+  this->send_state_(obj, state_json_generator_<sensor_state_json>);
 }
 void WebServer::handle_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (sensor::Sensor *obj : App.get_sensors()) {
@@ -426,8 +721,21 @@ void WebServer::handle_sensor_request(AsyncWebServerRequest *request, const UrlM
   }
   request->send(404);
 }
-std::string WebServer::sensor_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->sensor_json((sensor::Sensor *) (source), ((sensor::Sensor *) (source))->state, DETAIL_STATE);
+JsonView WebServer::sensor_state_json(WebServer *web_server, void *source) {
+  auto *obj = (sensor::Sensor *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "sensor-", obj->get_object_id());
+  json.add("value", obj->state);
+  if (std::isnan(obj->state)) {
+    json.add("state", "NA");
+  } else {
+    add_accuracy(json, "state", obj->state, obj->get_accuracy_decimals(), obj->get_unit_of_measurement());
+  }
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->sensor_json(obj, obj->state, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::sensor_all_json_generator(WebServer *web_server, void *source) {
   return web_server->sensor_json((sensor::Sensor *) (source), ((sensor::Sensor *) (source))->state, DETAIL_ALL);
@@ -454,9 +762,7 @@ std::string WebServer::sensor_json(sensor::Sensor *obj, float value, JsonDetail
 
 #ifdef USE_TEXT_SENSOR
 void WebServer::on_text_sensor_update(text_sensor::TextSensor *obj, const std::string &state) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", text_sensor_state_json_generator);
+  this->send_state_(obj, state_json_generator_<text_sensor_state_json>);
 }
 void WebServer::handle_text_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (text_sensor::TextSensor *obj : App.get_text_sensors()) {
@@ -471,9 +777,17 @@ void WebServer::handle_text_sensor_request(AsyncWebServerRequest *request, const
   }
   request->send(404);
 }
-std::string WebServer::text_sensor_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->text_sensor_json((text_sensor::TextSensor *) (source),
-                                      ((text_sensor::TextSensor *) (source))->state, DETAIL_STATE);
+JsonView WebServer::text_sensor_state_json(WebServer *web_server, void *source) {
+  auto *obj = (text_sensor::TextSensor *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "text_sensor-", obj->get_object_id());
+  json.add("value", obj->state);
+  json.add("state", obj->state);
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->text_sensor_json(obj, obj->state, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::text_sensor_all_json_generator(WebServer *web_server, void *source) {
   return web_server->text_sensor_json((text_sensor::TextSensor *) (source),
@@ -492,9 +806,7 @@ std::string WebServer::text_sensor_json(text_sensor::TextSensor *obj, const std:
 
 #ifdef USE_SWITCH
 void WebServer::on_switch_update(switch_::Switch *obj, bool state) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", switch_state_json_generator);
+  this->send_state_(obj, state_json_generator_<switch_state_json>);
 }
 void WebServer::handle_switch_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (switch_::Switch *obj : App.get_switches()) {
@@ -521,8 +833,17 @@ void WebServer::handle_switch_request(AsyncWebServerRequest *request, const UrlM
   }
   request->send(404);
 }
-std::string WebServer::switch_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->switch_json((switch_::Switch *) (source), ((switch_::Switch *) (source))->state, DETAIL_STATE);
+JsonView WebServer::switch_state_json(WebServer *web_server, void *source) {
+  auto *obj = (switch_::Switch *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "switch-", obj->get_object_id());
+  json.add("value", obj->state);
+  json.add("state", obj->state ? "ON" : "OFF");
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->switch_json(obj, obj->state, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::switch_all_json_generator(WebServer *web_server, void *source) {
   return web_server->switch_json((switch_::Switch *) (source), ((switch_::Switch *) (source))->state, DETAIL_ALL);
@@ -558,8 +879,15 @@ void WebServer::handle_button_request(AsyncWebServerRequest *request, const UrlM
   }
   request->send(404);
 }
-std::string WebServer::button_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->button_json((button::Button *) (source), DETAIL_STATE);
+JsonView WebServer::button_state_json(WebServer *web_server, void *source) {
+  auto *obj = (button::Button *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "button-", obj->get_object_id());
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->button_json(obj, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::button_all_json_generator(WebServer *web_server, void *source) {
   return web_server->button_json((button::Button *) (source), DETAIL_ALL);
@@ -576,9 +904,7 @@ std::string WebServer::button_json(button::Button *obj, JsonDetail start_config)
 
 #ifdef USE_BINARY_SENSOR
 void WebServer::on_binary_sensor_update(binary_sensor::BinarySensor *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", binary_sensor_state_json_generator);
+  this->send_state_(obj, state_json_generator_<binary_sensor_state_json>);
 }
 void WebServer::handle_binary_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (binary_sensor::BinarySensor *obj : App.get_binary_sensors()) {
@@ -593,9 +919,17 @@ void WebServer::handle_binary_sensor_request(AsyncWebServerRequest *request, con
   }
   request->send(404);
 }
-std::string WebServer::binary_sensor_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->binary_sensor_json((binary_sensor::BinarySensor *) (source),
-                                        ((binary_sensor::BinarySensor *) (source))->state, DETAIL_STATE);
+JsonView WebServer::binary_sensor_state_json(WebServer *web_server, void *source) {
+  auto *obj = (binary_sensor::BinarySensor *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "binary_sensor-", obj->get_object_id());
+  json.add("value", obj->state);
+  json.add("state", obj->state ? "ON" : "OFF");
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->binary_sensor_json(obj, obj->state, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::binary_sensor_all_json_generator(WebServer *web_server, void *source) {
   return web_server->binary_sensor_json((binary_sensor::BinarySensor *) (source),
@@ -614,9 +948,7 @@ std::string WebServer::binary_sensor_json(binary_sensor::BinarySensor *obj, bool
 
 #ifdef USE_FAN
 void WebServer::on_fan_update(fan::Fan *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", fan_state_json_generator);
+  this->send_state_(obj, state_json_generator_<fan_state_json>);
 }
 void WebServer::handle_fan_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (fan::Fan *obj : App.get_fans()) {
@@ -669,8 +1001,24 @@ void WebServer::handle_fan_request(AsyncWebServerRequest *request, const UrlMatc
   }
   request->send(404);
 }
-std::string WebServer::fan_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->fan_json((fan::Fan *) (source), DETAIL_STATE);
+JsonView WebServer::fan_state_json(WebServer *web_server, void *source) {
+  auto *obj = (fan::Fan *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "fan-", obj->get_object_id());
+  json.add("value", obj->state);
+  json.add("state", obj->state ? "ON" : "OFF");
+  const auto traits = obj->get_traits();
+  if (traits.supports_speed()) {
+    json.add("speed_level", (int) obj->speed);
+    json.add("speed_count", (int) traits.supported_speed_count());
+  }
+  if (traits.supports_oscillation())
+    json.add("oscillation", obj->oscillating);
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->fan_json(obj, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::fan_all_json_generator(WebServer *web_server, void *source) {
   return web_server->fan_json((fan::Fan *) (source), DETAIL_ALL);
@@ -695,9 +1043,7 @@ std::string WebServer::fan_json(fan::Fan *obj, JsonDetail start_config) {
 
 #ifdef USE_LIGHT
 void WebServer::on_light_update(light::LightState *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", light_state_json_generator);
+  this->send_state_(obj, state_json_generator_<light_state_json>);
 }
 void WebServer::handle_light_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (light::LightState *obj : App.get_lights()) {
@@ -785,8 +1131,8 @@ void WebServer::handle_light_request(AsyncWebServerRequest *request, const UrlMa
   }
   request->send(404);
 }
-std::string WebServer::light_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->light_json((light::LightState *) (source), DETAIL_STATE);
+JsonView WebServer::light_state_json(WebServer *web_server, void *source) {
+  return web_server->spill_state_json_(web_server->light_json((light::LightState *) (source), DETAIL_STATE));
 }
 std::string WebServer::light_all_json_generator(WebServer *web_server, void *source) {
   return web_server->light_json((light::LightState *) (source), DETAIL_ALL);
@@ -811,9 +1157,7 @@ std::string WebServer::light_json(light::LightState *obj, JsonDetail start_confi
 
 #ifdef USE_COVER
 void WebServer::on_cover_update(cover::Cover *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", cover_state_json_generator);
+  this->send_state_(obj, state_json_generator_<cover_state_json>);
 }
 void WebServer::handle_cover_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (cover::Cover *obj : App.get_covers()) {
@@ -867,8 +1211,22 @@ void WebServer::handle_cover_request(AsyncWebServerRequest *request, const UrlMa
   }
   request->send(404);
 }
-std::string WebServer::cover_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->cover_json((cover::Cover *) (source), DETAIL_STATE);
+JsonView WebServer::cover_state_json(WebServer *web_server, void *source) {
+  auto *obj = (cover::Cover *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "cover-", obj->get_object_id());
+  json.add("value", obj->position);
+  json.add("state", obj->is_fully_closed() ? "CLOSED" : "OPEN");
+  json.add("current_operation", cover::cover_operation_to_str(obj->current_operation));
+  if (obj->get_traits().get_supports_position())
+    json.add("position", obj->position);
+  if (obj->get_traits().get_supports_tilt())
+    json.add("tilt", obj->tilt);
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->cover_json(obj, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::cover_all_json_generator(WebServer *web_server, void *source) {
   return web_server->cover_json((cover::Cover *) (source), DETAIL_STATE);
@@ -892,9 +1250,7 @@ std::string WebServer::cover_json(cover::Cover *obj, JsonDetail start_config) {
 
 #ifdef USE_NUMBER
 void WebServer::on_number_update(number::Number *obj, float state) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", number_state_json_generator);
+  this->send_state_(obj, state_json_generator_<number_state_json>);
 }
 void WebServer::handle_number_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (auto *obj : App.get_numbers()) {
@@ -926,8 +1282,23 @@ void WebServer::handle_number_request(AsyncWebServerRequest *request, const UrlM
   request->send(404);
 }
 
-std::string WebServer::number_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->number_json((number::Number *) (source), ((number::Number *) (source))->state, DETAIL_STATE);
+JsonView WebServer::number_state_json(WebServer *web_server, void *source) {
+  auto *obj = (number::Number *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "number-", obj->get_object_id());
+  if (std::isnan(obj->state)) {
+    json.add("value", "\"NaN\"");
+    json.add("state", "NA");
+  } else {
+    int8_t accuracy = step_to_accuracy_decimals(obj->traits.get_step());
+    add_accuracy(json, "value", obj->state, accuracy, std::string());
+    add_accuracy(json, "state", obj->state, accuracy, obj->traits.get_unit_of_measurement());
+  }
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->number_json(obj, obj->state, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::number_all_json_generator(WebServer *web_server, void *source) {
   return web_server->number_json((number::Number *) (source), ((number::Number *) (source))->state, DETAIL_ALL);
@@ -963,9 +1334,7 @@ std::string WebServer::number_json(number::Number *obj, float value, JsonDetail
 
 #ifdef USE_DATETIME_DATE
 void WebServer::on_date_update(datetime::DateEntity *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", date_state_json_generator);
+  this->send_state_(obj, state_json_generator_<date_state_json>);
 }
 void WebServer::handle_date_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (auto *obj : App.get_dates()) {
@@ -1001,8 +1370,19 @@ void WebServer::handle_date_request(AsyncWebServerRequest *request, const UrlMat
   request->send(404);
 }
 
-std::string WebServer::date_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->date_json((datetime::DateEntity *) (source), DETAIL_STATE);
+JsonView WebServer::date_state_json(WebServer *web_server, void *source) {
+  auto *obj = (datetime::DateEntity *) (source);
+  char value[16];
+  snprintf(value, sizeof(value), "%d-%02d-%02d", obj->year, obj->month, obj->day);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "date-", obj->get_object_id());
+  json.add("value", value);
+  json.add("state", value);
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->date_json(obj, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::date_all_json_generator(WebServer *web_server, void *source) {
   return web_server->date_json((datetime::DateEntity *) (source), DETAIL_ALL);
@@ -1022,9 +1402,7 @@ std::string WebServer::date_json(datetime::DateEntity *obj, JsonDetail start_con
 
 #ifdef USE_DATETIME_TIME
 void WebServer::on_time_update(datetime::TimeEntity *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", time_state_json_generator);
+  this->send_state_(obj, state_json_generator_<time_state_json>);
 }
 void WebServer::handle_time_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (auto *obj : App.get_times()) {
@@ -1059,8 +1437,19 @@ void WebServer::handle_time_request(AsyncWebServerRequest *request, const UrlMat
   }
   request->send(404);
 }
-std::string WebServer::time_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->time_json((datetime::TimeEntity *) (source), DETAIL_STATE);
+JsonView WebServer::time_state_json(WebServer *web_server, void *source) {
+  auto *obj = (datetime::TimeEntity *) (source);
+  char value[16];
+  snprintf(value, sizeof(value), "%02d:%02d:%02d", obj->hour, obj->minute, obj->second);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "time-", obj->get_object_id());
+  json.add("value", value);
+  json.add("state", value);
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->time_json(obj, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::time_all_json_generator(WebServer *web_server, void *source) {
   return web_server->time_json((datetime::TimeEntity *) (source), DETAIL_ALL);
@@ -1080,9 +1469,7 @@ std::string WebServer::time_json(datetime::TimeEntity *obj, JsonDetail start_con
 
 #ifdef USE_DATETIME_DATETIME
 void WebServer::on_datetime_update(datetime::DateTimeEntity *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", datetime_state_json_generator);
+  this->send_state_(obj, state_json_generator_<datetime_state_json>);
 }
 void WebServer::handle_datetime_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (auto *obj : App.get_datetimes()) {
@@ -1117,8 +1504,20 @@ void WebServer::handle_datetime_request(AsyncWebServerRequest *request, const Ur
   }
   request->send(404);
 }
-std::string WebServer::datetime_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->datetime_json((datetime::DateTimeEntity *) (source), DETAIL_STATE);
+JsonView WebServer::datetime_state_json(WebServer *web_server, void *source) {
+  auto *obj = (datetime::DateTimeEntity *) (source);
+  char value[32];
+  snprintf(value, sizeof(value), "%d-%02d-%02d %02d:%02d:%02d", obj->year, obj->month, obj->day, obj->hour,
+           obj->minute, obj->second);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "datetime-", obj->get_object_id());
+  json.add("value", value);
+  json.add("state", value);
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->datetime_json(obj, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::datetime_all_json_generator(WebServer *web_server, void *source) {
   return web_server->datetime_json((datetime::DateTimeEntity *) (source), DETAIL_ALL);
@@ -1139,9 +1538,7 @@ std::string WebServer::datetime_json(datetime::DateTimeEntity *obj, JsonDetail s
 
 #ifdef USE_TEXT
 void WebServer::on_text_update(text::Text *obj, const std::string &state) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", text_state_json_generator);
+  this->send_state_(obj, state_json_generator_<text_state_json>);
 }
 void WebServer::handle_text_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (auto *obj : App.get_texts()) {
@@ -1172,8 +1569,24 @@ void WebServer::handle_text_request(AsyncWebServerRequest *request, const UrlMat
   request->send(404);
 }
 
-std::string WebServer::text_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->text_json((text::Text *) (source), ((text::Text *) (source))->state, DETAIL_STATE);
+JsonView WebServer::text_state_json(WebServer *web_server, void *source) {
+  auto *obj = (text::Text *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "text-", obj->get_object_id());
+  json.add("min_length", (int) obj->traits.get_min_length());
+  json.add("max_length", (int) obj->traits.get_max_length());
+  json.add("pattern", obj->traits.get_pattern());
+  if (obj->traits.get_mode() == text::TextMode::TEXT_MODE_PASSWORD) {
+    json.add("state", "********");
+  } else {
+    json.add("state", obj->state);
+  }
+  json.add("value", obj->state);
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->text_json(obj, obj->state, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::text_all_json_generator(WebServer *web_server, void *source) {
   return web_server->text_json((text::Text *) (source), ((text::Text *) (source))->state, DETAIL_ALL);
@@ -1200,9 +1613,7 @@ std::string WebServer::text_json(text::Text *obj, const std::string &value, Json
 
 #ifdef USE_SELECT
 void WebServer::on_select_update(select::Select *obj, const std::string &state, size_t index) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", select_state_json_generator);
+  this->send_state_(obj, state_json_generator_<select_state_json>);
 }
 void WebServer::handle_select_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (auto *obj : App.get_selects()) {
@@ -1234,8 +1645,17 @@ void WebServer::handle_select_request(AsyncWebServerRequest *request, const UrlM
   }
   request->send(404);
 }
-std::string WebServer::select_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->select_json((select::Select *) (source), ((select::Select *) (source))->state, DETAIL_STATE);
+JsonView WebServer::select_state_json(WebServer *web_server, void *source) {
+  auto *obj = (select::Select *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "select-", obj->get_object_id());
+  json.add("value", obj->state);
+  json.add("state", obj->state);
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->select_json(obj, obj->state, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::select_all_json_generator(WebServer *web_server, void *source) {
   return web_server->select_json((select::Select *) (source), ((select::Select *) (source))->state, DETAIL_ALL);
@@ -1259,9 +1679,7 @@ std::string WebServer::select_json(select::Select *obj, const std::string &value
 
 #ifdef USE_CLIMATE
 void WebServer::on_climate_update(climate::Climate *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", climate_state_json_generator);
+  this->send_state_(obj, state_json_generator_<climate_state_json>);
 }
 void WebServer::handle_climate_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (auto *obj : App.get_climates()) {
@@ -1321,8 +1739,63 @@ void WebServer::handle_climate_request(AsyncWebServerRequest *request, const Url
   }
   request->send(404);
 }
-std::string WebServer::climate_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->climate_json((climate::Climate *) (source), DETAIL_STATE);
+JsonView WebServer::climate_state_json(WebServer *web_server, void *source) {
+  auto *obj = (climate::Climate *) (source);
+  const auto traits = obj->get_traits();
+  int8_t target_accuracy = traits.get_target_temperature_accuracy_decimals();
+  int8_t current_accuracy = traits.get_current_temperature_accuracy_decimals();
+  char buf[16];
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "climate-", obj->get_object_id());
+  bool has_state = false;
+  json.add("mode", PSTR_LOCAL(climate_mode_to_string(obj->mode)));
+  add_accuracy(json, "max_temp", traits.get_visual_max_temperature(), target_accuracy, std::string());
+  add_accuracy(json, "min_temp", traits.get_visual_min_temperature(), target_accuracy, std::string());
+  json.add("step", traits.get_visual_target_temperature_step());
+  if (traits.get_supports_action()) {
+    json.add("action", PSTR_LOCAL(climate_action_to_string(obj->action)));
+    json.add("state", PSTR_LOCAL(climate_action_to_string(obj->action)));
+    has_state = true;
+  }
+  if (traits.get_supports_fan_modes() && obj->fan_mode.has_value()) {
+    json.add("fan_mode", PSTR_LOCAL(climate_fan_mode_to_string(obj->fan_mode.value())));
+  }
+  if (!traits.get_supported_custom_fan_modes().empty() && obj->custom_fan_mode.has_value()) {
+    json.add("custom_fan_mode", obj->custom_fan_mode.value());
+  }
+  if (traits.get_supports_presets() && obj->preset.has_value()) {
+    json.add("preset", PSTR_LOCAL(climate_preset_to_string(obj->preset.value())));
+  }
+  if (!traits.get_supported_custom_presets().empty() && obj->custom_preset.has_value()) {
+    json.add("custom_preset", obj->custom_preset.value());
+  }
+  if (traits.get_supports_swing_modes()) {
+    json.add("swing_mode", PSTR_LOCAL(climate_swing_mode_to_string(obj->swing_mode)));
+  }
+  if (traits.get_supports_current_temperature()) {
+    if (!std::isnan(obj->current_temperature)) {
+      add_accuracy(json, "current_temperature", obj->current_temperature, current_accuracy, std::string());
+    } else {
+      json.add("current_temperature", "NA");
+    }
+  }
+  if (traits.get_supports_two_point_target_temperature()) {
+    add_accuracy(json, "target_temperature_low", obj->target_temperature_low, target_accuracy, std::string());
+    add_accuracy(json, "target_temperature_high", obj->target_temperature_high, target_accuracy, std::string());
+    if (!has_state) {
+      add_accuracy(json, "state", (obj->target_temperature_high + obj->target_temperature_low) / 2.0f,
+                   target_accuracy, std::string());
+    }
+  } else {
+    add_accuracy(json, "target_temperature", obj->target_temperature, target_accuracy, std::string());
+    if (!has_state)
+      add_accuracy(json, "state", obj->target_temperature, target_accuracy, std::string());
+  }
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->climate_json(obj, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::climate_all_json_generator(WebServer *web_server, void *source) {
   return web_server->climate_json((climate::Climate *) (source), DETAIL_ALL);
@@ -1420,9 +1893,7 @@ std::string WebServer::climate_json(climate::Climate *obj, JsonDetail start_conf
 
 #ifdef USE_LOCK
 void WebServer::on_lock_update(lock::Lock *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", lock_state_json_generator);
+  this->send_state_(obj, state_json_generator_<lock_state_json>);
 }
 void WebServer::handle_lock_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (lock::Lock *obj : App.get_locks()) {
@@ -1449,8 +1920,17 @@ void WebServer::handle_lock_request(AsyncWebServerRequest *request, const UrlMat
   }
   request->send(404);
 }
-std::string WebServer::lock_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->lock_json((lock::Lock *) (source), ((lock::Lock *) (source))->state, DETAIL_STATE);
+JsonView WebServer::lock_state_json(WebServer *web_server, void *source) {
+  auto *obj = (lock::Lock *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "lock-", obj->get_object_id());
+  json.add("value", (int) obj->state);
+  json.add("state", lock::lock_state_to_string(obj->state));
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->lock_json(obj, obj->state, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::lock_all_json_generator(WebServer *web_server, void *source) {
   return web_server->lock_json((lock::Lock *) (source), ((lock::Lock *) (source))->state, DETAIL_ALL);
@@ -1468,9 +1948,7 @@ std::string WebServer::lock_json(lock::Lock *obj, lock::LockState value, JsonDet
 
 #ifdef USE_VALVE
 void WebServer::on_valve_update(valve::Valve *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", valve_state_json_generator);
+  this->send_state_(obj, state_json_generator_<valve_state_json>);
 }
 void WebServer::handle_valve_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (valve::Valve *obj : App.get_valves()) {
@@ -1517,8 +1995,20 @@ void WebServer::handle_valve_request(AsyncWebServerRequest *request, const UrlMa
   }
   request->send(404);
 }
-std::string WebServer::valve_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->valve_json((valve::Valve *) (source), DETAIL_STATE);
+JsonView WebServer::valve_state_json(WebServer *web_server, void *source) {
+  auto *obj = (valve::Valve *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "valve-", obj->get_object_id());
+  json.add("value", obj->position);
+  json.add("state", obj->is_fully_closed() ? "CLOSED" : "OPEN");
+  json.add("current_operation", valve::valve_operation_to_str(obj->current_operation));
+  if (obj->get_traits().get_supports_position())
+    json.add("position", obj->position);
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->valve_json(obj, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::valve_all_json_generator(WebServer *web_server, void *source) {
   return web_server->valve_json((valve::Valve *) (source), DETAIL_ALL);
@@ -1540,9 +2030,7 @@ std::string WebServer::valve_json(valve::Valve *obj, JsonDetail start_config) {
 
 #ifdef USE_ALARM_CONTROL_PANEL
 void WebServer::on_alarm_control_panel_update(alarm_control_panel::AlarmControlPanel *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", alarm_control_panel_state_json_generator);
+  this->send_state_(obj, state_json_generator_<alarm_control_panel_state_json>);
 }
 void WebServer::handle_alarm_control_panel_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (alarm_control_panel::AlarmControlPanel *obj : App.get_alarm_control_panels()) {
@@ -1582,10 +2070,19 @@ void WebServer::handle_alarm_control_panel_request(AsyncWebServerRequest *reques
   }
   request->send(404);
 }
-std::string WebServer::alarm_control_panel_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->alarm_control_panel_json((alarm_control_panel::AlarmControlPanel *) (source),
-                                              ((alarm_control_panel::AlarmControlPanel *) (source))->get_state(),
-                                              DETAIL_STATE);
+JsonView WebServer::alarm_control_panel_state_json(WebServer *web_server, void *source) {
+  auto *obj = (alarm_control_panel::AlarmControlPanel *) (source);
+  auto value = obj->get_state();
+  char buf[16];
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "alarm-control-panel-", obj->get_object_id());
+  json.add("value", (int) value);
+  json.add("state", PSTR_LOCAL(alarm_control_panel_state_to_string(value)));
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->alarm_control_panel_json(obj, value, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::alarm_control_panel_all_json_generator(WebServer *web_server, void *source) {
   return web_server->alarm_control_panel_json((alarm_control_panel::AlarmControlPanel *) (source),
@@ -1608,7 +2105,7 @@ std::string WebServer::alarm_control_panel_json(alarm_control_panel::AlarmContro
 
 #ifdef USE_EVENT
 void WebServer::on_event(event::Event *obj, const std::string &event_type) {
-  this->events_.deferrable_send_state(obj, "state", event_state_json_generator);
+  this->events_.deferrable_send_state(obj, "state", state_json_generator_<event_state_json>);
 }
 
 void WebServer::handle_event_request(AsyncWebServerRequest *request, const UrlMatch &match) {
@@ -1630,9 +2127,18 @@ static std::string get_event_type(event::Event *event) {
   return (event && event->last_event_type) ? *event->last_event_type : "";
 }
 
-std::string WebServer::event_state_json_generator(WebServer *web_server, void *source) {
+JsonView WebServer::event_state_json(WebServer *web_server, void *source) {
   auto *event = static_cast<event::Event *>(source);
-  return web_server->event_json(event, get_event_type(event), DETAIL_STATE);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "event-", event->get_object_id());
+  if (event->last_event_type != nullptr && !event->last_event_type->empty()) {
+    json.add("event_type", *event->last_event_type);
+  }
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->event_json(event, get_event_type(event), DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::event_all_json_generator(WebServer *web_server, void *source) {
   auto *event = static_cast<event::Event *>(source);
@@ -1658,9 +2164,7 @@ std::string WebServer::event_json(event::Event *obj, const std::string &event_ty
 
 #ifdef USE_UPDATE
 void WebServer::on_update(update::UpdateEntity *obj) {
-  if (this->events_.empty())
-    return;
-  this->events_.deferrable_send_state(obj, "state", update_state_json_generator);
+  this->send_state_(obj, state_json_generator_<update_state_json>);
 }
 void WebServer::handle_update_request(AsyncWebServerRequest *request, const UrlMatch &match) {
   for (update::UpdateEntity *obj : App.get_updates()) {
@@ -1685,8 +2189,30 @@ void WebServer::handle_update_request(AsyncWebServerRequest *request, const UrlM
   }
   request->send(404);
 }
-std::string WebServer::update_state_json_generator(WebServer *web_server, void *source) {
-  return web_server->update_json((update::UpdateEntity *) (source), DETAIL_STATE);
+JsonView WebServer::update_state_json(WebServer *web_server, void *source) {
+  auto *obj = (update::UpdateEntity *) (source);
+  JsonWriter json = web_server->state_json_writer_();
+  json.begin_object();
+  json.add("id", "update-", obj->get_object_id());
+  json.add("value", obj->update_info.latest_version);
+  switch (obj->state) {
+    case update::UPDATE_STATE_NO_UPDATE:
+      json.add("state", "NO UPDATE");
+      break;
+    case update::UPDATE_STATE_AVAILABLE:
+      json.add("state", "UPDATE AVAILABLE");
+      break;
+    case update::UPDATE_STATE_INSTALLING:
+      json.add("state", "INSTALLING");
+      break;
+    default:
+      json.add("state", "UNKNOWN");
+      break;
+  }
+  json.end_object();
+  if (!json.ok())
+    return web_server->spill_state_json_(web_server->update_json(obj, DETAIL_STATE));
+  return json.view();
 }
 std::string WebServer::update_all_json_generator(WebServer *web_server, void *source) {
   return web_server->update_json((update::UpdateEntity *) (source), DETAIL_STATE);
@@ -1726,6 +2252,13 @@ bool WebServer::canHandle(AsyncWebServerRequest *request) const {
   if (request->url() == "/")
     return true;
 
+#ifdef USE_WEBSERVER_UI_PARTITION
+  UIAsset asset;
+  if (request->method() == HTTP_GET &&
+      this->ui_partition_->find(request->url().c_str(), request->url().size(), asset))
+    return true;
+#endif
+
 #ifdef USE_ARDUINO
   if (request->url() == "/events") {
     return true;
@@ -1858,6 +2391,16 @@ bool WebServer::canHandle(AsyncWebServerRequest *request) const {
   return false;
 }
 void WebServer::handleRequest(AsyncWebServerRequest *request) {
+#ifdef USE_WEBSERVER_UI_PARTITION
+  // the pages in the UI partition take the place of the built-in ones
+  UIAsset asset;
+  if (request->method() == HTTP_GET &&
+      this->ui_partition_->find(request->url().c_str(), request->url().size(), asset)) {
+    UIPartition::send(*request, asset);
+    return;
+  }
+#endif
+
   if (request->url() == "/") {
     this->handle_index_request(request);
     return;
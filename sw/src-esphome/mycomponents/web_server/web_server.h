@@ -1,16 +1,32 @@
 #pragma once
 
+#include "entity_table.h"
+#include "json_writer.h"
 #include "list_entities.h"
+#include "log_ring.h"
+#include "remote_keypad.h"
+#include "ui_partition.h"
 
 #include "esphome/components/web_server_base/web_server_base.h"
 #ifdef USE_WEBSERVER
 #include "esphome/core/component.h"
 #include "esphome/core/controller.h"
 #include "esphome/core/entity_base.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
 
+#ifdef USE_WEBSERVER_LCD
+#include "src-common/lcd_frame.hpp"
+#endif
+#ifdef USE_WEBSERVER_LCD_MIRROR
+#include "src-common/lcd_mirror.hpp"
+#endif
+
+#include <atomic>
 #include <functional>
 #include <list>
 #include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -154,6 +170,31 @@ class DeferredUpdateEventSourceList : public std::list<DeferredUpdateEventSource
 };
 #endif
 
+#ifdef USE_ESP_IDF
+/// The /events event source, with access to its clients for the per-client log and LCD streams.
+class WebServerEventSource : public AsyncEventSource {
+ public:
+  using AsyncEventSource::AsyncEventSource;
+
+  /// Takes the optional `level` (a log level name or number) and `lcd` query parameters of a new client before
+  /// connecting it.
+  void handleRequest(AsyncWebServerRequest *request) override;
+
+  /// Log level requested by the client that is being connected, valid in the onConnect() callback.
+  uint8_t connect_level() const { return this->connect_level_; }
+  /// Whether the client that is being connected wants the LCD mirror, valid in the onConnect() callback.
+  bool connect_lcd() const { return this->connect_lcd_; }
+  /// Last-Event-ID of the client that is being connected (0 if none), valid in the onConnect() callback.
+  uint32_t connect_last_id() const { return this->connect_last_id_; }
+  const std::set<AsyncEventSourceResponse *> &clients() const { return this->sessions_; }
+
+ protected:
+  uint8_t connect_level_{ESPHOME_LOG_LEVEL_VERY_VERBOSE};
+  bool connect_lcd_{false};
+  uint32_t connect_last_id_{0};
+};
+#endif
+
 /** This class allows users to create a web server with their ESP nodes.
  *
  * Behind the scenes it's using AsyncWebServer to set up the server. It exposes 3 things:
@@ -215,6 +256,34 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
    */
   void set_expose_log(bool expose_log) { this->expose_log_ = expose_log; }
 
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+  void set_remote_keypad(RemoteKeypad *remote_keypad) { this->remote_keypad_ = remote_keypad; }
+#endif
+
+#ifdef USE_WEBSERVER_UI_PARTITION
+  /// Serve the pages from the UI partition, when it holds them.
+  void set_ui_partition(UIPartition *ui_partition) { this->ui_partition_ = ui_partition; }
+#endif
+
+#ifdef USE_WEBSERVER_LCD_MIRROR
+  /// Limit the LCD events sent to each client to this many per second.
+  void set_lcd_mirror_fps(uint8_t fps) { this->lcd_interval_ms_ = 1000 / fps; }
+#endif
+
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+  /// Pack the entities of the initial dump into `entities` events of up to this many bytes.
+  void set_entity_batch_bytes(uint16_t bytes) { this->entity_batch_bytes_ = bytes; }
+#endif
+
+#ifdef USE_WEBSERVER_LCD
+  /** Give the web clients a copy of the LCD, to be called from the display lambda after rendering.
+   *
+   * @param frame The cells that were just shown (the frame of GameLoop::show()).
+   * @param key_ticket The ticket of the last remote keypad key the display shows (the `ticket` of on_key).
+   */
+  void capture_lcd(const LcdFrame &frame, uint32_t key_ticket = 0);
+#endif
+
   // ========== INTERNAL METHODS ==========
   // (In most use cases you won't need these)
   /// Setup the internal web server and register handlers.
@@ -252,7 +321,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a sensor request under '/sensor/<id>'.
   void handle_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string sensor_state_json_generator(WebServer *web_server, void *source);
+  static JsonView sensor_state_json(WebServer *web_server, void *source);
   static std::string sensor_all_json_generator(WebServer *web_server, void *source);
   /// Dump the sensor state with its value as a JSON string.
   std::string sensor_json(sensor::Sensor *obj, float value, JsonDetail start_config);
@@ -264,7 +333,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a switch request under '/switch/<id>/</turn_on/turn_off/toggle>'.
   void handle_switch_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string switch_state_json_generator(WebServer *web_server, void *source);
+  static JsonView switch_state_json(WebServer *web_server, void *source);
   static std::string switch_all_json_generator(WebServer *web_server, void *source);
   /// Dump the switch state with its value as a JSON string.
   std::string switch_json(switch_::Switch *obj, bool value, JsonDetail start_config);
@@ -274,7 +343,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a button request under '/button/<id>/press'.
   void handle_button_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string button_state_json_generator(WebServer *web_server, void *source);
+  static JsonView button_state_json(WebServer *web_server, void *source);
   static std::string button_all_json_generator(WebServer *web_server, void *source);
   /// Dump the button details with its value as a JSON string.
   std::string button_json(button::Button *obj, JsonDetail start_config);
@@ -286,7 +355,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a binary sensor request under '/binary_sensor/<id>'.
   void handle_binary_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string binary_sensor_state_json_generator(WebServer *web_server, void *source);
+  static JsonView binary_sensor_state_json(WebServer *web_server, void *source);
   static std::string binary_sensor_all_json_generator(WebServer *web_server, void *source);
   /// Dump the binary sensor state with its value as a JSON string.
   std::string binary_sensor_json(binary_sensor::BinarySensor *obj, bool value, JsonDetail start_config);
@@ -298,7 +367,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a fan request under '/fan/<id>/</turn_on/turn_off/toggle>'.
   void handle_fan_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string fan_state_json_generator(WebServer *web_server, void *source);
+  static JsonView fan_state_json(WebServer *web_server, void *source);
   static std::string fan_all_json_generator(WebServer *web_server, void *source);
   /// Dump the fan state as a JSON string.
   std::string fan_json(fan::Fan *obj, JsonDetail start_config);
@@ -310,7 +379,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a light request under '/light/<id>/</turn_on/turn_off/toggle>'.
   void handle_light_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string light_state_json_generator(WebServer *web_server, void *source);
+  static JsonView light_state_json(WebServer *web_server, void *source);
   static std::string light_all_json_generator(WebServer *web_server, void *source);
   /// Dump the light state as a JSON string.
   std::string light_json(light::LightState *obj, JsonDetail start_config);
@@ -322,7 +391,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a text sensor request under '/text_sensor/<id>'.
   void handle_text_sensor_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string text_sensor_state_json_generator(WebServer *web_server, void *source);
+  static JsonView text_sensor_state_json(WebServer *web_server, void *source);
   static std::string text_sensor_all_json_generator(WebServer *web_server, void *source);
   /// Dump the text sensor state with its value as a JSON string.
   std::string text_sensor_json(text_sensor::TextSensor *obj, const std::string &value, JsonDetail start_config);
@@ -334,7 +403,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a cover request under '/cover/<id>/<open/close/stop/set>'.
   void handle_cover_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string cover_state_json_generator(WebServer *web_server, void *source);
+  static JsonView cover_state_json(WebServer *web_server, void *source);
   static std::string cover_all_json_generator(WebServer *web_server, void *source);
   /// Dump the cover state as a JSON string.
   std::string cover_json(cover::Cover *obj, JsonDetail start_config);
@@ -345,7 +414,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a number request under '/number/<id>'.
   void handle_number_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string number_state_json_generator(WebServer *web_server, void *source);
+  static JsonView number_state_json(WebServer *web_server, void *source);
   static std::string number_all_json_generator(WebServer *web_server, void *source);
   /// Dump the number state with its value as a JSON string.
   std::string number_json(number::Number *obj, float value, JsonDetail start_config);
@@ -356,7 +425,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a date request under '/date/<id>'.
   void handle_date_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string date_state_json_generator(WebServer *web_server, void *source);
+  static JsonView date_state_json(WebServer *web_server, void *source);
   static std::string date_all_json_generator(WebServer *web_server, void *source);
   /// Dump the date state with its value as a JSON string.
   std::string date_json(datetime::DateEntity *obj, JsonDetail start_config);
@@ -367,7 +436,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a time request under '/time/<id>'.
   void handle_time_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string time_state_json_generator(WebServer *web_server, void *source);
+  static JsonView time_state_json(WebServer *web_server, void *source);
   static std::string time_all_json_generator(WebServer *web_server, void *source);
   /// Dump the time state with its value as a JSON string.
   std::string time_json(datetime::TimeEntity *obj, JsonDetail start_config);
@@ -378,7 +447,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a datetime request under '/datetime/<id>'.
   void handle_datetime_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string datetime_state_json_generator(WebServer *web_server, void *source);
+  static JsonView datetime_state_json(WebServer *web_server, void *source);
   static std::string datetime_all_json_generator(WebServer *web_server, void *source);
   /// Dump the datetime state with its value as a JSON string.
   std::string datetime_json(datetime::DateTimeEntity *obj, JsonDetail start_config);
@@ -389,7 +458,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a text input request under '/text/<id>'.
   void handle_text_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string text_state_json_generator(WebServer *web_server, void *source);
+  static JsonView text_state_json(WebServer *web_server, void *source);
   static std::string text_all_json_generator(WebServer *web_server, void *source);
   /// Dump the text state with its value as a JSON string.
   std::string text_json(text::Text *obj, const std::string &value, JsonDetail start_config);
@@ -400,7 +469,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a select request under '/select/<id>'.
   void handle_select_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string select_state_json_generator(WebServer *web_server, void *source);
+  static JsonView select_state_json(WebServer *web_server, void *source);
   static std::string select_all_json_generator(WebServer *web_server, void *source);
   /// Dump the select state with its value as a JSON string.
   std::string select_json(select::Select *obj, const std::string &value, JsonDetail start_config);
@@ -411,7 +480,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a climate request under '/climate/<id>'.
   void handle_climate_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string climate_state_json_generator(WebServer *web_server, void *source);
+  static JsonView climate_state_json(WebServer *web_server, void *source);
   static std::string climate_all_json_generator(WebServer *web_server, void *source);
   /// Dump the climate details
   std::string climate_json(climate::Climate *obj, JsonDetail start_config);
@@ -423,7 +492,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a lock request under '/lock/<id>/</lock/unlock/open>'.
   void handle_lock_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string lock_state_json_generator(WebServer *web_server, void *source);
+  static JsonView lock_state_json(WebServer *web_server, void *source);
   static std::string lock_all_json_generator(WebServer *web_server, void *source);
   /// Dump the lock state with its value as a JSON string.
   std::string lock_json(lock::Lock *obj, lock::LockState value, JsonDetail start_config);
@@ -435,7 +504,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a valve request under '/valve/<id>/<open/close/stop/set>'.
   void handle_valve_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string valve_state_json_generator(WebServer *web_server, void *source);
+  static JsonView valve_state_json(WebServer *web_server, void *source);
   static std::string valve_all_json_generator(WebServer *web_server, void *source);
   /// Dump the valve state as a JSON string.
   std::string valve_json(valve::Valve *obj, JsonDetail start_config);
@@ -447,7 +516,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a alarm_control_panel request under '/alarm_control_panel/<id>'.
   void handle_alarm_control_panel_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string alarm_control_panel_state_json_generator(WebServer *web_server, void *source);
+  static JsonView alarm_control_panel_state_json(WebServer *web_server, void *source);
   static std::string alarm_control_panel_all_json_generator(WebServer *web_server, void *source);
   /// Dump the alarm_control_panel state with its value as a JSON string.
   std::string alarm_control_panel_json(alarm_control_panel::AlarmControlPanel *obj,
@@ -457,7 +526,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
 #ifdef USE_EVENT
   void on_event(event::Event *obj, const std::string &event_type) override;
 
-  static std::string event_state_json_generator(WebServer *web_server, void *source);
+  static JsonView event_state_json(WebServer *web_server, void *source);
   static std::string event_all_json_generator(WebServer *web_server, void *source);
 
   /// Handle a event request under '/event<id>'.
@@ -473,7 +542,7 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   /// Handle a update request under '/update/<id>'.
   void handle_update_request(AsyncWebServerRequest *request, const UrlMatch &match);
 
-  static std::string update_state_json_generator(WebServer *web_server, void *source);
+  static JsonView update_state_json(WebServer *web_server, void *source);
   static std::string update_all_json_generator(WebServer *web_server, void *source);
   /// Dump the update state with its value as a JSON string.
   std::string update_json(update::UpdateEntity *obj, JsonDetail start_config);
@@ -498,12 +567,101 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
 
  protected:
   void add_sorting_info_(JsonObject &root, EntityBase *entity);
+  /// Send the state of an entity to the clients, after it changed.
+  void send_state_(void *source, message_generator_t *message_generator);
+  /// Id of the ping, log and LCD events. With entity batches the event ids are positions in the entity stream, which a
+  /// reconnecting client resumes from, so these events carry none.
+  static uint32_t event_id_(uint32_t now) {
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+    return 0;
+#else
+    return now;
+#endif
+  }
+  /// Writer for a state event. All state events are generated in the main loop, one at a time, so they share a buffer.
+  JsonWriter state_json_writer_() { return JsonWriter(this->state_json_, sizeof(this->state_json_)); }
+  /// A state that didn't fit the writer, built as a document instead. It is kept until the next one, like the buffer.
+  JsonView spill_state_json_(std::string json) {
+    this->state_json_spill_ = std::move(json);
+    return JsonView{this->state_json_spill_.data(), this->state_json_spill_.size()};
+  }
+  /// The message_generator_t of the event source for one of the *_state_json() views, which copies the view into the
+  /// message. The entity table takes the views as they are.
+  template<JsonView (*view)(WebServer *, void *)>
+  static std::string state_json_generator_(WebServer *web_server, void *source) {
+    JsonView json = view(web_server, source);
+    return std::string(json.data, json.size);
+  }
   web_server_base::WebServerBase *base_;
+#ifdef USE_ESP_IDF
+  /// Log the free heap and its largest block.
+  void log_heap_();
+  /// The smallest largest free heap block seen, a measure of fragmentation.
+  uint32_t heap_largest_min_{UINT32_MAX};
+#endif
+  static constexpr size_t STATE_JSON_SIZE = 512;
+  char state_json_[STATE_JSON_SIZE];
+  std::string state_json_spill_;
 #ifdef USE_ARDUINO
   DeferredUpdateEventSourceList events_;
 #endif
 #ifdef USE_ESP_IDF
-  AsyncEventSource events_{"/events", this};
+  WebServerEventSource events_{"/events", this};
+#endif
+#if defined(USE_LOGGER) && defined(USE_ESP_IDF)
+  static constexpr size_t LOG_RING_BYTES = 8192;
+  static constexpr size_t LOG_RING_LINES = 128;
+
+  /// Send the buffered log lines to the clients, as far as each client keeps up.
+  void log_stream_loop_();
+
+  // Log lines are buffered in the ring by the logger callback (which may run in any task) and sent from loop(),
+  // log_lock_ guards the ring and the cursors.
+  Mutex log_lock_;
+  LogRing log_ring_{LOG_RING_BYTES, LOG_RING_LINES};
+  std::map<AsyncEventSourceResponse *, LogCursor> log_clients_;
+  LogBatch log_batch_;
+#endif
+#ifdef USE_WEBSERVER_LCD_MIRROR
+  struct LcdViewer {
+    LcdMirror mirror;
+    uint32_t since;
+    bool seen;  ///< found among the event source clients, onConnect() is called before the client is added
+  };
+
+  /// Send the LCD changes to the clients that asked for them.
+  void lcd_mirror_loop_();
+
+  // Viewers are added by onConnect() in the httpd task, everything else happens in the main loop. lcd_lock_ guards
+  // the viewers, lcd_viewer_count_ is read without it so that capture_lcd() costs nothing while nobody watches.
+  Mutex lcd_lock_;
+  std::map<AsyncEventSourceResponse *, LcdViewer> lcd_viewers_;
+  std::atomic<uint8_t> lcd_viewer_count_{0};
+  uint32_t lcd_interval_ms_{100};
+  LcdFrame lcd_frame_;
+  bool lcd_captured_{false};
+#endif
+#ifdef USE_WEBSERVER_ENTITY_BATCH
+  /// Batches sent to a client per loop, at most.
+  static constexpr uint8_t ENTITY_BATCHES_PER_LOOP = 4;
+
+  /// Send the entities to the clients in batches: all of them to new clients, then the ones that changed, as far as
+  /// each client keeps up.
+  void entity_dump_loop_();
+
+  struct EntityDump {
+    EntityCursor cursor;
+    uint32_t since;
+    bool seen;  ///< found among the event source clients, onConnect() is called before the client is added
+  };
+
+  // Cursors are set by onConnect() in the httpd task and by the loop for clients it doesn't know yet, entity_lock_
+  // guards them. The table is built at the first client.
+  Mutex entity_lock_;
+  std::map<AsyncEventSourceResponse *, EntityDump> entity_dumps_;
+  EntityTable entity_table_;
+  std::string entity_batch_;
+  uint16_t entity_batch_bytes_{1024};
 #endif
 
 #if USE_WEBSERVER_VERSION == 1
@@ -517,6 +675,12 @@ class WebServer : public Controller, public Component, public AsyncWebHandler {
   const char *js_include_{nullptr};
 #endif
   bool expose_log_{true};
+#ifdef USE_WEBSERVER_REMOTE_KEYPAD
+  RemoteKeypad *remote_keypad_{nullptr};
+#endif
+#ifdef USE_WEBSERVER_UI_PARTITION
+  UIPartition *ui_partition_{nullptr};
+#endif
 };
 
 }  // namespace web_server
@@ -0,0 +1,9 @@
+#!/bin/sh -e
+
+cd "$(dirname "$0")"
+
+for b in ../build/bench_*; do
+    echo "=== $(basename "$b")"
+    "$b"
+    echo
+done
@@ -0,0 +1,82 @@
+// The keypad and the LCD on one I2C bus, with and without the bus scheduler (src-esphome/mycomponents/bus_scheduler),
+// run by the model of the main loop of src-pc/shared_bus_sim.hpp: the LCD redraws a progress bar every 50ms and for
+// every key, while a seeded session taps keys and holds C.
+//
+// Reported per mode at 300 kHz: how long keypad scans waited after they were due (p50, p99, max), the share of the bus
+// time of the keypad and the LCD, the longest LCD transaction, and the frames drawn. The trace of the bus, a line for
+// each transaction (mode, device, start and end in us), goes to the file given.
+//
+// Usage: bench_bus_scheduler [seconds] [trace.csv]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../shared_bus_sim.hpp"
+
+static const uint32_t FREQUENCY = 300000;
+
+static double percentile(std::vector<double> v, double p) {
+  if (v.empty()) {
+    return 0;
+  }
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+static void play(SharedBusSim &sim, uint32_t seconds) {
+  std::mt19937 rng(47);
+  double end = seconds * 1e6;
+  double at = 500000;
+  while (at < end) {
+    char key = rng() % 4 == 0 ? 'C' : KeypadMatrixModel::KEYS[rng() % 16];
+    double hold = key == 'C' ? 2e6 + rng() % 2000000 : 60000 + rng() % 140000;
+    sim.run_until(at);
+    sim.keypad.set(key, true);
+    sim.run_until(at + hold);
+    sim.keypad.set(key, false);
+    at += hold + 200000 + rng() % 800000;
+  }
+  sim.run_until(end);
+}
+
+static void report(const char *mode, const SharedBusSim &sim, FILE *trace) {
+  double busy[2] = {};
+  double longest_lcd = 0;
+  for (const BusTransaction &t : sim.clock.trace) {
+    busy[t.device] += t.end - t.start;
+    if (t.device == BUS_LCD) {
+      longest_lcd = std::max(longest_lcd, t.end - t.start);
+    }
+    if (trace != nullptr) {
+      fprintf(trace, "%s,%s,%.1f,%.1f\n", mode, t.device == BUS_LCD ? "lcd" : "keypad", t.start, t.end);
+    }
+  }
+  printf("%-9s %6.0f %6.0f %6.0f %7.2f %7.2f %8.0f %7u\n", mode, percentile(sim.scan_waits, 0.5),
+         percentile(sim.scan_waits, 0.99), percentile(sim.scan_waits, 1), 100 * busy[BUS_KEYPAD] / sim.clock.now,
+         100 * busy[BUS_LCD] / sim.clock.now, longest_lcd, sim.frames);
+}
+
+int main(int argc, char **argv) {
+  uint32_t seconds = argc > 1 ? atoi(argv[1]) : 120;
+  FILE *trace = argc > 2 ? fopen(argv[2], "w") : nullptr;
+  if (trace != nullptr) {
+    fprintf(trace, "mode,device,start_us,end_us\n");
+  }
+
+  SharedBusSim alone(FREQUENCY, false);
+  play(alone, seconds);
+  SharedBusSim scheduled(FREQUENCY, true);
+  play(scheduled, seconds);
+
+  printf("%u s, %u kHz, scan waits in us\n", seconds, FREQUENCY / 1000);
+  printf("%-9s %6s %6s %6s %7s %7s %8s %7s\n", "mode", "p50", "p99", "max", "keypad%", "lcd%", "lcd max", "frames");
+  report("alone", alone, trace);
+  report("scheduled", scheduled, trace);
+  if (trace != nullptr) {
+    fclose(trace);
+  }
+  return 0;
+}
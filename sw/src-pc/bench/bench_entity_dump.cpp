@@ -0,0 +1,221 @@
+// Initial entity dump of a new /events client: one state_detail_all event per entity and loop, as the entity iterator
+// sends them, against `entities` batches from the EntityTable of the web server (entity_table.h).
+//
+// Time to a populated UI is simulated: the main loop runs every 16ms, the TCP send buffer of the client holds 5744
+// bytes (the esp-idf default) and drains at 100 kB/s. A dump is done when the last entity left the send buffer. The
+// CPU time of writing the dump is measured on the host: the detail of an entity is written with a JsonWriter in both
+// paths, so the per entity path is favoured (ArduinoJson isn't available on the host).
+//
+// Reported per number of entities: events, bytes (SSE framing included), ms to a populated UI, µs to write the dump.
+// Then for a client that reconnects after two entities changed: a full dump against resuming from its Last-Event-ID.
+//
+// Usage: bench_entity_dump [dumps]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../../src-esphome/mycomponents/web_server/entity_table.h"
+#include "../../src-esphome/mycomponents/web_server/json_writer.h"
+
+using esphome::web_server::EntityCursor;
+using esphome::web_server::EntityTable;
+using esphome::web_server::JsonView;
+using esphome::web_server::JsonWriter;
+using esphome::web_server::WebServer;
+
+static constexpr uint32_t LOOP_MS = 16;
+static constexpr size_t SEND_BUFFER = 5744;
+static constexpr double DRAIN_BYTES_PER_MS = 100.0;
+static constexpr size_t BATCH_BYTES = 1024;
+static constexpr int BATCHES_PER_LOOP = 4;
+// the config ping sent when the client connects
+static constexpr size_t CONFIG_BYTES = 160;
+
+struct Sensor {
+  std::string object_id;
+  std::string name;
+  std::string unit;
+  float value;
+};
+
+static char state_buffer[512];
+
+static JsonView sensor_state(WebServer *, void *source) {
+  auto *s = (Sensor *) source;
+  JsonWriter json(state_buffer, sizeof(state_buffer));
+  json.begin_object();
+  json.add("id", "sensor-", s->object_id);
+  json.add("value", s->value);
+  json.add_decimal("state", s->value, 1, s->unit);
+  json.end_object();
+  return json.view();
+}
+
+static std::string sensor_all(WebServer *, void *source) {
+  auto *s = (Sensor *) source;
+  JsonWriter json(state_buffer, sizeof(state_buffer));
+  json.begin_object();
+  json.add("id", "sensor-", s->object_id);
+  json.add("name", s->name);
+  json.add("icon", "mdi:gauge");
+  json.add("entity_category", 0);
+  json.add("value", s->value);
+  json.add_decimal("state", s->value, 1, s->unit);
+  json.add("sorting_weight", 50);
+  json.add("sorting_group", "Prop");
+  json.add("uom", s->unit);
+  json.end_object();
+  return json.str();
+}
+
+// Length of an event as the event source sends it
+static size_t event_bytes(uint32_t id, const char *event, size_t data_len) {
+  char header[64];
+  return snprintf(header, sizeof(header), "id: %u\r\nevent: %s\r\ndata: ", id, event) + data_len + 4;
+}
+
+class Client {
+public:
+  bool send(size_t bytes) {
+    if (queued + bytes > SEND_BUFFER) {
+      return false;
+    }
+    queued += bytes;
+    total += bytes;
+    events++;
+    return true;
+  }
+  void drain(double ms) { queued -= std::min<double>(queued, ms * DRAIN_BYTES_PER_MS); }
+  // ms until the queued bytes have left
+  double drained_in() const { return queued / DRAIN_BYTES_PER_MS; }
+
+  size_t queued = 0;
+  size_t total = 0;
+  size_t events = 0;
+};
+
+struct Result {
+  size_t events;
+  size_t bytes;
+  double ms;
+};
+
+// One entity per loop, the details that can't be sent are queued and sent first in later loops
+static Result per_entity(std::vector<Sensor> &sensors) {
+  Client client;
+  client.send(CONFIG_BYTES);
+  std::vector<size_t> deferred;
+  size_t next = 0;
+  uint32_t now = 0;
+  for (size_t loops = 0;; loops++, now += LOOP_MS) {
+    while (!deferred.empty() &&
+           client.send(event_bytes(now, "state", sensor_all(nullptr, &sensors[deferred.front()]).size()))) {
+      deferred.erase(deferred.begin());
+    }
+    // the iterator spends its first loop on the begin
+    if (loops >= 1 && next < sensors.size()) {
+      std::string detail = sensor_all(nullptr, &sensors[next]);
+      if (!deferred.empty() || !client.send(event_bytes(now, "state", detail.size()))) {
+        deferred.push_back(next);
+      }
+      next++;
+    }
+    if (next == sensors.size() && deferred.empty()) {
+      return Result{client.events - 1, client.total - CONFIG_BYTES, now + client.drained_in()};
+    }
+    client.drain(LOOP_MS);
+  }
+}
+
+// Everything the cursor of a client is due, in batches
+static Result batched(const EntityTable &table, EntityCursor cursor, uint32_t *last_id = nullptr) {
+  Client client;
+  client.send(CONFIG_BYTES);
+  std::string batch;
+  uint32_t now = 0;
+  uint32_t id;
+  for (;; now += LOOP_MS) {
+    bool done = false;
+    for (int i = 0; i < BATCHES_PER_LOOP; i++) {
+      if (!table.next_batch(nullptr, cursor, BATCH_BYTES, batch, id)) {
+        done = true;
+        break;
+      }
+      if (!client.send(event_bytes(now, "entities", batch.size()))) {
+        break;
+      }
+      table.consume(cursor);
+      if (id != 0 && last_id != nullptr) {
+        *last_id = id;
+      }
+    }
+    if (done) {
+      return Result{client.events - 1, client.total - CONFIG_BYTES, now + client.drained_in()};
+    }
+    client.drain(LOOP_MS);
+  }
+}
+
+template<typename F> static double us_per_dump(size_t dumps, F dump) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < dumps; i++) {
+    dump();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() / dumps;
+}
+
+int main(int argc, char **argv) {
+  size_t dumps = argc > 1 ? atoi(argv[1]) : 2000;
+
+  printf("initial dump   per entity event               batches of %zu bytes\n", BATCH_BYTES);
+  printf("entities  events  bytes  ms  us/dump       events  bytes  ms  us/dump\n");
+  std::string reconnects;
+  for (size_t n : {5, 20, 50}) {
+    std::vector<Sensor> sensors;
+    for (size_t i = 0; i < n; i++) {
+      sensors.push_back(Sensor{"prop_sensor_" + std::to_string(i), "Prop sensor " + std::to_string(i), "°C", 20.5f});
+    }
+    EntityTable table;
+    for (Sensor &s : sensors) {
+      table.add(&s, sensor_state, sensor_all, true);
+    }
+    table.start_sequence(0x80000000);
+    table.build(nullptr);
+
+    Result old_dump = per_entity(sensors);
+    uint32_t last_id = 0;
+    Result new_dump = batched(table, table.cursor(0), &last_id);
+    double old_us = us_per_dump(dumps, [&] {
+      for (Sensor &s : sensors) {
+        std::string detail = sensor_all(nullptr, &s);
+      }
+    });
+    std::string batch;
+    double new_us = us_per_dump(dumps, [&] {
+      for (size_t next = 0; next < table.size();) {
+        next = table.write_batch(nullptr, next, BATCH_BYTES, batch);
+      }
+    });
+    printf("%8zu  %6zu %6zu %3.0f %8.1f       %6zu %6zu %3.0f %8.1f\n", n, old_dump.events, old_dump.bytes,
+           old_dump.ms, old_us, new_dump.events, new_dump.bytes, new_dump.ms, new_us);
+
+    // the client drops out while 2 entities change, and reconnects
+    table.changed(&sensors[1]);
+    table.changed(&sensors[n - 1]);
+    Result full = batched(table, table.cursor(0));
+    Result resumed = batched(table, table.cursor(last_id));
+    char line[128];
+    snprintf(line, sizeof(line), "%8zu  %6zu %6zu %3.0f       %6zu %6zu %3.0f\n", n, full.events, full.bytes, full.ms,
+             resumed.events, resumed.bytes, resumed.ms);
+    reconnects += line;
+  }
+  printf("\nreconnect after 2 changes\n");
+  printf("          full dump              Last-Event-ID resume\n");
+  printf("entities  events  bytes  ms       events  bytes  ms\n%s", reconnects.c_str());
+  return 0;
+}
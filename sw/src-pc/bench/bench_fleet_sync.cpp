@@ -0,0 +1,265 @@
+// Fleet simulator: runs N complete game managers with fleet sync over the in-process loopback network, with injected
+// latency, jitter and packet loss, and measures how fast the fleet converges and how much it transmits.
+//
+// Each prop has its own clock (random boot time, offset and drift). The scenario:
+//   0-1s    the props boot
+//   15s     a domination game (1 min delay, 3 min game) is set up and started on the keypad of one prop
+//   80s     red captures the point of the first prop, 82s yellow captures the point of the last one
+//   110s    the leader is switched off
+//   140s    end
+//
+// Reported per run (convergence times are until the condition holds for good):
+//   leader    all props agree on the leader
+//   sync      all props have the shared clock, within SYNC_TOLERANCE of each other
+//   clk_err   worst spread of the shared clocks once synced
+//   game      after the start on one prop, all props know the game
+//   siren     spread of the game start sirens over all props
+//   score     worst spread of the field score (total time held by a team) shown by the props
+//   failover  after the leader is switched off, the others agree on a new one
+//   B/s       bytes sent per prop per second, average and the busiest prop (the leader answers all pings)
+//
+// Usage: bench_fleet_sync [props latency_ms loss_percent]
+// Without arguments a sweep over 2-64 props with 0%, 10% and 30% loss is run.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../../src-common/gm_manager.hpp"
+#include "../fleet_loopback.hpp"
+
+static uint32_t node_now = 0;
+uint32_t esphome::millis() { return node_now; }
+
+static constexpr uint32_t TICK = 10;
+static constexpr uint32_t SAMPLE = 100;
+static constexpr uint32_t BOOT_SPREAD = 1000;
+static constexpr uint32_t T_START = 15000;
+static constexpr uint32_t T_RED = 80000;
+static constexpr uint32_t T_YELLOW = 82000;
+static constexpr uint32_t T_LEADER_OFF = 110000;
+static constexpr uint32_t T_END = 140000;
+static constexpr uint32_t SYNC_TOLERANCE = 10;
+
+struct Node {
+  AntGlobals antg;
+  std::unique_ptr<GameManager> gm;
+  FleetLoopbackNetwork::Endpoint *ep = nullptr;
+  uint32_t id = 0;
+  uint32_t clock_base = 0;
+  int32_t drift_ppm = 0;
+  uint32_t boot_at = 0;
+  uint32_t last_clock = 0;
+  bool on = false;
+  int64_t siren_at = -1;
+
+  uint32_t local(uint32_t sim) const { return clock_base + sim + (int32_t)((int64_t)sim * drift_ppm / 1000000); }
+  const FleetSync &fleet() const { return gm->fleet_sync(); }
+  uint32_t shared(uint32_t sim) const { return fleet().shared_time(local(sim)); }
+
+  void keys(uint32_t sim, const char *keys) {
+    node_now = local(sim);
+    for (const char *k = keys; *k; k++) {
+      gm->handle_key(*k);
+    }
+  }
+};
+
+// Tracks when a condition last failed, the convergence time is the first sample after that
+struct Convergence {
+  uint32_t from;
+  int64_t last_false;
+
+  explicit Convergence(uint32_t from) : from(from), last_false(from) {}
+  void sample(uint32_t sim, bool ok) {
+    if (!ok) {
+      last_false = sim;
+    }
+  }
+  int64_t ms() const { return last_false - from + SAMPLE; }
+};
+
+struct Result {
+  int64_t leader_ms, sync_ms, game_ms, failover_ms;
+  uint32_t clock_err_ms, siren_skew_ms, score_err_ms;
+  double bytes_per_s, bytes_per_s_max;
+  bool complete; // all props joined the game and counted in the field score
+};
+
+static Result simulate(size_t props, uint32_t latency_ms, float loss, uint32_t seed) {
+  std::mt19937 rng(seed);
+  FleetLoopbackNetwork net(seed);
+  net.latency_ms = latency_ms;
+  net.jitter_ms = latency_ms;
+  net.loss = loss;
+
+  std::vector<std::unique_ptr<Node>> nodes;
+  for (size_t i = 0; i < props; i++) {
+    auto n = std::make_unique<Node>();
+    do {
+      n->id = rng();
+    } while (!n->id || std::any_of(nodes.begin(), nodes.end(), [&](auto &o) { return o->id == n->id; }));
+    n->clock_base = rng();
+    n->drift_ppm = (int32_t)(rng() % 101) - 50;
+    n->boot_at = rng() % BOOT_SPREAD;
+    n->ep = &net.add_endpoint();
+    n->ep->set_online(false);
+    nodes.push_back(std::move(n));
+  }
+  auto alive = [&]() {
+    std::vector<Node *> v;
+    for (auto &n : nodes)
+      if (n->on)
+        v.push_back(n.get());
+    return v;
+  };
+  auto lowest_id = [&]() {
+    uint32_t id = UINT32_MAX;
+    for (Node *n : alive())
+      id = std::min(id, n->id);
+    return id;
+  };
+  auto clock_spread = [&](uint32_t sim) {
+    std::vector<Node *> v = alive();
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    for (Node *n : v) {
+      int32_t d = n->shared(sim) - v[0]->shared(sim);
+      lo = std::min(lo, d);
+      hi = std::max(hi, d);
+    }
+    return (uint32_t)(hi - lo);
+  };
+
+  Node &starter = *nodes[props / 2];
+  Node &red = *nodes[0];
+  Node &yellow = *nodes[props - 1];
+  Convergence leader(BOOT_SPREAD), sync(BOOT_SPREAD), game(T_START), failover(T_LEADER_OFF);
+  Result r = {};
+  r.complete = true;
+
+  for (uint32_t sim = 0; sim < T_END; sim += TICK) {
+    net.set_time(sim);
+    for (auto &n : nodes) {
+      if (!n->on && sim >= n->boot_at && sim < T_LEADER_OFF) {
+        node_now = n->local(sim);
+        n->gm = std::make_unique<GameManager>(n->antg);
+        n->gm->attach_fleet(n->ep, n->id);
+        n->ep->set_online(true);
+        n->last_clock = node_now;
+        n->on = true;
+      }
+    }
+
+    // scenario
+    if (sim == T_START) {
+      starter.keys(sim, "BC1B3BC");
+    } else if (sim == T_RED) {
+      red.keys(sim, "r");
+    } else if (sim == T_RED + 6000) {
+      red.keys(sim, "R");
+    } else if (sim == T_YELLOW) {
+      yellow.keys(sim, "y");
+    } else if (sim == T_YELLOW + 6000) {
+      yellow.keys(sim, "Y");
+    } else if (sim == T_LEADER_OFF) {
+      for (auto &n : nodes) {
+        if (n->on && n->fleet().is_leader()) {
+          n->on = false;
+          n->ep->set_online(false);
+        }
+      }
+    }
+
+    for (auto &n : nodes) {
+      if (!n->on) {
+        continue;
+      }
+      node_now = n->local(sim);
+      n->antg.siren_params.duration = 0;
+      n->gm->clock(node_now, node_now - n->last_clock);
+      n->last_clock = node_now;
+      if (n->antg.siren_params.duration == SIREN_DURATION_GAME_START && n->siren_at < 0) {
+        n->siren_at = sim;
+      }
+    }
+
+    if (sim % SAMPLE || sim < BOOT_SPREAD) {
+      continue;
+    }
+    std::vector<Node *> v = alive();
+    uint32_t lowest = lowest_id();
+    bool agree = std::all_of(v.begin(), v.end(), [&](Node *n) { return n->fleet().leader() == lowest; });
+    bool synced = std::all_of(v.begin(), v.end(), [&](Node *n) { return n->fleet().synced(); }) &&
+                  clock_spread(sim) <= SYNC_TOLERANCE;
+    if (sim < T_START) {
+      leader.sample(sim, agree);
+      sync.sample(sim, synced);
+    } else if (sim < T_LEADER_OFF) {
+      game.sample(sim, std::all_of(v.begin(), v.end(), [&](Node *n) {
+        return n->fleet().current_game() == starter.fleet().current_game();
+      }));
+    } else {
+      failover.sample(sim, agree);
+    }
+    if (sim > T_START) {
+      r.clock_err_ms = std::max(r.clock_err_ms, clock_spread(sim));
+    }
+    if (sim >= T_RED && sim < T_LEADER_OFF) {
+      uint32_t red_lo = UINT32_MAX, red_hi = 0, yellow_lo = UINT32_MAX, yellow_hi = 0;
+      for (Node *n : v) {
+        FleetScore s = n->fleet().field_score(n->local(sim));
+        r.complete &= s.props == props;
+        red_lo = std::min(red_lo, s.red_ms);
+        red_hi = std::max(red_hi, s.red_ms);
+        yellow_lo = std::min(yellow_lo, s.yellow_ms);
+        yellow_hi = std::max(yellow_hi, s.yellow_ms);
+      }
+      r.score_err_ms = std::max({r.score_err_ms, red_hi - red_lo, yellow_hi - yellow_lo});
+    }
+  }
+
+  r.leader_ms = leader.ms();
+  r.sync_ms = sync.ms();
+  r.game_ms = game.ms();
+  r.failover_ms = failover.ms();
+  int64_t siren_lo = INT64_MAX, siren_hi = INT64_MIN;
+  uint32_t bytes_max = 0;
+  uint64_t bytes = 0;
+  for (auto &n : nodes) {
+    r.complete &= n->siren_at >= 0;
+    siren_lo = std::min(siren_lo, n->siren_at);
+    siren_hi = std::max(siren_hi, n->siren_at);
+    bytes += n->fleet().statistics().bytes_sent;
+    bytes_max = std::max(bytes_max, n->fleet().statistics().bytes_sent);
+  }
+  r.siren_skew_ms = siren_hi - siren_lo;
+  r.bytes_per_s = bytes / (double)props / (T_END / 1000.0);
+  r.bytes_per_s_max = bytes_max / (T_END / 1000.0);
+  return r;
+}
+
+static void run(size_t props, uint32_t latency_ms, float loss) {
+  Result r = simulate(props, latency_ms, loss, 1000 + props);
+  printf("%5zu %5u %4.0f%% %7lld %7lld %7u %7lld %7u %7u %8lld %7.1f %7.1f%s\n", props, latency_ms, loss * 100,
+         (long long)r.leader_ms, (long long)r.sync_ms, r.clock_err_ms, (long long)r.game_ms, r.siren_skew_ms,
+         r.score_err_ms, (long long)r.failover_ms, r.bytes_per_s, r.bytes_per_s_max, r.complete ? "" : "  INCOMPLETE");
+}
+
+int main(int argc, char **argv) {
+  mock_log_enabled = false;
+  printf("                        convergence / spread in ms                               B/s per prop\n");
+  printf("props   lat  loss  leader    sync clk_err    game   siren   score failover     avg     max\n");
+  if (argc == 4) {
+    run(atoi(argv[1]), atoi(argv[2]), atof(argv[3]) / 100);
+    return 0;
+  }
+  for (float loss : {0.0f, 0.1f, 0.3f}) {
+    for (size_t props : {2, 4, 8, 16, 32, 64}) {
+      run(props, 5, loss);
+    }
+  }
+  return 0;
+}
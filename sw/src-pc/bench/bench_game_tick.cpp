@@ -0,0 +1,139 @@
+// Cost of the game loop: the ticks of config.yaml (GameManager::clock() every 50ms and a display update) and the key
+// presses of a game of each mode, timed on the host.
+//
+// Built twice, as bench_game_tick and as bench_game_tick_profiled with the profiler of src-common/profiler.hpp
+// compiled in; the difference of the two is the overhead of the profiler. The profiled one also prints the profile of
+// all rounds.
+//
+// Reported per game mode: the simulated game length, the game loop calls (ticks, key presses and display updates) and
+// the mean CPU time per tick, key press and display update.
+//
+// Usage: bench_game_tick [rounds]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#include "../../src-common/gm_manager.hpp"
+
+static uint32_t now = 1;
+uint32_t esphome::millis() { return now; }
+
+static constexpr uint32_t TICK = 50;
+
+struct Scenario {
+  const char *mode;
+  const char *sequence; // as in src-pc/tests
+};
+
+static const Scenario SCENARIOS[] = {
+    {"menu", "B,DELAY=1000,B,DELAY=1000,B,DELAY=1000,A,DELAY=1000,A,DELAY=1000,A,DELAY=5000"},
+    {"defusal_code", "C,C,B,1,B,7,B,C,7,#,DELAY=30000,7,#,DELAY=100000"},
+    {"domination", "C,B,C,B,1,B,C,DELAY=10000,RED,DELAY=4999,DELAY=1,RED_RELEASE,YELLOW,DELAY=4999,YELLOW_RELEASE,"
+                   "DELAY=1,RED,DELAY=10000,RED_RELEASE,YELLOW,DELAY=1000,DELAY=4000,YELLOW_RELEASE,DELAY=24999,"
+                   "DELAY=1,RESET"},
+    {"zone_control", "C,B,B,C,C,DELAY=10000,RED,DELAY=5000,DELAY=1000,DELAY=60000,RED,DELAY=6000,RED_RELEASE,YELLOW,"
+                     "YELLOW_RELEASE,DELAY=1,RED,DELAY=6000,RED_RELEASE,YELLOW,DELAY=5000,DELAY=60000,RESET"},
+    {"countdown", "C,B,B,B,C,0,B,1,2,3,1,B,C,DELAY=59000,DELAY=1000,DELAY=60000"},
+    {"respawn_timer", "C,A,A,C,1,B,5,B,C,B,C,DELAY=59000,DELAY=1000,DELAY=4000,DELAY=1000,DELAY=60000,DELAY=5000"},
+};
+
+class Run {
+public:
+  // Plays the game, returns the simulated ms
+  uint32_t play(const Scenario &scenario) {
+    uint32_t start = now;
+    std::stringstream ss(scenario.sequence);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+      if (token.rfind("DELAY=", 0) == 0) {
+        advance(std::stoi(token.substr(6)));
+      } else {
+        key(token);
+      }
+    }
+    advance(1000);
+    return now - start;
+  }
+
+  size_t calls = 0;
+
+private:
+  void render() {
+    ANT_PROFILE_SCOPE(ProfileSite::DISPLAY_WRITE);
+    game_manager.display_update(display);
+    calls++;
+  }
+
+  void advance(uint32_t ms) {
+    while (ms > 0) {
+      uint32_t step = std::min(ms, TICK - now % TICK);
+      now += step;
+      ms -= step;
+      game_manager.clock(now, step);
+      calls++;
+      if (now % TICK == 0) {
+        render();
+      }
+    }
+  }
+
+  void key(const std::string &token) {
+    if (token.length() == 1) {
+      game_manager.handle_key(token[0]);
+    } else if (token == "RED") {
+      game_manager.handle_key(KEY_RED);
+    } else if (token == "RED_RELEASE") {
+      game_manager.handle_key(KEY_RED_RELEASE);
+    } else if (token == "YELLOW") {
+      game_manager.handle_key(KEY_YELLOW);
+    } else if (token == "YELLOW_RELEASE") {
+      game_manager.handle_key(KEY_YELLOW_RELEASE);
+    } else if (token == "RESET") {
+      game_manager.handle_key(KEY_RESET);
+    }
+    calls++;
+    render(); // like the on_key automation
+  }
+
+  AntGlobals antg;
+  GameManager game_manager{antg};
+  esphome::lcd_base::LCDDisplay display;
+};
+
+int main(int argc, char **argv) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 20;
+  mock_log_enabled = false;
+#ifdef ANT_PROFILE
+  printf("profiler compiled in\n");
+#else
+  printf("profiler compiled out\n");
+#endif
+  printf("%-16s %7s %9s %12s\n", "mode", "game s", "calls", "ns per call");
+  for (const Scenario &scenario : SCENARIOS) {
+    // the first round warms up
+    double total_ns = 0;
+    size_t calls = 0;
+    uint32_t ms = 0;
+    for (int round = 0; round <= rounds; round++) {
+      now = 1;
+      Run run;
+      auto start = std::chrono::steady_clock::now();
+      ms = run.play(scenario);
+      auto end = std::chrono::steady_clock::now();
+      if (round > 0) {
+        total_ns += std::chrono::duration<double, std::nano>(end - start).count();
+        calls += run.calls;
+      }
+    }
+    printf("%-16s %7.0f %9zu %12.1f\n", scenario.mode, ms / 1000.0, calls / rounds, total_ns / calls);
+  }
+#ifdef ANT_PROFILE
+  char text[Profiler::MAX_TEXT];
+  profiler.format(text, sizeof(text));
+  printf("\nprofile of all rounds:\n%s", text);
+#endif
+  return 0;
+}
@@ -0,0 +1,197 @@
+// Keypad scanning on the I2C bus: esphome's matrix_keypad on its pcf8574 pins against the scanner of pcf8574_keypad
+// (src-esphome/mycomponents/pcf8574_keypad), both played against the model of the matrix (src-pc/keypad_sim.hpp).
+//
+// A seeded session of taps on random keys and long holds of C, every contact bouncing for up to 2ms when it closes and
+// when it opens, with pauses of 0.3 to 3s between them, and then a minute without keys. The main loop comes every
+// 16ms, like esphome's, and every 0.2ms while pcf8574_keypad asks for it to scan fast. The stock scanner has its
+// default debounce time of 1ms, which takes the same key in two loops in a row.
+//
+// Reported per scanner at 300 kHz: the latency from the first contact to the key reported, for presses and releases,
+// missed and extra presses and releases, the share of the bus time the scans take over the whole session and over the
+// idle minute, and the I2C transactions a second.
+//
+// Usage: bench_keypad_scan [minutes]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../keypad_sim.hpp"
+
+using namespace esphome::pcf8574_keypad;
+
+static const uint32_t FREQUENCY = 300000;
+static const uint32_t MAIN_LOOP = 16000;
+static const uint32_t FAST_LOOP = 200;
+
+// A change of a contact, and the edges of the keys a scanner reports
+struct Contact {
+  uint32_t at;
+  uint8_t key;
+  bool closed;
+};
+
+struct Press {
+  uint32_t at;
+  uint8_t key;
+  bool down;
+};
+
+static void bounce(std::mt19937 &rng, std::vector<Contact> &contacts, uint32_t at, uint8_t key, bool closed) {
+  int bounces = rng() % 4;
+  for (int i = 0; i < bounces; i++) {
+    contacts.push_back(Contact{at, key, closed});
+    at += 100 + rng() % 400;
+    contacts.push_back(Contact{at, key, !closed});
+    at += 100 + rng() % 400;
+  }
+  contacts.push_back(Contact{at, key, closed});
+}
+
+// The session, and the presses and releases it should report: at the first contact
+static uint32_t session(uint32_t minutes, std::vector<Contact> &contacts, std::vector<Press> &presses) {
+  std::mt19937 rng(46);
+  uint32_t end = minutes * 60000000;
+  uint8_t c = strchr(KeypadMatrixModel::KEYS, 'C') - KeypadMatrixModel::KEYS;
+  uint32_t at = 1000000;
+  while (at < end) {
+    bool hold_c = rng() % 5 == 0;
+    uint8_t key = hold_c ? c : rng() % 16;
+    uint32_t hold = hold_c ? 3000000 + rng() % 2000000 : 60000 + rng() % 140000;
+    presses.push_back(Press{at, key, true});
+    bounce(rng, contacts, at, key, true);
+    at += hold;
+    presses.push_back(Press{at, key, false});
+    bounce(rng, contacts, at, key, false);
+    at += 300000 + rng() % 2700000;
+  }
+  return at + 60000000;
+}
+
+struct Result {
+  std::vector<Press> reported;
+  double busy_us = 0;
+  double idle_busy_us = 0;
+  uint32_t transactions = 0;
+};
+
+// Plays the contacts to the model and calls scan(now, reported) in each pass of the main loop, which returns whether
+// the next pass comes fast
+template <typename Scan>
+static Result play(const std::vector<Contact> &contacts, uint32_t end, KeypadMatrixModel &bus, Scan scan) {
+  Result result;
+  size_t next = 0;
+  uint32_t idle_from = end - 60000000;
+  double busy_at_idle = 0;
+  for (uint32_t now = 0; now < end;) {
+    for (; next < contacts.size() && contacts[next].at <= now; next++) {
+      bus.set(KeypadMatrixModel::KEYS[contacts[next].key], contacts[next].closed);
+    }
+    bool fast = scan(now, result.reported);
+    uint32_t step = fast ? FAST_LOOP : MAIN_LOOP;
+    if (now < idle_from && now + step >= idle_from) {
+      busy_at_idle = bus.busy_us;
+    }
+    now += step;
+  }
+  result.busy_us = bus.busy_us;
+  result.idle_busy_us = bus.busy_us - busy_at_idle;
+  result.transactions = bus.transactions;
+  return result;
+}
+
+static uint32_t percentile(std::vector<uint32_t> v, double p) {
+  if (v.empty()) {
+    return 0;
+  }
+  std::sort(v.begin(), v.end());
+  return v[std::min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+static void report(const char *name, const std::vector<Press> &presses, const Result &r, uint32_t end) {
+  // each press or release matches the reports of its key and direction until the next one of the session
+  std::vector<uint32_t> latency[2];
+  int missed = 0;
+  size_t matched = 0;
+  for (size_t i = 0; i < presses.size(); i++) {
+    uint32_t until = i + 1 < presses.size() ? presses[i + 1].at : end;
+    int n = 0;
+    for (const Press &p : r.reported) {
+      if (p.key == presses[i].key && p.down == presses[i].down && p.at >= presses[i].at && p.at < until) {
+        if (n++ == 0) {
+          latency[p.down].push_back(p.at - presses[i].at);
+        }
+      }
+    }
+    missed += n == 0;
+    matched += n > 0;
+  }
+  size_t extra = r.reported.size() - matched;
+  double seconds = end / 1e6;
+  for (int down = 1; down >= 0; down--) {
+    printf("%-8s %-7s %6.1f %6.1f %6.1f", name, down ? "press" : "release", percentile(latency[down], 0.5) / 1000.0,
+           percentile(latency[down], 0.99) / 1000.0, percentile(latency[down], 1) / 1000.0);
+    if (down) {
+      printf(" %6d %6zu %6.2f %6.2f %8.0f\n", missed, extra, 100 * r.busy_us / end, 100 * r.idle_busy_us / 60e6,
+             r.transactions / seconds);
+    } else {
+      printf("\n");
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  uint32_t minutes = argc > 1 ? atoi(argv[1]) : 10;
+  std::vector<Contact> contacts;
+  std::vector<Press> presses;
+  uint32_t end = session(minutes, contacts, presses);
+
+  // matrix_keypad: a key must be the same in two loops, more than one key is an error
+  int active = -1;
+  int pressed = -1;
+  uint32_t active_start = 0;
+  KeypadMatrixModel stock_bus(FREQUENCY);
+  stock_bus.out = KeypadScanner::ROWS_LOW | 0x0F;
+  Result stock = play(contacts, end, stock_bus, [&](uint32_t now, std::vector<Press> &reported) {
+    int key = stock_matrix_keypad_scan(stock_bus);
+    if (key == -2) {
+      return false;
+    }
+    if (key != active) {
+      active = key;
+      active_start = now;
+      return false;
+    }
+    if (pressed == key || now - active_start < 1000) {
+      return false;
+    }
+    if (pressed >= 0) {
+      reported.push_back(Press{now, (uint8_t)pressed, false});
+    }
+    if (key >= 0) {
+      reported.push_back(Press{now, (uint8_t)key, true});
+    }
+    pressed = key;
+    return false;
+  });
+
+  KeypadMatrixModel bus(FREQUENCY);
+  KeypadScanner scanner(&bus);
+  Result adaptive = play(contacts, end, bus, [&](uint32_t now, std::vector<Press> &reported) {
+    KeyEdge edges[KeypadScanner::KEYS];
+    size_t n = scanner.poll(now, edges);
+    for (size_t i = 0; i < n; i++) {
+      reported.push_back(Press{edges[i].at, edges[i].key, edges[i].down});
+    }
+    return scanner.fast();
+  });
+
+  printf("%zu presses in %.0f s, %u kHz, latency in ms\n", presses.size() / 2, end / 1e6, FREQUENCY / 1000);
+  printf("%-8s %-7s %6s %6s %6s %6s %6s %6s %6s %8s\n", "scanner", "edge", "p50", "p99", "max", "missed", "extra",
+         "bus%", "idle%", "trans/s");
+  report("stock", presses, stock, end);
+  report("adaptive", presses, adaptive, end);
+  return 0;
+}
@@ -0,0 +1,59 @@
+// Bus time of an LCD frame: the writes of esphome's lcd_pcf8574 against the burst of lcd_burst
+// (src-esphome/mycomponents/lcd_burst), played through the byte level model of the bus, the PCF8574 and the HD44780
+// (src-pc/lcd_bus_sim.hpp).
+//
+// Reported per driver and bus frequency, for a full 16x2 frame of 32 characters: I2C transactions, bytes on the bus
+// (with the address bytes), the time from the first start to the last stop (bus and driver delays, without the
+// CPU time of the I2C driver, which the stock driver pays 204 times a frame), and nibbles a real LCD would lose. The
+// CPU time of encode_frame() is timed on the host.
+//
+// Usage: bench_lcd_burst [frames]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "../lcd_bus_sim.hpp"
+
+using namespace esphome::lcd_burst;
+
+static volatile uint32_t sink; // keeps the work from being optimized away
+
+static void report(const char *name, uint32_t frequency, const LcdBusModel &bus, int frames) {
+  printf("%-8s %5u %6.1f %7.1f %10.1f %8.1f %6u\n", name, frequency / 1000, bus.transactions / (double)frames,
+         bus.bytes / (double)frames, bus.now / frames, bus.now / frames / 32, bus.busy_nibbles);
+}
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 100;
+  uint8_t chars[32];
+  memcpy(chars, "TIME LEFT: 01:23", 16);
+  memcpy(chars + 16, "\x05\x05\x05\x05\x03      T1:4 \xff", 16);
+
+  printf("%-8s %5s %6s %7s %10s %8s %6s\n", "driver", "kHz", "writes", "bytes", "us/frame", "us/char", "lost");
+  for (uint32_t frequency : {100000u, 300000u, 400000u}) {
+    LcdBusModel stock(frequency);
+    LcdBusModel burst(frequency);
+    for (int i = 0; i < frames; i++) {
+      chars[15] = '0' + i % 10;
+      stock_pcf8574_frame(stock, chars, 16, 2);
+      uint8_t buf[MAX_FRAME_BYTES];
+      burst.write(buf, encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, buf, sizeof(buf)));
+    }
+    report("stock", frequency, stock, frames);
+    report("burst", frequency, burst, frames);
+  }
+
+  int calls = frames * 10000;
+  uint8_t buf[MAX_FRAME_BYTES];
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < calls; i++) {
+    chars[15] = (uint8_t)i;
+    sink = sink + encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, buf, sizeof(buf));
+  }
+  auto end = std::chrono::steady_clock::now();
+  printf("\nencode_frame: %.1f ns a frame on the host\n",
+         std::chrono::duration<double, std::nano>(end - start).count() / calls);
+  return 0;
+}
@@ -0,0 +1,162 @@
+// LCD mirror bandwidth: plays a game of each mode (the key sequences of the LCD snapshot tests, with the display
+// rendered every 50ms like the interval in config.yaml and after every key) and streams the display to one viewer as
+// the web server does, for several FPS limits.
+//
+// Reported per game mode:
+//   s         game length, simulated
+//   frames/s  rendered frames per second that differ from the previous one
+//   full B/s  the whole display as an event on every change, for comparison
+//   then per FPS limit: events per second and bytes per second of `lcd` events (id, event and data lines as sent by
+//   the event source, without the HTTP chunk framing)
+//
+// Usage: bench_lcd_mirror
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include "../../src-common/gm_manager.hpp"
+#include "../../src-common/lcd_mirror.hpp"
+#include "../lcd_capture.hpp"
+
+static uint32_t now = 1;
+uint32_t esphome::millis() { return now; }
+
+static constexpr uint32_t RENDER_INTERVAL = 50;
+static constexpr uint32_t FPS_LIMITS[] = {5, 10, 20};
+static constexpr size_t N_LIMITS = sizeof(FPS_LIMITS) / sizeof(FPS_LIMITS[0]);
+
+struct Scenario {
+  const char *mode;
+  const char *sequence; // as in src-pc/tests
+};
+
+static const Scenario SCENARIOS[] = {
+    {"menu", "B,DELAY=1000,B,DELAY=1000,B,DELAY=1000,A,DELAY=1000,A,DELAY=1000,A,DELAY=5000"},
+    {"defusal_code", "C,C,B,1,B,7,B,C,7,#,DELAY=30000,7,#,DELAY=100000"},
+    {"defusal_buttons", "C,C,B,1,B,B,C,RED,DELAY=4000,DELAY=1000,RED_RELEASE,YELLOW,DELAY=4000,YELLOW_RELEASE,RED,"
+                        "DELAY=9000,DELAY=1000,DELAY=10000,RED_RELEASE,DELAY=60000,C,D"},
+    {"domination", "C,B,C,B,1,B,C,DELAY=10000,RED,DELAY=4999,DELAY=1,RED_RELEASE,YELLOW,DELAY=4999,YELLOW_RELEASE,"
+                   "DELAY=1,RED,DELAY=10000,RED_RELEASE,YELLOW,DELAY=1000,DELAY=4000,YELLOW_RELEASE,DELAY=24999,"
+                   "DELAY=1,RESET"},
+    {"zone_control", "C,B,B,C,C,DELAY=10000,RED,DELAY=5000,DELAY=1000,DELAY=60000,RED,DELAY=6000,RED_RELEASE,YELLOW,"
+                     "YELLOW_RELEASE,DELAY=1,RED,DELAY=6000,RED_RELEASE,YELLOW,DELAY=5000,DELAY=60000,RESET"},
+    {"countdown", "C,B,B,B,C,0,B,1,2,3,1,B,C,DELAY=59000,DELAY=1000,DELAY=60000"},
+    {"respawn_timer", "C,A,A,C,1,B,5,B,C,B,C,DELAY=59000,DELAY=1000,DELAY=4000,DELAY=1000,DELAY=60000,DELAY=5000"},
+};
+
+// Length of an `lcd` event as the event source sends it
+static size_t event_bytes(uint32_t id, size_t text_len) {
+  char header[48];
+  return snprintf(header, sizeof(header), "id: %u\r\nevent: lcd\r\ndata: ", id) + text_len + 4;
+}
+
+class Run {
+public:
+  void render() {
+    game_manager.display_update(display);
+    LcdFrame frame = lcd_capture(display);
+    display.present();
+
+    char text[LcdMirror::MAX_TEXT];
+    if (!rendered || frame != last) {
+      frames++;
+      full_bytes += event_bytes(now, 2 + LCD_CELLS);
+    }
+    last = frame;
+    rendered = true;
+    for (size_t i = 0; i < N_LIMITS; i++) {
+      size_t len = mirrors[i].update(frame, now, text);
+      if (len != 0) {
+        mirrors[i].acknowledge();
+        events[i]++;
+        bytes[i] += event_bytes(now, len);
+      }
+    }
+  }
+
+  void advance(uint32_t ms) {
+    while (ms > 0) {
+      uint32_t step = std::min(ms, RENDER_INTERVAL - now % RENDER_INTERVAL);
+      now += step;
+      ms -= step;
+      game_manager.clock(now, step);
+      if (now % RENDER_INTERVAL == 0) {
+        render();
+      }
+    }
+  }
+
+  void key(const std::string &token) {
+    if (token.length() == 1) {
+      game_manager.handle_key(token[0]);
+    } else if (token == "RED") {
+      game_manager.handle_key(KEY_RED);
+    } else if (token == "RED_RELEASE") {
+      game_manager.handle_key(KEY_RED_RELEASE);
+    } else if (token == "YELLOW") {
+      game_manager.handle_key(KEY_YELLOW);
+    } else if (token == "YELLOW_RELEASE") {
+      game_manager.handle_key(KEY_YELLOW_RELEASE);
+    } else if (token == "RESET") {
+      game_manager.handle_key(KEY_RESET);
+    }
+    render(); // like the on_key automation
+  }
+
+  void play(const Scenario &scenario) {
+    render();
+    uint32_t start = now;
+    std::stringstream ss(scenario.sequence);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+      if (token.rfind("DELAY=", 0) == 0) {
+        advance(std::stoi(token.substr(6)));
+      } else {
+        key(token);
+      }
+    }
+    advance(1000);
+
+    double s = (now - start) / 1000.0;
+    printf("%-16s %5.0f %8.1f %8.0f", scenario.mode, s, frames / s, full_bytes / s);
+    for (size_t i = 0; i < N_LIMITS; i++) {
+      printf(" %7.1f %7.0f", events[i] / s, bytes[i] / s);
+    }
+    printf("\n");
+  }
+
+private:
+  AntGlobals antg;
+  GameManager game_manager{antg};
+  esphome::lcd_base::LCDDisplay display;
+  LcdMirror mirrors[N_LIMITS] = {LcdMirror(1000 / FPS_LIMITS[0]), LcdMirror(1000 / FPS_LIMITS[1]),
+                                 LcdMirror(1000 / FPS_LIMITS[2])};
+  LcdFrame last;
+  bool rendered = false;
+  size_t frames = 0;
+  size_t full_bytes = 0;
+  size_t events[N_LIMITS] = {};
+  size_t bytes[N_LIMITS] = {};
+};
+
+int main() {
+  mock_log_enabled = false;
+  std::cout.setstate(std::ios::failbit); // the mock LCD prints every frame
+  printf("%-16s %5s %8s %8s", "", "", "", "");
+  for (uint32_t fps : FPS_LIMITS) {
+    printf("      max %2u fps", fps);
+  }
+  printf("\n%-16s %5s %8s %8s", "mode", "s", "frames/s", "full B/s");
+  for (size_t i = 0; i < N_LIMITS; i++) {
+    printf(" %7s %7s", "ev/s", "B/s");
+  }
+  printf("\n");
+  for (const Scenario &scenario : SCENARIOS) {
+    now = 1;
+    Run().play(scenario);
+  }
+  return 0;
+}
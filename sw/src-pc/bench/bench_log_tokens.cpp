@@ -0,0 +1,62 @@
+// Cost of a log call of the game: formatting the line as the esphome logger does, against writing the record of the
+// tokenized log (src-common/log_tokens.hpp), timed on the host.
+//
+// Reported per log call: the bytes of the text line (with the "[I][tag]: " header the logger adds, without colors)
+// against the bytes of the record in the ring and base64 encoded on the serial line, and the mean CPU time of
+// snprintf() against LogTokens::write(). The format strings the firmware no longer holds are counted by `ant_log dict`.
+//
+// Usage: bench_log_tokens [calls]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../../src-common/log_tokens.hpp"
+
+static volatile uint32_t sink; // keeps the work from being optimized away
+
+template <typename Fn> static double ns_per_call(int calls, Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < calls; i++) {
+    fn(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / calls;
+}
+
+template <typename... Args>
+static void bench(const char *name, int calls, const char *tag, const char *format, Args... args) {
+  char line[256];
+  uint32_t token = log_token('I', tag, format);
+  int header = snprintf(line, sizeof(line), "[I][%s]: ", tag);
+  int text = header + snprintf(line + header, sizeof(line) - header, format, args...);
+
+  LogTokens log;
+  log.write(token, 123456, args...);
+  uint8_t records[LogTokens::MAX_RECORD + 1];
+  size_t record = log.read(records, sizeof(records));
+
+  double text_ns = ns_per_call(calls, [&](int i) {
+    int n = snprintf(line, sizeof(line), "[I][%s]: ", tag);
+    sink = sink + snprintf(line + n, sizeof(line) - n, format, args...);
+  });
+  double record_ns = ns_per_call(calls, [&](int i) {
+    log.write(token, (uint32_t)i, args...);
+    if ((i & 15) == 15) {
+      sink = sink + log.read(records, sizeof(records)); // like the interval, between the calls
+    }
+  });
+  printf("%-14s %6d %7zu %7zu %10.1f %10.1f\n", name, text, record, 4 * ((record + 2) / 3), text_ns, record_ns);
+}
+
+int main(int argc, char **argv) {
+  int calls = argc > 1 ? atoi(argv[1]) : 1000000;
+  printf("%-14s %6s %7s %7s %10s %10s\n", "call", "text B", "record", "base64", "text ns", "record ns");
+  bench("state", calls, "GM_defusal_code", "ARM -> ARMED");
+  bench("key", calls, "Key", "on_key %c", '7');
+  bench("buzzer", calls, "GameManager", "Buzzer for %dms at %dHz", 100, 2000);
+  bench("siren", calls, "GameManager", "Siren for %dms at %dHz level %f with %dms delay", 5000, 3000, 0.8f, 0);
+  bench("remote_setup", calls, "GameManager", "Remote setup: %s%s", "domination", " (start)");
+  bench("fleet_game", calls, "GameManager", "Fleet game from %08x, starts in %dms", 0x3c61057au, 2500);
+  return 0;
+}
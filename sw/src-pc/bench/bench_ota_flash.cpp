@@ -0,0 +1,172 @@
+// OTA upload throughput of the web server against a model of the flash: a firmware image streamed through
+// OTARequestHandler::handleUpload() of the host build of the web_server component (see src-pc/mock_web/web_host.hpp),
+// in the chunks the multipart parser of the httpd task hands out.
+//
+// The OTA backend stand-in takes the time of the flash for each esp_ota_write(): the erase of every 4 KiB sector
+// before its first write and the program time of each 256 byte page, with the typical datasheet figures of the 4 MB
+// SPI NOR flash of ESP32-C3 modules. The time passes without waiting (host_advance_time()), so the progress reports of
+// the handler come at the rate they would on the device. The main loop runs between chunks, it runs the state
+// callbacks the handler defers with call_deferred().
+//
+// Chunk patterns: fixed sizes of a TCP segment (536 and 1440 bytes, the minimum and the lwIP MSS), random sizes up to
+// a segment as a receive of whatever arrived, and 4 KiB and 8 KiB, a receive buffer that filled while the flash was
+// busy.
+//
+// Reported per pattern: KB/s with the flash, MB/s without it (CPU only), backend write calls, sector erases, progress
+// callbacks, and the peak of the heap above the start of the upload.
+//
+// Usage: bench_ota_flash [firmware.ota.bin] [segment bytes ...]
+// Without an image the one of `make fw` is used if it exists, else a 1.5 MB pseudo random image.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../mock_web/web_host.hpp"
+
+using esphome::ota::FlashModel;
+using web_host::WebHost;
+
+static size_t heap_live = 0;
+static size_t heap_peak = 0;
+
+// The size of each block is kept in front of it, for the live total
+void *operator new(size_t size) {
+  auto *block = static_cast<size_t *>(malloc(sizeof(max_align_t) + size));
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *block = size;
+  heap_live += size;
+  heap_peak = std::max(heap_peak, heap_live);
+  return reinterpret_cast<uint8_t *>(block) + sizeof(max_align_t);
+}
+void operator delete(void *p) noexcept {
+  if (p == nullptr)
+    return;
+  auto *block = reinterpret_cast<size_t *>(static_cast<uint8_t *>(p) - sizeof(max_align_t));
+  heap_live -= *block;
+  free(block);
+}
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
+static const char *const FW_IMAGE = "../../src-esphome/.esphome/build/ant/.pioenvs/ant/firmware.ota.bin";
+
+static bool load(const char *path, std::vector<uint8_t> &image) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+  image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return !image.empty();
+}
+
+static std::vector<size_t> chunk_pattern(size_t total, size_t segment, bool random) {
+  std::mt19937 rng(42);
+  std::vector<size_t> chunks;
+  for (size_t pos = 0; pos < total;) {
+    size_t len = std::min(random ? 1 + rng() % segment : segment, total - pos);
+    chunks.push_back(len);
+    pos += len;
+  }
+  return chunks;
+}
+
+static void run(const std::vector<uint8_t> &image, size_t segment, bool random) {
+  std::vector<size_t> chunks = chunk_pattern(image.size(), segment, random);
+  double mb = image.size() / 1e6;
+  double flash_kb_s = 0;
+  double cpu_mb_s = 0;
+  uint32_t writes = 0;
+  uint32_t erases = 0;
+  uint32_t progress = 0;
+  size_t peak = 0;
+  bool ok = true;
+
+  for (bool flash : {true, false}) {
+    WebHost host;
+    FlashModel model;
+    if (flash) {
+      model.sector_erase_us = 45000;
+      model.page_program_us = 700;
+      model.write_call_us = 30;
+    }
+    esphome::ota::set_flash_model(model);
+    esphome::ota::reset_flash_stats();
+    uint32_t reports = 0;
+    host.ota.add_on_state_callback([&reports](esphome::ota::OTAState state, float, uint8_t) {
+      if (state == esphome::ota::OTA_IN_PROGRESS)
+        reports++;
+    });
+    AsyncWebServerRequest request(HTTP_POST, "/update?size=" + std::to_string(image.size()));
+
+    size_t base = heap_live;
+    heap_peak = heap_live;
+    auto start = std::chrono::steady_clock::now();
+    host.upload(request, "firmware.ota.bin", image, chunks);
+    host.loop();
+    double cpu_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const esphome::ota::FlashStats &stats = esphome::ota::flash_stats();
+    ok = ok && request.body() == "Update Successful!" && esphome::ota::updated_image() == image;
+    if (flash) {
+      flash_kb_s = mb * 1000 / (cpu_s + stats.busy_us / 1e6);
+      writes = stats.writes;
+      erases = stats.erases;
+      progress = reports;
+      peak = heap_peak - base;
+    } else {
+      cpu_mb_s = mb / cpu_s;
+    }
+  }
+
+  char pattern[32];
+  snprintf(pattern, sizeof(pattern), "%s%zu", random ? "1.." : "", segment);
+  printf("%-8s %8zu %9.1f %9.1f %8u %8u %9u %9zu%s\n", pattern, chunks.size(), flash_kb_s, cpu_mb_s, writes, erases,
+         progress, peak, ok ? "" : "  IMAGE MISMATCH");
+}
+
+int main(int argc, char **argv) {
+  esphome::logger::global_logger->set_print_level(ESPHOME_LOG_LEVEL_NONE);
+  std::vector<uint8_t> image;
+  const char *source = argc > 1 ? argv[1] : FW_IMAGE;
+  if (!load(source, image)) {
+    if (argc > 1) {
+      fprintf(stderr, "can't read %s\n", source);
+      return 1;
+    }
+    source = "pseudo random image";
+    image.resize(1536 * 1024);
+    std::mt19937 rng(1);
+    for (auto &b : image)
+      b = static_cast<uint8_t>(rng());
+    image[0] = 0xe9; // ESP image magic
+  }
+  printf("%s: %zu bytes\n", source, image.size());
+  printf("%-8s %8s %9s %9s %8s %8s %9s %9s\n", "chunks", "count", "KB/s", "CPU MB/s", "writes", "erases", "progress",
+         "peak RAM");
+
+  // the stand-in keeps the written image and the updated one, after two uploads it has the memory for both and the peak
+  // is that of the handler
+  for (int i = 0; i < 2; i++) {
+    WebHost host;
+    AsyncWebServerRequest request(HTTP_POST, "/update");
+    host.upload(request, "firmware.ota.bin", image);
+  }
+
+  if (argc > 2) {
+    for (int i = 2; i < argc; i++)
+      run(image, strtoul(argv[i], nullptr, 10), false);
+    return 0;
+  }
+  run(image, 536, false);
+  run(image, 1440, false);
+  run(image, 1440, true);
+  run(image, 4096, false);
+  run(image, 8192, false);
+  return 0;
+}
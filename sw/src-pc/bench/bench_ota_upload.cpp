@@ -0,0 +1,120 @@
+// Streams a firmware image through the web OTA write path in TCP-segment sized chunks and reports throughput and the
+// number of OTA backend write calls, with and without sector coalescing + streaming SHA-256.
+//
+// Usage: bench_ota_upload [firmware.ota.bin]
+// Without an argument a 1.5 MB pseudo random image is used.
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "../../src-esphome/mycomponents/web_server/ota/ota_stream.h"
+
+using esphome::web_server::OTASectorWriter;
+using esphome::web_server::OTASha256;
+
+// Stand-in for ota::OTABackend: copies into a flash image and counts calls.
+struct MockOTABackend {
+  std::vector<uint8_t> flash;
+  size_t write_calls = 0;
+  size_t unaligned_calls = 0;
+
+  uint8_t write(const uint8_t *data, size_t len) {
+    if (flash.size() % OTASectorWriter::SECTOR_SIZE != 0 || len % OTASectorWriter::SECTOR_SIZE != 0)
+      unaligned_calls++;
+    flash.insert(flash.end(), data, data + len);
+    write_calls++;
+    return 0;
+  }
+};
+
+struct Result {
+  double mb_per_s;
+  size_t write_calls;
+  size_t unaligned_calls;
+  bool image_ok;
+};
+
+static std::vector<size_t> chunk_pattern(size_t total, size_t segment, bool jitter) {
+  std::mt19937 rng(42);
+  std::vector<size_t> chunks;
+  size_t pos = 0;
+  while (pos < total) {
+    size_t len = jitter ? 1 + rng() % segment : segment;
+    len = std::min(len, total - pos);
+    chunks.push_back(len);
+    pos += len;
+  }
+  return chunks;
+}
+
+static Result run(const std::vector<uint8_t> &image, const std::vector<size_t> &chunks, bool coalesce) {
+  MockOTABackend backend;
+  backend.flash.reserve(image.size());
+  OTASha256 sha;
+  OTASectorWriter writer([&](const uint8_t *data, size_t len) { return backend.write(data, len); });
+
+  auto start = std::chrono::steady_clock::now();
+  size_t pos = 0;
+  for (size_t len : chunks) {
+    const uint8_t *data = image.data() + pos;
+    if (coalesce) {
+      sha.update(data, len);
+      writer.write(data, len);
+    } else {
+      backend.write(data, len);
+    }
+    pos += len;
+  }
+  if (coalesce) {
+    uint8_t digest[OTASha256::DIGEST_SIZE];
+    writer.flush();
+    sha.final(digest);
+  }
+  double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  return {image.size() / secs / 1e6, backend.write_calls, backend.unaligned_calls, backend.flash == image};
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<uint8_t> image;
+  if (argc > 1) {
+    std::ifstream f(argv[1], std::ios::binary);
+    image.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    if (image.empty()) {
+      printf("ERROR: cannot read %s\n", argv[1]);
+      return 1;
+    }
+  } else {
+    std::mt19937 rng(1);
+    image.resize(1536 * 1024);
+    for (auto &b : image)
+      b = (uint8_t)rng();
+  }
+
+  printf("image: %zu bytes\n", image.size());
+  printf("%-22s %-10s %10s %12s %10s %s\n", "chunks", "path", "MB/s", "write calls", "unaligned", "image");
+
+  struct {
+    const char *name;
+    size_t segment;
+    bool jitter;
+  } patterns[] = {
+      {"536 B (min MSS)", 536, false},
+      {"1436 B (soft-AP MSS)", 1436, false},
+      {"1..1460 B random", 1460, true},
+      {"4096 B", 4096, false},
+  };
+  for (auto &p : patterns) {
+    auto chunks = chunk_pattern(image.size(), p.segment, p.jitter);
+    Result direct = run(image, chunks, false);
+    Result coalesced = run(image, chunks, true);
+    printf("%-22s %-10s %10.1f %12zu %10zu %s\n", p.name, "direct", direct.mb_per_s, direct.write_calls,
+           direct.unaligned_calls, direct.image_ok ? "ok" : "BAD");
+    printf("%-22s %-10s %10.1f %12zu %10zu %s\n", "", "sector+sha", coalesced.mb_per_s, coalesced.write_calls,
+           coalesced.unaligned_calls, coalesced.image_ok ? "ok" : "BAD");
+  }
+  return 0;
+}
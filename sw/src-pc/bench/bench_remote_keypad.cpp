@@ -0,0 +1,178 @@
+// Remote keypad latency over the loopback interface: a WebSocket client sends key frames to the host stand-in server
+// (remote_keypad_host.hpp) and waits for the LCD frame that acknowledges each one. The game runs in its own thread
+// like the device's main loop, the key queue is drained once per loop iteration.
+//
+// The loop period decides most of the latency: 1ms is the device while a keypad client is connected (the main loop
+// doesn't sleep), 16ms the default esphome loop interval, 50ms draining the keys with the game clock only.
+//
+// Reported per loop period: round trip percentiles in ms, key to LCD frame including the network and both threads.
+//
+// Usage: bench_remote_keypad [round_trips]
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src-common/gm_manager.hpp"
+#include "../remote_keypad_host.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+static bench_clock::time_point start_time = bench_clock::now();
+uint32_t esphome::millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(bench_clock::now() - start_time).count();
+}
+
+// Minimal WebSocket client: handshake, masked binary frames out, unmasked frames in
+class Client {
+public:
+  bool connect(uint16_t port) {
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, (sockaddr *)&addr, sizeof(addr)) != 0) {
+      return false;
+    }
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    std::string request = "GET /keypad HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                          "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    send(fd, request.data(), request.size(), 0);
+    std::string response;
+    char c;
+    while (response.find("\r\n\r\n") == std::string::npos && read(fd, &c, 1) == 1) {
+      response += c;
+    }
+    return response.find(" 101 ") != std::string::npos &&
+           response.find(RemoteKeypadHost::websocket_accept("dGhlIHNhbXBsZSBub25jZQ==")) != std::string::npos;
+  }
+
+  void send_keys(uint8_t seq, const char *keys) {
+    uint8_t frame[2 + 4 + REMOTE_KEYPAD_MAX_FRAME];
+    size_t len = 1 + strlen(keys);
+    uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+    frame[0] = 0x82;
+    frame[1] = 0x80 | len;
+    memcpy(frame + 2, mask, 4);
+    for (size_t i = 0; i < len; i++) {
+      frame[6 + i] = (i == 0 ? seq : keys[i - 1]) ^ mask[i % 4];
+    }
+    send(fd, frame, 6 + len, 0);
+  }
+
+  // Blocks until the next frame, returns its payload
+  std::vector<uint8_t> receive() {
+    uint8_t header[2];
+    read_all(header, 2);
+    std::vector<uint8_t> payload(header[1] & 0x7f);
+    read_all(payload.data(), payload.size());
+    return payload;
+  }
+
+  ~Client() { close(fd); }
+
+private:
+  int fd = -1;
+
+  void read_all(uint8_t *buf, size_t len) {
+    while (len) {
+      ssize_t n = read(fd, buf, len);
+      if (n <= 0) {
+        fprintf(stderr, "connection closed\n");
+        exit(1);
+      }
+      buf += n;
+      len -= n;
+    }
+  }
+};
+
+static void run(uint32_t loop_ms, size_t round_trips) {
+  RemoteKeypadHost host;
+  if (!host.start(0)) {
+    fprintf(stderr, "can't listen\n");
+    exit(1);
+  }
+
+  std::atomic<bool> running{true};
+  std::thread game([&]() {
+    AntGlobals antg;
+    GameManager game_manager(antg);
+    esphome::lcd_base::LCDDisplay display;
+    auto update_display = [&]() {
+      game_manager.display_update(display);
+      host.set_frame(lcd_capture(display));
+      display.present();
+    };
+    uint32_t last_clock = esphome::millis();
+    while (running) {
+      host.loop([&](unsigned char key) {
+        game_manager.handle_key(key);
+        update_display();
+      });
+      uint32_t now = esphome::millis();
+      if (now - last_clock >= 50) {
+        game_manager.clock(now, now - last_clock);
+        last_clock = now;
+        update_display();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(loop_ms));
+    }
+  });
+
+  Client client;
+  if (!client.connect(host.port())) {
+    fprintf(stderr, "handshake failed\n");
+    exit(1);
+  }
+  client.receive(); // the full display
+
+  // Scroll through the main menu, every key changes the display. Sends are spread over the loop period.
+  std::mt19937 rng(loop_ms);
+  std::vector<double> rtt_ms;
+  size_t bytes = 0;
+  for (size_t i = 0; i <= round_trips; i++) {
+    std::this_thread::sleep_for(std::chrono::microseconds(rng() % (loop_ms * 1000 + 1)));
+    uint8_t seq = i;
+    auto sent = bench_clock::now();
+    client.send_keys(seq, i % 2 ? "B" : "A");
+    std::vector<uint8_t> frame;
+    do {
+      frame = client.receive();
+    } while (frame.empty() || frame[0] != seq);
+    if (i > 0) { // the first key leaves the splash screen
+      rtt_ms.push_back(std::chrono::duration<double, std::milli>(bench_clock::now() - sent).count());
+      bytes += frame.size();
+    }
+  }
+
+  running = false;
+  game.join();
+  host.stop();
+
+  std::sort(rtt_ms.begin(), rtt_ms.end());
+  auto pct = [&](double p) { return rtt_ms[std::min(rtt_ms.size() - 1, (size_t)(p * rtt_ms.size()))]; };
+  printf("%7u %7.2f %7.2f %7.2f %7.2f %9.1f\n", loop_ms, pct(0.5), pct(0.9), pct(0.99), rtt_ms.back(),
+         bytes / (double)rtt_ms.size());
+}
+
+int main(int argc, char **argv) {
+  mock_log_enabled = false;
+  std::cout.setstate(std::ios::failbit); // the mock LCD prints every frame
+  size_t round_trips = argc > 1 ? atoi(argv[1]) : 200;
+  printf("   loop        round trip ms             LCD frame\n");
+  printf("     ms     p50     p90     p99     max   bytes/key\n");
+  for (uint32_t loop_ms : {1, 5, 16, 50}) {
+    run(loop_ms, round_trips);
+  }
+  return 0;
+}
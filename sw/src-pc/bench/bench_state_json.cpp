@@ -0,0 +1,274 @@
+// State event JSON: the streaming JsonWriter of the web server (json_writer.h) against building a document first and
+// serializing it, as json::build_json() does with ArduinoJson.
+//
+// ArduinoJson isn't available on the host, the document path is modelled with the same steps: temporary strings for
+// the id and the formatted state, a document holding copies of the keys and values, serialization into a growing
+// std::string. The writer path is the one of the *_state_json() functions: a buffer owned by the server and one
+// std::string for the event source (the entity batches append the buffer as it is, without that string).
+//
+// Reported per entity type: ns per event, heap allocations and bytes allocated per event, event length.
+//
+// Usage: bench_state_json [events]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../../src-esphome/mycomponents/web_server/json_writer.h"
+
+using esphome::web_server::JsonWriter;
+
+static size_t alloc_count = 0;
+static size_t alloc_bytes = 0;
+
+void *operator new(size_t size) {
+  alloc_count++;
+  alloc_bytes += size;
+  void *p = malloc(size);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// --- esphome stand-ins ---
+
+static void normalize_accuracy_decimals(float &value, int8_t &accuracy_decimals) {
+  if (accuracy_decimals < 0) {
+    float multiplier = powf(10.0f, accuracy_decimals);
+    value = roundf(value * multiplier) / multiplier;
+    accuracy_decimals = 0;
+  }
+}
+
+static std::string value_accuracy_to_string(float value, int8_t accuracy_decimals) {
+  normalize_accuracy_decimals(value, accuracy_decimals);
+  char tmp[32];
+  snprintf(tmp, sizeof(tmp), "%.*f", accuracy_decimals, value);
+  return std::string(tmp);
+}
+
+struct Entity {
+  std::string object_id;
+  std::string unit;
+  int8_t accuracy = 1;
+  float number = 0;
+  bool flag = false;
+  std::string text;
+};
+
+// --- document path ---
+
+class Document {
+public:
+  void set(const char *key, const std::string &value) { set_string(key).str = value; }
+  void set(const char *key, const char *value) { set_string(key).str = value; }
+  void set(const char *key, bool value) { add(key).boolean = value; }
+  void set(const char *key, float value) {
+    Value &v = add(key);
+    v.is_number = true;
+    v.number = value;
+  }
+
+  std::string serialize() const {
+    std::string out = "{";
+    for (const Value &v : values) {
+      if (out.size() > 1) {
+        out += ',';
+      }
+      out += '"';
+      out += v.key;
+      out += "\":";
+      if (v.is_number) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), "%g", v.number);
+        out += std::isfinite(v.number) ? buf : "null";
+      } else if (!v.is_string) {
+        out += v.boolean ? "true" : "false";
+      } else {
+        out += '"';
+        out += v.str; // the entities of the benchmark need no escapes
+        out += '"';
+      }
+    }
+    out += '}';
+    return out;
+  }
+
+private:
+  struct Value {
+    std::string key;
+    std::string str;
+    float number = 0;
+    bool boolean = false;
+    bool is_number = false;
+    bool is_string = false;
+  };
+  std::vector<Value> values;
+
+  Value &add(const char *key) {
+    values.emplace_back();
+    values.back().key = key;
+    return values.back();
+  }
+
+  Value &set_string(const char *key) {
+    Value &v = add(key);
+    v.is_string = true;
+    return v;
+  }
+};
+
+static std::string sensor_document(const Entity &e) {
+  Document root;
+  root.set("id", "sensor-" + e.object_id);
+  root.set("value", e.number);
+  std::string state = value_accuracy_to_string(e.number, e.accuracy);
+  if (!e.unit.empty())
+    state += " " + e.unit;
+  root.set("state", state);
+  return root.serialize();
+}
+
+static std::string binary_sensor_document(const Entity &e) {
+  Document root;
+  root.set("id", "binary_sensor-" + e.object_id);
+  root.set("value", e.flag);
+  root.set("state", e.flag ? "ON" : "OFF");
+  return root.serialize();
+}
+
+static std::string text_sensor_document(const Entity &e) {
+  Document root;
+  root.set("id", "text_sensor-" + e.object_id);
+  root.set("value", e.text);
+  root.set("state", e.text);
+  return root.serialize();
+}
+
+static std::string number_document(const Entity &e) {
+  Document root;
+  root.set("id", "number-" + e.object_id);
+  root.set("value", value_accuracy_to_string(e.number, e.accuracy));
+  std::string state = value_accuracy_to_string(e.number, e.accuracy);
+  if (!e.unit.empty())
+    state += " " + e.unit;
+  root.set("state", state);
+  return root.serialize();
+}
+
+// --- writer path ---
+
+static char state_json[512];
+
+static void add_accuracy(JsonWriter &json, const char *key, float value, int8_t accuracy_decimals,
+                         const std::string &unit) {
+  normalize_accuracy_decimals(value, accuracy_decimals);
+  json.add_decimal(key, value, accuracy_decimals, unit);
+}
+
+static std::string sensor_writer(const Entity &e) {
+  JsonWriter json(state_json, sizeof(state_json));
+  json.begin_object();
+  json.add("id", "sensor-", e.object_id);
+  json.add("value", e.number);
+  add_accuracy(json, "state", e.number, e.accuracy, e.unit);
+  json.end_object();
+  return json.str();
+}
+
+static std::string binary_sensor_writer(const Entity &e) {
+  JsonWriter json(state_json, sizeof(state_json));
+  json.begin_object();
+  json.add("id", "binary_sensor-", e.object_id);
+  json.add("value", e.flag);
+  json.add("state", e.flag ? "ON" : "OFF");
+  json.end_object();
+  return json.str();
+}
+
+static std::string text_sensor_writer(const Entity &e) {
+  JsonWriter json(state_json, sizeof(state_json));
+  json.begin_object();
+  json.add("id", "text_sensor-", e.object_id);
+  json.add("value", e.text);
+  json.add("state", e.text);
+  json.end_object();
+  return json.str();
+}
+
+static std::string number_writer(const Entity &e) {
+  JsonWriter json(state_json, sizeof(state_json));
+  json.begin_object();
+  json.add("id", "number-", e.object_id);
+  add_accuracy(json, "value", e.number, e.accuracy, std::string());
+  add_accuracy(json, "state", e.number, e.accuracy, e.unit);
+  json.end_object();
+  return json.str();
+}
+
+// --- benchmark ---
+
+using generator_t = std::string (*)(const Entity &);
+
+struct Result {
+  double ns;
+  double allocs;
+  double bytes;
+  size_t length;
+};
+
+static Result run(generator_t generator, const Entity &entity, size_t events) {
+  size_t length = 0;
+  size_t count_before = alloc_count, bytes_before = alloc_bytes;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < events; i++) {
+    std::string event = generator(entity);
+    length += event.size();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return Result{std::chrono::duration<double, std::nano>(end - start).count() / events,
+                (double) (alloc_count - count_before) / events, (double) (alloc_bytes - bytes_before) / events,
+                length / events};
+}
+
+int main(int argc, char **argv) {
+  size_t events = argc > 1 ? atoi(argv[1]) : 200000;
+
+  Entity red_button{"red_button", "", 0, 0, true, ""};
+  Entity temperature{"chip_temperature", "°C", 1, 41.37f, false, ""};
+  Entity status{"game_status", "", 0, 0, false, "Domination: red 12:34, yellow 08:15"};
+  Entity siren{"siren_level", "%", 0, 75, false, ""};
+
+  struct Case {
+    const char *name;
+    const Entity &entity;
+    generator_t document;
+    generator_t writer;
+  };
+  const Case cases[] = {
+      {"binary_sensor", red_button, binary_sensor_document, binary_sensor_writer},
+      {"sensor", temperature, sensor_document, sensor_writer},
+      {"text_sensor", status, text_sensor_document, text_sensor_writer},
+      {"number", siren, number_document, number_writer},
+  };
+
+  printf("                        document               writer\n");
+  printf("entity           len   ns/ev allocs  bytes    ns/ev allocs  bytes\n");
+  for (const Case &c : cases) {
+    Result doc = run(c.document, c.entity, events);
+    Result writer = run(c.writer, c.entity, events);
+    if (c.document(c.entity) != c.writer(c.entity)) {
+      printf("%-14s outputs differ:\n  %s\n  %s\n", c.name, c.document(c.entity).c_str(), c.writer(c.entity).c_str());
+    }
+    printf("%-14s %5zu %7.0f %6.1f %6.0f  %7.0f %6.1f %6.0f\n", c.name, writer.length, doc.ns, doc.allocs, doc.bytes,
+           writer.ns, writer.allocs, writer.bytes);
+  }
+  return 0;
+}
@@ -0,0 +1,240 @@
+// The web_server component under load: the firmware code, compiled against the stand-in AsyncWebServer of
+// src-pc/mock_web (see web_host.hpp), replays mixes of requests.
+//
+// Mixes:
+//   index    - GET / (the gzipped page)
+//   poll     - GET of the state of an entity
+//   command  - POST toggling the switch or pressing the button, and the main loop that runs the command
+//   events   - a state change and the main loop that sends it to 3 connected /events clients
+//   connect  - a new /events client, until it got the config and all entities, then it disconnects
+//   ota      - a 1 MB firmware upload in TCP sized chunks
+//   mixed    - 70% poll, 10% command, 10% index and 10% events
+//
+// Requests are handled on the thread of the benchmark, as one httpd task would; the latency is the time a request
+// spends in the handlers (and in the main loop, for the mixes that need it), not network time. Allocations are the
+// operator new calls made meanwhile, the ArduinoJson stand-in allocates through it too. The stand-in server copies
+// response bodies into a buffer reserved when the request is made, so the copies aren't counted.
+//
+// Reported per mix: requests, requests per second, p50/p90/p99 latency, allocations and bytes per request.
+//
+// Usage: bench_web_server [requests per mix]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../mock_web/web_host.hpp"
+
+using web_host::WebHost;
+
+static bool counting = false;
+static size_t alloc_count = 0;
+static size_t alloc_bytes = 0;
+
+void *operator new(size_t size) {
+  if (counting) {
+    alloc_count++;
+    alloc_bytes += size;
+  }
+  void *p = malloc(size);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+  std::vector<double> latencies_us;
+  double total_us = 0;
+  size_t allocs = 0;
+  size_t bytes = 0;
+};
+
+// Runs a measured step: `prepare` outside of the measurement (making requests, reading the event streams), `step`
+// inside.
+static Result run(size_t count, const std::function<void(size_t)> &prepare, const std::function<void(size_t)> &step) {
+  Result result;
+  result.latencies_us.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    prepare(i);
+    size_t allocs = alloc_count;
+    size_t bytes = alloc_bytes;
+    counting = true;
+    auto start = Clock::now();
+    step(i);
+    auto end = Clock::now();
+    counting = false;
+    result.allocs += alloc_count - allocs;
+    result.bytes += alloc_bytes - bytes;
+    double us = std::chrono::duration<double, std::micro>(end - start).count();
+    result.latencies_us.push_back(us);
+    result.total_us += us;
+  }
+  return result;
+}
+
+static void report(const char *mix, Result result, const char *unit = "req") {
+  size_t n = result.latencies_us.size();
+  if (n == 0)
+    return;
+  std::sort(result.latencies_us.begin(), result.latencies_us.end());
+  auto percentile = [&](double p) { return result.latencies_us[std::min(n - 1, static_cast<size_t>(n * p))]; };
+  printf("%-8s %7zu %-3s %9.0f/s   p50 %8.1f us  p90 %8.1f us  p99 %8.1f us   %6.1f allocs %8.0f B per %s\n", mix, n,
+         unit, n / (result.total_us / 1e6), percentile(0.50), percentile(0.90), percentile(0.99),
+         static_cast<double>(result.allocs) / n, static_cast<double>(result.bytes) / n, unit);
+}
+
+static const char *poll_url(std::mt19937 &rng) {
+  static const char *const URLS[] = {
+      "/binary_sensor/red_button", "/binary_sensor/yellow_button", "/binary_sensor/key_c",
+      "/binary_sensor/key_star",   "/switch/siren",                "/binary_sensor/key_d?detail=all",
+  };
+  return URLS[rng() % (sizeof(URLS) / sizeof(URLS[0]))];
+}
+
+// Connects an /events client and runs the main loop until it got the config and all entities.
+static AsyncEventSourceResponse *connect_client(WebHost &host, AsyncWebServerRequest &request) {
+  host.handle(request);
+  AsyncEventSourceResponse *client = request.event_client();
+  for (int i = 0; i < 20; i++) {
+    host.loop();
+    client->read();
+  }
+  return client;
+}
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+  esphome::logger::global_logger->set_print_level(ESPHOME_LOG_LEVEL_NONE);
+  std::mt19937 rng(1);
+  std::unique_ptr<AsyncWebServerRequest> request;
+  std::vector<std::unique_ptr<AsyncWebServerRequest>> requests;
+
+  {
+    WebHost host;
+    report("index", run(
+                        count, [&](size_t) { request = std::make_unique<AsyncWebServerRequest>(HTTP_GET, "/"); },
+                        [&](size_t) { host.handle(*request); }));
+  }
+
+  {
+    WebHost host;
+    report("poll", run(
+                       count,
+                       [&](size_t) {
+                         request = std::make_unique<AsyncWebServerRequest>(HTTP_GET, poll_url(rng));
+                       },
+                       [&](size_t) { host.handle(*request); }));
+  }
+
+  {
+    WebHost host;
+    report("command", run(
+                          count,
+                          [&](size_t i) {
+                            const char *url = i % 2 ? "/switch/siren/toggle" : "/button/restart/press";
+                            request = std::make_unique<AsyncWebServerRequest>(HTTP_POST, url);
+                          },
+                          [&](size_t) {
+                            host.handle(*request);
+                            host.loop();
+                          }));
+  }
+
+  {
+    WebHost host;
+    std::vector<AsyncEventSourceResponse *> clients;
+    for (int c = 0; c < 3; c++) {
+      requests.push_back(std::make_unique<AsyncWebServerRequest>(HTTP_GET, "/events"));
+      clients.push_back(connect_client(host, *requests.back()));
+    }
+    report("events", run(
+                         count,
+                         [&](size_t) {
+                           for (auto *client : clients)
+                             client->read();
+                         },
+                         [&](size_t) {
+                           auto &sensor = host.sensors[rng() % host.sensors.size()];
+                           sensor->publish_state(!sensor->state);
+                           host.loop();
+                         }),
+           "evt");
+    requests.clear();
+  }
+
+  {
+    WebHost host;
+    AsyncEventSourceResponse *client = nullptr;
+    report("connect", run(
+                          std::max<size_t>(count / 20, 1),
+                          [&](size_t) {
+                            if (client != nullptr) {
+                              client->close();
+                              host.loop();
+                            }
+                            request = std::make_unique<AsyncWebServerRequest>(HTTP_GET, "/events");
+                          },
+                          [&](size_t) { client = connect_client(host, *request); }));
+  }
+
+  {
+    WebHost host;
+    std::vector<uint8_t> image(1024 * 1024);
+    for (size_t i = 0; i < image.size(); i++)
+      image[i] = static_cast<uint8_t>(rng());
+    image[0] = 0xe9;
+    Result result = run(
+        std::max<size_t>(count / 2000, 3),
+        [&](size_t) { request = std::make_unique<AsyncWebServerRequest>(HTTP_POST, "/update"); },
+        [&](size_t) { host.upload(*request, "firmware.bin", image); });
+    report("ota", result, "upl");
+    printf("%-8s %.1f MB/s\n", "", result.latencies_us.size() * image.size() / result.total_us);
+  }
+
+  {
+    WebHost host;
+    std::vector<AsyncEventSourceResponse *> clients;
+    std::vector<std::unique_ptr<AsyncWebServerRequest>> event_requests;
+    for (int c = 0; c < 2; c++) {
+      event_requests.push_back(std::make_unique<AsyncWebServerRequest>(HTTP_GET, "/events"));
+      clients.push_back(connect_client(host, *event_requests.back()));
+    }
+    report("mixed", run(
+                        count,
+                        [&](size_t) {
+                          for (auto *client : clients)
+                            client->read();
+                          uint32_t r = rng() % 10;
+                          if (r < 7) {
+                            request = std::make_unique<AsyncWebServerRequest>(HTTP_GET, poll_url(rng));
+                          } else if (r == 7) {
+                            request = std::make_unique<AsyncWebServerRequest>(HTTP_POST, "/switch/siren/toggle");
+                          } else if (r == 8) {
+                            request = std::make_unique<AsyncWebServerRequest>(HTTP_GET, "/");
+                          } else {
+                            request.reset();
+                          }
+                        },
+                        [&](size_t) {
+                          if (request != nullptr) {
+                            host.handle(*request);
+                          } else {
+                            auto &sensor = host.sensors[rng() % host.sensors.size()];
+                            sensor->publish_state(!sensor->state);
+                          }
+                          host.loop();
+                        }));
+  }
+  return 0;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src-common/fleet_sync.hpp"
+
+// In-process broadcast network for running several FleetSync instances in one process (unit tests and the fleet
+// simulator). A message reaches every other endpoint after latency_ms plus a random jitter, or is lost with
+// probability loss, independently per receiver like radio broadcasts are. Time is driven by the caller.
+class FleetLoopbackNetwork {
+private:
+  struct Packet {
+    uint32_t deliver_at;
+    size_t to;
+    size_t len;
+    uint8_t data[FLEET_MAX_MESSAGE];
+  };
+
+public:
+  class Endpoint : public FleetTransport {
+  private:
+    FleetLoopbackNetwork &net;
+    size_t index;
+    std::deque<Packet> inbox;
+    bool online = true;
+
+    friend class FleetLoopbackNetwork;
+
+  public:
+    Endpoint(FleetLoopbackNetwork &net, size_t index) : net(net), index(index) {}
+
+    void send(const uint8_t *data, size_t len) override {
+      if (online) {
+        net.broadcast(index, data, len);
+      }
+    }
+
+    size_t receive(uint8_t *buf) override {
+      if (inbox.empty()) {
+        return 0;
+      }
+      const Packet &p = inbox.front();
+      size_t len = p.len;
+      memcpy(buf, p.data, len);
+      inbox.pop_front();
+      return len;
+    }
+
+    // A prop that is switched off neither sends nor receives
+    void set_online(bool online) {
+      this->online = online;
+      inbox.clear();
+    }
+  };
+
+  uint32_t latency_ms = 5;
+  uint32_t jitter_ms = 5;
+  float loss = 0;
+
+  uint64_t delivered = 0;
+  uint64_t lost = 0;
+
+  explicit FleetLoopbackNetwork(uint32_t seed = 1) : rng(seed) {}
+
+  Endpoint &add_endpoint() {
+    endpoints.push_back(std::make_unique<Endpoint>(*this, endpoints.size()));
+    return *endpoints.back();
+  }
+
+  // Advances the network time, moving the messages that arrived by now to the receivers' inboxes
+  void set_time(uint32_t now) {
+    this->now = now;
+    auto due = std::stable_partition(in_flight.begin(), in_flight.end(),
+                                     [now](const Packet &p) { return (int32_t)(p.deliver_at - now) > 0; });
+    std::stable_sort(due, in_flight.end(),
+                     [](const Packet &a, const Packet &b) { return (int32_t)(a.deliver_at - b.deliver_at) < 0; });
+    for (auto it = due; it != in_flight.end(); ++it) {
+      Endpoint &ep = *endpoints[it->to];
+      if (ep.online) {
+        ep.inbox.push_back(*it);
+        delivered++;
+      }
+    }
+    in_flight.erase(due, in_flight.end());
+  }
+
+private:
+  std::mt19937 rng;
+  std::vector<std::unique_ptr<Endpoint>> endpoints;
+  std::vector<Packet> in_flight;
+  uint32_t now = 0;
+
+  void broadcast(size_t from, const uint8_t *data, size_t len) {
+    std::uniform_real_distribution<float> chance(0, 1);
+    std::uniform_int_distribution<uint32_t> jitter(0, jitter_ms);
+    for (size_t i = 0; i < endpoints.size(); i++) {
+      if (i == from) {
+        continue;
+      }
+      if (loss > 0 && chance(rng) < loss) {
+        lost++;
+        continue;
+      }
+      Packet p;
+      p.deliver_at = now + latency_ms + jitter(rng);
+      p.to = i;
+      p.len = len;
+      memcpy(p.data, data, len);
+      in_flight.push_back(p);
+    }
+  }
+};
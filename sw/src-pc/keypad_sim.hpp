@@ -0,0 +1,99 @@
+#pragma once
+
+// Model of the keypad on its I2C bus, for the host-side tests and benchmarks of the keypad scanners
+// (src-esphome/mycomponents/pcf8574_keypad): the 4x4 matrix of config.yaml, "D#0*C987B654A321", rows on P0-P3 and
+// columns on P4-P7 of a PCF8574, without diodes.
+//
+// The pins are quasi-bidirectional: a 0 drives the pin low, a 1 pulls it up weakly. A closed key connects its row
+// and column, so a read sees low every line that is driven low or connected to one through closed keys (the ghost
+// keys of three keys included). The bus time of each transaction is counted: a start, the address byte, the data
+// bytes, each with its ACK, and a stop; a repeated start for a write and a read in one.
+
+#include <cstdint>
+#include <cstring>
+
+#include "../src-esphome/mycomponents/pcf8574_keypad/keypad_scanner.h"
+
+class KeypadMatrixModel : public esphome::pcf8574_keypad::KeypadBus {
+public:
+  static constexpr const char *KEYS = "D#0*C987B654A321";
+
+  explicit KeypadMatrixModel(uint32_t frequency) : bit_us(1e6 / frequency) {}
+
+  // Closes or opens the contact of a key
+  void set(char key, bool closed) {
+    const char *at = strchr(KEYS, key);
+    uint16_t bit = 1 << (at - KEYS);
+    closed_ = closed ? closed_ | bit : closed_ & ~bit;
+  }
+
+  bool read_pins(uint8_t &pins) override {
+    count(1 + 9 + 9 + 1);
+    pins = sample();
+    return !fail;
+  }
+
+  bool write_pins(uint8_t pins) override {
+    count(1 + 9 + 9 + 1);
+    out = pins;
+    return !fail;
+  }
+
+  bool write_read_pins(uint8_t pins_out, uint8_t &pins) override {
+    count(1 + 9 + 9 + 1 + 9 + 9 + 1);
+    out = pins_out;
+    pins = sample();
+    return !fail;
+  }
+
+  const double bit_us;
+  double busy_us = 0;        // time the bus was busy
+  uint32_t transactions = 0;
+  uint8_t out = 0xFF;        // the pins the last write set
+  bool fail = false;         // the PCF8574 doesn't answer
+
+private:
+  void count(int bits) {
+    transactions++;
+    busy_us += bits * bit_us;
+  }
+
+  uint8_t sample() const {
+    uint8_t low = ~out;
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (int key = 0; key < 16; key++) {
+        uint8_t lines = 1 << (key / 4) | 1 << (4 + key % 4);
+        if ((closed_ & (1 << key)) && (low & lines) && (low & lines) != lines) {
+          low |= lines;
+          changed = true;
+        }
+      }
+    }
+    return ~low;
+  }
+
+  uint16_t closed_ = 0;
+};
+
+// esphome's matrix_keypad on the pins of its pcf8574 component: each pin_mode() and digital_write() a write of the
+// port, each digital_read() a read. Returns the index of the key down, -1 for none, -2 for more than one.
+inline int stock_matrix_keypad_scan(KeypadMatrixModel &bus) {
+  int key = -1;
+  bool error = false;
+  uint8_t pins;
+  for (int row = 0; row < 4; row++) {
+    bus.write_pins(bus.out & ~(1 << row)); // pin_mode(OUTPUT)
+    bus.write_pins(bus.out & ~(1 << row)); // digital_write(false)
+    for (int col = 0; col < 4; col++) {
+      bus.read_pins(pins);
+      if (!(pins & (1 << (4 + col)))) {
+        error = error || key != -1;
+        key = row * 4 + col;
+      }
+    }
+    bus.write_pins(bus.out | (1 << row)); // digital_write(true)
+    bus.write_pins(bus.out | (1 << row)); // pin_mode(INPUT)
+  }
+  return error ? -2 : key;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+// Byte level model of the LCD on its I2C bus: the bus, the PCF8574 port expander and the HD44780 behind it in 4-bit
+// mode, for the host-side tests and benchmarks of the LCD drivers (src-esphome/mycomponents/lcd_burst).
+//
+// Each I2C write takes its bits on the bus: a start, the address byte, the data bytes, each with its ACK, and a stop.
+// The PCF8574 sets its pins at the ACK of each byte, and the LCD takes a nibble on the falling edge of E. The model
+// keeps the DDRAM and CGRAM of the LCD, and counts the timing violations a real LCD would lose characters to: a nibble
+// while the last instruction still executes (37us, 1.52ms for clear and home), and RS changing as E rises.
+//
+// The initialization is not modelled, the LCD starts in 4-bit mode with the DDRAM blank.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "../src-esphome/mycomponents/lcd_burst/hd44780_burst.h"
+
+class LcdBusModel {
+public:
+  explicit LcdBusModel(uint32_t frequency) : bit_us(1e6 / frequency) { memset(ddram, ' ', sizeof(ddram)); }
+
+  // One I2C write to the PCF8574
+  void write(const uint8_t *data, size_t len) {
+    transactions++;
+    bytes += 1 + len;
+    now += bit_us * (1 + 9); // start, address
+    for (size_t i = 0; i < len; i++) {
+      now += bit_us * 9;
+      set_pins(data[i]);
+    }
+    now += bit_us; // stop
+  }
+
+  // Time without traffic, a delay of the driver
+  void pause(double us) { now += us; }
+
+  // The characters of a row of a columns wide display, as LCDDisplay maps them
+  std::string row(int r, int columns) const {
+    uint8_t addr = (r & 1 ? 0x40 : 0x00) + (r >= 2 ? columns : 0);
+    return std::string((const char *)ddram + addr, columns);
+  }
+
+  const double bit_us;
+  double now = 0;              // us since the start
+  uint32_t transactions = 0;   // I2C writes
+  uint32_t bytes = 0;          // bytes on the bus, with the address bytes
+  uint32_t busy_nibbles = 0;   // nibbles taken while the LCD was busy, lost on a real LCD
+  uint32_t rs_violations = 0;  // E rising in the byte that changes RS
+  uint32_t instructions = 0;   // commands and characters the LCD executed
+  uint8_t ddram[128];
+  uint8_t cgram[64] = {};
+
+private:
+  void set_pins(uint8_t p) {
+    using namespace esphome::lcd_burst;
+    bool e_rise = !(pins & PCF8574_E) && (p & PCF8574_E);
+    bool e_fall = (pins & PCF8574_E) && !(p & PCF8574_E);
+    if (e_rise && (p ^ pins) & PCF8574_RS) {
+      rs_violations++;
+    }
+    pins = p;
+    if (e_fall) {
+      nibble(p >> 4, p & PCF8574_RS);
+    }
+  }
+
+  void nibble(uint8_t value, bool rs) {
+    if (now < busy_until) {
+      busy_nibbles++;
+    }
+    if (!high_nibble) {
+      high = value;
+      high_nibble = true;
+      return;
+    }
+    high_nibble = false;
+    execute(high << 4 | value, rs);
+  }
+
+  void execute(uint8_t value, bool rs) {
+    instructions++;
+    busy_until = now + 37;
+    if (rs) {
+      if (cgram_mode) {
+        cgram[addr++ & 63] = value;
+      } else {
+        ddram[addr] = value;
+        addr = addr == 0x27 ? 0x40 : addr == 0x67 ? 0x00 : addr + 1;
+      }
+    } else if (value & 0x80) {
+      cgram_mode = false;
+      addr = value & 0x7f;
+    } else if (value & 0x40) {
+      cgram_mode = true;
+      addr = value & 0x3f;
+    } else if (value == 0x01 || (value & 0xfe) == 0x02) {
+      if (value == 0x01) {
+        memset(ddram, ' ', sizeof(ddram));
+      }
+      cgram_mode = false;
+      addr = 0;
+      busy_until = now + 1520;
+    }
+  }
+
+  uint8_t pins = 0;
+  bool high_nibble = false;
+  uint8_t high = 0;
+  bool cgram_mode = false;
+  uint8_t addr = 0;
+  double busy_until = 0;
+};
+
+// The writes of esphome's lcd_pcf8574 for a frame (LCDDisplay::display()): each pin change a write of its own, and
+// the delays of PCF8574LCDDisplay::write_n_bits()
+inline void stock_pcf8574_frame(LcdBusModel &bus, const uint8_t *chars, uint8_t columns, uint8_t rows) {
+  using namespace esphome::lcd_burst;
+  auto nibble = [&](uint8_t value) {
+    uint8_t data = value | PCF8574_BACKLIGHT;
+    bus.write(&data, 1);
+    uint8_t e = data | PCF8574_E;
+    bus.write(&e, 1);
+    bus.pause(1);
+    bus.write(&data, 1);
+    bus.pause(100);
+  };
+  auto send = [&](uint8_t value, bool rs) {
+    nibble((value & 0xF0) | rs);
+    nibble(((value << 4) & 0xF0) | rs);
+  };
+  static const uint8_t ROW_ADDR[] = {0x00, 0x40, 0x00, 0x40};
+  for (uint8_t row = 0; row < rows && row < 4; row++) {
+    send(HD44780_SET_DDRAM_ADDR | (ROW_ADDR[row] + (row >= 2 ? columns : 0)), false);
+    for (uint8_t col = 0; col < columns; col++) {
+      send(chars[row * columns + col], true);
+    }
+  }
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstring>
+
+#include "../src-common/lcd_frame.hpp"
+#include "mock_esphome.hpp"
+
+// Copy of the mock LCD, after the game manager rendered into it and before present(). On the device the web server
+// is handed the frame the game task rendered (GameLoop::show(), WebServer::capture_lcd()).
+inline LcdFrame lcd_capture(const esphome::lcd_base::LCDDisplay &disp) {
+  LcdFrame frame;
+  for (size_t row = 0; row < LCD_ROWS; row++) {
+    memcpy(frame.cells + row * LCD_COLS, disp.row(row).data(), LCD_COLS);
+  }
+  return frame;
+}
@@ -0,0 +1,359 @@
+#pragma once
+
+// Host side of the tokenized log (src-common/log_tokens.hpp): the token dictionary, the scanner that builds it from
+// the sources, and the decoder of the records. Used by tools/ant_log.cpp and the unit tests.
+
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../src-common/log_tokens.hpp"
+
+struct LogFormat {
+  char level; // 'I' or 'W'
+  std::string tag;
+  std::string format;
+
+  uint32_t token() const { return log_token(level, tag.c_str(), format.c_str()); }
+  bool operator==(const LogFormat &o) const { return level == o.level && tag == o.tag && format == o.format; }
+};
+
+// Finds the ANT_LOGI() and ANT_LOGW() calls in a source file (C++, or the lambdas of config.yaml) and adds their
+// formats. Calls whose tag and format aren't string literals, like the macro definitions, are skipped.
+inline void log_scan(const std::string &source, std::vector<LogFormat> &formats) {
+  size_t pos = 0;
+  auto skip_space = [&]() {
+    while (pos < source.size() && isspace((unsigned char)source[pos])) {
+      pos++;
+    }
+  };
+  // One or more adjacent string literals, unescaped
+  auto literal = [&](std::string &out) {
+    bool found = false;
+    skip_space();
+    while (pos < source.size() && source[pos] == '"') {
+      found = true;
+      for (pos++; pos < source.size() && source[pos] != '"'; pos++) {
+        char c = source[pos];
+        if (c == '\\' && pos + 1 < source.size()) {
+          c = source[++pos];
+          switch (c) {
+            case 'n': c = '\n'; break;
+            case 't': c = '\t'; break;
+            case 'r': c = '\r'; break;
+            case 'x': {
+              size_t used = 0;
+              c = (char)std::stoi(source.substr(pos + 1, 2), &used, 16);
+              pos += used;
+              break;
+            }
+            default:
+              if (c >= '0' && c <= '7') {
+                int v = 0;
+                for (int i = 0; i < 3 && pos < source.size() && source[pos] >= '0' && source[pos] <= '7'; i++) {
+                  v = v * 8 + source[pos++] - '0';
+                }
+                pos--;
+                c = (char)v;
+              }
+              break;
+          }
+        }
+        out += c;
+      }
+      pos++;
+      skip_space();
+    }
+    return found;
+  };
+
+  while ((pos = source.find("ANT_LOG", pos)) != std::string::npos) {
+    pos += 7;
+    if (pos + 1 >= source.size() || (source[pos] != 'I' && source[pos] != 'W')) {
+      continue;
+    }
+    LogFormat f{source[pos++], "", ""};
+    skip_space();
+    if (pos >= source.size() || source[pos] != '(') {
+      continue;
+    }
+    pos++;
+    if (!literal(f.tag) || pos >= source.size() || source[pos] != ',') {
+      continue;
+    }
+    pos++;
+    if (!literal(f.format)) {
+      continue;
+    }
+    formats.push_back(f);
+  }
+}
+
+class LogDecoder {
+public:
+  std::map<uint32_t, LogFormat> formats;
+
+  // Adds a format, false if another one has its token
+  bool add(const LogFormat &f) {
+    auto it = formats.emplace(f.token(), f).first;
+    return it->second == f;
+  }
+
+  // Dictionary file: a line per format, "<token in hex> <level> <tag> <format>" separated by tabs, with \\, \t and
+  // \n escaped in the tag and format
+  bool save(const char *path) const {
+    std::ofstream file(path);
+    file << "# ant_log token dictionary, see src-common/log_tokens.hpp\n";
+    char token[16];
+    for (const auto &[t, f] : formats) {
+      snprintf(token, sizeof(token), "%08x", t);
+      file << token << '\t' << f.level << '\t' << escape(f.tag) << '\t' << escape(f.format) << '\n';
+    }
+    return (bool)file;
+  }
+
+  bool load(const char *path) {
+    std::ifstream file(path);
+    if (!file) {
+      return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      size_t t1 = line.find('\t');
+      size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+      size_t t3 = t2 == std::string::npos ? t2 : line.find('\t', t2 + 1);
+      if (t3 == std::string::npos || t2 != t1 + 2) {
+        return false;
+      }
+      LogFormat f{line[t1 + 1], unescape(line.substr(t2 + 1, t3 - t2 - 1)), unescape(line.substr(t3 + 1))};
+      if (f.token() != (uint32_t)std::stoul(line.substr(0, t1), nullptr, 16)) {
+        return false;
+      }
+      formats[f.token()] = f;
+    }
+    return true;
+  }
+
+  // Decodes the records of data, appending a line per record to out as the PC build prints it ("[tag] text"), with
+  // times the timestamp in seconds and the level in front. Unknown tokens and broken records are reported in the text.
+  // Returns the number of records that didn't decode.
+  size_t decode(const uint8_t *data, size_t len, std::string &out, bool times = false) const {
+    size_t errors = 0;
+    size_t pos = 0;
+    while (pos < len) {
+      size_t end = pos + 1 + data[pos];
+      if (end > len || data[pos] < 4) {
+        out += "[ant_log] broken record\n";
+        return errors + 1;
+      }
+      Reader r{data, pos + 1, end};
+      pos = end;
+      uint32_t token = 0;
+      for (int i = 0; i < 4; i++) {
+        token |= (uint32_t)r.byte() << (8 * i);
+      }
+      uint32_t ms = (uint32_t)r.varint();
+      auto it = formats.find(token);
+      std::string text;
+      if (it == formats.end()) {
+        char line[48];
+        snprintf(line, sizeof(line), "[ant_log] unknown token %08x", token);
+        text = line;
+        errors++;
+      } else {
+        text = "[" + it->second.tag + "] ";
+        if (!expand(it->second.format, r, text)) {
+          text += " [ant_log: bad arguments]";
+          errors++;
+        }
+      }
+      if (times) {
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "%10.3f %c ", ms / 1000.0, it == formats.end() ? '?' : it->second.level);
+        out += prefix;
+      }
+      out += text + "\n";
+    }
+    return errors;
+  }
+
+  // Base64 to bytes, false on a character outside the alphabet or a bad length
+  static bool unbase64(const std::string &text, std::vector<uint8_t> &out) {
+    if (text.size() % 4 != 0) {
+      return false;
+    }
+    uint32_t v = 0;
+    int bits = 0;
+    for (char c : text) {
+      int d;
+      if (c >= 'A' && c <= 'Z') {
+        d = c - 'A';
+      } else if (c >= 'a' && c <= 'z') {
+        d = c - 'a' + 26;
+      } else if (c >= '0' && c <= '9') {
+        d = c - '0' + 52;
+      } else if (c == '+' || c == '/') {
+        d = c == '+' ? 62 : 63;
+      } else if (c == '=') {
+        continue;
+      } else {
+        return false;
+      }
+      v = v << 6 | d;
+      bits += 6;
+      if (bits >= 8) {
+        bits -= 8;
+        out.push_back((uint8_t)(v >> bits));
+      }
+    }
+    return true;
+  }
+
+private:
+  struct Reader {
+    const uint8_t *data;
+    size_t pos;
+    size_t end;
+    bool ok = true;
+
+    uint8_t byte() {
+      if (pos >= end) {
+        ok = false;
+        return 0;
+      }
+      return data[pos++];
+    }
+
+    uint64_t varint() {
+      uint64_t v = 0;
+      for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t b = byte();
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+          break;
+        }
+      }
+      return v;
+    }
+
+    int64_t zigzag() {
+      uint64_t v = varint();
+      return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+    }
+  };
+
+  static std::string escape(const std::string &s) {
+    std::string out;
+    for (char c : s) {
+      if (c == '\\' || c == '\t' || c == '\n') {
+        out += '\\';
+        c = c == '\t' ? 't' : c == '\n' ? 'n' : c;
+      }
+      out += c;
+    }
+    return out;
+  }
+
+  static std::string unescape(const std::string &s) {
+    std::string out;
+    for (size_t i = 0; i < s.size(); i++) {
+      char c = s[i];
+      if (c == '\\' && i + 1 < s.size()) {
+        c = s[++i];
+        c = c == 't' ? '\t' : c == 'n' ? '\n' : c;
+      }
+      out += c;
+    }
+    return out;
+  }
+
+  __attribute__((format(printf, 2, 3))) static void append(std::string &out, const char *spec, ...) {
+    char text[128];
+    va_list args;
+    va_start(args, spec);
+    vsnprintf(text, sizeof(text), spec, args);
+    va_end(args);
+    out += text;
+  }
+
+  // Formats the arguments of r with format as printf does. Conversions without a length modifier (and with h, hh)
+  // take 32-bit values, as on the device; l, ll, j, z and t take 64-bit ones.
+  static bool expand(const std::string &format, Reader &r, std::string &out) {
+    for (size_t i = 0; i < format.size(); i++) {
+      if (format[i] != '%') {
+        out += format[i];
+        continue;
+      }
+      if (i + 1 < format.size() && format[i + 1] == '%') {
+        out += '%';
+        i++;
+        continue;
+      }
+      // the conversion without its length modifier
+      std::string spec = "%";
+      size_t j = i + 1;
+      while (j < format.size() && strchr("-+ #0123456789.", format[j])) {
+        spec += format[j++];
+      }
+      bool wide = false;
+      while (j < format.size() && strchr("hljztL", format[j])) {
+        if (format[j] == 'h') {
+          spec += 'h';
+        } else {
+          wide = true;
+        }
+        j++;
+      }
+      if (j >= format.size()) {
+        return false;
+      }
+      char conversion = format[j];
+      i = j;
+      if (strchr("di", conversion)) {
+        int64_t v = r.zigzag();
+        if (wide) {
+          append(out, (spec + "lld").c_str(), (long long)v);
+        } else {
+          append(out, (spec + conversion).c_str(), (int)v);
+        }
+      } else if (strchr("uoxXc", conversion)) {
+        int64_t v = r.zigzag();
+        if (wide && conversion != 'c') {
+          append(out, (spec + "ll" + conversion).c_str(), (unsigned long long)v);
+        } else {
+          append(out, (spec + conversion).c_str(), (unsigned)v);
+        }
+      } else if (strchr("fFeEgGaA", conversion)) {
+        uint32_t bits = 0;
+        for (int b = 0; b < 4; b++) {
+          bits |= (uint32_t)r.byte() << (8 * b);
+        }
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        append(out, (spec + conversion).c_str(), (double)f);
+      } else if (conversion == 's') {
+        size_t n = (size_t)r.varint();
+        std::string s;
+        for (size_t k = 0; k < n && r.ok; k++) {
+          s += (char)r.byte();
+        }
+        append(out, (spec + 's').c_str(), s.c_str());
+      } else {
+        return false;
+      }
+      if (!r.ok) {
+        return false;
+      }
+    }
+    return r.pos == r.end;
+  }
+};
@@ -41,8 +41,50 @@ AntGlobals antg;
 GameManager game_manager(antg);
 
 void update_display() {
+  ANT_PROFILE_SCOPE(ProfileSite::DISPLAY_WRITE);
   game_manager.display_update(my_display);
   my_display.present();
+  input_latency.lcd(esphome::micros());
+}
+
+// A key from the keypad or the buttons, traced like the automations of config.yaml do
+void press(unsigned char key) {
+  input_latency.edge(esphome::micros());
+  game_manager.handle_key(key);
+}
+
+// The press or release edge of a key with long presses (C, D, *), like its binary_sensor in config.yaml: C_DOWN,
+// C_UP, D_DOWN, D_UP, STAR_DOWN, STAR_UP
+bool key_edge(const std::string &token) {
+  static const std::pair<const char *, unsigned char> KEYS[] = {{"C", KEY_C}, {"D", KEY_D}, {"STAR", KEY_STAR}};
+  for (const auto &[name, key] : KEYS) {
+    std::string prefix = std::string(name) + "_";
+    if (token == prefix + "DOWN" || token == prefix + "UP") {
+      game_manager.handle_key_edge(key, token == prefix + "DOWN");
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parses a setup document in the form the web API receives it (key=value&...), and posts it to the game loop
+void post_game_setup(const std::string &query) {
+  std::stringstream ss(query);
+  std::string param;
+  GameSetup setup;
+  const char *error = nullptr;
+  while (!error && std::getline(ss, param, '&')) {
+    size_t eq = param.find('=');
+    error = setup.set(param.substr(0, eq), eq == std::string::npos ? "" : param.substr(eq + 1));
+  }
+  if (!error) {
+    error = setup.validate();
+  }
+  if (error) {
+    printf("[SETUP ERROR: %s]\n", error);
+    return;
+  }
+  game_setup_mailbox.post(setup);
 }
 
 void process_test_sequence(const std::string &sequence) {
@@ -60,24 +102,30 @@ void process_test_sequence(const std::string &sequence) {
       printf("[DELAY %d]\n", delay_ms);
       cur_millis += delay_ms;
       game_manager.clock(cur_millis, delay_ms);
+    } else if (token.rfind("SETUP=", 0) == 0) {
+      // e.g. SETUP=MODE=DEFUSAL&BOMB_MIN=5&START=1, applied on the next DELAY like on the device
+      std::string query = token.substr(6);
+      std::transform(query.begin(), query.end(), query.begin(), [](unsigned char c) { return std::tolower(c); });
+      printf("[SETUP %s]\n", query.c_str());
+      post_game_setup(query);
     } else if (token.length() == 1) {
       printf("[KEY %s]\n", token.c_str());
-      game_manager.handle_key(token[0]);
+      press(token[0]);
     } else {
       printf("[KEY %s]\n", token.c_str());
       if (token == "RED") {
-        game_manager.handle_key(KEY_RED);
+        press(KEY_RED);
       } else if (token == "RED_RELEASE") {
-        game_manager.handle_key(KEY_RED_RELEASE);
+        press(KEY_RED_RELEASE);
       } else if (token == "YELLOW") {
-        game_manager.handle_key(KEY_YELLOW);
+        press(KEY_YELLOW);
       } else if (token == "YELLOW_RELEASE") {
-        game_manager.handle_key(KEY_YELLOW_RELEASE);
+        press(KEY_YELLOW_RELEASE);
       } else if (token == "RESET") {
-        game_manager.handle_key(KEY_RESET);
+        press(KEY_RESET);
       } else if (token == "C_LONG") {
-        game_manager.handle_key(KEY_C_LONG);
-      } else {
+        press(KEY_C_LONG);
+      } else if (!key_edge(token)) {
         printf("ERROR: Unknown test token: %s\n", token.c_str());
       }
     }
@@ -85,15 +133,32 @@ void process_test_sequence(const std::string &sequence) {
   }
 }
 
+// Game loop timings (src-common/profiler.hpp) and input latency (src-common/input_latency.hpp) of the run, on stderr
+// so that the test output stays the same
+bool profile_dump = false;
+
+void dump_profile() {
+  char text[Profiler::MAX_TEXT];
+  profiler.format(text, sizeof(text));
+  fputs(text, stderr);
+  input_latency.format(text, sizeof(text));
+  fputs(text, stderr);
+}
+
 int main(int argc, char *argv[]) {
   set_unbuffered_input();
   atexit(restore_input_buffering);
 
   for (int i = 1; i < argc; ++i) {
     std::string arg = argv[i];
-    if (arg == "--test" && i + 1 < argc) {
+    if (arg == "--profile") {
+      profile_dump = true;
+    } else if (arg == "--test" && i + 1 < argc) {
       std::string sequence = argv[++i];
       process_test_sequence(sequence);
+      if (profile_dump) {
+        dump_profile();
+      }
       return 0; // Exit after sequence
     }
   }
@@ -106,14 +171,19 @@ int main(int argc, char *argv[]) {
     if (read(STDIN_FILENO, &key, 1) > 0) {
       switch (key) {
       case 'q':
-      case 'Q': ESP_LOGI("main", "Exiting interactive mode."); return 0;
-      case 'r': game_manager.handle_key(KEY_RED); break;
-      case 'R': game_manager.handle_key(KEY_RED_RELEASE); break;
-      case 'y': game_manager.handle_key(KEY_YELLOW); break;
-      case 'Y': game_manager.handle_key(KEY_YELLOW_RELEASE); break;
-      case 'x': game_manager.handle_key(KEY_RESET); break;
-      case 'n': game_manager.handle_key(KEY_C_LONG); break;
-      default:  game_manager.handle_key(std::toupper(key)); break;
+      case 'Q':
+        ESP_LOGI("main", "Exiting interactive mode.");
+        if (profile_dump) {
+          dump_profile();
+        }
+        return 0;
+      case 'r': press(KEY_RED); break;
+      case 'R': press(KEY_RED_RELEASE); break;
+      case 'y': press(KEY_YELLOW); break;
+      case 'Y': press(KEY_YELLOW_RELEASE); break;
+      case 'x': press(KEY_RESET); break;
+      case 'n': press(KEY_C_LONG); break;
+      default:  press(std::toupper(key)); break;
       }
     }
 
@@ -0,0 +1,196 @@
+#pragma once
+
+// Stand-in for the part of ArduinoJson 7 that the web_server component uses: documents of objects, arrays and
+// scalars, built through a custom Allocator, and serialized compactly.
+//
+// Like ArduinoJson, a document takes all its memory from its allocator: the values (slots) in one block that grows by
+// reallocate(), and each string and key as a copy of its own.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace ArduinoJson {
+
+class Allocator {
+public:
+  virtual void *allocate(size_t size) = 0;
+  virtual void deallocate(void *ptr) = 0;
+  virtual void *reallocate(void *ptr, size_t new_size) = 0;
+
+protected:
+  ~Allocator() = default;
+};
+
+class JsonDocument;
+class JsonObject;
+class JsonArray;
+
+namespace detail {
+
+enum class Type : uint8_t { NUL, BOOL, INT, UINT, FLOAT, STRING, OBJECT, ARRAY };
+constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+struct Slot {
+  Type type;
+  const char *key;
+  uint32_t next;
+  // containers: the first and the last child
+  uint32_t first;
+  uint32_t last;
+  union {
+    bool b;
+    int64_t i;
+    uint64_t u;
+    double f;
+    const char *s;
+  };
+};
+
+/// A member of an object or an element of an array that may not exist yet, as `root["key"]`.
+class VariantRef {
+public:
+  VariantRef(JsonDocument *doc, uint32_t parent, const char *key) : doc_(doc), parent_(parent), key_(key) {}
+
+  VariantRef &operator=(bool value);
+  VariantRef &operator=(const char *value);
+  VariantRef &operator=(const std::string &value) { return *this = value.c_str(); }
+  VariantRef &operator=(double value);
+  VariantRef &operator=(float value) { return *this = static_cast<double>(value); }
+  template <typename T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value, int> = 0>
+  VariantRef &operator=(T value) {
+    if (std::is_signed<T>::value)
+      this->set_int_(static_cast<int64_t>(value));
+    else
+      this->set_uint_(static_cast<uint64_t>(value));
+    return *this;
+  }
+  template <typename T, std::enable_if_t<std::is_enum<T>::value, int> = 0> VariantRef &operator=(T value) {
+    return *this = static_cast<std::underlying_type_t<T>>(value);
+  }
+
+  template <typename T> T to();
+
+protected:
+  /// The slot of the member, added if it doesn't exist. NO_SLOT if the document is out of memory.
+  uint32_t slot_();
+  void set_int_(int64_t value);
+  void set_uint_(uint64_t value);
+
+  JsonDocument *doc_;
+  uint32_t parent_;
+  const char *key_;
+};
+
+} // namespace detail
+
+class JsonObject {
+public:
+  JsonObject() = default;
+  JsonObject(JsonDocument *doc, uint32_t slot) : doc_(doc), slot_(slot) {}
+
+  detail::VariantRef operator[](const char *key) const { return detail::VariantRef(this->doc_, this->slot_, key); }
+  detail::VariantRef operator[](const std::string &key) const { return (*this)[key.c_str()]; }
+  bool isNull() const { return this->doc_ == nullptr || this->slot_ == detail::NO_SLOT; }
+
+protected:
+  JsonDocument *doc_{nullptr};
+  uint32_t slot_{detail::NO_SLOT};
+};
+
+class JsonArray {
+public:
+  JsonArray() = default;
+  JsonArray(JsonDocument *doc, uint32_t slot) : doc_(doc), slot_(slot) {}
+
+  template <typename T> bool add(T value) {
+    if (this->isNull())
+      return false;
+    detail::VariantRef(this->doc_, this->slot_, nullptr) = value;
+    return true;
+  }
+  template <typename T> T add() { return detail::VariantRef(this->doc_, this->slot_, nullptr).to<T>(); }
+  bool isNull() const { return this->doc_ == nullptr || this->slot_ == detail::NO_SLOT; }
+
+protected:
+  JsonDocument *doc_{nullptr};
+  uint32_t slot_{detail::NO_SLOT};
+};
+
+class JsonDocument {
+public:
+  /// A document with the memory of `allocator`, of the heap if nullptr.
+  explicit JsonDocument(Allocator *allocator = nullptr);
+  ~JsonDocument();
+  JsonDocument(const JsonDocument &) = delete;
+  JsonDocument &operator=(const JsonDocument &) = delete;
+
+  /// Empties the document and makes its root an object or an array.
+  template <typename T> T to();
+  /// Whether an allocation failed, the document misses values then.
+  bool overflowed() const { return this->overflowed_; }
+
+  // Used by the values of the document
+  uint32_t add_slot(uint32_t parent, const char *key);
+  uint32_t find_member(uint32_t parent, const char *key) const;
+  const char *copy_string(const char *str);
+  detail::Slot &slot(uint32_t index) { return this->slots_[index]; }
+  const detail::Slot &slot(uint32_t index) const { return this->slots_[index]; }
+  bool empty() const { return this->count_ == 0; }
+
+protected:
+  void clear_();
+
+  Allocator *allocator_;
+  detail::Slot *slots_{nullptr};
+  uint32_t count_{0};
+  uint32_t capacity_{0};
+  bool overflowed_{false};
+};
+
+template <> inline JsonObject JsonDocument::to<JsonObject>() {
+  this->clear_();
+  uint32_t root = this->add_slot(detail::NO_SLOT, nullptr);
+  if (root != detail::NO_SLOT)
+    this->slots_[root].type = detail::Type::OBJECT;
+  return JsonObject(this, root);
+}
+
+template <> inline JsonArray JsonDocument::to<JsonArray>() {
+  this->clear_();
+  uint32_t root = this->add_slot(detail::NO_SLOT, nullptr);
+  if (root != detail::NO_SLOT)
+    this->slots_[root].type = detail::Type::ARRAY;
+  return JsonArray(this, root);
+}
+
+template <> inline JsonObject detail::VariantRef::to<JsonObject>() {
+  uint32_t slot = this->slot_();
+  if (slot != NO_SLOT) {
+    Slot &s = this->doc_->slot(slot);
+    s.type = Type::OBJECT;
+    s.first = s.last = NO_SLOT;
+  }
+  return JsonObject(this->doc_, slot);
+}
+
+template <> inline JsonArray detail::VariantRef::to<JsonArray>() {
+  uint32_t slot = this->slot_();
+  if (slot != NO_SLOT) {
+    Slot &s = this->doc_->slot(slot);
+    s.type = Type::ARRAY;
+    s.first = s.last = NO_SLOT;
+  }
+  return JsonArray(this->doc_, slot);
+}
+
+/// Length of the compact serialization, without a terminator.
+size_t measureJson(const JsonDocument &doc);
+/// Appends the compact serialization to `output`.
+size_t serializeJson(const JsonDocument &doc, std::string &output);
+
+} // namespace ArduinoJson
+
+using namespace ArduinoJson; // NOLINT(google-global-names-in-headers)
@@ -0,0 +1,299 @@
+// The ArduinoJson stand-in of the host build of the web_server component, see ArduinoJson.h.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "ArduinoJson.h"
+#include "esphome/components/json/json_util.h"
+
+namespace ArduinoJson {
+
+namespace {
+
+/// The heap, through operator new so that programs counting allocations see the documents. The size is kept in front
+/// of the block for reallocate().
+class HeapAllocator : public Allocator {
+public:
+  void *allocate(size_t size) override {
+    auto *block = static_cast<size_t *>(::operator new(sizeof(max_align_t) + size, std::nothrow));
+    if (block == nullptr)
+      return nullptr;
+    *block = size;
+    return reinterpret_cast<uint8_t *>(block) + sizeof(max_align_t);
+  }
+  void deallocate(void *ptr) override {
+    if (ptr != nullptr)
+      ::operator delete(static_cast<uint8_t *>(ptr) - sizeof(max_align_t));
+  }
+  void *reallocate(void *ptr, size_t new_size) override {
+    void *moved = this->allocate(new_size);
+    if (moved != nullptr && ptr != nullptr) {
+      size_t old_size = *reinterpret_cast<size_t *>(static_cast<uint8_t *>(ptr) - sizeof(max_align_t));
+      memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+      this->deallocate(ptr);
+    }
+    return moved;
+  }
+};
+
+HeapAllocator heap_allocator;
+
+// Slots of a new document, and the most it adds at once
+constexpr uint32_t INITIAL_SLOTS = 8;
+constexpr uint32_t MAX_GROWTH = 64;
+
+} // namespace
+
+JsonDocument::JsonDocument(Allocator *allocator) : allocator_(allocator != nullptr ? allocator : &heap_allocator) {}
+
+JsonDocument::~JsonDocument() {
+  this->clear_();
+  this->allocator_->deallocate(this->slots_);
+}
+
+void JsonDocument::clear_() {
+  for (uint32_t i = 0; i < this->count_; i++) {
+    detail::Slot &s = this->slots_[i];
+    this->allocator_->deallocate(const_cast<char *>(s.key));
+    if (s.type == detail::Type::STRING)
+      this->allocator_->deallocate(const_cast<char *>(s.s));
+  }
+  this->count_ = 0;
+}
+
+const char *JsonDocument::copy_string(const char *str) {
+  size_t len = strlen(str);
+  auto *copy = static_cast<char *>(this->allocator_->allocate(len + 1));
+  if (copy == nullptr) {
+    this->overflowed_ = true;
+    return nullptr;
+  }
+  memcpy(copy, str, len + 1);
+  return copy;
+}
+
+uint32_t JsonDocument::add_slot(uint32_t parent, const char *key) {
+  if (this->count_ == this->capacity_) {
+    uint32_t capacity = this->capacity_ == 0 ? INITIAL_SLOTS : this->capacity_ + std::min(this->capacity_, MAX_GROWTH);
+    void *slots = this->allocator_->reallocate(this->slots_, capacity * sizeof(detail::Slot));
+    if (slots == nullptr) {
+      this->overflowed_ = true;
+      return detail::NO_SLOT;
+    }
+    this->slots_ = static_cast<detail::Slot *>(slots);
+    this->capacity_ = capacity;
+  }
+  const char *key_copy = nullptr;
+  if (key != nullptr && (key_copy = this->copy_string(key)) == nullptr)
+    return detail::NO_SLOT;
+
+  uint32_t index = this->count_++;
+  detail::Slot &s = this->slots_[index];
+  s.type = detail::Type::NUL;
+  s.key = key_copy;
+  s.next = s.first = s.last = detail::NO_SLOT;
+  s.u = 0;
+  if (parent != detail::NO_SLOT) {
+    detail::Slot &p = this->slots_[parent];
+    if (p.last == detail::NO_SLOT) {
+      p.first = index;
+    } else {
+      this->slots_[p.last].next = index;
+    }
+    p.last = index;
+  }
+  return index;
+}
+
+uint32_t JsonDocument::find_member(uint32_t parent, const char *key) const {
+  for (uint32_t i = this->slots_[parent].first; i != detail::NO_SLOT; i = this->slots_[i].next) {
+    if (strcmp(this->slots_[i].key, key) == 0)
+      return i;
+  }
+  return detail::NO_SLOT;
+}
+
+namespace detail {
+
+uint32_t VariantRef::slot_() {
+  if (this->doc_ == nullptr || this->parent_ == NO_SLOT)
+    return NO_SLOT;
+  Slot &parent = this->doc_->slot(this->parent_);
+  if (parent.type != Type::OBJECT && parent.type != Type::ARRAY)
+    return NO_SLOT;
+  if (parent.type == Type::OBJECT) {
+    uint32_t member = this->doc_->find_member(this->parent_, this->key_);
+    if (member != NO_SLOT)
+      return member;
+  }
+  return this->doc_->add_slot(this->parent_, parent.type == Type::OBJECT ? this->key_ : nullptr);
+}
+
+VariantRef &VariantRef::operator=(bool value) {
+  uint32_t slot = this->slot_();
+  if (slot != NO_SLOT) {
+    this->doc_->slot(slot).type = Type::BOOL;
+    this->doc_->slot(slot).b = value;
+  }
+  return *this;
+}
+
+VariantRef &VariantRef::operator=(const char *value) {
+  uint32_t slot = this->slot_();
+  if (slot == NO_SLOT)
+    return *this;
+  if (value == nullptr) {
+    this->doc_->slot(slot).type = Type::NUL;
+    return *this;
+  }
+  const char *copy = this->doc_->copy_string(value);
+  if (copy != nullptr) {
+    this->doc_->slot(slot).type = Type::STRING;
+    this->doc_->slot(slot).s = copy;
+  }
+  return *this;
+}
+
+VariantRef &VariantRef::operator=(double value) {
+  uint32_t slot = this->slot_();
+  if (slot != NO_SLOT) {
+    this->doc_->slot(slot).type = Type::FLOAT;
+    this->doc_->slot(slot).f = value;
+  }
+  return *this;
+}
+
+void VariantRef::set_int_(int64_t value) {
+  uint32_t slot = this->slot_();
+  if (slot != NO_SLOT) {
+    this->doc_->slot(slot).type = Type::INT;
+    this->doc_->slot(slot).i = value;
+  }
+}
+
+void VariantRef::set_uint_(uint64_t value) {
+  uint32_t slot = this->slot_();
+  if (slot != NO_SLOT) {
+    this->doc_->slot(slot).type = Type::UINT;
+    this->doc_->slot(slot).u = value;
+  }
+}
+
+} // namespace detail
+
+namespace {
+
+class Writer {
+public:
+  explicit Writer(std::string *out) : out_(out) {}
+
+  void write(const JsonDocument &doc, uint32_t index) {
+    const detail::Slot &s = doc.slot(index);
+    char number[32];
+    switch (s.type) {
+    case detail::Type::NUL: this->raw("null"); break;
+    case detail::Type::BOOL: this->raw(s.b ? "true" : "false"); break;
+    case detail::Type::INT: this->raw(number, snprintf(number, sizeof(number), "%lld", (long long) s.i)); break;
+    case detail::Type::UINT:
+      this->raw(number, snprintf(number, sizeof(number), "%llu", (unsigned long long) s.u));
+      break;
+    case detail::Type::FLOAT:
+      // like ArduinoJson without ARDUINOJSON_ENABLE_NAN
+      if (std::isfinite(s.f)) {
+        this->raw(number, snprintf(number, sizeof(number), "%.9g", s.f));
+      } else {
+        this->raw("null");
+      }
+      break;
+    case detail::Type::STRING: this->string(s.s); break;
+    case detail::Type::OBJECT:
+    case detail::Type::ARRAY: {
+      bool object = s.type == detail::Type::OBJECT;
+      this->raw(object ? "{" : "[");
+      for (uint32_t i = s.first; i != detail::NO_SLOT; i = doc.slot(i).next) {
+        if (i != s.first)
+          this->raw(",");
+        if (object) {
+          this->string(doc.slot(i).key);
+          this->raw(":");
+        }
+        this->write(doc, i);
+      }
+      this->raw(object ? "}" : "]");
+      break;
+    }
+    }
+  }
+
+  size_t length() const { return this->length_; }
+
+protected:
+  void raw(const char *str) { this->raw(str, strlen(str)); }
+  void raw(const char *str, size_t len) {
+    if (this->out_ != nullptr)
+      this->out_->append(str, len);
+    this->length_ += len;
+  }
+  void string(const char *str) {
+    this->raw("\"");
+    for (const char *c = str; *c != '\0'; c++) {
+      switch (*c) {
+      case '"': this->raw("\\\""); break;
+      case '\\': this->raw("\\\\"); break;
+      case '\n': this->raw("\\n"); break;
+      case '\r': this->raw("\\r"); break;
+      case '\t': this->raw("\\t"); break;
+      default:
+        if (static_cast<unsigned char>(*c) < 0x20) {
+          char escaped[8];
+          this->raw(escaped, snprintf(escaped, sizeof(escaped), "\\u%04x", *c));
+        } else {
+          this->raw(c, 1);
+        }
+      }
+    }
+    this->raw("\"");
+  }
+
+  std::string *out_;
+  size_t length_{0};
+};
+
+} // namespace
+
+size_t measureJson(const JsonDocument &doc) {
+  if (doc.empty())
+    return 4; // null
+  Writer writer(nullptr);
+  writer.write(doc, 0);
+  return writer.length();
+}
+
+size_t serializeJson(const JsonDocument &doc, std::string &output) {
+  if (doc.empty()) {
+    output += "null";
+    return 4;
+  }
+  Writer writer(&output);
+  writer.write(doc, 0);
+  return writer.length();
+}
+
+} // namespace ArduinoJson
+
+namespace esphome {
+namespace json {
+
+std::string build_json(const json_build_t &f) {
+  JsonDocument doc;
+  JsonObject root = doc.to<JsonObject>();
+  f(root);
+  std::string output;
+  serializeJson(doc, output);
+  return output;
+}
+
+} // namespace json
+} // namespace esphome
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+struct esp_app_desc_t {
+  char version[32];
+  char project_name[32];
+  uint8_t app_elf_sha256[32];
+};
+
+const esp_app_desc_t *esp_app_get_description();
+
+/// host: sets the ELF hash of the running app, that delta patches are checked against.
+void esp_app_set_elf_sha256(const uint8_t sha256[32]);
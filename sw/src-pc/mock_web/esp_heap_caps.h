@@ -0,0 +1,11 @@
+#pragma once
+
+// Stand-ins for the heap statistics of ESP-IDF. The host heap has no comparable numbers, they are always 0.
+
+#include <cstddef>
+#include <cstdint>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+
+inline size_t heap_caps_get_free_size(uint32_t caps) { return 0; }
+inline size_t heap_caps_get_largest_free_block(uint32_t caps) { return 0; }
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "esp_partition.h"
+
+/// The running app partition, nullptr until esp_ota_set_running_image() is called.
+const esp_partition_t *esp_ota_get_running_partition();
+
+/// host: sets the contents of the running app partition, the base image of delta OTA updates.
+void esp_ota_set_running_image(const uint8_t *data, uint32_t size);
@@ -0,0 +1,32 @@
+#pragma once
+
+// Stand-ins for the ESP-IDF partition API, as far as the web server OTA uses it. The running app partition is a
+// buffer of the program, see esp_ota_set_running_image() in esp_ota_ops.h.
+
+#include <cstddef>
+#include <cstdint>
+
+using esp_err_t = int;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+struct esp_partition_t {
+  uint32_t address;
+  uint32_t size;
+  uint32_t erase_size;
+  char label[17];
+  // host: the contents
+  const uint8_t *data;
+};
+
+using esp_partition_mmap_handle_t = uint32_t;
+
+enum esp_partition_mmap_memory_t {
+  ESP_PARTITION_MMAP_DATA,
+  ESP_PARTITION_MMAP_INST,
+};
+
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size,
+                             esp_partition_mmap_memory_t memory, const void **out_ptr,
+                             esp_partition_mmap_handle_t *out_handle);
+void esp_partition_munmap(esp_partition_mmap_handle_t handle);
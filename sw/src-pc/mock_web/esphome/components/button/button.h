@@ -0,0 +1,21 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "esphome/core/entity_base.h"
+
+namespace esphome {
+namespace button {
+
+class Button : public EntityBase {
+public:
+  void press();
+  void add_on_press_callback(std::function<void()> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+
+protected:
+  std::vector<std::function<void()>> callbacks_;
+};
+
+} // namespace button
+} // namespace esphome
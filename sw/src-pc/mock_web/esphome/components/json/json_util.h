@@ -0,0 +1,17 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include <ArduinoJson.h>
+
+namespace esphome {
+namespace json {
+
+using json_build_t = std::function<void(JsonObject)>;
+
+/// Builds a JSON object in a document on the heap and serializes it.
+std::string build_json(const json_build_t &f);
+
+} // namespace json
+} // namespace esphome
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace logger {
+
+/// Hands the log lines to the callbacks, and prints those up to a level to stderr.
+class Logger {
+public:
+  void add_on_log_callback(std::function<void(uint8_t, const char *, const char *, size_t)> &&callback) {
+    this->callbacks_.push_back(std::move(callback));
+  }
+  /// Most verbose level printed, ESPHOME_LOG_LEVEL_WARN by default.
+  void set_print_level(int level) { this->print_level_ = level; }
+  /// Forgets the callbacks, for programs that set up several web servers in a row.
+  void clear_callbacks() { this->callbacks_.clear(); }
+
+  void log_vprintf(int level, const char *tag, int line, const char *format, va_list args);
+
+protected:
+  std::vector<std::function<void(uint8_t, const char *, const char *, size_t)>> callbacks_;
+  int print_level_{ESPHOME_LOG_LEVEL_WARN};
+};
+
+extern Logger *global_logger; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+} // namespace logger
+} // namespace esphome
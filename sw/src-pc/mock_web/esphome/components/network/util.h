@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+namespace esphome {
+namespace network {
+
+std::string get_use_address();
+
+} // namespace network
+} // namespace esphome
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace ota {
+
+enum OTAResponseTypes {
+  OTA_RESPONSE_OK = 0x00,
+  OTA_RESPONSE_ERROR_MAGIC = 0x80,
+  OTA_RESPONSE_ERROR_UPDATE_PREPARE = 0x81,
+  OTA_RESPONSE_ERROR_AUTH_INVALID = 0x82,
+  OTA_RESPONSE_ERROR_WRITING_FLASH = 0x83,
+  OTA_RESPONSE_ERROR_UPDATE_END = 0x84,
+  OTA_RESPONSE_ERROR_ESP32_NOT_ENOUGH_SPACE = 0x89,
+  OTA_RESPONSE_ERROR_NO_UPDATE_PARTITION = 0x8A,
+  OTA_RESPONSE_ERROR_MD5_MISMATCH = 0x8B,
+  OTA_RESPONSE_ERROR_UNKNOWN = 0xFF,
+};
+
+enum OTAState {
+  OTA_COMPLETED = 0,
+  OTA_STARTED,
+  OTA_IN_PROGRESS,
+  OTA_ABORT,
+  OTA_ERROR,
+};
+
+class OTABackend {
+public:
+  virtual ~OTABackend() = default;
+  virtual OTAResponseTypes begin(size_t image_size) = 0;
+  virtual void set_update_md5(const char *md5) {}
+  virtual OTAResponseTypes write(uint8_t *data, size_t len) = 0;
+  virtual OTAResponseTypes end() = 0;
+  virtual void abort() = 0;
+  virtual bool supports_compression() { return false; }
+};
+
+/// A backend that writes into the image of the host "update partition", see updated_image(). Writing takes the time of
+/// the flash model, see set_flash_model().
+std::unique_ptr<OTABackend> make_ota_backend();
+
+/// What the last successful OTA update wrote, empty before the first one.
+const std::vector<uint8_t> &updated_image();
+
+/// host: timing of the flash behind the backend. esp_ota_write() erases each 4 KiB sector before the first write to it
+/// and programs 256 byte pages. Writing lets the time pass with host_advance_time(). All 0 by default.
+struct FlashModel {
+  static constexpr size_t SECTOR_SIZE = 4096;
+  static constexpr size_t PAGE_SIZE = 256;
+
+  uint32_t sector_erase_us{0};
+  uint32_t page_program_us{0};
+  /// per esp_ota_write() call: locking the flash, disabling the cache
+  uint32_t write_call_us{0};
+};
+
+/// host: what the backend did since reset_flash_stats().
+struct FlashStats {
+  uint32_t begins{0};
+  uint32_t writes{0};
+  uint32_t erases{0};
+  uint32_t pages{0};
+  uint64_t busy_us{0};
+};
+
+void set_flash_model(const FlashModel &model);
+const FlashStats &flash_stats();
+void reset_flash_stats();
+
+class OTAComponent : public Component {
+#ifdef USE_OTA_STATE_CALLBACK
+public:
+  void add_on_state_callback(std::function<void(OTAState, float, uint8_t)> &&callback) {
+    this->state_callback_.add(std::move(callback));
+  }
+
+protected:
+  /// Calls the callbacks in the main loop, the state changes in the task of the OTA platform.
+  class StateCallbackManager : public CallbackManager<void(OTAState, float, uint8_t)> {
+  public:
+    explicit StateCallbackManager(OTAComponent *component) : component_(component) {}
+    void call_deferred(OTAState state, float progress, uint8_t error) {
+      this->component_->defer([this, state, progress, error]() { this->call(state, progress, error); });
+    }
+
+  protected:
+    OTAComponent *component_;
+  };
+
+  StateCallbackManager state_callback_{this};
+#endif
+};
+
+#ifdef USE_OTA_STATE_CALLBACK
+void register_ota_platform(OTAComponent *ota_caller);
+#endif
+
+} // namespace ota
+} // namespace esphome
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "esphome/core/entity_base.h"
+
+namespace esphome {
+namespace switch_ {
+
+/// A switch that takes whatever state it is set to.
+class Switch : public EntityBase {
+public:
+  void turn_on() { this->write_state(true); }
+  void turn_off() { this->write_state(false); }
+  void toggle() { this->write_state(!this->state); }
+  /// Sets the state and calls the callbacks, also if it didn't change.
+  void publish_state(bool state);
+  void add_on_state_callback(std::function<void(bool)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  bool assumed_state() { return false; }
+
+  bool state{false};
+
+protected:
+  virtual void write_state(bool state) { this->publish_state(state); }
+
+  std::vector<std::function<void(bool)>> callbacks_;
+};
+
+} // namespace switch_
+} // namespace esphome
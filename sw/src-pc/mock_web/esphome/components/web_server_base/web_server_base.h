@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "esphome/components/json/json_util.h"
+#include "esphome/components/web_server_idf/web_server_idf.h"
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace web_server_base {
+
+class WebServerBase : public Component {
+public:
+  WebServerBase();
+
+  /// Makes the server and adds the handlers, once.
+  void init();
+  std::shared_ptr<AsyncWebServer> get_server() const { return this->server_; }
+  void add_handler(AsyncWebHandler *handler);
+  void set_port(uint16_t port) { this->port_ = port; }
+  uint16_t get_port() const { return this->port_; }
+
+protected:
+  uint16_t port_{80};
+  std::shared_ptr<AsyncWebServer> server_{nullptr};
+  std::vector<AsyncWebHandler *> handlers_;
+};
+
+extern WebServerBase *global_web_server_base; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+} // namespace web_server_base
+} // namespace esphome
@@ -0,0 +1,268 @@
+#pragma once
+
+// Stand-in for the ESP-IDF AsyncWebServer of esphome, without sockets: requests are objects that a program hands to
+// AsyncWebServer::handle(), which runs them through the handlers as the httpd task does, and keeps the response in the
+// request. Event source clients queue their events in a modelled TCP send buffer, which the program reads out.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "esphome/core/defines.h"
+#include "esphome/core/helpers.h"
+
+enum http_method {
+  HTTP_DELETE = 0,
+  HTTP_GET = 1,
+  HTTP_HEAD = 2,
+  HTTP_POST = 3,
+  HTTP_PUT = 4,
+  HTTP_OPTIONS = 6,
+};
+
+namespace esphome {
+namespace web_server {
+class WebServer;
+class ListEntitiesIterator;
+} // namespace web_server
+
+namespace web_server_idf {
+
+using String = std::string;
+
+class AsyncEventSourceResponse;
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(std::string name, std::string value) : name_(std::move(name)), value_(std::move(value)) {}
+  const std::string &name() const { return this->name_; }
+  const std::string &value() const { return this->value_; }
+
+protected:
+  std::string name_;
+  std::string value_;
+};
+
+class AsyncWebServerResponse {
+public:
+  AsyncWebServerResponse(int code, const char *content_type, const uint8_t *data, size_t size)
+      : code_(code), content_type_(content_type != nullptr ? content_type : ""), data_(data), size_(size) {}
+  void addHeader(const char *name, const char *value) { this->headers_.emplace_back(name, value); }
+
+  int code() const { return this->code_; }
+  const std::string &content_type() const { return this->content_type_; }
+  const uint8_t *data() const { return this->data_; }
+  size_t size() const { return this->size_; }
+  const std::vector<std::pair<std::string, std::string>> &headers() const { return this->headers_; }
+
+protected:
+  int code_;
+  std::string content_type_;
+  const uint8_t *data_;
+  size_t size_;
+  std::vector<std::pair<std::string, std::string>> headers_;
+};
+
+/** An HTTP request, made by the program and answered by the handlers.
+ *
+ * The response body is copied into a buffer of the request that is reserved when the request is made, so that a
+ * program measuring the allocations of the handlers doesn't count the copy.
+ */
+class AsyncWebServerRequest {
+public:
+  static constexpr size_t BODY_RESERVE = 8192;
+
+  /// @param url The path, optionally with a query string.
+  AsyncWebServerRequest(http_method method, const std::string &url);
+
+  // Made by the program
+  void add_header(const std::string &name, const std::string &value) { this->headers_[name] = value; }
+  void set_content_length(size_t length) { this->content_length_ = length; }
+
+  http_method method() const { return this->method_; }
+  const std::string &url() const { return this->url_; }
+  size_t contentLength() const { return this->content_length_; }
+  bool hasParam(const std::string &name) const { return this->find_param_(name) != nullptr; }
+  AsyncWebParameter *getParam(const std::string &name) { return this->find_param_(name); }
+  bool hasArg(const char *name) const { return this->hasParam(name); }
+  std::string arg(const std::string &name) const;
+  bool hasHeader(const char *name) const { return this->headers_.count(name) != 0; }
+  optional<std::string> get_header(const char *name) const;
+
+  AsyncWebServerResponse *beginResponse(int code, const char *content_type, const uint8_t *data, size_t size) {
+    return new AsyncWebServerResponse(code, content_type, data, size); // NOLINT
+  }
+  AsyncWebServerResponse *beginResponse(int code, const char *content_type, const char *content = "") {
+    return this->beginResponse(code, content_type, reinterpret_cast<const uint8_t *>(content), strlen(content));
+  }
+  /// Sends the response and deletes it.
+  void send(AsyncWebServerResponse *response);
+  void send(int code, const char *content_type = nullptr, const char *content = nullptr);
+
+  // The result, for the program
+  bool sent() const { return this->code_ != 0; }
+  int code() const { return this->code_; }
+  const std::string &content_type() const { return this->content_type_; }
+  const std::string &body() const { return this->body_; }
+  /// A header of the response, empty if there is none.
+  std::string response_header(const std::string &name) const;
+  /// The /events client the request became, nullptr if none.
+  AsyncEventSourceResponse *event_client() const { return this->event_client_; }
+  void set_event_client(AsyncEventSourceResponse *client) { this->event_client_ = client; }
+
+protected:
+  AsyncWebParameter *find_param_(const std::string &name) const;
+
+  http_method method_;
+  std::string url_;
+  size_t content_length_{0};
+  mutable std::vector<AsyncWebParameter> params_;
+  std::map<std::string, std::string> headers_;
+
+  int code_{0};
+  std::string content_type_;
+  std::string body_;
+  std::vector<std::pair<std::string, std::string>> response_headers_;
+  AsyncEventSourceResponse *event_client_{nullptr};
+};
+
+class AsyncWebHandler {
+public:
+  virtual ~AsyncWebHandler() = default;
+  virtual bool canHandle(AsyncWebServerRequest *request) const { return false; }
+  virtual void handleRequest(AsyncWebServerRequest *request) {}
+  virtual void handleUpload(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data,
+                            size_t len, bool final) {}
+  // NOLINTNEXTLINE(readability-identifier-naming)
+  virtual bool isRequestHandlerTrivial() const { return true; }
+};
+
+class AsyncWebServer {
+public:
+  explicit AsyncWebServer(uint16_t port) : port_(port) {}
+
+  void begin() {}
+  void end() {}
+  void addHandler(AsyncWebHandler *handler) { this->handlers_.push_back(handler); }
+
+  /// Runs a request through the first handler that takes it, as the httpd task does. 404 if none does.
+  void handle(AsyncWebServerRequest *request);
+  /// Runs a multipart file upload: the handler gets the file in chunks of `chunk` bytes, then the request.
+  void handle_upload(AsyncWebServerRequest *request, const std::string &filename, const uint8_t *data, size_t len,
+                     size_t chunk);
+  /// The same in chunks of the given sizes, which add up to the length of the file. `between` runs before each chunk
+  /// but the first, while the server waits for the network.
+  void handle_upload(AsyncWebServerRequest *request, const std::string &filename, const uint8_t *data,
+                     const std::vector<size_t> &chunks, const std::function<void()> &between);
+
+protected:
+  void upload_(AsyncWebServerRequest *request, const std::string &filename, const uint8_t *data, size_t len,
+               const std::function<size_t(size_t index)> &chunk_at, const std::function<void()> &between);
+  AsyncWebHandler *find_handler_(AsyncWebServerRequest *request) const;
+
+  uint16_t port_;
+  std::vector<AsyncWebHandler *> handlers_;
+};
+
+using message_generator_t = std::string(esphome::web_server::WebServer *, void *);
+
+class AsyncEventSource;
+
+/** A client of an event source.
+ *
+ * As in esphome, an event is formatted into a buffer and sent from there; try_send_nodefer() fails while the previous
+ * event is still in the buffer. Sending copies from the buffer into the TCP send buffer of the client, which is of
+ * the lwIP default size and is emptied by read().
+ */
+class AsyncEventSourceResponse {
+  friend class AsyncEventSource;
+
+public:
+  /// TCP_SND_BUF of the ESP-IDF lwIP default configuration.
+  static constexpr size_t SEND_BUFFER = 5744;
+
+  bool try_send_nodefer(const char *message, const char *event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+  void deferrable_send_state(void *source, const char *event_type, message_generator_t *message_generator);
+  void loop();
+
+  // The client side, for the program
+  /// Takes up to `max` bytes of the text/event-stream out of the send buffer.
+  std::string read(size_t max = SEND_BUFFER);
+  /// Disconnects, the client is removed by the next loop() of the event source.
+  void close() { this->closed_ = true; }
+  bool closed() const { return this->closed_; }
+
+protected:
+  AsyncEventSourceResponse(const AsyncWebServerRequest *request, AsyncEventSource *server,
+                           esphome::web_server::WebServer *ws);
+  ~AsyncEventSourceResponse();
+
+  struct DeferredEvent {
+    void *source;
+    message_generator_t *message_generator;
+    bool operator==(const DeferredEvent &other) const {
+      return this->source == other.source && this->message_generator == other.message_generator;
+    }
+  };
+
+  /// Moves as much of the event buffer into the send buffer as fits.
+  void process_buffer_();
+  void process_deferred_queue_();
+
+  AsyncEventSource *server_;
+  esphome::web_server::WebServer *web_server_;
+  std::unique_ptr<esphome::web_server::ListEntitiesIterator> entities_iterator_;
+  std::vector<DeferredEvent> deferred_queue_;
+  std::string event_buffer_;
+  size_t event_bytes_sent_{0};
+  std::string send_buffer_;
+  bool closed_{false};
+};
+
+using AsyncEventSourceClient = AsyncEventSourceResponse;
+
+class AsyncEventSource : public AsyncWebHandler {
+  friend class AsyncEventSourceResponse;
+
+public:
+  using connect_handler_t = std::function<void(AsyncEventSourceClient *)>;
+
+  AsyncEventSource(std::string url, esphome::web_server::WebServer *ws) : url_(std::move(url)), web_server_(ws) {}
+  ~AsyncEventSource() override;
+
+  bool canHandle(AsyncWebServerRequest *request) const override {
+    return request->method() == HTTP_GET && request->url() == this->url_;
+  }
+  void handleRequest(AsyncWebServerRequest *request) override;
+  void onConnect(connect_handler_t cb) { this->on_connect_ = std::move(cb); }
+
+  void try_send_nodefer(const char *message, const char *event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+  void deferrable_send_state(void *source, const char *event_type, message_generator_t *message_generator);
+  /// Runs the clients and removes the ones that disconnected.
+  void loop();
+
+  bool empty() const { return this->count() == 0; }
+  size_t count() const { return this->sessions_.size(); }
+
+  /// Runs between onConnect() and adding the client, where the main loop can run on the device while the httpd task
+  /// connects a client. For tests of that gap.
+  static inline std::function<void()> connect_gap{};
+
+protected:
+  std::string url_;
+  std::set<AsyncEventSourceResponse *> sessions_;
+  connect_handler_t on_connect_{};
+  esphome::web_server::WebServer *web_server_;
+};
+
+} // namespace web_server_idf
+} // namespace esphome
+
+using namespace esphome::web_server_idf; // NOLINT(google-global-names-in-headers)
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "esphome/core/component.h"
+#include "esphome/core/controller.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+
+/// The entities, components and scheduler of the host build. Everything runs in loop(), on the thread that calls it;
+/// only defer() may be called from other threads.
+class Application {
+public:
+  void pre_setup(const std::string &name, const std::string &friendly_name, const char *comment);
+  void register_component(Component *component) { this->components_.push_back(component); }
+#ifdef USE_BINARY_SENSOR
+  void register_binary_sensor(binary_sensor::BinarySensor *obj) { this->binary_sensors_.push_back(obj); }
+  const std::vector<binary_sensor::BinarySensor *> &get_binary_sensors() { return this->binary_sensors_; }
+#endif
+#ifdef USE_SWITCH
+  void register_switch(switch_::Switch *obj) { this->switches_.push_back(obj); }
+  const std::vector<switch_::Switch *> &get_switches() { return this->switches_; }
+#endif
+#ifdef USE_BUTTON
+  void register_button(button::Button *obj) { this->buttons_.push_back(obj); }
+  const std::vector<button::Button *> &get_buttons() { return this->buttons_; }
+#endif
+
+  /// Sets up the components in the order of their setup priority.
+  void setup();
+  /// Runs the due timers, the deferred calls and the loop() of each component.
+  void loop();
+  /// Forgets the components, entities and timers, for programs that set up several applications in a row.
+  void reset();
+
+  const std::string &get_name() const { return this->name_; }
+  const std::string &get_friendly_name() const { return this->friendly_name_; }
+  std::string get_comment() const { return this->comment_; }
+
+  /// Counted instead of rebooting.
+  void safe_reboot() { this->reboots_++; }
+  uint32_t reboots() const { return this->reboots_; }
+
+  // Used by Component
+  void add_timer(Component *component, const std::string &name, uint32_t interval, bool repeat,
+                 std::function<void()> &&f);
+  void add_deferred(std::function<void()> &&f);
+
+protected:
+  struct Timer {
+    Component *component;
+    std::string name;
+    uint32_t interval;
+    uint32_t next;
+    bool repeat;
+    std::function<void()> f;
+  };
+
+  std::string name_;
+  std::string friendly_name_;
+  std::string comment_;
+  std::vector<Component *> components_;
+#ifdef USE_BINARY_SENSOR
+  std::vector<binary_sensor::BinarySensor *> binary_sensors_;
+#endif
+#ifdef USE_SWITCH
+  std::vector<switch_::Switch *> switches_;
+#endif
+#ifdef USE_BUTTON
+  std::vector<button::Button *> buttons_;
+#endif
+  std::vector<Timer> timers_;
+  Mutex deferred_lock_;
+  std::vector<std::function<void()>> deferred_;
+  std::vector<std::function<void()>> running_;
+  uint32_t reboots_{0};
+};
+
+extern Application App; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+} // namespace esphome
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "esphome/core/controller.h"
+#include "esphome/core/defines.h"
+
+namespace esphome {
+
+/// Visits the entities of App, one per advance().
+class ComponentIterator {
+public:
+  virtual ~ComponentIterator() = default;
+
+  void begin(bool include_internal = false);
+  void advance();
+  virtual bool on_begin() { return true; }
+#ifdef USE_BINARY_SENSOR
+  virtual bool on_binary_sensor(binary_sensor::BinarySensor *binary_sensor) = 0;
+#endif
+#ifdef USE_SWITCH
+  virtual bool on_switch(switch_::Switch *a_switch) = 0;
+#endif
+#ifdef USE_BUTTON
+  virtual bool on_button(button::Button *button) = 0;
+#endif
+  virtual bool on_end() { return true; }
+
+protected:
+  enum class IteratorState {
+    NONE = 0,
+    BEGIN,
+#ifdef USE_BINARY_SENSOR
+    BINARY_SENSOR,
+#endif
+#ifdef USE_SWITCH
+    SWITCH,
+#endif
+#ifdef USE_BUTTON
+    BUTTON,
+#endif
+    MAX,
+  } state_{IteratorState::NONE};
+  size_t at_{0};
+  bool include_internal_{false};
+
+  template <typename T> void advance_(const std::vector<T *> &entities, bool (ComponentIterator::*on)(T *));
+};
+
+} // namespace esphome
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_BINARY_SENSOR
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#endif
+#ifdef USE_SWITCH
+#include "esphome/components/switch/switch.h"
+#endif
+#ifdef USE_BUTTON
+#include "esphome/components/button/button.h"
+#endif
+
+namespace esphome {
+
+/// Gets the state changes of all entities of App.
+class Controller {
+public:
+  void setup_controller(bool include_internal = false);
+#ifdef USE_BINARY_SENSOR
+  virtual void on_binary_sensor_update(binary_sensor::BinarySensor *obj) {}
+#endif
+#ifdef USE_SWITCH
+  virtual void on_switch_update(switch_::Switch *obj, bool state) {}
+#endif
+};
+
+} // namespace esphome
@@ -0,0 +1,27 @@
+#pragma once
+
+// Stand-in for the defines.h that esphome generates from config.yaml, for the host build of the web_server component
+// (see web_host.hpp).
+//
+// The web_server features of config.yaml that don't need the hardware are enabled: the ESP-IDF flavour of the server,
+// the log stream, the LCD mirror, entity batches and OTA with the state callbacks of on_begin. The remote keypad and
+// the UI partition talk to the HTTP server and the flash directly and are left out. Besides the binary sensors of the
+// prop there are switches and buttons, so that the load mixes can POST to entities.
+
+#define USE_ESP32
+#define USE_ESP_IDF
+#define USE_LOGGER
+
+#define USE_BINARY_SENSOR
+#define USE_SWITCH
+#define USE_BUTTON
+
+#define USE_WEBSERVER
+#define USE_WEBSERVER_PORT 80
+#define USE_WEBSERVER_VERSION 2
+#define USE_WEBSERVER_OTA
+#define USE_OTA_STATE_CALLBACK
+#define USE_WEBSERVER_LCD
+#define USE_WEBSERVER_LCD_MIRROR
+#define USE_WEBSERVER_ENTITY_BATCH
+#define ESPHOME_WEBSERVER_INDEX_HTML_GZIPPED 1
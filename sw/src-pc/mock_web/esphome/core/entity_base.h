@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+
+enum EntityCategory : uint8_t {
+  ENTITY_CATEGORY_NONE = 0,
+  ENTITY_CATEGORY_CONFIG = 1,
+  ENTITY_CATEGORY_DIAGNOSTIC = 2,
+};
+
+class EntityBase {
+public:
+  /// Sets the name and the object id derived from it ("Red button" -> "red_button").
+  void set_name(const char *name);
+  const std::string &get_name() const { return this->name_; }
+  std::string get_object_id() const { return this->object_id_; }
+
+  bool is_internal() const { return this->internal_; }
+  void set_internal(bool internal) { this->internal_ = internal; }
+  bool is_disabled_by_default() const { return this->disabled_by_default_; }
+  void set_disabled_by_default(bool disabled_by_default) { this->disabled_by_default_ = disabled_by_default; }
+  EntityCategory get_entity_category() const { return this->entity_category_; }
+  void set_entity_category(EntityCategory entity_category) { this->entity_category_ = entity_category; }
+  std::string get_icon() const { return this->icon_; }
+  void set_icon(const char *icon) { this->icon_ = icon; }
+
+protected:
+  std::string name_;
+  std::string object_id_;
+  std::string icon_;
+  bool internal_{false};
+  bool disabled_by_default_{false};
+  EntityCategory entity_category_{ENTITY_CATEGORY_NONE};
+};
+
+} // namespace esphome
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+#define PROGMEM
+
+namespace esphome {
+
+/// Milliseconds since the start of the program, plus the time passed by host_advance_time().
+uint32_t millis();
+
+/// host: lets time pass without waiting, for models of slow hardware.
+void host_advance_time(uint32_t us);
+
+} // namespace esphome
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "esphome/core/hal.h"
+
+namespace esphome {
+
+template <typename T> using optional = std::optional<T>;
+inline constexpr std::nullopt_t nullopt = std::nullopt;
+
+/// The web server only guards short sections with it, a std::mutex will do.
+class Mutex {
+public:
+  void lock() { this->mutex_.lock(); }
+  bool try_lock() { return this->mutex_.try_lock(); }
+  void unlock() { this->mutex_.unlock(); }
+
+private:
+  std::mutex mutex_;
+};
+
+class LockGuard {
+public:
+  explicit LockGuard(Mutex &mutex) : mutex_(mutex) { this->mutex_.lock(); }
+  ~LockGuard() { this->mutex_.unlock(); }
+  LockGuard(const LockGuard &) = delete;
+  LockGuard &operator=(const LockGuard &) = delete;
+
+private:
+  Mutex &mutex_;
+};
+
+template <typename... Ts> class CallbackManager;
+
+/// Callbacks to call all at once.
+template <typename... Ts> class CallbackManager<void(Ts...)> {
+public:
+  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &callback : this->callbacks_)
+      callback(args...);
+  }
+
+protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+std::string str_sprintf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+uint32_t random_uint32();
+
+/// The whole string as an unsigned number, nothing if it isn't one.
+template <typename T, std::enable_if_t<std::is_unsigned<T>::value, int> = 0>
+optional<T> parse_number(const std::string &str) {
+  if (str.empty())
+    return {};
+  char *end = nullptr;
+  errno = 0;
+  unsigned long long value = strtoull(str.c_str(), &end, 10);
+  if (*end != '\0' || errno != 0 || value > static_cast<unsigned long long>(static_cast<T>(~T(0))))
+    return {};
+  return static_cast<T>(value);
+}
+
+inline void normalize_accuracy_decimals(float &value, int8_t &accuracy_decimals) {
+  if (accuracy_decimals < 0) {
+    float divisor = std::pow(10.0f, -accuracy_decimals);
+    value = std::round(value / divisor) * divisor;
+    accuracy_decimals = 0;
+  }
+}
+
+} // namespace esphome
@@ -0,0 +1,291 @@
+// The esphome core of the host build of the web_server component: application, scheduler, entities and logging.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <random>
+
+#include "esphome/components/logger/logger.h"
+#include "esphome/components/network/util.h"
+#include "esphome/core/application.h"
+#include "esphome/core/component_iterator.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+
+Application App; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+static std::atomic<uint64_t> advanced_us{0};
+
+uint32_t millis() {
+  static const auto start = std::chrono::steady_clock::now();
+  auto real_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  return static_cast<uint32_t>((real_us + advanced_us.load()) / 1000);
+}
+
+void host_advance_time(uint32_t us) { advanced_us += us; }
+
+std::string str_sprintf(const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  va_list copy;
+  va_copy(copy, args);
+  int len = vsnprintf(nullptr, 0, fmt, copy);
+  va_end(copy);
+  std::string str(len > 0 ? len : 0, '\0');
+  vsnprintf(&str[0], str.size() + 1, fmt, args);
+  va_end(args);
+  return str;
+}
+
+uint32_t random_uint32() {
+  static std::mt19937 rng(42);
+  return rng();
+}
+
+//
+// Logging
+//
+
+namespace logger {
+
+static Logger default_logger;
+Logger *global_logger = &default_logger; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+void Logger::log_vprintf(int level, const char *tag, int line, const char *format, va_list args) {
+  static const char LETTERS[] = "?EWICDVV";
+  char message[512];
+  int len = snprintf(message, sizeof(message), "[%c][%s:%03d]: ", LETTERS[std::min(level, 7)], tag, line);
+  int text = vsnprintf(message + len, sizeof(message) - len, format, args);
+  len = std::min<int>(len + std::max(text, 0), sizeof(message) - 1);
+  if (level <= this->print_level_) {
+    fprintf(stderr, "%s\n", message);
+  }
+  for (auto &callback : this->callbacks_) {
+    callback(level, tag, message, len);
+  }
+}
+
+} // namespace logger
+
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...) {
+  if (logger::global_logger == nullptr)
+    return;
+  va_list args;
+  va_start(args, format);
+  logger::global_logger->log_vprintf(level, tag, line, format, args);
+  va_end(args);
+}
+
+//
+// Application and scheduler
+//
+
+void Application::pre_setup(const std::string &name, const std::string &friendly_name, const char *comment) {
+  this->name_ = name;
+  this->friendly_name_ = friendly_name;
+  this->comment_ = comment;
+}
+
+void Application::setup() {
+  std::stable_sort(this->components_.begin(), this->components_.end(), [](Component *a, Component *b) {
+    return a->get_setup_priority() > b->get_setup_priority();
+  });
+  for (Component *component : this->components_) {
+    component->setup();
+  }
+  for (Component *component : this->components_) {
+    component->dump_config();
+  }
+}
+
+void Application::loop() {
+  uint32_t now = millis();
+  // timers may add timers
+  for (size_t i = 0; i < this->timers_.size(); i++) {
+    if (static_cast<int32_t>(now - this->timers_[i].next) < 0)
+      continue;
+    std::function<void()> f = this->timers_[i].f;
+    if (this->timers_[i].repeat) {
+      this->timers_[i].next = now + this->timers_[i].interval;
+    } else {
+      this->timers_.erase(this->timers_.begin() + i--);
+    }
+    f();
+  }
+
+  {
+    LockGuard guard(this->deferred_lock_);
+    std::swap(this->deferred_, this->running_);
+  }
+  for (auto &f : this->running_) {
+    f();
+  }
+  this->running_.clear();
+
+  for (Component *component : this->components_) {
+    component->loop();
+  }
+}
+
+void Application::reset() {
+  this->components_.clear();
+#ifdef USE_BINARY_SENSOR
+  this->binary_sensors_.clear();
+#endif
+#ifdef USE_SWITCH
+  this->switches_.clear();
+#endif
+#ifdef USE_BUTTON
+  this->buttons_.clear();
+#endif
+  this->timers_.clear();
+  LockGuard guard(this->deferred_lock_);
+  this->deferred_.clear();
+}
+
+void Application::add_timer(Component *component, const std::string &name, uint32_t interval, bool repeat,
+                            std::function<void()> &&f) {
+  // a named timer replaces the one of the same name of the component
+  if (!name.empty()) {
+    this->timers_.erase(std::remove_if(this->timers_.begin(), this->timers_.end(),
+                                       [&](const Timer &t) { return t.component == component && t.name == name; }),
+                        this->timers_.end());
+  }
+  this->timers_.push_back(Timer{component, name, interval, millis() + interval, repeat, std::move(f)});
+}
+
+void Application::add_deferred(std::function<void()> &&f) {
+  LockGuard guard(this->deferred_lock_);
+  this->deferred_.push_back(std::move(f));
+}
+
+void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {
+  App.add_timer(this, name, interval, true, std::move(f));
+}
+void Component::set_interval(uint32_t interval, std::function<void()> &&f) {
+  App.add_timer(this, "", interval, true, std::move(f));
+}
+void Component::set_timeout(uint32_t timeout, std::function<void()> &&f) {
+  App.add_timer(this, "", timeout, false, std::move(f));
+}
+void Component::defer(std::function<void()> &&f) { App.add_deferred(std::move(f)); }
+
+//
+// Entities
+//
+
+void EntityBase::set_name(const char *name) {
+  this->name_ = name;
+  this->object_id_.clear();
+  for (const char *c = name; *c != '\0'; c++) {
+    if (*c == ' ') {
+      this->object_id_ += '_';
+    } else if (isalnum(static_cast<unsigned char>(*c)) || *c == '-' || *c == '_') {
+      this->object_id_ += static_cast<char>(tolower(static_cast<unsigned char>(*c)));
+    }
+  }
+}
+
+#ifdef USE_BINARY_SENSOR
+void binary_sensor::BinarySensor::publish_state(bool state) {
+  bool changed = !this->has_state_ || this->state != state;
+  this->state = state;
+  this->has_state_ = true;
+  if (changed) {
+    for (auto &callback : this->callbacks_) {
+      callback(state);
+    }
+  }
+}
+#endif
+
+#ifdef USE_SWITCH
+void switch_::Switch::publish_state(bool state) {
+  this->state = state;
+  for (auto &callback : this->callbacks_) {
+    callback(state);
+  }
+}
+#endif
+
+#ifdef USE_BUTTON
+void button::Button::press() {
+  for (auto &callback : this->callbacks_) {
+    callback();
+  }
+}
+#endif
+
+void Controller::setup_controller(bool include_internal) {
+#ifdef USE_BINARY_SENSOR
+  for (auto *obj : App.get_binary_sensors()) {
+    if (include_internal || !obj->is_internal())
+      obj->add_on_state_callback([this, obj](bool state) { this->on_binary_sensor_update(obj); });
+  }
+#endif
+#ifdef USE_SWITCH
+  for (auto *obj : App.get_switches()) {
+    if (include_internal || !obj->is_internal())
+      obj->add_on_state_callback([this, obj](bool state) { this->on_switch_update(obj, state); });
+  }
+#endif
+}
+
+void ComponentIterator::begin(bool include_internal) {
+  this->state_ = IteratorState::BEGIN;
+  this->at_ = 0;
+  this->include_internal_ = include_internal;
+}
+
+template <typename T>
+void ComponentIterator::advance_(const std::vector<T *> &entities, bool (ComponentIterator::*on)(T *)) {
+  if (this->at_ >= entities.size()) {
+    this->state_ = static_cast<IteratorState>(static_cast<int>(this->state_) + 1);
+    this->at_ = 0;
+    return;
+  }
+  T *obj = entities[this->at_];
+  if ((obj->is_internal() && !this->include_internal_) || (this->*on)(obj)) {
+    this->at_++;
+  }
+}
+
+void ComponentIterator::advance() {
+  switch (this->state_) {
+  case IteratorState::NONE:
+    return;
+  case IteratorState::BEGIN:
+    if (this->on_begin())
+      this->state_ = static_cast<IteratorState>(static_cast<int>(this->state_) + 1);
+    return;
+#ifdef USE_BINARY_SENSOR
+  case IteratorState::BINARY_SENSOR:
+    this->advance_(App.get_binary_sensors(), &ComponentIterator::on_binary_sensor);
+    return;
+#endif
+#ifdef USE_SWITCH
+  case IteratorState::SWITCH:
+    this->advance_(App.get_switches(), &ComponentIterator::on_switch);
+    return;
+#endif
+#ifdef USE_BUTTON
+  case IteratorState::BUTTON:
+    this->advance_(App.get_buttons(), &ComponentIterator::on_button);
+    return;
+#endif
+  case IteratorState::MAX:
+    if (this->on_end())
+      this->state_ = IteratorState::NONE;
+    return;
+  }
+}
+
+namespace network {
+std::string get_use_address() { return "ant.local"; }
+} // namespace network
+
+} // namespace esphome
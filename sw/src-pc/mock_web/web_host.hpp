@@ -0,0 +1,107 @@
+#pragma once
+
+// The web_server component of the firmware on the PC, for host-side tests and benchmarks.
+//
+// The component is compiled unchanged against the stand-ins in this directory: a few esphome core classes, the entity
+// types the prop uses, ArduinoJson and the ESP-IDF AsyncWebServer (esphome/components/web_server_idf). The stand-in
+// server has no sockets: a request is an object that is run through the handlers on the calling thread, and an
+// /events client is a send buffer that the program reads. The features follow config.yaml, see
+// esphome/core/defines.h.
+//
+// Everything is single threaded, the httpd task and the main loop take turns on the thread of the program.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "esp_ota_ops.h"
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#include "esphome/components/button/button.h"
+#include "esphome/components/logger/logger.h"
+#include "esphome/components/ota/ota_backend.h"
+#include "esphome/components/switch/switch.h"
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "esphome/core/application.h"
+#include "ota/ota_web_server.h"
+#include "web_server.h"
+
+namespace web_host {
+
+using esphome::App;
+
+/// The web server of the prop with its entities, set up as the generated main.cpp does.
+///
+/// The binary sensors are the buttons of config.yaml and three keys of the keypad; they have no names there (they are
+/// internal), here they have, so that the web server has entities to serve. A switch and a button stand in for entities that take
+/// commands. Only one WebHost may exist at a time, esphome has a single App.
+class WebHost {
+public:
+  WebHost() {
+    App.reset();
+    App.pre_setup("ant", "Ant", "Airsoft bomb prop");
+    for (const char *name : {"Red button", "Yellow button", "Key C", "Key D", "Key star"}) {
+      auto sensor = std::make_unique<esphome::binary_sensor::BinarySensor>();
+      sensor->set_name(name);
+      App.register_binary_sensor(sensor.get());
+      this->sensors.push_back(std::move(sensor));
+    }
+    this->siren.set_name("Siren");
+    App.register_switch(&this->siren);
+    this->restart.set_name("Restart");
+    App.register_button(&this->restart);
+
+    App.register_component(&this->base);
+    this->web.set_expose_log(true);
+    this->web.set_lcd_mirror_fps(10);
+    this->web.set_entity_batch_bytes(1024);
+    App.register_component(&this->web);
+    App.register_component(&this->ota);
+    App.setup();
+    for (auto &sensor : this->sensors) {
+      sensor->publish_state(false);
+    }
+  }
+
+  ~WebHost() {
+    App.reset();
+    esphome::logger::global_logger->clear_callbacks();
+  }
+
+  WebHost(const WebHost &) = delete;
+  WebHost &operator=(const WebHost &) = delete;
+
+  /// Runs a request through the server, as the httpd task does.
+  void handle(AsyncWebServerRequest &request) { this->base.get_server()->handle(&request); }
+
+  /// Uploads a file to the request URL as a multipart form, in chunks of the given size (the httpd task receives it
+  /// in chunks of its receive buffer).
+  void upload(AsyncWebServerRequest &request, const std::string &filename, const std::vector<uint8_t> &file,
+              size_t chunk = 1460) {
+    request.set_content_length(file.size());
+    this->base.get_server()->handle_upload(&request, filename, file.data(), file.size(), chunk);
+  }
+
+  /// Uploads a file in chunks of the given sizes, running the main loop before each chunk but the first.
+  void upload(AsyncWebServerRequest &request, const std::string &filename, const std::vector<uint8_t> &file,
+              const std::vector<size_t> &chunks) {
+    request.set_content_length(file.size());
+    this->base.get_server()->handle_upload(&request, filename, file.data(), chunks, [this]() { this->loop(); });
+  }
+
+  /// Runs the main loop once: the timers, the deferred calls and the loop() of the components.
+  void loop() {
+    this->web.capture_lcd(this->lcd);
+    App.loop();
+  }
+
+  std::vector<std::unique_ptr<esphome::binary_sensor::BinarySensor>> sensors;
+  esphome::switch_::Switch siren;
+  esphome::button::Button restart;
+  LcdFrame lcd;
+
+  esphome::web_server_base::WebServerBase base;
+  esphome::web_server::WebServer web{&base};
+  esphome::web_server::WebServerOTAComponent ota;
+};
+
+} // namespace web_host
@@ -0,0 +1,452 @@
+// The HTTP side of the host build of the web_server component: requests, the event source, the web server base, the
+// OTA backend and the ESP-IDF partition functions behind it.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "esp_app_desc.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esphome/components/ota/ota_backend.h"
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "esphome/components/web_server_idf/web_server_idf.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "list_entities.h"
+#include "web_server.h"
+
+// What esphome generates from index_html_include: a gzipped page. The content doesn't matter to the server, only the
+// size, which is about that of the page of the prop.
+const uint8_t ESPHOME_WEBSERVER_INDEX_HTML[2048] PROGMEM = {0x1f, 0x8b, 0x08, 0x00};
+const size_t ESPHOME_WEBSERVER_INDEX_HTML_SIZE = sizeof(ESPHOME_WEBSERVER_INDEX_HTML);
+
+namespace esphome {
+namespace web_server_idf {
+
+static const char *const TAG = "web_server_idf";
+
+//
+// Requests
+//
+
+static std::string url_decode(const std::string &str) {
+  std::string decoded;
+  decoded.reserve(str.size());
+  for (size_t i = 0; i < str.size(); i++) {
+    if (str[i] == '+') {
+      decoded += ' ';
+    } else if (str[i] == '%' && i + 2 < str.size() && isxdigit(str[i + 1]) && isxdigit(str[i + 2])) {
+      decoded += static_cast<char>(strtoul(str.substr(i + 1, 2).c_str(), nullptr, 16));
+      i += 2;
+    } else {
+      decoded += str[i];
+    }
+  }
+  return decoded;
+}
+
+AsyncWebServerRequest::AsyncWebServerRequest(http_method method, const std::string &url) : method_(method) {
+  this->body_.reserve(BODY_RESERVE);
+  size_t query = url.find('?');
+  this->url_ = url_decode(url.substr(0, query));
+  if (query == std::string::npos)
+    return;
+  size_t start = query + 1;
+  while (start <= url.size()) {
+    size_t end = url.find('&', start);
+    if (end == std::string::npos)
+      end = url.size();
+    std::string pair = url.substr(start, end - start);
+    if (!pair.empty()) {
+      size_t eq = pair.find('=');
+      this->params_.emplace_back(url_decode(pair.substr(0, eq)),
+                                 eq == std::string::npos ? "" : url_decode(pair.substr(eq + 1)));
+    }
+    start = end + 1;
+  }
+}
+
+AsyncWebParameter *AsyncWebServerRequest::find_param_(const std::string &name) const {
+  for (auto &param : this->params_) {
+    if (param.name() == name)
+      return &param;
+  }
+  return nullptr;
+}
+
+std::string AsyncWebServerRequest::arg(const std::string &name) const {
+  AsyncWebParameter *param = this->find_param_(name);
+  return param != nullptr ? param->value() : "";
+}
+
+optional<std::string> AsyncWebServerRequest::get_header(const char *name) const {
+  auto it = this->headers_.find(name);
+  if (it == this->headers_.end())
+    return {};
+  return it->second;
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse *response) {
+  this->code_ = response->code();
+  this->content_type_ = response->content_type();
+  this->body_.assign(reinterpret_cast<const char *>(response->data()), response->size());
+  this->response_headers_ = response->headers();
+  delete response; // NOLINT(cppcoreguidelines-owning-memory)
+}
+
+void AsyncWebServerRequest::send(int code, const char *content_type, const char *content) {
+  this->code_ = code;
+  this->content_type_ = content_type != nullptr ? content_type : "";
+  this->body_.assign(content != nullptr ? content : "");
+}
+
+std::string AsyncWebServerRequest::response_header(const std::string &name) const {
+  for (const auto &header : this->response_headers_) {
+    if (header.first == name)
+      return header.second;
+  }
+  return "";
+}
+
+AsyncWebHandler *AsyncWebServer::find_handler_(AsyncWebServerRequest *request) const {
+  for (AsyncWebHandler *handler : this->handlers_) {
+    if (handler->canHandle(request))
+      return handler;
+  }
+  return nullptr;
+}
+
+void AsyncWebServer::handle(AsyncWebServerRequest *request) {
+  AsyncWebHandler *handler = this->find_handler_(request);
+  if (handler == nullptr) {
+    request->send(404);
+    return;
+  }
+  handler->handleRequest(request);
+}
+
+void AsyncWebServer::handle_upload(AsyncWebServerRequest *request, const std::string &filename, const uint8_t *data,
+                                   size_t len, size_t chunk) {
+  this->upload_(request, filename, data, len, [chunk](size_t) { return chunk; }, nullptr);
+}
+
+void AsyncWebServer::handle_upload(AsyncWebServerRequest *request, const std::string &filename, const uint8_t *data,
+                                   const std::vector<size_t> &chunks, const std::function<void()> &between) {
+  size_t len = 0;
+  for (size_t chunk : chunks)
+    len += chunk;
+  size_t at = 0;
+  this->upload_(request, filename, data, len, [&chunks, &at](size_t) { return at < chunks.size() ? chunks[at++] : 0; },
+                between);
+}
+
+void AsyncWebServer::upload_(AsyncWebServerRequest *request, const std::string &filename, const uint8_t *data,
+                             size_t len, const std::function<size_t(size_t index)> &chunk_at,
+                             const std::function<void()> &between) {
+  AsyncWebHandler *handler = this->find_handler_(request);
+  if (handler == nullptr) {
+    request->send(404);
+    return;
+  }
+  if (!handler->isRequestHandlerTrivial()) {
+    // the handlers don't write to the data, it's the receive buffer of the httpd task on the device
+    auto *bytes = const_cast<uint8_t *>(data);
+    size_t index = 0;
+    do {
+      if (index != 0 && between)
+        between();
+      size_t n = chunk_at(index);
+      n = n == 0 ? len - index : std::min(n, len - index);
+      handler->handleUpload(request, filename, index, bytes + index, n, index + n == len);
+      index += n;
+    } while (index < len);
+  }
+  handler->handleRequest(request);
+}
+
+//
+// Event source
+//
+
+AsyncEventSourceResponse::AsyncEventSourceResponse(const AsyncWebServerRequest *request, AsyncEventSource *server,
+                                                   esphome::web_server::WebServer *ws)
+    : server_(server), web_server_(ws) {
+  this->entities_iterator_ = std::make_unique<esphome::web_server::ListEntitiesIterator>(ws, server);
+  std::string message = ws->get_config_json();
+  this->try_send_nodefer(message.c_str(), "ping", millis(), 30000);
+  this->entities_iterator_->begin(ws->include_internal_);
+}
+
+AsyncEventSourceResponse::~AsyncEventSourceResponse() = default;
+
+void AsyncEventSourceResponse::process_buffer_() {
+  if (this->event_buffer_.empty())
+    return;
+  size_t room = SEND_BUFFER - this->send_buffer_.size();
+  size_t n = std::min(room, this->event_buffer_.size() - this->event_bytes_sent_);
+  this->send_buffer_.append(this->event_buffer_, this->event_bytes_sent_, n);
+  this->event_bytes_sent_ += n;
+  if (this->event_bytes_sent_ == this->event_buffer_.size()) {
+    this->event_buffer_.clear();
+    this->event_bytes_sent_ = 0;
+  }
+}
+
+void AsyncEventSourceResponse::process_deferred_queue_() {
+  while (!this->deferred_queue_.empty()) {
+    DeferredEvent &event = this->deferred_queue_.front();
+    std::string message = event.message_generator(this->web_server_, event.source);
+    if (!this->try_send_nodefer(message.c_str(), "state"))
+      break;
+    this->deferred_queue_.erase(this->deferred_queue_.begin());
+  }
+}
+
+void AsyncEventSourceResponse::loop() {
+  this->process_buffer_();
+  this->process_deferred_queue_();
+  if (!this->entities_iterator_->completed())
+    this->entities_iterator_->advance();
+}
+
+bool AsyncEventSourceResponse::try_send_nodefer(const char *message, const char *event, uint32_t id,
+                                                uint32_t reconnect) {
+  if (this->closed_)
+    return false;
+  this->process_buffer_();
+  if (!this->event_buffer_.empty())
+    return false;
+
+  char field[32];
+  if (reconnect != 0) {
+    snprintf(field, sizeof(field), "retry: %" PRIu32 "\r\n", reconnect);
+    this->event_buffer_ += field;
+  }
+  if (id != 0) {
+    snprintf(field, sizeof(field), "id: %" PRIu32 "\r\n", id);
+    this->event_buffer_ += field;
+  }
+  if (event != nullptr && *event != '\0') {
+    this->event_buffer_ += "event: ";
+    this->event_buffer_ += event;
+    this->event_buffer_ += "\r\n";
+  }
+  if (message != nullptr && *message != '\0') {
+    const char *line = message;
+    while (true) {
+      size_t len = strcspn(line, "\r\n");
+      this->event_buffer_ += "data: ";
+      this->event_buffer_.append(line, len);
+      this->event_buffer_ += "\r\n";
+      line += len;
+      if (*line == '\0')
+        break;
+      line += (line[0] == '\r' && line[1] == '\n') ? 2 : 1;
+    }
+  }
+  if (this->event_buffer_.empty())
+    return true;
+  this->event_buffer_ += "\r\n";
+  this->process_buffer_();
+  return true;
+}
+
+void AsyncEventSourceResponse::deferrable_send_state(void *source, const char *event_type,
+                                                     message_generator_t *message_generator) {
+  // the details of all entities go first, so that the page doesn't show entities without a name
+  if (!this->entities_iterator_->completed() && strcmp(event_type, "state_detail_all") != 0)
+    return;
+  if (source == nullptr || message_generator == nullptr)
+    return;
+  if (strcmp(event_type, "state_detail_all") != 0 && strcmp(event_type, "state") != 0) {
+    ESP_LOGE(TAG, "Can't defer non-state event");
+  }
+
+  this->process_buffer_();
+  this->process_deferred_queue_();
+  DeferredEvent item{source, message_generator};
+  if (this->event_buffer_.empty() && this->deferred_queue_.empty()) {
+    std::string message = message_generator(this->web_server_, source);
+    if (this->try_send_nodefer(message.c_str(), "state"))
+      return;
+  }
+  // the send buffer is full, the event goes out later with the state of then
+  if (std::find(this->deferred_queue_.begin(), this->deferred_queue_.end(), item) == this->deferred_queue_.end())
+    this->deferred_queue_.push_back(item);
+}
+
+std::string AsyncEventSourceResponse::read(size_t max) {
+  size_t n = std::min(max, this->send_buffer_.size());
+  std::string text = this->send_buffer_.substr(0, n);
+  this->send_buffer_.erase(0, n);
+  return text;
+}
+
+AsyncEventSource::~AsyncEventSource() {
+  for (AsyncEventSourceResponse *ses : this->sessions_)
+    delete ses; // NOLINT(cppcoreguidelines-owning-memory)
+}
+
+void AsyncEventSource::handleRequest(AsyncWebServerRequest *request) {
+  auto *rsp = new AsyncEventSourceResponse(request, this, this->web_server_); // NOLINT
+  request->send(200, "text/event-stream");
+  request->set_event_client(rsp);
+  if (this->on_connect_)
+    this->on_connect_(rsp);
+  if (connect_gap)
+    connect_gap();
+  this->sessions_.insert(rsp);
+}
+
+void AsyncEventSource::loop() {
+  for (auto it = this->sessions_.begin(); it != this->sessions_.end();) {
+    AsyncEventSourceResponse *ses = *it;
+    if (ses->closed()) {
+      ESP_LOGD(TAG, "Removing dead event source session");
+      it = this->sessions_.erase(it);
+      delete ses; // NOLINT(cppcoreguidelines-owning-memory)
+    } else {
+      ses->loop();
+      ++it;
+    }
+  }
+}
+
+void AsyncEventSource::try_send_nodefer(const char *message, const char *event, uint32_t id, uint32_t reconnect) {
+  for (AsyncEventSourceResponse *ses : this->sessions_)
+    ses->try_send_nodefer(message, event, id, reconnect);
+}
+
+void AsyncEventSource::deferrable_send_state(void *source, const char *event_type,
+                                             message_generator_t *message_generator) {
+  for (AsyncEventSourceResponse *ses : this->sessions_)
+    ses->deferrable_send_state(source, event_type, message_generator);
+}
+
+} // namespace web_server_idf
+
+//
+// Web server base
+//
+
+namespace web_server_base {
+
+WebServerBase *global_web_server_base = nullptr; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+WebServerBase::WebServerBase() { global_web_server_base = this; }
+
+void WebServerBase::init() {
+  if (this->server_ != nullptr)
+    return;
+  this->server_ = std::make_shared<AsyncWebServer>(this->port_);
+  this->server_->begin();
+  for (AsyncWebHandler *handler : this->handlers_)
+    this->server_->addHandler(handler);
+}
+
+void WebServerBase::add_handler(AsyncWebHandler *handler) {
+  this->handlers_.push_back(handler);
+  if (this->server_ != nullptr)
+    this->server_->addHandler(handler);
+}
+
+} // namespace web_server_base
+
+//
+// OTA
+//
+
+namespace ota {
+
+// The update partition, and the image being written. Both are kept, so that only the first updates allocate.
+static std::vector<uint8_t> updated; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+static std::vector<uint8_t> written; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+static FlashModel flash_model;       // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+static FlashStats stats;             // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+/// Writes into a buffer, the image becomes the updated one when the update ends.
+class HostOTABackend : public OTABackend {
+public:
+  OTAResponseTypes begin(size_t image_size) override {
+    written.clear();
+    written.reserve(image_size);
+    stats.begins++;
+    return OTA_RESPONSE_OK;
+  }
+  OTAResponseTypes write(uint8_t *data, size_t len) override {
+    size_t start = written.size();
+    written.insert(written.end(), data, data + len);
+    // the sectors and pages the data reaches into, erased and programmed while the caller waits
+    uint32_t erases = (written.size() + FlashModel::SECTOR_SIZE - 1) / FlashModel::SECTOR_SIZE -
+                      (start + FlashModel::SECTOR_SIZE - 1) / FlashModel::SECTOR_SIZE;
+    uint32_t pages = len == 0 ? 0 : (written.size() - 1) / FlashModel::PAGE_SIZE - start / FlashModel::PAGE_SIZE + 1;
+    uint32_t us =
+        flash_model.write_call_us + erases * flash_model.sector_erase_us + pages * flash_model.page_program_us;
+    stats.writes++;
+    stats.erases += erases;
+    stats.pages += pages;
+    stats.busy_us += us;
+    host_advance_time(us);
+    return OTA_RESPONSE_OK;
+  }
+  OTAResponseTypes end() override {
+    if (written.empty())
+      return OTA_RESPONSE_ERROR_UPDATE_END;
+    updated.swap(written);
+    return OTA_RESPONSE_OK;
+  }
+  void abort() override { written.clear(); }
+};
+
+std::unique_ptr<OTABackend> make_ota_backend() { return std::make_unique<HostOTABackend>(); }
+
+const std::vector<uint8_t> &updated_image() { return updated; }
+
+void set_flash_model(const FlashModel &model) { flash_model = model; }
+const FlashStats &flash_stats() { return stats; }
+void reset_flash_stats() { stats = FlashStats{}; }
+
+void register_ota_platform(OTAComponent *ota_caller) {}
+
+} // namespace ota
+} // namespace esphome
+
+//
+// ESP-IDF
+//
+
+static std::vector<uint8_t> running_image;     // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+static esp_partition_t running_partition = {}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+static esp_app_desc_t app_desc = {"host", "airsoft-bomb-prop", {}}; // NOLINT
+
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size,
+                             esp_partition_mmap_memory_t memory, const void **out_ptr,
+                             esp_partition_mmap_handle_t *out_handle) {
+  if (partition == nullptr || partition->data == nullptr || offset + size > partition->size)
+    return ESP_FAIL;
+  *out_ptr = partition->data + offset;
+  *out_handle = 1;
+  return ESP_OK;
+}
+
+void esp_partition_munmap(esp_partition_mmap_handle_t handle) {}
+
+const esp_partition_t *esp_ota_get_running_partition() {
+  return running_partition.data != nullptr ? &running_partition : nullptr;
+}
+
+void esp_ota_set_running_image(const uint8_t *data, uint32_t size) {
+  running_image.assign(data, data + size);
+  running_partition.address = 0x10000;
+  running_partition.size = size;
+  running_partition.erase_size = 4096;
+  snprintf(running_partition.label, sizeof(running_partition.label), "ota_0");
+  running_partition.data = running_image.data();
+}
+
+const esp_app_desc_t *esp_app_get_description() { return &app_desc; }
+
+void esp_app_set_elf_sha256(const uint8_t sha256[32]) { memcpy(app_desc.app_elf_sha256, sha256, 32); }
@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../src-common/remote_keypad.hpp"
+#include "lcd_capture.hpp"
+#include "mock_esphome.hpp"
+
+// Host stand-in for the remote keypad server of the web_server component (remote_keypad.cpp): serves the keypad page
+// on / and the WebSocket on /keypad over plain POSIX sockets, so the phone keypad can be tried against the PC build
+// (tools/remote_keypad_server.cpp) and its latency measured (bench/bench_remote_keypad.cpp).
+//
+// It is split the same way as on the device: a network thread (the HTTP server task there) parses the key frames and
+// pushes the keys to a RemoteKeyQueue, the game loop calls loop() to apply them and send the LCD frames.
+
+class RemoteKeypadHost {
+public:
+  static constexpr size_t MAX_CLIENTS = 3;
+
+  explicit RemoteKeypadHost(std::string page = "") : page(std::move(page)) {}
+  ~RemoteKeypadHost() { stop(); }
+
+  // Listens on all interfaces, port 0 picks a free one. Returns false if the port can't be used.
+  bool start(uint16_t port) {
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int on = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(listen_fd, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 4) != 0) {
+      close(listen_fd);
+      listen_fd = -1;
+      return false;
+    }
+    running = true;
+    thread = std::thread([this]() { serve(); });
+    return true;
+  }
+
+  void stop() {
+    if (!running) {
+      return;
+    }
+    running = false;
+    thread.join();
+    for (Connection &c : connections) {
+      close(c.fd);
+    }
+    connections.clear();
+    close(listen_fd);
+  }
+
+  uint16_t port() const {
+    sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd, (sockaddr *)&addr, &len);
+    return ntohs(addr.sin_port);
+  }
+
+  // Game loop side, like RemoteKeypad::loop(): on_key applies a key (and renders, calling set_frame()), then the
+  // clients are sent what changed
+  void loop(const std::function<void(unsigned char)> &on_key) {
+    int fds[MAX_CLIENTS];
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      for (size_t i = 0; i < MAX_CLIENTS; i++) {
+        if (slots[i].fresh) {
+          slots[i].client.reset();
+          slots[i].fresh = false;
+        }
+        fds[i] = slots[i].fd;
+      }
+    }
+
+    RemoteKey key;
+    while (queue.pop(key)) {
+      if (fds[key.client] >= 0) {
+        slots[key.client].client.applied(key.seq);
+      }
+      on_key(key.key);
+    }
+
+    uint8_t buf[REMOTE_KEYPAD_MAX_LCD_FRAME];
+    for (size_t i = 0; i < MAX_CLIENTS; i++) {
+      if (fds[i] < 0) {
+        continue;
+      }
+      size_t len = slots[i].client.update(frame, buf);
+      if (len) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (slots[i].fd == fds[i]) {
+          send_frame(fds[i], 0x2, buf, len);
+        }
+      }
+    }
+  }
+
+  bool active() const { return connected.load(std::memory_order_relaxed) != 0; }
+  void set_frame(const LcdFrame &frame) { this->frame = frame; }
+
+private:
+  struct Slot {
+    int fd = -1;
+    bool fresh = false;
+    RemoteKeypadClient client; // game loop only
+  };
+
+  struct Connection {
+    int fd;
+    std::string in;
+    int slot = -1; // >= 0 once upgraded to a WebSocket
+  };
+
+  std::string page;
+  int listen_fd = -1;
+  std::atomic<bool> running{false};
+  std::thread thread;
+  std::vector<Connection> connections; // network thread only
+
+  std::mutex lock; // slots[].fd and writes to the sockets
+  Slot slots[MAX_CLIENTS];
+  std::atomic<int> connected{0};
+  RemoteKeyQueue queue;
+  LcdFrame frame;
+
+  static uint32_t micros() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+  }
+
+  void serve() {
+    while (running) {
+      std::vector<pollfd> fds;
+      fds.push_back({listen_fd, POLLIN, 0});
+      for (Connection &c : connections) {
+        fds.push_back({c.fd, POLLIN, 0});
+      }
+      if (poll(fds.data(), fds.size(), 20) <= 0) {
+        continue;
+      }
+      if (fds[0].revents & POLLIN) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd >= 0) {
+          int on = 1;
+          setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+          connections.push_back({fd, "", -1});
+        }
+      }
+      for (size_t i = 1; i < fds.size(); i++) {
+        if (fds[i].revents && !receive(connections[i - 1])) {
+          drop(connections[i - 1]);
+          connections[i - 1].fd = -1;
+        }
+      }
+      connections.erase(std::remove_if(connections.begin(), connections.end(), [](auto &c) { return c.fd < 0; }),
+                        connections.end());
+    }
+  }
+
+  void drop(Connection &c) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (c.slot >= 0) {
+      slots[c.slot].fd = -1;
+      connected--;
+    }
+    close(c.fd);
+  }
+
+  // Reads what arrived. Returns false when the connection is to be closed.
+  bool receive(Connection &c) {
+    char buf[512];
+    ssize_t n = read(c.fd, buf, sizeof(buf));
+    if (n <= 0) {
+      return false;
+    }
+    c.in.append(buf, n);
+    return c.slot < 0 ? receive_http(c) : receive_ws(c);
+  }
+
+  bool receive_http(Connection &c) {
+    size_t end = c.in.find("\r\n\r\n");
+    if (end == std::string::npos) {
+      return c.in.size() < 4096;
+    }
+    std::string path = c.in.substr(4, c.in.find(' ', 4) - 4);
+    if (c.in.compare(0, 4, "GET ") != 0) {
+      return respond(c, "405 Method Not Allowed", "text/plain", "");
+    }
+    if (path == "/") {
+      return respond(c, "200 OK", "text/html", page);
+    }
+    std::string key = header(c.in.substr(0, end), "sec-websocket-key");
+    if (path != "/keypad" || key.empty()) {
+      return respond(c, "404 Not Found", "text/plain", "");
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      for (size_t i = 0; i < MAX_CLIENTS && c.slot < 0; i++) {
+        if (slots[i].fd < 0) {
+          std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                                 "Connection: Upgrade\r\nSec-WebSocket-Accept: " +
+                                 websocket_accept(key) + "\r\n\r\n";
+          write_all(c.fd, response.data(), response.size());
+          c.slot = i;
+          slots[i].fd = c.fd;
+          slots[i].fresh = true;
+          connected++;
+        }
+      }
+    }
+    if (c.slot < 0) {
+      return false; // too many clients
+    }
+    c.in.erase(0, end + 4);
+    return receive_ws(c);
+  }
+
+  bool respond(Connection &c, const char *status, const char *type, const std::string &body) {
+    std::string response = std::string("HTTP/1.1 ") + status + "\r\nContent-Type: " + type +
+                           "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" +
+                           body;
+    write_all(c.fd, response.data(), response.size());
+    return false;
+  }
+
+  // Parses the complete frames in c.in
+  bool receive_ws(Connection &c) {
+    for (;;) {
+      const uint8_t *d = (const uint8_t *)c.in.data();
+      if (c.in.size() < 2) {
+        return true;
+      }
+      uint8_t opcode = d[0] & 0x0f;
+      size_t len = d[1] & 0x7f;
+      if (!(d[1] & 0x80) || len > 125) {
+        return false; // client frames are masked, and ours are all small
+      }
+      if (c.in.size() < 6 + len) {
+        return true;
+      }
+      uint8_t payload[125];
+      for (size_t i = 0; i < len; i++) {
+        payload[i] = d[6 + i] ^ d[2 + i % 4];
+      }
+      c.in.erase(0, 6 + len);
+
+      switch (opcode) {
+      case 0x2: // binary
+        if (!remote_key_frame_valid(payload, len)) {
+          return false;
+        }
+        for (size_t i = 1; i < len; i++) {
+          queue.push(RemoteKey{micros(), (uint8_t)c.slot, payload[0], payload[i]});
+        }
+        break;
+      case 0x9: { // ping
+        std::lock_guard<std::mutex> guard(lock);
+        send_frame(c.fd, 0xa, payload, len);
+        break;
+      }
+      case 0xa: break; // pong
+      default:  return false; // close, text or fragments
+      }
+    }
+  }
+
+  static void send_frame(int fd, uint8_t opcode, const uint8_t *data, size_t len) {
+    uint8_t buf[2 + 125];
+    buf[0] = 0x80 | opcode;
+    buf[1] = len;
+    memcpy(buf + 2, data, len);
+    write_all(fd, buf, 2 + len);
+  }
+
+  static void write_all(int fd, const void *data, size_t len) {
+    const char *p = (const char *)data;
+    while (len) {
+      ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+      if (n <= 0) {
+        return;
+      }
+      p += n;
+      len -= n;
+    }
+  }
+
+  static std::string header(const std::string &request, const std::string &name) {
+    size_t pos = 0;
+    while ((pos = request.find("\r\n", pos)) != std::string::npos) {
+      pos += 2;
+      size_t colon = request.find(':', pos);
+      size_t eol = request.find("\r\n", pos);
+      if (colon == std::string::npos || (eol != std::string::npos && colon > eol)) {
+        continue;
+      }
+      std::string key = request.substr(pos, colon - pos);
+      std::transform(key.begin(), key.end(), key.begin(), [](unsigned char ch) { return std::tolower(ch); });
+      if (key == name) {
+        size_t start = request.find_first_not_of(' ', colon + 1);
+        return request.substr(start, eol - start);
+      }
+    }
+    return "";
+  }
+
+public:
+  // Sec-WebSocket-Accept for a Sec-WebSocket-Key: base64(sha1(key + GUID)), RFC 6455
+  static std::string websocket_accept(const std::string &key) {
+    uint8_t digest[20];
+    sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", digest);
+    return base64(digest, sizeof(digest));
+  }
+
+  static void sha1(const std::string &msg, uint8_t digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    std::string data = msg;
+    uint64_t bits = (uint64_t)msg.size() * 8;
+    data += (char)0x80;
+    while (data.size() % 64 != 56) {
+      data += (char)0;
+    }
+    for (int i = 7; i >= 0; i--) {
+      data += (char)(bits >> (i * 8));
+    }
+    auto rol = [](uint32_t v, int n) { return (v << n) | (v >> (32 - n)); };
+    for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+      uint32_t w[80];
+      for (int i = 0; i < 16; i++) {
+        const uint8_t *p = (const uint8_t *)data.data() + chunk + i * 4;
+        w[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+      }
+      for (int i = 16; i < 80; i++) {
+        w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+      }
+      uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+      for (int i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if (i < 20) {
+          f = (b & c) | (~b & d), k = 0x5a827999;
+        } else if (i < 40) {
+          f = b ^ c ^ d, k = 0x6ed9eba1;
+        } else if (i < 60) {
+          f = (b & c) | (b & d) | (c & d), k = 0x8f1bbcdc;
+        } else {
+          f = b ^ c ^ d, k = 0xca62c1d6;
+        }
+        uint32_t t = rol(a, 5) + f + e + k + w[i];
+        e = d, d = c, c = rol(b, 30), b = a, a = t;
+      }
+      h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e;
+    }
+    for (int i = 0; i < 20; i++) {
+      digest[i] = h[i / 4] >> (24 - (i % 4) * 8);
+    }
+  }
+
+  static std::string base64(const uint8_t *data, size_t len) {
+    static const char *CHARS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < len; i += 3) {
+      uint32_t v = data[i] << 16 | (i + 1 < len ? data[i + 1] << 8 : 0) | (i + 2 < len ? data[i + 2] : 0);
+      out += CHARS[v >> 18 & 63];
+      out += CHARS[v >> 12 & 63];
+      out += i + 1 < len ? CHARS[v >> 6 & 63] : '=';
+      out += i + 2 < len ? CHARS[v & 63] : '=';
+    }
+    return out;
+  }
+};
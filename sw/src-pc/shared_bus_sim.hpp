@@ -0,0 +1,189 @@
+#pragma once
+
+// The keypad and the LCD on their I2C bus (bus_a of config.yaml), run by a model of the esphome main loop, for the
+// host-side tests and benchmarks of the bus scheduler (src-esphome/mycomponents/bus_scheduler).
+//
+// The devices are the models of keypad_sim.hpp and lcd_bus_sim.hpp on one clock. I2C is blocking, like esphome's: a
+// transaction holds the loop for its bus time, and each one is recorded in the trace with its device, start and end.
+// A pass of the loop scans the keypad (pcf8574_keypad), writes the LCD chunks that fit (bus_scheduler), runs the 50ms
+// interval of config.yaml that redraws the LCD, and spends LOOP_US in the other components. Every key that goes down
+// redraws the LCD too. The next pass waits for 16ms after the start of the last one unless the keypad or the
+// scheduler ask for the loop to run on. Without the scheduler, a redraw writes the whole frame at once, as lcd_burst
+// does on its own.
+//
+// The redraws animate a progress bar, every frame differs from the last.
+
+#include <cstdio>
+#include <vector>
+
+#include "../src-esphome/mycomponents/bus_scheduler/transaction_scheduler.h"
+#include "keypad_sim.hpp"
+#include "lcd_bus_sim.hpp"
+
+enum BusDevice : uint8_t { BUS_KEYPAD, BUS_LCD };
+
+struct BusTransaction {
+  uint8_t device;
+  double start; // us
+  double end;
+};
+
+// The clock of the loop and the trace of the bus
+struct BusClock {
+  double now = 0;
+  std::vector<BusTransaction> trace;
+
+  void transaction(uint8_t device, double us) {
+    trace.push_back(BusTransaction{device, now, now + us});
+    now += us;
+  }
+};
+
+class TracedKeypadModel : public KeypadMatrixModel {
+public:
+  TracedKeypadModel(BusClock &clock, uint32_t frequency) : KeypadMatrixModel(frequency), clock(clock) {}
+
+  bool read_pins(uint8_t &pins) override {
+    double before = busy_us;
+    bool ok = KeypadMatrixModel::read_pins(pins);
+    clock.transaction(BUS_KEYPAD, busy_us - before);
+    return ok;
+  }
+
+  bool write_pins(uint8_t pins) override {
+    double before = busy_us;
+    bool ok = KeypadMatrixModel::write_pins(pins);
+    clock.transaction(BUS_KEYPAD, busy_us - before);
+    return ok;
+  }
+
+  bool write_read_pins(uint8_t pins_out, uint8_t &pins) override {
+    double before = busy_us;
+    bool ok = KeypadMatrixModel::write_read_pins(pins_out, pins);
+    clock.transaction(BUS_KEYPAD, busy_us - before);
+    return ok;
+  }
+
+  BusClock &clock;
+};
+
+class TracedLcdModel : public LcdBusModel, public esphome::bus_scheduler::ChunkWriter {
+public:
+  TracedLcdModel(BusClock &clock, uint32_t frequency) : LcdBusModel(frequency), clock(clock) {}
+
+  void write_traced(const uint8_t *data, size_t len) {
+    if (now < clock.now) {
+      pause(clock.now - now);
+    }
+    double before = now;
+    write(data, len);
+    clock.transaction(BUS_LCD, now - before);
+  }
+
+  bool write_chunk(const uint8_t *data, size_t len) override {
+    write_traced(data, len);
+    return true;
+  }
+
+  BusClock &clock;
+};
+
+class SharedBusSim {
+public:
+  static constexpr double LOOP_US = 50;
+  static constexpr double MAIN_LOOP_US = 16000;
+  static constexpr double DISPLAY_INTERVAL_US = 50000;
+
+  SharedBusSim(uint32_t frequency, bool scheduled)
+      : keypad(clock, frequency), lcd(clock, frequency), scanner(&keypad), scheduled(scheduled) {
+    scheduler.set_frequency(frequency);
+    keypad_client = scheduler.add_client("keypad");
+    lcd_client = scheduler.add_client("lcd", &lcd);
+  }
+
+  // Runs the main loop until its clock reaches t (us)
+  void run_until(double t) {
+    while (clock.now < t) {
+      pass();
+    }
+  }
+
+  void pass() {
+    using namespace esphome::pcf8574_keypad;
+    double start = clock.now;
+
+    // pcf8574_keypad
+    uint32_t due = scanner.next_scan();
+    uint32_t scans = scanner.scans();
+    KeyEdge found[KeypadScanner::KEYS];
+    size_t n = scanner.poll((uint32_t)start, found);
+    if (scanner.scans() != scans) {
+      if (scans > 0) {
+        scan_waits.push_back(start - due);
+      }
+      scheduler.record(keypad_client, (uint32_t)start, (uint32_t)(clock.now - start), 0);
+    }
+    scheduler.reserve(keypad_client, scanner.next_scan());
+    for (size_t i = 0; i < n; i++) {
+      edges.push_back(found[i]);
+      if (found[i].down) {
+        redraw();
+      }
+    }
+
+    // bus_scheduler
+    if (scheduled) {
+      while (scheduler.step((uint32_t)clock.now)) {
+      }
+    }
+
+    // the interval of config.yaml
+    if (clock.now >= next_redraw) {
+      next_redraw += DISPLAY_INTERVAL_US;
+      redraw();
+    }
+
+    clock.now += LOOP_US;
+    if (!scanner.fast() && scheduler.idle() && clock.now < start + MAIN_LOOP_US) {
+      clock.now = start + MAIN_LOOP_US;
+    }
+  }
+
+  // The display update: the characters of the next frame, then the frame queued or written
+  void redraw() {
+    frames++;
+    uint32_t s = (uint32_t)(clock.now / 1e6);
+    char row[17];
+    snprintf(row, sizeof(row), "TIME LEFT: %02u:%02u", 99 - s / 60 % 100, 59 - s % 60);
+    memcpy(chars, row, 16);
+    for (int i = 0; i < 16; i++) {
+      chars[16 + i] = i < (int)(frames % 17) ? 0xff : ' ';
+    }
+    using namespace esphome::lcd_burst;
+    if (scheduled) {
+      size_t len = encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, frame, sizeof(frame));
+      scheduler.queue(lcd_client, frame, len, PCF8574_E);
+    } else {
+      uint8_t buf[MAX_FRAME_BYTES];
+      lcd.write_traced(buf, encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, buf, sizeof(buf)));
+    }
+  }
+
+  BusClock clock;
+  TracedKeypadModel keypad;
+  TracedLcdModel lcd;
+  esphome::pcf8574_keypad::KeypadScanner scanner;
+  esphome::bus_scheduler::TransactionScheduler scheduler;
+  const bool scheduled;
+  uint8_t keypad_client;
+  uint8_t lcd_client;
+
+  std::vector<esphome::pcf8574_keypad::KeyEdge> edges;
+  std::vector<double> scan_waits; // from the time a scan was due to its start, us
+  uint32_t frames = 0;
+  uint8_t chars[32] = {};         // the characters of the last frame
+
+private:
+  uint8_t frame[esphome::lcd_burst::MAX_FRAME_BYTES];
+  double next_redraw = DISPLAY_INTERVAL_US;
+};
@@ -0,0 +1,76 @@
+// Creates and applies delta OTA patches (see ota_delta.h).
+//
+// Usage:
+//   ant_delta diff <old.ota.bin> <new.ota.bin> <patch.antp>
+//   ant_delta apply <old.ota.bin> <patch.antp> <new.ota.bin>
+//
+// The old image must be the firmware that is currently running on the device. `apply` uses the same decoder as the
+// device, so it can be used to check a patch before uploading it.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "delta_diff.hpp"
+
+static bool read_file(const char *path, delta_diff::bytes &data) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    fprintf(stderr, "can't read %s\n", path);
+    return false;
+  }
+  data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  return true;
+}
+
+static bool write_file(const char *path, const delta_diff::bytes &data) {
+  std::ofstream f(path, std::ios::binary);
+  f.write((const char *)data.data(), data.size());
+  if (!f) {
+    fprintf(stderr, "can't write %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+static int usage() {
+  fprintf(stderr, "usage: ant_delta diff <old> <new> <patch>\n"
+                  "       ant_delta apply <old> <patch> <new>\n");
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  if (argc != 5)
+    return usage();
+
+  delta_diff::bytes old, in, out;
+  if (!read_file(argv[2], old) || !read_file(argv[3], in))
+    return 1;
+
+  if (strcmp(argv[1], "diff") == 0) {
+    uint8_t id[esphome::web_server::OTADeltaDecoder::ID_SIZE];
+    if (!delta_diff::image_id(old, id))
+      printf("warning: %s is not an ESP32 app image, the device won't be able to check the base image\n", argv[2]);
+    out = delta_diff::diff(old, in);
+
+    // Verify the patch before anyone uploads it
+    delta_diff::bytes check;
+    if (delta_diff::apply(old, out, check) != esphome::web_server::OTADeltaDecoder::OK || check != in) {
+      fprintf(stderr, "internal error: patch doesn't reproduce %s\n", argv[3]);
+      return 1;
+    }
+    printf("%s: %zu bytes (%.1f%% of %zu)\n", argv[4], out.size(), 100.0 * out.size() / in.size(), in.size());
+  } else if (strcmp(argv[1], "apply") == 0) {
+    auto err = delta_diff::apply(old, in, out);
+    if (err != esphome::web_server::OTADeltaDecoder::OK) {
+      fprintf(stderr, "patch failed: error %d\n", err);
+      return 1;
+    }
+    printf("%s: %zu bytes\n", argv[4], out.size());
+  } else {
+    return usage();
+  }
+  return write_file(argv[4], out) ? 0 : 1;
+}
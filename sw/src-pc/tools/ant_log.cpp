@@ -0,0 +1,124 @@
+// Token dictionary and decoder of the tokenized log (see src-common/log_tokens.hpp).
+//
+// Usage:
+//   ant_log dict <dictionary> <source>...
+//   ant_log decode [--time] <dictionary> [log]
+//
+// `dict` scans the sources for ANT_LOGI() and ANT_LOGW() calls and writes their formats; the PC build runs it on
+// src-common and config.yaml into build/ant_log.dict. Two formats with the same token are an error.
+//
+// `decode` copies a device log (the file, or stdin, e.g. piped from `esphome logs`) to stdout, with the '$' lines of
+// the records replaced by their text, one line per record. With --time each record starts with its timestamp in
+// seconds since boot and its level.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "../log_decoder.hpp"
+
+static int usage() {
+  fprintf(stderr, "usage: ant_log dict <dictionary> <source>...\n"
+                  "       ant_log decode [--time] <dictionary> [log]\n");
+  return 2;
+}
+
+static int dict(int argc, char **argv) {
+  LogDecoder decoder;
+  size_t calls = 0;
+  size_t text_bytes = 0;
+  for (int i = 3; i < argc; i++) {
+    std::ifstream file(argv[i]);
+    if (!file) {
+      fprintf(stderr, "can't read %s\n", argv[i]);
+      return 1;
+    }
+    std::stringstream source;
+    source << file.rdbuf();
+    std::vector<LogFormat> formats;
+    log_scan(source.str(), formats);
+    for (const LogFormat &f : formats) {
+      if (!decoder.add(f)) {
+        fprintf(stderr, "%s: token %08x of \"%s\" is taken by \"%s\"\n", argv[i], f.token(), f.format.c_str(),
+                decoder.formats[f.token()].format.c_str());
+        return 1;
+      }
+      calls++;
+    }
+  }
+  for (const auto &[token, f] : decoder.formats) {
+    text_bytes += f.tag.size() + f.format.size() + 2;
+  }
+  if (!decoder.save(argv[2])) {
+    fprintf(stderr, "can't write %s\n", argv[2]);
+    return 1;
+  }
+  printf("%s: %zu formats of %zu calls, %zu bytes of strings\n", argv[2], decoder.formats.size(), calls, text_bytes);
+  return 0;
+}
+
+// The base64 text after the '$' of a record line (esphome adds the level, the tag and colors around it), or "" if
+// the line has none
+static std::string record_text(const std::string &line) {
+  size_t start = line.find("]: $");
+  if (start == std::string::npos) {
+    return "";
+  }
+  start += 4;
+  size_t end = start;
+  while (end < line.size() && (isalnum((unsigned char)line[end]) || strchr("+/=", line[end]))) {
+    end++;
+  }
+  return line.substr(start, end - start);
+}
+
+static int decode(int argc, char **argv) {
+  int arg = 2;
+  bool times = arg < argc && strcmp(argv[arg], "--time") == 0;
+  if (times) {
+    arg++;
+  }
+  if (arg >= argc || argc - arg > 2) {
+    return usage();
+  }
+  LogDecoder decoder;
+  if (!decoder.load(argv[arg])) {
+    fprintf(stderr, "can't read the dictionary %s\n", argv[arg]);
+    return 1;
+  }
+  std::ifstream file;
+  if (arg + 1 < argc) {
+    file.open(argv[arg + 1]);
+    if (!file) {
+      fprintf(stderr, "can't read %s\n", argv[arg + 1]);
+      return 1;
+    }
+  }
+  std::istream &in = arg + 1 < argc ? file : std::cin;
+
+  std::string line;
+  while (std::getline(in, line)) {
+    std::vector<uint8_t> records;
+    std::string text = record_text(line);
+    if (text.empty() || !LogDecoder::unbase64(text, records)) {
+      std::cout << line << '\n';
+      continue;
+    }
+    std::string out;
+    decoder.decode(records.data(), records.size(), out, times);
+    std::cout << out << std::flush;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 4 && strcmp(argv[1], "dict") == 0)
+    return dict(argc, argv);
+  if (argc >= 3 && strcmp(argv[1], "decode") == 0)
+    return decode(argc, argv);
+  return usage();
+}
@@ -0,0 +1,95 @@
+// Builds and lists web UI partition images (see ui_assets.h).
+//
+// Usage:
+//   ant_ui pack <image> <name>=<file>[:<content type>]...
+//   ant_ui list <image>
+//
+// `name` is the URL path the asset is served at, e.g. `/=index.html.gz`. Gzip compressed files are served as such,
+// the content type defaults to the one of the file extension (without `.gz`). `list` loads the image with the same
+// code as the device, so it can be used to check an image before uploading it.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "ui_pack.hpp"
+
+static bool read_file(const char *path, ui_pack::bytes &data) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    fprintf(stderr, "can't read %s\n", path);
+    return false;
+  }
+  data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  return true;
+}
+
+static bool write_file(const char *path, const ui_pack::bytes &data) {
+  std::ofstream f(path, std::ios::binary);
+  f.write((const char *)data.data(), data.size());
+  if (!f) {
+    fprintf(stderr, "can't write %s\n", path);
+    return false;
+  }
+  return true;
+}
+
+static int usage() {
+  fprintf(stderr, "usage: ant_ui pack <image> <name>=<file>[:<content type>]...\n"
+                  "       ant_ui list <image>\n");
+  return 2;
+}
+
+static int list(const char *path) {
+  ui_pack::bytes image;
+  if (!read_file(path, image))
+    return 1;
+  ui_pack::UIAssetImage assets;
+  auto err = assets.load(image.data(), image.size(), true);
+  if (err != ui_pack::UIAssetImage::OK) {
+    fprintf(stderr, "%s: %s\n", path, ui_pack::UIAssetImage::error_str(err));
+    return 1;
+  }
+  for (const auto &asset : assets.assets()) {
+    printf("%-20s %8u  %-24s%s\n", asset.name, asset.size, asset.content_type, asset.gzip ? " gzip" : "");
+  }
+  printf("%s: %u bytes\n", path, assets.size());
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc == 3 && strcmp(argv[1], "list") == 0)
+    return list(argv[2]);
+  if (argc < 4 || strcmp(argv[1], "pack") != 0)
+    return usage();
+
+  std::vector<ui_pack::Asset> assets;
+  for (int i = 3; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t eq = arg.find('=');
+    if (eq == std::string::npos)
+      return usage();
+    ui_pack::Asset asset;
+    asset.name = arg.substr(0, eq);
+    std::string file = arg.substr(eq + 1);
+    size_t colon = file.find(':');
+    if (colon != std::string::npos) {
+      asset.content_type = file.substr(colon + 1);
+      file.resize(colon);
+    } else {
+      asset.content_type = ui_pack::content_type_of(file);
+    }
+    if (!read_file(file.c_str(), asset.data))
+      return 1;
+    assets.push_back(std::move(asset));
+  }
+  if (const char *error = ui_pack::check(assets)) {
+    fprintf(stderr, "%s\n", error);
+    return 1;
+  }
+  if (!write_file(argv[2], ui_pack::pack(assets)))
+    return 1;
+  return list(argv[2]);
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+// Patch generator for delta OTA updates, the counterpart of OTADeltaDecoder (see ota_delta.h for the patch format).
+//
+// This is the bsdiff algorithm with a hash chain instead of a suffix array for the match search: firmware images are
+// small enough that a bounded chain walk finds practically the same matches, and it needs far less memory and code.
+// Used by tools/ant_delta.cpp and unit/unit_ota_delta.cpp.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../../src-esphome/mycomponents/web_server/ota/ota_delta.h"
+
+namespace delta_diff {
+
+using esphome::web_server::OTADeltaDecoder;
+using esphome::web_server::OTASha256;
+using bytes = std::vector<uint8_t>;
+
+static const size_t MIN_MATCH = 8;
+static const int CHAIN_DEPTH = 32;
+static const uint32_t HASH_BITS = 16;
+static const uint32_t ESP_IMAGE_MAGIC = 0xE9;
+static const uint32_t ESP_APP_DESC_MAGIC = 0xABCD5432;
+static const size_t ESP_APP_DESC_OFFSET = 32;
+
+inline uint32_t read_le32(const uint8_t *p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+inline void put_le32(bytes &out, uint32_t v) {
+  for (int i = 0; i < 4; i++)
+    out.push_back(uint8_t(v >> (8 * i)));
+}
+
+inline void put_varint(bytes &out, uint32_t v) {
+  while (v >= 0x80) {
+    out.push_back(uint8_t(v) | 0x80);
+    v >>= 7;
+  }
+  out.push_back(uint8_t(v));
+}
+
+inline void put_zigzag(bytes &out, int32_t v) { put_varint(out, (uint32_t(v) << 1) ^ uint32_t(v >> 31)); }
+
+/// Returns true and fills id if the image is an ESP32 app image with an app descriptor.
+inline bool image_id(const bytes &image, uint8_t id[OTADeltaDecoder::ID_SIZE]) {
+  if (image.size() < OTADeltaDecoder::APP_ELF_SHA256_OFFSET + OTADeltaDecoder::ID_SIZE || image[0] != ESP_IMAGE_MAGIC ||
+      read_le32(&image[ESP_APP_DESC_OFFSET]) != ESP_APP_DESC_MAGIC)
+    return false;
+  memcpy(id, &image[OTADeltaDecoder::APP_ELF_SHA256_OFFSET], OTADeltaDecoder::ID_SIZE);
+  return true;
+}
+
+/// Finds the longest match for nu[scan..] in old using the hash chains. Returns the length, position in *pos.
+class Matcher {
+public:
+  explicit Matcher(const bytes &old) : old_(old), head_(1u << HASH_BITS, -1), prev_(old.size(), -1) {
+    for (size_t i = 0; i + MIN_MATCH <= old.size(); i++) {
+      uint32_t h = hash(&old[i]);
+      prev_[i] = head_[h];
+      head_[h] = int32_t(i);
+    }
+  }
+
+  size_t search(const bytes &nu, size_t scan, size_t *pos) const {
+    size_t best = 0;
+    if (scan + MIN_MATCH > nu.size())
+      return 0;
+    int32_t cand = head_[hash(&nu[scan])];
+    for (int depth = 0; cand >= 0 && depth < CHAIN_DEPTH; depth++, cand = prev_[cand]) {
+      size_t len = 0;
+      while (cand + len < old_.size() && scan + len < nu.size() && old_[cand + len] == nu[scan + len])
+        len++;
+      if (len > best) {
+        best = len;
+        *pos = cand;
+      }
+    }
+    return best;
+  }
+
+private:
+  static uint32_t hash(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return uint32_t((v * 0x9E3779B97F4A7C15ull) >> (64 - HASH_BITS));
+  }
+
+  const bytes &old_;
+  std::vector<int32_t> head_;
+  std::vector<int32_t> prev_;
+};
+
+/// Run length encodes a diff section as { zero_run, literal_run, literal bytes } pairs.
+inline void put_diff(bytes &out, const uint8_t *diff, size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    size_t zeros = 0;
+    while (i + zeros < len && diff[i + zeros] == 0)
+      zeros++;
+    i += zeros;
+    // a literal run ends at 4 consecutive zeros, shorter gaps are cheaper to keep inline
+    size_t lit = 0;
+    while (i + lit < len) {
+      size_t gap = 0;
+      while (i + lit + gap < len && diff[i + lit + gap] == 0 && gap < 4)
+        gap++;
+      if (gap == 4 || i + lit + gap == len)
+        break;
+      lit += gap + 1;
+    }
+    put_varint(out, zeros);
+    put_varint(out, lit);
+    out.insert(out.end(), diff + i, diff + i + lit);
+    i += lit;
+  }
+}
+
+/// Creates a patch that turns old into nu.
+inline bytes diff(const bytes &old, const bytes &nu) {
+  bytes out;
+  out.insert(out.end(), {'A', 'N', 'T', 'P', OTADeltaDecoder::VERSION, 0, 0, 0});
+  put_le32(out, old.size());
+  put_le32(out, nu.size());
+  uint8_t id[OTADeltaDecoder::ID_SIZE] = {};
+  image_id(old, id);
+  out.insert(out.end(), id, id + sizeof(id));
+  uint8_t digest[OTASha256::DIGEST_SIZE];
+  OTASha256 sha;
+  sha.update(nu.data(), nu.size());
+  sha.final(digest);
+  out.insert(out.end(), digest, digest + sizeof(digest));
+
+  const Matcher matcher(old);
+  const int64_t old_size = old.size(), new_size = nu.size();
+  int64_t scan = 0, len = 0, last_scan = 0, last_pos = 0, last_offset = 0;
+  size_t pos = 0;
+  bytes diff_buf;
+
+  while (scan < new_size) {
+    int64_t old_score = 0;
+    int64_t scsc = scan += len;
+    // Advance until there's a match that is clearly better than continuing with the current alignment
+    for (; scan < new_size; scan++) {
+      len = matcher.search(nu, scan, &pos);
+      for (; scsc < scan + len; scsc++)
+        if (scsc + last_offset >= 0 && scsc + last_offset < old_size && old[scsc + last_offset] == nu[scsc])
+          old_score++;
+      if ((len == old_score && len != 0) || len > old_score + 8)
+        break;
+      if (scan + last_offset >= 0 && scan + last_offset < old_size && old[scan + last_offset] == nu[scan])
+        old_score--;
+    }
+    if (len == old_score && scan != new_size)
+      continue;
+
+    // Extend the previous match forwards and the new one backwards, allowing mismatches while >50% of bytes match
+    int64_t s = 0, best = 0, len_f = 0;
+    for (int64_t i = 0; last_scan + i < scan && last_pos + i < old_size;) {
+      if (old[last_pos + i] == nu[last_scan + i])
+        s++;
+      i++;
+      if (s * 2 - i > best * 2 - len_f) {
+        best = s;
+        len_f = i;
+      }
+    }
+    int64_t len_b = 0;
+    if (scan < new_size) {
+      s = 0;
+      best = 0;
+      for (int64_t i = 1; scan >= last_scan + i && int64_t(pos) >= i; i++) {
+        if (old[pos - i] == nu[scan - i])
+          s++;
+        if (s * 2 - i > best * 2 - len_b) {
+          best = s;
+          len_b = i;
+        }
+      }
+    }
+    if (last_scan + len_f > scan - len_b) {
+      int64_t overlap = (last_scan + len_f) - (scan - len_b), lens = 0;
+      s = 0;
+      best = 0;
+      for (int64_t i = 0; i < overlap; i++) {
+        if (nu[last_scan + len_f - overlap + i] == old[last_pos + len_f - overlap + i])
+          s++;
+        if (nu[scan - len_b + i] == old[pos - len_b + i])
+          s--;
+        if (s > best) {
+          best = s;
+          lens = i + 1;
+        }
+      }
+      len_f += lens - overlap;
+      len_b -= lens;
+    }
+
+    int64_t extra = (scan - len_b) - (last_scan + len_f);
+    put_varint(out, len_f);
+    put_varint(out, extra);
+    put_zigzag(out, int32_t((int64_t(pos) - len_b) - (last_pos + len_f)));
+    diff_buf.resize(len_f);
+    for (int64_t i = 0; i < len_f; i++)
+      diff_buf[i] = nu[last_scan + i] - old[last_pos + i];
+    put_diff(out, diff_buf.data(), diff_buf.size());
+    out.insert(out.end(), nu.begin() + last_scan + len_f, nu.begin() + scan - len_b);
+
+    last_scan = scan - len_b;
+    last_pos = pos - len_b;
+    last_offset = pos - scan;
+  }
+  return out;
+}
+
+/// Applies a patch with the device decoder. Returns the decoder result, the new image in nu.
+inline OTADeltaDecoder::Error apply(const bytes &old, const bytes &patch, bytes &nu, size_t chunk = 1460) {
+  nu.clear();
+  uint8_t id[OTADeltaDecoder::ID_SIZE];
+  bool has_id = image_id(old, id);
+  OTADeltaDecoder decoder(
+      [&](uint32_t offset, uint8_t *buf, size_t len) {
+        memcpy(buf, &old[offset], len);
+        return true;
+      },
+      old.size(), has_id ? id : nullptr,
+      [&](const uint8_t *data, size_t len) {
+        nu.insert(nu.end(), data, data + len);
+        return uint8_t(0);
+      });
+  for (size_t i = 0; i < patch.size(); i += chunk) {
+    size_t len = std::min(chunk, patch.size() - i);
+    OTADeltaDecoder::Error err = decoder.feed(&patch[i], len);
+    if (err != OTADeltaDecoder::OK)
+      return err;
+  }
+  return decoder.finish();
+}
+
+} // namespace delta_diff
@@ -0,0 +1,64 @@
+// Runs the game on the PC and serves the remote keypad, to try the phone keypad page without a prop.
+//
+// Usage: remote_keypad_server [port [keypad.html]]
+// Then open http://<pc address>:<port>/ (default 8080) on the phone. The LCD is also printed to the console.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#include "../../src-common/gm_manager.hpp"
+#include "../remote_keypad_host.hpp"
+
+static uint32_t start_ms = 0;
+uint32_t esphome::millis() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count() - start_ms;
+}
+
+int main(int argc, char **argv) {
+  uint16_t port = argc > 1 ? atoi(argv[1]) : 8080;
+  const char *page_path = argc > 2 ? argv[2] : "../src-esphome/keypad.html";
+  std::ifstream f(page_path);
+  if (!f) {
+    fprintf(stderr, "can't read %s\n", page_path);
+    return 1;
+  }
+  std::string page((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+  RemoteKeypadHost host(page);
+  if (!host.start(port)) {
+    fprintf(stderr, "can't listen on port %u\n", port);
+    return 1;
+  }
+  printf("Remote keypad on http://localhost:%u/\n", port);
+
+  start_ms = esphome::millis();
+  AntGlobals antg;
+  GameManager game_manager(antg);
+  esphome::lcd_base::LCDDisplay display;
+  auto update_display = [&]() {
+    game_manager.display_update(display);
+    host.set_frame(lcd_capture(display));
+    display.present();
+  };
+
+  // Like the device: the game clock ticks every 50ms, keys are applied as soon as the main loop sees them
+  uint32_t last_clock = esphome::millis();
+  for (;;) {
+    host.loop([&](unsigned char key) {
+      game_manager.handle_key(key);
+      update_display();
+    });
+    uint32_t now = esphome::millis();
+    if (now - last_clock >= 50) {
+      game_manager.clock(now, now - last_clock);
+      last_clock = now;
+      update_display();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
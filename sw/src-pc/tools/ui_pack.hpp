@@ -0,0 +1,93 @@
+#pragma once
+
+// Packer for web UI partition images, the counterpart of UIAssetImage (see ui_assets.h for the image format).
+// Used by tools/ant_ui.cpp and unit/unit_ui_assets.cpp.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../src-esphome/mycomponents/web_server/ui_assets.h"
+
+namespace ui_pack {
+
+using esphome::web_server::UIAssetImage;
+using bytes = std::vector<uint8_t>;
+
+struct Asset {
+  std::string name;
+  std::string content_type;
+  bytes data;
+};
+
+inline void put_le32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++)
+    p[i] = uint8_t(v >> (8 * i));
+}
+
+/// Gzip encoded data is recognized by its magic and served with `Content-Encoding: gzip`.
+inline bool is_gzip(const bytes &data) { return data.size() >= 2 && data[0] == 0x1F && data[1] == 0x8B; }
+
+/// Content type by file extension, for assets that don't give one.
+inline std::string content_type_of(const std::string &path) {
+  static const char *const TYPES[][2] = {
+      {".html", "text/html"}, {".htm", "text/html"},          {".js", "application/javascript"},
+      {".css", "text/css"},   {".json", "application/json"}, {".svg", "image/svg+xml"},
+      {".png", "image/png"},  {".ico", "image/x-icon"},      {".txt", "text/plain"},
+  };
+  std::string p = path;
+  if (p.size() > 3 && p.compare(p.size() - 3, 3, ".gz") == 0)
+    p.resize(p.size() - 3);
+  for (const auto &type : TYPES) {
+    size_t len = strlen(type[0]);
+    if (p.size() >= len && p.compare(p.size() - len, len, type[0]) == 0)
+      return type[1];
+  }
+  return "application/octet-stream";
+}
+
+/// Checks the names and content types of the assets, returns an error message or nullptr.
+inline const char *check(const std::vector<Asset> &assets) {
+  if (assets.size() > UIAssetImage::MAX_ASSETS)
+    return "too many assets";
+  for (const Asset &a : assets) {
+    if (a.name.empty() || a.name[0] != '/')
+      return "asset names are URL paths and start with /";
+    if (a.name.size() >= UIAssetImage::NAME_SIZE)
+      return "asset name too long";
+    if (a.content_type.size() >= UIAssetImage::CONTENT_TYPE_SIZE)
+      return "content type too long";
+    for (const Asset &b : assets) {
+      if (&a != &b && a.name == b.name)
+        return "duplicate asset name";
+    }
+  }
+  return nullptr;
+}
+
+/// Builds the image, the assets must pass check().
+inline bytes pack(const std::vector<Asset> &assets) {
+  size_t index_end = UIAssetImage::HEADER_SIZE + assets.size() * UIAssetImage::ENTRY_SIZE;
+  bytes out(index_end, 0);
+  for (size_t i = 0; i < assets.size(); i++) {
+    const Asset &a = assets[i];
+    uint8_t *entry = out.data() + UIAssetImage::HEADER_SIZE + i * UIAssetImage::ENTRY_SIZE;
+    memcpy(entry, a.name.data(), a.name.size());
+    memcpy(entry + UIAssetImage::NAME_SIZE, a.content_type.data(), a.content_type.size());
+    put_le32(entry + 80, out.size());
+    put_le32(entry + 84, a.data.size());
+    put_le32(entry + 88, UIAssetImage::crc32(0, a.data.data(), a.data.size()));
+    entry[92] = is_gzip(a.data) ? UIAssetImage::FLAG_GZIP : 0;
+    out.insert(out.end(), a.data.begin(), a.data.end());
+  }
+  memcpy(out.data(), "ANTU", 4);
+  out[4] = UIAssetImage::VERSION;
+  out[5] = assets.size();
+  put_le32(out.data() + 8, out.size());
+  put_le32(out.data() + 12, UIAssetImage::crc32(0, out.data() + UIAssetImage::HEADER_SIZE,
+                                                 index_end - UIAssetImage::HEADER_SIZE));
+  return out;
+}
+
+}  // namespace ui_pack
@@ -0,0 +1,68 @@
+#pragma once
+
+// The key sequences of the LCD snapshot tests (src-pc/tests, the first line of each test) for the unit tests that
+// replay them against the game.
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "../../src-common/globals.hpp"
+
+// Plays a sequence: key(k) for each key, edge(k, down) for each edge of a key with long presses (C_DOWN, STAR_UP, ...),
+// advance(ms) for each DELAY; web requests (SETUP=) are skipped. Returns false on a token it doesn't know.
+template <typename Key, typename Edge, typename Advance>
+bool play_sequence(const std::string &sequence, Key key, Edge edge, Advance advance) {
+  static const std::pair<const char *, unsigned char> NAMED[] = {
+      {"RED", KEY_RED},
+      {"RED_RELEASE", KEY_RED_RELEASE},
+      {"YELLOW", KEY_YELLOW},
+      {"YELLOW_RELEASE", KEY_YELLOW_RELEASE},
+      {"RESET", KEY_RESET},
+      {"C_LONG", KEY_C_LONG},
+  };
+  static const std::pair<const char *, unsigned char> EDGES[] = {{"C", KEY_C}, {"D", KEY_D}, {"STAR", KEY_STAR}};
+  std::stringstream ss(sequence);
+  std::string token;
+  while (std::getline(ss, token, ',')) {
+    if (token.rfind("DELAY=", 0) == 0) {
+      advance((uint32_t)std::stoi(token.substr(6)));
+    } else if (token.rfind("SETUP=", 0) == 0) {
+      continue; // a web request, not a key
+    } else if (token.length() == 1) {
+      key((unsigned char)token[0]);
+    } else {
+      auto named = std::find_if(std::begin(NAMED), std::end(NAMED), [&](auto &n) { return token == n.first; });
+      auto edged = std::find_if(std::begin(EDGES), std::end(EDGES), [&](auto &e) {
+        return token == std::string(e.first) + "_DOWN" || token == std::string(e.first) + "_UP";
+      });
+      if (named != std::end(NAMED)) {
+        key(named->second);
+      } else if (edged != std::end(EDGES)) {
+        edge(edged->second, token.back() == 'N');
+      } else {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Calls test(name, sequence) for each snapshot test in dir, returns the number of tests
+template <typename Test> size_t for_each_snapshot_game(const char *dir, Test test) {
+  size_t games = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+    std::string name = entry.path().filename().string();
+    if (name.rfind("test_", 0) != 0) {
+      continue;
+    }
+    std::ifstream file(entry.path());
+    std::string sequence;
+    std::getline(file, sequence);
+    test(name, sequence);
+    games++;
+  }
+  return games;
+}
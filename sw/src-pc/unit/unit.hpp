@@ -0,0 +1,27 @@
+#pragma once
+
+// Minimal assertion helpers for the host-side unit tests in src-pc/unit.
+// Each test is a standalone executable registered with ctest, which treats a non-zero exit code as failure.
+
+#include <cstdio>
+
+// NOLINTBEGIN(misc-definitions-in-headers)
+int unit_failures = 0;
+// NOLINTEND(misc-definitions-in-headers)
+
+#define CHECK(cond)                                                                                                    \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);                                                  \
+      unit_failures++;                                                                                                 \
+    }                                                                                                                  \
+  } while (0)
+
+inline int unit_result(const char *name) {
+  if (unit_failures) {
+    printf("FAIL: %s (%d checks failed)\n", name, unit_failures);
+    return 1;
+  }
+  printf("PASS: %s\n", name);
+  return 0;
+}
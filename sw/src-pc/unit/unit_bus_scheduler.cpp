@@ -0,0 +1,192 @@
+// Bus scheduler (src-esphome/mycomponents/bus_scheduler/transaction_scheduler.h): the chunks of a frame, the
+// reservations that hold them back, the statistics, and the keypad and the LCD on one bus (src-pc/shared_bus_sim.hpp)
+// with and without it, while the LCD animates a progress bar.
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../shared_bus_sim.hpp"
+#include "unit.hpp"
+
+using namespace esphome::bus_scheduler;
+using namespace esphome::lcd_burst;
+
+struct ChunkLog : ChunkWriter {
+  bool write_chunk(const uint8_t *data, size_t len) override {
+    chunks.emplace_back(data, data + len);
+    return ok;
+  }
+
+  std::vector<std::vector<uint8_t>> chunks;
+  bool ok = true;
+};
+
+static size_t test_frame(uint8_t *buf) {
+  uint8_t chars[32];
+  memcpy(chars, "TIME LEFT: 01:23\xff\xff\xff\xff\xff      T1:4 \xff", 32);
+  return encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, buf, MAX_FRAME_BYTES);
+}
+
+static void test_chunks() {
+  ChunkLog log;
+  TransactionScheduler scheduler;
+  scheduler.set_frequency(300000);
+  uint8_t lcd = scheduler.add_client("lcd", &log);
+  CHECK(scheduler.idle() && !scheduler.step(0));
+
+  uint8_t frame[MAX_FRAME_BYTES];
+  size_t len = test_frame(frame);
+  scheduler.queue(lcd, frame, len, PCF8574_E);
+  CHECK(!scheduler.idle());
+  uint32_t now = 0;
+  while (scheduler.step(now)) {
+    now += scheduler.write_us(log.chunks.back().size());
+  }
+  CHECK(scheduler.done(lcd) && scheduler.idle());
+
+  // chunks of at most 500us on the bus, each with whole bytes for the LCD (pairs of nibbles, each a pulse of E),
+  // together the frame
+  std::vector<uint8_t> all;
+  for (const auto &chunk : log.chunks) {
+    CHECK(scheduler.write_us(chunk.size()) <= 500);
+    CHECK(chunk.size() >= TransactionScheduler::MIN_CHUNK);
+    CHECK(!(chunk.back() & PCF8574_E));
+    int pulses = 0;
+    for (size_t i = 1; i < chunk.size(); i++) {
+      pulses += (chunk[i - 1] & PCF8574_E) && !(chunk[i] & PCF8574_E);
+    }
+    CHECK(pulses % 2 == 0);
+    all.insert(all.end(), chunk.begin(), chunk.end());
+  }
+  CHECK(all == std::vector<uint8_t>(frame, frame + len));
+  // 15 bytes fit into 500us at 300 kHz, 3 characters of 4 bytes
+  CHECK(log.chunks.size() == 12);
+  CHECK(scheduler.stats(lcd).transactions == 12 && scheduler.stats(lcd).bytes == len);
+}
+
+static void test_reservations() {
+  ChunkLog log;
+  TransactionScheduler scheduler;
+  scheduler.set_frequency(300000);
+  uint8_t keypad = scheduler.add_client("keypad");
+  uint8_t lcd = scheduler.add_client("lcd", &log);
+  uint8_t frame[MAX_FRAME_BYTES];
+  scheduler.queue(lcd, frame, test_frame(frame), PCF8574_E);
+
+  // a scan 200us ahead: a shorter chunk, then none until the scan
+  scheduler.reserve(keypad, 1200);
+  CHECK(scheduler.step(1000));
+  CHECK(scheduler.write_us(log.chunks.back().size()) <= 200);
+  CHECK(!scheduler.step(1000 + scheduler.write_us(log.chunks.back().size())));
+  CHECK(!scheduler.step(1200));
+  scheduler.record(keypad, 1250, 70, 1);
+  CHECK(scheduler.stats(keypad).max_wait_us == 50);
+  CHECK(scheduler.step(1320));
+
+  // a reservation that isn't taken holds the chunks for the slot time
+  size_t chunks = log.chunks.size();
+  scheduler.reserve(keypad, 2000);
+  CHECK(!scheduler.step(2000) && !scheduler.step(2999));
+  CHECK(scheduler.step(3000) && log.chunks.size() == chunks + 1);
+
+  // a new frame starts over
+  uint8_t next[MAX_FRAME_BYTES];
+  size_t len = test_frame(next);
+  next[len - 1] = 0x5a;  // the last byte tells them apart
+  scheduler.queue(lcd, next, len, PCF8574_E);
+  log.chunks.clear();
+  uint32_t now = 5000;
+  while (scheduler.step(now)) {
+    now += 1000;
+  }
+  std::vector<uint8_t> all;
+  for (const auto &chunk : log.chunks) {
+    all.insert(all.end(), chunk.begin(), chunk.end());
+  }
+  CHECK(all == std::vector<uint8_t>(next, next + len));
+}
+
+static void test_errors_and_stats() {
+  ChunkLog log;
+  TransactionScheduler scheduler;
+  scheduler.set_frequency(300000);
+  uint8_t keypad = scheduler.add_client("keypad");
+  uint8_t lcd = scheduler.add_client("lcd", &log);
+  uint8_t frame[MAX_FRAME_BYTES];
+  scheduler.queue(lcd, frame, test_frame(frame), PCF8574_E);
+
+  // a failed chunk drops the rest of the frame
+  log.ok = false;
+  CHECK(scheduler.step(0) && scheduler.done(lcd) && scheduler.stats(lcd).errors == 1);
+  CHECK(!scheduler.step(1000));
+
+  scheduler.reserve(keypad, 10000);
+  scheduler.record(keypad, 10300, 200, 1);
+  char line[200];
+  scheduler.format(line, sizeof(line), 1000000);
+  CHECK(std::string(line).find("keypad 0.0% 1/s max 200us wait 300us, lcd") == 0);
+  scheduler.reset_stats();
+  CHECK(scheduler.stats(keypad).transactions == 0 && scheduler.stats(keypad).max_wait_us == 0);
+
+  // too many devices
+  for (uint8_t i = scheduler.clients(); i < TransactionScheduler::MAX_CLIENTS; i++) {
+    CHECK(scheduler.add_client("more") == i);
+  }
+  CHECK(scheduler.add_client("one too many") == TransactionScheduler::MAX_CLIENTS);
+}
+
+// A session with the progress bar running: C held for 2s, then taps
+static void play(SharedBusSim &sim) {
+  sim.run_until(500000);
+  sim.keypad.set('C', true);
+  sim.run_until(2500000);
+  sim.keypad.set('C', false);
+  for (int i = 0; i < 8; i++) {
+    sim.run_until(2700000 + i * 250000);
+    sim.keypad.set('5', true);
+    sim.run_until(2800000 + i * 250000);
+    sim.keypad.set('5', false);
+  }
+  sim.run_until(5000000);
+}
+
+static void test_shared_bus() {
+  SharedBusSim alone(300000, false);
+  play(alone);
+  SharedBusSim scheduled(300000, true);
+  play(scheduled);
+
+  // the same keys, the LCD as fresh
+  CHECK(scheduled.edges.size() == 18 && alone.edges.size() == 18);
+  CHECK(scheduled.frames >= alone.frames);
+  CHECK(scheduled.scheduler.idle());
+  CHECK(scheduled.lcd.row(0, 16) == std::string((const char *)scheduled.chars, 16));
+  CHECK(scheduled.lcd.row(1, 16) == std::string((const char *)scheduled.chars + 16, 16));
+  CHECK(scheduled.lcd.busy_nibbles == 0 && scheduled.lcd.rs_violations == 0);
+
+  // a frame holds up a scan by its 4ms alone, with the scheduler a scan waits for no more than a pass of the loop (the
+  // other components and the last scan, the idle loop starts its 16ms at the start of a pass)
+  double alone_wait = *std::max_element(alone.scan_waits.begin(), alone.scan_waits.end());
+  double scheduled_wait = *std::max_element(scheduled.scan_waits.begin(), scheduled.scan_waits.end());
+  CHECK(alone_wait > 3000);
+  CHECK(scheduled_wait <= SharedBusSim::LOOP_US + 200);
+
+  // in the trace: one transaction at a time, the chunks short
+  for (size_t i = 1; i < scheduled.clock.trace.size(); i++) {
+    const BusTransaction &t = scheduled.clock.trace[i];
+    CHECK(t.start >= scheduled.clock.trace[i - 1].end);
+    if (t.device == BUS_LCD) {
+      CHECK(t.end - t.start <= 500);
+    }
+  }
+}
+
+int main() {
+  test_chunks();
+  test_reservations();
+  test_errors_and_stats();
+  test_shared_bus();
+  return unit_result("bus_scheduler");
+}
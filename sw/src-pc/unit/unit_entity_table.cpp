@@ -0,0 +1,203 @@
+#include <string>
+
+#include "../../src-esphome/mycomponents/web_server/entity_table.h"
+#include "unit.hpp"
+
+using esphome::web_server::EntityCursor;
+using esphome::web_server::EntityTable;
+using esphome::web_server::JsonView;
+using esphome::web_server::WebServer;
+
+struct Entity {
+  std::string id;
+  std::string name;
+  bool state;
+  int all_calls;
+};
+
+static Entity red_herring{"binary_sensor-x", "Not in the table", false, 0};
+
+// the state buffer of the web server, overwritten by each state
+static std::string state_buffer;
+
+static JsonView state_json(WebServer *, void *source) {
+  auto *e = (Entity *) source;
+  state_buffer = "{\"id\":\"" + e->id + "\",\"value\":" + (e->state ? "true" : "false") + ",\"state\":\"" +
+                 (e->state ? "ON" : "OFF") + "\"}";
+  return JsonView{state_buffer.data(), state_buffer.size()};
+}
+
+static std::string all_json(WebServer *, void *source) {
+  auto *e = (Entity *) source;
+  e->all_calls++;
+  return "{\"id\":\"" + e->id + "\",\"name\":\"" + e->name + "\",\"icon\":\"\",\"entity_category\":0,\"value\":" +
+         (e->state ? "true" : "false") + ",\"state\":\"" + (e->state ? "ON" : "OFF") + "\"}";
+}
+
+static void test_static_members() {
+  std::string out;
+  CHECK(EntityTable::static_members(R"({"id":"a","name":"A, \"b\"","value":1,"options":["x","}"],"t":{"k":[1]}})",
+                                    R"({"id":"a","value":2})", out));
+  CHECK(out == R"("name":"A, \"b\"","options":["x","}"],"t":{"k":[1]})");
+
+  // everything is live
+  out.clear();
+  CHECK(EntityTable::static_members(R"({"id":"a"})", R"({"id":"a"})", out) && out.empty());
+
+  // a key is only live if it is a key of the state object
+  out.clear();
+  CHECK(EntityTable::static_members(R"({"id":"a","state":"id"})", R"({"state":"x"})", out));
+  CHECK(out == R"("id":"a")");
+
+  out.clear();
+  CHECK(!EntityTable::static_members("[1,2]", "{}", out));
+  CHECK(!EntityTable::static_members(R"({"a":"b)", "{}", out));
+  CHECK(!EntityTable::static_members(R"({"a":1)", "{}", out));
+}
+
+static void test_batches() {
+  Entity red{"binary_sensor-red", "Red", false, 0};
+  Entity yellow{"binary_sensor-yellow", "Yellow", true, 0};
+  Entity reset{"binary_sensor-reset", "Reset", false, 0};
+  EntityTable table;
+  table.add(&red, state_json, all_json, true);
+  table.add(&yellow, state_json, all_json, true);
+  table.add(&reset, state_json, all_json, false);
+  table.build(nullptr);
+  CHECK(table.built() && table.size() == 3);
+  CHECK(red.all_calls == 1 && yellow.all_calls == 1 && reset.all_calls == 0);
+
+  std::string batch;
+  CHECK(table.write_batch(nullptr, 0, 1024, batch) == 3);
+  CHECK(batch == R"([{"id":"binary_sensor-red","value":false,"state":"OFF",)"
+                 R"("name":"Red","icon":"","entity_category":0},)"
+                 R"({"id":"binary_sensor-yellow","value":true,"state":"ON",)"
+                 R"("name":"Yellow","icon":"","entity_category":0},)"
+                 R"({"id":"binary_sensor-reset","name":"Reset","icon":"","entity_category":0,"value":false,)"
+                 R"("state":"OFF"}])");
+  // the cached entities don't build their detail again, the uncached one does
+  CHECK(red.all_calls == 1 && reset.all_calls == 1);
+
+  // the state is live, the name was cached
+  red.state = true;
+  red.name = "Renamed";
+  table.write_batch(nullptr, 0, 1024, batch);
+  CHECK(batch.find(R"({"id":"binary_sensor-red","value":true,"state":"ON","name":"Red")") == 1);
+}
+
+static void test_budget() {
+  Entity entities[10];
+  EntityTable table;
+  for (int i = 0; i < 10; i++) {
+    entities[i] = Entity{"binary_sensor-" + std::to_string(i), "Button", false, 0};
+    table.add(&entities[i], state_json, all_json, true);
+  }
+  table.build(nullptr);
+
+  std::string batch;
+  size_t one = table.write_batch(nullptr, 0, 1, batch);
+  CHECK(one == 1);  // at least one entity, even if it doesn't fit
+  size_t entity_len = batch.size() - 2;
+
+  // as many entities as fit, each entity in exactly one batch
+  size_t max_bytes = 2 + 3 * entity_len + 2 + 10;
+  size_t next = 0, batches = 0, entities_sent = 0;
+  while (next < table.size()) {
+    size_t end = table.write_batch(nullptr, next, max_bytes, batch);
+    CHECK(end > next && batch.size() <= max_bytes);
+    CHECK(batch.front() == '[' && batch.back() == ']');
+    entities_sent += end - next;
+    next = end;
+    batches++;
+  }
+  CHECK(entities_sent == 10 && batches == 4);
+
+  // nothing is left
+  CHECK(table.write_batch(nullptr, 10, max_bytes, batch) == 10 && batch == "[]");
+}
+
+// Sends everything a client is due, returns the entities in the batches and the id of the last batch
+static size_t pass(const EntityTable &table, EntityCursor &cursor, size_t max_bytes, std::string &ids,
+                   uint32_t &last_id) {
+  std::string batch;
+  size_t entities = 0;
+  uint32_t id;
+  while (table.next_batch(nullptr, cursor, max_bytes, batch, id)) {
+    for (size_t i = batch.find("{\"id\""); i != std::string::npos; i = batch.find("{\"id\"", i + 1)) {
+      ids += batch.substr(i + 21, 1);  // the digit after "binary_sensor-"
+      entities++;
+    }
+    if (id != 0)
+      last_id = id;
+    table.consume(cursor);
+  }
+  return entities;
+}
+
+static void test_resume() {
+  Entity entities[10];
+  EntityTable table;
+  for (int i = 0; i < 10; i++) {
+    entities[i] = Entity{"binary_sensor-" + std::to_string(i), "Button", false, 0};
+    table.add(&entities[i], state_json, all_json, true);
+  }
+  table.start_sequence(1000);
+  table.build(nullptr);
+
+  // a new client gets everything, in several batches, only the last one has an id
+  std::string batch;
+  std::string ids;
+  uint32_t id = 0;
+  EntityCursor client = table.cursor(0);
+  CHECK(table.next_batch(nullptr, client, 300, batch, id) && id == 0);
+  CHECK(pass(table, client, 300, ids, id) == 10 && ids == "0123456789" && id == 1000);
+  CHECK(!table.next_batch(nullptr, client, 300, batch, id));
+
+  // then what changed, once
+  table.changed(&entities[7]);
+  table.changed(&entities[3]);
+  table.changed(&entities[7]);
+  table.changed(&red_herring);
+  CHECK(table.seq() == 1003);
+  ids.clear();
+  CHECK(pass(table, client, 300, ids, id) == 2 && ids == "37" && id == 1003);
+
+  // the client drops out and comes back with its last id: only what it missed
+  table.changed(&entities[5]);
+  EntityCursor resumed = table.cursor(1003);
+  ids.clear();
+  CHECK(pass(table, resumed, 300, ids, id) == 1 && ids == "5" && id == 1004);
+
+  // so does an older id: entity 3 changed last at 1002
+  resumed = table.cursor(1001);
+  ids.clear();
+  CHECK(pass(table, resumed, 300, ids, id) == 3 && ids == "357" && id == 1004);
+  resumed = table.cursor(1002);
+  ids.clear();
+  CHECK(pass(table, resumed, 300, ids, id) == 2 && ids == "57" && id == 1004);
+
+  // ids that aren't of this table: everything
+  CHECK(table.cursor(0).full && table.cursor(999).full && table.cursor(1005).full && table.cursor(42).full);
+  CHECK(!table.cursor(1000).full && !table.cursor(1004).full);
+
+  // a change during a pass, of an entity that was sent already, goes out with the next pass
+  client = table.cursor(1000);
+  CHECK(table.next_batch(nullptr, client, 1, batch, id) && id == 0);  // entity 3
+  table.consume(client);
+  table.changed(&entities[3]);
+  ids.clear();
+  CHECK(pass(table, client, 1, ids, id) == 3 && ids == "573" && id == 1005);
+
+  // changes before the table is built are not numbered
+  EntityTable unbuilt;
+  unbuilt.add(&entities[0], state_json, all_json, true);
+  CHECK(unbuilt.cursor(1).full);
+}
+
+int main() {
+  test_static_members();
+  test_batches();
+  test_budget();
+  test_resume();
+  return unit_result("entity_table");
+}
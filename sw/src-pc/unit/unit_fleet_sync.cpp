@@ -0,0 +1,218 @@
+#include <cstdlib>
+#include <vector>
+
+#include "../fleet_loopback.hpp"
+#include "unit.hpp"
+
+// A prop for the tests: a FleetSync with its own free running clock (local = sim time + clock_base)
+struct Prop {
+  FleetSync sync;
+  uint32_t clock_base;
+  FleetLoopbackNetwork::Endpoint *ep;
+  bool on = true;
+
+  uint32_t local(uint32_t sim) const { return sim + clock_base; }
+};
+
+struct Field {
+  FleetLoopbackNetwork net;
+  std::vector<Prop> props;
+  uint32_t sim = 0;
+
+  Field(size_t n, uint32_t latency_ms, float loss) : props(n) {
+    net.latency_ms = latency_ms;
+    net.loss = loss;
+    for (size_t i = 0; i < n; i++) {
+      props[i].clock_base = 1000000 * i + 12345 * (i % 3); // wildly different boot times
+      props[i].ep = &net.add_endpoint();
+      props[i].sync.begin(props[i].ep, 100 + 7 * i);
+    }
+  }
+
+  void run(uint32_t ms) {
+    for (uint32_t end = sim + ms; sim < end; sim += 10) {
+      net.set_time(sim);
+      for (Prop &p : props) {
+        if (p.on) {
+          p.sync.clock(p.local(sim));
+        }
+      }
+    }
+  }
+
+  // Largest difference between the props' shared clocks at the same instant
+  uint32_t clock_spread() const {
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    for (const Prop &p : props) {
+      if (p.on) {
+        int32_t t = p.sync.shared_time(p.local(sim)) - props[0].sync.shared_time(props[0].local(sim));
+        lo = std::min(lo, t);
+        hi = std::max(hi, t);
+      }
+    }
+    return hi - lo;
+  }
+
+  bool agree_on_leader(uint32_t leader) const {
+    for (const Prop &p : props) {
+      if (p.on && p.sync.leader() != leader) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+static void test_messages() {
+  uint8_t buf[FLEET_MAX_MESSAGE];
+  FleetMessage in;
+  in.type = FleetMessage::TYPE::STATE;
+  in.sender = 0xdeadbeef;
+  in.fields = FleetMessage::F_ALL | FleetMessage::F_CLOCK;
+  in.timeline = 77;
+  in.game = {0x12345678, 0xfffffff0, 0x10, 999}; // start_at wrapped around
+  in.state = {2, 123400, 4000000};
+  size_t len = in.encode(buf);
+  CHECK(len <= FLEET_MAX_MESSAGE);
+
+  FleetMessage out;
+  CHECK(out.decode(buf, len));
+  CHECK(out.type == FleetMessage::TYPE::STATE && out.sender == in.sender && out.fields == in.fields);
+  CHECK(out.timeline == 77);
+  CHECK(out.game == in.game);
+  CHECK(out.state.team_active == 2 && out.state.red_ms == 123400 && out.state.yellow_ms == 4000000);
+
+  // any truncation is rejected, as is trailing garbage
+  for (size_t l = 0; l < len; l++) {
+    CHECK(!out.decode(buf, l));
+  }
+  CHECK(!out.decode(buf, len + 1));
+
+  // a delta with just one time field is small
+  in.fields = FleetMessage::F_RED;
+  CHECK(in.encode(buf) <= 9);
+
+  in.type = FleetMessage::TYPE::PONG;
+  in.target = 42;
+  in.t1 = 1;
+  in.t2 = 2;
+  in.t3 = 0xffffffff;
+  len = in.encode(buf);
+  CHECK(len <= FLEET_MAX_MESSAGE);
+  CHECK(out.decode(buf, len));
+  CHECK(out.type == FleetMessage::TYPE::PONG && out.target == 42 && out.t1 == 1 && out.t2 == 2 && out.t3 == in.t3);
+
+  // foreign traffic and invalid values
+  buf[0] = 0x51;
+  CHECK(!out.decode(buf, len));
+  in.type = FleetMessage::TYPE::STATE;
+  in.fields = FleetMessage::F_TEAM;
+  in.state.team_active = 3;
+  CHECK(!out.decode(buf, in.encode(buf)));
+}
+
+static void test_convergence(uint32_t latency_ms, float loss, uint32_t max_spread) {
+  Field field(5, latency_ms, loss);
+  field.run(15000);
+  CHECK(field.agree_on_leader(100)); // the lowest id
+  for (Prop &p : field.props) {
+    CHECK(p.sync.synced());
+    CHECK(p.sync.peer_count() == 4);
+  }
+  CHECK(field.clock_spread() <= max_spread);
+}
+
+static void test_game() {
+  Field field(4, 10, 0.2);
+  field.run(10000);
+  FleetGame game;
+  for (Prop &p : field.props) {
+    CHECK(!p.sync.take_game(game));
+  }
+
+  Prop &starter = field.props[2];
+  starter.sync.announce_game(starter.local(field.sim), 60000, 10);
+  uint32_t start_at = starter.sync.shared_time(starter.local(field.sim)) + 60000;
+  field.run(3000);
+  for (size_t i = 0; i < field.props.size(); i++) {
+    Prop &p = field.props[i];
+    CHECK(p.sync.current_game().origin == starter.sync.id());
+    CHECK(p.sync.current_game().start_at == start_at);
+    // reported once, and never to the prop that started it
+    CHECK(p.sync.take_game(game) == (i != 2));
+    CHECK(!p.sync.take_game(game));
+  }
+
+  // a restart replaces the game everywhere
+  Prop &restarter = field.props[3];
+  restarter.sync.announce_game(restarter.local(field.sim), 0, 5);
+  field.run(3000);
+  for (Prop &p : field.props) {
+    CHECK(p.sync.current_game().origin == restarter.sync.id());
+    CHECK(p.sync.current_game().game_min == 5);
+  }
+}
+
+static void test_field_score() {
+  Field field(3, 10, 0);
+  field.run(10000);
+  field.props[0].sync.announce_game(field.props[0].local(field.sim), 0, 10);
+  field.run(2000);
+  field.props[0].sync.set_state({0, 1000, 0});
+  field.props[1].sync.set_state({0, 2000, 500});
+  field.props[2].sync.set_state({0, 0, 1200});
+  field.run(2000);
+  for (Prop &p : field.props) {
+    FleetScore score = p.sync.field_score(p.local(field.sim));
+    CHECK(score.props == 3);
+    CHECK(score.red_ms == 3000);
+    CHECK(score.yellow_ms == 1700);
+  }
+
+  // a held point keeps scoring between the updates
+  for (uint32_t held = 0; held < 1500; held += 10) {
+    field.props[1].sync.set_state({1, 2000 + held, 500});
+    field.run(10);
+  }
+  for (Prop &p : field.props) {
+    FleetScore score = p.sync.field_score(p.local(field.sim));
+    CHECK(abs((int)score.red_ms - 4500) <= 150);
+  }
+}
+
+static void test_failover() {
+  Field field(4, 10, 0.05);
+  field.run(15000);
+  CHECK(field.agree_on_leader(100));
+  uint32_t before = field.props[1].sync.shared_time(field.props[1].local(field.sim));
+
+  // the leader is switched off, the next lowest id takes over and keeps the shared clock going
+  field.props[0].on = false;
+  field.props[0].ep->set_online(false);
+  field.run(10000);
+  CHECK(field.agree_on_leader(107));
+  CHECK(field.clock_spread() <= 10);
+  uint32_t after = field.props[1].sync.shared_time(field.props[1].local(field.sim));
+  CHECK(abs((int32_t)(after - before) - 10000) <= 10);
+
+  // after a reboot it syncs to the running clock before leading again
+  field.props[0].sync = FleetSync();
+  field.props[0].sync.begin(field.props[0].ep, 100);
+  field.props[0].on = true;
+  field.props[0].ep->set_online(true);
+  field.run(10000);
+  CHECK(field.agree_on_leader(100));
+  CHECK(field.clock_spread() <= 10);
+  after = field.props[1].sync.shared_time(field.props[1].local(field.sim));
+  CHECK(abs((int32_t)(after - before) - 20000) <= 10);
+}
+
+int main() {
+  test_messages();
+  test_convergence(5, 0, 10);
+  test_convergence(20, 0.3, 20);
+  test_game();
+  test_field_score();
+  test_failover();
+  return unit_result("fleet_sync");
+}
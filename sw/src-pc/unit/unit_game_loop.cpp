@@ -0,0 +1,302 @@
+// The game on a task of its own (src-common/game_loop.hpp): the latest value hand-off between two threads, the tick
+// jitter table (src-common/tick_jitter.hpp), and the games of all LCD snapshot tests (the directory is the argument)
+// played through the command, action and frame queues, which must show the same frames and run the same actions as
+// the game called directly. A game thread with the main thread feeding it keys last.
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src-common/game_loop.hpp"
+#include "../../src-common/tick_jitter.hpp"
+#include "snapshot_games.hpp"
+#include "unit.hpp"
+
+static std::atomic<uint32_t> now{1};
+uint32_t esphome::millis() { return now.load(std::memory_order_relaxed); }
+
+static void test_latest_value() {
+  LatestValue<int> value;
+  CHECK(!value.fresh() && value.read() == 0);
+  value.write(1);
+  value.write(2);
+  CHECK(value.fresh() && value.read() == 2);
+  CHECK(!value.fresh() && value.read() == 2);
+  value.back() = 3;
+  CHECK(!value.fresh());
+  value.publish();
+  CHECK(value.read() == 3);
+
+  // a producer and a consumer thread: every value read is whole and newer than the one before
+  struct Record {
+    uint32_t seq;
+    uint32_t copies[15];
+  };
+  LatestValue<Record> records;
+  const uint32_t count = 200000;
+  std::thread producer([&]() {
+    for (uint32_t i = 1; i <= count; i++) {
+      Record &r = records.back();
+      r.seq = i;
+      for (uint32_t &c : r.copies) {
+        c = i;
+      }
+      records.publish();
+    }
+  });
+  uint32_t last = 0;
+  bool whole = true, in_order = true;
+  while (last < count) {
+    const Record &r = records.read();
+    for (uint32_t c : r.copies) {
+      whole &= c == r.seq;
+    }
+    in_order &= r.seq >= last;
+    last = r.seq;
+  }
+  producer.join();
+  CHECK(whole && in_order);
+}
+
+static void test_tick_jitter() {
+  TickJitter jitter;
+  jitter.period_us = 50000;
+  jitter.tick(0, 300);
+  jitter.tick(1000, 500);
+  jitter.tick(3000, 400);
+  jitter.skipped = 2;
+  jitter.wakes = 7;
+  CHECK(jitter.late.count == 3 && jitter.late.max == 3000 && jitter.run.max == 500);
+
+  char text[TickJitter::MAX_TEXT];
+  size_t len = jitter.format(text, sizeof(text));
+  CHECK(len == strlen(text));
+  std::string table = text;
+  CHECK(table.rfind("# game task ticks since boot, every 50000 us", 0) == 0);
+  CHECK(table.find("\nlate                          3   1333.3") != std::string::npos);
+  CHECK(table.find("\nrun                           3    400.0") != std::string::npos);
+  CHECK(table.find("\nskipped 2, woken for keys 7\n") != std::string::npos);
+
+  // cut, still terminated
+  char small[40];
+  CHECK(jitter.format(small, sizeof(small)) == sizeof(small) - 1 && small[sizeof(small) - 1] == '\0');
+}
+
+static std::string frame_of(const esphome::lcd_base::LCDDisplay &display) { return display.row(0) + display.row(1); }
+
+// What a game showed and did after each key, edge and tick
+struct Trace {
+  std::vector<std::string> frames;
+  std::vector<uint32_t> actions; // of the last s_handle_actions run of the step, 0 for none
+};
+
+// The game called directly, as the key automations and the interval of config.yaml did
+static Trace play_direct(const std::string &sequence) {
+  now = 1;
+  AntGlobals antg;
+  GameManager game(antg);
+  Trace trace;
+  auto step = [&]() {
+    esphome::lcd_base::LCDDisplay display;
+    game.display_update(display);
+    trace.frames.push_back(frame_of(display));
+    trace.actions.push_back(script_actions.actions);
+    script_actions = {};
+  };
+  play_sequence(
+      sequence,
+      [&](unsigned char key) {
+        game.handle_key(key);
+        step();
+      },
+      [&](unsigned char key, bool down) {
+        game.handle_key_edge(key, down);
+        step();
+      },
+      [&](uint32_t ms) {
+        now += ms;
+        game.clock(now, now - game.clock_last_update_ms);
+        step();
+      });
+  return trace;
+}
+
+// The game behind the queues: a pass of the game task for each command and each tick, then the main loop
+static Trace play_queued(const std::string &sequence) {
+  now = 1;
+  AntGlobals antg;
+  GameManager game(antg);
+  GameLoop loop(game);
+  Trace trace;
+  esphome::lcd_base::LCDDisplay lcd;
+  auto step = [&](bool deadline) {
+    // the game task
+    if (deadline) {
+      loop.tick(now);
+    } else {
+      loop.apply_commands();
+    }
+    esphome::lcd_base::LCDDisplay frame;
+    game.display_update(frame);
+    std::string cells = frame_of(frame);
+    loop.publish(cells.data());
+    // the main loop
+    loop.run_actions();
+    CHECK(loop.frame_ready());
+    esphome::lcd_base::LCDDisplay shown;
+    loop.show(shown);
+    CHECK(!loop.frame_ready());
+    trace.frames.push_back(frame_of(shown));
+    trace.actions.push_back(script_actions.actions);
+    script_actions = {};
+  };
+  play_sequence(
+      sequence,
+      [&](unsigned char key) {
+        loop.key(key, esphome::micros());
+        step(false);
+      },
+      [&](unsigned char key, bool down) {
+        loop.key_edge(key, down, now);
+        step(false);
+      },
+      [&](uint32_t ms) {
+        now += ms;
+        step(true);
+      });
+  CHECK(loop.commands.dropped == 0 && loop.actions.dropped == 0);
+  return trace;
+}
+
+static void test_snapshot_games(const char *dir) {
+  size_t steps = 0;
+  size_t games = for_each_snapshot_game(dir, [&](const std::string &name, const std::string &sequence) {
+    Trace direct = play_direct(sequence);
+    Trace queued = play_queued(sequence);
+    bool same = direct.frames == queued.frames && direct.actions == queued.actions;
+    if (!same) {
+      for (size_t i = 0; i < direct.frames.size() && i < queued.frames.size(); i++) {
+        if (direct.frames[i] != queued.frames[i] || direct.actions[i] != queued.actions[i]) {
+          printf("%s: step %zu shows |%s| actions %u, queued |%s| actions %u\n", name.c_str(), i,
+                 direct.frames[i].c_str(), direct.actions[i], queued.frames[i].c_str(), queued.actions[i]);
+          break;
+        }
+      }
+    }
+    CHECK(same);
+    steps += direct.frames.size();
+  });
+  CHECK(games >= 80 && steps > 900);
+}
+
+// The frames carry the ticket of the last key the game applied before rendering them
+static void test_key_tickets() {
+  AntGlobals antg;
+  GameManager game(antg);
+  GameLoop loop(game);
+  esphome::lcd_base::LCDDisplay lcd;
+  std::string cells(LCD_CELLS, ' ');
+  loop.key(KEY_A, 0, 5);
+  loop.publish(cells.data()); // rendered before the key was applied
+  loop.show(lcd);
+  CHECK(loop.shown_ticket() == 0);
+  loop.apply_commands();
+  loop.key(KEY_B, 0); // no ticket
+  loop.apply_commands();
+  loop.publish(cells.data());
+  loop.show(lcd);
+  CHECK(loop.shown_ticket() == 5);
+  loop.key(KEY_A, 0, 6);
+  loop.tick(now);
+  loop.publish(cells.data());
+  loop.show(lcd);
+  CHECK(loop.shown_ticket() == 6);
+}
+
+// A press and release of the buttons count from when their automation reported them, not from when the game task got
+// to them
+static void test_button_edges() {
+  now = 1000;
+  AntGlobals antg;
+  GameManager game(antg);
+  GameLoop loop(game);
+  antg.gestures.hold(KEY_RED, 5000);
+  loop.key(KEY_A, esphome::micros()); // out of the splash
+  loop.apply_commands();
+  loop.key(KEY_RED, esphome::micros());
+  now = 1250;
+  loop.apply_commands();
+  CHECK(antg.gestures.progress(KEY_RED, 5000, now) == 0.05f);
+  now = 1400;
+  loop.key(KEY_RED_RELEASE, esphome::micros());
+  now = 1900;
+  loop.apply_commands();
+  Gesture g;
+  CHECK(antg.gestures.poll(now, g) && g.type == Gesture::TYPE::TAP && g.at == 1400 && g.ms == 400);
+}
+
+static void test_ota_info() {
+  AntGlobals antg;
+  GameManager game(antg);
+  GameLoop loop(game);
+  ant_ota_t &info = ota_info_updates.back();
+  info.ssid = "ant-1234";
+  info.ip = "192.168.4.1";
+  ota_info_updates.publish();
+  CHECK(antg.ota_info.ssid.empty());
+  loop.tick(now);
+  CHECK(antg.ota_info.ssid == "ant-1234" && antg.ota_info.ip == "192.168.4.1");
+}
+
+// A game thread ticking on its own while the main thread queues keys, runs the actions and shows the frames. The clock
+// stands still, so the display only depends on the keys and their order.
+static void test_threads() {
+  const std::string keys = "C,B,B,B,C,0,B,3,B";
+  Trace direct = play_direct(keys);
+
+  now = 1;
+  AntGlobals antg;
+  GameManager game(antg);
+  GameLoop loop(game);
+  std::atomic<bool> done{false};
+  std::thread task([&]() {
+    while (!done.load()) {
+      loop.tick(now);
+      esphome::lcd_base::LCDDisplay frame;
+      game.display_update(frame);
+      loop.publish(frame_of(frame).data());
+      std::this_thread::yield();
+    }
+  });
+  play_sequence(
+      keys, [&](unsigned char key) { loop.key(key, esphome::micros()); }, [](unsigned char, bool) {},
+      [](uint32_t) {});
+  std::string expected = direct.frames.back();
+  std::string shown;
+  for (int i = 0; i < 100000 && shown != expected; i++) {
+    loop.run_actions();
+    esphome::lcd_base::LCDDisplay lcd;
+    loop.show(lcd);
+    shown = frame_of(lcd);
+    std::this_thread::yield();
+  }
+  done = true;
+  task.join();
+  CHECK(shown == expected);
+  CHECK(loop.commands.empty() && loop.actions.empty());
+}
+
+int main(int argc, char **argv) {
+  mock_log_enabled = false;
+  test_latest_value();
+  test_tick_jitter();
+  test_key_tickets();
+  test_button_edges();
+  test_ota_info();
+  test_threads();
+  if (argc > 1)
+    test_snapshot_games(argv[1]);
+  return unit_result("game_loop");
+}
@@ -0,0 +1,225 @@
+// The snapshot of the game for other tasks (src-common/game_snapshot.hpp): the sequence lock it is published through,
+// alone and with readers hammering it, the fields as the game modes fill them, and readers on threads of their own
+// while a game thread plays the games of all LCD snapshot tests (the directory is the argument). Built with
+// ThreadSanitizer where the compiler has it, which fails the test on any data race between the game thread and the
+// readers.
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src-common/game_loop.hpp"
+#include "snapshot_games.hpp"
+#include "unit.hpp"
+
+static std::atomic<uint32_t> now{1};
+uint32_t esphome::millis() { return now.load(std::memory_order_relaxed); }
+
+static void test_seqlock() {
+  SeqLock<GameSnapshot> lock;
+  CHECK(lock.writes() == 0);
+  GameSnapshot s = lock.read();
+  CHECK(s.mode == GameSnapshot::MODE::NONE && s.state == GameSnapshot::STATE::SPLASH && s.game_ms == 0);
+
+  s.mode = GameSnapshot::MODE::COUNTDOWN;
+  s.game_ms = 12345;
+  memcpy(s.lcd, "0123456789abcdefghijklmnopqrstuv", LCD_CELLS);
+  lock.write(s);
+  CHECK(lock.writes() == 1);
+  GameSnapshot copy;
+  CHECK(lock.try_read(copy));
+  CHECK(copy.mode == GameSnapshot::MODE::COUNTDOWN && copy.game_ms == 12345);
+  CHECK(memcmp(copy.lcd, s.lcd, LCD_CELLS) == 0);
+
+  // an odd size, the last word is padded
+  struct Odd {
+    char bytes[7];
+  };
+  SeqLock<Odd> odd;
+  odd.write(Odd{{1, 2, 3, 4, 5, 6, 7}});
+  CHECK(odd.read().bytes[6] == 7);
+}
+
+// A writer thread and readers hammering a lock: every copy is whole and no older than the one before
+static void test_stress() {
+  struct Record {
+    uint32_t seq;
+    uint32_t copies[23];
+  };
+  const int READERS = 3;
+  const uint32_t count = 100000;
+  SeqLock<Record> lock;
+  std::atomic<int> torn{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < READERS; r++) {
+    readers.emplace_back([&]() {
+      uint32_t last = 0;
+      while (last < count) {
+        Record record = lock.read();
+        for (uint32_t c : record.copies) {
+          if (c != record.seq) {
+            torn++;
+            break;
+          }
+        }
+        if (record.seq < last) {
+          torn++;
+        }
+        last = record.seq;
+      }
+    });
+  }
+  Record record;
+  for (uint32_t i = 1; i <= count; i++) {
+    record.seq = i;
+    for (uint32_t &c : record.copies) {
+      c = i;
+    }
+    lock.write(record);
+  }
+  for (std::thread &t : readers) {
+    t.join();
+  }
+  CHECK(torn == 0);
+  CHECK(lock.writes() == count);
+}
+
+// A game set up by the web API (game_setup.hpp) and ticked by the game loop
+static GameSnapshot setup_and_tick(GameSetup::MODE mode, int delay_min, int game_min) {
+  now = 1;
+  AntGlobals antg;
+  GameManager game(antg);
+  GameLoop loop(game);
+  GameSetup setup;
+  setup.mode = mode;
+  setup.delay_min = delay_min;
+  setup.game_min = game_min;
+  setup.start = true;
+  game_setup_mailbox.post(setup);
+  loop.tick(now);
+  now += 1000;
+  loop.tick(now);
+  esphome::lcd_base::LCDDisplay frame;
+  game.display_update(frame);
+  std::string cells = frame.row(0) + frame.row(1);
+  loop.publish(cells.data());
+  GameSnapshot s = game_snapshot.read();
+  CHECK(memcmp(s.lcd, cells.data(), LCD_CELLS) == 0);
+  CHECK(s.clock_ms == 1001);
+  return s;
+}
+
+static void test_fields() {
+  now = 1;
+  AntGlobals antg;
+  GameManager game(antg);
+  GameLoop loop(game);
+  loop.publish(std::string(LCD_CELLS, ' ').data());
+  CHECK(game_snapshot.read().state == GameSnapshot::STATE::SPLASH);
+  loop.key(KEY_A, 0);
+  loop.apply_commands();
+  loop.publish(std::string(LCD_CELLS, ' ').data());
+  GameSnapshot s = game_snapshot.read();
+  CHECK(s.mode == GameSnapshot::MODE::NONE && s.state == GameSnapshot::STATE::MENU);
+
+  s = setup_and_tick(GameSetup::MODE::COUNTDOWN, 0, 1);
+  CHECK(s.mode == GameSnapshot::MODE::COUNTDOWN && s.state == GameSnapshot::STATE::RUNNING);
+  CHECK(s.game_ms == 60000 - 1001 && s.delay_ms == 0);
+
+  s = setup_and_tick(GameSetup::MODE::DOMINATION, 1, 2);
+  CHECK(s.mode == GameSnapshot::MODE::DOMINATION && s.state == GameSnapshot::STATE::PRE_START);
+  CHECK(s.delay_ms == 60000 - 1001 && s.game_ms == 120000 && s.team_active == 0);
+
+  s = setup_and_tick(GameSetup::MODE::ZONE_CONTROL, 0, 0);
+  CHECK(s.mode == GameSnapshot::MODE::ZONE_CONTROL && s.state == GameSnapshot::STATE::RUNNING);
+  CHECK(s.red_ms == 0 && s.yellow_ms == 0 && !s.armed);
+}
+
+// Readers on threads of their own while the game thread plays the games: every copy they get is whole, all of its
+// fields from the same tick.
+static void test_readers(const char *dir) {
+  const int READERS = 3;
+  std::vector<std::string> games;
+  for_each_snapshot_game(dir, [&](const std::string &name, const std::string &sequence) { games.push_back(sequence); });
+  CHECK(games.size() >= 80);
+
+  game_snapshot.write(GameSnapshot()); // not the last one of test_fields()
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> reads{0};
+  std::atomic<int> torn{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < READERS; r++) {
+    readers.emplace_back([&]() {
+      while (!done.load()) {
+        GameSnapshot s = game_snapshot.read();
+        // the game thread copies the clock into the last cell of the display, a torn copy wouldn't match
+        if ((uint8_t)s.lcd[LCD_CELLS - 1] != (uint8_t)s.clock_ms) {
+          torn++;
+        }
+        // the splash and the menu are the only states without a game mode
+        bool idle = s.state == GameSnapshot::STATE::SPLASH || s.state == GameSnapshot::STATE::MENU;
+        if (idle != (s.mode == GameSnapshot::MODE::NONE)) {
+          torn++;
+        }
+        reads++;
+      }
+    });
+  }
+
+  uint32_t published = game_snapshot.writes();
+  std::string last;
+  for (const std::string &sequence : games) {
+    now = 1;
+    AntGlobals antg;
+    GameManager game(antg);
+    GameLoop loop(game);
+    auto step = [&](bool deadline) {
+      if (deadline) {
+        loop.tick(now);
+      } else {
+        loop.apply_commands();
+      }
+      esphome::lcd_base::LCDDisplay frame;
+      game.display_update(frame);
+      last = frame.row(0) + frame.row(1);
+      last[LCD_CELLS - 1] = (char)(uint8_t)game.clock_last_update_ms;
+      loop.publish(last.data());
+      loop.run_actions();
+      published++;
+    };
+    play_sequence(
+        sequence,
+        [&](unsigned char key) {
+          loop.key(key, esphome::micros());
+          step(false);
+        },
+        [&](unsigned char key, bool down) {
+          loop.key_edge(key, down, now);
+          step(false);
+        },
+        [&](uint32_t ms) {
+          now += ms;
+          step(true);
+        });
+  }
+  done = true;
+  for (std::thread &t : readers) {
+    t.join();
+  }
+  CHECK(torn == 0);
+  CHECK(reads > 0);
+  CHECK(game_snapshot.writes() == published);
+  CHECK(memcmp(game_snapshot.read().lcd, last.data(), LCD_CELLS) == 0);
+}
+
+int main(int argc, char **argv) {
+  mock_log_enabled = false;
+  test_seqlock();
+  test_stress();
+  test_fields();
+  if (argc > 1)
+    test_readers(argv[1]);
+  return unit_result("game_snapshot");
+}
@@ -0,0 +1,179 @@
+// Gesture recognizer (src-common/gestures.hpp): taps, holds, releases and chords from millisecond-exact edges.
+
+#include <vector>
+
+#include "../../src-common/gestures.hpp"
+#include "unit.hpp"
+
+using TYPE = Gesture::TYPE;
+
+static std::vector<Gesture> poll_all(GestureRecognizer &r, uint32_t now) {
+  std::vector<Gesture> out;
+  Gesture g;
+  while (r.poll(now, g)) {
+    out.push_back(g);
+  }
+  return out;
+}
+
+static bool is(const Gesture &g, TYPE type, unsigned char key, uint32_t at, uint32_t ms) {
+  return g.type == type && g.key == key && g.at == at && g.ms == ms;
+}
+
+static void test_tap_and_hold() {
+  GestureRecognizer r;
+  CHECK(r.hold('R', 5000));
+  CHECK(r.hold('R', 10000));
+  CHECK(r.hold('R', 5000)); // already subscribed
+
+  // a short press is a tap
+  r.press('R', 100);
+  CHECK(r.down('R') && !r.down('Y'));
+  r.release('R', 350);
+  std::vector<Gesture> g = poll_all(r, 350);
+  CHECK(g.size() == 2 && is(g[0], TYPE::TAP, 'R', 350, 250) && is(g[1], TYPE::RELEASE, 'R', 350, 250));
+
+  // the hold is due at the press plus the threshold, to the ms
+  r.press('R', 1000);
+  uint32_t at = 0;
+  CHECK(r.next_deadline(at) && at == 6000);
+  CHECK(poll_all(r, 5999).empty());
+  g = poll_all(r, 6000);
+  CHECK(g.size() == 1 && is(g[0], TYPE::HOLD, 'R', 6000, 5000));
+  CHECK(r.next_deadline(at) && at == 11000);
+
+  // both holds reached without a poll in between come out in time order, with their own times
+  g = poll_all(r, 30000);
+  CHECK(g.size() == 1 && is(g[0], TYPE::HOLD, 'R', 11000, 10000));
+  CHECK(!r.next_deadline(at));
+  r.release('R', 31000);
+  g = poll_all(r, 31000);
+  CHECK(g.size() == 1 && is(g[0], TYPE::RELEASE, 'R', 31000, 30000));
+
+  // unsubscribed keys are not tracked
+  r.press('X', 100);
+  CHECK(!r.down('X') && poll_all(r, 100000).empty());
+}
+
+static void test_hold_before_release() {
+  GestureRecognizer r;
+  r.hold('R', 5000);
+
+  // the release comes in after the deadline, before any poll: the hold is still reported, before the release
+  r.press('R', 0);
+  r.release('R', 5000);
+  std::vector<Gesture> g = poll_all(r, 5000);
+  CHECK(g.size() == 2 && is(g[0], TYPE::HOLD, 'R', 5000, 5000) && is(g[1], TYPE::RELEASE, 'R', 5000, 5000));
+
+  // one ms short is a tap
+  r.press('R', 10000);
+  r.release('R', 14999);
+  g = poll_all(r, 20000);
+  CHECK(g.size() == 2 && g[0].type == TYPE::TAP && g[1].type == TYPE::RELEASE && g[1].ms == 4999);
+}
+
+static void test_progress() {
+  GestureRecognizer r;
+  r.hold('Y', 5000);
+  CHECK(r.progress('Y', 5000, 0) == 0.0f);
+  r.press('Y', 1000);
+  CHECK(r.progress('Y', 5000, 3500) == 0.5f);
+  r.release('Y', 2000);
+  // after the release it stays where the hold got to
+  CHECK(r.progress('Y', 5000, 9000) == 0.2f);
+  CHECK(r.progress('Q', 5000, 9000) == 0.0f);
+}
+
+static void test_chord() {
+  GestureRecognizer r;
+  CHECK(r.chord('R', 'D', 3000));
+
+  // counted from the later press
+  r.press('R', 100);
+  r.press('D', 1100);
+  uint32_t at = 0;
+  CHECK(r.next_deadline(at) && at == 4100);
+  CHECK(poll_all(r, 4099).empty());
+  std::vector<Gesture> g = poll_all(r, 4100);
+  CHECK(g.size() == 1 && is(g[0], TYPE::CHORD, 'R', 4100, 3000));
+  CHECK(poll_all(r, 9000).empty());
+
+  // the keys of the chord are not tapped
+  r.release('D', 9000);
+  g = poll_all(r, 9000);
+  CHECK(g.size() == 1 && is(g[0], TYPE::RELEASE, 'D', 9000, 7900));
+
+  // one key let go before the threshold, no chord
+  r.press('D', 10000);
+  r.release('R', 12000);
+  g = poll_all(r, 20000);
+  CHECK(g.size() == 1 && is(g[0], TYPE::RELEASE, 'R', 12000, 11900));
+  r.release('D', 20000);
+  g = poll_all(r, 20000);
+  CHECK(g.size() == 2 && is(g[0], TYPE::TAP, 'D', 20000, 10000));
+
+  // a key that is pressed again without its release starts over
+  r.press('R', 30000);
+  r.press('D', 30000);
+  r.press('R', 32000);
+  CHECK(r.next_deadline(at) && at == 35000);
+}
+
+static void test_wrap() {
+  GestureRecognizer r;
+  r.hold('C', 10000);
+  r.hold('D', 2000);
+  r.press('C', 0xffffff00u);
+  r.press('D', 0xfffffff0u);
+  uint32_t at = 0;
+  CHECK(r.next_deadline(at) && at == 0xfffffff0u + 2000);
+  // past the wrap both come out, the earlier first
+  std::vector<Gesture> g = poll_all(r, 20000);
+  CHECK(g.size() == 2 && is(g[0], TYPE::HOLD, 'D', 0xfffffff0u + 2000, 2000) &&
+        is(g[1], TYPE::HOLD, 'C', 0xffffff00u + 10000, 10000));
+  r.release('C', 30000);
+  g = poll_all(r, 30000);
+  CHECK(g.size() == 1 && is(g[0], TYPE::RELEASE, 'C', 30000, 30000 + 0x100));
+}
+
+static void test_queue() {
+  GestureRecognizer r;
+  r.hold('A', 100000);
+  // taps without polls: the queue keeps QUEUE gestures, the rest are counted
+  for (uint32_t i = 0; i < GestureRecognizer::QUEUE; i++) {
+    r.press('A', i * 10);
+    r.release('A', i * 10 + 5);
+  }
+  CHECK(r.dropped == GestureRecognizer::QUEUE);
+  std::vector<Gesture> g = poll_all(r, 1000);
+  CHECK(g.size() == GestureRecognizer::QUEUE && is(g[0], TYPE::TAP, 'A', 5, 5) && is(g[7], TYPE::RELEASE, 'A', 35, 5));
+
+  // reset forgets the keys and the queue, the subscriptions stay
+  r.press('A', 0);
+  r.reset();
+  CHECK(!r.down('A') && poll_all(r, 200000).empty() && r.dropped == 0);
+  r.press('A', 0);
+  g = poll_all(r, 200000);
+  CHECK(g.size() == 1 && is(g[0], TYPE::HOLD, 'A', 100000, 100000));
+
+  // the tables are bounded
+  GestureRecognizer full;
+  for (unsigned char key = 0; key < GestureRecognizer::KEYS; key++) {
+    CHECK(full.hold('a' + key, 1));
+  }
+  CHECK(!full.hold('z', 1));
+  for (uint32_t t = 2; t <= GestureRecognizer::THRESHOLDS; t++) {
+    CHECK(full.hold('a', t));
+  }
+  CHECK(!full.hold('a', 100));
+}
+
+int main() {
+  test_tap_and_hold();
+  test_hold_before_release();
+  test_progress();
+  test_chord();
+  test_wrap();
+  test_queue();
+  return unit_result("gestures");
+}
@@ -0,0 +1,251 @@
+// Glyph cache of the LCD (src-esphome/mycomponents/lcd_burst/glyph_cache.h) and the big digits of the timers
+// (src-common/big_digits.hpp): the slots it gives up, the frames as the LCD (src-pc/lcd_bus_sim.hpp) shows them, and
+// the CGRAM uploads of games on the virtual clock, redrawn every 50ms as config.yaml does. The directory of the LCD
+// snapshot tests is the argument, their key sequences are replayed as well.
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "../../src-common/big_digits.hpp"
+#include "../../src-common/gm_manager.hpp"
+#include "../lcd_bus_sim.hpp"
+#include "snapshot_games.hpp"
+#include "unit.hpp"
+
+#include "../../src-esphome/mycomponents/lcd_burst/glyph_cache.h"
+
+using namespace esphome::lcd_burst;
+
+static uint32_t now = 1;
+uint32_t esphome::millis() { return now; }
+
+static void test_policy() {
+  GlyphCache cache;
+  uint8_t out[16];
+
+  // the bars take the empty slots, the full block is the ROM's, other characters stay
+  const uint8_t bars[] = {'A', GLYPH_BAR_5, GLYPH_BAR_1, GLYPH_BAR_2, GLYPH_BAR_3, GLYPH_BAR_4, GLYPH_BAR_1, ' '};
+  cache.map(bars, sizeof(bars), out);
+  CHECK(cache.upload_count() == 4 && cache.uploaded() == 4);
+  CHECK(out[0] == 'A' && out[1] == 0xff && out[2] == 0 && out[5] == 3 && out[6] == 0 && out[7] == ' ');
+  CHECK(cache.uploads()[0].slot == 0 && cache.uploads()[0].glyph == GLYPH_BAR_1);
+
+  // again: nothing to upload
+  cache.map(bars, sizeof(bars), out);
+  CHECK(cache.upload_count() == 0 && cache.uploaded() == 4);
+
+  // the big digits into the rest
+  const uint8_t big[] = {GLYPH_BIG_TOP, GLYPH_BIG_BOTTOM, GLYPH_BIG_BOTH, GLYPH_BIG_DOT, GLYPH_BLOCK};
+  cache.map(big, sizeof(big), out);
+  CHECK(cache.upload_count() == 4 && out[0] == 4 && out[3] == 7 && out[4] == 0xff);
+
+  // a full cache gives up the least recently used slot off the screen: a bar, not the big digits just shown
+  const uint8_t arrow[] = {GLYPH_ARROW, GLYPH_BAR_4};
+  cache.map(arrow, sizeof(arrow), out);
+  CHECK(cache.upload_count() == 1 && out[0] == 0 && cache.glyph(0) == GLYPH_ARROW && out[1] == 3);
+  // all off the screen but for the arrow: the least recently used, a big digit stroke
+  cache.map(bars, sizeof(bars), out);
+  CHECK(cache.upload_count() == 1 && cache.glyph(4) == GLYPH_BAR_1 && out[2] == 4);
+
+  // more glyphs than slots: the ones in place keep their slots, the one that doesn't fit shows its ROM character
+  const uint8_t all[] = {GLYPH_BAR_1,   GLYPH_BAR_2,      GLYPH_BAR_3,    GLYPH_BAR_4,  GLYPH_ARROW,
+                         GLYPH_BIG_TOP, GLYPH_BIG_BOTTOM, GLYPH_BIG_BOTH, GLYPH_BIG_DOT};
+  cache.reset_stats();
+  cache.map(all, sizeof(all), out);
+  CHECK(cache.fallbacks() == 1 && out[5] == '-');
+  for (int i = 0; i < 9; i++) {
+    CHECK(i == 5 || (out[i] < GlyphCache::SLOTS && cache.glyph(out[i]) == all[i]));
+  }
+
+  // a frame the LCD didn't get: its glyphs again with the next one
+  cache.clear();
+  cache.map(big, sizeof(big), out);
+  cache.drop_last();
+  cache.map(big, sizeof(big), out);
+  CHECK(cache.upload_count() == 4);
+  cache.map(big, sizeof(big), out);
+  CHECK(cache.upload_count() == 0);
+}
+
+static std::string stand_ins(const char *row) {
+  std::string s = row;
+  for (char &c : s) {
+    c = glyph_stand_in(c);
+  }
+  return s;
+}
+
+static void test_big_digits() {
+  char top[BIG_TIME_COLS + 1], bottom[BIG_TIME_COLS + 1];
+  CHECK(format_big_time(5 * 60000 + 999, top, bottom));
+  CHECK(stand_ins(top) == "X\"X X==.X\"X X\"X" && stand_ins(bottom) == "X_X __X.X_X X_X");
+  CHECK(format_big_time(12 * 60000 + 34000, top, bottom));
+  CHECK(stand_ins(top) == "  X ==X.==X X_X" && stand_ins(bottom) == "  X X__.__X   X");
+  CHECK(format_big_time(-1, top, bottom) && stand_ins(top) == "X\"X X\"X.X\"X X\"X");
+  CHECK(format_big_time(99 * 60000 + 59999, top, bottom) && stand_ins(bottom) == "__X __X.__X __X");
+  CHECK(!format_big_time(100 * 60000, top, bottom));
+
+  // the strokes of all the digits are 4 glyphs
+  uint8_t used[256] = {};
+  for (int d = 0; d < 10; d++) {
+    big_digit(d, top, bottom);
+    for (int i = 0; i < 3; i++) {
+      used[(uint8_t)top[i]] = used[(uint8_t)bottom[i]] = 1;
+    }
+  }
+  CHECK(used[GLYPH_BIG_TOP] && used[GLYPH_BIG_BOTTOM] && used[GLYPH_BIG_BOTH] && used[GLYPH_BLOCK] && used[' ']);
+  CHECK(std::count(used, used + 256, 1) == 5);
+
+  // alternating screens: 5s each, by the time left
+  CHECK(!big_time_turn(4999) && big_time_turn(5000) && big_time_turn(9999) && !big_time_turn(10000));
+}
+
+// Whether the LCD shows the cells as printed: the ROM character, or a slot with the pixel rows of the glyph
+static bool shows(const LcdBusModel &lcd, const uint8_t *cells) {
+  for (int r = 0; r < 2; r++) {
+    std::string row = lcd.row(r, 16);
+    for (int col = 0; col < 16; col++) {
+      uint8_t printed = cells[r * 16 + col];
+      uint8_t code = row[col];
+      const Glyph *g = find_glyph(printed);
+      bool ok = g == nullptr  ? code == printed
+                : g->in_rom ? code == g->rom
+                            : code < GlyphCache::SLOTS && memcmp(lcd.cgram + code * 8, g->rows, 8) == 0;
+      if (!ok) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// The game on the virtual clock, every frame through the cache into the LCD model
+class Prop {
+public:
+  static constexpr uint32_t FRAME_MS = 50;
+
+  void key(unsigned char key) {
+    game_manager.handle_key(key);
+    render();
+  }
+
+  void edge(unsigned char key, bool down) {
+    game_manager.handle_key_edge(key, down);
+    render();
+  }
+
+  // The interval of config.yaml for ms
+  void advance(uint32_t ms) {
+    while (ms > 0) {
+      uint32_t step = std::min(ms, FRAME_MS);
+      now += step;
+      ms -= step;
+      game_manager.clock(now, step);
+      render();
+    }
+  }
+
+  bool play(const std::string &sequence) {
+    return play_sequence(
+        sequence, [&](unsigned char k) { key(k); }, [&](unsigned char k, bool down) { edge(k, down); },
+        [&](uint32_t ms) { advance(ms); });
+  }
+
+  uint32_t max_per_second() const {
+    uint32_t max = 0;
+    for (const auto &second : per_second) {
+      max = std::max(max, second.second);
+    }
+    return max;
+  }
+
+  GlyphCache cache;
+  LcdBusModel lcd{300000};
+  // uploads in each second of the clock that had any
+  std::map<uint32_t, uint32_t> per_second;
+  uint32_t frames = 0;
+  uint32_t wrong = 0; // frames the LCD didn't show as printed
+  uint32_t big = 0;   // frames with big digits
+  uint32_t last_upload = 0;
+
+private:
+  void render() {
+    esphome::lcd_base::LCDDisplay display;
+    game_manager.display_update(display);
+    uint8_t cells[32];
+    memcpy(cells, display.row(0).data(), 16);
+    memcpy(cells + 16, display.row(1).data(), 16);
+    uint8_t buf[MAX_GLYPH_FRAME_BYTES];
+    size_t len = cache.encode(cells, 16, 2, PCF8574_BACKLIGHT, buf, sizeof(buf));
+    lcd.write(buf, len);
+    frames++;
+    if (cache.upload_count() > 0) {
+      per_second[now / 1000] += cache.upload_count();
+      last_upload = now;
+    }
+    wrong += !shows(lcd, cells);
+    big += std::count(cells, cells + 32, GLYPH_BIG_DOT) == 2;
+  }
+
+  AntGlobals antg;
+  GameManager game_manager{antg};
+};
+
+static void test_countdown() {
+  now = 1;
+  Prop prop;
+  // 3 minutes
+  CHECK(prop.play("C,B,B,B,C,0,B,3,B,C"));
+  uint32_t start = now;
+  prop.advance(3 * 60000);
+  // the strokes of the digits once, then 3600 frames with nothing to upload
+  CHECK(prop.big >= 3599 && prop.wrong == 0);
+  CHECK(prop.cache.uploaded() == 4 && prop.max_per_second() == 4 && prop.last_upload == start);
+  CHECK(prop.lcd.busy_nibbles == 0 && prop.lcd.rs_violations == 0);
+}
+
+static void test_domination() {
+  now = 1;
+  Prop prop;
+  // 2 minutes, the zone taken back and forth: the progress bars and the big digits, 8 glyphs in 8 slots
+  CHECK(prop.play("C,B,C,B,2,B,C"));
+  for (int i = 0; i < 6; i++) {
+    prop.play(i % 2 ? "YELLOW,DELAY=5000,YELLOW_RELEASE,DELAY=10000" : "RED,DELAY=5000,RED_RELEASE,DELAY=10000");
+  }
+  prop.advance(30000);
+  CHECK(prop.big > 0 && prop.wrong == 0 && prop.cache.fallbacks() == 0);
+  CHECK(prop.cache.uploaded() == 8 && prop.max_per_second() <= 4);
+  CHECK(prop.lcd.busy_nibbles == 0);
+}
+
+static void test_snapshot_games(const char *dir) {
+  uint32_t frames = 0;
+  size_t games = for_each_snapshot_game(dir, [&](const std::string &name, const std::string &sequence) {
+    now = 1;
+    Prop prop;
+    bool ok = prop.play(sequence);
+    CHECK(ok);
+    // no glyph uploaded twice
+    if (prop.wrong || prop.cache.fallbacks() || prop.cache.uploaded() > 8 || prop.lcd.busy_nibbles) {
+      printf("%s: %u frames, %u wrong, %u uploads, %u fallbacks\n", name.c_str(), prop.frames, prop.wrong,
+             prop.cache.uploaded(), prop.cache.fallbacks());
+    }
+    CHECK(prop.wrong == 0 && prop.cache.fallbacks() == 0 && prop.cache.uploaded() <= 8);
+    CHECK(prop.lcd.busy_nibbles == 0);
+    frames += prop.frames;
+  });
+  CHECK(games >= 80 && frames > 100000);
+}
+
+int main(int argc, char **argv) {
+  mock_log_enabled = false;
+  test_policy();
+  test_big_digits();
+  test_countdown();
+  test_domination();
+  if (argc > 1)
+    test_snapshot_games(argv[1]);
+  return unit_result("glyph_cache");
+}
@@ -0,0 +1,134 @@
+// Input latency trace (src-common/input_latency.hpp), and the game on the virtual clock: the key sequences of all LCD
+// snapshot tests (the directory is the argument) played in the main loop of config.yaml, where a key has to reach the
+// buzzer and the LCD in the same loop pass it came in.
+
+#include <cstring>
+#include <string>
+
+#include "../../src-common/gm_manager.hpp"
+#include "../../src-common/input_latency.hpp"
+#include "snapshot_games.hpp"
+#include "unit.hpp"
+
+static uint32_t now = 1;
+uint32_t esphome::millis() { return now; }
+
+using SPAN = InputLatency::SPAN;
+
+static void test_trace() {
+  InputLatency latency;
+  latency.edge(1000);
+  latency.key(1300);
+  latency.buzzer(1400);
+  latency.buzzer(1500); // once per key
+  latency.lcd(17300);
+  CHECK(latency.span(SPAN::EDGE_TO_KEY).count == 1 && latency.span(SPAN::EDGE_TO_KEY).max == 300);
+  CHECK(latency.span(SPAN::KEY_TO_BUZZER).count == 1 && latency.span(SPAN::KEY_TO_BUZZER).max == 100);
+  CHECK(latency.span(SPAN::KEY_TO_LCD).count == 1 && latency.last_us[(int)SPAN::KEY_TO_LCD] == 16000);
+
+  // a key from the clock: no edge; no buzzer, no sample; a redraw without a key, no sample
+  latency.key(20000);
+  latency.lcd(21000);
+  latency.lcd(22000);
+  latency.buzzer(23000);
+  CHECK(latency.span(SPAN::EDGE_TO_KEY).count == 1);
+  CHECK(latency.span(SPAN::KEY_TO_BUZZER).count == 1);
+  CHECK(latency.span(SPAN::KEY_TO_LCD).count == 2 && latency.last_us[(int)SPAN::KEY_TO_LCD] == 1000);
+
+  // two keys before a redraw: the first one is traced
+  latency.key(30000);
+  latency.key(31000);
+  latency.lcd(35000);
+  CHECK(latency.span(SPAN::KEY_TO_LCD).count == 3 && latency.last_us[(int)SPAN::KEY_TO_LCD] == 5000);
+
+  char text[InputLatency::MAX_TEXT];
+  size_t len = latency.format(text, sizeof(text));
+  CHECK(len == strlen(text));
+  std::string table = text;
+  CHECK(table.find("\nkey_to_lcd                    3") != std::string::npos);
+  CHECK(table.find("\nedge_to_key                   1    300.0") != std::string::npos);
+
+  latency.reset();
+  CHECK(latency.span(SPAN::KEY_TO_LCD).count == 0 && latency.last_us[(int)SPAN::KEY_TO_LCD] == 0);
+}
+
+// The main loop of config.yaml on the virtual clock: the key automations, and the interval with its display update
+class Loop {
+public:
+  void key(unsigned char key) {
+    input_latency.edge(esphome::micros());
+    game_manager.handle_key(key);
+    render();
+    keys++;
+  }
+
+  // An edge of a key with long presses, which doesn't buzz
+  void edge(unsigned char key, bool down) {
+    game_manager.handle_key_edge(key, down);
+    render();
+  }
+
+  // One pass of the interval after ms, as the snapshot tests run a DELAY
+  void advance(uint32_t ms) {
+    now += ms;
+    game_manager.clock(now, ms);
+    render();
+  }
+
+  size_t keys = 0;
+
+private:
+  void render() {
+    game_manager.display_update(display);
+    input_latency.lcd(esphome::micros());
+  }
+
+  AntGlobals antg;
+  GameManager game_manager{antg};
+  esphome::lcd_base::LCDDisplay display;
+};
+
+static bool play(const std::string &sequence, size_t &keys) {
+  Loop loop;
+  bool ok = play_sequence(
+      sequence, [&](unsigned char key) { loop.key(key); },
+      [&](unsigned char key, bool down) { loop.edge(key, down); }, [&](uint32_t ms) { loop.advance(ms); });
+  loop.advance(50);
+  keys = loop.keys;
+  return ok;
+}
+
+static void test_snapshot_games(const char *dir) {
+  size_t buzzes = 0;
+  size_t games = for_each_snapshot_game(dir, [&](const std::string &name, const std::string &sequence) {
+    input_latency.reset();
+    now = 1;
+    size_t keys = 0;
+    bool ok = play(sequence, keys);
+    CHECK(ok);
+    // every key reaches the LCD (keys of the clock add to the count), without waiting for the next tick
+    const InputLatency &l = input_latency;
+    bool same_pass = l.span(SPAN::EDGE_TO_KEY).max == 0 && l.span(SPAN::KEY_TO_BUZZER).max == 0 &&
+                     l.span(SPAN::KEY_TO_LCD).max == 0;
+    bool all_keys = l.span(SPAN::EDGE_TO_KEY).count == keys && l.span(SPAN::KEY_TO_LCD).count >= keys;
+    if (!ok || !same_pass || !all_keys) {
+      printf("%s: %zu keys, edge_to_key %u max %u, key_to_buzzer max %u, key_to_lcd %u max %u\n", name.c_str(), keys,
+             l.span(SPAN::EDGE_TO_KEY).count, l.span(SPAN::EDGE_TO_KEY).max, l.span(SPAN::KEY_TO_BUZZER).max,
+             l.span(SPAN::KEY_TO_LCD).count, l.span(SPAN::KEY_TO_LCD).max);
+    }
+    CHECK(same_pass);
+    CHECK(all_keys);
+    buzzes += l.span(SPAN::KEY_TO_BUZZER).count;
+  });
+  CHECK(games >= 80);
+  // a buzzer that waits for the clock comes after the LCD, and isn't sampled
+  CHECK(buzzes > 0);
+}
+
+int main(int argc, char **argv) {
+  mock_log_enabled = false;
+  test_trace();
+  if (argc > 1)
+    test_snapshot_games(argv[1]);
+  return unit_result("input_latency");
+}
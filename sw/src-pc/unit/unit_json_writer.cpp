@@ -0,0 +1,111 @@
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "../../src-esphome/mycomponents/web_server/json_writer.h"
+#include "unit.hpp"
+
+using esphome::web_server::JsonWriter;
+
+static void test_object() {
+  char buf[256];
+  JsonWriter json(buf, sizeof(buf));
+  json.begin_object();
+  json.add("id", "binary_sensor-", std::string("red_button"));
+  json.add("value", true);
+  json.add("state", "ON");
+  json.add("count", -12);
+  json.add("level", 0.5f);
+  json.add("off", false);
+  json.end_object();
+  CHECK(json.ok());
+  CHECK(json.str() == R"({"id":"binary_sensor-red_button","value":true,"state":"ON","count":-12,"level":0.5,"off":false})");
+  CHECK(strlen(json.c_str()) == json.size());
+
+  // an empty object
+  JsonWriter empty(buf, sizeof(buf));
+  empty.begin_object();
+  empty.end_object();
+  CHECK(empty.str() == "{}");
+}
+
+static void test_numbers() {
+  char buf[256];
+  JsonWriter json(buf, sizeof(buf));
+  json.begin_object();
+  json.add("a", 21.3f);
+  json.add("nan", NAN);
+  json.add("inf", INFINITY);
+  json.add_decimal("t", 21.25f, 1, "°C");
+  json.add_decimal("n", -3.0f, 0);
+  json.end_object();
+  CHECK(json.ok());
+  // floats in the shortest form that reads back the same
+  CHECK(json.str() == R"({"a":21.3,"nan":null,"inf":null,"t":"21.2 °C","n":"-3"})");
+}
+
+static void test_escapes() {
+  char buf[256];
+  JsonWriter json(buf, sizeof(buf));
+  json.begin_object();
+  json.add("s", std::string("a\"b\\c\n\t\x01/\xc3\xa9"));
+  json.end_object();
+  CHECK(json.ok());
+  CHECK(json.str() == R"({"s":"a\"b\\c\n\t\u0001/)"
+                      "\xc3\xa9\"}");
+
+  // an escape in the id part
+  JsonWriter id(buf, sizeof(buf));
+  id.begin_object();
+  id.add("id", "text-\"", std::string("\r"));
+  id.end_object();
+  CHECK(id.str() == R"({"id":"text-\"\r"})");
+}
+
+static void test_bounded() {
+  // exactly fits, including the NUL
+  const std::string expected = R"({"state":"ON"})";
+  char buf[64];
+  memset(buf, 'x', sizeof(buf));
+  JsonWriter fits(buf, expected.size() + 1);
+  fits.begin_object();
+  fits.add("state", "ON");
+  fits.end_object();
+  CHECK(fits.ok() && fits.str() == expected);
+
+  // one byte less: not ok, nothing is written past the buffer
+  memset(buf, 'x', sizeof(buf));
+  JsonWriter small(buf, expected.size());
+  small.begin_object();
+  small.add("state", "ON");
+  small.end_object();
+  CHECK(!small.ok());
+  CHECK(small.size() < expected.size() && buf[small.size()] == '\0' && buf[expected.size()] == 'x');
+
+  // an escape that doesn't fit
+  JsonWriter escape(buf, 8);
+  escape.begin_object();
+  escape.add("s", "\x01");
+  escape.end_object();
+  CHECK(!escape.ok() && escape.size() < 8);
+
+  // nothing more is written after an overflow, even if it would fit
+  JsonWriter after(buf, 12);
+  after.begin_object();
+  after.add("s", std::string(20, 'a'));
+  size_t len = after.size();
+  after.add("b", true);
+  CHECK(!after.ok() && after.size() == len);
+
+  JsonWriter none(buf, 0);
+  none.begin_object();
+  CHECK(!none.ok());
+}
+
+int main() {
+  test_object();
+  test_numbers();
+  test_escapes();
+  test_bounded();
+  return unit_result("json_writer");
+}
@@ -0,0 +1,159 @@
+// Keypad scanner (src-esphome/mycomponents/pcf8574_keypad/keypad_scanner.h) against the model of the matrix on its
+// PCF8574 (src-pc/keypad_sim.hpp): the transactions of a scan, the edges with their times, debouncing, the scan rate,
+// two keys and the ghosts of three.
+
+#include <vector>
+
+#include "../keypad_sim.hpp"
+#include "unit.hpp"
+
+using namespace esphome::pcf8574_keypad;
+
+// Index of a key of the model's matrix
+static uint8_t key(char k) { return strchr(KeypadMatrixModel::KEYS, k) - KeypadMatrixModel::KEYS; }
+
+struct Scan {
+  std::vector<KeyEdge> edges;
+  uint32_t transactions;
+};
+
+static Scan poll(KeypadScanner &scanner, KeypadMatrixModel &bus, uint32_t now) {
+  KeyEdge edges[KeypadScanner::KEYS];
+  uint32_t before = bus.transactions;
+  size_t n = scanner.poll(now, edges);
+  return Scan{std::vector<KeyEdge>(edges, edges + n), bus.transactions - before};
+}
+
+static bool is(const KeyEdge &e, char k, bool down, uint32_t at) {
+  return e.key == key(k) && e.down == down && e.at == at;
+}
+
+static void test_idle_and_press() {
+  KeypadMatrixModel bus(300000);
+  KeypadScanner scanner(&bus);
+
+  // the first scan drives the rows low, then a bare read is the scan
+  Scan s = poll(scanner, bus, 0);
+  CHECK(s.edges.empty() && s.transactions == 2 && bus.out == KeypadScanner::ROWS_LOW);
+  CHECK(poll(scanner, bus, 15999).transactions == 0);
+  s = poll(scanner, bus, 16000);
+  CHECK(s.edges.empty() && s.transactions == 1 && !scanner.fast());
+
+  // a key: the bare read and one write and read
+  bus.set('5', true);
+  s = poll(scanner, bus, 32000);
+  CHECK(s.edges.size() == 1 && is(s.edges[0], '5', true, 32000) && s.transactions == 2);
+  CHECK(scanner.fast() && scanner.keys() == 1 << key('5'));
+
+  // held: fast scans, bare reads, and every DECODE_EVERY scans a decode
+  uint32_t transactions = 0;
+  for (uint32_t t = 33000; t < 33000 + 1000 * KeypadScanner::DECODE_EVERY; t += 1000) {
+    s = poll(scanner, bus, t);
+    CHECK(s.edges.empty());
+    transactions += s.transactions;
+  }
+  CHECK(transactions == KeypadScanner::DECODE_EVERY + 1);
+
+  // the release, bouncing: taken at the first scan that sees it, the bounce is held off
+  bus.set('5', false);
+  s = poll(scanner, bus, 41000);
+  CHECK(s.edges.size() == 1 && is(s.edges[0], '5', false, 41000));
+  bus.set('5', true);
+  CHECK(poll(scanner, bus, 42000).edges.empty());
+  bus.set('5', false);
+  for (uint32_t t = 43000; t < 50000; t += 1000) {
+    CHECK(poll(scanner, bus, t).edges.empty());
+  }
+  CHECK(scanner.keys() == 0);
+
+  // fast for the active time after the last scan with a key down (the bounce), then idle again
+  CHECK(scanner.fast());
+  poll(scanner, bus, 42000 + 499000);
+  CHECK(scanner.fast());
+  poll(scanner, bus, 42000 + 500000);
+  CHECK(!scanner.fast());
+  CHECK(poll(scanner, bus, 42000 + 501000).transactions == 0);
+}
+
+static void test_two_keys() {
+  KeypadMatrixModel bus(300000);
+  KeypadScanner scanner(&bus);
+  poll(scanner, bus, 0);
+
+  // on one row: D and *, both at once
+  bus.set('D', true);
+  bus.set('*', true);
+  Scan s = poll(scanner, bus, 16000);
+  CHECK(s.edges.size() == 2 && is(s.edges[0], 'D', true, 16000) && is(s.edges[1], '*', true, 16000));
+  bus.set('D', false);
+  bus.set('*', false);
+  CHECK(poll(scanner, bus, 30000).edges.size() == 2 && scanner.keys() == 0);
+
+  // on different rows and columns: D and 5, a read of each row
+  bus.set('D', true);
+  bus.set('5', true);
+  s = poll(scanner, bus, 40000);
+  CHECK(s.edges.size() == 2 && scanner.keys() == (1 << key('D') | 1 << key('5')));
+  CHECK(s.transactions == 1 + 1 + 2 + 1);
+
+  // a third that makes a ghost: D, 5 and 0 show 5's column on D's row too, dropped
+  bus.set('0', true);
+  for (uint32_t t = 50000; t < 60000; t += 1000) {
+    CHECK(poll(scanner, bus, t).edges.empty());
+  }
+  CHECK(scanner.keys() == (1 << key('D') | 1 << key('5')));
+  bus.set('0', false);
+  bus.set('5', false);
+  s = poll(scanner, bus, 60000);
+  CHECK(s.edges.size() == 1 && is(s.edges[0], '5', false, 60000));
+}
+
+static void test_same_line() {
+  // a second key on the column of the one held doesn't change the bare read, the decode finds it
+  KeypadMatrixModel bus(300000);
+  KeypadScanner scanner(&bus);
+  poll(scanner, bus, 0);
+  bus.set('D', true);
+  poll(scanner, bus, 16000);
+  bus.set('C', true);
+  uint32_t t = 17000;
+  for (; t < 17000 + 1000 * KeypadScanner::DECODE_EVERY; t += 1000) {
+    Scan s = poll(scanner, bus, t);
+    if (!s.edges.empty()) {
+      CHECK(s.edges.size() == 1 && is(s.edges[0], 'C', true, t));
+      break;
+    }
+  }
+  CHECK(scanner.keys() == (1 << key('D') | 1 << key('C')));
+}
+
+static void test_bus_errors() {
+  KeypadMatrixModel bus(300000);
+  KeypadScanner scanner(&bus);
+  bus.fail = true;
+  poll(scanner, bus, 0);
+  bus.set('1', true);
+  CHECK(poll(scanner, bus, 16000).edges.empty() && scanner.errors() == 2);
+  bus.fail = false;
+  Scan s = poll(scanner, bus, 32000);
+  CHECK(s.edges.size() == 1 && is(s.edges[0], '1', true, 32000));
+}
+
+static void test_stock_scan() {
+  KeypadMatrixModel bus(300000);
+  bus.out = KeypadScanner::ROWS_LOW | 0x0F;
+  CHECK(stock_matrix_keypad_scan(bus) == -1 && bus.transactions == 32);
+  bus.set('7', true);
+  CHECK(stock_matrix_keypad_scan(bus) == key('7'));
+  bus.set('1', true);
+  CHECK(stock_matrix_keypad_scan(bus) == -2);
+}
+
+int main() {
+  test_idle_and_press();
+  test_two_keys();
+  test_same_line();
+  test_bus_errors();
+  test_stock_scan();
+  return unit_result("keypad_scanner");
+}
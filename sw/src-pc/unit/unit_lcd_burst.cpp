@@ -0,0 +1,137 @@
+// Burst LCD driver (src-esphome/mycomponents/lcd_burst/hd44780_burst.h): the bytes of a frame played through the model
+// of the bus, the PCF8574 and the HD44780 (src-pc/lcd_bus_sim.hpp).
+
+#include <cstring>
+#include <string>
+
+#include "../lcd_bus_sim.hpp"
+#include "unit.hpp"
+
+using namespace esphome::lcd_burst;
+
+static const char *ROW0 = "TIME LEFT: 01:23";
+static const char *ROW1 = "\x05\x05\x05\x05\x03      T1:4 \xff";
+
+static void frame_16x2(uint8_t *chars) {
+  memcpy(chars, ROW0, 16);
+  memcpy(chars + 16, ROW1, 16);
+}
+
+static void test_frame() {
+  uint8_t chars[32];
+  frame_16x2(chars);
+  uint8_t buf[MAX_FRAME_BYTES];
+  size_t len = encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, buf, sizeof(buf));
+  // per row: RS, the address, RS, 4 bytes a character
+  CHECK(len == 2 * (1 + 4 + 1 + 16 * 4));
+  for (size_t i = 0; i < len; i++) {
+    CHECK(buf[i] & PCF8574_BACKLIGHT);
+  }
+
+  LcdBusModel bus(300000);
+  bus.write(buf, len);
+  CHECK(bus.row(0, 16) == ROW0);
+  CHECK(bus.row(1, 16) == std::string(ROW1, 16));
+  CHECK(bus.transactions == 1 && bus.bytes == len + 1);
+  CHECK(bus.instructions == 34);
+  CHECK(bus.busy_nibbles == 0 && bus.rs_violations == 0);
+
+  // the next frame in its own write
+  chars[0] = 'X';
+  len = encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, buf, sizeof(buf));
+  bus.write(buf, len);
+  CHECK(bus.row(0, 16) == "XIME LEFT: 01:23");
+  CHECK(bus.busy_nibbles == 0 && bus.rs_violations == 0);
+
+  // too small a buffer
+  CHECK(encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, buf, len - 1) == 0);
+}
+
+static void test_stock_driver() {
+  // the same frame through the writes of lcd_pcf8574
+  uint8_t chars[32];
+  frame_16x2(chars);
+  LcdBusModel bus(300000);
+  stock_pcf8574_frame(bus, chars, 16, 2);
+  CHECK(bus.row(0, 16) == ROW0);
+  CHECK(bus.row(1, 16) == std::string(ROW1, 16));
+  CHECK(bus.transactions == 34 * 2 * 3 && bus.bytes == 34 * 2 * 3 * 2);
+  CHECK(bus.busy_nibbles == 0 && bus.rs_violations == 0);
+
+  LcdBusModel burst(300000);
+  uint8_t buf[MAX_FRAME_BYTES];
+  burst.write(buf, encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, buf, sizeof(buf)));
+  CHECK(burst.now * 4 < bus.now);
+}
+
+static void test_20x4() {
+  uint8_t chars[80];
+  for (int i = 0; i < 80; i++) {
+    chars[i] = 'A' + i / 20;
+  }
+  uint8_t buf[MAX_FRAME_BYTES];
+  size_t len = encode_frame(chars, 20, 4, PCF8574_BACKLIGHT, buf, sizeof(buf));
+  CHECK(len == MAX_FRAME_BYTES);
+  LcdBusModel bus(300000);
+  bus.write(buf, len);
+  for (int r = 0; r < 4; r++) {
+    CHECK(bus.row(r, 20) == std::string(20, 'A' + r));
+  }
+}
+
+static void test_bus_speed() {
+  // the two bytes of a nibble pace the LCD up to 480 kHz
+  uint8_t chars[32];
+  frame_16x2(chars);
+  uint8_t buf[MAX_FRAME_BYTES];
+  size_t len = encode_frame(chars, 16, 2, PCF8574_BACKLIGHT, buf, sizeof(buf));
+  LcdBusModel fast(400000);
+  fast.write(buf, len);
+  CHECK(fast.busy_nibbles == 0);
+  LcdBusModel too_fast(500000);
+  too_fast.write(buf, len);
+  CHECK(too_fast.busy_nibbles > 0);
+}
+
+static void test_commands() {
+  // a user defined character, a write per command and character like LCDDisplay::setup() sends them
+  LcdBusModel bus(300000);
+  auto send = [&](uint8_t value, bool rs) {
+    uint8_t buf[5];
+    BurstEncoder enc(buf, sizeof(buf), 0);
+    if (rs) {
+      enc.data(value);
+    } else {
+      enc.command(value);
+    }
+    CHECK(!enc.overflow() && enc.size() == 5);
+    bus.write(buf, enc.size());
+  };
+  send(0x40 | (1 << 3), false);
+  for (uint8_t i = 0; i < 8; i++) {
+    send(0x10 | i, true);
+  }
+  for (uint8_t i = 0; i < 8; i++) {
+    CHECK(bus.cgram[8 + i] == (0x10 | i));
+  }
+  // back to the DDRAM
+  send(HD44780_SET_DDRAM_ADDR | 0x40, false);
+  send('k', true);
+  CHECK(bus.row(1, 16)[0] == 'k');
+  CHECK(bus.busy_nibbles == 0 && bus.rs_violations == 0);
+
+  // a nibble of the initialization
+  uint8_t buf[3];
+  BurstEncoder enc(buf, sizeof(buf), PCF8574_BACKLIGHT);
+  enc.nibble(0x30, false);
+  CHECK(enc.size() == 3 && buf[0] == 0x38 && buf[1] == 0x3c && buf[2] == 0x38);
+}
+
+int main() {
+  test_frame();
+  test_stock_driver();
+  test_20x4();
+  test_bus_speed();
+  test_commands();
+  return unit_result("lcd_burst");
+}
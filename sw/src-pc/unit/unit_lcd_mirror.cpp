@@ -0,0 +1,103 @@
+#include <random>
+
+#include "../../src-common/lcd_mirror.hpp"
+#include "unit.hpp"
+
+static LcdFrame frame_of(const char *row0, const char *row1) {
+  LcdFrame f;
+  memcpy(f.cells, row0, LCD_COLS);
+  memcpy(f.cells + LCD_COLS, row1, LCD_COLS);
+  return f;
+}
+
+static void test_text() {
+  char text[LcdMirror::MAX_TEXT];
+  uint8_t diff[LcdFrame::MAX_DIFF];
+
+  // glyphs and the backslash are escaped, other unprintable characters can't be sent
+  LcdFrame a = frame_of("\x01\x05\\ab          \x7f", "               \x00");
+  size_t len = LcdMirror::encode(diff, a.diff(nullptr, diff), text);
+  CHECK(len == strlen(text));
+  CHECK(strncmp(text, "0P\\1\\5\\\\ab", 10) == 0);
+  LcdFrame b;
+  CHECK(LcdMirror::apply(b, text));
+  CHECK(b.cells[0] == 1 && b.cells[1] == 5 && b.cells[2] == '\\' && b.cells[15] == '?' && b.cells[31] == 0);
+
+  // the strokes of the big digits
+  LcdFrame big = frame_of("\x05\x10\x05 \x12\x13          ", "\x05\x11\x05             ");
+  len = LcdMirror::encode(diff, big.diff(nullptr, diff), text);
+  CHECK(strncmp(text, "0P\\5\\@\\5 \\B\\C ", 14) == 0);
+  LcdFrame big_viewer;
+  CHECK(LcdMirror::apply(big_viewer, text) && big_viewer == big);
+
+  // one changed cell
+  b = a;
+  b.cells[17] = 'x';
+  CHECK(LcdMirror::encode(diff, b.diff(&a, diff), text) == 3 && strcmp(text, "A1x") == 0);
+
+  // the worst case fits
+  LcdFrame glyphs;
+  memset(glyphs.cells, 2, LCD_CELLS);
+  CHECK(LcdMirror::encode(diff, glyphs.diff(nullptr, diff), text) == LcdMirror::MAX_TEXT - 1);
+
+  // random frames round trip
+  std::mt19937 rng(5);
+  LcdFrame prev, next, viewer;
+  for (int i = 0; i < 2000; i++) {
+    for (int j = rng() % 8; j >= 0; j--) {
+      next.cells[rng() % LCD_CELLS] = "a\\ \x00\x03"[rng() % 5];
+    }
+    LcdMirror::encode(diff, next.diff(i ? &prev : nullptr, diff), text);
+    CHECK(LcdMirror::apply(viewer, text) && viewer == next);
+    prev = next;
+  }
+
+  // malformed events
+  CHECK(!LcdMirror::apply(b, "0"));
+  CHECK(!LcdMirror::apply(b, "00"));
+  CHECK(!LcdMirror::apply(b, "O3abc"));
+  CHECK(!LcdMirror::apply(b, "03ab"));
+  CHECK(!LcdMirror::apply(b, "01\\9"));
+  CHECK(!LcdMirror::apply(b, "01\\H"));
+  CHECK(!LcdMirror::apply(b, "01\\"));
+}
+
+static void test_mirror() {
+  char text[LcdMirror::MAX_TEXT];
+  LcdMirror mirror(100);
+  LcdFrame frame = frame_of("  Defusal       ", "  Domination    ");
+  LcdFrame viewer;
+
+  // the full display first, right away
+  CHECK(mirror.update(frame, 1000, text) == 2 + LCD_CELLS);
+  mirror.acknowledge();
+  CHECK(LcdMirror::apply(viewer, text) && viewer == frame);
+  CHECK(mirror.update(frame, 2000, text) == 0);
+
+  // not more often than the interval, the changes in between add up
+  frame.cells[0] = '>';
+  CHECK(mirror.update(frame, 2050, text) == 3);
+  mirror.acknowledge();
+  frame.cells[16] = '>';
+  CHECK(mirror.update(frame, 2100, text) == 0);
+  frame.cells[18] = '!';
+  CHECK(mirror.update(frame, 2150, text) == 2 + 3);
+  mirror.acknowledge();
+
+  // an event that couldn't be queued is not acknowledged: the next one carries its changes too
+  frame.cells[1] = '1';
+  CHECK(mirror.update(frame, 2300, text) == 3);
+  frame.cells[30] = '2';
+  CHECK(mirror.update(frame, 2350, text) == 3 + 3);
+  mirror.acknowledge();
+  CHECK(LcdMirror::apply(viewer, text) && viewer != frame); // the 2150 event was not applied to this viewer
+
+  mirror.reset();
+  CHECK(mirror.update(frame, 2360, text) == 2 + LCD_CELLS);
+}
+
+int main() {
+  test_text();
+  test_mirror();
+  return unit_result("lcd_mirror");
+}
@@ -0,0 +1,164 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../src-esphome/mycomponents/web_server/log_ring.h"
+#include "unit.hpp"
+
+using esphome::web_server::LogBatch;
+using esphome::web_server::LogCursor;
+using esphome::web_server::LogRing;
+
+static void push(LogRing &ring, uint8_t level, const std::string &text) { ring.push(level, text.data(), text.size()); }
+
+// A client that accepts up to `accept` lines per batch (the rest is refused like by a busy connection)
+struct Client {
+  LogCursor cursor;
+  LogBatch batch;
+  std::vector<std::string> lines;
+  std::vector<uint32_t> markers;
+
+  void poll(const LogRing &ring, size_t accept = SIZE_MAX, bool accept_marker = true) {
+    ring.read(cursor, batch);
+    bool marker_sent = batch.dropped() == 0 || accept_marker;
+    if (batch.dropped() != 0 && marker_sent) {
+      markers.push_back(batch.dropped());
+    }
+    size_t sent = 0;
+    while (marker_sent && sent < batch.size() && sent < accept) {
+      lines.push_back(batch.text(sent++));
+    }
+    batch.consume(cursor, marker_sent, sent);
+  }
+
+  void drain(const LogRing &ring) {
+    for (int i = 0; i < 100; i++) {
+      poll(ring);
+    }
+  }
+};
+
+static void test_order_and_levels() {
+  LogRing ring(1024, 16);
+  Client all, info;
+  all.cursor = ring.oldest(7);
+  info.cursor = ring.oldest(3);
+  push(ring, 1, "error");
+  push(ring, 5, "debug");
+  push(ring, 3, "info");
+  push(ring, 7, "very verbose");
+  all.drain(ring);
+  info.drain(ring);
+  CHECK((all.lines == std::vector<std::string>{"error", "debug", "info", "very verbose"}));
+  CHECK((info.lines == std::vector<std::string>{"error", "info"}));
+  CHECK(all.markers.empty() && info.markers.empty());
+  CHECK(info.cursor.seq == ring.next_seq()); // skipped lines are consumed too
+
+  // a client that only wants new lines
+  Client late;
+  late.cursor = ring.newest(7);
+  push(ring, 3, "new");
+  late.drain(ring);
+  CHECK((late.lines == std::vector<std::string>{"new"}));
+}
+
+static void test_slow_client() {
+  LogRing ring(1024, 16);
+  Client fast, slow;
+  fast.cursor = slow.cursor = ring.oldest(7);
+  for (int i = 0; i < 100; i++) {
+    push(ring, 3, "line " + std::to_string(i));
+    fast.poll(ring);
+    slow.poll(ring, i % 4 == 0 ? 1 : 0); // takes one line every 4 pushes
+  }
+  CHECK(fast.lines.size() == 100 && fast.markers.empty());
+  CHECK(fast.lines[99] == "line 99");
+
+  slow.drain(ring);
+  // every line is either delivered or counted as dropped, in order, and the ring kept its last 16
+  uint32_t dropped = 0;
+  for (uint32_t m : slow.markers) {
+    dropped += m;
+  }
+  CHECK(!slow.markers.empty());
+  CHECK(slow.lines.size() + dropped == 100);
+  CHECK(slow.lines.back() == "line 99");
+  CHECK(ring.size() == 16);
+
+  // the marker is repeated until the client takes it, and nothing is sent ahead of it
+  Client stuck;
+  stuck.cursor = LogCursor{0, 7, 0};
+  stuck.poll(ring, SIZE_MAX, false);
+  stuck.poll(ring, SIZE_MAX, false);
+  CHECK(stuck.lines.empty());
+  stuck.poll(ring);
+  CHECK((stuck.markers == std::vector<uint32_t>{100 - 16}));
+  CHECK(stuck.lines.size() == 16 && stuck.lines[0] == "line 84");
+}
+
+static void test_bytes_and_wrap() {
+  // long lines evict by bytes before the line slots run out, and never straddle the end of the ring
+  LogRing ring(256, 64);
+  Client client;
+  client.cursor = ring.oldest(7);
+  std::vector<std::string> pushed;
+  for (int i = 0; i < 1000; i++) {
+    std::string line(1 + (i * 37) % 60, 'a' + i % 26);
+    push(ring, 3, line);
+    pushed.push_back(line);
+    client.poll(ring);
+  }
+  CHECK(client.lines == pushed);
+
+  // lines are truncated to a quarter of the ring
+  push(ring, 3, std::string(200, 'x'));
+  client.poll(ring);
+  CHECK(client.lines.back() == std::string(63, 'x'));
+
+  // a batch is limited in lines and bytes
+  LogRing big(65536, 1024);
+  Client batched;
+  batched.cursor = big.oldest(7);
+  for (int i = 0; i < 100; i++) {
+    push(big, 3, std::string(100, 'b'));
+  }
+  big.read(batched.cursor, batched.batch);
+  CHECK(batched.batch.size() == LogBatch::MAX_BYTES / 101);
+  for (int i = 0; i < 100; i++) {
+    push(big, 3, "s");
+  }
+  batched.drain(big);
+  CHECK(batched.lines.size() == 200);
+}
+
+static void test_long_run() {
+  // the ring is reused many times over without losing lines for a client that keeps up
+  LogRing ring(1024, 16);
+  Client client;
+  client.cursor = ring.oldest(7);
+  for (uint32_t i = 0; i < 5000; i++) {
+    push(ring, 3, std::string(200, 'z'));
+    client.poll(ring);
+  }
+  CHECK(client.lines.size() == 5000 && client.markers.empty());
+}
+
+static void test_parse_level() {
+  uint8_t level = 0;
+  CHECK(LogRing::parse_level("debug", level) && level == 5);
+  CHECK(LogRing::parse_level("WARN", level) && level == 2);
+  CHECK(LogRing::parse_level("very_verbose", level) && level == 7);
+  CHECK(LogRing::parse_level("3", level) && level == 3);
+  CHECK(!LogRing::parse_level("8", level));
+  CHECK(!LogRing::parse_level("loud", level));
+  CHECK(!LogRing::parse_level("", level));
+}
+
+int main() {
+  test_order_and_levels();
+  test_slow_client();
+  test_bytes_and_wrap();
+  test_long_run();
+  test_parse_level();
+  return unit_result("log_ring");
+}
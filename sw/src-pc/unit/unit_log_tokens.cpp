@@ -0,0 +1,248 @@
+// Tokenized log (src-common/log_tokens.hpp and src-pc/log_decoder.hpp): the records, the ring, the dictionary, and
+// the game: with the dictionary the build made (the first argument), the records of all LCD snapshot test games (the
+// directory is the second argument) must decode to the text the PC build prints.
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../../src-common/gm_manager.hpp"
+#include "../log_decoder.hpp"
+#include "snapshot_games.hpp"
+#include "unit.hpp"
+
+static uint32_t now = 1;
+uint32_t esphome::millis() { return now; }
+
+// Drains the ring and decodes the records
+static std::string drain(LogTokens &log, const LogDecoder &decoder, bool times = false) {
+  uint8_t records[96];
+  std::string text;
+  size_t len;
+  while ((len = log.read(records, sizeof(records))) != 0) {
+    size_t errors = decoder.decode(records, len, text, times);
+    CHECK(errors == 0);
+  }
+  return text;
+}
+
+static void test_records() {
+  static const LogFormat FORMATS[] = {
+      {'I', "T", "plain"},
+      {'I', "T", "%d %i %u %08x %X %o %c|%5d|%-4d|%+d"},
+      {'W', "T", "%f %.2f %8.3f %g %e"},
+      {'I', "T", "%s%s [%5s] [%-5s] [%.2s]"},
+      {'I', "T", "%lld %llu %ld %zu %hhd %hu 100%%"},
+  };
+  LogDecoder decoder;
+  for (const LogFormat &f : FORMATS) {
+    CHECK(decoder.add(f));
+  }
+  LogTokens log;
+  std::string expected;
+  char line[256];
+  auto expect = [&](const char *format, auto... args) {
+    snprintf(line, sizeof(line), format, args...);
+    expected += std::string("[T] ") + line + "\n";
+  };
+
+  log.write(log_token('I', "T", "plain"), 1);
+  expect("%s", "plain");
+  log.write(log_token('I', "T", FORMATS[1].format.c_str()), 2, -7, INT32_MIN, 4000000000u, 0xdeadbeefu, 255, 8, 'k',
+            42, 3, 0);
+  expect("%d %i %u %08x %X %o %c|%5d|%-4d|%+d", -7, INT32_MIN, 4000000000u, 0xdeadbeefu, 255, 8, 'k', 42, 3, 0);
+  log.write(log_token('W', "T", FORMATS[2].format.c_str()), 3, 0.8f, -1.125f, 1e6f, 0.0001f, 3.5f);
+  expect("%f %.2f %8.3f %g %e", 0.8f, -1.125f, 1e6f, 0.0001f, 3.5f);
+  log.write(log_token('I', "T", FORMATS[3].format.c_str()), 4, "domination", " (start)", "ab", "cd", "efgh");
+  expect("%s%s [%5s] [%-5s] [%.2s]", "domination", " (start)", "ab", "cd", "efgh");
+  log.write(log_token('I', "T", FORMATS[4].format.c_str()), 5, -5000000000ll, 18000000000000000000ull, -3l,
+            (size_t)12, (signed char)-2, (unsigned short)65535);
+  expect("%lld %llu %ld %zu %hhd %hu 100%%", -5000000000ll, 18000000000000000000ull, -3l, (size_t)12,
+         (signed char)-2, (unsigned short)65535);
+  CHECK(drain(log, decoder) == expected);
+
+  // longer strings are cut
+  log.write(log_token('I', "T", FORMATS[3].format.c_str()), 6, "0123456789012345678901234567890123456789", "", "",
+            "", "");
+  CHECK(drain(log, decoder) == "[T] 012345678901234567890123 [     ] [     ] []\n");
+
+  // timestamps and levels
+  log.write(log_token('W', "T", FORMATS[2].format.c_str()), 61234, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f);
+  log.write(0x12345678, 7);
+  std::string text;
+  uint8_t records[96];
+  size_t len = log.read(records, sizeof(records));
+  CHECK(decoder.decode(records, len, text, true) == 1);
+  CHECK(text.rfind("    61.234 W [T] 1.000000 1.00", 0) == 0);
+  CHECK(text.find("\n     0.007 ? [ant_log] unknown token 12345678\n") != std::string::npos);
+
+  // a record without its arguments
+  log.write(log_token('I', "T", FORMATS[1].format.c_str()), 8, 1, 2);
+  text.clear();
+  len = log.read(records, sizeof(records));
+  CHECK(decoder.decode(records, len, text) == 1);
+  CHECK(text.find("[ant_log: bad arguments]") != std::string::npos);
+}
+
+static void test_ring() {
+  LogTokens log;
+  uint32_t token = log_token('I', "T", "%s");
+  const char *s = "0123456789012345678901234567890123456789";
+  // 1 + 4 + 1 + 1 + 24 bytes a record
+  size_t fits = LogTokens::RING / 31;
+  for (size_t i = 0; i < fits + 3; i++) {
+    log.write(token, 1, s);
+  }
+  CHECK(log.dropped == 3);
+
+  // whole records only, as many as fit
+  uint8_t out[100];
+  CHECK(log.read(out, sizeof(out)) == 93);
+  CHECK(out[0] == 30 && out[31] == 30 && out[62] == 30);
+  size_t read = 3;
+  while (log.read(out, 31) == 31) {
+    read++;
+  }
+  CHECK(read == fits);
+  CHECK(log.take_dropped() == 3 && log.dropped == 0);
+
+  // the ring wraps
+  for (int round = 0; round < 100; round++) {
+    log.write(token, round, "ab");
+    log.write(token, round, "cd");
+    CHECK(log.read(out, sizeof(out)) == 18);
+  }
+  CHECK(log.dropped == 0);
+
+  // too long for a record: 12 floats are 48 bytes, 16 don't fit
+  uint32_t floats = log_token('I', "T", "%f");
+  log.write(floats, 1, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f);
+  CHECK(log.dropped == 0);
+  log.write(floats, 1, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f, 16.f);
+  CHECK(log.dropped == 1);
+}
+
+static void test_base64() {
+  const uint8_t data[] = {0, 1, 2, 0xfb, 0xff, 0x80, 0x7f};
+  for (size_t len = 0; len <= sizeof(data); len++) {
+    char text[16];
+    size_t n = LogTokens::base64(data, len, text);
+    CHECK(n == strlen(text) && n == 4 * ((len + 2) / 3));
+    std::vector<uint8_t> back;
+    CHECK(LogDecoder::unbase64(text, back));
+    CHECK(back == std::vector<uint8_t>(data, data + len));
+  }
+  char text[8];
+  LogTokens::base64((const uint8_t *)"ant", 3, text);
+  CHECK(strcmp(text, "YW50") == 0);
+  std::vector<uint8_t> back;
+  CHECK(!LogDecoder::unbase64("YW5", back));
+  CHECK(!LogDecoder::unbase64("YW5!", back));
+}
+
+static void test_scan() {
+  const char *source = R"(
+#define ANT_LOGI(tag, format, ...) ANT_LOG_RECORD('I', tag, format, ##__VA_ARGS__)
+    ANT_LOGI("GameManager", "Siren for %dms at %dHz level %f with %dms delay", s->duration, s->tone, s->level,
+             s->delay);
+    ANT_LOGW ( "A\tB",
+      "tab\t, quote \", newline\n" "and more \x41\101" );
+    ANT_LOGI(TAG, "not a literal");
+    ANT_LOGE("Err", "no such level");
+)";
+  std::vector<LogFormat> formats;
+  log_scan(source, formats);
+  const LogFormat siren{'I', "GameManager", "Siren for %dms at %dHz level %f with %dms delay"};
+  const LogFormat escapes{'W', "A\tB", "tab\t, quote \", newline\nand more AA"};
+  CHECK(formats.size() == 2);
+  CHECK(formats.size() == 2 && formats[0] == siren && formats[1] == escapes);
+
+  // the dictionary file keeps them
+  LogDecoder decoder;
+  for (const LogFormat &f : formats) {
+    CHECK(decoder.add(f));
+  }
+  std::string path = (std::filesystem::temp_directory_path() / "unit_log_tokens.dict").string();
+  CHECK(decoder.save(path.c_str()));
+  LogDecoder loaded;
+  CHECK(loaded.load(path.c_str()));
+  CHECK(loaded.formats == decoder.formats);
+  // the token the compiler made
+  constexpr uint32_t token = log_token('I', "GameManager", "Siren for %dms at %dHz level %f with %dms delay");
+  CHECK(loaded.formats.count(token) == 1);
+}
+
+// The main loop of config.yaml: keys, and the interval that drains the records after the display update
+class Loop {
+public:
+  explicit Loop(const LogDecoder &decoder) : decoder(decoder) {}
+
+  void key(unsigned char key) {
+    game_manager.handle_key(key);
+    render();
+  }
+
+  void edge(unsigned char key, bool down) {
+    game_manager.handle_key_edge(key, down);
+    render();
+  }
+
+  void advance(uint32_t ms) {
+    now += ms;
+    game_manager.clock(now, ms);
+    render();
+  }
+
+  std::string decoded;
+
+private:
+  void render() {
+    game_manager.display_update(display);
+    decoded += drain(log_tokens, decoder);
+  }
+
+  const LogDecoder &decoder;
+  AntGlobals antg;
+  GameManager game_manager{antg};
+  esphome::lcd_base::LCDDisplay display;
+};
+
+static void test_snapshot_games(const char *dict, const char *dir) {
+  LogDecoder decoder;
+  CHECK(decoder.load(dict));
+  CHECK(decoder.formats.size() >= 30);
+  size_t lines = 0;
+  size_t games = for_each_snapshot_game(dir, [&](const std::string &name, const std::string &sequence) {
+    std::string printed;
+    mock_log_capture = &printed;
+    log_tokens.reset();
+    now = 1;
+    Loop loop(decoder);
+    bool ok = play_sequence(
+        sequence, [&](unsigned char key) { loop.key(key); },
+        [&](unsigned char key, bool down) { loop.edge(key, down); }, [&](uint32_t ms) { loop.advance(ms); });
+    loop.advance(50);
+    mock_log_capture = nullptr;
+    CHECK(ok);
+    CHECK(log_tokens.dropped == 0);
+    if (loop.decoded != printed) {
+      printf("%s: printed\n%sdecoded\n%s", name.c_str(), printed.c_str(), loop.decoded.c_str());
+    }
+    CHECK(loop.decoded == printed);
+    lines += std::count(printed.begin(), printed.end(), '\n');
+  });
+  CHECK(games >= 80);
+  CHECK(lines > 100);
+}
+
+int main(int argc, char **argv) {
+  test_records();
+  test_ring();
+  test_base64();
+  test_scan();
+  if (argc > 2)
+    test_snapshot_games(argv[1], argv[2]);
+  return unit_result("log_tokens");
+}
@@ -0,0 +1,163 @@
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../tools/delta_diff.hpp"
+#include "unit.hpp"
+
+using delta_diff::bytes;
+using esphome::web_server::OTADeltaDecoder;
+
+// Something that looks enough like a firmware image: an ESP32 image header with an app descriptor followed by "code"
+// with lots of 32 bit addresses pointing into the image.
+static bytes make_image(uint32_t seed, size_t size) {
+  std::mt19937 rng(seed);
+  bytes image(size);
+  for (size_t i = 0; i < size; i += 4) {
+    uint32_t word = rng() % 3 == 0 ? 0x42000000 + (rng() % size) : rng() % 256;
+    memcpy(&image[i], &word, std::min<size_t>(4, size - i));
+  }
+  image[0] = delta_diff::ESP_IMAGE_MAGIC;
+  uint32_t magic = delta_diff::ESP_APP_DESC_MAGIC;
+  memcpy(&image[delta_diff::ESP_APP_DESC_OFFSET], &magic, sizeof(magic));
+  return image;
+}
+
+// The next firmware version: some code inserted in the middle, everything behind it relocated, some of it rewritten.
+static bytes next_version(const bytes &old, uint32_t seed) {
+  std::mt19937 rng(seed);
+  bytes nu(old.begin(), old.begin() + old.size() / 3);
+  for (int i = 0; i < 3000; i++)
+    nu.push_back(rng());
+  nu.insert(nu.end(), old.begin() + old.size() / 3, old.end());
+  for (size_t i = old.size() / 3; i + 4 <= nu.size(); i += 4) {
+    uint32_t word;
+    memcpy(&word, &nu[i], sizeof(word));
+    if ((word & 0xFF000000) == 0x42000000) {
+      word += 3000;
+      memcpy(&nu[i], &word, sizeof(word));
+    }
+  }
+  for (size_t i = nu.size() / 2; i < nu.size() / 2 + 500; i++)
+    nu[i] = rng();
+  // new build id
+  for (size_t i = 0; i < OTADeltaDecoder::ID_SIZE; i++)
+    nu[OTADeltaDecoder::APP_ELF_SHA256_OFFSET + i] = rng();
+  return nu;
+}
+
+static void test_round_trip() {
+  bytes old = make_image(1, 200000);
+  bytes nu = next_version(old, 2);
+  bytes patch = delta_diff::diff(old, nu);
+  CHECK(patch.size() < nu.size() / 10);
+
+  for (size_t chunk : {size_t(1), size_t(7), size_t(536), size_t(1460), patch.size()}) {
+    bytes out;
+    CHECK(delta_diff::apply(old, patch, out, chunk) == OTADeltaDecoder::OK);
+    CHECK(out == nu);
+  }
+}
+
+static void test_edge_cases() {
+  bytes old = make_image(3, 50000);
+  bytes out;
+
+  // identical image
+  bytes patch = delta_diff::diff(old, old);
+  CHECK(patch.size() < 200);
+  CHECK(delta_diff::apply(old, patch, out, 3) == OTADeltaDecoder::OK && out == old);
+
+  // unrelated image, everything ends up in extra sections
+  bytes other = make_image(4, 30000);
+  patch = delta_diff::diff(old, other);
+  CHECK(delta_diff::apply(old, patch, out) == OTADeltaDecoder::OK && out == other);
+
+  // empty images
+  patch = delta_diff::diff(old, bytes());
+  CHECK(delta_diff::apply(old, patch, out) == OTADeltaDecoder::OK && out.empty());
+  patch = delta_diff::diff(bytes(), other);
+  CHECK(delta_diff::apply(bytes(), patch, out) == OTADeltaDecoder::OK && out == other);
+}
+
+static void test_errors() {
+  bytes old = make_image(5, 50000);
+  bytes nu = next_version(old, 6);
+  bytes patch = delta_diff::diff(old, nu);
+  bytes out;
+
+  bytes bad = patch;
+  bad[0] = 'X';
+  CHECK(delta_diff::apply(old, bad, out) == OTADeltaDecoder::ERROR_FORMAT);
+
+  bad = patch;
+  bad[4] = OTADeltaDecoder::VERSION + 1;
+  CHECK(delta_diff::apply(old, bad, out) == OTADeltaDecoder::ERROR_FORMAT);
+
+  // patch for a different running firmware
+  bytes other_base = old;
+  other_base[OTADeltaDecoder::APP_ELF_SHA256_OFFSET] ^= 1;
+  CHECK(delta_diff::apply(other_base, patch, out) == OTADeltaDecoder::ERROR_BASE);
+  // base larger than the running partition
+  bytes shorter(old.begin(), old.end() - 1);
+  CHECK(delta_diff::apply(shorter, patch, out) == OTADeltaDecoder::ERROR_BASE);
+
+  bad = patch;
+  bad[48] ^= 1;
+  CHECK(delta_diff::apply(old, bad, out) == OTADeltaDecoder::ERROR_HASH);
+  bad = patch;
+  bad[bad.size() / 2] ^= 1;
+  CHECK(delta_diff::apply(old, bad, out) != OTADeltaDecoder::OK);
+
+  bad.assign(patch.begin(), patch.end() - 10);
+  CHECK(delta_diff::apply(old, bad, out) == OTADeltaDecoder::ERROR_SIZE);
+  bad.assign(patch.begin(), patch.begin() + 40);
+  CHECK(delta_diff::apply(old, bad, out) == OTADeltaDecoder::ERROR_FORMAT);
+  bad = patch;
+  bad.push_back(0);
+  CHECK(delta_diff::apply(old, bad, out) == OTADeltaDecoder::ERROR_SIZE);
+
+  // random garbage after a valid header must fail cleanly, never read outside the old image
+  std::mt19937 rng(7);
+  for (int round = 0; round < 200; round++) {
+    bad.assign(patch.begin(), patch.begin() + OTADeltaDecoder::HEADER_SIZE);
+    for (int i = 0; i < 100; i++)
+      bad.push_back(rng());
+    CHECK(delta_diff::apply(old, bad, out) != OTADeltaDecoder::OK);
+  }
+}
+
+static void test_sink_error() {
+  bytes old = make_image(8, 20000);
+  bytes patch = delta_diff::diff(old, next_version(old, 9));
+  size_t written = 0;
+  OTADeltaDecoder decoder([&](uint32_t offset, uint8_t *buf, size_t len) { return false; }, old.size(), nullptr,
+                          [&](const uint8_t *data, size_t len) {
+                            written += len;
+                            return uint8_t(written > 1000 ? 42 : 0);
+                          });
+  // the read callback fails before anything is written
+  CHECK(decoder.feed(patch.data(), patch.size()) == OTADeltaDecoder::ERROR_OLD_READ);
+
+  OTADeltaDecoder decoder2(
+      [&](uint32_t offset, uint8_t *buf, size_t len) {
+        memcpy(buf, &old[offset], len);
+        return true;
+      },
+      old.size(), nullptr,
+      [&](const uint8_t *data, size_t len) {
+        written += len;
+        return uint8_t(written > 1000 ? 42 : 0);
+      });
+  CHECK(decoder2.feed(patch.data(), patch.size()) == OTADeltaDecoder::ERROR_SINK);
+  CHECK(decoder2.sink_error() == 42);
+  CHECK(decoder2.finish() != OTADeltaDecoder::OK);
+}
+
+int main() {
+  test_round_trip();
+  test_edge_cases();
+  test_errors();
+  test_sink_error();
+  return unit_result("ota_delta");
+}
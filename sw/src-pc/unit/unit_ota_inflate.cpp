@@ -0,0 +1,185 @@
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "../../src-esphome/mycomponents/web_server/ota/ota_inflate.h"
+#include "unit.hpp"
+
+using esphome::web_server::OTAGzipInflater;
+using bytes = std::vector<uint8_t>;
+
+// Compresses with zlib, which is only used as the reference encoder here.
+static bytes gzip(const bytes &data, int level, int strategy, bool header_fields = false) {
+  z_stream zs = {};
+  deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, strategy);
+  gz_header header = {};
+  char name[] = "firmware.ota.bin";
+  uint8_t extra[] = {'A', 'N', 4, 0, 1, 2, 3, 4};
+  if (header_fields) {
+    header.name = (Bytef *)name;
+    header.extra = extra;
+    header.extra_len = sizeof(extra);
+    header.comment = (Bytef *)"test";
+    header.hcrc = 1;
+    deflateSetHeader(&zs, &header);
+  }
+  bytes out(deflateBound(&zs, data.size()) + 64);
+  zs.next_in = (Bytef *)data.data();
+  zs.avail_in = data.size();
+  zs.next_out = out.data();
+  zs.avail_out = out.size();
+  deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  return out;
+}
+
+// Feeds the stream in chunks chosen by next_len and collects the output
+static OTAGzipInflater::Error inflate(const bytes &gz, bytes &out, const std::function<size_t()> &next_len) {
+  out.clear();
+  OTAGzipInflater inflater([&](const uint8_t *data, size_t len) {
+    out.insert(out.end(), data, data + len);
+    return uint8_t(0);
+  });
+  for (size_t pos = 0; pos < gz.size();) {
+    size_t len = std::min(next_len(), gz.size() - pos);
+    OTAGzipInflater::Error err = inflater.feed(gz.data() + pos, len);
+    if (err != OTAGzipInflater::OK)
+      return err;
+    pos += len;
+  }
+  return inflater.finish();
+}
+
+static OTAGzipInflater::Error inflate(const bytes &gz, bytes &out, size_t chunk = 1460) {
+  return inflate(gz, out, [chunk]() { return chunk; });
+}
+
+// Firmware-ish data: runs of repeated words, small integers and random bytes
+static bytes test_data(uint32_t seed, size_t size) {
+  std::mt19937 rng(seed);
+  bytes data;
+  while (data.size() < size) {
+    switch (rng() % 4) {
+      case 0: data.insert(data.end(), 1 + rng() % 300, rng()); break;
+      case 1: data.push_back(rng() % 8); break;
+      case 2: data.push_back(rng()); break;
+      case 3:
+        if (data.size() > 100) {
+          size_t start = rng() % (data.size() - 50);
+          data.insert(data.end(), data.begin() + start, data.begin() + start + 3 + rng() % 40);
+        }
+        break;
+    }
+  }
+  data.resize(size);
+  return data;
+}
+
+static void test_block_types() {
+  bytes data = test_data(1, 300000);
+  bytes out;
+  for (int strategy : {Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED}) {
+    for (int level : {0, 1, 6, 9}) {
+      bytes gz = gzip(data, level, strategy);
+      CHECK(inflate(gz, out) == OTAGzipInflater::OK);
+      CHECK(out == data);
+    }
+  }
+
+  // incompressible data ends up in stored blocks
+  std::mt19937 rng(2);
+  bytes random(100000);
+  for (auto &b : random)
+    b = rng();
+  CHECK(inflate(gzip(random, 9, Z_DEFAULT_STRATEGY), out) == OTAGzipInflater::OK && out == random);
+
+  CHECK(inflate(gzip(bytes(), 9, Z_DEFAULT_STRATEGY), out) == OTAGzipInflater::OK && out.empty());
+  CHECK(inflate(gzip(data, 9, Z_DEFAULT_STRATEGY, true), out) == OTAGzipInflater::OK && out == data);
+}
+
+static void test_chunk_boundaries() {
+  bytes data = test_data(3, 100000);
+  bytes gz = gzip(data, 9, Z_DEFAULT_STRATEGY, true);
+  bytes out;
+
+  for (size_t chunk : {size_t(1), size_t(2), size_t(3), size_t(7), size_t(536), gz.size()}) {
+    CHECK(inflate(gz, out, chunk) == OTAGzipInflater::OK);
+    CHECK(out == data);
+  }
+
+  std::mt19937 rng(4);
+  for (int round = 0; round < 20; round++) {
+    CHECK(inflate(gz, out, [&]() { return 1 + rng() % 100; }) == OTAGzipInflater::OK);
+    CHECK(out == data);
+  }
+
+  // every possible split into two chunks of a small stream with a dynamic block
+  bytes small = test_data(5, 3000);
+  bytes small_gz = gzip(small, 9, Z_DEFAULT_STRATEGY, true);
+  for (size_t split = 1; split < small_gz.size(); split++) {
+    bool first = true;
+    CHECK(inflate(small_gz, out, [&]() {
+            size_t len = first ? split : small_gz.size();
+            first = false;
+            return len;
+          }) == OTAGzipInflater::OK);
+    CHECK(out == small);
+  }
+}
+
+static void test_errors() {
+  bytes data = test_data(6, 50000);
+  bytes gz = gzip(data, 9, Z_DEFAULT_STRATEGY);
+  bytes out;
+
+  CHECK(OTAGzipInflater::is_gzip(gz.data(), gz.size()));
+  bytes bad = gz;
+  bad[1] = 0;
+  CHECK(!OTAGzipInflater::is_gzip(bad.data(), bad.size()));
+  CHECK(inflate(bad, out) == OTAGzipInflater::ERROR_FORMAT);
+
+  // CRC-32 and ISIZE in the trailer
+  bad = gz;
+  bad[bad.size() - 8] ^= 1;
+  CHECK(inflate(bad, out) == OTAGzipInflater::ERROR_CRC);
+  bad = gz;
+  bad[bad.size() - 1] ^= 1;
+  CHECK(inflate(bad, out) == OTAGzipInflater::ERROR_CRC);
+
+  bad.assign(gz.begin(), gz.end() - 1);
+  CHECK(inflate(bad, out) == OTAGzipInflater::ERROR_FORMAT);
+  bad.assign(gz.begin(), gz.begin() + gz.size() / 2);
+  CHECK(inflate(bad, out) == OTAGzipInflater::ERROR_FORMAT);
+  bad = gz;
+  bad.push_back(0);
+  CHECK(inflate(bad, out) == OTAGzipInflater::ERROR_FORMAT);
+
+  // Corrupt compressed data must be rejected or still produce the original data (some bit flips only change e.g. the
+  // distance of a match inside a run of equal bytes), never crash
+  std::mt19937 rng(7);
+  for (int round = 0; round < 500; round++) {
+    bad = gz;
+    bad[10 + rng() % (bad.size() - 18)] ^= 1 << (rng() % 8);
+    CHECK(inflate(bad, out, 1 + rng() % 2000) != OTAGzipInflater::OK || out == data);
+  }
+
+  size_t written = 0;
+  OTAGzipInflater inflater([&](const uint8_t *data, size_t len) {
+    written += len;
+    return uint8_t(written > 10000 ? 42 : 0);
+  });
+  CHECK(inflater.feed(gz.data(), gz.size()) == OTAGzipInflater::ERROR_SINK);
+  CHECK(inflater.sink_error() == 42);
+  CHECK(inflater.finish() != OTAGzipInflater::OK);
+}
+
+int main() {
+  test_block_types();
+  test_chunk_boundaries();
+  test_errors();
+  return unit_result("ota_inflate");
+}
@@ -0,0 +1,107 @@
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../src-esphome/mycomponents/web_server/ota/ota_stream.h"
+#include "unit.hpp"
+
+using esphome::web_server::OTASectorWriter;
+using esphome::web_server::OTASha256;
+
+static std::string sha256_hex(const std::string &data) {
+  OTASha256 sha;
+  uint8_t digest[OTASha256::DIGEST_SIZE];
+  sha.update((const uint8_t *)data.data(), data.size());
+  sha.final(digest);
+  return OTASha256::to_hex(digest);
+}
+
+static void test_sha256_vectors() {
+  CHECK(sha256_hex("") == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  CHECK(sha256_hex("abc") == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+  CHECK(sha256_hex("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+  CHECK(sha256_hex(std::string(1000000, 'a')) == "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+static void test_sha256_chunked() {
+  std::mt19937 rng(1);
+  std::string data(100000, '\0');
+  for (auto &c : data)
+    c = (char)rng();
+
+  std::string expected = sha256_hex(data);
+  for (int round = 0; round < 20; round++) {
+    OTASha256 sha;
+    size_t pos = 0;
+    while (pos < data.size()) {
+      size_t len = std::min<size_t>(rng() % 200, data.size() - pos);
+      sha.update((const uint8_t *)data.data() + pos, len);
+      pos += len;
+    }
+    uint8_t digest[OTASha256::DIGEST_SIZE];
+    sha.final(digest);
+    CHECK(OTASha256::to_hex(digest) == expected);
+  }
+}
+
+static void test_sha256_hex() {
+  uint8_t digest[OTASha256::DIGEST_SIZE];
+  CHECK(OTASha256::from_hex("BA7816BF8F01CFEA414140DE5DAE2223B00361A396177A9CB410FF61F20015AD", digest));
+  CHECK(OTASha256::to_hex(digest) == sha256_hex("abc"));
+  CHECK(!OTASha256::from_hex("ba7816bf", digest));
+  CHECK(!OTASha256::from_hex(std::string(63, '0') + "g", digest));
+}
+
+static void test_sector_writer() {
+  std::mt19937 rng(2);
+  std::vector<uint8_t> data(3 * OTASectorWriter::SECTOR_SIZE + 1234);
+  for (auto &b : data)
+    b = (uint8_t)rng();
+
+  const size_t max_chunks[] = {1, 100, 1460, 5000, 20000};
+  for (size_t max_chunk : max_chunks) {
+    std::vector<uint8_t> out;
+    std::vector<size_t> calls;
+    OTASectorWriter writer([&](const uint8_t *buf, size_t len) -> uint8_t {
+      out.insert(out.end(), buf, buf + len);
+      calls.push_back(len);
+      return 0;
+    });
+    size_t pos = 0;
+    while (pos < data.size()) {
+      size_t len = std::min<size_t>(1 + rng() % max_chunk, data.size() - pos);
+      CHECK(writer.write(data.data() + pos, len) == 0);
+      pos += len;
+    }
+    CHECK(writer.flush() == 0);
+    CHECK(out == data);
+    CHECK(calls.size() == 4);
+    for (size_t i = 0; i + 1 < calls.size(); i++)
+      CHECK(calls[i] == OTASectorWriter::SECTOR_SIZE);
+    CHECK(calls.back() == 1234);
+  }
+}
+
+static void test_sector_writer_error() {
+  int calls = 0;
+  OTASectorWriter writer([&](const uint8_t *buf, size_t len) -> uint8_t {
+    calls++;
+    return calls == 2 ? 0x80 : 0;
+  });
+  std::vector<uint8_t> data(OTASectorWriter::SECTOR_SIZE, 0xAA);
+  CHECK(writer.write(data.data(), data.size()) == 0);
+  CHECK(writer.write(data.data(), data.size()) == 0x80);
+  CHECK(writer.flush() == 0);
+  CHECK(calls == 2);
+}
+
+int main() {
+  test_sha256_vectors();
+  test_sha256_chunked();
+  test_sha256_hex();
+  test_sector_writer();
+  test_sector_writer_error();
+  return unit_result("ota_stream");
+}
@@ -0,0 +1,113 @@
+#include <cstring>
+#include <string>
+
+#include "../../src-common/gm_manager.hpp"
+#include "../../src-common/profiler.hpp"
+#include "unit.hpp"
+
+static uint32_t now = 1;
+uint32_t esphome::millis() { return now; }
+
+static void test_histogram() {
+  CHECK(ProfileHistogram::bucket_of(0) == 0);
+  CHECK(ProfileHistogram::bucket_of(1) == 1);
+  CHECK(ProfileHistogram::bucket_of(2) == 2 && ProfileHistogram::bucket_of(3) == 2);
+  CHECK(ProfileHistogram::bucket_of(4) == 3);
+  CHECK(ProfileHistogram::bucket_of(1u << 31) == ProfileHistogram::BUCKETS - 1);
+
+  ProfileHistogram h;
+  CHECK(h.percentile(0.5f) == 0);
+  for (int i = 0; i < 90; i++)
+    h.record(100);
+  for (int i = 0; i < 10; i++)
+    h.record(5000);
+  CHECK(h.count == 100 && h.total == 90 * 100 + 10 * 5000 && h.max == 5000);
+  CHECK(h.percentile(0.5f) == 128);
+  CHECK(h.percentile(0.89f) == 128);
+  // the bucket bound is 8192, the max is lower
+  CHECK(h.percentile(0.9f) == 5000 && h.percentile(0.99f) == 5000);
+
+  // beyond the last bucket bound only the max is known
+  h.record(100000000);
+  CHECK(h.percentile(0.999f) == 100000000);
+}
+
+static void test_scope() {
+  profiler.reset();
+  {
+    ANT_PROFILE_SCOPE(ProfileSite::ACTIONS);
+  }
+  CHECK(profiler.site(ProfileSite::ACTIONS).count == 1);
+  CHECK(profiler.site(ProfileSite::GAME_CLOCK).count == 0);
+
+  CHECK(profile_mode_site(ProfileSite::GAME_CLOCK, 0) == ProfileSite::DEFUSAL_CLOCK);
+  CHECK(profile_mode_site(ProfileSite::GAME_KEY, 1) == ProfileSite::DOMINATION_KEY);
+  CHECK(profile_mode_site(ProfileSite::GAME_DISPLAY, 6) == ProfileSite::MENU_DISPLAY);
+}
+
+static void test_game_manager() {
+  profiler.reset();
+  AntGlobals antg;
+  GameManager game_manager(antg);
+  esphome::lcd_base::LCDDisplay display;
+
+  // splash, then the menu
+  game_manager.clock(now, 0);
+  game_manager.handle_key(KEY_B);
+  game_manager.display_update(display);
+  CHECK(profiler.site(ProfileSite::GAME_CLOCK).count == 1);
+  CHECK(profiler.site(ProfileSite::GAME_KEY).count == 1);
+  CHECK(profiler.site(ProfileSite::MENU_DISPLAY).count == 1);
+  CHECK(profiler.site(ProfileSite::GAME_DISPLAY).count == 1);
+  // the splash isn't a mode
+  CHECK(profiler.site(ProfileSite::MENU_KEY).count == 0);
+
+  // domination, selected in the menu
+  game_manager.handle_key(KEY_B);
+  game_manager.handle_key(KEY_C);
+  CHECK(profiler.site(ProfileSite::MENU_KEY).count == 2);
+  // the buzzer of each key
+  CHECK(profiler.site(ProfileSite::ACTIONS).count == 3);
+  now += 50;
+  game_manager.clock(now, 50);
+  game_manager.handle_key(KEY_B);
+  CHECK(profiler.site(ProfileSite::DOMINATION_CLOCK).count == 1);
+  CHECK(profiler.site(ProfileSite::DOMINATION_KEY).count == 1);
+  CHECK(profiler.site(ProfileSite::GAME_CLOCK).count == 2);
+  CHECK(profiler.site(ProfileSite::DEFUSAL_CLOCK).count == 0);
+}
+
+static void test_format() {
+  profiler.reset();
+  profiler.site(ProfileSite::GAME_CLOCK).record(3000);
+  profiler.site(ProfileSite::COUNTDOWN_KEY).record(500);
+
+  char text[Profiler::MAX_TEXT];
+  size_t len = profiler.format(text, sizeof(text));
+  CHECK(len == strlen(text));
+  std::string table = text;
+  CHECK(table.rfind("# since boot, 1000 ticks/us", 0) == 0);
+  CHECK(table.find("\nclock                         1      3.0      3.0      3.0      3.0      3.0\n") !=
+        std::string::npos);
+  CHECK(table.find("\ncountdown.key                 1      0.5      0.5") != std::string::npos);
+  CHECK(table.find("handle_key") == std::string::npos);
+
+  // all sites fit
+  for (size_t i = 0; i < static_cast<size_t>(ProfileSite::COUNT); i++)
+    profiler.sites[i].record(0xffffffff);
+  len = profiler.format(text, sizeof(text));
+  CHECK(len < sizeof(text) && len == strlen(text));
+
+  // a short buffer is cut
+  char small[40];
+  CHECK(profiler.format(small, sizeof(small)) == sizeof(small) - 1 && strlen(small) == sizeof(small) - 1);
+}
+
+int main() {
+  mock_log_enabled = false;
+  test_histogram();
+  test_scope();
+  test_game_manager();
+  test_format();
+  return unit_result("profiler");
+}
@@ -0,0 +1,167 @@
+#include <random>
+#include <thread>
+
+#include "../../src-common/remote_keypad.hpp"
+#include "../remote_keypad_host.hpp"
+#include "unit.hpp"
+
+static LcdFrame frame_of(const char *row0, const char *row1) {
+  LcdFrame f;
+  memcpy(f.cells, row0, LCD_COLS);
+  memcpy(f.cells + LCD_COLS, row1, LCD_COLS);
+  return f;
+}
+
+static void test_lcd_diff() {
+  uint8_t buf[LcdFrame::MAX_DIFF];
+  LcdFrame a = frame_of("> Defusal       ", "  Domination    ");
+  LcdFrame b = frame_of("  Defusal       ", "> Domination    ");
+
+  // against nothing: the full display, including the glyphs
+  a.cells[15] = '\x05';
+  CHECK(a.diff(nullptr, buf) == LcdFrame::MAX_DIFF);
+  LcdFrame c;
+  CHECK(c.apply(buf, LcdFrame::MAX_DIFF) && c == a);
+  a.cells[15] = ' ';
+
+  // unchanged: nothing
+  CHECK(a.diff(&a, buf) == 0);
+
+  // two changed cells far apart: two runs of one cell
+  CHECK(b.diff(&a, buf) == 6);
+  CHECK(buf[0] == 0 && buf[1] == 1 && buf[2] == ' ' && buf[3] == 16 && buf[4] == 1 && buf[5] == '>');
+  c = a;
+  CHECK(c.apply(buf, 6) && c == b);
+
+  // a gap of up to 2 unchanged cells is bridged
+  LcdFrame d = a;
+  d.cells[3] = 'x';
+  d.cells[6] = 'y';
+  CHECK(d.diff(&a, buf) == 2 + 4);
+  d.cells[6] = 's';
+  d.cells[7] = 'z';
+  CHECK(d.diff(&a, buf) == 2 + 1 + 2 + 1);
+
+  // random frames round trip, and never cost more than the full frame
+  std::mt19937 rng(3);
+  LcdFrame prev, next, mirror;
+  for (int i = 0; i < 2000; i++) {
+    for (int j = rng() % 8; j >= 0; j--) {
+      next.cells[rng() % LCD_CELLS] = "ab \x01\x02"[rng() % 5];
+    }
+    size_t len = next.diff(i ? &prev : nullptr, buf);
+    CHECK(len <= LcdFrame::MAX_DIFF);
+    CHECK(mirror.apply(buf, len) && mirror == next);
+    prev = next;
+  }
+
+  // malformed diffs
+  const uint8_t bad_len[] = {30, 3, 'a', 'b', 'c'};
+  CHECK(!c.apply(bad_len, sizeof(bad_len)));
+  const uint8_t truncated[] = {0, 3, 'a'};
+  CHECK(!c.apply(truncated, sizeof(truncated)));
+  const uint8_t empty_run[] = {0, 0};
+  CHECK(!c.apply(empty_run, sizeof(empty_run)));
+}
+
+static void test_key_frames() {
+  const uint8_t ok[] = {7, KEY_1, KEY_RED, KEY_C_LONG, KEY_HASH};
+  CHECK(remote_key_frame_valid(ok, sizeof(ok)));
+  CHECK(!remote_key_frame_valid(ok, 1)); // no keys
+  const uint8_t bad[] = {7, 'a'};
+  CHECK(!remote_key_frame_valid(bad, sizeof(bad)));
+  uint8_t too_long[REMOTE_KEYPAD_MAX_FRAME + 1];
+  memset(too_long, KEY_0, sizeof(too_long));
+  CHECK(!remote_key_frame_valid(too_long, sizeof(too_long)));
+}
+
+static void test_client() {
+  RemoteKeypadClient client;
+  uint8_t buf[REMOTE_KEYPAD_MAX_LCD_FRAME];
+  LcdFrame frame = frame_of("   KMS ANT V2   ", "  makerspace.lt ");
+
+  // the first frame is the full display, then only changes
+  CHECK(client.update(frame, buf) == 1 + LcdFrame::MAX_DIFF);
+  CHECK(client.update(frame, buf) == 0);
+
+  // an applied key frame is acknowledged even if the display didn't change
+  client.applied(42);
+  CHECK(client.update(frame, buf) == 1 && buf[0] == 42);
+  CHECK(client.update(frame, buf) == 0);
+
+  frame.cells[0] = '>';
+  CHECK(client.update(frame, buf) == 1 + 3 && buf[0] == 42);
+
+  // key frames queued for the game task are acknowledged with the first display that shows them
+  client.queued(43, 7);
+  client.queued(43, 8);
+  client.queued(44, 9);
+  client.shown(6);
+  CHECK(client.update(frame, buf) == 0);
+  client.shown(8);
+  CHECK(client.update(frame, buf) == 1 && buf[0] == 43);
+  client.shown(8);
+  CHECK(client.update(frame, buf) == 0);
+  client.shown(9);
+  CHECK(client.update(frame, buf) == 1 && buf[0] == 44);
+
+  // too many in flight: the oldest are dropped, the newest still acknowledged
+  for (uint32_t i = 0; i < RemoteKeypadClient::MAX_QUEUED + 3; i++) {
+    client.queued((uint8_t)(50 + i), 10 + i);
+  }
+  client.shown(10 + RemoteKeypadClient::MAX_QUEUED + 2);
+  CHECK(client.update(frame, buf) == 1 && buf[0] == 50 + RemoteKeypadClient::MAX_QUEUED + 2);
+
+  client.reset();
+  CHECK(client.update(frame, buf) == 1 + LcdFrame::MAX_DIFF);
+}
+
+static void test_queue() {
+  RemoteKeyQueueN<8> small;
+  for (uint8_t i = 0; i < 7; i++) {
+    CHECK(small.push(RemoteKey{i, 0, i, KEY_0}));
+  }
+  CHECK(!small.push(RemoteKey{}) && small.dropped == 1);
+  RemoteKey key;
+  for (uint8_t i = 0; i < 7; i++) {
+    CHECK(small.pop(key) && key.seq == i);
+  }
+  CHECK(!small.pop(key) && small.empty());
+
+  // a producer and a consumer thread, every key arrives once and in order
+  RemoteKeyQueue queue;
+  const uint32_t count = 20000;
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < count; i++) {
+      while (!queue.push(RemoteKey{i, 0, (uint8_t)i, KEY_0})) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  uint32_t expected = 0;
+  bool in_order = true;
+  while (expected < count) {
+    if (queue.pop(key)) {
+      in_order &= key.received_us == expected;
+      expected++;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  CHECK(in_order);
+}
+
+static void test_websocket_accept() {
+  // the example of RFC 6455
+  CHECK(RemoteKeypadHost::websocket_accept("dGhlIHNhbXBsZSBub25jZQ==") == "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+int main() {
+  test_lcd_diff();
+  test_key_frames();
+  test_client();
+  test_queue();
+  test_websocket_accept();
+  return unit_result("remote_keypad");
+}
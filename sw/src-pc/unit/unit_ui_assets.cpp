@@ -0,0 +1,162 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../tools/ui_pack.hpp"
+#include "unit.hpp"
+
+using esphome::web_server::UIAsset;
+using esphome::web_server::UIAssetImage;
+using ui_pack::bytes;
+
+static constexpr size_t PARTITION_SIZE = 0x40000;
+
+static bytes to_bytes(const std::string &s) { return bytes(s.begin(), s.end()); }
+
+// The image written to the start of an erased partition
+static bytes flash(const bytes &image) {
+  bytes partition(PARTITION_SIZE, 0xFF);
+  std::copy(image.begin(), image.end(), partition.begin());
+  return partition;
+}
+
+// An asset as the device sends it, chunk by chunk
+static bytes serve(const UIAssetImage &image, const char *name, size_t chunk_size, size_t *chunks = nullptr) {
+  const UIAsset *asset = image.find(name, strlen(name));
+  bytes body;
+  if (asset == nullptr)
+    return body;
+  size_t n = 0;
+  CHECK(UIAssetImage::send_chunked(*asset, chunk_size, [&](const uint8_t *data, size_t len) {
+    CHECK(len > 0 && len <= chunk_size);
+    // zero copy: the chunks point into the image
+    CHECK(data >= asset->data && data + len <= asset->data + asset->size);
+    body.insert(body.end(), data, data + len);
+    n++;
+    return true;
+  }));
+  if (chunks != nullptr)
+    *chunks = n;
+  return body;
+}
+
+static void test_crc32() {
+  const char *check = "123456789";
+  CHECK(UIAssetImage::crc32(0, (const uint8_t *) check, 9) == 0xCBF43926);
+  // incremental
+  uint32_t crc = UIAssetImage::crc32(0, (const uint8_t *) check, 4);
+  CHECK(UIAssetImage::crc32(crc, (const uint8_t *) check + 4, 5) == 0xCBF43926);
+  CHECK(UIAssetImage::crc32(0, nullptr, 0) == 0);
+}
+
+static void test_serve() {
+  bytes index = to_bytes("<html><body>index</body></html>");
+  bytes keypad(10000);
+  for (size_t i = 0; i < keypad.size(); i++)
+    keypad[i] = i * 7;
+  keypad[0] = 0x1F;
+  keypad[1] = 0x8B;
+  std::vector<ui_pack::Asset> assets = {
+      {"/", "text/html", index},
+      {"/keypad", ui_pack::content_type_of("keypad.html.gz"), keypad},
+  };
+  CHECK(ui_pack::check(assets) == nullptr);
+  bytes image = ui_pack::pack(assets);
+  bytes partition = flash(image);
+
+  UIAssetImage ui;
+  CHECK(ui.load(partition.data(), partition.size(), true) == UIAssetImage::OK);
+  CHECK(ui.assets().size() == 2 && ui.size() == image.size());
+
+  const UIAsset *root = ui.find("/", 1);
+  CHECK(root != nullptr && strcmp(root->content_type, "text/html") == 0 && !root->gzip);
+  const UIAsset *pad = ui.find("/keypad", 7);
+  CHECK(pad != nullptr && strcmp(pad->content_type, "text/html") == 0 && pad->gzip);
+  CHECK(ui.find("/key", 4) == nullptr && ui.find("/keypad.html", 12) == nullptr);
+  // the name doesn't have to be NUL terminated, e.g. a part of the request line
+  CHECK(ui.find("/keypad?x=1", 7) == pad);
+
+  size_t chunks;
+  CHECK(serve(ui, "/", 4096, &chunks) == index && chunks == 1);
+  CHECK(serve(ui, "/keypad", 4096, &chunks) == keypad && chunks == 3);
+  CHECK(serve(ui, "/keypad", 1, &chunks) == keypad && chunks == keypad.size());
+
+  // a sink that stops
+  size_t calls = 0;
+  CHECK(!UIAssetImage::send_chunked(*pad, 1000, [&](const uint8_t *, size_t) { return ++calls < 2; }));
+  CHECK(calls == 2);
+}
+
+static void test_reject() {
+  bytes image = ui_pack::pack({{"/", "text/html", to_bytes("index")}, {"/a.css", "text/css", to_bytes("a{}")}});
+  UIAssetImage ui;
+
+  bytes erased(PARTITION_SIZE, 0xFF);
+  CHECK(ui.load(erased.data(), erased.size(), true) == UIAssetImage::ERROR_EMPTY);
+  CHECK(ui.load(image.data(), 10, true) == UIAssetImage::ERROR_FORMAT);
+  bytes other = image;
+  other[4] = UIAssetImage::VERSION + 1;
+  CHECK(ui.load(other.data(), other.size(), true) == UIAssetImage::ERROR_FORMAT);
+  CHECK(!UIAssetImage::is_image(erased.data(), erased.size()) && UIAssetImage::is_image(image.data(), 4));
+
+  // doesn't fit into the partition
+  CHECK(ui.load(image.data(), image.size() - 1, true) == UIAssetImage::ERROR_SIZE);
+
+  // a flipped bit in the index
+  bytes bad = flash(image);
+  bad[UIAssetImage::HEADER_SIZE + 1] ^= 0x01;
+  CHECK(ui.load(bad.data(), bad.size(), true) == UIAssetImage::ERROR_INDEX);
+
+  // a flipped bit in the data is only found when verifying
+  bad = flash(image);
+  bad[image.size() - 1] ^= 0x01;
+  CHECK(ui.load(bad.data(), bad.size(), true) == UIAssetImage::ERROR_DATA);
+  CHECK(ui.assets().empty() && ui.size() == 0);
+  CHECK(ui.load(bad.data(), bad.size(), false) == UIAssetImage::OK);
+
+  // a torn upload: the rest of the partition is still erased
+  bytes torn(PARTITION_SIZE, 0xFF);
+  std::copy(image.begin(), image.end() - 2, torn.begin());
+  CHECK(ui.load(torn.data(), torn.size(), true) == UIAssetImage::ERROR_DATA);
+
+  // an index that points outside of the image, with a matching CRC
+  bytes outside = image;
+  ui_pack::put_le32(outside.data() + UIAssetImage::HEADER_SIZE + 84, image.size());
+  ui_pack::put_le32(outside.data() + 12, UIAssetImage::crc32(0, outside.data() + UIAssetImage::HEADER_SIZE,
+                                                             2 * UIAssetImage::ENTRY_SIZE));
+  CHECK(ui.load(outside.data(), outside.size(), false) == UIAssetImage::ERROR_INDEX);
+
+  // the packer refuses what the device couldn't serve
+  CHECK(ui_pack::check({{"index.html", "text/html", {}}}) != nullptr);
+  CHECK(ui_pack::check({{"/", "text/html", {}}, {"/", "text/css", {}}}) != nullptr);
+  CHECK(ui_pack::check({{"/" + std::string(UIAssetImage::NAME_SIZE, 'x'), "text/html", {}}}) != nullptr);
+  CHECK(ui_pack::check({{"/", std::string(UIAssetImage::CONTENT_TYPE_SIZE, 'x'), {}}}) != nullptr);
+}
+
+// The pages of the prop, packed as `make ui` does
+static void test_pages(const std::string &dir) {
+  std::vector<ui_pack::Asset> assets = {{"/", "text/html", {}}, {"/keypad", "text/html", {}}};
+  const char *files[] = {"index.html", "keypad.html"};
+  for (size_t i = 0; i < assets.size(); i++) {
+    std::ifstream f(dir + "/" + files[i], std::ios::binary);
+    CHECK(f.good());
+    assets[i].data.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    CHECK(!assets[i].data.empty());
+  }
+  bytes partition = flash(ui_pack::pack(assets));
+  UIAssetImage ui;
+  CHECK(ui.load(partition.data(), partition.size(), true) == UIAssetImage::OK);
+  CHECK(serve(ui, "/", 1436) == assets[0].data);
+  CHECK(serve(ui, "/keypad", 1436) == assets[1].data);
+}
+
+int main(int argc, char **argv) {
+  test_crc32();
+  test_serve();
+  test_reject();
+  if (argc > 1)
+    test_pages(argv[1]);
+  return unit_result("ui_assets");
+}
@@ -0,0 +1,215 @@
+// The web_server component against the stand-in AsyncWebServer (src-pc/mock_web): pages, entity requests, the event
+// stream and OTA uploads, and the metrics component.
+
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "../../src-common/profiler.hpp"
+#include "../../src-esphome/mycomponents/metrics/metrics.h"
+#include "../mock_web/web_host.hpp"
+#include "unit.hpp"
+
+using web_host::WebHost;
+
+static bool contains(const std::string &text, const std::string &part) { return text.find(part) != std::string::npos; }
+
+static void test_index() {
+  WebHost host;
+  AsyncWebServerRequest request(HTTP_GET, "/");
+  host.handle(request);
+  CHECK(request.code() == 200);
+  CHECK(request.content_type() == "text/html");
+  CHECK(request.response_header("Content-Encoding") == "gzip");
+  CHECK(request.body().size() == ESPHOME_WEBSERVER_INDEX_HTML_SIZE);
+}
+
+static void test_not_found() {
+  WebHost host;
+  AsyncWebServerRequest request(HTTP_GET, "/nothing/here");
+  host.handle(request);
+  CHECK(request.code() == 404);
+}
+
+static void test_binary_sensor() {
+  WebHost host;
+  host.sensors[0]->publish_state(true);
+  AsyncWebServerRequest request(HTTP_GET, "/binary_sensor/red_button");
+  host.handle(request);
+  CHECK(request.code() == 200);
+  CHECK(request.content_type() == "application/json");
+  CHECK(contains(request.body(), "\"id\":\"binary_sensor-red_button\""));
+  CHECK(contains(request.body(), "\"value\":true"));
+
+  AsyncWebServerRequest unknown(HTTP_GET, "/binary_sensor/blue_button");
+  host.handle(unknown);
+  CHECK(unknown.code() == 404);
+}
+
+static void test_switch_and_button() {
+  WebHost host;
+  AsyncWebServerRequest toggle(HTTP_POST, "/switch/siren/toggle");
+  host.handle(toggle);
+  CHECK(toggle.code() == 200);
+  // commands are deferred to the main loop
+  CHECK(!host.siren.state);
+  host.loop();
+  CHECK(host.siren.state);
+
+  AsyncWebServerRequest state(HTTP_GET, "/switch/siren");
+  host.handle(state);
+  CHECK(contains(state.body(), "\"state\":\"ON\""));
+
+  int presses = 0;
+  host.restart.add_on_press_callback([&presses]() { presses++; });
+  AsyncWebServerRequest press(HTTP_POST, "/button/restart/press");
+  host.handle(press);
+  CHECK(press.code() == 200);
+  host.loop();
+  CHECK(presses == 1);
+}
+
+static void test_events() {
+  WebHost host;
+  AsyncWebServerRequest request(HTTP_GET, "/events");
+  host.handle(request);
+  CHECK(request.code() == 200);
+  AsyncEventSourceResponse *client = request.event_client();
+  CHECK(client != nullptr);
+  if (client == nullptr)
+    return;
+
+  for (int i = 0; i < 10; i++)
+    host.loop();
+  std::string stream = client->read();
+  // the config first, then the entities in batches
+  CHECK(stream.rfind("retry: 30000\r\n", 0) == 0);
+  CHECK(contains(stream, "event: ping\r\n"));
+  CHECK(contains(stream, "\"title\":\"Ant\""));
+  CHECK(contains(stream, "event: entities\r\n"));
+  CHECK(contains(stream, "binary_sensor-key_star"));
+  CHECK(contains(stream, "switch-siren"));
+
+  // a change goes out with the next loop
+  host.sensors[1]->publish_state(true);
+  host.loop();
+  stream = client->read();
+  CHECK(contains(stream, "binary_sensor-yellow_button"));
+  CHECK(!contains(stream, "binary_sensor-red_button"));
+
+  client->close();
+  host.loop();
+  CHECK(host.base.get_server() != nullptr);
+}
+
+// The event id of the last entity batch in a stream, the change it is complete up to
+static uint32_t last_entities_id(const std::string &stream) {
+  static const std::regex BATCH("id: ([0-9]+)\r\nevent: entities\r\n");
+  uint32_t id = 0;
+  for (auto it = std::sregex_iterator(stream.begin(), stream.end(), BATCH); it != std::sregex_iterator(); ++it)
+    id = strtoul((*it)[1].str().c_str(), nullptr, 10);
+  return id;
+}
+
+// A client that reconnects with Last-Event-ID is only sent what changed, also when the main loop runs between
+// onConnect() and the client being added
+static void test_events_resume() {
+  WebHost host;
+  AsyncWebServerRequest first(HTTP_GET, "/events");
+  host.handle(first);
+  AsyncEventSourceResponse *client = first.event_client();
+  CHECK(client != nullptr);
+  if (client == nullptr)
+    return;
+  for (int i = 0; i < 10; i++)
+    host.loop();
+  uint32_t last_id = last_entities_id(client->read());
+  CHECK(last_id != 0);
+  client->close();
+  host.loop();
+
+  host.sensors[1]->publish_state(true);
+  AsyncWebServerRequest again(HTTP_GET, "/events");
+  again.add_header("Last-Event-ID", std::to_string(last_id));
+  AsyncEventSource::connect_gap = [&host]() { host.loop(); };
+  host.handle(again);
+  AsyncEventSource::connect_gap = nullptr;
+  client = again.event_client();
+  CHECK(client != nullptr);
+  if (client == nullptr)
+    return;
+  for (int i = 0; i < 10; i++)
+    host.loop();
+  std::string stream = client->read();
+  CHECK(contains(stream, "binary_sensor-yellow_button"));
+  CHECK(!contains(stream, "binary_sensor-key_star"));
+  CHECK(last_entities_id(stream) > last_id);
+}
+
+static void test_ota_upload() {
+  WebHost host;
+  std::vector<uint8_t> image(100000);
+  for (size_t i = 0; i < image.size(); i++)
+    image[i] = static_cast<uint8_t>(i * 7 + i / 251);
+  image[0] = 0xe9; // ESP image magic
+
+  AsyncWebServerRequest request(HTTP_POST, "/update");
+  host.upload(request, "firmware.bin", image);
+  CHECK(request.code() == 200);
+  CHECK(request.body() == "Update Successful!");
+  CHECK(esphome::ota::updated_image() == image);
+
+  // a truncated gzip stream fails
+  std::vector<uint8_t> broken = {0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x01};
+  AsyncWebServerRequest failed(HTTP_POST, "/update");
+  host.upload(failed, "firmware.bin.gz", broken);
+  CHECK(failed.body() == "Update Failed!");
+  CHECK(esphome::ota::updated_image() == image);
+
+  // the magic is recognized when the first chunks are shorter than it
+  AsyncWebServerRequest split(HTTP_POST, "/update");
+  host.upload(split, "firmware.bin.gz", broken, 1);
+  CHECK(split.body() == "Update Failed!");
+  CHECK(esphome::ota::updated_image() == image);
+  image[1] = 0x42;
+  AsyncWebServerRequest plain(HTTP_POST, "/update");
+  host.upload(plain, "firmware.bin", image, std::vector<size_t>{1, 2, 1, image.size() - 4});
+  CHECK(plain.body() == "Update Successful!");
+  CHECK(esphome::ota::updated_image() == image);
+}
+
+static void test_metrics() {
+  WebHost host;
+  esphome::metrics::Metrics metrics(&host.base);
+  metrics.setup();
+  profiler.reset();
+  profiler.site(ProfileSite::DEFUSAL_CLOCK).record(2000);
+
+  AsyncWebServerRequest request(HTTP_GET, "/metrics");
+  host.handle(request);
+  CHECK(request.code() == 200);
+  CHECK(request.content_type() == "text/plain");
+  CHECK(request.body().rfind("# since boot", 0) == 0);
+  CHECK(contains(request.body(), "\ndefusal.clock "));
+  CHECK(!contains(request.body(), "\nclock "));
+  CHECK(contains(request.body(), "\n\n# input latency since boot"));
+  CHECK(contains(request.body(), "\n\n# game task ticks since boot"));
+
+  AsyncWebServerRequest post(HTTP_POST, "/metrics");
+  host.handle(post);
+  CHECK(post.code() == 404);
+}
+
+int main() {
+  esphome::logger::global_logger->set_print_level(ESPHOME_LOG_LEVEL_NONE);
+  test_index();
+  test_not_found();
+  test_binary_sensor();
+  test_switch_and_button();
+  test_events();
+  test_events_resume();
+  test_ota_upload();
+  test_metrics();
+  return unit_result("web_server");
+}